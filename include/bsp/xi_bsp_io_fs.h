@@ -131,7 +131,11 @@ xi_bsp_io_fs_stat( const char* const resource_name, xi_bsp_io_fs_stat_t* resourc
  * flash file system implementations which reserve space when
  * the file is opened for writing.  Not used in POSIX implementations.
  * @param [in] open_flags a read/write/append bitmask of operations as
- * defined by a bitmask type xi_bsp_io_fs_open_flags_t.
+ * defined by a bitmask type xi_bsp_io_fs_open_flags_t. Read and write together
+ * requests an existing file to be opened for update without truncating it, the
+ * Secure File Transfer uses this to continue an interrupted download. If the
+ * platform can't support it an error should be returned, the download then
+ * starts over.
  * @param [out] resource_handle_out a pointer to an abstracted
  * xi_bsp_io_fs_resource_handle_t data type. This value will be passed to
  * future file operations such as read, write or close.
@@ -192,7 +192,7 @@ typedef struct xi_bsp_socket_events_s
  * @param [in] socket_events_array an array of sockets and sockets' events
  * @param [in] socket_events_array_size size of the socket_events_array
  * @param [in] timeout used for passive waiting function must not wait longer than the
- * given timeout ( in seconds )
+ * given timeout ( in seconds ), a negative timeout means waiting until a socket event
  *
  * @return
  * - XI_BSP_IO_NET_STATE_OK - if select call updated any socket event
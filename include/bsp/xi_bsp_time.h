@@ -47,6 +47,16 @@ xi_time_t xi_bsp_time_getcurrenttime_seconds();
  */
 xi_time_t xi_bsp_time_getcurrenttime_milliseconds();
 
+/**
+ * @function
+ * @brief Returns microseconds elapsed since an arbitrary point of time.
+ *
+ * The clock must not go back nor jump with the wall clock, only the difference of two
+ * values is used. It is called only by a library built with XI_STATS_LAYER_TIMING set
+ * to 1 in order to time the layer calls, other builds do not need an implementation.
+ */
+xi_time_t xi_bsp_time_getmonotonictime_microseconds();
+
 #ifdef __cplusplus
 }
 #endif
@@ -226,6 +226,59 @@ extern xi_state_t xi_events_process_tick();
  */
 extern void xi_events_stop();
 
+/**
+ * @brief     Reports what the Xively Client waits for, for applications that run
+ * their own event loop instead of xi_events_process_blocking or
+ * xi_events_process_tick.
+ * @detailed  The application waits on the sockets returned, in its own poll, epoll or
+ * libuv loop, until one of them is ready or timeout_ms passes. Then it calls
+ * xi_notify_fd_ready or xi_notify_timeout. Any of these calls can change the sockets
+ * and the timeout, so xi_events_get_fds has to be called again after each of them.
+ *
+ * All of the calls have to be made from a single thread.
+ *
+ * @param [out] fds filled with the sockets and the xi_fd_event_t bits they wait for
+ * @param [in] max_fds capacity of fds
+ * @param [out] fds_count number of the sockets, if fds is too small it is the
+ * capacity required
+ * @param [out] timeout_ms time after which xi_notify_timeout has to be called, -1 if
+ * nothing is scheduled
+ *
+ * @see xi_notify_fd_ready
+ * @see xi_notify_timeout
+ *
+ * @retval XI_STATE_OK fds and timeout_ms have been filled in
+ * @retval XI_BUFFER_OVERFLOW if fds is too small
+ * @retval XI_INVALID_PARAMETER if any of the pointers is NULL
+ * @retval XI_EVENT_PROCESS_STOPPED if xi_events_stop has been invoked
+ */
+extern xi_state_t xi_events_get_fds( xi_fd_interest_t* fds,
+                                     size_t max_fds,
+                                     size_t* fds_count,
+                                     xi_time_t* timeout_ms );
+
+/**
+ * @brief     Processes the readiness of a socket returned by xi_events_get_fds,
+ * along with any timed events that are due.
+ *
+ * @param [in] fd the socket that is ready
+ * @param [in] events xi_fd_event_t bits of the readiness
+ *
+ * @retval XI_STATE_OK the events have been processed
+ * @retval XI_FD_HANDLER_NOT_FOUND if the socket has been closed meanwhile
+ * @retval XI_EVENT_PROCESS_STOPPED if xi_events_stop has been invoked
+ */
+extern xi_state_t xi_notify_fd_ready( intptr_t fd, uint8_t events );
+
+/**
+ * @brief     Processes the timed events that are due, to be called once the timeout
+ * returned by xi_events_get_fds has passed.
+ *
+ * @retval XI_STATE_OK the events have been processed
+ * @retval XI_EVENT_PROCESS_STOPPED if xi_events_stop has been invoked
+ */
+extern xi_state_t xi_notify_timeout();
+
 /**
  * @brief Files set by this function will be kept updated by the Xively C Client.
  *
@@ -276,6 +329,64 @@ extern xi_state_t xi_set_updateable_files( xi_context_handle_t xih,
                                            uint16_t count,
                                            xi_sft_url_handler_callback_t* url_handler );
 
+/**
+ * @brief Tunes the MQTT file download of the Secure File Transfer (SFT) process.
+ *
+ * Files are downloaded in chunks requested by FILE_GET_CHUNK messages. Instead of
+ * waiting for each chunk before requesting the next one the Xively C Client keeps
+ * `window` requests outstanding, so a download takes roughly `window` times less
+ * broker round-trips. Chunks may arrive out of order, they are written at their offset
+ * and held in memory only until the checksum calculation reaches them, so the peak
+ * memory use is about `window * chunk_size` bytes.
+ *
+ * The `chunk_size` is the requested length of a chunk. If the SFT service serves
+ * shorter chunks the client continues with the service's chunk size.
+ *
+ * This function must be called prior to `xi_connect`.
+ *
+ * @param [in] xih a context handle created by invoking xi_create_context
+ * @param [in] window number of outstanding FILE_GET_CHUNK requests, at most
+ *                    XI_SFT_FILE_CHUNK_WINDOW_MAX, 0 selects the default
+ *                    XI_SFT_FILE_CHUNK_WINDOW
+ * @param [in] chunk_size requested chunk length in bytes, 0 selects the default
+ *                        XI_SFT_FILE_CHUNK_SIZE
+ *
+ * @retval XI_STATE_OK if the values are set, an error value otherwise.
+ */
+extern xi_state_t xi_set_sft_download_window( xi_context_handle_t xih,
+                                              uint16_t window,
+                                              uint32_t chunk_size );
+
+/**
+ * @brief Lets the Secure File Transfer (SFT) process download several files of an
+ * update package at the same time.
+ *
+ * By default the files of a package are downloaded one after the other in the order
+ * given by `xi_bsp_fwu_order_resource_downloads`. With `max_files` greater than one
+ * the next files are started while the previous ones are still downloading, each with
+ * its own file handle, checksum calculation and window of FILE_GET_CHUNK requests.
+ *
+ * The `memory_budget` bounds the bytes all of the downloads have requested but not
+ * received yet plus the bytes received out of order and waiting for the checksum.
+ * No new file is started and no further chunk is requested while the budget is used
+ * up. `xi_bsp_fwu_on_package_download_finished` is still called once, after every
+ * file of the package is verified.
+ *
+ * This function must be called prior to `xi_connect`.
+ *
+ * @param [in] xih a context handle created by invoking xi_create_context
+ * @param [in] max_files number of files downloaded at the same time, at most
+ *                       XI_SFT_PARALLEL_DOWNLOADS_MAX, 0 selects the default
+ *                       XI_SFT_PARALLEL_DOWNLOADS
+ * @param [in] memory_budget in bytes, 0 selects the default
+ *                           XI_SFT_DOWNLOAD_MEMORY_BUDGET
+ *
+ * @retval XI_STATE_OK if the values are set, an error value otherwise.
+ */
+extern xi_state_t xi_set_sft_parallel_downloads( xi_context_handle_t xih,
+                                                 uint16_t max_files,
+                                                 uint32_t memory_budget );
+
 /**
  * @brief     Opens a connection to the xively service using the provided context,
  * includes a callback.
@@ -679,6 +790,221 @@ extern xi_state_t xi_publish_data( xi_context_handle_t xih,
                                    xi_user_callback_t* callback,
                                    void* user_data );
 
+/**
+ * @brief     Publishes binary data to the Xively Service on a given topic, ahead of the
+ * publications of the lower priority classes.
+ * @detailed  Works like xi_publish_data, except that the publication is of the given
+ * class while the ones of xi_publish_data are of the XI_PUBLISH_PRIORITY_NORMAL class.
+ * The outgoing messages waiting for the connection, as well as the ones in the offline
+ * queue, are sent in the order of their class and in the order they were requested
+ * within a class. The message being written to the socket is never interrupted, so an
+ * alarm waits for at most one message in front of it.
+ *
+ * The time from the request to the write of each class is gathered by the library
+ * statistics, see xi_get_stats.
+ *
+ * @param [in] priority the class of the publication, one of xi_publish_priority_t
+ *
+ * @see xi_publish_data
+ *
+ * @retval XI_STATE_OK If the publication request was formatted correctly.
+ * @retval XI_INVALID_PARAMETER If the priority is not one of the classes.
+ * @retval XI_OUT_OF_MEMORY   If the platform did not have enough free memory to
+ * fulfill the request
+ */
+extern xi_state_t xi_publish_data_with_priority( xi_context_handle_t xih,
+                                                 const char* topic,
+                                                 const uint8_t* data,
+                                                 size_t data_len,
+                                                 const xi_mqtt_qos_t qos,
+                                                 const xi_mqtt_retain_t retain,
+                                                 const xi_publish_priority_t priority,
+                                                 xi_user_callback_t* callback,
+                                                 void* user_data );
+
+/**
+ * @brief     Enables the store-and-forward queue for publications made while offline.
+ * @detailed  Once enabled, every publication requested while the context is not
+ * connected, or while the client is in backoff, is kept in a bounded in-memory queue
+ * instead of being rejected with XI_BACKOFF_TERMINAL. After the next successful connect
+ * the queue is drained at most drain_rate messages per second, by class from
+ * XI_PUBLISH_PRIORITY_ALARM down to XI_PUBLISH_PRIORITY_BULK and in FIFO order within
+ * a class.
+ *
+ * If spool_file_name is given, messages that do not fit in memory are spilled to that
+ * resource through the filesystem functions (see xi_set_fs_functions). The spool survives
+ * a restart of the application: a non-empty spool found while enabling the queue is
+ * drained first, starting after the last message the previous run has drained. The
+ * drain position is kept in a second resource, the spool name suffixed with ".offset".
+ * Spooled messages lose their completion callback, it is invoked with XI_STATE_OK as
+ * soon as the message is safely written to the spool.
+ *
+ * When both memory and spool are full the oldest queued message of the lowest priority
+ * class is dropped and its callback invoked with XI_BACKOFF_TERMINAL. Once messages have
+ * been spilled to the spool, a new one the full spool can't take is dropped instead, so
+ * that it doesn't overtake the spooled ones. The publications above
+ * XI_PUBLISH_PRIORITY_NORMAL are kept in memory whenever possible and drained ahead of
+ * the others, see xi_publish_data_with_priority. The spool doesn't store the class,
+ * spooled messages are drained as XI_PUBLISH_PRIORITY_NORMAL.
+ *
+ * @param [in] xih a context handle created by invoking xi_create_context
+ * @param [in] max_messages maximum number of messages kept in memory, must be > 0
+ * @param [in] max_bytes maximum sum of payload sizes kept in memory, 0 means no limit
+ * @param [in] drain_rate messages published per second after reconnect, 0 means all at
+ * once
+ * @param [in] spool_file_name Optional name of the spool resource. This may be NULL.
+ *
+ * @see xi_get_offline_publish_queue_stats
+ *
+ * @retval XI_STATE_OK the queue has been enabled
+ * @retval XI_INVALID_PARAMETER if the context handle or max_messages is invalid
+ * @retval XI_ALREADY_INITIALIZED if the queue was already enabled on this context
+ * @retval XI_OUT_OF_MEMORY if the platform did not have enough free memory
+ */
+extern xi_state_t xi_set_offline_publish_queue( xi_context_handle_t xih,
+                                                size_t max_messages,
+                                                size_t max_bytes,
+                                                uint16_t drain_rate,
+                                                const char* spool_file_name );
+
+/**
+ * @brief     Fetches the counters of the offline publish queue.
+ *
+ * @param [in] xih a context handle created by invoking xi_create_context
+ * @param [out] stats filled with the current queue depth, bytes and drop counts
+ *
+ * @see xi_set_offline_publish_queue
+ *
+ * @retval XI_STATE_OK stats has been filled in
+ * @retval XI_INVALID_PARAMETER if the context handle or stats is invalid
+ * @retval XI_NOT_INITIALIZED if the queue is not enabled on this context
+ */
+extern xi_state_t xi_get_offline_publish_queue_stats( xi_context_handle_t xih,
+                                                      xi_publish_queue_stats_t* stats );
+
+/**
+ * @brief     Makes the MQTT session of XI_SESSION_CONTINUE survive a restart of the
+ * application.
+ * @detailed  QoS1 publications that have been sent but not acknowledged by the broker
+ * are recorded in log_file_name through the filesystem functions (see
+ * xi_set_fs_functions). Compaction of the log alternates between log_file_name and
+ * log_file_name suffixed with ".alt", so that one complete log always exists. A log
+ * left by a previous run is picked up by this call and the publications recorded in it
+ * are sent again, with the DUP flag and their original message ids, by the first
+ * xi_connect with XI_SESSION_CONTINUE. Replayed publications have no completion
+ * callback. A connection with XI_SESSION_CLEAN discards the log.
+ *
+ * The log has to be enabled before xi_connect is called.
+ *
+ * @param [in] xih a context handle created by invoking xi_create_context
+ * @param [in] log_file_name name of the session log resource
+ *
+ * @retval XI_STATE_OK the session log has been enabled
+ * @retval XI_INVALID_PARAMETER if the context handle or log_file_name is invalid
+ * @retval XI_ALREADY_INITIALIZED if the session log was already enabled on this context
+ * @retval XI_OUT_OF_MEMORY if the platform did not have enough free memory
+ */
+extern xi_state_t xi_set_persistent_session( xi_context_handle_t xih,
+                                             const char* log_file_name );
+
+/**
+ * @brief     Fetches the MQTT keepalive counters of a context.
+ *
+ * A PINGREQ is sent only if nothing else has been sent for the keepalive interval,
+ * pings_avoided counts the keepalive expiries which found other traffic instead.
+ *
+ * @param [in] xih a context handle created by invoking xi_create_context
+ * @param [out] stats filled with the number of pings sent and avoided
+ *
+ * @retval XI_STATE_OK stats has been filled in
+ * @retval XI_INVALID_PARAMETER if the context handle or stats is invalid
+ */
+extern xi_state_t xi_get_keepalive_stats( xi_context_handle_t xih,
+                                          xi_keepalive_stats_t* stats );
+
+/**
+ * @brief     Fetches the counters of the event loop, the layers and the allocator.
+ *
+ * The counters are shared by all the contexts, only the keepalive counters are taken
+ * from the given context. They are updated without synchronisation so they are to be
+ * read as approximate if the event loop runs on another thread. The latency histogram
+ * bucket n counts the layer calls which took less than 2^n microseconds, the last
+ * bucket counts all the longer ones. The layer calls are timed only if the library is
+ * built with XI_STATS_LAYER_TIMING=1, which reads the monotonic clock of the BSP twice
+ * per call, otherwise they are only counted.
+ *
+ * @param [in] xih a context handle created by invoking xi_create_context
+ * @param [out] stats filled with a snapshot of the counters
+ *
+ * @retval XI_STATE_OK stats has been filled in
+ * @retval XI_INVALID_PARAMETER if the context handle or stats is invalid
+ */
+extern xi_state_t xi_get_stats( xi_context_handle_t xih, xi_stats_t* stats );
+
+/**
+ * @brief     Zeroes the counters returned by xi_get_stats.
+ */
+extern void xi_reset_stats( void );
+
+/**
+ * @brief     Enables the trace of the hot path events.
+ *
+ * The layer calls, event loop iterations and event dispatcher steps are written into
+ * the ring buffer given, the oldest events are overwritten once it is full. The
+ * buffer is owned by the application and has to stay valid until the trace is
+ * disabled by passing NULL. Nothing is traced by default.
+ *
+ * @param [in] events ring buffer for the trace events or NULL
+ * @param [in] events_count number of the events the buffer can hold
+ */
+extern void
+xi_set_stats_trace_buffer( xi_stats_trace_event_t* events, size_t events_count );
+
+/**
+ * @brief     Copies the trace events out of the ring buffer.
+ *
+ * Safe to call from another thread than the event loop one when the library is built
+ * with a compiler providing the __atomic builtins (GCC, clang), from the event loop
+ * thread only otherwise. Events overwritten before they could be copied are skipped,
+ * the gaps can be spotted in the sequence numbers.
+ *
+ * @param [out] events filled with the events in order
+ * @param [in] max_events capacity of events
+ * @param [in,out] sequence the sequence number of the first event to copy, 0 to
+ * start from the oldest, on return the one to pass to the next call
+ * @param [out] events_count number of the events copied
+ *
+ * @retval XI_STATE_OK the events have been copied
+ * @retval XI_INVALID_PARAMETER if any of the pointers is NULL
+ */
+extern xi_state_t xi_get_stats_trace( xi_stats_trace_event_t* events,
+                                      size_t max_events,
+                                      uint32_t* sequence,
+                                      size_t* events_count );
+
+/**
+ * @brief     Starts recording the network traffic of the connections.
+ *
+ * Every connection made from now on gets its bytes read and written, timestamped,
+ * appended to the given file through the file system BSP. The recording can be fed
+ * back to the client with the replay io layer of the tests to reproduce the session
+ * without a broker. With TLS enabled the recorded bytes are encrypted. Nothing is
+ * recorded by default.
+ *
+ * @param [in] resource_name name of the file to record into, it is truncated
+ *
+ * @retval XI_STATE_OK the capture has been started
+ * @retval XI_INVALID_PARAMETER if resource_name is NULL
+ * @retval XI_FS_OPEN_ERROR or another file system error if the file could not be
+ * opened or written
+ */
+extern xi_state_t xi_start_net_capture( const char* resource_name );
+
+/**
+ * @brief     Stops the recording started by xi_start_net_capture and closes the file.
+ */
+extern void xi_stop_net_capture( void );
+
 /**
  * @brief     Subscribes to request notifications if a message from the xively
  * service is posted to the given topic.
@@ -731,6 +1057,62 @@ extern xi_state_t xi_subscribe( xi_context_handle_t xih,
                                 xi_user_subscription_callback_t* callback,
                                 void* user_data );
 
+/**
+ * @brief     Subscribes to several topics with a single MQTT SUBSCRIBE message.
+ * @detailed  Works as a sequence of xi_subscribe calls but the whole batch is sent
+ * in one message and acknowledged by one SUBACK. Each topic filter keeps its own
+ * callback which gets the subscription result of that topic filter.
+ *
+ * @param [in] xih a context handle created by invoking xi_create_context
+ * @param [in] subscriptions topic filters with their qos, callbacks and user data,
+ * the strings are copied
+ * @param [in] count number of elements of subscriptions
+ *
+ * @see xi_subscribe
+ *
+ * @retval XI_STATE_OK If the subscription request was formatted correctly.
+ * @retval XI_INVALID_PARAMETER if a topic or a callback is missing or count is 0
+ * @retval XI_OUT_OF_MEMORY   If the platform did not have enough free memory to
+ * fulfill the request
+ */
+extern xi_state_t xi_subscribe_many( xi_context_handle_t xih,
+                                     const xi_subscription_t* subscriptions,
+                                     size_t count );
+
+/**
+ * @brief     Unsubscribes from a topic subscribed with xi_subscribe.
+ * @detailed  Once the broker acknowledged the request the subscription callbacks of
+ * the topic are released and the callback is invoked with XI_STATE_OK. The topic
+ * has to match the subscribed topic filter exactly.
+ *
+ * @param [in] xih a context handle created by invoking xi_create_context
+ * @param [in] topic the topic filter to unsubscribe from
+ * @param [in] callback optional, invoked with the result of the request
+ * @param [in] user_data a pointer that will be passed to the callback
+ *
+ * @retval XI_STATE_OK If the unsubscribe request was formatted correctly.
+ * @retval XI_INVALID_PARAMETER if the topic is missing
+ * @retval XI_OUT_OF_MEMORY   If the platform did not have enough free memory to
+ * fulfill the request
+ */
+extern xi_state_t xi_unsubscribe( xi_context_handle_t xih,
+                                  const char* topic,
+                                  xi_user_callback_t* callback,
+                                  void* user_data );
+
+/**
+ * @brief     Unsubscribes from several topics with a single MQTT UNSUBSCRIBE message.
+ * @detailed  MQTT 3.1.1 acknowledges the whole batch at once, so the callback is
+ * invoked once for all of the topics.
+ *
+ * @see xi_unsubscribe
+ */
+extern xi_state_t xi_unsubscribe_many( xi_context_handle_t xih,
+                                       const char* const* topics,
+                                       size_t count,
+                                       xi_user_callback_t* callback,
+                                       void* user_data );
+
 /**
  * @brief     Closes the connection associated with the provide context.
  * @detailed  Closes connection to the Xively Service.  This will happen asynchronously.
@@ -149,6 +149,20 @@ typedef void( xi_user_subscription_callback_t )( xi_context_handle_t in_context_
                                                  xi_state_t state,
                                                  void* user_data );
 
+/**
+ * @name  xi_subscription_t
+ * @brief one topic filter of a batched subscription
+ *
+ * @see xi_subscribe_many
+ */
+typedef struct xi_subscription_s
+{
+    const char* topic;
+    xi_mqtt_qos_t qos;
+    xi_user_subscription_callback_t* callback; /* per topic, same as of xi_subscribe */
+    void* user_data;
+} xi_subscription_t;
+
 /**
  * @name  xi_sft_on_file_downloaded_callback_t
  * @brief At a the end of a Secure File Transfer (SFT) HTTP file download the application
@@ -239,6 +253,164 @@ typedef uint8_t( xi_sft_url_handler_callback_t )(
     xi_sft_on_file_downloaded_callback_t* fn_on_file_downloaded_callback,
     void* callback_data );
 
+/**
+ * @name  xi_publish_priority_t
+ * @brief priority class of a publication
+ *
+ * A publication of a higher class is sent ahead of the ones of the lower classes that
+ * are still waiting in the outbound queues. The publications of one class keep their
+ * order.
+ *
+ * @see xi_publish_data_with_priority
+ */
+typedef enum xi_publish_priority_e {
+    XI_PUBLISH_PRIORITY_BULK = 0, /* e.g. log uploads, sent when nothing else waits */
+    XI_PUBLISH_PRIORITY_NORMAL,   /* the class of xi_publish and the like */
+    XI_PUBLISH_PRIORITY_ALARM,    /* sent before anything else queued */
+    XI_PUBLISH_PRIORITY_COUNT
+} xi_publish_priority_t;
+
+/**
+ * @name  xi_publish_queue_stats_t
+ * @brief snapshot of the offline publish queue counters of a context
+ *
+ * @see xi_set_offline_publish_queue xi_get_offline_publish_queue_stats
+ */
+typedef struct xi_publish_queue_stats_s
+{
+    size_t queued_messages;  /* messages held in RAM */
+    size_t queued_bytes;     /* payload bytes held in RAM */
+    size_t spooled_messages; /* messages held in the spool file */
+    size_t spooled_bytes;    /* bytes held in the spool file, record headers included */
+    uint32_t dropped_messages; /* messages discarded because the queue was full */
+    uint32_t drained_messages; /* handed over to the MQTT layer after reconnect */
+} xi_publish_queue_stats_t;
+
+/**
+ * @name  xi_keepalive_stats_t
+ * @brief MQTT keepalive counters of a context, accumulated over its connections
+ *
+ * @see xi_get_keepalive_stats
+ */
+typedef struct xi_keepalive_stats_s
+{
+    uint32_t pings_sent;    /* PINGREQ messages sent */
+    uint32_t pings_avoided; /* expiries skipped since other messages went out */
+} xi_keepalive_stats_t;
+
+/* size of the per layer table of xi_stats_t, higher layer type ids are not counted */
+#define XI_STATS_LAYERS_COUNT 8
+
+/* bucket i of a latency histogram counts the values shorter than 2^i units that did
+ * not fit a lower bucket, the last bucket counts all of the longer ones, the unit is
+ * the microsecond for the layer calls and the millisecond for the publications */
+#define XI_STATS_LATENCY_BUCKETS_COUNT 12
+
+/**
+ * @name  xi_layer_stats_t
+ * @brief calls of the functions of one layer and their durations in microseconds, the
+ * duration of a call includes whatever it executed directly on the other layers
+ *
+ * The durations are measured only if the library is built with XI_STATS_LAYER_TIMING
+ * set to 1, the histogram stays empty otherwise.
+ */
+typedef struct xi_layer_stats_s
+{
+    uint32_t calls;
+    uint32_t latency_histogram[XI_STATS_LATENCY_BUCKETS_COUNT];
+} xi_layer_stats_t;
+
+/**
+ * @name  xi_publish_priority_stats_t
+ * @brief publications of one priority class written to the socket and the time they
+ * spent in the outbound queues of the layers, from the publish call or from the drain
+ * of the offline queue to the end of the write
+ */
+typedef struct xi_publish_priority_stats_s
+{
+    uint32_t messages;
+    uint32_t latency_max_ms;
+    uint64_t latency_total_ms; /* divided by messages gives the mean latency */
+    uint32_t latency_histogram[XI_STATS_LATENCY_BUCKETS_COUNT];
+} xi_publish_priority_stats_t;
+
+/**
+ * @name  xi_stats_t
+ * @brief process wide counters of the event loop and the layers plus the keepalive
+ * counters of a context
+ *
+ * The counters are updated without synchronisation, values read while the event loop
+ * runs on another thread are approximate.
+ *
+ * @see xi_get_stats
+ */
+typedef struct xi_stats_s
+{
+    xi_layer_stats_t layers[XI_STATS_LAYERS_COUNT]; /* indexed by the layer type id */
+    uint32_t evtd_steps;             /* event dispatcher steps */
+    uint32_t evtd_queue_depth_max;   /* most handles run from the queue by one step */
+    uint32_t evtd_steps_over_budget; /* steps that left handles queued for the next */
+    uint32_t timer_heap_size;        /* time events pending at the last step */
+    uint32_t timer_heap_size_max;
+    uint32_t select_calls;
+    uint32_t select_ready_calls; /* select calls that returned with a socket ready */
+    uint64_t select_wait_ms;     /* time blocked in select */
+    uint64_t select_ready_ms;    /* time spent on the events that followed select */
+    uint64_t bytes_in;           /* read from the sockets */
+    uint64_t bytes_out;          /* written to the sockets */
+    uint32_t messages_in;        /* MQTT messages decoded */
+    uint32_t messages_out;       /* MQTT messages sent */
+    uint32_t allocations;        /* divided by messages gives allocations per message */
+    xi_publish_priority_stats_t publish[XI_PUBLISH_PRIORITY_COUNT]; /* by the class */
+    xi_keepalive_stats_t keepalive;
+} xi_stats_t;
+
+typedef enum xi_stats_trace_event_type_e {
+    XI_STATS_TRACE_LAYER_CALL = 0, /* id: layer type id, value: duration in us or 0 */
+    XI_STATS_TRACE_SELECT,         /* id: 1 if a socket was ready, value: wait in ms */
+    XI_STATS_TRACE_EVTD_STEP       /* id: 0, value: handles run from the queue */
+} xi_stats_trace_event_type_t;
+
+/**
+ * @name  xi_stats_trace_event_t
+ * @brief entry of the trace ring buffer
+ *
+ * @see xi_set_stats_trace_buffer
+ */
+typedef struct xi_stats_trace_event_s
+{
+    uint32_t sequence; /* number of the event since the buffer has been set */
+    uint32_t timestamp_ms;
+    uint16_t type; /* xi_stats_trace_event_type_t */
+    uint16_t id;
+    uint32_t value;
+} xi_stats_trace_event_t;
+
+/**
+ * @name  xi_fd_event_t
+ * @brief readiness of a socket, bits of xi_fd_interest_t's events
+ *
+ * @see xi_events_get_fds xi_notify_fd_ready
+ */
+typedef enum xi_fd_event_e {
+    XI_FD_EVENT_NONE  = 0,
+    XI_FD_EVENT_READ  = 1 << 0,
+    XI_FD_EVENT_WRITE = 1 << 1,
+    XI_FD_EVENT_ERROR = 1 << 2
+} xi_fd_event_t;
+
+/**
+ * @name  xi_fd_interest_t
+ * @brief socket the library waits on and the events it waits for
+ *
+ * @see xi_events_get_fds
+ */
+typedef struct xi_fd_interest_s
+{
+    intptr_t fd;
+    uint8_t events; /* xi_fd_event_t bits */
+} xi_fd_interest_t;
+
 #ifdef __cplusplus
 }
 #endif
@@ -8,6 +8,8 @@
 #define __XIVELY_SENML_H__
 
 #include <xively_error.h>
+#include <xively_mqtt.h>
+#include <xively_types.h>
 
 #include <xively_senml_macros.h>
 #include <xively_senml_types.h>
@@ -73,6 +75,59 @@ extern xi_state_t xi_senml_serialize( xi_senml_t* senml_structure,
                                       uint8_t** out_buffer,
                                       uint32_t* out_size );
 
+/**
+ * @name xi_senml_serialize_as
+ * @brief Serializes a senml structure in the requested format.
+ *
+ * Works like xi_senml_serialize. With XI_SENML_FORMAT_CBOR the output is SenML CBOR
+ * as defined by RFC 8428: an array of records keyed by integer labels, float values
+ * encoded as integers, half or single precision floats whichever is the shortest
+ * exact one. This is usually a third of the size of the JSON output.
+ *
+ * @param [in] senml_structure the structure to be serialized
+ * @param [in] format XI_SENML_FORMAT_JSON or XI_SENML_FORMAT_CBOR
+ * @param [out] out_buffer this buffer will contain the serialized document, memory is
+ *                         allocated inside
+ * @param [out] out_size the size of the serialized document
+ *
+ * @retval XI_STATE_OK if succeeded, other in case of failure,
+ *         see xively_error.h for error codes
+ */
+extern xi_state_t xi_senml_serialize_as( xi_senml_t* senml_structure,
+                                         xi_senml_format_t format,
+                                         uint8_t** out_buffer,
+                                         uint32_t* out_size );
+
+/**
+ * @name xi_publish_senml
+ * @brief Serializes a senml structure and publishes it on the given topic.
+ *
+ * The serialized document is handed over to the publish directly, there is no
+ * intermediate buffer to copy and free. The senml structure is not needed after the
+ * call returns, it can be destroyed or reused. Parameters and the callback are the same
+ * as of xi_publish.
+ *
+ * @param [in] xih a context handle created by invoking xi_create_context
+ * @param [in] topic the topic to publish the document on
+ * @param [in] senml_structure the structure to be published
+ * @param [in] format XI_SENML_FORMAT_JSON or XI_SENML_FORMAT_CBOR
+ * @param [in] qos Quality of Service MQTT level
+ * @param [in] retain retain flag of the MQTT message
+ * @param [in] callback optional function called when the message has been sent
+ * @param [in] user_data optional data passed to the callback
+ *
+ * @retval XI_STATE_OK if succeeded, other in case of failure,
+ *         see xively_error.h for error codes
+ */
+extern xi_state_t xi_publish_senml( xi_context_handle_t xih,
+                                    const char* topic,
+                                    xi_senml_t* senml_structure,
+                                    xi_senml_format_t format,
+                                    const xi_mqtt_qos_t qos,
+                                    const xi_mqtt_retain_t retain,
+                                    xi_user_callback_t* callback,
+                                    void* user_data );
+
 /**
  * @name xi_create_senml_struct
  * @brief Allocates and initializes a senml structure, recommended usage through the API
@@ -108,6 +163,95 @@ extern xi_state_t xi_create_senml_struct( xi_senml_t** senml_ptr, int count, ...
  */
 extern xi_state_t xi_add_senml_entry( xi_senml_t* senml_ptr, int count, ... );
 
+/**
+ * @name xi_init_senml_writer
+ * @brief Prepares a streaming writer which serializes senml entries right into a
+ *        caller provided buffer, recommended usage through the API macros
+ *        XI_INIT_SENML_WRITER or XI_INIT_SENML_EMPTY_WRITER.
+ *
+ * Unlike xi_senml_t the writer allocates no memory and copies no strings, memory use
+ * stays the same regardless of the number of entries. Entries are appended with
+ * XI_APPEND_SENML_ENTRY, the document is completed with xi_flush_senml_writer.
+ *
+ * Example usage:
+ *
+ *     uint8_t buffer[512];
+ *     xi_senml_writer_t writer;
+ *     xi_state_t state = XI_STATE_OK;
+ *
+ *     XI_INIT_SENML_WRITER( state, &writer, XI_SENML_FORMAT_CBOR, buffer,
+ *                           sizeof( buffer ), XI_SENML_BASE_NAME( "thermostat" ) );
+ *
+ *     for ( ;; )
+ *     {
+ *         XI_APPEND_SENML_ENTRY( state, &writer, XI_SENML_ENTRY_NAME( "kitchen" ),
+ *                                XI_SENML_ENTRY_FLOAT_VALUE( read_sensor() ) );
+ *
+ *         if ( XI_BUFFER_OVERFLOW == state )
+ *         {
+ *             const uint8_t* document = NULL;
+ *             uint32_t document_size = 0;
+ *
+ *             xi_flush_senml_writer( &writer, &document, &document_size );
+ *             xi_publish_data( xih, "topic", document, document_size, ... );
+ *             // and append the entry again
+ *         }
+ *     }
+ *
+ * @param [out] writer the writer to initialize
+ * @param [in] format XI_SENML_FORMAT_JSON or XI_SENML_FORMAT_CBOR
+ * @param [in] buffer the output buffer, it has to outlive the writer
+ * @param [in] capacity the size of the output buffer
+ * @param [in] count number of following parameters, filled properly by API macro
+ * @param [in] ... base value descriptors usually created by XI_SENML_BASE_*
+ *
+ * @retval XI_STATE_OK if succeeded, XI_BUFFER_OVERFLOW if not even an empty document
+ *         fits into the buffer, other in case of failure, see xively_error.h
+ */
+extern xi_state_t xi_init_senml_writer( xi_senml_writer_t* writer,
+                                        xi_senml_format_t format,
+                                        uint8_t* buffer,
+                                        uint32_t capacity,
+                                        int count,
+                                        ... );
+
+/**
+ * @name xi_append_senml_entry
+ * @brief Serializes an entry into the document of a streaming writer, recommended
+ *        usage through the API macro XI_APPEND_SENML_ENTRY.
+ *
+ * Room for completing the document is always kept in the buffer. If the entry does
+ * not fit the writer is left intact and XI_BUFFER_OVERFLOW is returned, the document
+ * has to be flushed before the entry is appended again.
+ *
+ * @param [in] writer the writer to append to
+ * @param [in] count number of following parameters, filled properly by API macro
+ * @param [in] ... entry field descriptors usually created by XI_SENML_ENTRY_* and
+ *                 XI_SENML_ENTRY_*_VALUE
+ *
+ * @retval XI_STATE_OK if succeeded, XI_BUFFER_OVERFLOW if the entry does not fit, other
+ *         in case of failure, see xively_error.h for error codes
+ */
+extern xi_state_t xi_append_senml_entry( xi_senml_writer_t* writer, int count, ... );
+
+/**
+ * @name xi_flush_senml_writer
+ * @brief Completes the document of the appended entries.
+ *
+ * The document stays in the writer's buffer until the next entry is appended, which
+ * starts a new document with the same base fields at the beginning of the buffer.
+ *
+ * @param [in] writer the writer to flush
+ * @param [out] out_document points to the document in the writer's buffer
+ * @param [out] out_size the size of the document
+ *
+ * @retval XI_STATE_OK if succeeded, other in case of failure,
+ *         see xively_error.h for error codes
+ */
+extern xi_state_t xi_flush_senml_writer( xi_senml_writer_t* writer,
+                                         const uint8_t** out_document,
+                                         uint32_t* out_size );
+
 /**
  * @name xi_senml_free_buffer
  * @brief Releases the buffer memory allocated by the serializer function.
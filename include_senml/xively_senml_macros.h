@@ -73,6 +73,59 @@
             XI_SENML_ENTRY3( __VA_ARGS__ ), XI_SENML_ENTRY2( __VA_ARGS__ ),              \
             XI_SENML_ENTRY1( __VA_ARGS__ ) ) );
 
+/**
+ * @name XI_INIT_SENML_EMPTY_WRITER
+ * @brief Initializes a streaming senml writer with no base name, time, units set.
+ *
+ * @param [out] state the return state of the action, XI_STATE_OK in case of success
+ * @param [out] writer_ptr a pointer to the xi_senml_writer_t to initialize
+ * @param [in] format XI_SENML_FORMAT_JSON or XI_SENML_FORMAT_CBOR
+ * @param [in] buffer the output buffer the documents are written into
+ * @param [in] capacity the size of the output buffer
+ */
+#define XI_INIT_SENML_EMPTY_WRITER( state, writer_ptr, format, buffer, capacity )        \
+    state = xi_init_senml_writer( writer_ptr, format, buffer, capacity, 0 );
+
+/**
+ * @name XI_INIT_SENML_WRITER
+ * @brief Initializes a streaming senml writer with at least one set from base name,
+ *        unit and time.
+ *
+ * @param [out] state the return state of the action, XI_STATE_OK in case of success
+ * @param [out] writer_ptr a pointer to the xi_senml_writer_t to initialize
+ * @param [in] format XI_SENML_FORMAT_JSON or XI_SENML_FORMAT_CBOR
+ * @param [in] buffer the output buffer the documents are written into
+ * @param [in] capacity the size of the output buffer
+ * @param [in] ... base field descriptors at most 3 created by the XI_SENML_BASE_*
+ *                 macros. The strings are not copied, they have to outlive the writer.
+ */
+#define XI_INIT_SENML_WRITER( state, writer_ptr, format, buffer, capacity, ... )         \
+    state = xi_init_senml_writer(                                                        \
+        writer_ptr, format, buffer, capacity,                                            \
+        XI_SENML_ENTRY_IMPL( __VA_ARGS__, XI_SENML_ENTRY_ERROR( __VA_ARGS__ ),           \
+                             XI_SENML_ENTRY_ERROR( __VA_ARGS__ ), 3, 2, 1 ),             \
+        XI_SENML_ENTRY_IMPL(                                                             \
+            __VA_ARGS__, XI_SENML_ENTRY_ERROR( __VA_ARGS__ ),                            \
+            XI_SENML_ENTRY_ERROR( __VA_ARGS__ ), XI_SENML_ENTRY3( __VA_ARGS__ ),         \
+            XI_SENML_ENTRY2( __VA_ARGS__ ), XI_SENML_ENTRY1( __VA_ARGS__ ) ) );
+
+/**
+ * @name XI_APPEND_SENML_ENTRY
+ * @brief Writes an entry into the document of a streaming senml writer.
+ *
+ * @param [out] state the return state of the action, XI_STATE_OK in case of success,
+ *                    XI_BUFFER_OVERFLOW if the entry does not fit into the buffer
+ * @param [in] writer_ptr a pointer to an initialized xi_senml_writer_t
+ * @param [in] ... entry field descriptors at most 5, the same as of XI_ADD_SENML_ENTRY
+ */
+#define XI_APPEND_SENML_ENTRY( state, writer_ptr, ... )                                  \
+    state = xi_append_senml_entry(                                                       \
+        writer_ptr, XI_SENML_ENTRY_IMPL( __VA_ARGS__, 5, 4, 3, 2, 1 ),                   \
+        XI_SENML_ENTRY_IMPL(                                                             \
+            __VA_ARGS__, XI_SENML_ENTRY5( __VA_ARGS__ ), XI_SENML_ENTRY4( __VA_ARGS__ ), \
+            XI_SENML_ENTRY3( __VA_ARGS__ ), XI_SENML_ENTRY2( __VA_ARGS__ ),              \
+            XI_SENML_ENTRY1( __VA_ARGS__ ) ) );
+
 #define XI_SENML_BASE_NAME( bn )                                                         \
     ( ( xi_senml_t ){.base_name = bn, .set.base_name_set = 1} )
 
@@ -35,6 +35,12 @@ typedef enum xi_senml_value_type_e {
     XI_SENML_VALUE_TYPE_BOOLEAN
 } xi_senml_value_type_t;
 
+/* output formats of the serializer, CBOR uses the integer labels of RFC 8428 */
+typedef enum xi_senml_format_e {
+    XI_SENML_FORMAT_JSON = 0,
+    XI_SENML_FORMAT_CBOR
+} xi_senml_format_t;
+
 typedef union xi_senml_value_u {
     float float_value;
     char* string_value;
@@ -69,6 +75,20 @@ typedef struct xi_senml_s
     struct xi_senml_entry_s* entries_list;
 } xi_senml_t;
 
+/* streaming writer state, see xi_init_senml_writer, members are not meant to be
+ * accessed directly */
+typedef struct xi_senml_writer_s
+{
+    xi_senml_t base; /* strings are referenced, not copied */
+    xi_senml_format_t format;
+    uint8_t* buffer;
+    uint32_t capacity;
+    uint32_t length; /* of the open document, 0 before it is opened */
+    uint32_t entries_count;
+    uint32_t open_length;
+    uint32_t close_length; /* of a document with entries */
+} xi_senml_writer_t;
+
 #ifdef __cplusplus
 }
 #endif
@@ -81,6 +81,22 @@ XI_CONFIG_FLAGS += -DXI_DEBUG_ASSERT=$(XI_DEBUG_ASSERT)
 XI_CONFIG_FLAGS += -DXI_DEBUG_EXTRA_INFO=$(XI_DEBUG_EXTRA_INFO)
 XI_CONFIG_FLAGS += -DUSE_CBOR_CONTEXT
 
+ifdef XI_MAX_NUM_CONTEXTS
+XI_CONFIG_FLAGS += -DXI_MAX_NUM_CONTEXTS=$(XI_MAX_NUM_CONTEXTS)
+endif
+
+ifdef XI_LAYER_CHAIN_STATIC
+XI_CONFIG_FLAGS += -DXI_LAYER_CHAIN_STATIC=$(XI_LAYER_CHAIN_STATIC)
+endif
+
+ifdef XI_STATS_LAYER_TIMING
+XI_CONFIG_FLAGS += -DXI_STATS_LAYER_TIMING=$(XI_STATS_LAYER_TIMING)
+endif
+
+ifdef XI_VECTOR_INDEX_TYPE
+XI_CONFIG_FLAGS += -DXI_VECTOR_INDEX_TYPE=$(XI_VECTOR_INDEX_TYPE)
+endif
+
 ifdef XI_CBOR_MESSAGE_MIN_BUFFER_SIZE
 XI_CONFIG_FLAGS += -DXI_CBOR_MESSAGE_MIN_BUFFER_SIZE=$(XI_CBOR_MESSAGE_MIN_BUFFER_SIZE)
 endif
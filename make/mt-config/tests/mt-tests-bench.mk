@@ -0,0 +1,53 @@
+# Copyright (c) 2003-2018, Xively All rights reserved.
+#
+# This is part of the Xively C Client library,
+# it is licensed under the BSD 3-Clause license.
+
+include make/mt-config/tests/mt-tests.mk
+
+XI_BENCH_SOURCE_DIR := $(XI_TEST_DIR)/benchmarks
+XI_BENCH_BINDIR := $(XI_TEST_BINDIR)/benchmarks
+
+XI_BENCH_CHECKSUM := $(XI_BENCH_BINDIR)/xi_bench_checksum
+XI_BENCH_CHECKSUM_IMAGE_MB ?= 16
+XI_BENCH_CHECKSUM_ROUNDS ?= 5
+
+XI_BENCH_LAYER_CHAIN := $(XI_BENCH_BINDIR)/xi_bench_layer_chain
+XI_BENCH_LAYER_CHAIN_MESSAGES ?= 100000
+
+XI_BENCH_CBOR_CODEC_CT := $(XI_BENCH_BINDIR)/xi_bench_cbor_codec_ct
+XI_BENCH_CBOR_CODEC_CT_MESSAGES ?= 200000
+
+XI_BENCH_SENML := $(XI_BENCH_BINDIR)/xi_bench_senml
+XI_BENCH_SENML_DOCUMENTS ?= 2000
+
+XI_BENCH_LOOPBACK := $(XI_BENCH_BINDIR)/xi_bench_loopback
+XI_BENCH_LOOPBACK_MESSAGES ?= 10000
+
+# checksum backends compared by bench_checksum_all, each one is built in its own
+# output directories so the regular build is left untouched
+XI_BENCH_CHECKSUM_TLS_BACKENDS ?= wolfssl mbedtls
+
+XI_BENCH_CONFIG_FLAGS :=
+XI_BENCH_EXTRA_SOURCES :=
+
+# the cn-cbor codec the streaming one is compared with lives with the tests
+XI_BENCH_CN_CBOR_CODEC_DIR := $(XI_TEST_DIR)/common/control_topic
+$(XI_BENCH_CBOR_CODEC_CT): XI_BENCH_CONFIG_FLAGS += -I$(XI_BENCH_CN_CBOR_CODEC_DIR)
+$(XI_BENCH_CBOR_CODEC_CT): XI_BENCH_EXTRA_SOURCES += $(XI_BENCH_CN_CBOR_CODEC_DIR)/xi_cbor_codec_ct_cn_cbor.c
+
+ifeq (,$(findstring tls_bsp,$(CONFIG)))
+    XI_BENCH_CONFIG_FLAGS += -DXI_BENCH_CHECKSUM_CRYPTOALGS
+    XI_BENCH_CONFIG_FLAGS += -DXI_BENCH_CHECKSUM_BACKEND=\"crypto-algorithms\"
+else
+    XI_BENCH_CONFIG_FLAGS += -DXI_BENCH_CHECKSUM_BACKEND=\"$(XI_BSP_TLS)\"
+endif
+
+# allocations are counted by wrapping the memory BSP which needs GNU ld
+ifeq ($(XI_HOST_PLATFORM),Linux)
+    XI_BENCH_COUNTING_ALLOCATIONS := $(XI_BENCH_LAYER_CHAIN) $(XI_BENCH_CBOR_CODEC_CT) $(XI_BENCH_SENML)
+    $(XI_BENCH_COUNTING_ALLOCATIONS): XI_BENCH_CONFIG_FLAGS += -DXI_BENCH_COUNT_ALLOCATIONS
+    $(XI_BENCH_COUNTING_ALLOCATIONS): XI_BENCH_CONFIG_FLAGS += -Wl,--wrap=xi_bsp_mem_alloc
+    # instructions are counted with perf_event_open
+    $(XI_BENCH_LAYER_CHAIN): XI_BENCH_CONFIG_FLAGS += -DXI_BENCH_COUNT_INSTRUCTIONS
+endif
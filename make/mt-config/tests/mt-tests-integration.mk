@@ -49,10 +49,14 @@ XI_ITESTS_SOURCES += $(wildcard $(XI_TEST_DIR)/*.c)
 # ADD dummy io layer
 XI_ITESTS_SOURCES += $(wildcard $(LIBXIVELY)/src/libxively/io/dummy/*.c)
 
+# ADD replay io layer
+XI_ITESTS_SOURCES += $(wildcard $(XI_TEST_DIR)/common/replay/*.c)
+
 ifdef XI_SECURE_FILE_TRANSFER_ENABLED
     XI_ITESTS_SOURCES += $(wildcard $(XI_TEST_DIR)/common/control_topic/*.c)
 else
     XI_ITESTS_SOURCES := $(filter-out $(XI_ITESTS_SOURCE_DIR)/xi_itest_sft.c, $(XI_ITESTS_SOURCES))
+    XI_ITESTS_SOURCES := $(filter-out $(XI_ITESTS_SOURCE_DIR)/xi_itest_startup.c, $(XI_ITESTS_SOURCES))
 endif
 
 # removing TLS layer related tests in case TLS is turned off from compilation
@@ -68,6 +72,7 @@ XI_ITESTS_INCLUDE_FLAGS += -I$(CMOCKA_INCLUDE_DIR)
 XI_ITESTS_INCLUDE_FLAGS += -I$(XI_TEST_DIR)
 XI_ITESTS_INCLUDE_FLAGS += -I$(XI_TEST_DIR)/tools
 XI_ITESTS_INCLUDE_FLAGS += -I$(XI_TEST_DIR)/common/control_topic
+XI_ITESTS_INCLUDE_FLAGS += -I$(XI_TEST_DIR)/common/replay
 XI_ITESTS_INCLUDE_FLAGS += -I$(XI_TEST_DIR)/itests
 XI_ITESTS_INCLUDE_FLAGS += -I$(XI_TEST_DIR)/itests/tools
 XI_ITESTS_INCLUDE_FLAGS += -I$(XI_TEST_DIR)/itests/tools/dummy
@@ -27,3 +27,22 @@ XI_TEST_TOOLS_OBJS := $(subst $(LIBXIVELY)/src, $(XI_OBJDIR), $(XI_TEST_TOOLS_OB
 
 XI_TEST_TOOLS_INCLUDE_FLAGS := -I$(LIBXIVELY_SOURCE_DIR)/../import/protobuf-c/library
 
+
+# the fleet simulator is not a part of the tests target, see the fleet_simulator target
+XI_TEST_TOOLS_FLEET_SIMULATOR := $(XI_TEST_TOOLS_BINDIR)/xi_fleet_simulator
+XI_TEST_TOOLS_FLEET_SIMULATOR_SOURCES := $(wildcard $(XI_TEST_TOOLS_SRCDIR)/xi_fleet_simulator/*.c)
+
+ifdef XI_SECURE_FILE_TRANSFER_ENABLED
+    XI_TEST_TOOLS_FLEET_SIMULATOR_SOURCES += $(wildcard $(XI_TEST_DIR)/common/control_topic/*.c)
+endif
+
+XI_TEST_TOOLS_FLEET_SIMULATOR_FLAGS := -I$(XI_TEST_DIR)/common/control_topic
+
+# the heap used per device is measured by wrapping the memory BSP which needs GNU ld
+ifeq ($(XI_HOST_PLATFORM),Linux)
+    XI_TEST_TOOLS_FLEET_SIMULATOR_FLAGS += -DXI_FLEET_SIMULATOR_COUNT_MEMORY
+    XI_TEST_TOOLS_FLEET_SIMULATOR_FLAGS += -Wl,--wrap=xi_bsp_mem_alloc,--wrap=xi_bsp_mem_realloc,--wrap=xi_bsp_mem_free
+endif
+
+# the library is rebuilt for the simulator with this many contexts allowed
+XI_FLEET_SIMULATOR_MAX_CONTEXTS ?= 20000
@@ -28,6 +28,7 @@ endif
 
 ifdef XI_SECURE_FILE_TRANSFER_ENABLED
     XI_UTEST_SOURCES += $(wildcard $(XI_TEST_DIR)/common/control_topic/*.c)
+    XI_UTEST_INCLUDE_FLAGS += -I$(XI_TEST_DIR)/common/control_topic
 else
     XI_UTEST_EXCLUDED += xi_utest_cbor_codec_ct_decode.c xi_utest_cbor_codec_ct_encode.c xi_utest_control_message_sft.c xi_utest_sft_logic.c xi_utest_sft_logic_internal_methods.c
 endif
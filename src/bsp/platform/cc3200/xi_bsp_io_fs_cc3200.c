@@ -86,7 +86,12 @@ xi_bsp_io_fs_state_t xi_bsp_io_fs_open( const char* const resource_name,
                                         const xi_bsp_io_fs_open_flags_t open_flags,
                                         xi_bsp_io_fs_resource_handle_t* resource_handle_out )
 {
-    ( void )open_flags;
+    /* the SimpleLink file system can't open a file for update in place */
+    if ( ( XI_BSP_IO_FS_OPEN_READ | XI_BSP_IO_FS_OPEN_WRITE ) ==
+         ( open_flags & ( XI_BSP_IO_FS_OPEN_READ | XI_BSP_IO_FS_OPEN_WRITE ) ) )
+    {
+        return XI_BSP_IO_FS_INVALID_PARAMETER;
+    }
 
 #ifdef XI_DEBUG__FOR_FIRMWARE_UPDATE_TESTING_PURPOSES
     _ReadBootInfo( &sBootInfo );
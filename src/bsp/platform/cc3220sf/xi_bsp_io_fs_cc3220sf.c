@@ -101,6 +101,13 @@ xi_bsp_io_fs_open( const char* const resource_name,
     xi_bsp_debug_format( " Opening file: [ %s ] with flags: [ %i ]", resource_name,
                          open_flags );
 
+    /* the SimpleLink file system can't open a file for update in place */
+    if ( ( XI_BSP_IO_FS_OPEN_READ | XI_BSP_IO_FS_OPEN_WRITE ) ==
+         ( open_flags & ( XI_BSP_IO_FS_OPEN_READ | XI_BSP_IO_FS_OPEN_WRITE ) ) )
+    {
+        return XI_BSP_IO_FS_INVALID_PARAMETER;
+    }
+
     if ( 1 == xi_bsp_fwu_is_this_firmware( resource_name ) )
     {
         _i16 status;
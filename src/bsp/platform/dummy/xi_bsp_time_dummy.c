@@ -20,3 +20,8 @@ xi_time_t xi_bsp_time_getcurrenttime_milliseconds()
 {
     return 1;
 }
+
+xi_time_t xi_bsp_time_getmonotonictime_microseconds()
+{
+    return 1;
+}
@@ -152,8 +152,12 @@ xi_bsp_io_fs_open( const char* const resource_name,
     xi_bsp_io_fs_posix_file_handle_container_t* new_entry = NULL;
     xi_bsp_io_fs_state_t ret                              = XI_BSP_IO_FS_STATE_OK;
 
-    FILE* fp =
-        fopen( resource_name, ( open_flags & XI_BSP_IO_FS_OPEN_READ ) ? "rb" : "wb" );
+    /* read and write together opens an existing file for update without truncation */
+    const char* mode = ( open_flags & XI_BSP_IO_FS_OPEN_READ )
+                           ? ( ( open_flags & XI_BSP_IO_FS_OPEN_WRITE ) ? "r+b" : "rb" )
+                           : "wb";
+
+    FILE* fp = fopen( resource_name, mode );
 
     /* if error on fopen check the errno value */
     XI_BSP_IO_FS_CHECK_CND( NULL == fp,
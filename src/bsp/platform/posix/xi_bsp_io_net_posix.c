@@ -260,7 +260,8 @@ xi_bsp_io_net_state_t xi_bsp_io_net_select( xi_bsp_socket_events_t* socket_event
     tv.tv_sec = timeout_sec;
 
     /* call the actual posix select */
-    const int result = select( max_fd + 1, &rfds, &wfds, &efds, &tv );
+    const int result =
+        select( max_fd + 1, &rfds, &wfds, &efds, ( 0 > timeout_sec ) ? NULL : &tv );
 
     if ( 0 < result )
     {
@@ -8,6 +8,7 @@
 
 #include <stddef.h>
 #include <sys/time.h>
+#include <time.h>
 
 void xi_bsp_time_init()
 {
@@ -31,3 +32,11 @@ xi_time_t xi_bsp_time_getcurrenttime_milliseconds()
                           ( current_time.tv_usec + 500 ) /
                               1000 ); /* round the microseconds to milliseconds */
 }
+
+xi_time_t xi_bsp_time_getmonotonictime_microseconds()
+{
+    struct timespec current_time;
+    clock_gettime( CLOCK_MONOTONIC, &current_time );
+    return ( xi_time_t )( ( current_time.tv_sec * 1000000 ) +
+                          current_time.tv_nsec / 1000 );
+}
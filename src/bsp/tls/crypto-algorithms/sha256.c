@@ -17,6 +17,21 @@
 #include <string.h>
 #include "sha256.h"
 
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define SHA256_HAVE_SHANI
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+#if defined(__aarch64__) && (defined(__ARM_FEATURE_SHA2) || defined(__ARM_FEATURE_CRYPTO))
+#define SHA256_HAVE_ARMV8
+#include <arm_neon.h>
+#if defined(__linux__)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+#endif
+
 /****************************** MACROS ******************************/
 #define ROTLEFT(a,b) (((a) << (b)) | ((a) >> (32-(b))))
 #define ROTRIGHT(a,b) (((a) >> (b)) | ((a) << (32-(b))))
@@ -40,50 +55,244 @@ static const WORD k[64] = {
 	0x748f82ee,0x78a5636f,0x84c87814,0x8cc70208,0x90befffa,0xa4506ceb,0xbef9a3f7,0xc67178f2
 };
 
+typedef void (*SHA256_BLOCKS_FN)(WORD state[8], const BYTE data[], size_t blocks);
+
+// Block function selected by sha256_select_impl, resolved on the first sha256_init.
+static SHA256_BLOCKS_FN sha256_blocks = NULL;
+static SHA256_IMPL sha256_impl = SHA256_IMPL_AUTO;
+
 /*********************** FUNCTION DEFINITIONS ***********************/
-void sha256_transform(SHA256_CTX *ctx, const BYTE data[])
+static void sha256_blocks_portable(WORD state[8], const BYTE data[], size_t blocks)
 {
 	WORD a, b, c, d, e, f, g, h, i, j, t1, t2, m[64];
 
-	for (i = 0, j = 0; i < 16; ++i, j += 4)
-		m[i] = (data[j] << 24) | (data[j + 1] << 16) | (data[j + 2] << 8) | (data[j + 3]);
-	for ( ; i < 64; ++i)
-		m[i] = SIG1(m[i - 2]) + m[i - 7] + SIG0(m[i - 15]) + m[i - 16];
-
-	a = ctx->state[0];
-	b = ctx->state[1];
-	c = ctx->state[2];
-	d = ctx->state[3];
-	e = ctx->state[4];
-	f = ctx->state[5];
-	g = ctx->state[6];
-	h = ctx->state[7];
-
-	for (i = 0; i < 64; ++i) {
-		t1 = h + EP1(e) + CH(e,f,g) + k[i] + m[i];
-		t2 = EP0(a) + MAJ(a,b,c);
-		h = g;
-		g = f;
-		f = e;
-		e = d + t1;
-		d = c;
-		c = b;
-		b = a;
-		a = t1 + t2;
+	for ( ; blocks > 0; --blocks, data += 64) {
+		for (i = 0, j = 0; i < 16; ++i, j += 4)
+			m[i] = ((WORD)data[j] << 24) | ((WORD)data[j + 1] << 16) | ((WORD)data[j + 2] << 8) | (data[j + 3]);
+		for ( ; i < 64; ++i)
+			m[i] = SIG1(m[i - 2]) + m[i - 7] + SIG0(m[i - 15]) + m[i - 16];
+
+		a = state[0];
+		b = state[1];
+		c = state[2];
+		d = state[3];
+		e = state[4];
+		f = state[5];
+		g = state[6];
+		h = state[7];
+
+		for (i = 0; i < 64; ++i) {
+			t1 = h + EP1(e) + CH(e,f,g) + k[i] + m[i];
+			t2 = EP0(a) + MAJ(a,b,c);
+			h = g;
+			g = f;
+			f = e;
+			e = d + t1;
+			d = c;
+			c = b;
+			b = a;
+			a = t1 + t2;
+		}
+
+		state[0] += a;
+		state[1] += b;
+		state[2] += c;
+		state[3] += d;
+		state[4] += e;
+		state[5] += f;
+		state[6] += g;
+		state[7] += h;
 	}
+}
+
+#ifdef SHA256_HAVE_SHANI
+// SHA extensions keep the state as ABEF/CDGH and perform two rounds per
+// sha256rnds2, the message schedule is computed four words at a time.
+__attribute__((target("sha,sse4.1,ssse3")))
+static void sha256_blocks_shani(WORD state[8], const BYTE data[], size_t blocks)
+{
+	const __m128i mask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+	__m128i state0, state1, abef, cdgh, msg, tmp, w[4];
+	int i;
+
+	tmp = _mm_loadu_si128((const __m128i *)&state[0]);
+	state1 = _mm_loadu_si128((const __m128i *)&state[4]);
+	tmp = _mm_shuffle_epi32(tmp, 0xB1);            // CDAB
+	state1 = _mm_shuffle_epi32(state1, 0x1B);      // EFGH
+	state0 = _mm_alignr_epi8(tmp, state1, 8);      // ABEF
+	state1 = _mm_blend_epi16(state1, tmp, 0xF0);   // CDGH
+
+	for ( ; blocks > 0; --blocks, data += 64) {
+		abef = state0;
+		cdgh = state1;
+
+		for (i = 0; i < 16; ++i) {
+			if (i < 4) {
+				w[i] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(data + 16 * i)), mask);
+			}
+			else {
+				tmp = _mm_sha256msg1_epu32(w[i & 3], w[(i + 1) & 3]);
+				tmp = _mm_add_epi32(tmp, _mm_alignr_epi8(w[(i + 3) & 3], w[(i + 2) & 3], 4));
+				w[i & 3] = _mm_sha256msg2_epu32(tmp, w[(i + 3) & 3]);
+			}
+			msg = _mm_add_epi32(w[i & 3], _mm_loadu_si128((const __m128i *)&k[4 * i]));
+			state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+			msg = _mm_shuffle_epi32(msg, 0x0E);
+			state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+		}
 
-	ctx->state[0] += a;
-	ctx->state[1] += b;
-	ctx->state[2] += c;
-	ctx->state[3] += d;
-	ctx->state[4] += e;
-	ctx->state[5] += f;
-	ctx->state[6] += g;
-	ctx->state[7] += h;
+		state0 = _mm_add_epi32(state0, abef);
+		state1 = _mm_add_epi32(state1, cdgh);
+	}
+
+	tmp = _mm_shuffle_epi32(state0, 0x1B);         // FEBA
+	state1 = _mm_shuffle_epi32(state1, 0xB1);      // DCHG
+	state0 = _mm_blend_epi16(tmp, state1, 0xF0);   // DCBA
+	state1 = _mm_alignr_epi8(state1, tmp, 8);      // HGFE
+
+	_mm_storeu_si128((__m128i *)&state[0], state0);
+	_mm_storeu_si128((__m128i *)&state[4], state1);
+}
+
+static int sha256_shani_supported(void)
+{
+	unsigned int eax, ebx, ecx, edx;
+
+	if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+		return 0;
+	// SSSE3 and SSE4.1
+	if (!(ecx & (1u << 9)) || !(ecx & (1u << 19)))
+		return 0;
+	if (__get_cpuid_max(0, NULL) < 7)
+		return 0;
+	__cpuid_count(7, 0, eax, ebx, ecx, edx);
+	// SHA
+	return (ebx & (1u << 29)) != 0;
+}
+#endif
+
+#ifdef SHA256_HAVE_ARMV8
+static void sha256_blocks_armv8(WORD state[8], const BYTE data[], size_t blocks)
+{
+	uint32x4_t state0, state1, abcd, efgh, msg, tmp, w[4];
+	int i;
+
+	state0 = vld1q_u32(&state[0]);
+	state1 = vld1q_u32(&state[4]);
+
+	for ( ; blocks > 0; --blocks, data += 64) {
+		abcd = state0;
+		efgh = state1;
+
+		for (i = 0; i < 16; ++i) {
+			if (i < 4) {
+				w[i] = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(data + 16 * i)));
+			}
+			else {
+				tmp = vsha256su0q_u32(w[i & 3], w[(i + 1) & 3]);
+				w[i & 3] = vsha256su1q_u32(tmp, w[(i + 2) & 3], w[(i + 3) & 3]);
+			}
+			msg = vaddq_u32(w[i & 3], vld1q_u32(&k[4 * i]));
+			tmp = state0;
+			state0 = vsha256hq_u32(state0, state1, msg);
+			state1 = vsha256h2q_u32(state1, tmp, msg);
+		}
+
+		state0 = vaddq_u32(state0, abcd);
+		state1 = vaddq_u32(state1, efgh);
+	}
+
+	vst1q_u32(&state[0], state0);
+	vst1q_u32(&state[4], state1);
+}
+
+static int sha256_armv8_supported(void)
+{
+#if defined(__linux__) && defined(HWCAP_SHA2)
+	return (getauxval(AT_HWCAP) & HWCAP_SHA2) != 0;
+#else
+	// the toolchain was told the extensions are there
+	return 1;
+#endif
+}
+#endif
+
+int sha256_select_impl(SHA256_IMPL impl)
+{
+	SHA256_BLOCKS_FN blocks = NULL;
+
+	switch (impl) {
+	case SHA256_IMPL_AUTO:
+#ifdef SHA256_HAVE_SHANI
+		if (sha256_shani_supported()) {
+			impl = SHA256_IMPL_SHANI;
+			blocks = sha256_blocks_shani;
+			break;
+		}
+#endif
+#ifdef SHA256_HAVE_ARMV8
+		if (sha256_armv8_supported()) {
+			impl = SHA256_IMPL_ARMV8;
+			blocks = sha256_blocks_armv8;
+			break;
+		}
+#endif
+		impl = SHA256_IMPL_PORTABLE;
+		blocks = sha256_blocks_portable;
+		break;
+	case SHA256_IMPL_PORTABLE:
+		blocks = sha256_blocks_portable;
+		break;
+#ifdef SHA256_HAVE_SHANI
+	case SHA256_IMPL_SHANI:
+		if (sha256_shani_supported())
+			blocks = sha256_blocks_shani;
+		break;
+#endif
+#ifdef SHA256_HAVE_ARMV8
+	case SHA256_IMPL_ARMV8:
+		if (sha256_armv8_supported())
+			blocks = sha256_blocks_armv8;
+		break;
+#endif
+	default:
+		break;
+	}
+
+	if (blocks == NULL)
+		return 0;
+
+	sha256_blocks = blocks;
+	sha256_impl = impl;
+
+	return 1;
+}
+
+const char *sha256_impl_name(void)
+{
+	if (sha256_blocks == NULL)
+		sha256_select_impl(SHA256_IMPL_AUTO);
+
+	switch (sha256_impl) {
+	case SHA256_IMPL_SHANI:
+		return "sha-ni";
+	case SHA256_IMPL_ARMV8:
+		return "armv8-ce";
+	default:
+		return "portable";
+	}
+}
+
+void sha256_transform(SHA256_CTX *ctx, const BYTE data[])
+{
+	sha256_blocks(ctx->state, data, 1);
 }
 
 void sha256_init(SHA256_CTX *ctx)
 {
+	if (sha256_blocks == NULL)
+		sha256_select_impl(SHA256_IMPL_AUTO);
+
 	ctx->datalen = 0;
 	ctx->bitlen = 0;
 	ctx->state[0] = 0x6a09e667;
@@ -98,17 +307,35 @@ void sha256_init(SHA256_CTX *ctx)
 
 void sha256_update(SHA256_CTX *ctx, const BYTE data[], size_t len)
 {
-	WORD i;
+	size_t fill, blocks;
 
-	for (i = 0; i < len; ++i) {
-		ctx->data[ctx->datalen] = data[i];
-		ctx->datalen++;
-		if (ctx->datalen == 64) {
-			sha256_transform(ctx, ctx->data);
-			ctx->bitlen += 512;
-			ctx->datalen = 0;
+	// Top up a partially filled block first.
+	if (ctx->datalen > 0) {
+		fill = 64 - ctx->datalen;
+		if (len < fill) {
+			memcpy(ctx->data + ctx->datalen, data, len);
+			ctx->datalen += len;
+			return;
 		}
+		memcpy(ctx->data + ctx->datalen, data, fill);
+		sha256_transform(ctx, ctx->data);
+		ctx->bitlen += 512;
+		ctx->datalen = 0;
+		data += fill;
+		len -= fill;
 	}
+
+	// Whole blocks are hashed straight from the input.
+	blocks = len / 64;
+	if (blocks > 0) {
+		sha256_blocks(ctx->state, data, blocks);
+		ctx->bitlen += 512 * (unsigned long long)blocks;
+		data += blocks * 64;
+		len -= blocks * 64;
+	}
+
+	memcpy(ctx->data, data, len);
+	ctx->datalen = len;
 }
 
 void sha256_final(SHA256_CTX *ctx, BYTE hash[])
@@ -26,9 +26,20 @@ typedef struct {
 	WORD state[8];
 } SHA256_CTX;
 
+typedef enum {
+	SHA256_IMPL_AUTO = 0,   // fastest one supported by the CPU
+	SHA256_IMPL_PORTABLE,
+	SHA256_IMPL_SHANI,      // x86-64 SHA extensions
+	SHA256_IMPL_ARMV8       // ARMv8 cryptography extensions
+} SHA256_IMPL;
+
 /*********************** FUNCTION DECLARATIONS **********************/
 void sha256_init(SHA256_CTX *ctx);
 void sha256_update(SHA256_CTX *ctx, const BYTE data[], size_t len);
 void sha256_final(SHA256_CTX *ctx, BYTE hash[]);
 
+// Returns 0 if the implementation is not compiled in or the CPU lacks it.
+int sha256_select_impl(SHA256_IMPL impl);
+const char *sha256_impl_name(void);
+
 #endif   // SHA256_H
@@ -7,15 +7,20 @@
 #include <xi_cbor_codec_ct.h>
 #include <xi_cbor_codec_ct_keys.h>
 
+#include <string.h>
+
 #include <cbor.h>
 #include <cn-cbor/cn-cbor.h>
 
+#include <xi_config.h>
 #include <xi_control_message.h>
 #include <xively_error.h>
 #include <xi_macros.h>
 
 #include <xi_debug.h>
 
+/* the codec below does not use cn-cbor, the allocator context is kept for the
+ * applications and the tests which use cn-cbor through the library */
 #ifdef USE_CBOR_CONTEXT
 
 #include <xi_allocator.h>
@@ -42,106 +47,184 @@ cn_cbor_context* context_cbor = &cn_cbor_context_object;
 
 #endif
 
-void xi_cbor_put_name_and_revision( cn_cbor* cb_map,
-                                    const char* name,
-                                    const char* revision,
-                                    cn_cbor_errback* errp )
+/*
+ * Streaming CBOR codec of the control topic messages. The encoder emits the message
+ * field by field, the very same emitter is run once without a buffer to calculate
+ * the exact size and once more to write the bytes. The decoder walks the received
+ * buffer and fills the message straight from it, unknown keys are skipped.
+ */
+
+#define XI_CBOR_MAJOR_UINT 0
+#define XI_CBOR_MAJOR_NEGINT 1
+#define XI_CBOR_MAJOR_BYTES 2
+#define XI_CBOR_MAJOR_TEXT 3
+#define XI_CBOR_MAJOR_ARRAY 4
+#define XI_CBOR_MAJOR_MAP 5
+#define XI_CBOR_MAJOR_TAG 6
+#define XI_CBOR_MAJOR_SIMPLE 7
+
+#define XI_CBOR_SIMPLE_FALSE 20
+#define XI_CBOR_SIMPLE_TRUE 21
+
+#define XI_CBOR_ADDITIONAL_INFO_INDEFINITE 31
+#define XI_CBOR_BREAK 0xff
+
+/* limits the recursion while skipping unknown values */
+#define XI_CBOR_MAX_NESTING 8
+
+/*-----------------------------------------------------------------------
+ * ENCODER
+ * ----------------------------------------------------------------------- */
+
+typedef struct xi_cbor_writer_s
 {
-    if ( NULL != name )
+    uint8_t* buffer; /* NULL while sizing */
+    uint32_t pos;
+} xi_cbor_writer_t;
+
+static void xi_cbor_put_head( xi_cbor_writer_t* writer, uint8_t major, uint64_t value )
+{
+    uint8_t head[9];
+    uint8_t argument_len = 0;
+    uint8_t i            = 0;
+
+    /* the shortest big endian argument that fits the value */
+    if ( value < 24 )
     {
-        cn_cbor_map_put( cb_map,
-                         cn_cbor_string_create(
-                             XI_CBOR_CODEC_CT_STRING_FILE_NAME CBOR_CONTEXT_PARAM, errp ),
-                         cn_cbor_string_create( name CBOR_CONTEXT_PARAM, errp ), errp );
+        head[0] = ( uint8_t )( major << 5 | value );
+    }
+    else if ( value <= 0xff )
+    {
+        head[0]      = ( uint8_t )( major << 5 | 24 );
+        argument_len = 1;
+    }
+    else if ( value <= 0xffff )
+    {
+        head[0]      = ( uint8_t )( major << 5 | 25 );
+        argument_len = 2;
+    }
+    else if ( value <= 0xffffffff )
+    {
+        head[0]      = ( uint8_t )( major << 5 | 26 );
+        argument_len = 4;
+    }
+    else
+    {
+        head[0]      = ( uint8_t )( major << 5 | 27 );
+        argument_len = 8;
     }
 
-    if ( NULL != revision )
+    for ( ; i < argument_len; ++i )
     {
-        cn_cbor_map_put(
-            cb_map, cn_cbor_string_create(
-                        XI_CBOR_CODEC_CT_STRING_FILE_REVISION CBOR_CONTEXT_PARAM, errp ),
-            cn_cbor_string_create( revision CBOR_CONTEXT_PARAM, errp ), errp );
+        head[argument_len - i] = ( uint8_t )( value >> ( 8 * i ) );
     }
+
+    if ( NULL != writer->buffer )
+    {
+        memcpy( writer->buffer + writer->pos, head, 1 + argument_len );
+    }
+
+    writer->pos += 1 + argument_len;
 }
 
-void xi_cbor_codec_ct_encode_generate_buffer( cn_cbor* cb_map,
-                                              uint8_t** out_encoded_allocated_inside,
-                                              uint32_t* out_len,
-                                              uint32_t buffer_size_min,
-                                              uint32_t buffer_size_max )
+static void xi_cbor_put_int( xi_cbor_writer_t* writer, int64_t value )
 {
-    /* This function generates CBOR encoded message buffer. Starts at a minimum buffer
-     * size and doubles it until message fits into the buffer or the maximum allowed size
-     * is reached. At the end output binary is trimmed at exactly required size. */
+    if ( value < 0 )
+    {
+        xi_cbor_put_head( writer, XI_CBOR_MAJOR_NEGINT, ( uint64_t )( -1 - value ) );
+    }
+    else
+    {
+        xi_cbor_put_head( writer, XI_CBOR_MAJOR_UINT, ( uint64_t )value );
+    }
+}
 
-    xi_state_t state = XI_STATE_OK;
+static void xi_cbor_put_text( xi_cbor_writer_t* writer, const char* text )
+{
+    const size_t text_len = strlen( text );
 
-    uint8_t* encoded     = NULL;
-    uint32_t encoded_len = buffer_size_min;
+    xi_cbor_put_head( writer, XI_CBOR_MAJOR_TEXT, text_len );
 
-    /* doubling buffer size until it fits or ceiling is reached */
-    for ( ; encoded_len < buffer_size_max; encoded_len *= 2 )
+    if ( NULL != writer->buffer )
     {
-        XI_ALLOC_BUFFER_AT( uint8_t, encoded, encoded_len, state );
+        memcpy( writer->buffer + writer->pos, text, text_len );
+    }
 
-        const ssize_t encode_result =
-            cn_cbor_encoder_write( encoded, 0, encoded_len, cb_map );
+    writer->pos += text_len;
+}
 
-        if ( encode_result <= 0 )
-        {
-            /* failure during encoding, probably buffer size is not enough */
-            XI_SAFE_FREE( encoded );
-        }
-        else
-        {
-            /* successful encoding */
-            *out_len = encode_result;
-            break;
-        }
-    }
+static void xi_cbor_put_bool( xi_cbor_writer_t* writer, uint8_t value )
+{
+    xi_cbor_put_head( writer, XI_CBOR_MAJOR_SIMPLE,
+                      value ? XI_CBOR_SIMPLE_TRUE : XI_CBOR_SIMPLE_FALSE );
+}
 
-    cn_cbor_free( cb_map CBOR_CONTEXT_PARAM );
+static void
+xi_cbor_put_key_int( xi_cbor_writer_t* writer, const char* key, int64_t value )
+{
+    xi_cbor_put_text( writer, key );
+    xi_cbor_put_int( writer, value );
+}
 
-    if ( 0 < *out_len )
-    {
-        XI_ALLOC_BUFFER_AT( uint8_t, *out_encoded_allocated_inside, *out_len, state );
+static void
+xi_cbor_put_key_text( xi_cbor_writer_t* writer, const char* key, const char* value )
+{
+    xi_cbor_put_text( writer, key );
+    xi_cbor_put_text( writer, value );
+}
 
-        memcpy( *out_encoded_allocated_inside, encoded, *out_len );
+/* the NULL name and revision are left out of the map, the way the cn-cbor encoder did */
+static void xi_cbor_put_name_and_revision_fields( xi_cbor_writer_t* writer,
+                                                  const char* name,
+                                                  const char* revision )
+{
+    if ( NULL != name )
+    {
+        xi_cbor_put_key_text( writer, XI_CBOR_CODEC_CT_STRING_FILE_NAME, name );
     }
-    XI_SAFE_FREE( encoded );
-
-    return;
 
-err_handling:;
+    if ( NULL != revision )
+    {
+        xi_cbor_put_key_text( writer, XI_CBOR_CODEC_CT_STRING_FILE_REVISION, revision );
+    }
+}
 
-    XI_SAFE_FREE( encoded );
-    XI_SAFE_FREE( *out_encoded_allocated_inside );
+static uint64_t xi_cbor_name_and_revision_field_count( const char* name,
+                                                       const char* revision )
+{
+    return ( NULL != name ) + ( NULL != revision );
 }
 
-void xi_cbor_codec_ct_encode( const xi_control_message_t* control_message,
-                              uint8_t** out_encoded_allocated_inside,
-                              uint32_t* out_len )
+static void xi_cbor_codec_ct_encode_message( xi_cbor_writer_t* writer,
+                                             const xi_control_message_t* control_message )
 {
-    if ( NULL == control_message )
+    /* msgtype and msgver */
+    uint64_t field_count = 2;
+
+    switch ( control_message->common.msgtype )
     {
-        *out_len = 0;
-        return;
+        case XI_CONTROL_MESSAGE_CS__SFT_FILE_INFO:
+            field_count += ( 0 < control_message->file_info.list_len ) ? 2 : 0;
+            break;
+        case XI_CONTROL_MESSAGE_CS__SFT_FILE_GET_CHUNK:
+            field_count += 2 + xi_cbor_name_and_revision_field_count(
+                                   control_message->file_get_chunk.name,
+                                   control_message->file_get_chunk.revision );
+            break;
+        case XI_CONTROL_MESSAGE_CS__SFT_FILE_STATUS:
+            field_count += 2 + xi_cbor_name_and_revision_field_count(
+                                   control_message->file_status.name,
+                                   control_message->file_status.revision );
+            break;
+        default:;
     }
 
-    cn_cbor_errback err;
-    cn_cbor* cb_map = cn_cbor_map_create( CBOR_CONTEXT_PARAM_COMMA & err );
+    xi_cbor_put_head( writer, XI_CBOR_MAJOR_MAP, field_count );
 
-    cn_cbor_map_put(
-        cb_map,
-        cn_cbor_string_create( XI_CBOR_CODEC_CT_STRING_MSGTYPE CBOR_CONTEXT_PARAM, &err ),
-        cn_cbor_int_create( control_message->common.msgtype CBOR_CONTEXT_PARAM, &err ),
-        &err );
-
-    cn_cbor_map_put(
-        cb_map,
-        cn_cbor_string_create( XI_CBOR_CODEC_CT_STRING_MSGVER CBOR_CONTEXT_PARAM, &err ),
-        cn_cbor_int_create( control_message->common.msgver CBOR_CONTEXT_PARAM, &err ),
-        &err );
+    xi_cbor_put_key_int( writer, XI_CBOR_CODEC_CT_STRING_MSGTYPE,
+                         control_message->common.msgtype );
+    xi_cbor_put_key_int( writer, XI_CBOR_CODEC_CT_STRING_MSGVER,
+                         control_message->common.msgver );
 
     switch ( control_message->common.msgtype )
     {
@@ -149,88 +232,54 @@ void xi_cbor_codec_ct_encode( const xi_control_message_t* control_message,
 
             if ( 0 < control_message->file_info.list_len )
             {
-                cn_cbor* files = cn_cbor_array_create( CBOR_CONTEXT_PARAM_COMMA & err );
-
                 uint16_t id_file = 0;
+
+                xi_cbor_put_text( writer, XI_CBOR_CODEC_CT_STRING_LIST );
+                xi_cbor_put_head( writer, XI_CBOR_MAJOR_ARRAY,
+                                  control_message->file_info.list_len );
+
                 for ( ; id_file < control_message->file_info.list_len; ++id_file )
                 {
-                    cn_cbor* file = cn_cbor_map_create( CBOR_CONTEXT_PARAM_COMMA & err );
+                    const xi_control_message_file_desc_t* file =
+                        &control_message->file_info.list[id_file];
 
-                    xi_cbor_put_name_and_revision(
-                        file, control_message->file_info.list[id_file].name,
-                        control_message->file_info.list[id_file].revision, &err );
+                    xi_cbor_put_head(
+                        writer, XI_CBOR_MAJOR_MAP,
+                        xi_cbor_name_and_revision_field_count( file->name,
+                                                               file->revision ) );
 
-                    cn_cbor_array_append( files, file, &err );
+                    xi_cbor_put_name_and_revision_fields( writer, file->name,
+                                                          file->revision );
                 }
 
-                cn_cbor_map_put(
-                    cb_map, cn_cbor_string_create(
-                                XI_CBOR_CODEC_CT_STRING_LIST CBOR_CONTEXT_PARAM, &err ),
-                    files, &err );
-
-                cn_cbor* cn_cbor_bool = CN_CALLOC_CONTEXT();
-                if ( NULL != cn_cbor_bool )
-                {
-                    cn_cbor_bool->type =
-                        ( 0 != control_message->file_info.flag_accept_download_link )
-                            ? CN_CBOR_TRUE
-                            : CN_CBOR_FALSE;
-
-                    cn_cbor_map_put(
-                        cb_map,
-                        cn_cbor_string_create(
-                            XI_CBOR_CODEC_CT_STRING_FILE_DOWNLOADLINK CBOR_CONTEXT_PARAM,
-                            &err ),
-                        cn_cbor_bool, &err );
-                }
+                xi_cbor_put_text( writer, XI_CBOR_CODEC_CT_STRING_FILE_DOWNLOADLINK );
+                xi_cbor_put_bool( writer,
+                                  control_message->file_info.flag_accept_download_link );
             }
             break;
 
         case XI_CONTROL_MESSAGE_CS__SFT_FILE_GET_CHUNK:
 
-            xi_cbor_put_name_and_revision( cb_map, control_message->file_get_chunk.name,
-                                           control_message->file_get_chunk.revision,
-                                           &err );
-
-            cn_cbor_map_put(
-                cb_map,
-                cn_cbor_string_create(
-                    XI_CBOR_CODEC_CT_STRING_FILECHUNK_OFFSET CBOR_CONTEXT_PARAM, &err ),
-                cn_cbor_int_create(
-                    control_message->file_get_chunk.offset CBOR_CONTEXT_PARAM, &err ),
-                &err );
-
-            cn_cbor_map_put(
-                cb_map,
-                cn_cbor_string_create(
-                    XI_CBOR_CODEC_CT_STRING_FILECHUNK_LENGTH CBOR_CONTEXT_PARAM, &err ),
-                cn_cbor_int_create(
-                    control_message->file_get_chunk.length CBOR_CONTEXT_PARAM, &err ),
-                &err );
+            xi_cbor_put_name_and_revision_fields(
+                writer, control_message->file_get_chunk.name,
+                control_message->file_get_chunk.revision );
 
+            xi_cbor_put_key_int( writer, XI_CBOR_CODEC_CT_STRING_FILECHUNK_OFFSET,
+                                 control_message->file_get_chunk.offset );
+            xi_cbor_put_key_int( writer, XI_CBOR_CODEC_CT_STRING_FILECHUNK_LENGTH,
+                                 control_message->file_get_chunk.length );
             break;
 
         case XI_CONTROL_MESSAGE_CS__SFT_FILE_STATUS:
 
-            xi_cbor_put_name_and_revision( cb_map, control_message->file_status.name,
-                                           control_message->file_status.revision, &err );
-
-            cn_cbor_map_put(
-                cb_map,
-                cn_cbor_string_create(
-                    XI_CBOR_CODEC_CT_STRING_FILESTATUS_PHASE CBOR_CONTEXT_PARAM, &err ),
-                cn_cbor_int_create( control_message->file_status.phase CBOR_CONTEXT_PARAM,
-                                    &err ),
-                &err );
-
-            cn_cbor_map_put(
-                cb_map,
-                cn_cbor_string_create(
-                    XI_CBOR_CODEC_CT_STRING_FILESTATUS_CODE CBOR_CONTEXT_PARAM, &err ),
-                cn_cbor_int_create( control_message->file_status.code CBOR_CONTEXT_PARAM,
-                                    &err ),
-                &err );
+            xi_cbor_put_name_and_revision_fields( writer,
+                                                  control_message->file_status.name,
+                                                  control_message->file_status.revision );
 
+            xi_cbor_put_key_int( writer, XI_CBOR_CODEC_CT_STRING_FILESTATUS_PHASE,
+                                 control_message->file_status.phase );
+            xi_cbor_put_key_int( writer, XI_CBOR_CODEC_CT_STRING_FILESTATUS_CODE,
+                                 control_message->file_status.code );
             break;
 
         /* the followings are encoded by the broker and decoded by the client */
@@ -238,265 +287,695 @@ void xi_cbor_codec_ct_encode( const xi_control_message_t* control_message,
         case XI_CONTROL_MESSAGE_SC__SFT_FILE_CHUNK:
         default:
 
-            xi_debug_format(
-                "WARNING: CBOR encoder was called with server to client message type %d",
-                control_message->common.msgtype );
+            /* warn only once, not for the sizing run too */
+            if ( NULL != writer->buffer )
+            {
+                xi_debug_format( "WARNING: CBOR encoder was called with server to "
+                                 "client message type %d",
+                                 control_message->common.msgtype );
+            }
     }
+}
+
+void xi_cbor_codec_ct_encode( const xi_control_message_t* control_message,
+                              uint8_t** out_encoded_allocated_inside,
+                              uint32_t* out_len )
+{
+    xi_state_t state        = XI_STATE_OK;
+    xi_cbor_writer_t writer = {NULL, 0};
 
-    xi_cbor_codec_ct_encode_generate_buffer( cb_map, out_encoded_allocated_inside,
-                                             out_len, XI_CBOR_MESSAGE_MIN_BUFFER_SIZE,
-                                             XI_CBOR_MESSAGE_MAX_BUFFER_SIZE );
+    *out_encoded_allocated_inside = NULL;
+    *out_len                      = 0;
+
+    if ( NULL == control_message )
+    {
+        return;
+    }
+
+    /* sizing run */
+    xi_cbor_codec_ct_encode_message( &writer, control_message );
+
+    XI_CHECK_CND_DBGMESSAGE( XI_CBOR_MESSAGE_MAX_BUFFER_SIZE < writer.pos,
+                             XI_SERIALIZATION_ERROR, state,
+                             "ERROR: control message exceeds the maximum CBOR size" );
+
+    XI_ALLOC_BUFFER_AT( uint8_t, writer.buffer, writer.pos, state );
+
+    /* writing run */
+    writer.pos = 0;
+    xi_cbor_codec_ct_encode_message( &writer, control_message );
+
+    *out_encoded_allocated_inside = writer.buffer;
+    *out_len                      = writer.pos;
+
+err_handling:;
 }
 
-xi_state_t xi_cbor_codec_ct_decode_getvalue( cn_cbor* source,
-                                             const char* key,
-                                             void* out_destination,
-                                             uint16_t* out_len )
+/*-----------------------------------------------------------------------
+ * DECODER
+ * ----------------------------------------------------------------------- */
+
+typedef struct xi_cbor_reader_s
+{
+    const uint8_t* data;
+    uint32_t len;
+    uint32_t pos;
+    xi_state_t state; /* once not OK every read fails */
+} xi_cbor_reader_t;
+
+typedef struct xi_cbor_item_s
 {
-    xi_state_t state = XI_INVALID_PARAMETER;
+    uint8_t major;
+    uint8_t indefinite;
+    uint64_t value; /* integer value, length or number of elements */
+} xi_cbor_item_t;
 
-    if ( NULL == source )
+static uint8_t xi_cbor_reader_fail( xi_cbor_reader_t* reader )
+{
+    reader->state = XI_ELEMENT_NOT_FOUND;
+    return 0;
+}
+
+/* reads the head of the next data item, returns 0 on malformed or truncated input */
+static uint8_t xi_cbor_get_head( xi_cbor_reader_t* reader, xi_cbor_item_t* item )
+{
+    if ( XI_STATE_OK != reader->state || reader->pos >= reader->len )
     {
-        return state;
+        return xi_cbor_reader_fail( reader );
     }
 
-    cn_cbor* source_value = cn_cbor_mapget_string( source, key );
+    const uint8_t initial_byte    = reader->data[reader->pos++];
+    const uint8_t additional_info = initial_byte & 0x1f;
+
+    item->major      = initial_byte >> 5;
+    item->indefinite = 0;
+    item->value      = additional_info;
 
-    if ( NULL != source_value )
+    if ( 24 <= additional_info && additional_info <= 27 )
     {
-        // xi_debug_printf( "[ CBOR ] type: %d,\n", source_value->type );
+        const uint8_t argument_len = ( uint8_t )( 1 << ( additional_info - 24 ) );
+        uint8_t i                  = 0;
 
-        state = XI_STATE_OK;
+        if ( reader->len - reader->pos < argument_len )
+        {
+            return xi_cbor_reader_fail( reader );
+        }
 
-        switch ( source_value->type )
+        item->value = 0;
+        for ( ; i < argument_len; ++i )
         {
-            case CN_CBOR_FALSE:
-                *( ( uint32_t* )out_destination ) = 0;
-                break;
-            case CN_CBOR_TRUE:
-                *( ( uint32_t* )out_destination ) = 1;
-                break;
-            case CN_CBOR_NULL:
-            case CN_CBOR_UNDEF:
-            case CN_CBOR_UINT:
-            case CN_CBOR_INT:
-            case CN_CBOR_TAG:
-            case CN_CBOR_SIMPLE:
-            case CN_CBOR_DOUBLE:
+            item->value = item->value << 8 | reader->data[reader->pos++];
+        }
+    }
+    else if ( XI_CBOR_ADDITIONAL_INFO_INDEFINITE == additional_info )
+    {
+        /* indefinite length strings and containers, the break code is handled by
+         * xi_cbor_has_next */
+        if ( item->major < XI_CBOR_MAJOR_BYTES || XI_CBOR_MAJOR_MAP < item->major )
+        {
+            return xi_cbor_reader_fail( reader );
+        }
+
+        item->indefinite = 1;
+    }
+    else if ( 24 < additional_info )
+    {
+        return xi_cbor_reader_fail( reader );
+    }
+
+    return 1;
+}
 
-                // xi_debug_printf( "source_value: %lu\n", source_value->v.uint );
+/* true while the container has elements left, consumes the break of indefinite ones */
+static uint8_t xi_cbor_has_next( xi_cbor_reader_t* reader, xi_cbor_item_t* container )
+{
+    if ( XI_STATE_OK != reader->state )
+    {
+        return 0;
+    }
 
-                *( ( uint32_t* )out_destination ) = source_value->v.uint;
+    if ( container->indefinite )
+    {
+        if ( reader->pos >= reader->len )
+        {
+            return xi_cbor_reader_fail( reader );
+        }
 
-                break;
+        if ( XI_CBOR_BREAK == reader->data[reader->pos] )
+        {
+            ++reader->pos;
+            return 0;
+        }
 
-            case CN_CBOR_BYTES:
+        return 1;
+    }
 
-                if ( 0 == source_value->length )
-                {
-                    break;
-                }
-                // xi_debug_printf( "CN_CBOR_BYTES / source_value: %s, length: %d\n",
-                //                  ( char* )source_value->v.bytes, source_value->length
-                //                  );
+    if ( 0 == container->value )
+    {
+        return 0;
+    }
+
+    --container->value;
+    return 1;
+}
+
+/* consumes the payload of a definite length string, returns pointer to its bytes */
+static const uint8_t*
+xi_cbor_get_string_bytes( xi_cbor_reader_t* reader, const xi_cbor_item_t* item )
+{
+    if ( XI_STATE_OK != reader->state || reader->len - reader->pos < item->value )
+    {
+        xi_cbor_reader_fail( reader );
+        return NULL;
+    }
+
+    const uint8_t* bytes = reader->data + reader->pos;
+    reader->pos += ( uint32_t )item->value;
+
+    return bytes;
+}
 
-                XI_ALLOC_BUFFER_AT( uint8_t, *( uint8_t** )out_destination,
-                                    source_value->length, state );
+static void xi_cbor_skip_item_content( xi_cbor_reader_t* reader,
+                                       xi_cbor_item_t* item,
+                                       uint8_t nesting );
 
-                memcpy( *( uint8_t** )out_destination, source_value->v.bytes,
-                        source_value->length );
+static void xi_cbor_skip_item( xi_cbor_reader_t* reader, uint8_t nesting )
+{
+    xi_cbor_item_t item;
+
+    if ( xi_cbor_get_head( reader, &item ) )
+    {
+        xi_cbor_skip_item_content( reader, &item, nesting );
+    }
+}
 
-                if ( NULL != out_len )
+static void xi_cbor_skip_item_content( xi_cbor_reader_t* reader,
+                                       xi_cbor_item_t* item,
+                                       uint8_t nesting )
+{
+    if ( XI_CBOR_MAX_NESTING <= nesting )
+    {
+        xi_cbor_reader_fail( reader );
+        return;
+    }
+
+    switch ( item->major )
+    {
+        case XI_CBOR_MAJOR_BYTES:
+        case XI_CBOR_MAJOR_TEXT:
+            if ( item->indefinite )
+            {
+                /* chunks of an indefinite string */
+                while ( xi_cbor_has_next( reader, item ) )
                 {
-                    *out_len = source_value->length;
+                    xi_cbor_skip_item( reader, nesting + 1 );
                 }
+            }
+            else
+            {
+                xi_cbor_get_string_bytes( reader, item );
+            }
+            break;
+        case XI_CBOR_MAJOR_ARRAY:
+            while ( xi_cbor_has_next( reader, item ) )
+            {
+                xi_cbor_skip_item( reader, nesting + 1 );
+            }
+            break;
+        case XI_CBOR_MAJOR_MAP:
+            while ( xi_cbor_has_next( reader, item ) )
+            {
+                xi_cbor_skip_item( reader, nesting + 1 );
+                xi_cbor_skip_item( reader, nesting + 1 );
+            }
+            break;
+        case XI_CBOR_MAJOR_TAG:
+            xi_cbor_skip_item( reader, nesting + 1 );
+            break;
+        default:; /* integers and simple values have no content */
+    }
+}
+
+/* compares a map key read by xi_cbor_get_key with the expected one */
+static uint8_t
+xi_cbor_key_is( const uint8_t* key, uint32_t key_len, const char* expected )
+{
+    return strlen( expected ) == key_len && 0 == memcmp( key, expected, key_len );
+}
+
+/* reads an integer or bool value into a uint32_t, other types are skipped */
+static void xi_cbor_get_uint32( xi_cbor_reader_t* reader, uint32_t* out_value )
+{
+    xi_cbor_item_t item;
+
+    if ( !xi_cbor_get_head( reader, &item ) )
+    {
+        return;
+    }
 
-                break;
+    switch ( item.major )
+    {
+        case XI_CBOR_MAJOR_UINT:
+            *out_value = ( uint32_t )item.value;
+            break;
+        case XI_CBOR_MAJOR_NEGINT:
+            *out_value = ( uint32_t )( -1 - ( int64_t )item.value );
+            break;
+        case XI_CBOR_MAJOR_SIMPLE:
+            *out_value = ( XI_CBOR_SIMPLE_TRUE == item.value ) ? 1 : 0;
+            break;
+        default:
+            xi_cbor_skip_item_content( reader, &item, 1 );
+    }
+}
 
-            case CN_CBOR_TEXT:
+static void xi_cbor_get_uint8( xi_cbor_reader_t* reader, uint8_t* out_value )
+{
+    uint32_t value = *out_value;
 
-                // xi_debug_printf( "source_value: %s, length: %d\n", source_value->v.str,
-                //                  source_value->length );
+    xi_cbor_get_uint32( reader, &value );
 
-                XI_ALLOC_BUFFER_AT( char, *( char** )out_destination,
-                                    source_value->length + 1, state );
+    *out_value = ( uint8_t )value;
+}
 
-                memcpy( *( char** )out_destination, source_value->v.str,
-                        source_value->length );
+/* reads a definite length text or byte string, other types are skipped */
+static const uint8_t*
+xi_cbor_get_bytes( xi_cbor_reader_t* reader, uint32_t* out_len )
+{
+    xi_cbor_item_t item;
 
-                break;
+    if ( !xi_cbor_get_head( reader, &item ) )
+    {
+        return NULL;
+    }
 
-            case CN_CBOR_BYTES_CHUNKED:
-            case CN_CBOR_TEXT_CHUNKED:
-            case CN_CBOR_ARRAY:
-            case CN_CBOR_MAP:
-            case CN_CBOR_INVALID:
-                state = XI_NOT_IMPLEMENTED;
-                break;
-        }
+    if ( ( XI_CBOR_MAJOR_BYTES != item.major && XI_CBOR_MAJOR_TEXT != item.major ) ||
+         item.indefinite )
+    {
+        xi_cbor_skip_item_content( reader, &item, 1 );
+        return NULL;
     }
-    else
+
+    const uint8_t* bytes = xi_cbor_get_string_bytes( reader, &item );
+    *out_len             = ( uint32_t )item.value;
+
+    return bytes;
+}
+
+/* copies a string value into a zero terminated allocated buffer, the first occurrence
+ * of a key wins */
+static xi_state_t xi_cbor_get_string_copy( xi_cbor_reader_t* reader, char** out_string )
+{
+    xi_state_t state   = XI_STATE_OK;
+    uint32_t bytes_len = 0;
+
+    const uint8_t* bytes = xi_cbor_get_bytes( reader, &bytes_len );
+
+    if ( NULL == bytes || NULL != *out_string )
     {
-        xi_debug_printf( "[ CBOR ] element not found for key: '%s'\n", key );
-        state = XI_ELEMENT_NOT_FOUND;
+        return XI_STATE_OK;
     }
 
+    XI_ALLOC_BUFFER_AT( char, *out_string, bytes_len + 1, state );
+    memcpy( *out_string, bytes, bytes_len );
+
 err_handling:
+    return state;
+}
+
+static xi_state_t xi_cbor_get_bytes_copy( xi_cbor_reader_t* reader,
+                                          uint8_t** out_bytes,
+                                          uint16_t* out_len )
+{
+    xi_state_t state   = XI_STATE_OK;
+    uint32_t bytes_len = 0;
+
+    const uint8_t* bytes = xi_cbor_get_bytes( reader, &bytes_len );
 
+    if ( NULL == bytes || 0 == bytes_len || NULL != *out_bytes )
+    {
+        return XI_STATE_OK;
+    }
+
+    XI_ALLOC_BUFFER_AT( uint8_t, *out_bytes, bytes_len, state );
+    memcpy( *out_bytes, bytes, bytes_len );
+    *out_len = ( uint16_t )bytes_len;
+
+err_handling:
     return state;
 }
 
-xi_control_message_t* xi_cbor_codec_ct_decode( const uint8_t* data, const uint32_t len )
+/* opens a map or array, anything else is skipped */
+static uint8_t xi_cbor_get_container( xi_cbor_reader_t* reader,
+                                      uint8_t major,
+                                      xi_cbor_item_t* container )
 {
-    cn_cbor_errback err;
-    cn_cbor* cb_map = cn_cbor_decode( data, len CBOR_CONTEXT_PARAM, &err );
+    if ( !xi_cbor_get_head( reader, container ) )
+    {
+        return 0;
+    }
 
-    xi_control_message_t* control_message_out = NULL;
+    if ( major != container->major )
+    {
+        xi_cbor_skip_item_content( reader, container, 1 );
+        return 0;
+    }
 
+    return 1;
+}
+
+/* reads the next map key, non text keys are skipped together with their values */
+static uint8_t xi_cbor_get_key( xi_cbor_reader_t* reader,
+                                const uint8_t** out_key,
+                                uint32_t* out_key_len )
+{
+    xi_cbor_item_t item;
+
+    if ( !xi_cbor_get_head( reader, &item ) )
+    {
+        return 0;
+    }
+
+    if ( XI_CBOR_MAJOR_TEXT != item.major || item.indefinite )
+    {
+        xi_cbor_skip_item_content( reader, &item, 1 );
+        xi_cbor_skip_item( reader, 1 );
+        return 0;
+    }
+
+    *out_key     = xi_cbor_get_string_bytes( reader, &item );
+    *out_key_len = ( uint32_t )item.value;
+
+    return NULL != *out_key;
+}
+
+static xi_state_t
+xi_cbor_codec_ct_decode_file_desc_ext( xi_cbor_reader_t* reader,
+                                       xi_control_message_file_desc_ext_t* file )
+{
     xi_state_t state = XI_STATE_OK;
-    cn_cbor* msgtype = NULL;
-    cn_cbor* msgver  = NULL;
+    xi_cbor_item_t map;
+    const uint8_t* key = NULL;
+    uint32_t key_len   = 0;
 
-    XI_CHECK_CND_DBGMESSAGE( NULL == cb_map, XI_ELEMENT_NOT_FOUND, state,
-                             "ERROR: data is not a CBOR binary" );
+    if ( !xi_cbor_get_container( reader, XI_CBOR_MAJOR_MAP, &map ) )
+    {
+        return XI_STATE_OK;
+    }
 
-    XI_ALLOC_AT( xi_control_message_t, control_message_out, state );
+    while ( XI_STATE_OK == state && xi_cbor_has_next( reader, &map ) )
+    {
+        if ( !xi_cbor_get_key( reader, &key, &key_len ) )
+        {
+            continue;
+        }
 
-    msgtype = cn_cbor_mapget_string( cb_map, XI_CBOR_CODEC_CT_STRING_MSGTYPE );
-    XI_CHECK_CND_DBGMESSAGE( NULL == msgtype, XI_INVALID_PARAMETER, state,
-                             "ERROR: no 'msgtype' found" );
-    control_message_out->common.msgtype = ( xi_control_message_type_t )msgtype->v.uint;
+        if ( xi_cbor_key_is( key, key_len, XI_CBOR_CODEC_CT_STRING_FILE_NAME ) )
+        {
+            state = xi_cbor_get_string_copy( reader, &file->name );
+        }
+        else if ( xi_cbor_key_is( key, key_len, XI_CBOR_CODEC_CT_STRING_FILE_REVISION ) )
+        {
+            state = xi_cbor_get_string_copy( reader, &file->revision );
+        }
+        else if ( xi_cbor_key_is( key, key_len,
+                                  XI_CBOR_CODEC_CT_STRING_FILE_OPERATION ) )
+        {
+            xi_cbor_get_uint8( reader, &file->file_operation );
+        }
+        else if ( xi_cbor_key_is( key, key_len,
+                                  XI_CBOR_CODEC_CT_STRING_FILE_IMAGESIZE ) )
+        {
+            xi_cbor_get_uint32( reader, &file->size_in_bytes );
+        }
+        else if ( xi_cbor_key_is( key, key_len,
+                                  XI_CBOR_CODEC_CT_STRING_FILE_FINGERPRINT ) )
+        {
+            state = xi_cbor_get_bytes_copy( reader, &file->fingerprint,
+                                            &file->fingerprint_len );
+        }
+        else if ( xi_cbor_key_is( key, key_len,
+                                  XI_CBOR_CODEC_CT_STRING_FILE_DOWNLOADLINK ) )
+        {
+            state = xi_cbor_get_string_copy( reader, &file->download_link );
+        }
+        else if ( xi_cbor_key_is( key, key_len,
+                                  XI_CBOR_CODEC_CT_STRING_FILE_MQTT_DL_SUPPORTED ) )
+        {
+            xi_cbor_get_uint8( reader, &file->flag_mqtt_download_also_supported );
+        }
+        else
+        {
+            xi_cbor_skip_item( reader, 1 );
+        }
+    }
 
+    return state;
+}
 
-    msgver = cn_cbor_mapget_string( cb_map, XI_CBOR_CODEC_CT_STRING_MSGVER );
-    XI_CHECK_CND_DBGMESSAGE( NULL == msgver, XI_INVALID_PARAMETER, state,
-                             "ERROR: no 'msgver' found" );
-    control_message_out->common.msgver = msgver->v.uint;
+static xi_state_t
+xi_cbor_codec_ct_decode_file_list( xi_cbor_reader_t* reader,
+                                   xi_control_message_t* control_message )
+{
+    xi_state_t state = XI_STATE_OK;
+    xi_cbor_item_t list;
+    uint64_t list_len = 0;
+    uint16_t id_file  = 0;
 
+    if ( NULL != control_message->file_update_available.list )
+    {
+        /* repeated list key */
+        xi_cbor_skip_item( reader, 1 );
+        return XI_STATE_OK;
+    }
 
-    switch ( ( xi_control_message_type_t )msgtype->v.uint )
+    if ( !xi_cbor_get_container( reader, XI_CBOR_MAJOR_ARRAY, &list ) )
     {
-        case XI_CONTROL_MESSAGE_SC__SFT_FILE_UPDATE_AVAILABLE:
+        return XI_STATE_OK;
+    }
+
+    list_len = list.value;
+
+    /* count the elements of an indefinite array upfront, skipping is cheap */
+    if ( list.indefinite )
+    {
+        xi_cbor_reader_t counter = *reader;
+
+        for ( list_len = 0; xi_cbor_has_next( &counter, &list ); ++list_len )
         {
-            cn_cbor* list = cn_cbor_mapget_string( cb_map, XI_CBOR_CODEC_CT_STRING_LIST );
+            xi_cbor_skip_item( &counter, 1 );
+        }
+    }
+
+    /* every element takes at least a byte */
+    XI_CHECK_CND_DBGMESSAGE( 0xffff < list_len || reader->len - reader->pos < list_len,
+                             XI_ELEMENT_NOT_FOUND, state,
+                             "ERROR: invalid file list length" );
+
+    if ( 0 < list_len )
+    {
+        XI_ALLOC_BUFFER_AT( xi_control_message_file_desc_ext_t,
+                            control_message->file_update_available.list,
+                            sizeof( xi_control_message_file_desc_ext_t ) * list_len,
+                            state );
+    }
+
+    control_message->file_update_available.list_len = ( uint16_t )list_len;
+
+    for ( ; XI_STATE_OK == state && xi_cbor_has_next( reader, &list ); ++id_file )
+    {
+        state = xi_cbor_codec_ct_decode_file_desc_ext(
+            reader, &control_message->file_update_available.list[id_file] );
+    }
+
+err_handling:
+    return state;
+}
+
+static xi_state_t xi_cbor_codec_ct_decode_field( xi_cbor_reader_t* reader,
+                                                 xi_control_message_t* control_message,
+                                                 const uint8_t* key,
+                                                 uint32_t key_len )
+{
+    switch ( control_message->common.msgtype )
+    {
+        case XI_CONTROL_MESSAGE_SC__SFT_FILE_UPDATE_AVAILABLE:
+
+            if ( xi_cbor_key_is( key, key_len, XI_CBOR_CODEC_CT_STRING_LIST ) )
+            {
+                return xi_cbor_codec_ct_decode_file_list( reader, control_message );
+            }
+            break;
 
-            if ( NULL != list )
+        case XI_CONTROL_MESSAGE_SC__SFT_FILE_CHUNK:
+
+            if ( xi_cbor_key_is( key, key_len, XI_CBOR_CODEC_CT_STRING_FILE_NAME ) )
+            {
+                return xi_cbor_get_string_copy( reader,
+                                                &control_message->file_chunk.name );
+            }
+            else if ( xi_cbor_key_is( key, key_len,
+                                      XI_CBOR_CODEC_CT_STRING_FILE_REVISION ) )
+            {
+                return xi_cbor_get_string_copy( reader,
+                                                &control_message->file_chunk.revision );
+            }
+            else if ( xi_cbor_key_is( key, key_len,
+                                      XI_CBOR_CODEC_CT_STRING_FILECHUNK_OFFSET ) )
+            {
+                xi_cbor_get_uint32( reader, &control_message->file_chunk.offset );
+                return XI_STATE_OK;
+            }
+            else if ( xi_cbor_key_is( key, key_len,
+                                      XI_CBOR_CODEC_CT_STRING_FILECHUNK_STATUS ) )
             {
-                control_message_out->file_update_available.list_len = list->length;
+                xi_cbor_get_uint8( reader, &control_message->file_chunk.status );
+                return XI_STATE_OK;
+            }
+            else if ( xi_cbor_key_is( key, key_len,
+                                      XI_CBOR_CODEC_CT_STRING_FILECHUNK_CHUNK ) &&
+                      NULL == control_message->file_chunk.chunk )
+            {
+                /* the length field of the protocol is redundant, the length of the
+                 * byte string is used instead */
+                uint32_t chunk_len = 0;
+                const uint8_t* chunk = xi_cbor_get_bytes( reader, &chunk_len );
 
-                if ( 0 < list->length )
+                if ( NULL != chunk && 0 < chunk_len )
                 {
-                    XI_ALLOC_BUFFER_AT( xi_control_message_file_desc_ext_t,
-                                        control_message_out->file_update_available.list,
-                                        sizeof( xi_control_message_file_desc_ext_t ) *
-                                            list->length,
-                                        state );
-
-                    uint16_t id_file = 0;
-                    for ( ; id_file < list->length; ++id_file )
-                    {
-                        cn_cbor* file = cn_cbor_index( list, id_file );
-
-                        xi_cbor_codec_ct_decode_getvalue(
-                            file, XI_CBOR_CODEC_CT_STRING_FILE_NAME,
-                            &control_message_out->file_update_available.list[id_file]
-                                 .name,
-                            NULL );
-
-                        xi_cbor_codec_ct_decode_getvalue(
-                            file, XI_CBOR_CODEC_CT_STRING_FILE_REVISION,
-                            &control_message_out->file_update_available.list[id_file]
-                                 .revision,
-                            NULL );
-
-                        xi_cbor_codec_ct_decode_getvalue(
-                            file, XI_CBOR_CODEC_CT_STRING_FILE_OPERATION,
-                            &control_message_out->file_update_available.list[id_file]
-                                 .file_operation,
-                            NULL );
-
-                        xi_cbor_codec_ct_decode_getvalue(
-                            file, XI_CBOR_CODEC_CT_STRING_FILE_IMAGESIZE,
-                            &control_message_out->file_update_available.list[id_file]
-                                 .size_in_bytes,
-                            NULL );
-
-                        xi_cbor_codec_ct_decode_getvalue(
-                            file, XI_CBOR_CODEC_CT_STRING_FILE_FINGERPRINT,
-                            &control_message_out->file_update_available.list[id_file]
-                                 .fingerprint,
-                            &control_message_out->file_update_available.list[id_file]
-                                 .fingerprint_len );
-
-                        xi_cbor_codec_ct_decode_getvalue(
-                            file, XI_CBOR_CODEC_CT_STRING_FILE_DOWNLOADLINK,
-                            &control_message_out->file_update_available.list[id_file]
-                                 .download_link,
-                            NULL );
-
-                        xi_cbor_codec_ct_decode_getvalue(
-                            file, XI_CBOR_CODEC_CT_STRING_FILE_MQTT_DL_SUPPORTED,
-                            &control_message_out->file_update_available.list[id_file]
-                                 .flag_mqtt_download_also_supported,
-                            NULL );
-                    }
+                    control_message->file_chunk.chunk               = ( uint8_t* )chunk;
+                    control_message->file_chunk.length              = chunk_len;
+                    control_message->file_chunk.flag_chunk_borrowed = 1;
                 }
+
+                return XI_STATE_OK;
             }
-        }
+            break;
 
-        break;
+        default:
+            break;
+    }
 
-        case XI_CONTROL_MESSAGE_SC__SFT_FILE_CHUNK:
+    xi_cbor_skip_item( reader, 1 );
+
+    return XI_STATE_OK;
+}
 
-            xi_cbor_codec_ct_decode_getvalue( cb_map, XI_CBOR_CODEC_CT_STRING_FILE_NAME,
-                                              &control_message_out->file_chunk.name,
-                                              NULL );
+/* finds msgtype and msgver, everything else in the message depends on the type */
+static xi_state_t xi_cbor_codec_ct_decode_header( xi_cbor_reader_t reader,
+                                                  xi_control_message_t* control_message )
+{
+    xi_cbor_item_t map;
+    const uint8_t* key    = NULL;
+    uint32_t key_len      = 0;
+    uint8_t found_msgtype = 0;
+    uint8_t found_msgver  = 0;
+    uint32_t msgtype      = 0;
+
+    if ( !xi_cbor_get_container( &reader, XI_CBOR_MAJOR_MAP, &map ) )
+    {
+        xi_debug_logger( "ERROR: data is not a CBOR binary" );
+        return XI_ELEMENT_NOT_FOUND;
+    }
 
-            xi_cbor_codec_ct_decode_getvalue(
-                cb_map, XI_CBOR_CODEC_CT_STRING_FILE_REVISION,
-                &control_message_out->file_chunk.revision, NULL );
+    while ( !( found_msgtype && found_msgver ) && xi_cbor_has_next( &reader, &map ) )
+    {
+        if ( !xi_cbor_get_key( &reader, &key, &key_len ) )
+        {
+            continue;
+        }
 
-            xi_cbor_codec_ct_decode_getvalue(
-                cb_map, XI_CBOR_CODEC_CT_STRING_FILECHUNK_OFFSET,
-                &control_message_out->file_chunk.offset, NULL );
+        if ( !found_msgtype &&
+             xi_cbor_key_is( key, key_len, XI_CBOR_CODEC_CT_STRING_MSGTYPE ) )
+        {
+            xi_cbor_get_uint32( &reader, &msgtype );
+            found_msgtype = 1;
+        }
+        else if ( !found_msgver &&
+                  xi_cbor_key_is( key, key_len, XI_CBOR_CODEC_CT_STRING_MSGVER ) )
+        {
+            xi_cbor_get_uint32( &reader, &control_message->common.msgver );
+            found_msgver = 1;
+        }
+        else
+        {
+            xi_cbor_skip_item( &reader, 1 );
+        }
+    }
 
-            /*  This 'length' field is redundant since the CBOR encoding contains
-                the length of the byte array right in the array. So here we don't
-                rely on protocol's length field but the CBOR's array size.
-                Thus ignoring the 'length' field itself.
+    if ( !found_msgtype || !found_msgver )
+    {
+        xi_debug_logger( "ERROR: no 'msgtype' or 'msgver' found" );
+        return XI_INVALID_PARAMETER;
+    }
 
-            xi_cbor_codec_ct_decode_getvalue(
-                cb_map, XI_CBOR_CODEC_CT_STRING_FILECHUNK_LENGTH,
-                &control_message_out->file_chunk.length, NULL );*/
+    control_message->common.msgtype = ( xi_control_message_type_t )msgtype;
 
-            xi_cbor_codec_ct_decode_getvalue(
-                cb_map, XI_CBOR_CODEC_CT_STRING_FILECHUNK_STATUS,
-                &control_message_out->file_chunk.status, NULL );
+    return XI_STATE_OK;
+}
 
-            xi_cbor_codec_ct_decode_getvalue(
-                cb_map, XI_CBOR_CODEC_CT_STRING_FILECHUNK_CHUNK,
-                &control_message_out->file_chunk.chunk,
-                ( uint16_t* )&control_message_out->file_chunk.length );
+xi_control_message_t* xi_cbor_codec_ct_decode( const uint8_t* data, const uint32_t len )
+{
+    xi_state_t state                          = XI_STATE_OK;
+    xi_control_message_t* control_message_out = NULL;
+    xi_cbor_reader_t reader                   = {data, len, 0, XI_STATE_OK};
+    xi_cbor_item_t map;
+    const uint8_t* key = NULL;
+    uint32_t key_len   = 0;
 
-            break;
+    XI_CHECK_CND_DBGMESSAGE( NULL == data, XI_ELEMENT_NOT_FOUND, state,
+                             "ERROR: data is not a CBOR binary" );
 
+    XI_ALLOC_AT( xi_control_message_t, control_message_out, state );
+
+    state = xi_cbor_codec_ct_decode_header( reader, control_message_out );
+    XI_CHECK_STATE( state );
+
+    switch ( control_message_out->common.msgtype )
+    {
+        case XI_CONTROL_MESSAGE_SC__SFT_FILE_UPDATE_AVAILABLE:
+        case XI_CONTROL_MESSAGE_SC__SFT_FILE_CHUNK:
+            break;
         case XI_CONTROL_MESSAGE_CS__SFT_FILE_INFO:
         case XI_CONTROL_MESSAGE_CS__SFT_FILE_GET_CHUNK:
         case XI_CONTROL_MESSAGE_CS__SFT_FILE_STATUS:
         default:
-
             xi_debug_format(
-                "WARNING: CBOR decoder was called with client to server message type %lu",
-                msgtype->v.uint );
+                "WARNING: CBOR decoder was called with client to server message type %d",
+                control_message_out->common.msgtype );
+    }
+
+    xi_cbor_get_container( &reader, XI_CBOR_MAJOR_MAP, &map );
+
+    while ( XI_STATE_OK == state && xi_cbor_has_next( &reader, &map ) )
+    {
+        if ( !xi_cbor_get_key( &reader, &key, &key_len ) )
+        {
+            continue;
+        }
+
+        if ( xi_cbor_key_is( key, key_len, XI_CBOR_CODEC_CT_STRING_MSGTYPE ) ||
+             xi_cbor_key_is( key, key_len, XI_CBOR_CODEC_CT_STRING_MSGVER ) )
+        {
+            xi_cbor_skip_item( &reader, 1 );
+            continue;
+        }
+
+        state = xi_cbor_codec_ct_decode_field( &reader, control_message_out, key,
+                                               key_len );
     }
 
-    cn_cbor_free( cb_map CBOR_CONTEXT_PARAM );
+    XI_CHECK_STATE( state );
+
+    XI_CHECK_CND_DBGMESSAGE( XI_STATE_OK != reader.state || reader.pos != reader.len,
+                             XI_ELEMENT_NOT_FOUND, state,
+                             "ERROR: data is not a CBOR binary" );
+
     return control_message_out;
 
 err_handling:
 
-    cn_cbor_free( cb_map CBOR_CONTEXT_PARAM );
-    XI_SAFE_FREE( control_message_out );
+    xi_control_message_free( &control_message_out );
 
-    return control_message_out;
+    return NULL;
 }
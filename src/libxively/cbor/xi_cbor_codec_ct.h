@@ -11,10 +11,27 @@
 
 union xi_control_message_u;
 
+/**
+ * @brief xi_cbor_codec_ct_encode encodes a client to service control message
+ *
+ * The encoded size is calculated upfront so the output is written in a single pass
+ * into a buffer allocated with the exact size. On failure *out_len is 0 and
+ * *out_encoded_allocated_inside is NULL.
+ */
 void xi_cbor_codec_ct_encode( const union xi_control_message_u* control_message,
                               uint8_t** out_encoded_allocated_inside,
                               uint32_t* out_len );
 
+/**
+ * @brief xi_cbor_codec_ct_decode decodes a service to client control message
+ *
+ * The message is decoded straight from the buffer without building an intermediate
+ * CBOR tree. The chunk of a FILE_CHUNK message is not copied, it points into data and
+ * file_chunk.flag_chunk_borrowed is set, so data has to outlive the returned message's
+ * chunk.
+ *
+ * @return decoded message or NULL if data is not a well formed CBOR map
+ */
 union xi_control_message_u*
 xi_cbor_codec_ct_decode( const uint8_t* data, const uint32_t len );
 
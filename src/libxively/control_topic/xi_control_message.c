@@ -68,7 +68,11 @@ void xi_control_message_free( xi_control_message_t** control_message )
 
             XI_SAFE_FREE( ( *control_message )->file_chunk.name );
             XI_SAFE_FREE( ( *control_message )->file_chunk.revision );
-            XI_SAFE_FREE( ( *control_message )->file_chunk.chunk );
+
+            if ( 0 == ( *control_message )->file_chunk.flag_chunk_borrowed )
+            {
+                XI_SAFE_FREE( ( *control_message )->file_chunk.chunk );
+            }
 
             break;
 
@@ -117,6 +117,9 @@ typedef union xi_control_message_u {
         uint8_t status;
         uint8_t* chunk;
 
+        /* chunk points into the received buffer, it is not released with the message */
+        uint8_t flag_chunk_borrowed;
+
     } file_chunk;
 
     struct
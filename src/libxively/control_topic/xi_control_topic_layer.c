@@ -125,7 +125,8 @@ xi_control_topic_publish_on_topic( void* context, xi_control_message_t* control_
 
     mqtt_logic_task = xi_mqtt_logic_make_publish_task(
         layer_data->publish_topic_name, encoded_message_data_desc,
-        XI_MQTT_QOS_AT_MOST_ONCE, XI_MQTT_RETAIN_FALSE, xi_make_empty_handle() );
+        XI_MQTT_QOS_AT_MOST_ONCE, XI_MQTT_RETAIN_FALSE, XI_PUBLISH_PRIORITY_NORMAL,
+        xi_make_empty_handle() );
 
     XI_CHECK_MEMORY( mqtt_logic_task, local_state );
 
@@ -197,6 +198,7 @@ xi_state_t xi_on_control_message( xi_context_handle_t in_context_handle,
 #endif
             }
         }
+        break;
         case XI_SUB_CALL_MESSAGE:
         {
             xi_debug_format( "received data on control topic length: %zu ",
@@ -269,6 +271,12 @@ xi_state_t xi_control_topic_connection_state_changed( void* context, xi_state_t
              XI_CONNECTION_STATE_OPENED )
     {
         XI_PROCESS_POST_CONNECT_ON_THIS_LAYER( context, NULL, state );
+
+        /* send what has been published while the connection was down */
+        if ( NULL != XI_CONTEXT_DATA( context )->publish_queue )
+        {
+            xi_publish_queue_schedule_drain( XI_CONTEXT_DATA( context )->publish_queue );
+        }
     }
 
     return state;
@@ -321,6 +329,14 @@ xi_control_topic_layer_init( void* context, void* data, xi_state_t in_out_state
                              &xi_control_topic_publish_on_topic,
                              XI_CONTEXT_DATA( context )->sft_url_handler_callback,
                              context );
+
+        xi_sft_set_download_window( layer_data->sft_context,
+                                    XI_CONTEXT_DATA( context )->sft_chunk_window_size,
+                                    XI_CONTEXT_DATA( context )->sft_chunk_size );
+
+        xi_sft_set_parallel_downloads(
+            layer_data->sft_context, XI_CONTEXT_DATA( context )->sft_parallel_downloads,
+            XI_CONTEXT_DATA( context )->sft_download_memory_budget );
 #endif
     }
 
@@ -372,6 +388,11 @@ xi_control_topic_layer_connect( void* context, void* data, xi_state_t in_out_sta
             xi_control_topic_subscribe( context, subscribe_control_topic_name );
         XI_CHECK_STATE( in_out_state );
 
+#ifdef XI_SECURE_FILE_TRANSFER_ENABLED
+        /* pipelined behind the SUBSCRIBE instead of waiting for the SUBACK */
+        xi_sft_send_file_info( layer_data->sft_context );
+#endif
+
         return in_out_state;
     }
 
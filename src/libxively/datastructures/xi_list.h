@@ -48,6 +48,28 @@
         }                                                                                \
     }
 
+/* inserts elem in front of the first element for which cnd( element, val ) holds, at
+ * the end of the list if there is none, so an ordered list stays ordered */
+#define XI_LIST_INSERT_BEFORE( type, list, cnd, val, elem )                              \
+    {                                                                                    \
+        type* prev = NULL;                                                               \
+        type* curr = list;                                                               \
+        while ( ( NULL != curr ) && ( !cnd( curr, val ) ) )                              \
+        {                                                                                \
+            prev = curr;                                                                 \
+            curr = curr->__next;                                                         \
+        }                                                                                \
+        elem->__next = curr;                                                             \
+        if ( NULL == prev )                                                              \
+        {                                                                                \
+            list = elem;                                                                 \
+        }                                                                                \
+        else                                                                             \
+        {                                                                                \
+            prev->__next = elem;                                                         \
+        }                                                                                \
+    }
+
 #define XI_LIST_DROP( type, list, elem )                                                 \
     {                                                                                    \
         type* prev = list;                                                               \
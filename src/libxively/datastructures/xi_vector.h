@@ -10,6 +10,7 @@
 #include <stdint.h>
 
 #include "xi_allocator.h"
+#include "xi_config.h"
 #include "xi_debug.h"
 #include "xi_macros.h"
 
@@ -18,7 +19,7 @@ extern "C" {
 #endif
 
 /* ! This type has to be SIGNED ! */
-typedef int8_t xi_vector_index_type_t;
+typedef XI_VECTOR_INDEX_TYPE xi_vector_index_type_t;
 
 union xi_vector_selector_u {
     void* ptr_value;
@@ -6,9 +6,12 @@
 
 #include <inttypes.h>
 
+#include "xi_bsp_time.h"
+#include "xi_config.h"
 #include "xi_event_dispatcher_api.h"
 #include "xi_list.h"
 #include "xi_helpers.h"
+#include "xi_stats.h"
 
 static inline int8_t xi_evtd_cmp_fd( const union xi_vector_selector_u* e0,
                                      const union xi_vector_selector_u* value )
@@ -176,19 +179,67 @@ void xi_evtd_continue_when_empty( xi_evtd_instance_t* instance, xi_event_handle_
     instance->on_empty = handle;
 }
 
-xi_event_handle_queue_t*
-xi_evtd_execute( xi_evtd_instance_t* instance, xi_event_handle_t handle )
+/* queue element of a handle not convertible to a closure, its closure points at the
+ * handle stored right behind it */
+typedef struct xi_evtd_handle_queue_elem_s
 {
-    xi_state_t state = XI_STATE_OK;
-    XI_ALLOC_SYSTEM( xi_event_handle_queue_t, queue_elem, state );
+    xi_event_handle_queue_t queue_elem;
+    xi_event_handle_t handle;
+} xi_evtd_handle_queue_elem_t;
+
+/* adapts the handles of any shape to the closures, the handle is passed as a1 */
+static xi_event_handle_return_t xi_evtd_execute_adapted_handle( void* handle,
+                                                                void* unused_a2,
+                                                                xi_state_t unused_a3,
+                                                                void* unused_a4 )
+{
+    XI_UNUSED( unused_a2 );
+    XI_UNUSED( unused_a3 );
+    XI_UNUSED( unused_a4 );
 
-    queue_elem->handle = handle;
+    return xi_evtd_execute_handle( ( xi_event_handle_t* )handle );
+}
+
+/**
+ * @brief xi_evtd_handle_to_closure converts the handles of 4 arguments, the closure is
+ * left untouched for the other ones
+ *
+ * @return 1 if the handle has been converted 0 otherwise
+ */
+static uint8_t
+xi_evtd_handle_to_closure( const xi_event_handle_t* handle, xi_event_closure_t* closure )
+{
+    if ( XI_EVENT_HANDLE_ARGC4 != handle->handle_type )
+    {
+        return 0;
+    }
+
+    *closure = xi_make_closure( handle->handlers.h4.fn_argc4, handle->handlers.h4.a1,
+                                handle->handlers.h4.a2, handle->handlers.h4.a3,
+                                handle->handlers.h4.a4 );
+
+    return 1;
+}
 
+static void xi_evtd_enqueue( xi_evtd_instance_t* instance,
+                             xi_event_handle_queue_t* queue_elem )
+{
     xi_lock_critical_section( instance->cs );
 
     XI_LIST_PUSH_BACK( xi_event_handle_queue_t, instance->call_queue, queue_elem );
 
     xi_unlock_critical_section( instance->cs );
+}
+
+xi_event_handle_queue_t*
+xi_evtd_execute_closure( xi_evtd_instance_t* instance, xi_event_closure_t closure )
+{
+    xi_state_t state = XI_STATE_OK;
+    XI_ALLOC_SYSTEM( xi_event_handle_queue_t, queue_elem, state );
+
+    queue_elem->closure = closure;
+
+    xi_evtd_enqueue( instance, queue_elem );
 
     return queue_elem;
 
@@ -196,6 +247,106 @@ err_handling:
     return NULL;
 }
 
+xi_event_handle_queue_t*
+xi_evtd_execute( xi_evtd_instance_t* instance, xi_event_handle_t handle )
+{
+    xi_event_closure_t closure;
+
+    if ( xi_evtd_handle_to_closure( &handle, &closure ) )
+    {
+        return xi_evtd_execute_closure( instance, closure );
+    }
+
+    xi_state_t state = XI_STATE_OK;
+    XI_ALLOC_SYSTEM( xi_evtd_handle_queue_elem_t, handle_elem, state );
+
+    handle_elem->handle             = handle;
+    handle_elem->queue_elem.closure = xi_make_closure(
+        &xi_evtd_execute_adapted_handle, &handle_elem->handle, NULL, XI_STATE_OK, NULL );
+
+    xi_evtd_enqueue( instance, &handle_elem->queue_elem );
+
+    return &handle_elem->queue_elem;
+
+err_handling:
+    return NULL;
+}
+
+/**
+ * @brief xi_evtd_has_pending_calls_locked is xi_evtd_has_pending_calls for a caller
+ * which already holds the critical section
+ */
+static uint8_t xi_evtd_has_pending_calls_locked( xi_evtd_instance_t* instance )
+{
+    return !XI_LIST_EMPTY( xi_event_handle_queue_t, instance->call_queue ) ||
+           !xi_closure_disposed( &instance->direct_call );
+}
+
+/**
+ * @brief xi_evtd_take_direct_call_slot tells whether the next call can be stored in
+ * the instance instead of the queue, it leaves the critical section locked if so
+ */
+static uint8_t xi_evtd_take_direct_call_slot( xi_evtd_instance_t* instance )
+{
+    xi_lock_critical_section( instance->cs );
+
+    /* the direct call has to be the oldest pending handle to keep the order */
+    if ( 0 < instance->direct_call_depth &&
+         xi_closure_disposed( &instance->direct_call ) &&
+         XI_LIST_EMPTY( xi_event_handle_queue_t, instance->call_queue ) )
+    {
+        return 1;
+    }
+
+    xi_unlock_critical_section( instance->cs );
+
+    return 0;
+}
+
+xi_state_t
+xi_evtd_execute_closure_direct( xi_evtd_instance_t* instance, xi_event_closure_t closure )
+{
+    if ( xi_evtd_take_direct_call_slot( instance ) )
+    {
+        instance->direct_call = closure;
+
+        xi_unlock_critical_section( instance->cs );
+
+        return XI_STATE_OK;
+    }
+
+    if ( NULL == xi_evtd_execute_closure( instance, closure ) )
+    {
+        return XI_OUT_OF_MEMORY;
+    }
+
+    return XI_STATE_OK;
+}
+
+xi_state_t xi_evtd_execute_direct( xi_evtd_instance_t* instance, xi_event_handle_t handle )
+{
+    xi_event_closure_t closure;
+
+    if ( xi_evtd_handle_to_closure( &handle, &closure ) )
+    {
+        return xi_evtd_execute_closure_direct( instance, closure );
+    }
+
+    if ( xi_evtd_take_direct_call_slot( instance ) )
+    {
+        instance->direct_call_handle = handle;
+        instance->direct_call =
+            xi_make_closure( &xi_evtd_execute_adapted_handle,
+                             &instance->direct_call_handle, NULL, XI_STATE_OK, NULL );
+
+        xi_unlock_critical_section( instance->cs );
+
+        return XI_STATE_OK;
+    }
+
+    return NULL == xi_evtd_execute( instance, handle ) ? XI_OUT_OF_MEMORY : XI_STATE_OK;
+}
+
 xi_state_t xi_evtd_execute_in( xi_evtd_instance_t* instance,
                                xi_event_handle_t handle,
                                xi_time_t time_diff,
@@ -271,6 +422,10 @@ xi_evtd_instance_t* xi_evtd_create_instance( void )
 
     XI_CHECK_STATE( xi_init_critical_section( &evtd_instance->cs ) );
 
+    evtd_instance->direct_call_depth  = XI_EVTD_DIRECT_CALL_DEPTH;
+    evtd_instance->step_budget        = XI_EVTD_STEP_BUDGET;
+    evtd_instance->step_time_slice_ms = XI_EVTD_STEP_TIME_SLICE_MS;
+
     return evtd_instance;
 
 err_handling:
@@ -353,6 +508,45 @@ static uint8_t xi_state_is_fatal( xi_state_t e )
     }
 }
 
+static inline xi_event_handle_return_t
+xi_evtd_execute_closure_now( xi_event_closure_t* closure )
+{
+    return ( *closure->fn )( closure->a1, closure->a2, closure->a3, closure->a4 );
+}
+
+/**
+ * @brief xi_evtd_take_direct_call moves the direct call closure out of the instance
+ *
+ * The adapted handle is moved to the handle given since the one in the instance may
+ * be overwritten by the direct calls made during its own execution.
+ *
+ * @return 1 if there was a direct call pending 0 otherwise
+ */
+static uint8_t xi_evtd_take_direct_call( xi_evtd_instance_t* evtd_instance,
+                                         xi_event_closure_t* closure,
+                                         xi_event_handle_t* handle )
+{
+    uint8_t taken = 0;
+
+    xi_lock_critical_section( evtd_instance->cs );
+    if ( !xi_closure_disposed( &evtd_instance->direct_call ) )
+    {
+        *closure = evtd_instance->direct_call;
+        xi_dispose_closure( &evtd_instance->direct_call );
+
+        if ( &evtd_instance->direct_call_handle == closure->a1 )
+        {
+            *handle     = evtd_instance->direct_call_handle;
+            closure->a1 = handle;
+        }
+
+        taken = 1;
+    }
+    xi_unlock_critical_section( evtd_instance->cs );
+
+    return taken;
+}
+
 extern uint8_t
 xi_evtd_single_step( xi_evtd_instance_t* evtd_instance, xi_time_t new_step )
 {
@@ -362,25 +556,52 @@ xi_evtd_single_step( xi_evtd_instance_t* evtd_instance, xi_time_t new_step )
     evtd_instance->current_step = new_step;
 
     xi_event_handle_queue_t* queue_elem = NULL;
+    xi_event_closure_t direct_call;
+    xi_event_handle_t direct_call_handle;
+    xi_state_t result = XI_STATE_OK;
+    uint16_t depth    = 0;
 
-    xi_lock_critical_section( evtd_instance->cs );
-    if ( !XI_LIST_EMPTY( xi_event_handle_queue_t, evtd_instance->call_queue ) )
+    /* a direct call left behind when the depth limit was hit goes first */
+    if ( xi_evtd_take_direct_call( evtd_instance, &direct_call, &direct_call_handle ) )
     {
-        XI_LIST_POP( xi_event_handle_queue_t, evtd_instance->call_queue, queue_elem );
+        result = xi_evtd_execute_closure_now( &direct_call );
     }
-    xi_unlock_critical_section( evtd_instance->cs );
+    else
+    {
+        xi_lock_critical_section( evtd_instance->cs );
+        if ( !XI_LIST_EMPTY( xi_event_handle_queue_t, evtd_instance->call_queue ) )
+        {
+            XI_LIST_POP( xi_event_handle_queue_t, evtd_instance->call_queue,
+                         queue_elem );
+        }
+        xi_unlock_critical_section( evtd_instance->cs );
 
-    if ( queue_elem == NULL )
-        return 0;
+        if ( queue_elem == NULL )
+            return 0;
 
-    const xi_state_t result = xi_evtd_execute_handle( &queue_elem->handle );
+        result = xi_evtd_execute_closure_now( &queue_elem->closure );
+
+        XI_SAFE_FREE( queue_elem );
+    }
 
     if ( xi_state_is_fatal( result ) == 1 )
     {
         xi_debug_logger( "error while processing normal events" );
     }
 
-    XI_SAFE_FREE( queue_elem );
+    /* handles registered with xi_evtd_execute_direct by the ones just executed */
+    for ( ; depth < evtd_instance->direct_call_depth &&
+            xi_evtd_take_direct_call( evtd_instance, &direct_call,
+                                      &direct_call_handle );
+          ++depth )
+    {
+        result = xi_evtd_execute_closure_now( &direct_call );
+
+        if ( xi_state_is_fatal( result ) == 1 )
+        {
+            xi_debug_logger( "error while processing direct calls" );
+        }
+    }
 
     return 1;
 }
@@ -392,6 +613,9 @@ void xi_evtd_step( xi_evtd_instance_t* evtd_instance, xi_time_t new_step )
 
     evtd_instance->current_step = new_step;
     xi_time_event_t* tmp        = NULL;
+    uint32_t handles_run        = 0;
+
+    const uint32_t timer_heap_size = evtd_instance->time_events_container->elem_no;
 
 #ifdef XI_DEUBG_OUTPUT_EVENT_SYSTEM
     xi_debug_format( "[size of time event queue: %d]",
@@ -441,15 +665,31 @@ void xi_evtd_step( xi_evtd_instance_t* evtd_instance, xi_time_t new_step )
     xi_debug_logger( "[enqueued events]" );
 #endif
 
-    /* execute all handlers in call_queue */
-    while ( xi_evtd_single_step( evtd_instance, new_step ) )
-        ;
+    const xi_time_t slice_end_ms =
+        ( 0 < evtd_instance->step_time_slice_ms )
+            ? xi_bsp_time_getcurrenttime_milliseconds() +
+                  evtd_instance->step_time_slice_ms
+            : 0;
+
+    /* execute the handlers in call_queue within the budget of the step */
+    while ( ( 0 == evtd_instance->step_budget ||
+              handles_run < evtd_instance->step_budget ) &&
+            ( 0 == slice_end_ms ||
+              xi_bsp_time_getcurrenttime_milliseconds() < slice_end_ms ) &&
+            xi_evtd_single_step( evtd_instance, new_step ) )
+    {
+        ++handles_run;
+    }
+
+    xi_stats_record_evtd_step( timer_heap_size, handles_run,
+                               xi_evtd_has_pending_calls( evtd_instance ) );
 
     xi_lock_critical_section( evtd_instance->cs );
-    /* here we can call the on_empty handler
+    /* here we can call the on_empty handler once the step left no call queued
      * watch out, handler is called only once and
      * it is disposed after that */
     if ( ( 0 == evtd_instance->time_events_container->elem_no ) &&
+         ( 0 == xi_evtd_has_pending_calls_locked( evtd_instance ) ) &&
          ( evtd_instance->on_empty.handle_type != XI_EVENT_HANDLE_UNSET ) )
     {
         xi_debug_logger( "calling on_empty_handler" );
@@ -464,6 +704,17 @@ void xi_evtd_step( xi_evtd_instance_t* evtd_instance, xi_time_t new_step )
     xi_unlock_critical_section( evtd_instance->cs );
 }
 
+uint8_t xi_evtd_has_pending_calls( xi_evtd_instance_t* instance )
+{
+    uint8_t pending = 0;
+
+    xi_lock_critical_section( instance->cs );
+    pending = xi_evtd_has_pending_calls_locked( instance );
+    xi_unlock_critical_section( instance->cs );
+
+    return pending;
+}
+
 uint8_t xi_evtd_dispatcher_continue( xi_evtd_instance_t* instance )
 {
     return instance != NULL && instance->stop != 1;
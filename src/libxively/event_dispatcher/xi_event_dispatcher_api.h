@@ -51,6 +51,14 @@ typedef struct xi_evtd_instance_s
     xi_vector_t* handles_and_socket_fd;
     xi_vector_t* handles_and_file_fd;
     xi_event_handle_t on_empty;
+    /* closure stored by xi_evtd_execute_direct, always older than the call_queue */
+    xi_event_closure_t direct_call;
+    /* the handle the direct_call adapts if it wasn't convertible to a closure */
+    xi_event_handle_t direct_call_handle;
+    uint16_t direct_call_depth;
+    /* limits of the handles run from the queue by one xi_evtd_step, 0 for none */
+    uint16_t step_budget;
+    uint16_t step_time_slice_ms;
     uint8_t stop;
 } xi_evtd_instance_t;
 
@@ -78,6 +86,32 @@ xi_evtd_continue_when_empty( xi_evtd_instance_t* instance, xi_event_handle_t han
 extern xi_event_handle_queue_t*
 xi_evtd_execute( xi_evtd_instance_t* instance, xi_event_handle_t handle );
 
+/**
+ * @brief xi_evtd_execute_direct schedules the handle the same way xi_evtd_execute does
+ * but without allocating a queue element if the call queue is empty
+ *
+ * The handle is then kept in the instance and xi_evtd_single_step runs it right after
+ * the currently executed handle returns, up to direct_call_depth such handles in a row.
+ * The execution order is the same as if the handle was queued.
+ *
+ * @return XI_STATE_OK or XI_OUT_OF_MEMORY if falling back to the queue failed
+ */
+extern xi_state_t
+xi_evtd_execute_direct( xi_evtd_instance_t* instance, xi_event_handle_t handle );
+
+/**
+ * @brief xi_evtd_execute_closure schedules the closure the same way xi_evtd_execute
+ * schedules a handle, the queue element holds just the closure
+ */
+extern xi_event_handle_queue_t*
+xi_evtd_execute_closure( xi_evtd_instance_t* instance, xi_event_closure_t closure );
+
+/**
+ * @brief xi_evtd_execute_closure_direct is the xi_evtd_execute_direct of closures
+ */
+extern xi_state_t xi_evtd_execute_closure_direct( xi_evtd_instance_t* instance,
+                                                  xi_event_closure_t closure );
+
 extern xi_state_t xi_evtd_execute_in( xi_evtd_instance_t* instance,
                                       xi_event_handle_t handle,
                                       xi_time_t time_diff,
@@ -98,8 +132,21 @@ extern xi_event_handle_return_t xi_evtd_execute_handle( xi_event_handle_t* handl
 
 extern uint8_t xi_evtd_single_step( xi_evtd_instance_t* instance, xi_time_t new_step );
 
+/**
+ * @brief xi_evtd_step runs the due time events and then the handles of the queue, up
+ * to step_budget handles and for at most step_time_slice_ms
+ *
+ * The handles left over stay queued for the next step so that the event loop gets
+ * back to the sockets and to the other event dispatchers in time.
+ */
 extern void xi_evtd_step( xi_evtd_instance_t* instance, xi_time_t new_step );
 
+/**
+ * @brief xi_evtd_has_pending_calls tells if there are handles waiting to be run by
+ * the next step, the event loop must not block then
+ */
+extern uint8_t xi_evtd_has_pending_calls( xi_evtd_instance_t* instance );
+
 extern uint8_t xi_evtd_dispatcher_continue( xi_evtd_instance_t* instance );
 
 extern uint8_t
@@ -229,3 +229,13 @@ uint8_t xi_handle_disposed( xi_event_handle_t* handle )
 {
     return handle->handle_type == XI_EVENT_HANDLE_UNSET ? 1 : 0;
 }
+
+void xi_dispose_closure( xi_event_closure_t* closure )
+{
+    memset( closure, 0, sizeof( xi_event_closure_t ) );
+}
+
+uint8_t xi_closure_disposed( xi_event_closure_t* closure )
+{
+    return NULL == closure->fn ? 1 : 0;
+}
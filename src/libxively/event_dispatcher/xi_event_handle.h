@@ -163,6 +163,15 @@ extern xi_event_handle_t xi_make_handle_argc6( const uint8_t target_tid,
                                                xi_event_handle_arg5_t a6 );
 #endif /* XI_DEBUG_EXTRA_INFO */
 
+static inline xi_event_closure_t xi_make_closure( xi_event_handle_func_argc4_ptr fn_ptr,
+                                                  xi_event_handle_arg1_t a1,
+                                                  xi_event_handle_arg2_t a2,
+                                                  xi_event_handle_arg3_t a3,
+                                                  xi_event_handle_arg4_t a4 )
+{
+    return ( xi_event_closure_t ){fn_ptr, a1, a2, a4, a3};
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -173,4 +182,8 @@ extern void xi_dispose_handle( xi_event_handle_t* handle );
 
 extern uint8_t xi_handle_disposed( xi_event_handle_t* handle );
 
+extern void xi_dispose_closure( xi_event_closure_t* closure );
+
+extern uint8_t xi_closure_disposed( xi_event_closure_t* closure );
+
 #endif /* __XI_EVENT_HANDLE_H__ */
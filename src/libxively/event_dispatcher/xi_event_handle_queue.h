@@ -12,7 +12,7 @@
 typedef struct xi_event_handle_queue_s
 {
     struct xi_event_handle_queue_s* __next;
-    xi_event_handle_t handle;
+    xi_event_closure_t closure;
 } xi_event_handle_queue_t;
 
 #endif /* __XI_EVENT_HANDLE_QUEUE_H__ */
@@ -115,6 +115,22 @@ typedef struct xi_event_handle_s
     uint8_t target_tid;
 } xi_event_handle_t;
 
+/**
+ * Compact form of a handle of a function with 4 arguments, the shape of the layer
+ * calls. It carries neither the type tag, the debug info nor the thread id and the
+ * arguments are laid out without the padding of the union, so it is roughly half the
+ * size of the xi_event_handle_t. The call queue and the direct call of the event
+ * dispatcher store closures, the handles of other shapes are adapted to them.
+ */
+typedef struct xi_event_closure_s
+{
+    xi_event_handle_func_argc4_ptr fn;
+    xi_event_handle_arg1_t a1;
+    xi_event_handle_arg2_t a2;
+    xi_event_handle_arg4_t a4;
+    xi_event_handle_arg3_t a3;
+} xi_event_closure_t;
+
 #define xi_make_empty_event_handle( target_tid )                                         \
     {                                                                                    \
         XI_EVENT_HANDLE_UNSET, .handlers.h0 = {0}, target_tid                            \
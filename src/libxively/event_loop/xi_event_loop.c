@@ -8,6 +8,7 @@
 #include "xi_bsp_io_net.h"
 #include "xi_bsp_time.h"
 #include "xi_event_dispatcher_api.h"
+#include "xi_stats.h"
 
 
 /**
@@ -38,6 +39,29 @@ static size_t xi_bsp_event_loop_count_all_sockets( xi_evtd_instance_t** event_di
     return ret_num_of_sockets;
 }
 
+/**
+ * @brief xi_event_loop_timeout_until computes the wait for a time event
+ *
+ * The time of the event is rounded up to a multiple of XI_TIMER_SLACK so that the
+ * events close to each other, of all the event dispatchers, fire in one wakeup.
+ *
+ * @return seconds to wait, 0 if the event is due
+ */
+static xi_time_t
+xi_event_loop_timeout_until( xi_time_t time_of_event, xi_time_t current_time )
+{
+#if 0 < XI_TIMER_SLACK
+    if ( 0 < time_of_event )
+    {
+        time_of_event =
+            ( ( time_of_event + XI_TIMER_SLACK - 1 ) / XI_TIMER_SLACK ) * XI_TIMER_SLACK;
+    }
+#endif
+
+    /* the first event to execute may be in the past */
+    return ( time_of_event > current_time ) ? time_of_event - current_time : 0;
+}
+
 xi_state_t
 xi_bsp_event_loop_transform_to_bsp_select( xi_evtd_instance_t** in_event_dispatchers,
                                            uint8_t in_num_evtds,
@@ -52,7 +76,7 @@ xi_bsp_event_loop_transform_to_bsp_select( xi_evtd_instance_t** in_event_dispatc
     }
 
     size_t socket_id                  = 0;
-    uint8_t was_file_updated          = 0;
+    uint8_t was_work_pending          = 0;
     uint8_t was_timeout_candidate_set = 0;
     xi_time_t timeout_candidate       = 0;
 
@@ -114,35 +138,32 @@ xi_bsp_event_loop_transform_to_bsp_select( xi_evtd_instance_t** in_event_dispatc
             socket_id += 1;
         }
 
-        was_file_updated |= xi_evtd_update_file_fd_events( event_dispatcher );
-    }
+        was_work_pending |= xi_evtd_update_file_fd_events( event_dispatcher );
 
-    /* store the current time */
-    const xi_time_t current_time = xi_bsp_time_getcurrenttime_seconds();
+        /* the previous step ran out of its budget, the rest is due right away */
+        was_work_pending |= xi_evtd_has_pending_calls( event_dispatcher );
+    }
 
     /* recalculate the timeout */
     if ( was_timeout_candidate_set )
     {
-        if ( timeout_candidate >= current_time )
-        {
-            timeout_candidate = timeout_candidate - current_time;
-        }
-        else
-        {
-            /* this is possible if the first event to execute is in the past */
-            timeout_candidate = 0;
-        }
+        timeout_candidate = xi_event_loop_timeout_until(
+            timeout_candidate, xi_bsp_time_getcurrenttime_seconds() );
     }
     else
     {
         timeout_candidate = XI_DEFAULT_IDLE_TIMEOUT;
     }
 
-    /* make it clamped from the top */
-    timeout_candidate = XI_MIN( timeout_candidate, XI_MAX_IDLE_TIMEOUT );
+    /* make it clamped from the top, a negative timeout means no timeout at all */
+    if ( 0 <= XI_MAX_IDLE_TIMEOUT &&
+         ( 0 > timeout_candidate || XI_MAX_IDLE_TIMEOUT < timeout_candidate ) )
+    {
+        timeout_candidate = XI_MAX_IDLE_TIMEOUT;
+    }
 
     /* update the return parameter */
-    *out_timeout = ( was_file_updated != 0 ) ? ( 0 ) : ( timeout_candidate );
+    *out_timeout = ( was_work_pending != 0 ) ? ( 0 ) : ( timeout_candidate );
 
     return XI_STATE_OK;
 }
@@ -246,11 +267,15 @@ xi_state_t xi_event_loop_with_evtds( uint32_t num_iterations,
             no_of_sockets_to_update, &timeout );
         XI_CHECK_STATE( state );
 
+        const xi_time_t select_start_ms = xi_bsp_time_getcurrenttime_milliseconds();
+
         /* call the bsp select function */
         const xi_bsp_io_net_state_t select_state =
             xi_bsp_io_net_select( ( xi_bsp_socket_events_t* )&array_of_sockets_to_update,
                                   no_of_sockets_to_update, timeout );
 
+        const xi_time_t select_end_ms = xi_bsp_time_getcurrenttime_milliseconds();
+
         if ( XI_BSP_IO_NET_STATE_OK == select_state )
         {
             /* tranform output from bsp select to event dispatcher updates */
@@ -272,8 +297,161 @@ xi_state_t xi_event_loop_with_evtds( uint32_t num_iterations,
             xi_evtd_step( event_dispatchers[evtd_id],
                           xi_bsp_time_getcurrenttime_seconds() );
         }
+
+        xi_stats_record_select( select_end_ms - select_start_ms,
+                                xi_bsp_time_getcurrenttime_milliseconds() - select_end_ms,
+                                XI_BSP_IO_NET_STATE_OK == select_state );
     }
 
 err_handling:
     return state;
 }
+
+/**
+ * @brief xi_event_loop_fd_events translates the event a socket waits for
+ * @return xi_fd_event_t bits
+ */
+static uint8_t xi_event_loop_fd_events( xi_event_type_t event_type )
+{
+    uint8_t events = XI_FD_EVENT_NONE;
+
+    if ( ( event_type & XI_EVENT_WANT_READ ) > 0 )
+    {
+        events |= XI_FD_EVENT_READ;
+    }
+
+    /* the end of a non blocking connect is signalled as the socket being writable */
+    if ( ( event_type & ( XI_EVENT_WANT_WRITE | XI_EVENT_WANT_CONNECT ) ) > 0 )
+    {
+        events |= XI_FD_EVENT_WRITE;
+    }
+
+    if ( ( event_type & XI_EVENT_ERROR ) > 0 )
+    {
+        events |= XI_FD_EVENT_ERROR;
+    }
+
+    return events;
+}
+
+static xi_evtd_fd_tuple_t*
+xi_event_loop_find_socket( xi_evtd_instance_t* event_dispatcher, xi_fd_t fd )
+{
+    xi_vector_index_type_t i = 0;
+
+    for ( ; i < event_dispatcher->handles_and_socket_fd->elem_no; ++i )
+    {
+        xi_evtd_fd_tuple_t* tuple =
+            ( xi_evtd_fd_tuple_t* )event_dispatcher->handles_and_socket_fd->array[i]
+                .selector_t.ptr_value;
+
+        if ( fd == tuple->fd )
+        {
+            return tuple;
+        }
+    }
+
+    return NULL;
+}
+
+xi_state_t xi_event_loop_get_fd_interests( xi_evtd_instance_t* event_dispatcher,
+                                           xi_fd_interest_t* fds,
+                                           size_t max_fds,
+                                           size_t* fds_count,
+                                           xi_time_t* timeout_ms )
+{
+    if ( NULL == event_dispatcher || ( NULL == fds && 0 < max_fds ) ||
+         NULL == fds_count || NULL == timeout_ms )
+    {
+        return XI_INVALID_PARAMETER;
+    }
+
+    xi_time_t time_of_earliest_event = 0;
+    xi_vector_index_type_t i         = 0;
+
+    *fds_count = ( size_t )event_dispatcher->handles_and_socket_fd->elem_no;
+
+    if ( max_fds < *fds_count )
+    {
+        return XI_BUFFER_OVERFLOW;
+    }
+
+    for ( ; i < event_dispatcher->handles_and_socket_fd->elem_no; ++i )
+    {
+        const xi_evtd_fd_tuple_t* tuple =
+            ( xi_evtd_fd_tuple_t* )event_dispatcher->handles_and_socket_fd->array[i]
+                .selector_t.ptr_value;
+
+        fds[i].fd     = tuple->fd;
+        fds[i].events = xi_event_loop_fd_events( tuple->event_type );
+    }
+
+    /* the file events are processed on every pass, they never wait, neither do the
+     * handles left queued by a step which ran out of its budget */
+    if ( 0 < event_dispatcher->handles_and_file_fd->elem_no ||
+         xi_evtd_has_pending_calls( event_dispatcher ) )
+    {
+        *timeout_ms = 0;
+    }
+    else if ( XI_STATE_OK == xi_evtd_get_time_of_earliest_event(
+                                 event_dispatcher, &time_of_earliest_event ) )
+    {
+        *timeout_ms = xi_event_loop_timeout_until(
+                          time_of_earliest_event, xi_bsp_time_getcurrenttime_seconds() ) *
+                      1000;
+    }
+    else
+    {
+        *timeout_ms = -1;
+    }
+
+    return XI_STATE_OK;
+}
+
+static void xi_event_loop_process_due_events( xi_evtd_instance_t* event_dispatcher )
+{
+    xi_evtd_update_file_fd_events( event_dispatcher );
+    xi_evtd_step( event_dispatcher, xi_bsp_time_getcurrenttime_seconds() );
+}
+
+xi_state_t xi_event_loop_notify_fd( xi_evtd_instance_t* event_dispatcher,
+                                    xi_fd_t fd,
+                                    uint8_t events )
+{
+    if ( NULL == event_dispatcher )
+    {
+        return XI_INVALID_PARAMETER;
+    }
+
+    xi_state_t state                = XI_STATE_OK;
+    const xi_evtd_fd_tuple_t* tuple = xi_event_loop_find_socket( event_dispatcher, fd );
+
+    /* the host loop may still hold an event of a socket closed meanwhile, unlike
+     * xi_evtd_update_event_on_socket this must not stop the dispatcher */
+    if ( NULL == tuple )
+    {
+        return XI_FD_HANDLER_NOT_FOUND;
+    }
+
+    if ( 0 != ( events & ( xi_event_loop_fd_events( tuple->event_type ) |
+                           XI_FD_EVENT_ERROR ) ) )
+    {
+        state = xi_evtd_update_event_on_socket( event_dispatcher, fd );
+    }
+
+    xi_event_loop_process_due_events( event_dispatcher );
+
+    return state;
+}
+
+xi_state_t xi_event_loop_notify_timeout( xi_evtd_instance_t* event_dispatcher )
+{
+    if ( NULL == event_dispatcher )
+    {
+        return XI_INVALID_PARAMETER;
+    }
+
+    xi_event_loop_process_due_events( event_dispatcher );
+
+    return XI_STATE_OK;
+}
@@ -7,6 +7,8 @@
 #ifndef __XI_EVENT_LOOP_H__
 #define __XI_EVENT_LOOP_H__
 
+#include <xively_types.h>
+
 #include "xi_event_dispatcher_api.h"
 
 #ifdef __cplusplus
@@ -17,6 +19,36 @@ xi_state_t xi_event_loop_with_evtds( uint32_t num_iterations,
                                      xi_evtd_instance_t** event_dispatchers,
                                      uint8_t num_evtds );
 
+/**
+ * @brief xi_event_loop_get_fd_interests fills the sockets the event dispatcher waits
+ * on for an event loop that is run outside of the library
+ *
+ * @param [out] fds_count number of the sockets, the required size of fds if it is too
+ * small
+ * @param [out] timeout_ms time until the earliest time event, -1 if there is none
+ * @return XI_BUFFER_OVERFLOW if max_fds is too small
+ */
+xi_state_t xi_event_loop_get_fd_interests( xi_evtd_instance_t* event_dispatcher,
+                                           xi_fd_interest_t* fds,
+                                           size_t max_fds,
+                                           size_t* fds_count,
+                                           xi_time_t* timeout_ms );
+
+/**
+ * @brief xi_event_loop_notify_fd executes the handle waiting on the socket if it
+ * waits for any of the events, then processes the events that are due
+ *
+ * @return XI_FD_HANDLER_NOT_FOUND if the socket is not registered anymore
+ */
+xi_state_t xi_event_loop_notify_fd( xi_evtd_instance_t* event_dispatcher,
+                                    xi_fd_t fd,
+                                    uint8_t events );
+
+/**
+ * @brief xi_event_loop_notify_timeout processes the events that are due
+ */
+xi_state_t xi_event_loop_notify_timeout( xi_evtd_instance_t* event_dispatcher );
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,233 @@
+/* Copyright (c) 2003-2018, Xively All rights reserved.
+ *
+ * This is part of the Xively C Client library,
+ * it is licensed under the BSD 3-Clause license.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "xi_io_net_capture.h"
+#include "xi_bsp_io_fs.h"
+#include "xi_bsp_time.h"
+#include "xi_debug.h"
+#include "xi_fs_bsp_to_xi_mapping.h"
+#include "xi_macros.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* written only by the event loop thread, like the net layer itself */
+static xi_bsp_io_fs_resource_handle_t xi_io_net_capture_handle =
+    XI_BSP_IO_FS_INVALID_RESOURCE_HANDLE;
+static size_t xi_io_net_capture_offset        = 0;
+static xi_time_t xi_io_net_capture_started_ms = 0;
+
+/* the numbering goes on across the captures so that a session which began in an
+ * earlier one can be told apart */
+static uint16_t xi_io_net_capture_next_session  = 1;
+static uint16_t xi_io_net_capture_first_session = 1;
+
+static xi_state_t xi_io_net_capture_write( const uint8_t* data, size_t length )
+{
+    size_t written = 0;
+
+    while ( 0 < length )
+    {
+        const xi_bsp_io_fs_state_t state =
+            xi_bsp_io_fs_write( xi_io_net_capture_handle, data, length,
+                                xi_io_net_capture_offset, &written );
+
+        if ( XI_BSP_IO_FS_STATE_OK != state || 0 == written )
+        {
+            return xi_fs_bsp_io_fs_2_xi_state( state );
+        }
+
+        xi_io_net_capture_offset += written;
+        data += written;
+        length -= written;
+    }
+
+    return XI_STATE_OK;
+}
+
+static void xi_io_net_capture_write_record( uint16_t session,
+                                            xi_io_net_capture_record_type_t type,
+                                            const uint8_t* data,
+                                            size_t length )
+{
+    const uint32_t timestamp_ms = ( uint32_t )(
+        xi_bsp_time_getcurrenttime_milliseconds() - xi_io_net_capture_started_ms );
+    uint8_t header[XI_IO_NET_CAPTURE_RECORD_HEADER_SIZE];
+
+    header[0]  = ( uint8_t )type;
+    header[1]  = ( uint8_t )( session >> 8 );
+    header[2]  = ( uint8_t )session;
+    header[3]  = ( uint8_t )( timestamp_ms >> 24 );
+    header[4]  = ( uint8_t )( timestamp_ms >> 16 );
+    header[5]  = ( uint8_t )( timestamp_ms >> 8 );
+    header[6]  = ( uint8_t )timestamp_ms;
+    header[7]  = ( uint8_t )( length >> 24 );
+    header[8]  = ( uint8_t )( length >> 16 );
+    header[9]  = ( uint8_t )( length >> 8 );
+    header[10] = ( uint8_t )length;
+
+    if ( XI_STATE_OK != xi_io_net_capture_write( header, sizeof( header ) ) ||
+         XI_STATE_OK != xi_io_net_capture_write( data, length ) )
+    {
+        /* a partial record would make the rest of the file unreadable */
+        xi_debug_logger( "writing the net capture failed, stopping it" );
+        xi_io_net_capture_stop();
+    }
+}
+
+xi_state_t xi_io_net_capture_start( const char* resource_name )
+{
+    xi_state_t state = XI_STATE_OK;
+    uint8_t header[XI_IO_NET_CAPTURE_FILE_HEADER_SIZE];
+
+    if ( NULL == resource_name )
+    {
+        return XI_INVALID_PARAMETER;
+    }
+
+    xi_io_net_capture_stop();
+
+    state = xi_fs_bsp_io_fs_2_xi_state(
+        xi_bsp_io_fs_open( resource_name, 0 /* the size is not known upfront */,
+                           XI_BSP_IO_FS_OPEN_WRITE, &xi_io_net_capture_handle ) );
+    XI_CHECK_STATE( state );
+
+    xi_io_net_capture_offset        = 0;
+    xi_io_net_capture_started_ms    = xi_bsp_time_getcurrenttime_milliseconds();
+    xi_io_net_capture_first_session = xi_io_net_capture_next_session;
+
+    memcpy( header, XI_IO_NET_CAPTURE_MAGIC, XI_IO_NET_CAPTURE_MAGIC_SIZE );
+    header[XI_IO_NET_CAPTURE_MAGIC_SIZE] = XI_IO_NET_CAPTURE_VERSION;
+
+    state = xi_io_net_capture_write( header, sizeof( header ) );
+    XI_CHECK_STATE( state );
+
+    return XI_STATE_OK;
+
+err_handling:
+    xi_io_net_capture_stop();
+
+    return state;
+}
+
+void xi_io_net_capture_stop( void )
+{
+    if ( XI_BSP_IO_FS_INVALID_RESOURCE_HANDLE == xi_io_net_capture_handle )
+    {
+        return;
+    }
+
+    xi_bsp_io_fs_close( xi_io_net_capture_handle );
+    xi_io_net_capture_handle = XI_BSP_IO_FS_INVALID_RESOURCE_HANDLE;
+}
+
+uint16_t xi_io_net_capture_begin_session( const char* host, uint16_t port )
+{
+    char endpoint[256];
+
+    if ( XI_BSP_IO_FS_INVALID_RESOURCE_HANDLE == xi_io_net_capture_handle )
+    {
+        return 0;
+    }
+
+    const uint16_t session = xi_io_net_capture_next_session;
+    xi_io_net_capture_next_session =
+        ( UINT16_MAX == session ) ? 1 : ( uint16_t )( session + 1 );
+
+    const int endpoint_length =
+        snprintf( endpoint, sizeof( endpoint ), "%s:%hu", host, port );
+
+    xi_io_net_capture_write_record(
+        session, XI_IO_NET_CAPTURE_CONNECT, ( const uint8_t* )endpoint,
+        XI_MIN( ( size_t )XI_MAX( endpoint_length, 0 ), sizeof( endpoint ) - 1 ) );
+
+    return session;
+}
+
+void xi_io_net_capture_record( uint16_t session,
+                               xi_io_net_capture_record_type_t type,
+                               const uint8_t* data,
+                               size_t length )
+{
+    if ( 0 == session ||
+         XI_BSP_IO_FS_INVALID_RESOURCE_HANDLE == xi_io_net_capture_handle ||
+         ( uint16_t )( session - xi_io_net_capture_first_session ) >=
+             ( uint16_t )( xi_io_net_capture_next_session -
+                           xi_io_net_capture_first_session ) )
+    {
+        return;
+    }
+
+    xi_io_net_capture_write_record( session, type, data, length );
+}
+
+static uint32_t xi_io_net_capture_read_u32( const uint8_t* bytes )
+{
+    return ( ( uint32_t )bytes[0] << 24 ) | ( ( uint32_t )bytes[1] << 16 ) |
+           ( ( uint32_t )bytes[2] << 8 ) | ( uint32_t )bytes[3];
+}
+
+xi_state_t xi_io_net_capture_next_record( const uint8_t* recording,
+                                          size_t recording_size,
+                                          size_t* offset,
+                                          xi_io_net_capture_record_t* record )
+{
+    if ( NULL == recording || NULL == offset || NULL == record )
+    {
+        return XI_INVALID_PARAMETER;
+    }
+
+    if ( 0 == *offset )
+    {
+        if ( XI_IO_NET_CAPTURE_FILE_HEADER_SIZE > recording_size ||
+             0 != memcmp( recording, XI_IO_NET_CAPTURE_MAGIC,
+                          XI_IO_NET_CAPTURE_MAGIC_SIZE ) ||
+             XI_IO_NET_CAPTURE_VERSION != recording[XI_IO_NET_CAPTURE_MAGIC_SIZE] )
+        {
+            return XI_INVALID_PARAMETER;
+        }
+
+        *offset = XI_IO_NET_CAPTURE_FILE_HEADER_SIZE;
+    }
+
+    if ( recording_size == *offset )
+    {
+        return XI_ELEMENT_NOT_FOUND;
+    }
+
+    if ( XI_IO_NET_CAPTURE_RECORD_HEADER_SIZE > recording_size - *offset )
+    {
+        return XI_INVALID_PARAMETER;
+    }
+
+    const uint8_t* header = recording + *offset;
+
+    record->type         = ( xi_io_net_capture_record_type_t )header[0];
+    record->session      = ( uint16_t )( ( header[1] << 8 ) | header[2] );
+    record->timestamp_ms = xi_io_net_capture_read_u32( header + 3 );
+    record->length       = xi_io_net_capture_read_u32( header + 7 );
+    record->data         = header + XI_IO_NET_CAPTURE_RECORD_HEADER_SIZE;
+
+    if ( XI_IO_NET_CAPTURE_CONNECT > record->type ||
+         XI_IO_NET_CAPTURE_CLOSE < record->type ||
+         record->length >
+             recording_size - *offset - XI_IO_NET_CAPTURE_RECORD_HEADER_SIZE )
+    {
+        return XI_INVALID_PARAMETER;
+    }
+
+    *offset += XI_IO_NET_CAPTURE_RECORD_HEADER_SIZE + record->length;
+
+    return XI_STATE_OK;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,105 @@
+/* Copyright (c) 2003-2018, Xively All rights reserved.
+ *
+ * This is part of the Xively C Client library,
+ * it is licensed under the BSD 3-Clause license.
+ */
+
+#ifndef __XI_IO_NET_CAPTURE_H__
+#define __XI_IO_NET_CAPTURE_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <xively_error.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Capture of the byte streams going through the net layer, meant for recording
+ * sessions which are later replayed to reproduce a performance problem or to compare
+ * two builds on the same traffic.
+ *
+ * The capture file starts with XI_IO_NET_CAPTURE_MAGIC followed by the version byte,
+ * then the records follow back to back. Each record is a header of
+ * XI_IO_NET_CAPTURE_RECORD_HEADER_SIZE bytes:
+ *  - type, 1 byte, one of xi_io_net_capture_record_type_t,
+ *  - session, 2 bytes, numbers the connections made while capturing, starts from 1,
+ *  - timestamp, 4 bytes, milliseconds since the capture started,
+ *  - length, 4 bytes, of the data following the header,
+ * all of the numbers are big endian. The data of a CONNECT record is "host:port", the
+ * IN and OUT records carry the bytes exactly as they were read or written, TLS
+ * included since the net layer is below it.
+ */
+
+#define XI_IO_NET_CAPTURE_MAGIC "XINETCAP"
+#define XI_IO_NET_CAPTURE_MAGIC_SIZE ( sizeof( XI_IO_NET_CAPTURE_MAGIC ) - 1 )
+#define XI_IO_NET_CAPTURE_VERSION 1
+#define XI_IO_NET_CAPTURE_FILE_HEADER_SIZE ( XI_IO_NET_CAPTURE_MAGIC_SIZE + 1 )
+#define XI_IO_NET_CAPTURE_RECORD_HEADER_SIZE 11
+
+typedef enum xi_io_net_capture_record_type_e {
+    XI_IO_NET_CAPTURE_CONNECT = 1,
+    XI_IO_NET_CAPTURE_IN,
+    XI_IO_NET_CAPTURE_OUT,
+    XI_IO_NET_CAPTURE_CLOSE
+} xi_io_net_capture_record_type_t;
+
+typedef struct xi_io_net_capture_record_s
+{
+    xi_io_net_capture_record_type_t type;
+    uint16_t session;
+    uint32_t timestamp_ms;
+    const uint8_t* data; /* points into the recording */
+    uint32_t length;
+} xi_io_net_capture_record_t;
+
+/**
+ * @brief xi_io_net_capture_start opens the capture file, truncating it, and starts
+ * recording the sessions connected from now on. A capture already running is stopped
+ * first.
+ */
+extern xi_state_t xi_io_net_capture_start( const char* resource_name );
+
+/**
+ * @brief xi_io_net_capture_stop closes the capture file, the sessions still
+ * connected are not recorded any more
+ */
+extern void xi_io_net_capture_stop( void );
+
+/**
+ * @brief xi_io_net_capture_begin_session writes the CONNECT record of a new session
+ *
+ * @return the session number to pass to xi_io_net_capture_record, 0 if there is no
+ * capture running
+ */
+extern uint16_t xi_io_net_capture_begin_session( const char* host, uint16_t port );
+
+/**
+ * @brief xi_io_net_capture_record writes a record of the session, a no-op for the
+ * session 0 or if the capture has been stopped since the session began
+ */
+extern void xi_io_net_capture_record( uint16_t session,
+                                      xi_io_net_capture_record_type_t type,
+                                      const uint8_t* data,
+                                      size_t length );
+
+/**
+ * @brief xi_io_net_capture_next_record parses the record at *offset of a recording
+ * read into the memory, an offset of 0 checks and skips the file header
+ *
+ * @param [in,out] offset position of the record, on return the one of the next
+ * @return XI_STATE_OK, XI_ELEMENT_NOT_FOUND at the end of the recording or
+ * XI_INVALID_PARAMETER if it is not a recording or the record is truncated
+ */
+extern xi_state_t xi_io_net_capture_next_record( const uint8_t* recording,
+                                                 size_t recording_size,
+                                                 size_t* offset,
+                                                 xi_io_net_capture_record_t* record );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __XI_IO_NET_CAPTURE_H__ */
@@ -6,6 +6,7 @@
 
 #include "xi_io_net_layer.h"
 #include "xi_io_net_layer_state.h"
+#include "xi_io_net_capture.h"
 #include "xi_bsp_io_net.h"
 
 #include "xi_macros.h"
@@ -17,6 +18,7 @@
 
 #include "xi_io_timeouts.h"
 #include "xi_globals.h"
+#include "xi_stats.h"
 
 xi_state_t xi_io_net_layer_connect( void* context, void* data, xi_state_t in_out_state )
 {
@@ -76,6 +78,9 @@ xi_state_t xi_io_net_layer_connect( void* context, void* data, xi_state_t in_out
                              in_out_state, "Error while calling getsockopt." );
     xi_debug_logger( "Connection successful!" );
 
+    layer_data->capture_session =
+        xi_io_net_capture_begin_session( connection_data->host, connection_data->port );
+
     XI_CR_EXIT( layer_data->layer_connect_cs,
                 XI_PROCESS_CONNECT_ON_NEXT_LAYER( context, NULL, XI_STATE_OK ) );
 
@@ -208,10 +213,17 @@ xi_state_t xi_io_net_layer_push( void* context, void* data, xi_state_t in_out_st
             }
 
             buffer->curr_pos += len;
+            XI_STATS_ADD( bytes_out, len );
             left = buffer->capacity - buffer->curr_pos;
         } while ( left > 0 );
     }
 
+    if ( buffer != 0 )
+    {
+        xi_io_net_capture_record( layer_data->capture_session, XI_IO_NET_CAPTURE_OUT,
+                                  buffer->data_ptr, buffer->capacity );
+    }
+
     xi_debug_format( "%d bytes written", len );
     xi_free_desc( &buffer );
 
@@ -303,6 +315,11 @@ xi_state_t xi_io_net_layer_pull( void* context, void* data, xi_state_t in_out_st
     buffer_desc->length   = len;
     buffer_desc->curr_pos = 0;
 
+    XI_STATS_ADD( bytes_in, len );
+
+    xi_io_net_capture_record( layer_data->capture_session, XI_IO_NET_CAPTURE_IN,
+                              buffer_desc->data_ptr, len );
+
     return XI_PROCESS_PULL_ON_NEXT_LAYER( context, ( void* )buffer_desc, XI_STATE_OK );
 
 err_handling:
@@ -331,6 +348,9 @@ xi_io_net_layer_close_externally( void* context, void* data, xi_state_t in_out_s
         return XI_PROCESS_CLOSE_EXTERNALLY_ON_NEXT_LAYER( context, data, in_out_state );
     }
 
+    xi_io_net_capture_record( layer_data->capture_session, XI_IO_NET_CAPTURE_CLOSE,
+                              NULL, 0 );
+
     /* unregister the fd */
     xi_evtd_unregister_socket_fd( XI_CONTEXT_DATA( context )->evtd_instance,
                                   layer_data->socket );
@@ -15,6 +15,9 @@ typedef struct xi_io_net_layer_state_s
     xi_bsp_socket_t socket;
 
     uint16_t layer_connect_cs;
+
+    /* number of the session in the net capture, 0 when it is not captured */
+    uint16_t capture_session;
 } xi_io_net_layer_state_t;
 
 #endif /* __XI_IO_NET_LAYER_STATE_H__ */
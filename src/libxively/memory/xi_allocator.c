@@ -6,11 +6,14 @@
 
 #include "xi_allocator.h"
 #include "xi_bsp_mem.h"
+#include "xi_stats.h"
 
 extern void* memset( void* ptr, int value, size_t num );
 
 void* __xi_alloc( size_t byte_count )
 {
+    XI_STATS_INC( allocations );
+
     return xi_bsp_mem_alloc( byte_count );
 }
 
@@ -19,6 +22,8 @@ void* __xi_calloc( size_t num, size_t byte_count )
     const size_t size_to_allocate = num * byte_count;
     void* ret                     = xi_bsp_mem_alloc( size_to_allocate );
 
+    XI_STATS_INC( allocations );
+
     /* it's unspecified if memset works with NULL pointer */
     if ( NULL != ret )
     {
@@ -30,6 +35,8 @@ void* __xi_calloc( size_t num, size_t byte_count )
 
 void* __xi_realloc( void* ptr, size_t byte_count )
 {
+    XI_STATS_INC( allocations );
+
     return xi_bsp_mem_realloc( ptr, byte_count );
 }
 
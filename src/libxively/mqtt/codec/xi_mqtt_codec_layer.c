@@ -4,6 +4,7 @@
  * it is licensed under the BSD 3-Clause license.
  */
 
+#include "xi_bsp_time.h"
 #include "xi_coroutine.h"
 #include "xi_list.h"
 #include "xi_mqtt_codec_layer.h"
@@ -14,11 +15,14 @@
 #include "xi_mqtt_parser.h"
 #include "xi_layer_macros.h"
 #include "xi_layer_api.h"
+#include "xi_stats.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+#define XI_MQTT_CODEC_TASK_LOWER_PRIORITY( task, value ) ( ( task )->priority < value )
+
 static void clear_task_queue( void* context )
 {
     /* PRE-CONDITIONS */
@@ -83,12 +87,18 @@ xi_state_t xi_mqtt_codec_layer_push( void* context, void* data, xi_state_t in_ou
 
         XI_CHECK_MEMORY( new_task, in_out_state );
 
-        XI_LIST_PUSH_BACK( xi_mqtt_codec_layer_task_t, layer_data->task_queue, new_task );
-
         if ( XI_CR_IS_RUNNING( layer_data->push_cs ) )
         {
+            /* the head is being sent, the rest is ordered by the priority class */
+            XI_LIST_INSERT_BEFORE( xi_mqtt_codec_layer_task_t,
+                                   layer_data->task_queue->__next,
+                                   XI_MQTT_CODEC_TASK_LOWER_PRIORITY, new_task->priority,
+                                   new_task );
+
             return XI_STATE_OK;
         }
+
+        XI_LIST_PUSH_BACK( xi_mqtt_codec_layer_task_t, layer_data->task_queue, new_task );
     }
     else if ( in_out_state == XI_STATE_WANT_WRITE )
     {
@@ -186,6 +196,15 @@ xi_state_t xi_mqtt_codec_layer_push( void* context, void* data, xi_state_t in_ou
 finalise: /* common part for all messages */
     if ( XI_STATE_WRITTEN == in_out_state )
     {
+        XI_STATS_INC( messages_out );
+
+        if ( XI_MQTT_TYPE_PUBLISH == layer_data->msg_type )
+        {
+            xi_stats_record_publish( task->priority,
+                                     xi_bsp_time_getcurrenttime_milliseconds() -
+                                         task->queued_ms );
+        }
+
         xi_debug_format( "[m.id[%d] m.type[%d]] mqtt_codec_layer message sent",
                          layer_data->msg_id, layer_data->msg_type );
     }
@@ -299,6 +318,8 @@ xi_state_t xi_mqtt_codec_layer_pull( void* context, void* data, xi_state_t in_ou
         goto err_handling;
     }
 
+    XI_STATS_INC( messages_in );
+
     xi_debug_format( "[m.id[%d] m.type[%d]] msg decoded!",
                      xi_mqtt_get_message_id( layer_data->msg ),
                      layer_data->msg->common.common_u.common_bits.type );
@@ -19,6 +19,20 @@ xi_mqtt_codec_layer_task_t* xi_mqtt_codec_layer_make_task( xi_mqtt_message_t* ms
     new_task->msg_type = ( xi_mqtt_type_t )msg->common.common_u.common_bits.type;
     new_task->msg      = msg;
 
+    switch ( new_task->msg_type )
+    {
+        case XI_MQTT_TYPE_PUBLISH:
+            new_task->priority  = msg->publish.priority;
+            new_task->queued_ms = msg->publish.queued_ms;
+            break;
+        case XI_MQTT_TYPE_DISCONNECT:
+            new_task->priority = XI_PUBLISH_PRIORITY_BULK;
+            break;
+        default:
+            new_task->priority = XI_PUBLISH_PRIORITY_ALARM;
+            break;
+    }
+
     return new_task;
 
 err_handling:
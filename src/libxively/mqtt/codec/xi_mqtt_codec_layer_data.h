@@ -20,6 +20,8 @@ typedef struct xi_mqtt_codec_layer_task_s
     xi_mqtt_message_t* msg;
     uint16_t msg_id;
     xi_mqtt_type_t msg_type;
+    xi_publish_priority_t priority; /* the task queue is ordered by it */
+    xi_time_t queued_ms;
 } xi_mqtt_codec_layer_task_t;
 
 typedef struct xi_mqtt_codec_layer_data_s
@@ -39,6 +41,10 @@ typedef struct xi_mqtt_codec_layer_data_s
  *
  * Helper ctor like function to create mqtt codec layer's task
  *
+ * A publication keeps its priority class. The other messages, acknowledgements and
+ * pings, are of the alarm class so that they never wait for the publications, except
+ * for DISCONNECT which is of the bulk one so that it is sent after all of them.
+ *
  * @param msg
  * @return
  */
@@ -89,6 +89,59 @@ void xi_debug_mqtt_message_dump( const xi_mqtt_message_t* message )
 }
 #endif
 
+xi_mqtt_topicpair_t* xi_mqtt_topicpair_last( xi_mqtt_topicpair_t* topics )
+{
+    while ( NULL != topics && NULL != topics->next )
+    {
+        topics = topics->next;
+    }
+
+    return topics;
+}
+
+xi_state_t
+xi_mqtt_topicpair_append( xi_mqtt_topicpair_t** topics, xi_mqtt_topicpair_t** out )
+{
+    assert( NULL != topics );
+
+    xi_state_t state          = XI_STATE_OK;
+    xi_mqtt_topicpair_t* last = xi_mqtt_topicpair_last( *topics );
+
+    XI_ALLOC( xi_mqtt_topicpair_t, topic, state );
+
+    if ( NULL == last )
+    {
+        *topics = topic;
+    }
+    else
+    {
+        last->next = topic;
+    }
+
+    if ( NULL != out )
+    {
+        *out = topic;
+    }
+
+err_handling:
+    return state;
+}
+
+void xi_mqtt_topicpair_free_list( xi_mqtt_topicpair_t** topics )
+{
+    assert( NULL != topics );
+
+    while ( NULL != *topics )
+    {
+        xi_mqtt_topicpair_t* next = ( *topics )->next;
+
+        xi_free_desc( &( *topics )->name );
+        XI_SAFE_FREE( *topics );
+
+        *topics = next;
+    }
+}
+
 void xi_mqtt_message_free( xi_mqtt_message_t** msg )
 {
     if ( msg == NULL || *msg == NULL )
@@ -121,20 +174,13 @@ void xi_mqtt_message_free( xi_mqtt_message_t** msg )
                 xi_free_desc( &m->publish.topic_name );
             break;
         case XI_MQTT_TYPE_SUBSCRIBE:
-            if ( m->subscribe.topics )
-            {
-                if ( m->subscribe.topics )
-                    xi_free_desc( &m->subscribe.topics->name );
-                XI_SAFE_FREE( m->subscribe.topics );
-            }
+            xi_mqtt_topicpair_free_list( &m->subscribe.topics );
             break;
         case XI_MQTT_TYPE_SUBACK:
-            if ( m->suback.topics )
-            {
-                if ( m->suback.topics->name )
-                    xi_free_desc( &m->suback.topics->name );
-                XI_SAFE_FREE( m->suback.topics );
-            }
+            xi_mqtt_topicpair_free_list( &m->suback.topics );
+            break;
+        case XI_MQTT_TYPE_UNSUBSCRIBE:
+            xi_mqtt_topicpair_free_list( &m->unsubscribe.topics );
             break;
     }
 
@@ -163,6 +209,8 @@ uint16_t xi_mqtt_get_message_id( const xi_mqtt_message_t* msg )
             return msg->subscribe.message_id;
         case XI_MQTT_TYPE_SUBACK:
             return msg->suback.message_id;
+        case XI_MQTT_TYPE_UNSUBSCRIBE:
+            return msg->unsubscribe.message_id;
         case XI_MQTT_TYPE_UNSUBACK:
             return msg->unsuback.message_id;
         case XI_MQTT_TYPE_PINGREQ:
@@ -12,6 +12,8 @@
 
 #include "xi_data_desc.h"
 #include <xively_mqtt.h>
+#include <xively_time.h>
+#include <xively_types.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -41,12 +43,7 @@ typedef enum {
     XI_MQTT_MESSAGE_CLASS_FROM_SERVER
 } xi_mqtt_message_class_t;
 
-typedef struct xi_mqtt_topic_s
-{
-    struct mqtt_topic_s* next;
-    xi_data_desc_t* name;
-} xi_mqtt_topic_t;
-
+/* SUBSCRIBE, SUBACK and UNSUBSCRIBE carry one element per topic filter, in order */
 typedef struct xi_mqtt_topicpair_s
 {
     struct xi_mqtt_topicpair_s* next;
@@ -121,6 +118,10 @@ typedef union xi_mqtt_message_u {
         uint16_t message_id;
 
         xi_data_desc_t* content;
+
+        /* not serialised, the codec sends the messages of the higher classes first */
+        xi_publish_priority_t priority;
+        xi_time_t queued_ms;
     } publish;
 
     struct
@@ -172,7 +173,7 @@ typedef union xi_mqtt_message_u {
         struct common_s common;
 
         uint16_t message_id;
-        xi_mqtt_topic_t* topics;
+        xi_mqtt_topicpair_t* topics; /* the payload is unused */
     } unsubscribe;
 
     struct
@@ -206,6 +207,12 @@ extern void xi_debug_mqtt_message_dump( const xi_mqtt_message_t* msg );
 
 extern void xi_mqtt_message_free( xi_mqtt_message_t** msg );
 
+/* topic list helpers, an appended element is zeroed and owned by the list */
+extern xi_mqtt_topicpair_t* xi_mqtt_topicpair_last( xi_mqtt_topicpair_t* topics );
+extern xi_state_t
+xi_mqtt_topicpair_append( xi_mqtt_topicpair_t** topics, xi_mqtt_topicpair_t** out );
+extern void xi_mqtt_topicpair_free_list( xi_mqtt_topicpair_t** topics );
+
 /**
  * @name    xi_mqtt_class_msg_type_receiving
  * @brief   Classifies the message while executing the receiving code
@@ -158,26 +158,26 @@ err_handling:
 #define READ_STRING( into )                                                              \
     do                                                                                   \
     {                                                                                    \
-        local_state = read_string( parser, into, src );                                  \
-        XI_CR_YIELD_UNTIL( parser->cs, ( local_state == XI_STATE_WANT_READ ),            \
+        parser->local_state = read_string( parser, into, src );                          \
+        XI_CR_YIELD_UNTIL( parser->cs, ( parser->local_state == XI_STATE_WANT_READ ),    \
                            XI_STATE_WANT_READ );                                         \
-        if ( local_state != XI_STATE_OK )                                                \
+        if ( parser->local_state != XI_STATE_OK )                                        \
         {                                                                                \
-            XI_CR_EXIT( parser->cs, local_state );                                       \
+            XI_CR_EXIT( parser->cs, parser->local_state );                               \
         }                                                                                \
-    } while ( local_state != XI_STATE_OK )
+    } while ( parser->local_state != XI_STATE_OK )
 
 #define READ_DATA( into )                                                                \
     do                                                                                   \
     {                                                                                    \
-        local_state = read_data( parser, into, src );                                    \
-        XI_CR_YIELD_UNTIL( parser->cs, ( local_state == XI_STATE_WANT_READ ),            \
+        parser->local_state = read_data( parser, into, src );                            \
+        XI_CR_YIELD_UNTIL( parser->cs, ( parser->local_state == XI_STATE_WANT_READ ),    \
                            XI_STATE_WANT_READ );                                         \
-        if ( local_state != XI_STATE_OK )                                                \
+        if ( parser->local_state != XI_STATE_OK )                                        \
         {                                                                                \
-            XI_CR_EXIT( parser->cs, local_state );                                       \
+            XI_CR_EXIT( parser->cs, parser->local_state );                               \
         }                                                                                \
-    } while ( local_state != XI_STATE_OK )
+    } while ( parser->local_state != XI_STATE_OK )
 
 void xi_mqtt_parser_init( xi_mqtt_parser_t* parser )
 {
@@ -197,12 +197,12 @@ xi_state_t xi_mqtt_parser_execute( xi_mqtt_parser_t* parser,
                                    xi_mqtt_message_t* message,
                                    xi_data_desc_t* data_buffer_desc )
 {
-    xi_data_desc_t* src           = data_buffer_desc;
-    static xi_state_t local_state = XI_STATE_OK;
+    xi_data_desc_t* src        = data_buffer_desc;
+    xi_mqtt_topicpair_t* topic = NULL;
 
     XI_CR_START( parser->cs );
 
-    local_state = XI_STATE_OK;
+    parser->local_state = XI_STATE_OK;
 
     XI_CR_YIELD_ON( parser->cs, ( ( src->curr_pos - src->length ) == 0 ),
                     XI_STATE_WANT_READ );
@@ -438,48 +438,100 @@ xi_state_t xi_mqtt_parser_execute( xi_mqtt_parser_t* parser,
         src->curr_pos += 1;
         parser->data_length += 1;
 
+        /* topic filters with the requested qos till the end of the message */
+        while ( parser->data_length < parser->remaining_length + 2 )
+        {
+            XI_CHECK_STATE( parser->local_state = xi_mqtt_topicpair_append(
+                                &message->subscribe.topics, NULL ) );
+
+            READ_STRING( &xi_mqtt_topicpair_last( message->subscribe.topics )->name );
+
+            XI_CR_YIELD_ON( parser->cs, ( ( src->curr_pos - src->length ) == 0 ),
+                            XI_STATE_WANT_READ );
+
+            xi_mqtt_topicpair_last( message->subscribe.topics )
+                ->xi_mqtt_topic_pair_payload_u.qos =
+                ( xi_mqtt_qos_t )src->data_ptr[src->curr_pos];
+            src->curr_pos += 1;
+            parser->data_length += 1;
+        }
+
+        XI_CR_EXIT( parser->cs, XI_STATE_OK );
+    }
+    else if ( message->common.common_u.common_bits.type == XI_MQTT_TYPE_SUBACK )
+    {
         XI_CR_YIELD_ON( parser->cs, ( ( src->curr_pos - src->length ) == 0 ),
                         XI_STATE_WANT_READ );
 
-        XI_ALLOC_AT( xi_mqtt_topicpair_t, message->subscribe.topics, local_state );
-
-        READ_STRING( &message->subscribe.topics->name );
+        message->suback.message_id = ( src->data_ptr[src->curr_pos] << 8 );
+        src->curr_pos += 1;
+        parser->data_length += 1;
 
         XI_CR_YIELD_ON( parser->cs, ( ( src->curr_pos - src->length ) == 0 ),
                         XI_STATE_WANT_READ );
 
-        message->subscribe.topics->xi_mqtt_topic_pair_payload_u.qos =
-            ( xi_mqtt_qos_t )src->data_ptr[src->curr_pos];
+        message->suback.message_id += src->data_ptr[src->curr_pos] & 0xFF;
         src->curr_pos += 1;
         parser->data_length += 1;
 
+        /* one return code per topic filter of the SUBSCRIBE */
+        while ( parser->data_length < parser->remaining_length + 2 )
+        {
+            XI_CR_YIELD_ON( parser->cs, ( ( src->curr_pos - src->length ) == 0 ),
+                            XI_STATE_WANT_READ );
+
+            XI_CHECK_STATE( parser->local_state = xi_mqtt_topicpair_append(
+                                &message->suback.topics, &topic ) );
+
+            XI_CHECK_STATE( parser->local_state = xi_mqtt_parse_suback_response(
+                                &topic->xi_mqtt_topic_pair_payload_u.status,
+                                src->data_ptr[src->curr_pos] ) );
+
+            src->curr_pos += 1;
+            parser->data_length += 1;
+        }
+
         XI_CR_EXIT( parser->cs, XI_STATE_OK );
     }
-    else if ( message->common.common_u.common_bits.type == XI_MQTT_TYPE_SUBACK )
+    else if ( message->common.common_u.common_bits.type == XI_MQTT_TYPE_UNSUBSCRIBE )
     {
         XI_CR_YIELD_ON( parser->cs, ( ( src->curr_pos - src->length ) == 0 ),
                         XI_STATE_WANT_READ );
 
-        message->suback.message_id = ( src->data_ptr[src->curr_pos] << 8 );
+        message->unsubscribe.message_id = ( src->data_ptr[src->curr_pos] << 8 );
         src->curr_pos += 1;
         parser->data_length += 1;
 
         XI_CR_YIELD_ON( parser->cs, ( ( src->curr_pos - src->length ) == 0 ),
                         XI_STATE_WANT_READ );
 
-        message->suback.message_id += src->data_ptr[src->curr_pos] & 0xFF;
+        message->unsubscribe.message_id += src->data_ptr[src->curr_pos] & 0xFF;
         src->curr_pos += 1;
         parser->data_length += 1;
 
+        while ( parser->data_length < parser->remaining_length + 2 )
+        {
+            XI_CHECK_STATE( parser->local_state = xi_mqtt_topicpair_append(
+                                &message->unsubscribe.topics, NULL ) );
+
+            READ_STRING( &xi_mqtt_topicpair_last( message->unsubscribe.topics )->name );
+        }
+
+        XI_CR_EXIT( parser->cs, XI_STATE_OK );
+    }
+    else if ( message->common.common_u.common_bits.type == XI_MQTT_TYPE_UNSUBACK )
+    {
         XI_CR_YIELD_ON( parser->cs, ( ( src->curr_pos - src->length ) == 0 ),
                         XI_STATE_WANT_READ );
 
-        XI_ALLOC_AT( xi_mqtt_topicpair_t, message->suback.topics, local_state );
+        message->unsuback.message_id = ( src->data_ptr[src->curr_pos] << 8 );
+        src->curr_pos += 1;
+        parser->data_length += 1;
 
-        XI_CHECK_STATE( local_state = xi_mqtt_parse_suback_response(
-                            &message->suback.topics->xi_mqtt_topic_pair_payload_u.status,
-                            src->data_ptr[src->curr_pos] ) );
+        XI_CR_YIELD_ON( parser->cs, ( ( src->curr_pos - src->length ) == 0 ),
+                        XI_STATE_WANT_READ );
 
+        message->unsuback.message_id += src->data_ptr[src->curr_pos] & 0xFF;
         src->curr_pos += 1;
         parser->data_length += 1;
 
@@ -504,7 +556,7 @@ xi_state_t xi_mqtt_parser_execute( xi_mqtt_parser_t* parser,
     }
 
 err_handling:
-    XI_CR_EXIT( parser->cs, local_state );
+    XI_CR_EXIT( parser->cs, parser->local_state );
 
     XI_CR_END();
 }
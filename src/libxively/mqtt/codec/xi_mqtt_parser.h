@@ -40,6 +40,9 @@ typedef struct xi_mqtt_parser_s
     size_t remaining_length;
     size_t str_length;
     size_t data_length;
+    /* state of the nested read across the yields, kept per parser since every
+     * connection parses its own messages interleaved with the others */
+    xi_state_t local_state;
 } xi_mqtt_parser_t;
 
 extern void xi_mqtt_parser_init( xi_mqtt_parser_t* parser );
@@ -146,17 +146,43 @@ xi_state_t xi_mqtt_serialiser_size( size_t* msg_len,
     }
     else if ( message->common.common_u.common_bits.type == XI_MQTT_TYPE_SUBSCRIBE )
     {
+        const xi_mqtt_topicpair_t* topic = message->subscribe.topics;
+
         *msg_len += 2; /* size msgid */
-        *msg_len += 2; /* size of topic */
 
-        /* @TODO add support for multiple topics per request */
-        *msg_len += message->subscribe.topics->name->length;
-        *msg_len += 1; /* qos */
+        for ( ; NULL != topic; topic = topic->next )
+        {
+            *msg_len += 2; /* size of topic */
+            *msg_len += topic->name->length;
+            *msg_len += 1; /* qos */
+        }
     }
     else if ( message->common.common_u.common_bits.type == XI_MQTT_TYPE_SUBACK )
+    {
+        const xi_mqtt_topicpair_t* topic = message->suback.topics;
+
+        *msg_len += 2; /* size of the msg id */
+
+        for ( ; NULL != topic; topic = topic->next )
+        {
+            *msg_len += 1; /* return code */
+        }
+    }
+    else if ( message->common.common_u.common_bits.type == XI_MQTT_TYPE_UNSUBSCRIBE )
+    {
+        const xi_mqtt_topicpair_t* topic = message->unsubscribe.topics;
+
+        *msg_len += 2; /* size msgid */
+
+        for ( ; NULL != topic; topic = topic->next )
+        {
+            *msg_len += 2; /* size of topic */
+            *msg_len += topic->name->length;
+        }
+    }
+    else if ( message->common.common_u.common_bits.type == XI_MQTT_TYPE_UNSUBACK )
     {
         *msg_len += 2; /* size of the msg id */
-        *msg_len += 1; /* qos */
     }
     else if ( message->common.common_u.common_bits.type == XI_MQTT_TYPE_PINGREQ )
     {
@@ -182,8 +208,9 @@ xi_mqtt_serialiser_rc_t xi_mqtt_serialiser_write( xi_mqtt_serialiser_t* serialis
 {
     XI_UNUSED( message_len );
 
-    size_t tmp_remaining_len = 0;
-    uint32_t value           = 0;
+    size_t tmp_remaining_len         = 0;
+    uint32_t value                   = 0;
+    const xi_mqtt_topicpair_t* topic = NULL;
 
     WRITE_8( buffer, message->common.common_u.common_value );
 
@@ -276,10 +303,11 @@ xi_mqtt_serialiser_rc_t xi_mqtt_serialiser_write( xi_mqtt_serialiser_t* serialis
 
             WRITE_16( buffer, message->subscribe.message_id );
 
-            WRITE_STRING( buffer, message->subscribe.topics->name );
-
-            WRITE_8( buffer,
-                     message->subscribe.topics->xi_mqtt_topic_pair_payload_u.qos & 0xFF );
+            for ( topic = message->subscribe.topics; NULL != topic; topic = topic->next )
+            {
+                WRITE_STRING( buffer, topic->name );
+                WRITE_8( buffer, topic->xi_mqtt_topic_pair_payload_u.qos & 0xFF );
+            }
             break;
         }
 
@@ -287,9 +315,27 @@ xi_mqtt_serialiser_rc_t xi_mqtt_serialiser_write( xi_mqtt_serialiser_t* serialis
         {
             WRITE_16( buffer, message->suback.message_id );
 
-            WRITE_8( buffer,
-                     message->subscribe.topics->xi_mqtt_topic_pair_payload_u.status &
-                         0xFF );
+            for ( topic = message->suback.topics; NULL != topic; topic = topic->next )
+            {
+                WRITE_8( buffer, topic->xi_mqtt_topic_pair_payload_u.status & 0xFF );
+            }
+            break;
+        }
+
+        case XI_MQTT_TYPE_UNSUBSCRIBE:
+        {
+            WRITE_16( buffer, message->unsubscribe.message_id );
+
+            for ( topic = message->unsubscribe.topics; NULL != topic; topic = topic->next )
+            {
+                WRITE_STRING( buffer, topic->name );
+            }
+            break;
+        }
+
+        case XI_MQTT_TYPE_UNSUBACK:
+        {
+            WRITE_16( buffer, message->unsuback.message_id );
             break;
         }
 
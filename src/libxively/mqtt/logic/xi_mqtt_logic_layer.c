@@ -131,15 +131,12 @@ xi_state_t xi_mqtt_logic_layer_push( void* context, void* data, xi_state_t in_ou
                           task_to_be_called );
         }
 
-        /* restart layer keepalive - centralized for every successful send */
-        if ( XI_STATE_WRITTEN == in_out_state &&
-             NULL != layer_data->keepalive_event.ptr_to_position )
+        /* keepalive - centralized for every successful send, the timer itself is
+         * re-armed only when it fires */
+        if ( XI_STATE_WRITTEN == in_out_state )
         {
-            xi_state_t local_state = xi_evtd_restart(
-                XI_CONTEXT_DATA( context )->evtd_instance, &layer_data->keepalive_event,
-                XI_CONTEXT_DATA( context )->connection_data->keepalive_timeout );
-
-            XI_CHECK_STATE( local_state );
+            layer_data->last_send_time =
+                XI_CONTEXT_DATA( context )->evtd_instance->current_step;
         }
 
         if ( task_to_be_called != 0 )
@@ -206,6 +203,12 @@ xi_state_t xi_mqtt_logic_layer_push( void* context, void* data, xi_state_t in_ou
                 xi_make_handle( &do_mqtt_subscribe, context, task, XI_STATE_OK, 0 );
         }
         break;
+        case XI_MQTT_UNSUBSCRIBE:
+        {
+            task->logic =
+                xi_make_handle( &do_mqtt_unsubscribe, context, task, XI_STATE_OK, 0 );
+        }
+        break;
         case XI_MQTT_KEEPALIVE:
         {
             task->logic =
@@ -360,6 +363,62 @@ err_handling:
     return in_out_state;
 }
 
+/* rebuilds the publications the session log has not seen acknowledged, they are sent
+ * again with the DUP flag by the post connect together with the other queued tasks */
+static void
+xi_mqtt_logic_layer_replay_session_log( void* context,
+                                        xi_mqtt_logic_layer_data_t* layer_data )
+{
+    xi_session_log_t* session_log = XI_CONTEXT_DATA( context )->session_log;
+    xi_session_log_entry_t* entry = NULL;
+    xi_state_t state              = XI_STATE_OK;
+
+    if ( NULL == session_log || 0 == session_log->replay_pending )
+    {
+        return;
+    }
+
+    session_log->replay_pending = 0;
+
+    for ( entry = session_log->entries; NULL != entry; entry = entry->__next )
+    {
+        char* topic                = NULL;
+        xi_data_desc_t* data       = NULL;
+        xi_mqtt_retain_t retain    = XI_MQTT_RETAIN_FALSE;
+        xi_mqtt_logic_task_t* task = NULL;
+
+        XI_CHECK_STATE( state = xi_session_log_read_publish( session_log, entry, &topic,
+                                                             &data, &retain ) );
+
+        task = xi_mqtt_logic_make_publish_task( topic, data, XI_MQTT_QOS_AT_LEAST_ONCE,
+                                                retain, XI_PUBLISH_PRIORITY_NORMAL,
+                                                xi_make_empty_handle() );
+        XI_SAFE_FREE( topic );
+
+        if ( NULL == task )
+        {
+            xi_free_desc( &data );
+            state = XI_OUT_OF_MEMORY;
+            goto err_handling;
+        }
+
+        task->msg_id        = entry->msg_id;
+        task->session_state = XI_MQTT_LOGIC_TASK_SESSION_STORE;
+        task->logic =
+            xi_make_handle( &do_mqtt_publish_q1, context, task, XI_STATE_RESEND, 0 );
+
+        XI_LIST_PUSH_BACK( xi_mqtt_logic_task_t, layer_data->q12_tasks_queue, task );
+    }
+
+    layer_data->last_msg_id = session_log->last_msg_id;
+
+    return;
+
+err_handling:
+    xi_debug_format( "session log replay failed with state: %d", state );
+    layer_data->last_msg_id = session_log->last_msg_id;
+}
+
 xi_state_t xi_mqtt_logic_layer_init( void* context, void* data, xi_state_t in_out_state )
 {
     XI_LAYER_FUNCTION_PRINT_FUNCTION_DIGEST();
@@ -402,9 +461,20 @@ xi_state_t xi_mqtt_logic_layer_init( void* context, void* data, xi_state_t in_ou
         layer_data->last_msg_id =
             XI_THIS_LAYER( context )->context_data->copy_of_last_msg_id;
         XI_THIS_LAYER( context )->context_data->copy_of_last_msg_id = 0;
+
+        /* nothing kept in memory, the session may have been left by a previous run */
+        if ( NULL == layer_data->q12_tasks_queue )
+        {
+            xi_mqtt_logic_layer_replay_session_log( context, layer_data );
+        }
     }
     else
     {
+        if ( NULL != XI_CONTEXT_DATA( context )->session_log )
+        {
+            xi_session_log_reset( XI_CONTEXT_DATA( context )->session_log );
+        }
+
         if ( NULL != XI_THIS_LAYER( context )->context_data->copy_of_handlers_for_topics )
         {
             xi_vector_for_each(
@@ -480,7 +550,8 @@ xi_mqtt_logic_layer_post_connect( void* context, void* data, xi_state_t in_out_s
     }
 
     /* set new context and send timeout which will make the qos12 tasks to  continue they
-     * work just where they were stopped */
+     * work just where they were stopped, the ones that were pushed while connecting are
+     * started so that all of them are in flight at once */
     XI_LIST_FOREACH_WITH_ARG( xi_mqtt_logic_task_t, layer_data->q12_tasks_queue,
                               set_new_context_and_call_resend, context );
 
@@ -592,6 +663,11 @@ xi_mqtt_logic_layer_close_externally( void* context, void* data, xi_state_t in_o
         XI_LIST_FOREACH( xi_mqtt_logic_task_t, unacked_list,
                          xi_mqtt_logic_layer_task_make_context_null );
     }
+    else if ( NULL != context_data->session_log )
+    {
+        /* the unacknowledged publications go away with the clean session */
+        xi_session_log_reset( context_data->session_log );
+    }
 
     /* if the handlers for topics are left alone than it means
      * that it has to be freed */
@@ -9,6 +9,7 @@
 
 #include "xi_mqtt_logic_layer_connect_command.h"
 #include "xi_mqtt_logic_layer_subscribe_command.h"
+#include "xi_mqtt_logic_layer_unsubscribe_command.h"
 #include "xi_mqtt_logic_layer_publish_q0_command.h"
 #include "xi_mqtt_logic_layer_publish_q1_command.h"
 
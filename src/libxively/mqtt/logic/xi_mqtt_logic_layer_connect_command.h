@@ -77,8 +77,7 @@ do_mqtt_connect( void* ctx /* should be the context of the logic layer */
     xi_mqtt_logic_layer_data_t* layer_data =
         ( xi_mqtt_logic_layer_data_t* )XI_THIS_LAYER( context )->user_data;
 
-    xi_mqtt_message_t* msg_memory        = ( xi_mqtt_message_t* )msg_data;
-    xi_evtd_instance_t* event_dispatcher = XI_CONTEXT_DATA( context )->evtd_instance;
+    xi_mqtt_message_t* msg_memory = ( xi_mqtt_message_t* )msg_data;
 
     if ( XI_THIS_LAYER_NOT_OPERATIONAL( context ) || layer_data == 0 )
     {
@@ -153,10 +152,7 @@ do_mqtt_connect( void* ctx /* should be the context of the logic layer */
 
             if ( XI_CONTEXT_DATA( context )->connection_data->keepalive_timeout > 0 )
             {
-                state = xi_evtd_execute_in(
-                    event_dispatcher, xi_make_handle( &do_mqtt_keepalive_once, context ),
-                    XI_CONTEXT_DATA( context )->connection_data->keepalive_timeout,
-                    &layer_data->keepalive_event );
+                state = xi_mqtt_logic_layer_keepalive_start( context );
 
                 XI_CHECK_STATE( state );
             }
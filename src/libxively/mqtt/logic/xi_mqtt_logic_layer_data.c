@@ -4,6 +4,7 @@
  * it is licensed under the BSD 3-Clause license.
  */
 
+#include "xi_bsp_time.h"
 #include "xi_helpers.h"
 #include "xi_macros.h"
 #include "xi_mqtt_logic_layer_data.h"
@@ -12,11 +13,13 @@
 extern "C" {
 #endif
 
-xi_mqtt_logic_task_t* xi_mqtt_logic_make_publish_task( const char* topic,
-                                                       xi_data_desc_t* data,
-                                                       const xi_mqtt_qos_t qos,
-                                                       const xi_mqtt_retain_t retain,
-                                                       xi_event_handle_t callback )
+xi_mqtt_logic_task_t*
+xi_mqtt_logic_make_publish_task( const char* topic,
+                                 xi_data_desc_t* data,
+                                 const xi_mqtt_qos_t qos,
+                                 const xi_mqtt_retain_t retain,
+                                 const xi_publish_priority_t priority,
+                                 xi_event_handle_t callback )
 {
     /* PRECONDITIONS */
     assert( NULL != topic );
@@ -37,6 +40,9 @@ xi_mqtt_logic_task_t* xi_mqtt_logic_make_publish_task( const char* topic,
     task->data.data_u->publish.topic  = xi_str_dup( topic );
     task->data.data_u->publish.data   = data;
 
+    task->data.data_u->publish.priority  = priority;
+    task->data.data_u->publish.queued_ms = xi_bsp_time_getcurrenttime_milliseconds();
+
     return task;
 
 err_handling:
@@ -47,6 +53,18 @@ err_handling:
     return NULL;
 }
 
+xi_publish_priority_t
+xi_mqtt_logic_task_publish_priority( const xi_mqtt_logic_task_t* task )
+{
+    if ( XI_MQTT_PUBLISH != task->data.mqtt_settings.scenario ||
+         NULL == task->data.data_u )
+    {
+        return XI_PUBLISH_PRIORITY_NORMAL;
+    }
+
+    return task->data.data_u->publish.priority;
+}
+
 xi_mqtt_logic_task_t* xi_mqtt_logic_make_subscribe_task( char* topic,
                                                          const xi_mqtt_qos_t qos,
                                                          xi_event_handle_t handler )
@@ -77,6 +95,89 @@ err_handling:
     return NULL;
 }
 
+xi_state_t xi_mqtt_logic_subscribe_task_add_topic( xi_mqtt_logic_task_t* task,
+                                                   char* topic,
+                                                   const xi_mqtt_qos_t qos,
+                                                   xi_event_handle_t handler )
+{
+    /* PRECONDITIONS */
+    assert( NULL != task );
+    assert( NULL != task->data.data_u );
+    assert( XI_MQTT_SUBSCRIBE == task->data.mqtt_settings.scenario );
+    assert( NULL != topic );
+
+    xi_state_t state                   = XI_STATE_OK;
+    xi_mqtt_task_specific_data_t* last = task->data.data_u;
+
+    while ( NULL != last->subscribe.next )
+    {
+        last = last->subscribe.next;
+    }
+
+    XI_ALLOC_AT( xi_mqtt_task_specific_data_t, last->subscribe.next, state );
+
+    last->subscribe.next->subscribe.topic   = topic;
+    last->subscribe.next->subscribe.qos     = qos;
+    last->subscribe.next->subscribe.handler = handler;
+
+err_handling:
+    return state;
+}
+
+xi_mqtt_logic_task_t* xi_mqtt_logic_make_unsubscribe_task( char* topic,
+                                                           xi_event_handle_t callback )
+{
+    /* PRECONDITIONS */
+    assert( NULL != topic );
+
+    xi_state_t state = XI_STATE_OK;
+
+    XI_ALLOC( xi_mqtt_logic_task_t, task, state );
+
+    task->data.mqtt_settings.scenario = XI_MQTT_UNSUBSCRIBE;
+    task->data.mqtt_settings.qos      = XI_MQTT_QOS_AT_LEAST_ONCE;
+
+    task->callback = callback;
+
+    XI_ALLOC_AT( xi_mqtt_task_specific_data_t, task->data.data_u, state );
+
+    task->data.data_u->unsubscribe.topic = topic;
+
+    return task;
+
+err_handling:
+    if ( task )
+    {
+        xi_mqtt_logic_free_task( &task );
+    }
+    return NULL;
+}
+
+xi_state_t
+xi_mqtt_logic_unsubscribe_task_add_topic( xi_mqtt_logic_task_t* task, char* topic )
+{
+    /* PRECONDITIONS */
+    assert( NULL != task );
+    assert( NULL != task->data.data_u );
+    assert( XI_MQTT_UNSUBSCRIBE == task->data.mqtt_settings.scenario );
+    assert( NULL != topic );
+
+    xi_state_t state                   = XI_STATE_OK;
+    xi_mqtt_task_specific_data_t* last = task->data.data_u;
+
+    while ( NULL != last->unsubscribe.next )
+    {
+        last = last->unsubscribe.next;
+    }
+
+    XI_ALLOC_AT( xi_mqtt_task_specific_data_t, last->unsubscribe.next, state );
+
+    last->unsubscribe.next->unsubscribe.topic = topic;
+
+err_handling:
+    return state;
+}
+
 xi_mqtt_logic_task_t* xi_mqtt_logic_make_shutdown_task( void )
 {
     xi_state_t state = XI_STATE_OK;
@@ -113,8 +214,32 @@ void xi_mqtt_task_spec_data_free_subscribe_data( xi_mqtt_task_specific_data_t**
     assert( NULL != data );
     assert( NULL != *data );
 
-    XI_SAFE_FREE( ( *data )->subscribe.topic );
-    XI_SAFE_FREE( ( *data ) );
+    while ( NULL != *data )
+    {
+        xi_mqtt_task_specific_data_t* next = ( *data )->subscribe.next;
+
+        XI_SAFE_FREE( ( *data )->subscribe.topic );
+        XI_SAFE_FREE( ( *data ) );
+
+        *data = next;
+    }
+}
+
+void xi_mqtt_task_spec_data_free_unsubscribe_data( xi_mqtt_task_specific_data_t** data )
+{
+    /* PRECONDITIONS */
+    assert( NULL != data );
+    assert( NULL != *data );
+
+    while ( NULL != *data )
+    {
+        xi_mqtt_task_specific_data_t* next = ( *data )->unsubscribe.next;
+
+        XI_SAFE_FREE( ( *data )->unsubscribe.topic );
+        XI_SAFE_FREE( ( *data ) );
+
+        *data = next;
+    }
 }
 
 void xi_mqtt_task_spec_data_free_subscribe_data_vec( union xi_vector_selector_u* data,
@@ -141,6 +266,9 @@ xi_mqtt_logic_task_t* xi_mqtt_logic_free_task_data( xi_mqtt_logic_task_t* task )
         case XI_MQTT_SUBSCRIBE:
             xi_mqtt_task_spec_data_free_subscribe_data( &task->data.data_u );
             break;
+        case XI_MQTT_UNSUBSCRIBE:
+            xi_mqtt_task_spec_data_free_unsubscribe_data( &task->data.data_u );
+            break;
         case XI_MQTT_SHUTDOWN:
             break;
         default:
@@ -21,17 +21,20 @@ typedef enum xi_scenario_e {
     XI_MQTT_PUBLISH,
     XI_MQTT_PUBACK,
     XI_MQTT_SUBSCRIBE,
+    XI_MQTT_UNSUBSCRIBE,
     XI_MQTT_KEEPALIVE,
     XI_MQTT_SHUTDOWN
 } xi_scenario_t;
 
-typedef union {
+typedef union xi_mqtt_task_specific_data_u {
     struct data_t_publish_t
     {
         char* topic;
         xi_data_desc_t* data;
         xi_mqtt_retain_t retain;
         xi_mqtt_dup_t dup;
+        xi_publish_priority_t priority;
+        xi_time_t queued_ms; /* when the publication entered the layer chain */
     } publish;
 
     struct data_t_subscribe_t
@@ -39,8 +42,16 @@ typedef union {
         char* topic;
         xi_event_handle_t handler;
         xi_mqtt_qos_t qos;
+        /* further topic filters of the same SUBSCRIBE, NULL once registered */
+        union xi_mqtt_task_specific_data_u* next;
     } subscribe;
 
+    struct data_t_unsubscribe_t
+    {
+        char* topic;
+        union xi_mqtt_task_specific_data_u* next;
+    } unsubscribe;
+
     struct data_t_shutdown_t
     {
         char placeholder; /* This is to meet requirements of the IAR ARM
@@ -98,6 +109,8 @@ typedef struct
     xi_mqtt_logic_task_t* current_q0_task;
     xi_vector_t* handlers_for_topics;
     xi_time_event_handle_t keepalive_event;
+    xi_time_t last_send_time;
+    xi_time_t keepalive_interval; /* keepalive timeout less the jitter */
     uint16_t last_msg_id;
 } xi_mqtt_logic_layer_data_t;
 
@@ -107,19 +120,40 @@ xi_mqtt_logic_make_publish_task( const char* topic,
                                  xi_data_desc_t* data,
                                  const xi_mqtt_qos_t qos,
                                  const xi_mqtt_retain_t retain,
+                                 const xi_publish_priority_t priority,
                                  xi_event_handle_t callback );
 
+/* priority class of the task, the tasks other than publications are of the normal one */
+extern xi_publish_priority_t
+xi_mqtt_logic_task_publish_priority( const xi_mqtt_logic_task_t* task );
+
 extern xi_mqtt_logic_task_t*
 xi_mqtt_logic_make_subscribe_task( char* topic,
                                    const xi_mqtt_qos_t qos,
                                    xi_event_handle_t handler );
 
+/* appends a topic filter to the SUBSCRIBE of the task, the topic is owned by the
+ * task on success */
+extern xi_state_t xi_mqtt_logic_subscribe_task_add_topic( xi_mqtt_logic_task_t* task,
+                                                          char* topic,
+                                                          const xi_mqtt_qos_t qos,
+                                                          xi_event_handle_t handler );
+
+extern xi_mqtt_logic_task_t*
+xi_mqtt_logic_make_unsubscribe_task( char* topic, xi_event_handle_t callback );
+
+extern xi_state_t
+xi_mqtt_logic_unsubscribe_task_add_topic( xi_mqtt_logic_task_t* task, char* topic );
+
 extern void
 xi_mqtt_task_spec_data_free_publish_data( xi_mqtt_task_specific_data_t** data );
 
 extern void
 xi_mqtt_task_spec_data_free_subscribe_data( xi_mqtt_task_specific_data_t** data );
 
+extern void
+xi_mqtt_task_spec_data_free_unsubscribe_data( xi_mqtt_task_specific_data_t** data );
+
 extern void
 xi_mqtt_task_spec_data_free_subscribe_data_vec( union xi_vector_selector_u* data,
                                                 void* arg );
@@ -33,6 +33,17 @@ cmp_topics( const union xi_vector_selector_u* a, const union xi_vector_selector_
     return 1;
 }
 
+/* exact match of the subscribed topic filter, b is expected to be a string */
+static inline int8_t cmp_subscribed_topic( const union xi_vector_selector_u* a,
+                                           const union xi_vector_selector_u* b )
+{
+    const xi_mqtt_task_specific_data_t* ca =
+        ( const xi_mqtt_task_specific_data_t* )a->ptr_value;
+    const char* cb = ( const char* )b->ptr_value;
+
+    return strcmp( ca->subscribe.topic, cb ) == 0 ? 0 : 1;
+}
+
 static inline xi_state_t fill_with_pingreq_data( xi_mqtt_message_t* msg )
 {
     memset( msg, 0, sizeof( xi_mqtt_message_t ) );
@@ -225,6 +236,68 @@ err_handling:
     return local_state;
 }
 
+/* adds a further topic filter to a SUBSCRIBE prepared by fill_with_subscribe_data */
+static inline xi_state_t append_subscribe_topic( xi_mqtt_message_t* msg,
+                                                 const char* topic,
+                                                 const xi_mqtt_qos_t qos )
+{
+    xi_state_t local_state     = XI_STATE_OK;
+    xi_mqtt_topicpair_t* entry = NULL;
+
+    XI_CHECK_STATE( local_state =
+                        xi_mqtt_topicpair_append( &msg->subscribe.topics, &entry ) );
+
+    XI_CHECK_MEMORY( entry->name = xi_make_desc_from_string_copy( topic ), local_state );
+
+    entry->xi_mqtt_topic_pair_payload_u.qos = qos;
+
+err_handling:
+    return local_state;
+}
+
+static inline xi_state_t fill_with_unsubscribe_data( xi_mqtt_message_t* msg,
+                                                     const char* topic,
+                                                     const uint16_t msg_id,
+                                                     const xi_mqtt_dup_t dup )
+{
+    xi_state_t local_state     = XI_STATE_OK;
+    xi_mqtt_topicpair_t* entry = NULL;
+
+    memset( msg, 0, sizeof( xi_mqtt_message_t ) );
+
+    msg->common.common_u.common_bits.retain = XI_MQTT_RETAIN_FALSE;
+    msg->common.common_u.common_bits.qos =
+        XI_MQTT_QOS_AT_LEAST_ONCE; /* forced by the protocol */
+    msg->common.common_u.common_bits.dup  = dup;
+    msg->common.common_u.common_bits.type = XI_MQTT_TYPE_UNSUBSCRIBE;
+    msg->common.remaining_length = 0; /* this is filled during the serialization */
+
+    msg->unsubscribe.message_id = msg_id;
+
+    XI_CHECK_STATE( local_state =
+                        xi_mqtt_topicpair_append( &msg->unsubscribe.topics, &entry ) );
+
+    XI_CHECK_MEMORY( entry->name = xi_make_desc_from_string_copy( topic ), local_state );
+
+err_handling:
+    return local_state;
+}
+
+static inline xi_state_t
+append_unsubscribe_topic( xi_mqtt_message_t* msg, const char* topic )
+{
+    xi_state_t local_state     = XI_STATE_OK;
+    xi_mqtt_topicpair_t* entry = NULL;
+
+    XI_CHECK_STATE( local_state =
+                        xi_mqtt_topicpair_append( &msg->unsubscribe.topics, &entry ) );
+
+    XI_CHECK_MEMORY( entry->name = xi_make_desc_from_string_copy( topic ), local_state );
+
+err_handling:
+    return local_state;
+}
+
 static inline xi_state_t fill_with_disconnect_data( xi_mqtt_message_t* msg )
 {
     memset( msg, 0, sizeof( xi_mqtt_message_t ) );
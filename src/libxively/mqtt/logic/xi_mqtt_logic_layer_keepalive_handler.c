@@ -4,6 +4,7 @@
  * it is licensed under the BSD 3-Clause license.
  */
 
+#include "xi_config.h"
 #include "xi_coroutine.h"
 #include "xi_layer_api.h"
 #include "xi_globals.h"
@@ -11,11 +12,53 @@
 #include "xi_mqtt_logic_layer_data.h"
 #include "xi_mqtt_logic_layer_keepalive_handler.h"
 #include "xi_mqtt_logic_layer_helpers.h"
+#include "xi_bsp_rng.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/* the next PINGREQ is due an interval after the last send */
+static xi_state_t
+xi_mqtt_logic_layer_keepalive_schedule( xi_layer_connectivity_t* context,
+                                        xi_mqtt_logic_layer_data_t* layer_data )
+{
+    xi_evtd_instance_t* event_dispatcher = XI_CONTEXT_DATA( context )->evtd_instance;
+
+    const xi_time_t idle_time =
+        event_dispatcher->current_step - layer_data->last_send_time;
+
+    return xi_evtd_execute_in(
+        event_dispatcher, xi_make_handle( &do_mqtt_keepalive_once, context ),
+        ( idle_time < layer_data->keepalive_interval )
+            ? layer_data->keepalive_interval - idle_time
+            : 0,
+        &layer_data->keepalive_event );
+}
+
+xi_state_t xi_mqtt_logic_layer_keepalive_start( void* data )
+{
+    xi_layer_connectivity_t* context = data;
+    xi_time_t jitter                 = 0;
+
+    xi_mqtt_logic_layer_data_t* layer_data =
+        ( xi_mqtt_logic_layer_data_t* )XI_THIS_LAYER( context )->user_data;
+
+    const xi_time_t keepalive_timeout =
+        XI_CONTEXT_DATA( context )->connection_data->keepalive_timeout;
+
+#if 0 < XI_MQTT_KEEPALIVE_JITTER_DIVISOR
+    jitter =
+        xi_bsp_rng_get() % ( keepalive_timeout / XI_MQTT_KEEPALIVE_JITTER_DIVISOR + 1 );
+#endif
+
+    /* the CONNECT has just been sent */
+    layer_data->last_send_time = XI_CONTEXT_DATA( context )->evtd_instance->current_step;
+    layer_data->keepalive_interval = keepalive_timeout - jitter;
+
+    return xi_mqtt_logic_layer_keepalive_schedule( context, layer_data );
+}
+
 xi_state_t do_mqtt_keepalive_once( void* data )
 {
     xi_layer_connectivity_t* context = data;
@@ -31,6 +74,16 @@ xi_state_t do_mqtt_keepalive_once( void* data )
 
     layer_data->keepalive_event.ptr_to_position = NULL;
 
+    /* the broker has heard from us meanwhile, no need to ping */
+    if ( XI_CONTEXT_DATA( context )->evtd_instance->current_step -
+             layer_data->last_send_time <
+         layer_data->keepalive_interval )
+    {
+        XI_CONTEXT_DATA( context )->keepalive_stats.pings_avoided += 1;
+
+        return xi_mqtt_logic_layer_keepalive_schedule( context, layer_data );
+    }
+
     XI_ALLOC( xi_mqtt_logic_task_t, task, state );
 
     task->data.mqtt_settings.scenario = XI_MQTT_KEEPALIVE;
@@ -77,6 +130,7 @@ do_mqtt_keepalive_task( void* ctx, void* data, xi_state_t state, void* msg_data
 
     if ( state == XI_STATE_WRITTEN )
     {
+        XI_CONTEXT_DATA( context )->keepalive_stats.pings_sent += 1;
         xi_debug_logger( "pingreq message sent... waiting for response" );
     }
     else
@@ -131,10 +185,7 @@ do_mqtt_keepalive_task( void* ctx, void* data, xi_state_t state, void* msg_data
     if ( XI_CONTEXT_DATA( context )->connection_data->connection_state ==
          XI_CONNECTION_STATE_OPENED )
     {
-        state = xi_evtd_execute_in(
-            event_dispatcher, xi_make_handle( &do_mqtt_keepalive_once, context ),
-            XI_CONTEXT_DATA( context )->connection_data->keepalive_timeout,
-            &layer_data->keepalive_event );
+        state = xi_mqtt_logic_layer_keepalive_schedule( context, layer_data );
         XI_CHECK_STATE( state );
     }
 
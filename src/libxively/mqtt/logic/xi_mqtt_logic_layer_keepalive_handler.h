@@ -13,6 +13,16 @@
 extern "C" {
 #endif
 
+/**
+ * @brief xi_mqtt_logic_layer_keepalive_start arms the keepalive of a connection
+ *
+ * A PINGREQ is due when nothing has been sent for the keepalive interval: the keepalive
+ * timeout shortened by a random jitter, so the pings of a fleet connected at the same
+ * time spread out. Sends only record their time, the timer is re-armed lazily when it
+ * fires and finds the connection has not been idle for the interval.
+ */
+xi_state_t xi_mqtt_logic_layer_keepalive_start( void* context );
+
 xi_state_t do_mqtt_keepalive_once( void* data );
 
 xi_state_t
@@ -60,6 +60,9 @@ do_mqtt_publish_q0( void* ctx, /* should be the context of the logic layer */
                         task->data.data_u->publish.data, XI_MQTT_QOS_AT_MOST_ONCE,
                         task->data.data_u->publish.retain, XI_MQTT_DUP_FALSE, 0 ) );
 
+    msg_memory->publish.priority  = task->data.data_u->publish.priority;
+    msg_memory->publish.queued_ms = task->data.data_u->publish.queued_ms;
+
     xi_debug_logger( "publish sending message..." );
 
     /* wait till it is sent */
@@ -19,6 +19,19 @@
 extern "C" {
 #endif
 
+/* the publication is over, acknowledged or not it must not be replayed anymore */
+static inline void
+xi_mqtt_logic_publish_q1_end_session_log( xi_layer_connectivity_t* context,
+                                          xi_mqtt_logic_task_t* task )
+{
+    if ( XI_MQTT_LOGIC_TASK_SESSION_STORE == task->session_state &&
+         NULL != XI_CONTEXT_DATA( context )->session_log )
+    {
+        xi_session_log_append_puback( XI_CONTEXT_DATA( context )->session_log,
+                                      task->msg_id );
+    }
+}
+
 static xi_state_t
 do_mqtt_publish_q1( void* ctx /* should be the context of the logic layer */
                     ,
@@ -68,6 +81,9 @@ do_mqtt_publish_q1( void* ctx /* should be the context of the logic layer */
                 state == XI_STATE_RESEND ? XI_MQTT_DUP_TRUE : XI_MQTT_DUP_FALSE,
                 task->msg_id ) );
 
+        msg_memory->publish.priority  = task->data.data_u->publish.priority;
+        msg_memory->publish.queued_ms = task->data.data_u->publish.queued_ms;
+
         xi_debug_format( "[m.id[%d]]publish q1 sending message", task->msg_id );
 
         XI_CR_YIELD( task->cs,
@@ -76,6 +92,17 @@ do_mqtt_publish_q1( void* ctx /* should be the context of the logic layer */
         if ( state == XI_STATE_WRITTEN )
         {
             xi_debug_format( "[m.id[%d]]publish q1 has been sent", task->msg_id );
+
+            /* the first write makes the publication a part of the session */
+            if ( XI_MQTT_LOGIC_TASK_SESSION_UNSET == task->session_state &&
+                 NULL != XI_CONTEXT_DATA( context )->session_log )
+            {
+                xi_session_log_append_publish(
+                    XI_CONTEXT_DATA( context )->session_log, task->msg_id,
+                    task->data.data_u->publish.topic, task->data.data_u->publish.data,
+                    XI_MQTT_QOS_AT_LEAST_ONCE, task->data.data_u->publish.retain );
+            }
+
             task->session_state = task->session_state == XI_MQTT_LOGIC_TASK_SESSION_UNSET
                                       ? XI_MQTT_LOGIC_TASK_SESSION_STORE
                                       : task->session_state;
@@ -153,6 +180,8 @@ do_mqtt_publish_q1( void* ctx /* should be the context of the logic layer */
 
     xi_debug_format( "[m.id[%d]]publish q1 publish puback received", task->msg_id );
 
+    xi_mqtt_logic_publish_q1_end_session_log( context, task );
+
     xi_mqtt_logic_task_defer_users_callback( context, task, state );
 
     xi_mqtt_message_free( &msg_memory );
@@ -164,6 +193,8 @@ do_mqtt_publish_q1( void* ctx /* should be the context of the logic layer */
     XI_CR_END();
 
 err_handling:
+    xi_mqtt_logic_publish_q1_end_session_log( context, task );
+
     xi_mqtt_logic_task_defer_users_callback( context, task, state );
 
     xi_mqtt_message_free( &msg_memory );
@@ -31,6 +31,8 @@ do_mqtt_subscribe( void* ctx, void* data, xi_state_t state, void* msg )
     xi_mqtt_message_t* msg_memory        = ( xi_mqtt_message_t* )msg;
     xi_evtd_instance_t* event_dispatcher = XI_CONTEXT_DATA( ctx )->evtd_instance;
     xi_state_t local_state               = XI_STATE_OK;
+    xi_mqtt_task_specific_data_t* entry  = NULL;
+    xi_mqtt_topicpair_t* topic           = NULL;
 
     xi_mqtt_logic_layer_data_t* layer_data =
         ( xi_mqtt_logic_layer_data_t* )XI_THIS_LAYER( context )->user_data;
@@ -58,6 +60,15 @@ do_mqtt_subscribe( void* ctx, void* data, xi_state_t state, void* msg )
                 task->data.data_u->subscribe.qos,
                 XI_STATE_RESEND == state ? XI_MQTT_DUP_TRUE : XI_MQTT_DUP_FALSE ) );
 
+        /* the rest of the batch goes into the same message */
+        for ( entry = task->data.data_u->subscribe.next; NULL != entry;
+              entry = entry->subscribe.next )
+        {
+            XI_CHECK_STATE( state = append_subscribe_topic( msg_memory,
+                                                            entry->subscribe.topic,
+                                                            entry->subscribe.qos ) );
+        }
+
         xi_debug_format( "[m.id[%d]]subscribe sending message", task->msg_id );
 
         XI_CR_YIELD( task->cs,
@@ -146,37 +157,48 @@ do_mqtt_subscribe( void* ctx, void* data, xi_state_t state, void* msg )
 
         xi_debug_format( "[m.id[%d]]subscribe suback received", task->msg_id );
 
-        xi_mqtt_suback_status_t suback_status =
-            msg_memory->suback.topics->xi_mqtt_topic_pair_payload_u.status;
-
-        xi_mqtt_message_free( &msg_memory );
+        /* the return codes come in the order of the topic filters, each topic filter
+         * gets its own callback, a missing return code counts as a failure */
+        topic = msg_memory->suback.topics;
 
-        task->data.data_u->subscribe.handler.handlers.h6.a2 =
-            ( void* )( intptr_t )suback_status;
-
-        task->data.data_u->subscribe.handler.handlers.h6.a3 =
-            suback_status == XI_MQTT_SUBACK_FAILED ? XI_MQTT_SUBSCRIPTION_FAILED
-                                                   : XI_MQTT_SUBSCRIPTION_SUCCESSFULL;
-
-        /* check if the suback registration was successfull */
-        if ( XI_MQTT_SUBACK_FAILED != suback_status )
+        while ( NULL != task->data.data_u )
         {
-            /* now it can be registered - we are passing the ownership of the data.data_u
-             * to the vector */
-            XI_CHECK_MEMORY( xi_vector_push( layer_data->handlers_for_topics,
-                                             XI_VEC_VALUE_PARAM( XI_VEC_VALUE_PTR(
-                                                 task->data.data_u ) ) ),
-                             state );
+            entry = task->data.data_u;
+
+            xi_mqtt_suback_status_t suback_status =
+                NULL != topic ? topic->xi_mqtt_topic_pair_payload_u.status
+                              : XI_MQTT_SUBACK_FAILED;
+
+            topic = NULL != topic ? topic->next : NULL;
+
+            entry->subscribe.handler.handlers.h6.a2 = ( void* )( intptr_t )suback_status;
+
+            entry->subscribe.handler.handlers.h6.a3 =
+                suback_status == XI_MQTT_SUBACK_FAILED ? XI_MQTT_SUBSCRIPTION_FAILED
+                                                       : XI_MQTT_SUBSCRIPTION_SUCCESSFULL;
+
+            /* check if the suback registration was successfull */
+            if ( XI_MQTT_SUBACK_FAILED != suback_status )
+            {
+                /* now it can be registered - we are passing the ownership of the
+                 * entry to the vector */
+                XI_CHECK_MEMORY( xi_vector_push( layer_data->handlers_for_topics,
+                                                 XI_VEC_VALUE_PARAM(
+                                                     XI_VEC_VALUE_PTR( entry ) ) ),
+                                 state );
+            }
+
+            /* now it's safe to detach the entry because the ownership of this memory
+             * block is now passed either to a subscription callback or the
+             * handlers_for_topics vector if the subscription was succesfull */
+            task->data.data_u     = entry->subscribe.next;
+            entry->subscribe.next = NULL;
+
+            XI_CHECK_MEMORY(
+                xi_evtd_execute( event_dispatcher, entry->subscribe.handler ), state );
         }
 
-        XI_CHECK_MEMORY(
-            xi_evtd_execute( event_dispatcher, task->data.data_u->subscribe.handler ),
-            state );
-
-        /* now it's safe to nullify this pointer because the ownership of this memory
-         * block is now passed either to a subscription callback or the
-         * handlers_for_topics vector if the subscription was succesfull */
-        task->data.data_u = NULL;
+        xi_mqtt_message_free( &msg_memory );
 
         XI_CR_EXIT( task->cs, xi_mqtt_logic_layer_finalize_task( context, task ) );
     }
@@ -29,6 +29,11 @@ void xi_mqtt_logic_task_defer_users_callback( void* context,
 
 #define CMP_TASK_MSG_ID( task, id ) ( task->msg_id == id )
 
+/* the immediate tasks stay ahead of all of the publications */
+#define CMP_TASK_LOWER_PRIORITY( task, publish_priority )                                \
+    ( XI_MQTT_LOGIC_TASK_IMMEDIATE != task->priority &&                                  \
+      xi_mqtt_logic_task_publish_priority( task ) < publish_priority )
+
 static inline void
 cancel_task_timeout( xi_mqtt_logic_task_t* task, xi_layer_connectivity_t* context )
 {
@@ -92,6 +97,13 @@ set_new_context_and_call_resend( xi_mqtt_logic_task_t* task, void* context )
         task->logic.handlers.h4.a1 = context;
         resend_task( task );
     }
+    else if ( 0 == task->cs )
+    {
+        /* queued before the CONNACK, it has not sent anything yet so it is started
+         * now together with the others instead of one by one */
+        task->logic.handlers.h4.a1 = context;
+        xi_evtd_execute_handle( &task->logic );
+    }
 }
 
 static inline xi_state_t
@@ -111,8 +123,11 @@ run_task( xi_layer_connectivity_t* context, xi_mqtt_logic_task_t* task )
         switch ( task->priority )
         {
             case XI_MQTT_LOGIC_TASK_NORMAL:
-                XI_LIST_PUSH_BACK( xi_mqtt_logic_task_t, layer_data->q0_tasks_queue,
-                                   task );
+                /* behind the tasks of the same or a higher class */
+                XI_LIST_INSERT_BEFORE(
+                    xi_mqtt_logic_task_t, layer_data->q0_tasks_queue,
+                    CMP_TASK_LOWER_PRIORITY, xi_mqtt_logic_task_publish_priority( task ),
+                    task );
                 break;
             case XI_MQTT_LOGIC_TASK_IMMEDIATE:
                 XI_LIST_PUSH_FRONT( xi_mqtt_logic_task_t, layer_data->q0_tasks_queue,
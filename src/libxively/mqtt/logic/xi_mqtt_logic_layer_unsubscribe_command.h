@@ -0,0 +1,206 @@
+/* Copyright (c) 2003-2018, Xively All rights reserved.
+ *
+ * This is part of the Xively C Client library,
+ * it is licensed under the BSD 3-Clause license.
+ */
+
+#ifndef __XI_MQTT_LOGIC_LAYER_UNSUBSCRIBE_COMMAND_H__
+#define __XI_MQTT_LOGIC_LAYER_UNSUBSCRIBE_COMMAND_H__
+
+#include "xi_layer_api.h"
+#include "xi_mqtt_logic_layer_data.h"
+#include "xi_coroutine.h"
+#include "xi_mqtt_message.h"
+#include "xi_mqtt_logic_layer_data_helpers.h"
+#include "xi_mqtt_logic_layer_task_helpers.h"
+#include "xi_globals.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* drops every registered handler of the topic filter */
+static inline void xi_mqtt_logic_unregister_topic( xi_mqtt_logic_layer_data_t* layer_data,
+                                                   const char* topic )
+{
+    xi_vector_index_type_t index = -1;
+
+    while ( -1 != ( index = xi_vector_find(
+                        layer_data->handlers_for_topics,
+                        XI_VEC_CONST_VALUE_PARAM( XI_VEC_VALUE_PTR( ( void* )topic ) ),
+                        cmp_subscribed_topic ) ) )
+    {
+        xi_mqtt_task_specific_data_t* subscribe_data =
+            ( xi_mqtt_task_specific_data_t* )layer_data->handlers_for_topics->array[index]
+                .selector_t.ptr_value;
+
+        xi_vector_del( layer_data->handlers_for_topics, index );
+        xi_mqtt_task_spec_data_free_subscribe_data( &subscribe_data );
+    }
+}
+
+static inline xi_state_t
+do_mqtt_unsubscribe( void* ctx, void* data, xi_state_t state, void* msg )
+{
+    xi_layer_connectivity_t* context = ( xi_layer_connectivity_t* )ctx;
+    xi_mqtt_logic_task_t* task       = ( xi_mqtt_logic_task_t* )data;
+
+    assert( NULL != context );
+    assert( NULL != task );
+
+    xi_mqtt_message_t* msg_memory        = ( xi_mqtt_message_t* )msg;
+    xi_evtd_instance_t* event_dispatcher = XI_CONTEXT_DATA( ctx )->evtd_instance;
+    xi_state_t local_state               = XI_STATE_OK;
+    xi_mqtt_task_specific_data_t* entry  = NULL;
+
+    xi_mqtt_logic_layer_data_t* layer_data =
+        ( xi_mqtt_logic_layer_data_t* )XI_THIS_LAYER( context )->user_data;
+
+    if ( NULL == layer_data )
+    {
+        cancel_task_timeout( task, context );
+        xi_mqtt_message_free( &msg_memory );
+        return XI_STATE_OK;
+    }
+
+    XI_CR_START( task->cs );
+
+    do
+    {
+        xi_debug_format( "[m.id[%d]]unsubscribe preparing message", task->msg_id );
+
+        XI_ALLOC_AT( xi_mqtt_message_t, msg_memory, state );
+
+        XI_CHECK_STATE(
+            state = fill_with_unsubscribe_data(
+                msg_memory, task->data.data_u->unsubscribe.topic, task->msg_id,
+                XI_STATE_RESEND == state ? XI_MQTT_DUP_TRUE : XI_MQTT_DUP_FALSE ) );
+
+        for ( entry = task->data.data_u->unsubscribe.next; NULL != entry;
+              entry = entry->unsubscribe.next )
+        {
+            XI_CHECK_STATE( state = append_unsubscribe_topic(
+                                msg_memory, entry->unsubscribe.topic ) );
+        }
+
+        xi_debug_format( "[m.id[%d]]unsubscribe sending message", task->msg_id );
+
+        XI_CR_YIELD( task->cs,
+                     XI_PROCESS_PUSH_ON_PREV_LAYER( context, msg_memory, XI_STATE_OK ) );
+
+        if ( XI_STATE_WRITTEN == state )
+        {
+            xi_debug_format( "[m.id[%d]]unsubscribe has been sent", task->msg_id );
+            assert( NULL == task->timeout.ptr_to_position );
+            task->session_state = task->session_state == XI_MQTT_LOGIC_TASK_SESSION_UNSET
+                                      ? XI_MQTT_LOGIC_TASK_SESSION_STORE
+                                      : task->session_state;
+        }
+        else
+        {
+            xi_debug_format( "[m.id[%d]]unsubscribe has not been sent", task->msg_id );
+
+            assert( NULL == task->timeout.ptr_to_position );
+
+            local_state = xi_evtd_execute_in(
+                event_dispatcher, xi_make_handle( &do_mqtt_unsubscribe, context, task,
+                                                  XI_STATE_RESEND, NULL ),
+                1, &task->timeout );
+
+            XI_CHECK_STATE( local_state );
+
+            XI_CR_YIELD( task->cs, XI_STATE_OK );
+
+            /* sanity checks */
+            assert( NULL == task->timeout.ptr_to_position );
+            assert( XI_STATE_RESEND == state );
+
+            continue;
+        }
+
+        assert( NULL == task->timeout.ptr_to_position );
+
+        if ( XI_CONTEXT_DATA( context )->connection_data->keepalive_timeout > 0 )
+        {
+            local_state = xi_evtd_execute_in(
+                event_dispatcher, xi_make_handle( &do_mqtt_unsubscribe, context, task,
+                                                  XI_STATE_TIMEOUT, NULL ),
+                XI_CONTEXT_DATA( context )->connection_data->keepalive_timeout,
+                &task->timeout );
+            XI_CHECK_STATE( local_state );
+        }
+
+        /* wait for the unsuback */
+        XI_CR_YIELD( task->cs, XI_STATE_OK );
+
+        if ( XI_STATE_TIMEOUT == state )
+        {
+            xi_debug_format( "[m.id[%d]]unsubscribe timeout occured", task->msg_id );
+            assert( NULL == task->timeout.ptr_to_position );
+            state = XI_STATE_RESEND;
+        }
+        else
+        {
+            cancel_task_timeout( task, context );
+        }
+
+        assert( NULL == task->timeout.ptr_to_position );
+
+    } while ( XI_STATE_RESEND == state );
+
+    assert( NULL == task->timeout.ptr_to_position );
+
+    if ( XI_STATE_OK != state )
+    {
+        goto err_handling;
+    }
+
+    if ( msg_memory->common.common_u.common_bits.type != XI_MQTT_TYPE_UNSUBACK )
+    {
+        xi_debug_format( "[m.id[%d]]unsubscribe error was expecting unsuback got %d!",
+                         task->msg_id, msg_memory->common.common_u.common_bits.type );
+
+        state = XI_MQTT_LOGIC_WRONG_MESSAGE_RECEIVED;
+        goto err_handling;
+    }
+
+    xi_debug_format( "[m.id[%d]]unsubscribe unsuback received", task->msg_id );
+
+    /* the unsuback carries no per topic result, the whole batch is acknowledged */
+    for ( entry = task->data.data_u; NULL != entry; entry = entry->unsubscribe.next )
+    {
+        xi_mqtt_logic_unregister_topic( layer_data, entry->unsubscribe.topic );
+    }
+
+    xi_mqtt_logic_task_defer_users_callback( context, task, state );
+
+    xi_mqtt_message_free( &msg_memory );
+
+    xi_mqtt_logic_free_task_data( task );
+
+    XI_CR_EXIT( task->cs, xi_mqtt_logic_layer_finalize_task( context, task ) );
+
+    XI_CR_END();
+
+err_handling:
+    xi_mqtt_logic_task_defer_users_callback( context, task, state );
+
+    xi_mqtt_message_free( &msg_memory );
+
+    if ( task->data.data_u )
+    {
+        xi_mqtt_logic_free_task_data( task );
+    }
+
+    XI_CR_RESET( task->cs );
+
+    xi_mqtt_logic_layer_finalize_task( context, task );
+
+    return state;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __XI_MQTT_LOGIC_LAYER_UNSUBSCRIBE_COMMAND_H__ */
@@ -64,6 +64,11 @@ xi_workerthread_t* xi_workerthread_create_instance( xi_evtd_instance_t* evtd_sec
         new_workerthread_instance->thread_evtd == NULL, XI_OUT_OF_MEMORY, state,
         "could not create event dispatcher for new xi_workerthread instance" );
 
+    /* a worker thread serves no sockets, each of its steps has to run all the queued
+     * handles, including the last one which runs those added right before the stop */
+    new_workerthread_instance->thread_evtd->step_budget        = 0;
+    new_workerthread_instance->thread_evtd->step_time_slice_ms = 0;
+
     new_workerthread_instance->thread_evtd_secondary = evtd_secondary;
 
     const int ret_pthread_create =
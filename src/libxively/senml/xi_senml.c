@@ -11,6 +11,7 @@
 #include "xi_debug.h"
 #include "xi_allocator.h"
 #include "xi_helpers.h"
+#include "xi_senml_cbor_serializer.h"
 #include "xi_senml_json_serializer.h"
 #include <stdarg.h>
 #include <xi_list.h>
@@ -19,9 +20,43 @@
 extern "C" {
 #endif
 
+/* implemented in xively.c, takes the ownership of data */
+extern xi_state_t xi_publish_data_impl( xi_context_handle_t xih,
+                                        const char* topic,
+                                        xi_data_desc_t* data,
+                                        const xi_mqtt_qos_t qos,
+                                        const xi_mqtt_retain_t retain,
+                                        const xi_publish_priority_t priority,
+                                        xi_user_callback_t* callback,
+                                        void* user_data );
+
+static xi_state_t xi_senml_serialize_to_desc( xi_senml_t* senml_structure,
+                                              xi_senml_format_t format,
+                                              xi_data_desc_t** out_buffer )
+{
+    switch ( format )
+    {
+        case XI_SENML_FORMAT_JSON:
+            return xi_senml_json_serialize( out_buffer, senml_structure );
+        case XI_SENML_FORMAT_CBOR:
+            return xi_senml_cbor_serialize( out_buffer, senml_structure );
+        default:
+            return XI_INVALID_PARAMETER;
+    }
+}
+
 xi_state_t xi_senml_serialize( xi_senml_t* senml_structure,
                                uint8_t** out_buffer,
                                uint32_t* out_size )
+{
+    return xi_senml_serialize_as( senml_structure, XI_SENML_FORMAT_JSON, out_buffer,
+                                  out_size );
+}
+
+xi_state_t xi_senml_serialize_as( xi_senml_t* senml_structure,
+                                  xi_senml_format_t format,
+                                  uint8_t** out_buffer,
+                                  uint32_t* out_size )
 {
     if ( NULL == out_buffer || NULL == out_size )
     {
@@ -30,7 +65,7 @@ xi_state_t xi_senml_serialize( xi_senml_t* senml_structure,
 
     xi_data_desc_t* buffer = NULL;
 
-    xi_state_t state = xi_senml_json_serialize( &buffer, senml_structure );
+    xi_state_t state = xi_senml_serialize_to_desc( senml_structure, format, &buffer );
 
     XI_CHECK_STATE( state );
     XI_CHECK_CND( buffer == NULL, XI_SERIALIZATION_ERROR, state );
@@ -53,6 +88,36 @@ err_handling:
     return state;
 }
 
+xi_state_t xi_publish_senml( xi_context_handle_t xih,
+                             const char* topic,
+                             xi_senml_t* senml_structure,
+                             xi_senml_format_t format,
+                             const xi_mqtt_qos_t qos,
+                             const xi_mqtt_retain_t retain,
+                             xi_user_callback_t* callback,
+                             void* user_data )
+{
+    /* PRE-CONDITIONS */
+    assert( NULL != topic );
+
+    xi_data_desc_t* buffer = NULL;
+
+    xi_state_t state = xi_senml_serialize_to_desc( senml_structure, format, &buffer );
+
+    XI_CHECK_STATE( state );
+    XI_CHECK_CND( buffer == NULL, XI_SERIALIZATION_ERROR, state );
+
+    /* the document goes to the publish as it is, no copy */
+    return xi_publish_data_impl( xih, topic, buffer, qos, retain,
+                                 XI_PUBLISH_PRIORITY_NORMAL, callback, user_data );
+
+err_handling:
+
+    xi_free_desc( &buffer );
+
+    return state;
+}
+
 xi_state_t xi_senml_free_buffer( uint8_t** buffer )
 {
     if ( NULL == buffer )
@@ -0,0 +1,432 @@
+/* Copyright (c) 2003-2018, Xively All rights reserved.
+ *
+ * This is part of the Xively C Client library,
+ * it is licensed under the BSD 3-Clause license.
+ */
+
+#include "xi_debug.h"
+#include "xi_macros.h"
+
+#include "xi_senml_cbor_serializer.h"
+
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * SenML CBOR emitter, run once without a buffer to calculate the exact size and once
+ * more to write the bytes, the same way the JSON serializer works.
+ */
+
+#define XI_SENML_CBOR_MAJOR_UINT 0
+#define XI_SENML_CBOR_MAJOR_NEGINT 1
+#define XI_SENML_CBOR_MAJOR_TEXT 3
+#define XI_SENML_CBOR_MAJOR_ARRAY 4
+#define XI_SENML_CBOR_MAJOR_MAP 5
+#define XI_SENML_CBOR_MAJOR_SIMPLE 7
+
+#define XI_SENML_CBOR_SIMPLE_FALSE 20
+#define XI_SENML_CBOR_SIMPLE_TRUE 21
+#define XI_SENML_CBOR_HALF_FLOAT 25
+#define XI_SENML_CBOR_SINGLE_FLOAT 26
+#define XI_SENML_CBOR_INDEFINITE_LENGTH 31
+
+/* RFC 8428 labels */
+#define XI_SENML_CBOR_LABEL_BASE_NAME -2
+#define XI_SENML_CBOR_LABEL_BASE_TIME -3
+#define XI_SENML_CBOR_LABEL_BASE_UNIT -4
+#define XI_SENML_CBOR_LABEL_NAME 0
+#define XI_SENML_CBOR_LABEL_UNIT 1
+#define XI_SENML_CBOR_LABEL_VALUE 2
+#define XI_SENML_CBOR_LABEL_STRING_VALUE 3
+#define XI_SENML_CBOR_LABEL_BOOLEAN_VALUE 4
+#define XI_SENML_CBOR_LABEL_TIME 6
+#define XI_SENML_CBOR_LABEL_UPDATE_TIME 7
+
+typedef struct xi_senml_cbor_writer_s
+{
+    uint8_t* buffer; /* NULL while sizing */
+    uint32_t pos;
+    xi_state_t state; /* first error of the emitters */
+} xi_senml_cbor_writer_t;
+
+static void
+xi_senml_cbor_put( xi_senml_cbor_writer_t* writer, const void* data, uint32_t len )
+{
+    if ( NULL != writer->buffer )
+    {
+        memcpy( writer->buffer + writer->pos, data, len );
+    }
+
+    writer->pos += len;
+}
+
+/* head with the shortest big endian argument, additional_info selects the float width
+ * of the simple major type */
+static void xi_senml_cbor_put_head_with_argument_len( xi_senml_cbor_writer_t* writer,
+                                                      uint8_t major,
+                                                      uint8_t additional_info,
+                                                      uint32_t argument,
+                                                      uint8_t argument_len )
+{
+    uint8_t head[5];
+    uint8_t i = 0;
+
+    head[0] = ( uint8_t )( major << 5 | additional_info );
+
+    for ( ; i < argument_len; ++i )
+    {
+        head[argument_len - i] = ( uint8_t )( argument >> ( 8 * i ) );
+    }
+
+    xi_senml_cbor_put( writer, head, 1 + argument_len );
+}
+
+static void
+xi_senml_cbor_put_head( xi_senml_cbor_writer_t* writer, uint8_t major, uint32_t value )
+{
+    if ( value < 24 )
+    {
+        xi_senml_cbor_put_head_with_argument_len( writer, major, ( uint8_t )value, 0, 0 );
+    }
+    else if ( value <= 0xff )
+    {
+        xi_senml_cbor_put_head_with_argument_len( writer, major, 24, value, 1 );
+    }
+    else if ( value <= 0xffff )
+    {
+        xi_senml_cbor_put_head_with_argument_len( writer, major, 25, value, 2 );
+    }
+    else
+    {
+        xi_senml_cbor_put_head_with_argument_len( writer, major, 26, value, 4 );
+    }
+}
+
+static void xi_senml_cbor_put_int( xi_senml_cbor_writer_t* writer, int32_t value )
+{
+    if ( value < 0 )
+    {
+        xi_senml_cbor_put_head( writer, XI_SENML_CBOR_MAJOR_NEGINT,
+                                ( uint32_t )( -1 - value ) );
+    }
+    else
+    {
+        xi_senml_cbor_put_head( writer, XI_SENML_CBOR_MAJOR_UINT, ( uint32_t )value );
+    }
+}
+
+static void xi_senml_cbor_put_text( xi_senml_cbor_writer_t* writer, const char* text )
+{
+    const uint32_t text_len = strlen( text );
+
+    xi_senml_cbor_put_head( writer, XI_SENML_CBOR_MAJOR_TEXT, text_len );
+    xi_senml_cbor_put( writer, text, text_len );
+}
+
+static void xi_senml_cbor_put_boolean( xi_senml_cbor_writer_t* writer, uint8_t boolean )
+{
+    xi_senml_cbor_put_head( writer, XI_SENML_CBOR_MAJOR_SIMPLE,
+                            ( boolean > 0 ) ? XI_SENML_CBOR_SIMPLE_TRUE
+                                            : XI_SENML_CBOR_SIMPLE_FALSE );
+}
+
+/* @return 1 if the float is exactly representable as a half precision float */
+static uint8_t xi_senml_cbor_half_from_float_bits( uint32_t bits, uint16_t* half )
+{
+    const uint16_t sign     = ( uint16_t )( ( bits >> 16 ) & 0x8000 );
+    const int exponent      = ( int )( ( bits >> 23 ) & 0xff ) - 127;
+    const uint32_t mantissa = bits & 0x7fffff;
+
+    if ( -14 <= exponent && exponent <= 15 )
+    {
+        /* normal half, the 13 lowest mantissa bits are lost */
+        if ( 0 != ( mantissa & 0x1fff ) )
+        {
+            return 0;
+        }
+
+        *half = ( uint16_t )( sign | ( exponent + 15 ) << 10 | mantissa >> 13 );
+        return 1;
+    }
+
+    if ( -24 <= exponent && exponent < -14 )
+    {
+        /* subnormal half, the implicit leading bit becomes explicit */
+        const uint32_t significand = mantissa | 0x800000;
+        const int shift            = 13 + ( -14 - exponent );
+
+        if ( 0 != ( significand & ( ( 1u << shift ) - 1 ) ) )
+        {
+            return 0;
+        }
+
+        *half = ( uint16_t )( sign | significand >> shift );
+        return 1;
+    }
+
+    return 0;
+}
+
+static void xi_senml_cbor_put_float( xi_senml_cbor_writer_t* writer, float value )
+{
+    uint32_t bits = 0;
+    uint16_t half = 0;
+
+    memcpy( &bits, &value, sizeof( bits ) );
+
+    /* infinity and NaN are not numbers a sensor can report */
+    if ( 0x7f800000 <= ( bits & 0x7fffffff ) )
+    {
+        writer->state = XI_SERIALIZATION_ERROR;
+        return;
+    }
+
+    if ( -2147483648.0f <= value && value < 2147483648.0f &&
+         value == ( float )( int32_t )value )
+    {
+        xi_senml_cbor_put_int( writer, ( int32_t )value );
+    }
+    else if ( xi_senml_cbor_half_from_float_bits( bits, &half ) )
+    {
+        xi_senml_cbor_put_head_with_argument_len( writer, XI_SENML_CBOR_MAJOR_SIMPLE,
+                                                  XI_SENML_CBOR_HALF_FLOAT, half, 2 );
+    }
+    else
+    {
+        xi_senml_cbor_put_head_with_argument_len( writer, XI_SENML_CBOR_MAJOR_SIMPLE,
+                                                  XI_SENML_CBOR_SINGLE_FLOAT, bits, 4 );
+    }
+}
+
+static void xi_senml_cbor_put_base_fields( xi_senml_cbor_writer_t* writer,
+                                           const xi_senml_t* senml_structure )
+{
+    if ( senml_structure->set.base_name_set == 1 )
+    {
+        xi_senml_cbor_put_int( writer, XI_SENML_CBOR_LABEL_BASE_NAME );
+        xi_senml_cbor_put_text( writer, senml_structure->base_name );
+    }
+
+    if ( senml_structure->set.base_time_set == 1 )
+    {
+        xi_senml_cbor_put_int( writer, XI_SENML_CBOR_LABEL_BASE_TIME );
+        xi_senml_cbor_put_int( writer, senml_structure->base_time );
+    }
+
+    if ( senml_structure->set.base_units_set == 1 )
+    {
+        xi_senml_cbor_put_int( writer, XI_SENML_CBOR_LABEL_BASE_UNIT );
+        xi_senml_cbor_put_text( writer, senml_structure->base_units );
+    }
+}
+
+static uint32_t xi_senml_cbor_base_fields_count( const xi_senml_t* senml_structure )
+{
+    return senml_structure->set.base_name_set + senml_structure->set.base_time_set +
+           senml_structure->set.base_units_set;
+}
+
+static void xi_senml_cbor_put_entry( xi_senml_cbor_writer_t* writer,
+                                     const xi_senml_entry_t* entry,
+                                     const xi_senml_t* base_fields_of )
+{
+    if ( entry->set.value_set != 1 )
+    {
+        writer->state = XI_INVALID_PARAMETER;
+        return;
+    }
+
+    const uint32_t fields_count =
+        ( ( NULL != base_fields_of ) ? xi_senml_cbor_base_fields_count( base_fields_of )
+                                     : 0 ) +
+        entry->set.name_set + entry->set.units_set + entry->set.value_set +
+        entry->set.time_set + entry->set.update_time_set;
+
+    xi_senml_cbor_put_head( writer, XI_SENML_CBOR_MAJOR_MAP, fields_count );
+
+    if ( NULL != base_fields_of )
+    {
+        xi_senml_cbor_put_base_fields( writer, base_fields_of );
+    }
+
+    if ( entry->set.name_set == 1 )
+    {
+        xi_senml_cbor_put_int( writer, XI_SENML_CBOR_LABEL_NAME );
+        xi_senml_cbor_put_text( writer, entry->name );
+    }
+
+    if ( entry->set.units_set == 1 )
+    {
+        xi_senml_cbor_put_int( writer, XI_SENML_CBOR_LABEL_UNIT );
+        xi_senml_cbor_put_text( writer, entry->units );
+    }
+
+    switch ( entry->value_cnt.value_type )
+    {
+        case XI_SENML_VALUE_TYPE_FLOAT:
+            xi_senml_cbor_put_int( writer, XI_SENML_CBOR_LABEL_VALUE );
+            xi_senml_cbor_put_float( writer, entry->value_cnt.value.float_value );
+            break;
+        case XI_SENML_VALUE_TYPE_STRING:
+            xi_senml_cbor_put_int( writer, XI_SENML_CBOR_LABEL_STRING_VALUE );
+            xi_senml_cbor_put_text( writer, entry->value_cnt.value.string_value );
+            break;
+        case XI_SENML_VALUE_TYPE_BOOLEAN:
+            xi_senml_cbor_put_int( writer, XI_SENML_CBOR_LABEL_BOOLEAN_VALUE );
+            xi_senml_cbor_put_boolean( writer, entry->value_cnt.value.boolean_value );
+            break;
+        default:
+            writer->state = XI_INVALID_PARAMETER;
+            return;
+    }
+
+    if ( entry->set.time_set == 1 )
+    {
+        xi_senml_cbor_put_int( writer, XI_SENML_CBOR_LABEL_TIME );
+        xi_senml_cbor_put_int( writer, entry->time );
+    }
+
+    if ( entry->set.update_time_set == 1 )
+    {
+        xi_senml_cbor_put_int( writer, XI_SENML_CBOR_LABEL_UPDATE_TIME );
+        xi_senml_cbor_put_int( writer, entry->update_time );
+    }
+}
+
+/* a document without entries still carries its base fields in a record of their own */
+static void xi_senml_cbor_put_base_record( xi_senml_cbor_writer_t* writer,
+                                           const xi_senml_t* senml_structure )
+{
+    const uint32_t base_fields_count = xi_senml_cbor_base_fields_count( senml_structure );
+
+    if ( 0 < base_fields_count )
+    {
+        xi_senml_cbor_put_head( writer, XI_SENML_CBOR_MAJOR_MAP, base_fields_count );
+        xi_senml_cbor_put_base_fields( writer, senml_structure );
+    }
+}
+
+static void xi_senml_cbor_put_document( xi_senml_cbor_writer_t* writer,
+                                        const xi_senml_t* senml_structure )
+{
+    const xi_senml_entry_t* entry = senml_structure->entries_list;
+    uint32_t entries_count        = 0;
+
+    for ( ; NULL != entry; entry = entry->__next )
+    {
+        ++entries_count;
+    }
+
+    if ( 0 == entries_count )
+    {
+        xi_senml_cbor_put_head(
+            writer, XI_SENML_CBOR_MAJOR_ARRAY,
+            ( 0 < xi_senml_cbor_base_fields_count( senml_structure ) ) ? 1 : 0 );
+        xi_senml_cbor_put_base_record( writer, senml_structure );
+
+        return;
+    }
+
+    xi_senml_cbor_put_head( writer, XI_SENML_CBOR_MAJOR_ARRAY, entries_count );
+
+    for ( entry = senml_structure->entries_list;
+          NULL != entry && XI_STATE_OK == writer->state; entry = entry->__next )
+    {
+        xi_senml_cbor_put_entry(
+            writer, entry,
+            ( entry == senml_structure->entries_list ) ? senml_structure : NULL );
+    }
+}
+
+/*-----------------------------------------------------------------------
+ * WRITING TO A FIXED BUFFER
+ * ----------------------------------------------------------------------- */
+
+/* the number of records is not known upfront, the array is of indefinite length */
+xi_state_t xi_senml_cbor_write_document_open( uint8_t* buffer,
+                                              uint32_t* len,
+                                              const xi_senml_t* base )
+{
+    xi_senml_cbor_writer_t writer = {buffer, 0, XI_STATE_OK};
+
+    XI_UNUSED( base );
+
+    xi_senml_cbor_put_head_with_argument_len( &writer, XI_SENML_CBOR_MAJOR_ARRAY,
+                                              XI_SENML_CBOR_INDEFINITE_LENGTH, 0, 0 );
+
+    *len = writer.pos;
+    return writer.state;
+}
+
+xi_state_t xi_senml_cbor_write_entry( uint8_t* buffer,
+                                      uint32_t* len,
+                                      const xi_senml_t* base,
+                                      const xi_senml_entry_t* entry,
+                                      uint32_t entry_count )
+{
+    xi_senml_cbor_writer_t writer = {buffer, 0, XI_STATE_OK};
+
+    xi_senml_cbor_put_entry( &writer, entry, ( 0 == entry_count ) ? base : NULL );
+
+    *len = writer.pos;
+    return writer.state;
+}
+
+xi_state_t xi_senml_cbor_write_document_close( uint8_t* buffer,
+                                               uint32_t* len,
+                                               const xi_senml_t* base,
+                                               uint32_t entries_count )
+{
+    xi_senml_cbor_writer_t writer = {buffer, 0, XI_STATE_OK};
+
+    if ( 0 == entries_count )
+    {
+        xi_senml_cbor_put_base_record( &writer, base );
+    }
+
+    /* break */
+    xi_senml_cbor_put_head_with_argument_len( &writer, XI_SENML_CBOR_MAJOR_SIMPLE,
+                                              XI_SENML_CBOR_INDEFINITE_LENGTH, 0, 0 );
+
+    *len = writer.pos;
+    return writer.state;
+}
+
+xi_state_t
+xi_senml_cbor_serialize( xi_data_desc_t** out_buffer, xi_senml_t* senml_structure )
+{
+    xi_state_t ret_state          = XI_STATE_OK;
+    xi_senml_cbor_writer_t writer = {NULL, 0, XI_STATE_OK};
+
+    if ( out_buffer == 0 || senml_structure == 0 )
+    {
+        return XI_INVALID_PARAMETER;
+    }
+
+    *out_buffer = NULL;
+
+    /* sizing run */
+    xi_senml_cbor_put_document( &writer, senml_structure );
+
+    XI_CHECK_STATE( ret_state = writer.state );
+
+    xi_data_desc_t* dst = *out_buffer = xi_make_empty_desc_alloc( writer.pos );
+    XI_CHECK_MEMORY( dst, ret_state );
+
+    /* writing run */
+    writer.buffer = dst->data_ptr;
+    writer.pos    = 0;
+    xi_senml_cbor_put_document( &writer, senml_structure );
+
+    dst->length = writer.pos;
+
+err_handling:
+    return ret_state;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,51 @@
+/* Copyright (c) 2003-2018, Xively All rights reserved.
+ *
+ * This is part of the Xively C Client library,
+ * it is licensed under the BSD 3-Clause license.
+ */
+
+#ifndef __XI_SENML_CBOR_SERIALIZER_H__
+#define __XI_SENML_CBOR_SERIALIZER_H__
+
+#include "xi_data_desc.h"
+#include "xively_senml_types.h"
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief xi_senml_cbor_serialize encodes a senml structure as SenML CBOR (RFC 8428)
+ *
+ * The output is an array of records with integer labels, the base fields go into the
+ * first record. Float values take the shortest of integer, half and single precision
+ * encoding which keeps them exact. The size is calculated upfront so *out_buffer is
+ * allocated once with the exact size.
+ */
+extern xi_state_t
+xi_senml_cbor_serialize( xi_data_desc_t** out_buffer, xi_senml_t* senml_structure );
+
+/* streaming writer support: the document is written piece by piece into a fixed
+ * buffer, with buffer NULL only the length is returned in *len */
+extern xi_state_t xi_senml_cbor_write_document_open( uint8_t* buffer,
+                                                     uint32_t* len,
+                                                     const xi_senml_t* base );
+
+extern xi_state_t xi_senml_cbor_write_entry( uint8_t* buffer,
+                                             uint32_t* len,
+                                             const xi_senml_t* base,
+                                             const xi_senml_entry_t* entry,
+                                             uint32_t entry_count );
+
+extern xi_state_t xi_senml_cbor_write_document_close( uint8_t* buffer,
+                                                      uint32_t* len,
+                                                      const xi_senml_t* base,
+                                                      uint32_t entries_count );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __XI_SENML_CBOR_SERIALIZER_H__ */
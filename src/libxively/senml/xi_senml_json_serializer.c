@@ -9,10 +9,20 @@
 
 #include "xi_senml_json_serializer.h"
 
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/*
+ * Every piece of the document is produced by an emitter which is run twice: first
+ * without a buffer to calculate the exact length, then to write the bytes into a
+ * buffer of that length. A whole document is therefore allocated once.
+ */
+
 /* static buffers used to generate senml content */
 static const char xi_senml_pat_open[]                  = "{\"e\":[";
 static const char xi_senml_pat_entries_close[]         = "]";
@@ -35,149 +45,744 @@ static const char xi_senml_pat_entry_time[]            = "\"t\":";
 static const char xi_senml_pat_entry_update_time[]     = "\"ut\":";
 static const char xi_senml_pat_entry_close[]           = "}";
 
-xi_state_t xi_senml_json_serialize_init( xi_data_desc_t* out )
+#define XI_SENML_PAT_LEN( pat ) ( sizeof( pat ) - 1 )
+
+/* longest float is "-1.23456789e-38" and the longest int is "-2147483648" */
+#define XI_SENML_JSON_NUMBER_MAX_LEN 16
+
+/* the float digits are searched in double arithmetic within the range of exact powers
+ * of ten, the shortest of 9 significant digits always survives a float round trip */
+#define XI_SENML_JSON_POW10_MAX 22
+#define XI_SENML_JSON_FLOAT_MAX_DIGITS 9
+#define XI_SENML_JSON_DOUBLE_EXACT_INT_LIMIT 9007199254740992.0
+
+static const double xi_senml_json_pow10[XI_SENML_JSON_POW10_MAX + 1] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+typedef struct xi_senml_json_writer_s
 {
-    assert( out != 0 );
+    char* buffer; /* NULL while sizing */
+    uint32_t pos;
+    xi_state_t state; /* first error of the emitters */
+} xi_senml_json_writer_t;
 
-    return xi_data_desc_append_data_resize( out, xi_senml_pat_open,
-                                            sizeof( xi_senml_pat_open ) - 1 );
+/*-----------------------------------------------------------------------
+ * NUMBER FORMATTING
+ * ----------------------------------------------------------------------- */
+
+/* exact for every uint32_t, size optimized builds would emit a division instead */
+static uint32_t xi_senml_json_div10( uint32_t value )
+{
+    return ( uint32_t )( ( ( uint64_t )value * 0xCCCCCCCDu ) >> 35 );
 }
 
-xi_state_t xi_senml_json_serialize_key( xi_data_desc_t* out,
-                                        const char* const key,
-                                        uint16_t elem_count )
+static uint8_t xi_senml_json_format_uint( char* out, uint32_t value )
 {
-    assert( out != 0 );
-    assert( key != 0 );
+    char digits[10];
+    uint8_t len = 0;
+    uint8_t i   = 0;
 
-    xi_state_t ret_state = XI_STATE_OK;
+    do
+    {
+        const uint32_t quotient = xi_senml_json_div10( value );
 
-    if ( elem_count > 0 )
+        digits[len++] = ( char )( '0' + value - quotient * 10 );
+        value         = quotient;
+    } while ( 0 != value );
+
+    for ( ; i < len; ++i )
     {
-        XI_CHECK_STATE( ret_state = xi_data_desc_append_data_resize(
-                            out, xi_senml_pat_coln, sizeof( xi_senml_pat_coln ) - 1 ) );
+        out[i] = digits[len - 1 - i];
     }
 
-    XI_CHECK_STATE( ret_state =
-                        xi_data_desc_append_data_resize( out, key, strlen( key ) ) );
+    return len;
+}
 
-err_handling:
-    return ret_state;
+static uint8_t xi_senml_json_format_int( char* out, int32_t value )
+{
+    if ( value < 0 )
+    {
+        out[0] = '-';
+        return 1 + xi_senml_json_format_uint( out + 1, 0 - ( uint32_t )value );
+    }
+
+    return xi_senml_json_format_uint( out, ( uint32_t )value );
 }
 
-xi_state_t xi_senml_json_serialize_string( xi_data_desc_t* out, const char* const string )
+/*
+ * Writes digits * 10^exponent the way %g would with the precision of a float. With out
+ * set to NULL only the length is calculated, this is what the sizing run asks for.
+ */
+static uint8_t
+xi_senml_json_format_decimal( char* out, uint8_t negative, uint32_t digits, int exponent )
 {
-    assert( out != 0 );
-    assert( string != 0 );
+    char digit_chars[10];
+    uint8_t digit_count = 1;
+    uint8_t len         = negative;
+    int i               = 0;
+
+    while ( 0 != digits && digits == xi_senml_json_div10( digits ) * 10 )
+    {
+        digits = xi_senml_json_div10( digits );
+        ++exponent;
+    }
+
+    while ( digit_count < 10 && xi_senml_json_pow10[digit_count] <= digits )
+    {
+        ++digit_count;
+    }
+
+    /* exponent of the leading digit */
+    const int leading_exponent = exponent + digit_count - 1;
+    const uint8_t scientific   = ( leading_exponent < -4 ||
+                                 XI_SENML_JSON_FLOAT_MAX_DIGITS <= leading_exponent );
+
+    if ( NULL == out )
+    {
+        if ( scientific )
+        {
+            /* d[.ddd]e+XX */
+            return len + digit_count + ( ( 1 < digit_count ) ? 1 : 0 ) + 4;
+        }
+        else if ( 0 <= exponent )
+        {
+            return len + digit_count + exponent;
+        }
+        else if ( 0 <= leading_exponent )
+        {
+            return len + digit_count + 1;
+        }
 
-    xi_state_t ret_state = XI_STATE_OK;
+        /* 0.000ddd */
+        return len + 1 - leading_exponent + digit_count;
+    }
 
-    XI_CHECK_STATE( ret_state = xi_data_desc_append_data_resize(
-                        out, xi_senml_pat_quot, sizeof( xi_senml_pat_quot ) - 1 ) );
+    xi_senml_json_format_uint( digit_chars, digits );
 
-    XI_CHECK_STATE(
-        ret_state = xi_data_desc_append_data_resize( out, string, strlen( string ) ) );
+    if ( negative )
+    {
+        out[0] = '-';
+    }
 
-    XI_CHECK_STATE( ret_state = xi_data_desc_append_data_resize(
-                        out, xi_senml_pat_quot, sizeof( xi_senml_pat_quot ) - 1 ) );
+    if ( scientific )
+    {
+        out[len++] = digit_chars[0];
 
-err_handling:
-    return ret_state;
+        if ( 1 < digit_count )
+        {
+            out[len++] = '.';
+
+            for ( i = 1; i < digit_count; ++i )
+            {
+                out[len++] = digit_chars[i];
+            }
+        }
+
+        const int abs_exponent =
+            ( leading_exponent < 0 ) ? -leading_exponent : leading_exponent;
+
+        out[len++] = 'e';
+        out[len++] = ( leading_exponent < 0 ) ? '-' : '+';
+        out[len++] = ( char )( '0' + abs_exponent / 10 );
+        out[len++] = ( char )( '0' + abs_exponent % 10 );
+
+        return len;
+    }
+
+    /* plain notation, one position of the decimal at a time */
+    for ( i = XI_MAX( leading_exponent, 0 ); i >= XI_MIN( exponent, 0 ); --i )
+    {
+        out[len++] =
+            ( i <= leading_exponent && exponent <= i ) ? digit_chars[leading_exponent - i]
+                                                       : '0';
+
+        if ( 0 == i && exponent < 0 )
+        {
+            out[len++] = '.';
+        }
+    }
+
+    return len;
 }
 
-xi_state_t xi_senml_json_serialize_float( xi_data_desc_t* out, const float value )
+/* rare path for the magnitudes out of the exact powers of ten */
+static uint8_t xi_senml_json_format_float_slow( char* out, float value )
 {
-    assert( out != 0 );
-
     char buf[32] = {'\0'};
+    int ret      = 0;
+    int i        = 1;
 
-    int ret = snprintf( buf, sizeof( buf ), "%.5g", value );
+    for ( ; i <= XI_SENML_JSON_FLOAT_MAX_DIGITS; ++i )
+    {
+        ret = snprintf( buf, sizeof( buf ), "%.*g", i, value );
 
-    if ( ret <= 0 )
+        if ( strtof( buf, NULL ) == value )
+        {
+            break;
+        }
+    }
+
+    if ( ret <= 0 || XI_SENML_JSON_NUMBER_MAX_LEN < ret )
     {
-        return XI_SERIALIZATION_ERROR;
+        return 0;
     }
 
-#if 0 /* @TODO to further discussion */
-    if( ret <= sizeof( buf ) )
+    if ( NULL != out )
     {
-        return XI_TRUNCATION_WARNING;
+        memcpy( out, buf, ret );
     }
-#endif
 
-    return xi_data_desc_append_data_resize( out, buf, ret );
+    return ( uint8_t )ret;
 }
 
-xi_state_t xi_senml_json_serialize_int( xi_data_desc_t* out, const uint32_t value )
+static float xi_senml_json_float_from_bits( uint32_t bits )
 {
-    assert( out != 0 );
+    float value = 0;
+    memcpy( &value, &bits, sizeof( value ) );
 
-    char buf[32] = {'\0'};
+    return value;
+}
+
+/* @return the digits of abs_value rounded to the scale or 0 if they don't read back */
+static uint32_t xi_senml_json_float_digits( double abs_value,
+                                           double low,
+                                           double high,
+                                           uint8_t even_significand,
+                                           int scale_exponent )
+{
+    const double scale =
+        xi_senml_json_pow10[( scale_exponent < 0 ) ? -scale_exponent : scale_exponent];
 
-    int ret = snprintf( buf, sizeof( buf ), "%d", value );
+    const double scaled =
+        ( scale_exponent < 0 ) ? abs_value * scale : abs_value / scale;
+    const uint32_t digits = ( uint32_t )( scaled + 0.5 );
 
-    if ( ret <= 0 )
+    const double candidate = ( scale_exponent < 0 ) ? digits / scale : digits * scale;
+
+    if ( low < candidate && candidate < high )
     {
-        return XI_SERIALIZATION_ERROR;
+        return digits;
     }
 
-#if 0 /* @TODO to further discussion */
-    if( ret <= sizeof( buf ) )
+    /* a whole number below 2^53 is exact, landing on a midpoint it reads back as the
+     * neighbour with the even significand */
+    if ( ( low == candidate || candidate == high ) && even_significand &&
+         0 <= scale_exponent && candidate < XI_SENML_JSON_DOUBLE_EXACT_INT_LIMIT )
     {
-        return XI_TRUNCATION_WARNING;
+        return digits;
     }
-#endif
 
-    return xi_data_desc_append_data_resize( out, buf, ret );
+    return 0;
 }
 
-xi_state_t xi_senml_json_serialize_boolean( xi_data_desc_t* out, const uint8_t boolean )
+/*
+ * Formats the shortest decimal that reads back as the very same float. The number of
+ * significant digits grows until the decimal falls strictly between the midpoints to
+ * the neighbouring floats. The candidate is calculated with a single rounding in
+ * double which cannot move it across a midpoint, since the midpoints are exact in
+ * double, so a candidate found strictly inside is a correct one. A candidate right on
+ * a midpoint is only taken if it is known to be exact.
+ *
+ * @return number of characters written, or just calculated if out is NULL, 0 for
+ *         infinity and NaN which JSON can't hold
+ */
+static uint8_t xi_senml_json_format_float( char* out, float value )
 {
-    assert( out != 0 );
+    uint32_t bits = 0;
+    memcpy( &bits, &value, sizeof( bits ) );
+
+    const uint8_t negative   = ( uint8_t )( bits >> 31 );
+    const uint32_t magnitude = bits & 0x7fffffff;
+
+    if ( 0x7f800000 <= magnitude )
+    {
+        return 0;
+    }
+
+    if ( 0 == magnitude )
+    {
+        return xi_senml_json_format_decimal( out, negative, 0, 0 );
+    }
+
+    const double abs_value = xi_senml_json_float_from_bits( magnitude );
+
+    /* decimal exponent of the leading digit */
+    int exponent10 = 0;
+
+    if ( 1.0 <= abs_value )
+    {
+        while ( exponent10 < XI_SENML_JSON_POW10_MAX &&
+                xi_senml_json_pow10[exponent10 + 1] <= abs_value )
+        {
+            ++exponent10;
+        }
+
+        if ( XI_SENML_JSON_POW10_MAX == exponent10 )
+        {
+            return xi_senml_json_format_float_slow( out, value );
+        }
+    }
+    else
+    {
+        do
+        {
+            --exponent10;
+        } while ( -exponent10 <= XI_SENML_JSON_POW10_MAX &&
+                  abs_value * xi_senml_json_pow10[-exponent10] < 1.0 );
 
+        /* the last candidate scales by 10^(exponent10 - 9 + 1) */
+        if ( exponent10 - XI_SENML_JSON_FLOAT_MAX_DIGITS + 1 < -XI_SENML_JSON_POW10_MAX )
+        {
+            return xi_senml_json_format_float_slow( out, value );
+        }
+    }
+
+    /* the values reading back as this float lie between these midpoints */
+    const double low =
+        ( abs_value + xi_senml_json_float_from_bits( magnitude - 1 ) ) / 2;
+    const double high =
+        ( abs_value + xi_senml_json_float_from_bits( magnitude + 1 ) ) / 2;
+
+    /* a decimal that fits implies a fitting one with more digits, the shortest one is
+     * searched by bisection */
+    int min_digit_count      = 1;
+    int max_digit_count      = XI_SENML_JSON_FLOAT_MAX_DIGITS;
+    int shortest_exponent    = 0;
+    uint32_t shortest_digits = 0;
+
+    while ( min_digit_count <= max_digit_count )
+    {
+        const int digit_count    = ( min_digit_count + max_digit_count ) / 2;
+        const int scale_exponent = exponent10 - digit_count + 1;
+
+        const uint32_t digits = xi_senml_json_float_digits(
+            abs_value, low, high, 0 == ( magnitude & 1 ), scale_exponent );
+
+        if ( 0 != digits )
+        {
+            shortest_digits   = digits;
+            shortest_exponent = scale_exponent;
+            max_digit_count   = digit_count - 1;
+        }
+        else
+        {
+            min_digit_count = digit_count + 1;
+        }
+    }
+
+    if ( 0 != shortest_digits )
+    {
+        return xi_senml_json_format_decimal( out, negative, shortest_digits,
+                                             shortest_exponent );
+    }
+
+    return xi_senml_json_format_float_slow( out, value );
+}
+
+/*-----------------------------------------------------------------------
+ * EMITTERS
+ * ----------------------------------------------------------------------- */
+
+static void
+xi_senml_json_put( xi_senml_json_writer_t* writer, const char* data, uint32_t len )
+{
+    if ( NULL != writer->buffer )
+    {
+        memcpy( writer->buffer + writer->pos, data, len );
+    }
+
+    writer->pos += len;
+}
+
+static void xi_senml_json_put_key( xi_senml_json_writer_t* writer,
+                                   const char* key,
+                                   uint32_t key_len,
+                                   uint16_t elem_count )
+{
+    if ( elem_count > 0 )
+    {
+        xi_senml_json_put( writer, xi_senml_pat_coln,
+                           XI_SENML_PAT_LEN( xi_senml_pat_coln ) );
+    }
+
+    xi_senml_json_put( writer, key, key_len );
+}
+
+static void xi_senml_json_put_string( xi_senml_json_writer_t* writer, const char* string )
+{
+    xi_senml_json_put( writer, xi_senml_pat_quot, XI_SENML_PAT_LEN( xi_senml_pat_quot ) );
+    xi_senml_json_put( writer, string, strlen( string ) );
+    xi_senml_json_put( writer, xi_senml_pat_quot, XI_SENML_PAT_LEN( xi_senml_pat_quot ) );
+}
+
+/* numbers are formatted in place */
+static char* xi_senml_json_position( xi_senml_json_writer_t* writer )
+{
+    return ( NULL != writer->buffer ) ? writer->buffer + writer->pos : NULL;
+}
+
+static void xi_senml_json_put_float( xi_senml_json_writer_t* writer, float value )
+{
+    const uint8_t len =
+        xi_senml_json_format_float( xi_senml_json_position( writer ), value );
+
+    if ( 0 == len )
+    {
+        writer->state = XI_SERIALIZATION_ERROR;
+        return;
+    }
+
+    writer->pos += len;
+}
+
+static void xi_senml_json_put_int( xi_senml_json_writer_t* writer, int32_t value )
+{
+    if ( NULL == writer->buffer )
+    {
+        char buf[XI_SENML_JSON_NUMBER_MAX_LEN];
+        writer->pos += xi_senml_json_format_int( buf, value );
+        return;
+    }
+
+    writer->pos += xi_senml_json_format_int( writer->buffer + writer->pos, value );
+}
+
+static void xi_senml_json_put_boolean( xi_senml_json_writer_t* writer, uint8_t boolean )
+{
     if ( boolean > 0 )
     {
-        return xi_data_desc_append_data_resize( out, xi_senml_pat_true,
-                                                sizeof( xi_senml_pat_true ) - 1 );
+        xi_senml_json_put( writer, xi_senml_pat_true,
+                           XI_SENML_PAT_LEN( xi_senml_pat_true ) );
+    }
+    else
+    {
+        xi_senml_json_put( writer, xi_senml_pat_false,
+                           XI_SENML_PAT_LEN( xi_senml_pat_false ) );
     }
+}
 
-    return xi_data_desc_append_data_resize( out, xi_senml_pat_false,
-                                            sizeof( xi_senml_pat_false ) - 1 );
+static void xi_senml_json_put_value_set( xi_senml_json_writer_t* writer,
+                                         const xi_senml_value_t* value_cnt,
+                                         uint16_t elem_count )
+{
+    switch ( value_cnt->value_type )
+    {
+        case XI_SENML_VALUE_TYPE_STRING:
+            xi_senml_json_put_key(
+                writer, xi_senml_pat_entry_string_value,
+                XI_SENML_PAT_LEN( xi_senml_pat_entry_string_value ), elem_count );
+            xi_senml_json_put_string( writer, value_cnt->value.string_value );
+            break;
+        case XI_SENML_VALUE_TYPE_FLOAT:
+            xi_senml_json_put_key( writer, xi_senml_pat_entry_float_value,
+                                   XI_SENML_PAT_LEN( xi_senml_pat_entry_float_value ),
+                                   elem_count );
+            xi_senml_json_put_float( writer, value_cnt->value.float_value );
+            break;
+        case XI_SENML_VALUE_TYPE_BOOLEAN:
+            xi_senml_json_put_key(
+                writer, xi_senml_pat_entry_boolean_value,
+                XI_SENML_PAT_LEN( xi_senml_pat_entry_boolean_value ), elem_count );
+            xi_senml_json_put_boolean( writer, value_cnt->value.boolean_value );
+            break;
+        default:
+            writer->state = XI_INVALID_PARAMETER;
+    }
 }
 
-xi_state_t
-xi_senml_json_serialize_name( xi_data_desc_t* out, const char* name, uint16_t elem_count )
+static void xi_senml_json_put_entry( xi_senml_json_writer_t* writer,
+                                     const xi_senml_entry_t* entry,
+                                     uint32_t entry_count )
 {
-    assert( out != 0 );
-    assert( name != 0 );
+    uint16_t fields_count = 0;
 
-    xi_state_t ret_state = XI_STATE_OK;
+    /* open either with coln or without */
+    if ( entry_count > 0 )
+    {
+        xi_senml_json_put( writer, xi_senml_pat_entry_open_next,
+                           XI_SENML_PAT_LEN( xi_senml_pat_entry_open_next ) );
+    }
+    else
+    {
+        xi_senml_json_put( writer, xi_senml_pat_entry_open_elem_count,
+                           XI_SENML_PAT_LEN( xi_senml_pat_entry_open_elem_count ) );
+    }
 
-    /* elem_count part serialize the key value */
-    XI_CHECK_STATE( ret_state = xi_senml_json_serialize_key( out, xi_senml_pat_entry_name,
-                                                             elem_count ) );
+    if ( entry->set.name_set == 1 )
+    {
+        xi_senml_json_put_key( writer, xi_senml_pat_entry_name,
+                               XI_SENML_PAT_LEN( xi_senml_pat_entry_name ),
+                               fields_count++ );
+        xi_senml_json_put_string( writer, entry->name );
+    }
+
+    if ( entry->set.value_set == 1 )
+    {
+        xi_senml_json_put_value_set( writer, &entry->value_cnt, fields_count++ );
+    }
+    else
+    {
+        writer->state = XI_INVALID_PARAMETER;
+        return;
+    }
+
+    if ( entry->set.time_set == 1 )
+    {
+        xi_senml_json_put_key( writer, xi_senml_pat_entry_time,
+                               XI_SENML_PAT_LEN( xi_senml_pat_entry_time ),
+                               fields_count++ );
+        xi_senml_json_put_int( writer, entry->time );
+    }
+
+    if ( entry->set.units_set == 1 )
+    {
+        xi_senml_json_put_key( writer, xi_senml_pat_entry_units,
+                               XI_SENML_PAT_LEN( xi_senml_pat_entry_units ),
+                               fields_count++ );
+        xi_senml_json_put_string( writer, entry->units );
+    }
+
+    if ( entry->set.update_time_set == 1 )
+    {
+        xi_senml_json_put_key( writer, xi_senml_pat_entry_update_time,
+                               XI_SENML_PAT_LEN( xi_senml_pat_entry_update_time ),
+                               fields_count++ );
+        xi_senml_json_put_int( writer, entry->update_time );
+    }
 
-    /* then the value itself */
-    XI_CHECK_STATE( ret_state = xi_senml_json_serialize_string( out, name ) );
+    xi_senml_json_put( writer, xi_senml_pat_entry_close,
+                       XI_SENML_PAT_LEN( xi_senml_pat_entry_close ) );
+}
+
+static void xi_senml_json_put_document_open( xi_senml_json_writer_t* writer )
+{
+    xi_senml_json_put( writer, xi_senml_pat_open, XI_SENML_PAT_LEN( xi_senml_pat_open ) );
+}
+
+/* the base fields follow the entries */
+static void xi_senml_json_put_document_close( xi_senml_json_writer_t* writer,
+                                              const xi_senml_t* senml_structure )
+{
+    xi_senml_json_put( writer, xi_senml_pat_entries_close,
+                       XI_SENML_PAT_LEN( xi_senml_pat_entries_close ) );
+
+    uint16_t elements_count = 1;
+
+    if ( senml_structure->set.base_name_set == 1 )
+    {
+        xi_senml_json_put_key( writer, xi_senml_pat_base_name,
+                               XI_SENML_PAT_LEN( xi_senml_pat_base_name ),
+                               elements_count++ );
+        xi_senml_json_put_string( writer, senml_structure->base_name );
+    }
+
+    if ( senml_structure->set.base_time_set == 1 )
+    {
+        xi_senml_json_put_key( writer, xi_senml_pat_base_time,
+                               XI_SENML_PAT_LEN( xi_senml_pat_base_time ),
+                               elements_count++ );
+        xi_senml_json_put_int( writer, senml_structure->base_time );
+    }
+
+    if ( senml_structure->set.base_units_set == 1 )
+    {
+        xi_senml_json_put_key( writer, xi_senml_pat_base_units,
+                               XI_SENML_PAT_LEN( xi_senml_pat_base_units ),
+                               elements_count++ );
+        xi_senml_json_put_string( writer, senml_structure->base_units );
+    }
+
+    xi_senml_json_put( writer, xi_senml_pat_close,
+                       XI_SENML_PAT_LEN( xi_senml_pat_close ) );
+}
+
+static void xi_senml_json_put_document( xi_senml_json_writer_t* writer,
+                                        const xi_senml_t* senml_structure )
+{
+    xi_senml_json_put_document_open( writer );
+
+    /* serialization of entities */
+    {
+        uint32_t entries_count        = 0;
+        const xi_senml_entry_t* entry = senml_structure->entries_list;
+
+        while ( entry && XI_STATE_OK == writer->state )
+        {
+            xi_senml_json_put_entry( writer, entry, entries_count );
+            entry = entry->__next;
+            ++entries_count;
+        }
+    }
+
+    xi_senml_json_put_document_close( writer, senml_structure );
+}
+
+/*-----------------------------------------------------------------------
+ * WRITING TO A FIXED BUFFER
+ * ----------------------------------------------------------------------- */
+
+xi_state_t xi_senml_json_write_document_open( uint8_t* buffer,
+                                              uint32_t* len,
+                                              const xi_senml_t* base )
+{
+    xi_senml_json_writer_t writer = {( char* )buffer, 0, XI_STATE_OK};
+
+    XI_UNUSED( base );
+
+    xi_senml_json_put_document_open( &writer );
+
+    *len = writer.pos;
+    return writer.state;
+}
+
+xi_state_t xi_senml_json_write_entry( uint8_t* buffer,
+                                      uint32_t* len,
+                                      const xi_senml_t* base,
+                                      const xi_senml_entry_t* entry,
+                                      uint32_t entry_count )
+{
+    xi_senml_json_writer_t writer = {( char* )buffer, 0, XI_STATE_OK};
+
+    XI_UNUSED( base );
+
+    xi_senml_json_put_entry( &writer, entry, entry_count );
+
+    *len = writer.pos;
+    return writer.state;
+}
+
+xi_state_t xi_senml_json_write_document_close( uint8_t* buffer,
+                                               uint32_t* len,
+                                               const xi_senml_t* base,
+                                               uint32_t entries_count )
+{
+    xi_senml_json_writer_t writer = {( char* )buffer, 0, XI_STATE_OK};
+
+    XI_UNUSED( entries_count );
+
+    xi_senml_json_put_document_close( &writer, base );
+
+    *len = writer.pos;
+    return writer.state;
+}
+
+/*-----------------------------------------------------------------------
+ * APPENDING TO A DATA DESCRIPTOR
+ * ----------------------------------------------------------------------- */
+
+/* the sizing run is done, makes room for its output at the end of out */
+static xi_state_t
+xi_senml_json_writer_reserve( xi_senml_json_writer_t* writer, xi_data_desc_t* out )
+{
+    xi_state_t ret_state = writer->state;
+
+    XI_CHECK_STATE( ret_state );
+    XI_CHECK_STATE( ret_state = xi_data_desc_assure_buf_len( out, writer->pos ) );
+
+    writer->buffer = ( char* )out->data_ptr + out->length;
+    writer->pos    = 0;
 
 err_handling:
     return ret_state;
 }
 
+/* runs the emitter calls twice, sizing then appending their output to out */
+#define XI_SENML_JSON_APPEND( out, ... )                                                 \
+    {                                                                                    \
+        xi_senml_json_writer_t writer_storage = {NULL, 0, XI_STATE_OK};                  \
+        xi_senml_json_writer_t* writer        = &writer_storage;                         \
+                                                                                         \
+        __VA_ARGS__;                                                                     \
+                                                                                         \
+        const xi_state_t reserve_state = xi_senml_json_writer_reserve( writer, out );    \
+                                                                                         \
+        if ( XI_STATE_OK != reserve_state )                                              \
+        {                                                                                \
+            return reserve_state;                                                        \
+        }                                                                                \
+                                                                                         \
+        __VA_ARGS__;                                                                     \
+                                                                                         \
+        out->length += writer->pos;                                                      \
+                                                                                         \
+        return XI_STATE_OK;                                                              \
+    }
+
+xi_state_t xi_senml_json_serialize_init( xi_data_desc_t* out )
+{
+    assert( out != 0 );
+
+    XI_SENML_JSON_APPEND(
+        out, xi_senml_json_put( writer, xi_senml_pat_open,
+                                XI_SENML_PAT_LEN( xi_senml_pat_open ) ) );
+}
+
+xi_state_t xi_senml_json_serialize_key( xi_data_desc_t* out,
+                                        const char* const key,
+                                        uint16_t elem_count )
+{
+    assert( out != 0 );
+    assert( key != 0 );
+
+    XI_SENML_JSON_APPEND(
+        out, xi_senml_json_put_key( writer, key, strlen( key ), elem_count ) );
+}
+
+xi_state_t xi_senml_json_serialize_string( xi_data_desc_t* out, const char* const string )
+{
+    assert( out != 0 );
+    assert( string != 0 );
+
+    XI_SENML_JSON_APPEND( out, xi_senml_json_put_string( writer, string ) );
+}
+
+xi_state_t xi_senml_json_serialize_float( xi_data_desc_t* out, const float value )
+{
+    assert( out != 0 );
+
+    XI_SENML_JSON_APPEND( out, xi_senml_json_put_float( writer, value ) );
+}
+
+xi_state_t xi_senml_json_serialize_int( xi_data_desc_t* out, const uint32_t value )
+{
+    assert( out != 0 );
+
+    XI_SENML_JSON_APPEND( out, xi_senml_json_put_int( writer, ( int32_t )value ) );
+}
+
+xi_state_t xi_senml_json_serialize_boolean( xi_data_desc_t* out, const uint8_t boolean )
+{
+    assert( out != 0 );
+
+    XI_SENML_JSON_APPEND( out, xi_senml_json_put_boolean( writer, boolean ) );
+}
+
+xi_state_t
+xi_senml_json_serialize_name( xi_data_desc_t* out, const char* name, uint16_t elem_count )
+{
+    assert( out != 0 );
+    assert( name != 0 );
+
+    XI_SENML_JSON_APPEND( out, {
+        xi_senml_json_put_key( writer, xi_senml_pat_entry_name,
+                               XI_SENML_PAT_LEN( xi_senml_pat_entry_name ), elem_count );
+        xi_senml_json_put_string( writer, name );
+    } );
+}
+
 xi_state_t xi_senml_json_serialize_float_value( xi_data_desc_t* out,
                                                 const float value,
                                                 uint16_t elem_count )
 {
     assert( out != 0 );
 
-    xi_state_t ret_state = XI_STATE_OK;
-
-    XI_CHECK_STATE( ret_state = xi_senml_json_serialize_key(
-                        out, xi_senml_pat_entry_float_value, elem_count ) );
-    XI_CHECK_STATE( ret_state = xi_senml_json_serialize_float( out, value ) );
-
-err_handling:
-    return ret_state;
+    XI_SENML_JSON_APPEND( out, {
+        xi_senml_json_put_key( writer, xi_senml_pat_entry_float_value,
+                               XI_SENML_PAT_LEN( xi_senml_pat_entry_float_value ),
+                               elem_count );
+        xi_senml_json_put_float( writer, value );
+    } );
 }
 
 xi_state_t xi_senml_json_serialize_string_value( xi_data_desc_t* out,
@@ -187,14 +792,12 @@ xi_state_t xi_senml_json_serialize_string_value( xi_data_desc_t* out,
     assert( out != 0 );
     assert( string != 0 );
 
-    xi_state_t ret_state = XI_STATE_OK;
-
-    XI_CHECK_STATE( ret_state = xi_senml_json_serialize_key(
-                        out, xi_senml_pat_entry_string_value, elem_count ) );
-    XI_CHECK_STATE( ret_state = xi_senml_json_serialize_string( out, string ) );
-
-err_handling:
-    return ret_state;
+    XI_SENML_JSON_APPEND( out, {
+        xi_senml_json_put_key( writer, xi_senml_pat_entry_string_value,
+                               XI_SENML_PAT_LEN( xi_senml_pat_entry_string_value ),
+                               elem_count );
+        xi_senml_json_put_string( writer, string );
+    } );
 }
 
 xi_state_t xi_senml_json_serialize_boolean_value( xi_data_desc_t* out,
@@ -203,14 +806,12 @@ xi_state_t xi_senml_json_serialize_boolean_value( xi_data_desc_t* out,
 {
     assert( out != 0 );
 
-    xi_state_t ret_state = XI_STATE_OK;
-
-    XI_CHECK_STATE( ret_state = xi_senml_json_serialize_key(
-                        out, xi_senml_pat_entry_boolean_value, elem_count ) );
-    XI_CHECK_STATE( ret_state = xi_senml_json_serialize_boolean( out, boolean ) );
-
-err_handling:
-    return ret_state;
+    XI_SENML_JSON_APPEND( out, {
+        xi_senml_json_put_key( writer, xi_senml_pat_entry_boolean_value,
+                               XI_SENML_PAT_LEN( xi_senml_pat_entry_boolean_value ),
+                               elem_count );
+        xi_senml_json_put_boolean( writer, boolean );
+    } );
 }
 
 xi_state_t xi_senml_json_serialize_units( xi_data_desc_t* out,
@@ -220,14 +821,11 @@ xi_state_t xi_senml_json_serialize_units( xi_data_desc_t* out,
     assert( out != 0 );
     assert( units != 0 );
 
-    xi_state_t ret_state = XI_STATE_OK;
-
-    XI_CHECK_STATE( ret_state = xi_senml_json_serialize_key(
-                        out, xi_senml_pat_entry_units, elem_count ) );
-    XI_CHECK_STATE( ret_state = xi_senml_json_serialize_string( out, units ) );
-
-err_handling:
-    return ret_state;
+    XI_SENML_JSON_APPEND( out, {
+        xi_senml_json_put_key( writer, xi_senml_pat_entry_units,
+                               XI_SENML_PAT_LEN( xi_senml_pat_entry_units ), elem_count );
+        xi_senml_json_put_string( writer, units );
+    } );
 }
 
 xi_state_t
@@ -235,14 +833,11 @@ xi_senml_json_serialize_time( xi_data_desc_t* out, int32_t time, uint16_t elem_c
 {
     assert( out != 0 );
 
-    xi_state_t ret_state = XI_STATE_OK;
-
-    XI_CHECK_STATE( ret_state = xi_senml_json_serialize_key( out, xi_senml_pat_entry_time,
-                                                             elem_count ) );
-    XI_CHECK_STATE( ret_state = xi_senml_json_serialize_int( out, time ) );
-
-err_handling:
-    return ret_state;
+    XI_SENML_JSON_APPEND( out, {
+        xi_senml_json_put_key( writer, xi_senml_pat_entry_time,
+                               XI_SENML_PAT_LEN( xi_senml_pat_entry_time ), elem_count );
+        xi_senml_json_put_int( writer, time );
+    } );
 }
 
 xi_state_t xi_senml_json_serialize_update_time( xi_data_desc_t* out,
@@ -251,14 +846,12 @@ xi_state_t xi_senml_json_serialize_update_time( xi_data_desc_t* out,
 {
     assert( out != 0 );
 
-    xi_state_t ret_state = XI_STATE_OK;
-
-    XI_CHECK_STATE( ret_state = xi_senml_json_serialize_key(
-                        out, xi_senml_pat_entry_update_time, elem_count ) );
-    XI_CHECK_STATE( ret_state = xi_senml_json_serialize_int( out, time ) );
-
-err_handling:
-    return ret_state;
+    XI_SENML_JSON_APPEND( out, {
+        xi_senml_json_put_key( writer, xi_senml_pat_entry_update_time,
+                               XI_SENML_PAT_LEN( xi_senml_pat_entry_update_time ),
+                               elem_count );
+        xi_senml_json_put_int( writer, time );
+    } );
 }
 
 xi_state_t xi_senml_json_serialize_base_name( xi_data_desc_t* out,
@@ -268,17 +861,11 @@ xi_state_t xi_senml_json_serialize_base_name( xi_data_desc_t* out,
     assert( out != 0 );
     assert( base_name != 0 );
 
-    xi_state_t ret_state = XI_STATE_OK;
-
-    /* elem_count part serialize the key value */
-    XI_CHECK_STATE( ret_state = xi_senml_json_serialize_key( out, xi_senml_pat_base_name,
-                                                             elem_count ) );
-
-    /* then the value itself */
-    XI_CHECK_STATE( ret_state = xi_senml_json_serialize_string( out, base_name ) );
-
-err_handling:
-    return ret_state;
+    XI_SENML_JSON_APPEND( out, {
+        xi_senml_json_put_key( writer, xi_senml_pat_base_name,
+                               XI_SENML_PAT_LEN( xi_senml_pat_base_name ), elem_count );
+        xi_senml_json_put_string( writer, base_name );
+    } );
 }
 
 xi_state_t xi_senml_json_serialize_base_units( xi_data_desc_t* out,
@@ -288,14 +875,11 @@ xi_state_t xi_senml_json_serialize_base_units( xi_data_desc_t* out,
     assert( out != 0 );
     assert( base_units != 0 );
 
-    xi_state_t ret_state = XI_STATE_OK;
-
-    XI_CHECK_STATE( ret_state = xi_senml_json_serialize_key( out, xi_senml_pat_base_units,
-                                                             elem_count ) );
-    XI_CHECK_STATE( ret_state = xi_senml_json_serialize_string( out, base_units ) );
-
-err_handling:
-    return ret_state;
+    XI_SENML_JSON_APPEND( out, {
+        xi_senml_json_put_key( writer, xi_senml_pat_base_units,
+                               XI_SENML_PAT_LEN( xi_senml_pat_base_units ), elem_count );
+        xi_senml_json_put_string( writer, base_units );
+    } );
 }
 
 xi_state_t xi_senml_json_serialize_base_time( xi_data_desc_t* out,
@@ -304,172 +888,76 @@ xi_state_t xi_senml_json_serialize_base_time( xi_data_desc_t* out,
 {
     assert( out != 0 );
 
-    xi_state_t ret_state = XI_STATE_OK;
-
-    XI_CHECK_STATE( ret_state = xi_senml_json_serialize_key( out, xi_senml_pat_base_time,
-                                                             elem_count ) );
-    XI_CHECK_STATE( ret_state = xi_senml_json_serialize_int( out, base_time ) );
-
-err_handling:
-    return ret_state;
+    XI_SENML_JSON_APPEND( out, {
+        xi_senml_json_put_key( writer, xi_senml_pat_base_time,
+                               XI_SENML_PAT_LEN( xi_senml_pat_base_time ), elem_count );
+        xi_senml_json_put_int( writer, base_time );
+    } );
 }
 
 xi_state_t xi_senml_json_serialize_close( xi_data_desc_t* out )
 {
     assert( out != 0 );
 
-    return xi_data_desc_append_data_resize( out, xi_senml_pat_close,
-                                            sizeof( xi_senml_pat_close ) - 1 );
+    XI_SENML_JSON_APPEND(
+        out, xi_senml_json_put( writer, xi_senml_pat_close,
+                                XI_SENML_PAT_LEN( xi_senml_pat_close ) ) );
 }
 
 xi_state_t xi_senml_json_serialize_close_entries( xi_data_desc_t* out )
 {
     assert( out != 0 );
 
-    return xi_data_desc_append_data_resize( out, xi_senml_pat_entries_close,
-                                            sizeof( xi_senml_pat_entries_close ) - 1 );
+    XI_SENML_JSON_APPEND(
+        out, xi_senml_json_put( writer, xi_senml_pat_entries_close,
+                                XI_SENML_PAT_LEN( xi_senml_pat_entries_close ) ) );
 }
 
 xi_state_t xi_senml_json_serialize_value_set( xi_data_desc_t* out,
                                               xi_senml_value_t* value_cnt,
                                               uint16_t elem_count )
 {
-    switch ( value_cnt->value_type )
-    {
-        case XI_SENML_VALUE_TYPE_STRING:
-            return xi_senml_json_serialize_string_value(
-                out, value_cnt->value.string_value, elem_count );
-        case XI_SENML_VALUE_TYPE_FLOAT:
-            return xi_senml_json_serialize_float_value( out, value_cnt->value.float_value,
-                                                        elem_count );
-        case XI_SENML_VALUE_TYPE_BOOLEAN:
-            return xi_senml_json_serialize_boolean_value(
-                out, value_cnt->value.boolean_value, elem_count );
-        default:
-            return XI_INVALID_PARAMETER;
-    }
+    assert( out != 0 );
+
+    XI_SENML_JSON_APPEND( out,
+                          xi_senml_json_put_value_set( writer, value_cnt, elem_count ) );
 }
 
 xi_state_t xi_senml_json_serialize_entry( xi_data_desc_t* out,
                                           xi_senml_entry_t* entry,
                                           uint32_t entry_count )
 {
-    xi_state_t ret_state = XI_STATE_OK;
-
-    uint16_t fields_count = 0;
-
-    /* open either with coln or without */
-    if ( entry_count > 0 )
-    {
-        XI_CHECK_STATE( ret_state = xi_data_desc_append_data_resize(
-                            out, xi_senml_pat_entry_open_next,
-                            sizeof( xi_senml_pat_entry_open_next ) - 1 ) );
-    }
-    else
-    {
-        XI_CHECK_STATE( ret_state = xi_data_desc_append_data_resize(
-                            out, xi_senml_pat_entry_open_elem_count,
-                            sizeof( xi_senml_pat_entry_open_elem_count ) - 1 ) );
-    }
-
-    if ( entry->set.name_set == 1 )
-    {
-        XI_CHECK_STATE( ret_state = xi_senml_json_serialize_name( out, entry->name,
-                                                                  fields_count++ ) );
-    }
-
-    if ( entry->set.value_set == 1 )
-    {
-        XI_CHECK_STATE( ret_state = xi_senml_json_serialize_value_set(
-                            out, &entry->value_cnt, fields_count++ ) );
-    }
-    else
-    {
-        return XI_INVALID_PARAMETER;
-    }
-
-    if ( entry->set.time_set == 1 )
-    {
-        XI_CHECK_STATE( ret_state = xi_senml_json_serialize_time( out, entry->time,
-                                                                  fields_count++ ) );
-    }
-
-    if ( entry->set.units_set == 1 )
-    {
-        XI_CHECK_STATE( ret_state = xi_senml_json_serialize_units( out, entry->units,
-                                                                   fields_count++ ) );
-    }
-
-    if ( entry->set.update_time_set == 1 )
-    {
-        XI_CHECK_STATE( ret_state = xi_senml_json_serialize_update_time(
-                            out, entry->update_time, fields_count++ ) );
-    }
-
-    XI_CHECK_STATE(
-        ret_state = xi_data_desc_append_data_resize(
-            out, xi_senml_pat_entry_close, sizeof( xi_senml_pat_entry_close ) - 1 ) );
+    assert( out != 0 );
 
-err_handling:
-    return ret_state;
+    XI_SENML_JSON_APPEND( out, xi_senml_json_put_entry( writer, entry, entry_count ) );
 }
 
 xi_state_t
 xi_senml_json_serialize( xi_data_desc_t** out_buffer, xi_senml_t* senml_structure )
 {
-    /* we are going to start with some 32 bytes allocation */
-    static const uint32_t start_size = 32;
-
-    xi_state_t ret_state = XI_STATE_OK;
+    xi_state_t ret_state          = XI_STATE_OK;
+    xi_senml_json_writer_t writer = {NULL, 0, XI_STATE_OK};
 
     if ( out_buffer == 0 || senml_structure == 0 )
     {
         return XI_INVALID_PARAMETER;
     }
 
-    xi_data_desc_t* dst = *out_buffer = xi_make_empty_desc_alloc( start_size );
-    XI_CHECK_MEMORY( dst, ret_state );
-
-    /* initialization of the senml buffer */
-    XI_CHECK_STATE( ret_state = xi_senml_json_serialize_init( dst ) );
-
-    /* serialization of entities */
-    {
-        uint32_t entries_count  = 0;
-        xi_senml_entry_t* entry = senml_structure->entries_list;
-
-        while ( entry )
-        {
-            XI_CHECK_STATE( ret_state = xi_senml_json_serialize_entry( *out_buffer, entry,
-                                                                       entries_count ) );
-            entry = entry->__next;
-            ++entries_count;
-        }
-    }
-
-    XI_CHECK_STATE( ret_state = xi_senml_json_serialize_close_entries( dst ) );
+    *out_buffer = NULL;
 
-    uint16_t elements_count = 1;
+    /* sizing run */
+    xi_senml_json_put_document( &writer, senml_structure );
 
-    if ( senml_structure->set.base_name_set == 1 )
-    {
-        xi_senml_json_serialize_base_name( dst, senml_structure->base_name,
-                                           elements_count++ );
-    }
+    XI_CHECK_STATE( ret_state = writer.state );
 
-    if ( senml_structure->set.base_time_set == 1 )
-    {
-        xi_senml_json_serialize_base_time( dst, senml_structure->base_time,
-                                           elements_count++ );
-    }
+    xi_data_desc_t* dst = *out_buffer = xi_make_empty_desc_alloc( writer.pos );
+    XI_CHECK_MEMORY( dst, ret_state );
 
-    if ( senml_structure->set.base_units_set == 1 )
-    {
-        xi_senml_json_serialize_base_units( dst, senml_structure->base_units,
-                                            elements_count++ );
-    }
+    /* writing run */
+    XI_CHECK_STATE( ret_state = xi_senml_json_writer_reserve( &writer, dst ) );
+    xi_senml_json_put_document( &writer, senml_structure );
 
-    XI_CHECK_STATE( ret_state = xi_senml_json_serialize_close( dst ) );
+    dst->length = writer.pos;
 
 err_handling:
     return ret_state;
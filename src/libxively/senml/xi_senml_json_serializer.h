@@ -86,6 +86,23 @@ extern xi_state_t xi_senml_json_serialize_entry( xi_data_desc_t* out,
 extern xi_state_t
 xi_senml_json_serialize( xi_data_desc_t** out_buffer, xi_senml_t* senml_structure );
 
+/* streaming writer support: the document is written piece by piece into a fixed
+ * buffer, with buffer NULL only the length is returned in *len */
+extern xi_state_t xi_senml_json_write_document_open( uint8_t* buffer,
+                                                     uint32_t* len,
+                                                     const xi_senml_t* base );
+
+extern xi_state_t xi_senml_json_write_entry( uint8_t* buffer,
+                                             uint32_t* len,
+                                             const xi_senml_t* base,
+                                             const xi_senml_entry_t* entry,
+                                             uint32_t entry_count );
+
+extern xi_state_t xi_senml_json_write_document_close( uint8_t* buffer,
+                                                      uint32_t* len,
+                                                      const xi_senml_t* base,
+                                                      uint32_t entries_count );
+
 #ifdef __cplusplus
 }
 #endif
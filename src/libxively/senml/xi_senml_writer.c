@@ -0,0 +1,252 @@
+/* Copyright (c) 2003-2018, Xively All rights reserved.
+ *
+ * This is part of the Xively C Client library,
+ * it is licensed under the BSD 3-Clause license.
+ */
+
+#include "xively_senml.h"
+#include "xi_macros.h"
+#include "xi_senml_cbor_serializer.h"
+#include "xi_senml_json_serializer.h"
+
+#include <stdarg.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * The writer serializes every entry as it is appended, nothing is kept of it
+ * afterwards. Each piece of the document is sized first so an entry is written only
+ * if the closing of the document still fits behind it.
+ */
+
+typedef struct xi_senml_writer_format_s
+{
+    xi_state_t ( *write_document_open )( uint8_t* buffer,
+                                         uint32_t* len,
+                                         const xi_senml_t* base );
+    xi_state_t ( *write_entry )( uint8_t* buffer,
+                                 uint32_t* len,
+                                 const xi_senml_t* base,
+                                 const xi_senml_entry_t* entry,
+                                 uint32_t entry_count );
+    xi_state_t ( *write_document_close )( uint8_t* buffer,
+                                          uint32_t* len,
+                                          const xi_senml_t* base,
+                                          uint32_t entries_count );
+} xi_senml_writer_format_t;
+
+static const xi_senml_writer_format_t xi_senml_writer_formats[] = {
+    /* XI_SENML_FORMAT_JSON */
+    {&xi_senml_json_write_document_open, &xi_senml_json_write_entry,
+     &xi_senml_json_write_document_close},
+    /* XI_SENML_FORMAT_CBOR */
+    {&xi_senml_cbor_write_document_open, &xi_senml_cbor_write_entry,
+     &xi_senml_cbor_write_document_close}};
+
+/* opens the document if nothing has been written into it yet */
+static xi_state_t xi_senml_writer_open( xi_senml_writer_t* writer )
+{
+    xi_state_t state = XI_STATE_OK;
+
+    if ( 0 == writer->length )
+    {
+        XI_CHECK_STATE( state = xi_senml_writer_formats[writer->format]
+                                    .write_document_open( writer->buffer,
+                                                          &writer->length,
+                                                          &writer->base ) );
+    }
+
+err_handling:
+    return state;
+}
+
+xi_state_t xi_init_senml_writer( xi_senml_writer_t* writer,
+                                 xi_senml_format_t format,
+                                 uint8_t* buffer,
+                                 uint32_t capacity,
+                                 int count,
+                                 ... )
+{
+    xi_state_t state         = XI_STATE_OK;
+    uint32_t empty_close_len = 0;
+    uint8_t i                = 0;
+    va_list ap;
+
+    if ( NULL == writer || NULL == buffer ||
+         XI_ARRAYSIZE( xi_senml_writer_formats ) <= ( size_t )format )
+    {
+        return XI_INVALID_PARAMETER;
+    }
+
+    memset( writer, 0, sizeof( xi_senml_writer_t ) );
+
+    writer->format   = format;
+    writer->buffer   = buffer;
+    writer->capacity = capacity;
+
+    va_start( ap, count );
+
+    for ( ; i < count; ++i )
+    {
+        const xi_senml_t base_in = va_arg( ap, xi_senml_t );
+
+        if ( 1 == base_in.set.base_name_set )
+        {
+            XI_CHECK_CND( NULL == base_in.base_name, XI_INVALID_PARAMETER, state );
+
+            writer->base.set.base_name_set = 1;
+            writer->base.base_name         = base_in.base_name;
+        }
+
+        if ( 1 == base_in.set.base_units_set )
+        {
+            XI_CHECK_CND( NULL == base_in.base_units, XI_INVALID_PARAMETER, state );
+
+            writer->base.set.base_units_set = 1;
+            writer->base.base_units         = base_in.base_units;
+        }
+
+        if ( 1 == base_in.set.base_time_set )
+        {
+            writer->base.set.base_time_set = 1;
+            writer->base.base_time         = base_in.base_time;
+        }
+    }
+
+    const xi_senml_writer_format_t* writer_format = &xi_senml_writer_formats[format];
+
+    XI_CHECK_STATE( state = writer_format->write_document_open(
+                        NULL, &writer->open_length, &writer->base ) );
+    XI_CHECK_STATE( state = writer_format->write_document_close(
+                        NULL, &empty_close_len, &writer->base, 0 ) );
+    XI_CHECK_CND( capacity < writer->open_length + empty_close_len, XI_BUFFER_OVERFLOW,
+                  state );
+
+    /* the closing does not change with the number of entries once there is one */
+    XI_CHECK_STATE( state = writer_format->write_document_close(
+                        NULL, &writer->close_length, &writer->base, 1 ) );
+
+err_handling:
+    va_end( ap );
+    return state;
+}
+
+xi_state_t xi_append_senml_entry( xi_senml_writer_t* writer, int count, ... )
+{
+    xi_state_t state   = XI_STATE_OK;
+    uint32_t entry_len = 0;
+    uint8_t i          = 0;
+    xi_senml_entry_t entry;
+    va_list ap;
+
+    if ( NULL == writer )
+    {
+        return XI_INVALID_PARAMETER;
+    }
+
+    memset( &entry, 0, sizeof( xi_senml_entry_t ) );
+
+    const xi_senml_writer_format_t* format = &xi_senml_writer_formats[writer->format];
+
+    va_start( ap, count );
+
+    /* the descriptors are merged, strings are referenced for the time of the call */
+    for ( ; i < count; ++i )
+    {
+        const xi_senml_entry_t entry_in = va_arg( ap, xi_senml_entry_t );
+
+        if ( 1 == entry_in.set.name_set )
+        {
+            XI_CHECK_CND( NULL == entry_in.name, XI_INVALID_PARAMETER, state );
+
+            entry.set.name_set = 1;
+            entry.name         = entry_in.name;
+        }
+
+        if ( 1 == entry_in.set.units_set )
+        {
+            XI_CHECK_CND( NULL == entry_in.units, XI_INVALID_PARAMETER, state );
+
+            entry.set.units_set = 1;
+            entry.units         = entry_in.units;
+        }
+
+        if ( 1 == entry_in.set.value_set )
+        {
+            XI_CHECK_CND( XI_SENML_VALUE_TYPE_STRING == entry_in.value_cnt.value_type &&
+                              NULL == entry_in.value_cnt.value.string_value,
+                          XI_INVALID_PARAMETER, state );
+
+            entry.set.value_set = 1;
+            entry.value_cnt     = entry_in.value_cnt;
+        }
+
+        if ( 1 == entry_in.set.time_set )
+        {
+            entry.set.time_set = 1;
+            entry.time         = entry_in.time;
+        }
+
+        if ( 1 == entry_in.set.update_time_set )
+        {
+            entry.set.update_time_set = 1;
+            entry.update_time         = entry_in.update_time;
+        }
+    }
+
+    /* sizing */
+    XI_CHECK_STATE( state = format->write_entry( NULL, &entry_len, &writer->base, &entry,
+                                                 writer->entries_count ) );
+    XI_CHECK_CND( writer->capacity < ( ( 0 == writer->length ) ? writer->open_length
+                                                               : writer->length ) +
+                                         entry_len + writer->close_length,
+                  XI_BUFFER_OVERFLOW, state );
+
+    /* writing */
+    XI_CHECK_STATE( state = xi_senml_writer_open( writer ) );
+    XI_CHECK_STATE( state = format->write_entry( writer->buffer + writer->length,
+                                                 &entry_len, &writer->base, &entry,
+                                                 writer->entries_count ) );
+
+    writer->length += entry_len;
+    writer->entries_count += 1;
+
+err_handling:
+    va_end( ap );
+    return state;
+}
+
+xi_state_t xi_flush_senml_writer( xi_senml_writer_t* writer,
+                                  const uint8_t** out_document,
+                                  uint32_t* out_size )
+{
+    xi_state_t state   = XI_STATE_OK;
+    uint32_t close_len = 0;
+
+    if ( NULL == writer || NULL == out_document || NULL == out_size )
+    {
+        return XI_INVALID_PARAMETER;
+    }
+
+    XI_CHECK_STATE( state = xi_senml_writer_open( writer ) );
+    XI_CHECK_STATE( state = xi_senml_writer_formats[writer->format].write_document_close(
+                        writer->buffer + writer->length, &close_len, &writer->base,
+                        writer->entries_count ) );
+
+    *out_document = writer->buffer;
+    *out_size     = writer->length + close_len;
+
+    /* the next entry starts a new document */
+    writer->length        = 0;
+    writer->entries_count = 0;
+
+err_handling:
+    return state;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -47,9 +47,18 @@ xi_state_t xi_sft_make_context( xi_sft_context_t** context,
     ( *context )->update_message_fua       = NULL;
     ( *context )->update_current_file      = NULL;
     ( *context )->update_firmware          = NULL;
-    ( *context )->update_file_handle       = XI_BSP_IO_FS_INVALID_RESOURCE_HANDLE;
     ( *context )->sft_url_handler_callback = sft_url_handler_callback;
-    ( *context )->checksum_context         = NULL;
+    ( *context )->parallel_downloads       = XI_SFT_PARALLEL_DOWNLOADS;
+    ( *context )->download_memory_budget   = XI_SFT_DOWNLOAD_MEMORY_BUDGET;
+    ( *context )->chunk_window_size        = XI_SFT_FILE_CHUNK_WINDOW;
+    ( *context )->chunk_size               = XI_SFT_FILE_CHUNK_SIZE;
+
+    uint16_t id_download = 0;
+    for ( ; id_download < XI_SFT_PARALLEL_DOWNLOADS_MAX; ++id_download )
+    {
+        ( *context )->downloads[id_download].file_handle =
+            XI_BSP_IO_FS_INVALID_RESOURCE_HANDLE;
+    }
 
     return state;
 
@@ -63,9 +72,11 @@ xi_state_t xi_sft_free_context( xi_sft_context_t** context )
 {
     if ( NULL != context && NULL != *context )
     {
-        xi_sft_on_message_file_chunk_checksum_final( *context );
+        /* connection lost or shutdown: the next context may continue from here */
+        _xi_sft_save_download_progresses( *context );
 
-        xi_bsp_io_fs_close( ( *context )->update_file_handle );
+        /* closes the files under update */
+        _xi_sft_abandon_package_download( *context );
 
         xi_control_message_free( &( *context )->update_message_fua );
         XI_SAFE_FREE( ( *context )->updateable_files_download_order );
@@ -75,6 +86,40 @@ xi_state_t xi_sft_free_context( xi_sft_context_t** context )
     return XI_STATE_OK;
 }
 
+xi_state_t xi_sft_set_download_window( xi_sft_context_t* context,
+                                       uint16_t chunk_window_size,
+                                       uint32_t chunk_size )
+{
+    if ( NULL == context || XI_SFT_FILE_CHUNK_WINDOW_MAX < chunk_window_size )
+    {
+        return XI_INVALID_PARAMETER;
+    }
+
+    context->chunk_window_size =
+        ( 0 == chunk_window_size ) ? XI_SFT_FILE_CHUNK_WINDOW : chunk_window_size;
+    context->chunk_size = ( 0 == chunk_size ) ? XI_SFT_FILE_CHUNK_SIZE : chunk_size;
+
+    return XI_STATE_OK;
+}
+
+xi_state_t xi_sft_set_parallel_downloads( xi_sft_context_t* context,
+                                          uint16_t parallel_downloads,
+                                          uint32_t download_memory_budget )
+{
+    if ( NULL == context || XI_SFT_PARALLEL_DOWNLOADS_MAX < parallel_downloads )
+    {
+        return XI_INVALID_PARAMETER;
+    }
+
+    context->parallel_downloads =
+        ( 0 == parallel_downloads ) ? XI_SFT_PARALLEL_DOWNLOADS : parallel_downloads;
+    context->download_memory_budget = ( 0 == download_memory_budget )
+                                          ? XI_SFT_DOWNLOAD_MEMORY_BUDGET
+                                          : download_memory_budget;
+
+    return XI_STATE_OK;
+}
+
 xi_state_t xi_sft_on_connected( xi_sft_context_t* context )
 {
     xi_state_t state = XI_STATE_OK;
@@ -92,6 +137,18 @@ xi_state_t xi_sft_on_connected( xi_sft_context_t* context )
         return XI_INVALID_PARAMETER;
     }
 
+    return state;
+}
+
+xi_state_t xi_sft_send_file_info( xi_sft_context_t* context )
+{
+    xi_state_t state = XI_STATE_OK;
+
+    if ( NULL == context )
+    {
+        return XI_INVALID_PARAMETER;
+    }
+
     if ( NULL != context->fn_send_message )
     {
         xi_control_message_t* message_file_info = xi_control_message_create_file_info(
@@ -175,6 +232,11 @@ xi_sft_on_message( xi_sft_context_t* context, xi_control_message_t* sft_message_
         {
             /* todo?: check whether device is ready to start download of file */
 
+            /* the downloads in progress belong to the replaced package, their
+             * progress is saved while the file descriptions are still available */
+            _xi_sft_save_download_progresses( context );
+            _xi_sft_abandon_package_download( context );
+
             if ( NULL != context->update_message_fua )
             {
                 xi_control_message_free( &context->update_message_fua );
@@ -199,58 +261,50 @@ xi_sft_on_message( xi_sft_context_t* context, xi_control_message_t* sft_message_
 
         case XI_CONTROL_MESSAGE_SC__SFT_FILE_CHUNK:
         {
-            /* check whether FILE_CHUNK's filename matches the requested filename */
-            if ( NULL != context->update_current_file &&
-                 NULL != context->update_current_file->name &&
-                 NULL != sft_message_in->file_chunk.name &&
-                 0 == strcmp( context->update_current_file->name,
-                              sft_message_in->file_chunk.name ) )
+            /* find the download the FILE_CHUNK belongs to by its filename */
+            xi_sft_file_download_t* download =
+                _xi_sft_find_file_download( context, sft_message_in->file_chunk.name );
+
+            if ( NULL != download && 0 != download->flag_mqtt_download )
             {
+                const xi_control_message_file_desc_ext_t* file_desc = download->file_desc;
+
                 /* process file chunk */
                 {
                     const xi_control_message__sft_file_status_code_t
                         chunk_handling_status_code =
                             xi_sft_on_message_file_chunk_process_file_chunk(
-                                context, sft_message_in );
+                                download, sft_message_in );
 
                     /* error handling */
                     if ( XI_CONTROL_MESSAGE__SFT_FILE_STATUS_CODE_SUCCESS !=
                          chunk_handling_status_code )
                     {
                         _xi_sft_send_file_status(
-                            context, NULL,
+                            context, file_desc,
                             XI_CONTROL_MESSAGE__SFT_FILE_STATUS_PHASE_PROCESSING,
                             chunk_handling_status_code );
 
                         xi_debug_logger( "Error: File chunk handling failed" );
                         xi_bsp_fwu_on_package_download_failure();
 
+                        xi_sft_revision_remove_download_progress( file_desc->name );
+                        _xi_sft_abandon_package_download( context );
+
                         goto err_handling;
                     }
                 }
 
-                const uint32_t all_downloaded_bytes =
-                    sft_message_in->file_chunk.offset + sft_message_in->file_chunk.length;
-
-#if 0
-                printf( "         === === === downloading file: %s, %d / %d, [%d%%], "
-                        "status: %d\n",
-                        context->update_current_file->name,
-                        context->update_current_file->size_in_bytes, all_downloaded_bytes,
-                        ( all_downloaded_bytes * 100 ) /
-                            context->update_current_file->size_in_bytes,
-                        sft_message_in->file_chunk.status );
-#endif
+                _xi_sft_on_file_chunk_arrived( context, download,
+                                               sft_message_in->file_chunk.offset,
+                                               sft_message_in->file_chunk.length );
 
                 /* Secure File Transfer (SFT) flow management */
-                if ( all_downloaded_bytes < context->update_current_file->size_in_bytes )
+                if ( download->chunk_window.checksum_offset < file_desc->size_in_bytes )
                 {
-                    /* SFT flow: file is not downloaded yet, continue with this file */
-
-                    _xi_sft_send_file_get_chunk(
-                        context, all_downloaded_bytes,
-                        context->update_current_file->size_in_bytes -
-                            all_downloaded_bytes );
+                    /* SFT flow: file is not downloaded yet, keep the windows of
+                     * FILE_GET_CHUNK requests full */
+                    _xi_sft_fill_chunk_windows( context );
                 }
                 else
                 {
@@ -261,10 +315,13 @@ xi_sft_on_message( xi_sft_context_t* context, xi_control_message_t* sft_message_
                     {
                         const xi_control_message__sft_file_status_code_t
                             checksum_status_code =
-                                xi_sft_on_message_file_chunk_checksum_final( context );
+                                xi_sft_on_message_file_chunk_checksum_final( download );
+
+                        /* whatever the verdict, a saved progress is of no use anymore */
+                        xi_sft_revision_remove_download_progress( file_desc->name );
 
                         _xi_sft_send_file_status(
-                            context, NULL,
+                            context, file_desc,
                             XI_CONTROL_MESSAGE__SFT_FILE_STATUS_PHASE_DOWNLOADED,
                             checksum_status_code );
 
@@ -273,6 +330,7 @@ xi_sft_on_message( xi_sft_context_t* context, xi_control_message_t* sft_message_
                         {
                             xi_debug_logger( "Error: File checksum validation failed" );
                             xi_bsp_fwu_on_package_download_failure();
+                            _xi_sft_abandon_package_download( context );
                             goto err_handling;
                         }
                     }
@@ -280,44 +338,46 @@ xi_sft_on_message( xi_sft_context_t* context, xi_control_message_t* sft_message_
                     /* close file */
                     {
                         state = xi_fs_bsp_io_fs_2_xi_state(
-                            xi_bsp_io_fs_close( context->update_file_handle ) );
-                        context->update_file_handle =
-                            XI_BSP_IO_FS_INVALID_RESOURCE_HANDLE;
-                        // printf( " --- %s, close, state: %d\n", __FUNCTION__, state );
+                            xi_bsp_io_fs_close( download->file_handle ) );
+                        download->file_handle = XI_BSP_IO_FS_INVALID_RESOURCE_HANDLE;
+                        _xi_sft_release_file_download( download );
 
                         if ( XI_STATE_OK != state )
                         {
                             _xi_sft_send_file_status(
-                                context, NULL,
+                                context, file_desc,
                                 XI_CONTROL_MESSAGE__SFT_FILE_STATUS_PHASE_PROCESSING,
                                 XI_CONTROL_MESSAGE__SFT_FILE_STATUS_CODE_ERROR__FILE_CLOSE );
 
+                            _xi_sft_abandon_package_download( context );
                             goto err_handling;
                         }
                         else
                         {
-                            _xi_sft_current_file_revision_handling( context );
+                            _xi_sft_file_revision_handling( context, file_desc );
                         }
                     }
 
                     _xi_sft_continue_package_download( context );
+
+                    /* the finished file freed memory budget for the others */
+                    _xi_sft_fill_chunk_windows( context );
                 }
             }
             else
             {
-                /* Something went wrong. Somehow the current file under update
-                 * is not in sync with arrived FILE_CHUNK message. */
+                /* Something went wrong. The arrived FILE_CHUNK message belongs to none
+                 * of the files under download. */
 
                 _xi_sft_send_file_status(
                     context, NULL, XI_CONTROL_MESSAGE__SFT_FILE_STATUS_PHASE_DOWNLOADED,
                     XI_CONTROL_MESSAGE__SFT_FILE_STATUS_CODE_ERROR__UNEXPECTED_FILE_CHUNK );
 
-                xi_debug_format( "ERROR: context->update_current_file is out of sync. "
-                                 "[%p] [%s]. Dropping this FILE_CHUNK message, waiting "
-                                 "for the proper one...",
-                                 context->update_current_file,
-                                 context->update_current_file
-                                     ? context->update_current_file->name
+                xi_debug_format( "ERROR: FILE_CHUNK of [%s] is out of sync with the "
+                                 "files under download. Dropping this FILE_CHUNK "
+                                 "message, waiting for the proper one...",
+                                 sft_message_in->file_chunk.name
+                                     ? sft_message_in->file_chunk.name
                                      : "n/a" );
             }
         }
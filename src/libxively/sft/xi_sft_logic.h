@@ -11,9 +11,48 @@
 #include <xi_control_message.h>
 #include <xi_bsp_io_fs.h>
 #include <xively_types.h>
+#include <xi_config.h>
 
 typedef xi_state_t ( *fn_send_control_message_t )( void*, xi_control_message_t* );
 
+/* FILE_CHUNK that arrived ahead of the checksum frontier, it is already written to the
+ * file but waits here to be fed into the checksum in order */
+typedef struct xi_sft_pending_chunk_s
+{
+    struct xi_sft_pending_chunk_s* __next;
+    uint32_t offset;
+    uint32_t length;
+    uint8_t* chunk;
+} xi_sft_pending_chunk_t;
+
+/* FILE_GET_CHUNK sent and not answered yet, zero length marks a free slot */
+typedef struct
+{
+    uint32_t offset;
+    uint32_t length;
+} xi_sft_chunk_request_t;
+
+/* MQTT download state of a file under update */
+typedef struct
+{
+    xi_sft_chunk_request_t requests[XI_SFT_FILE_CHUNK_WINDOW_MAX];
+    xi_sft_pending_chunk_t* pending_chunks;
+    uint32_t request_offset;  /* first byte not requested yet */
+    uint32_t checksum_offset; /* bytes written and checksummed in order */
+    uint32_t progress_offset; /* checksum_offset last saved as download progress */
+    uint16_t requests_in_flight;
+} xi_sft_chunk_window_t;
+
+/* a file of the package under download, NULL file_desc marks a free slot */
+typedef struct
+{
+    const xi_control_message_file_desc_ext_t* file_desc;
+    uint8_t flag_mqtt_download; /* 0 while the application downloads the file */
+    xi_bsp_io_fs_resource_handle_t file_handle;
+    void* checksum_context;
+    xi_sft_chunk_window_t chunk_window;
+} xi_sft_file_download_t;
+
 typedef struct
 {
     fn_send_control_message_t fn_send_message;
@@ -23,12 +62,17 @@ typedef struct
     int32_t* updateable_files_download_order;
 
     xi_control_message_t* update_message_fua;
+    /* the file selected for download last */
     const xi_control_message_file_desc_ext_t* update_current_file;
     const xi_control_message_file_desc_ext_t* update_firmware;
-    xi_bsp_io_fs_resource_handle_t update_file_handle;
     xi_sft_url_handler_callback_t* sft_url_handler_callback;
 
-    void* checksum_context;
+    xi_sft_file_download_t downloads[XI_SFT_PARALLEL_DOWNLOADS_MAX];
+    uint16_t parallel_downloads;
+    uint32_t download_memory_budget;
+
+    uint16_t chunk_window_size;
+    uint32_t chunk_size;
 
 } xi_sft_context_t;
 
@@ -42,8 +86,37 @@ xi_state_t xi_sft_make_context( xi_sft_context_t** context,
 
 xi_state_t xi_sft_free_context( xi_sft_context_t** context );
 
+/**
+ * @brief xi_sft_set_download_window sets the number of FILE_GET_CHUNK requests kept
+ * outstanding during MQTT file download and the requested chunk length
+ *
+ * Zero selects the XI_SFT_FILE_CHUNK_WINDOW and XI_SFT_FILE_CHUNK_SIZE defaults. The
+ * chunk size is only a proposal: if the service answers with shorter chunks the
+ * shorter length is used for the rest of the download.
+ */
+xi_state_t xi_sft_set_download_window( xi_sft_context_t* context,
+                                       uint16_t chunk_window_size,
+                                       uint32_t chunk_size );
+
+/**
+ * @brief xi_sft_set_parallel_downloads sets how many files of a package are downloaded
+ * at the same time and the memory they may use together
+ *
+ * The memory budget counts the bytes of the outstanding FILE_GET_CHUNK requests and of
+ * the FILE_CHUNKs waiting for the checksum. Zero selects the XI_SFT_PARALLEL_DOWNLOADS
+ * and XI_SFT_DOWNLOAD_MEMORY_BUDGET defaults.
+ */
+xi_state_t xi_sft_set_parallel_downloads( xi_sft_context_t* context,
+                                          uint16_t parallel_downloads,
+                                          uint32_t download_memory_budget );
+
+/* called once the control topic subscription is granted */
 xi_state_t xi_sft_on_connected( xi_sft_context_t* context );
 
+/* sends the FILE_INFO message, it does not wait for the control topic SUBACK, the
+ * broker handles the SUBSCRIBE sent before it first so the reply is not lost */
+xi_state_t xi_sft_send_file_info( xi_sft_context_t* context );
+
 xi_state_t xi_sft_on_connection_failed( xi_sft_context_t* context );
 
 xi_state_t
@@ -28,19 +28,24 @@ _xi_sft_on_file_downloaded_task( void* sft_context_void,
         ( intptr_t )flag_download_finished_successfully_void;
 
 
+    xi_sft_file_download_t* download = _xi_sft_find_file_download( context, filename );
+
     if ( 0 != flag_download_finished_successfully )
     {
         /* URL download finished successfully: report status, continue package download */
-        if ( NULL != context->update_current_file &&
-             NULL != context->update_current_file->name && NULL != filename &&
-             0 == strcmp( context->update_current_file->name, filename ) )
+        if ( NULL != download && 0 == download->flag_mqtt_download )
         {
+            const xi_control_message_file_desc_ext_t* file_desc = download->file_desc;
+
             _xi_sft_send_file_status(
-                context, NULL, XI_CONTROL_MESSAGE__SFT_FILE_STATUS_PHASE_DOWNLOADED,
+                context, file_desc, XI_CONTROL_MESSAGE__SFT_FILE_STATUS_PHASE_DOWNLOADED,
                 XI_CONTROL_MESSAGE__SFT_FILE_STATUS_CODE_SUCCESS );
 
-            _xi_sft_current_file_revision_handling( context );
+            _xi_sft_release_file_download( download );
+
+            _xi_sft_file_revision_handling( context, file_desc );
             _xi_sft_continue_package_download( context );
+            _xi_sft_fill_chunk_windows( context );
         }
         else
         {
@@ -53,14 +58,20 @@ _xi_sft_on_file_downloaded_task( void* sft_context_void,
     {
         /* URL download failed: report status, try to fallback to MQTT download */
         _xi_sft_send_file_status(
-            context, NULL, XI_CONTROL_MESSAGE__SFT_FILE_STATUS_PHASE_DOWNLOADED,
+            context, ( NULL != download ) ? download->file_desc : NULL,
+            XI_CONTROL_MESSAGE__SFT_FILE_STATUS_PHASE_DOWNLOADED,
             XI_CONTROL_MESSAGE__SFT_FILE_STATUS_CODE_ERROR__URLDL_FAILED );
 
-        if ( 0 != context->update_current_file->flag_mqtt_download_also_supported )
+        if ( NULL != download &&
+             0 != download->file_desc->flag_mqtt_download_also_supported )
         {
             /* fallback to MQTT: starting the internal MQTT file download process */
-            _xi_sft_send_file_get_chunk( context, 0,
-                                         context->update_current_file->size_in_bytes );
+            _xi_sft_start_mqtt_download( context, download );
+        }
+        else
+        {
+            /* package download stops here */
+            _xi_sft_abandon_package_download( context );
         }
     }
 
@@ -11,33 +11,102 @@
 #include <xi_bsp_io_fs.h>
 #include <xi_bsp_fwu.h>
 #include <xi_fs_bsp_to_xi_mapping.h>
+#include <xi_macros.h>
+#include <xi_list.h>
+#include <xi_sft_logic_internal_methods.h>
+
+static void _xi_sft_checksum_update_in_order( xi_sft_file_download_t* download,
+                                              uint32_t offset,
+                                              const uint8_t* chunk,
+                                              uint32_t length )
+{
+    const uint32_t checksum_offset = download->chunk_window.checksum_offset;
+
+    /* only the part past the frontier is new for the checksum */
+    if ( offset + length <= checksum_offset )
+    {
+        return;
+    }
+
+    xi_bsp_fwu_checksum_update( download->checksum_context,
+                                chunk + ( checksum_offset - offset ),
+                                offset + length - checksum_offset );
+
+    download->chunk_window.checksum_offset = offset + length;
+}
+
+static xi_state_t _xi_sft_store_pending_chunk( xi_sft_file_download_t* download,
+                                               xi_control_message_t* sft_message_in )
+{
+    xi_state_t state = XI_STATE_OK;
+
+    XI_ALLOC( xi_sft_pending_chunk_t, pending_chunk, state );
+
+    pending_chunk->offset = sft_message_in->file_chunk.offset;
+    pending_chunk->length = sft_message_in->file_chunk.length;
+
+    if ( 0 != sft_message_in->file_chunk.flag_chunk_borrowed )
+    {
+        /* the chunk lives in the MQTT payload which is gone once the message is
+         * processed, the out of order ones have to be copied */
+        if ( 0 < pending_chunk->length )
+        {
+            XI_ALLOC_BUFFER_AT( uint8_t, pending_chunk->chunk, pending_chunk->length,
+                                state );
+            memcpy( pending_chunk->chunk, sft_message_in->file_chunk.chunk,
+                    pending_chunk->length );
+        }
+    }
+    else
+    {
+        /* passing memory ownership */
+        pending_chunk->chunk             = sft_message_in->file_chunk.chunk;
+        sft_message_in->file_chunk.chunk = NULL;
+    }
+
+    /* keep the list ordered by offset so the frontier only has to look at its head */
+    xi_sft_pending_chunk_t** it = &download->chunk_window.pending_chunks;
+    while ( NULL != *it && ( *it )->offset < pending_chunk->offset )
+    {
+        it = &( *it )->__next;
+    }
+
+    pending_chunk->__next = *it;
+    *it                   = pending_chunk;
+
+    return state;
+
+err_handling:
+    XI_SAFE_FREE( pending_chunk );
+    return state;
+}
 
 xi_control_message__sft_file_status_code_t
-xi_sft_on_message_file_chunk_process_file_chunk( xi_sft_context_t* context,
+xi_sft_on_message_file_chunk_process_file_chunk( xi_sft_file_download_t* download,
                                                  xi_control_message_t* sft_message_in )
 {
     xi_state_t state = XI_STATE_OK;
 
-    /* at first chunk open file */
-    if ( 0 == sft_message_in->file_chunk.offset )
+    /* chunks of a window may arrive in any order, the first one opens the file */
+    if ( XI_BSP_IO_FS_INVALID_RESOURCE_HANDLE == download->file_handle )
     {
         state = xi_fs_bsp_io_fs_2_xi_state( xi_bsp_io_fs_open(
-            sft_message_in->file_chunk.name, context->update_current_file->size_in_bytes,
-            XI_BSP_IO_FS_OPEN_WRITE, &context->update_file_handle ) );
+            sft_message_in->file_chunk.name, download->file_desc->size_in_bytes,
+            XI_BSP_IO_FS_OPEN_WRITE, &download->file_handle ) );
 
         if ( XI_STATE_OK != state )
         {
             return XI_CONTROL_MESSAGE__SFT_FILE_STATUS_CODE_ERROR__FILE_OPEN;
         }
 
-        xi_bsp_fwu_checksum_init( &context->checksum_context );
+        xi_bsp_fwu_checksum_init( &download->checksum_context );
     }
 
-    /* write bytes through FILE BSP */
+    /* write bytes through FILE BSP, the offset of the chunk addresses the file */
     size_t bytes_written = 0;
 
     state = xi_fs_bsp_io_fs_2_xi_state(
-        xi_bsp_io_fs_write( context->update_file_handle, sft_message_in->file_chunk.chunk,
+        xi_bsp_io_fs_write( download->file_handle, sft_message_in->file_chunk.chunk,
                             sft_message_in->file_chunk.length,
                             sft_message_in->file_chunk.offset, &bytes_written ) );
 
@@ -46,18 +115,52 @@ xi_sft_on_message_file_chunk_process_file_chunk( xi_sft_context_t* context,
         return XI_CONTROL_MESSAGE__SFT_FILE_STATUS_CODE_ERROR__FILE_WRITE;
     }
 
-    xi_bsp_fwu_checksum_update( context->checksum_context,
-                                sft_message_in->file_chunk.chunk,
-                                sft_message_in->file_chunk.length );
+    /* the checksum has to be calculated in file order, chunks arriving ahead of the
+     * frontier wait in the pending list */
+    if ( sft_message_in->file_chunk.offset > download->chunk_window.checksum_offset )
+    {
+        state = _xi_sft_store_pending_chunk( download, sft_message_in );
+
+        return ( XI_STATE_OK == state )
+                   ? XI_CONTROL_MESSAGE__SFT_FILE_STATUS_CODE_SUCCESS
+                   : XI_CONTROL_MESSAGE__SFT_FILE_STATUS_CODE_ERROR__FILE_WRITE;
+    }
+
+    _xi_sft_checksum_update_in_order( download, sft_message_in->file_chunk.offset,
+                                      sft_message_in->file_chunk.chunk,
+                                      sft_message_in->file_chunk.length );
+
+    /* move the frontier over the pending chunks it has reached */
+    xi_sft_pending_chunk_t* pending_chunk = NULL;
+
+    while ( NULL != download->chunk_window.pending_chunks &&
+            download->chunk_window.pending_chunks->offset <=
+                download->chunk_window.checksum_offset )
+    {
+        XI_LIST_POP( xi_sft_pending_chunk_t, download->chunk_window.pending_chunks,
+                     pending_chunk );
+
+        _xi_sft_checksum_update_in_order( download, pending_chunk->offset,
+                                          pending_chunk->chunk, pending_chunk->length );
+
+        XI_SAFE_FREE( pending_chunk->chunk );
+        XI_SAFE_FREE( pending_chunk );
+    }
+
+    if ( XI_SFT_DOWNLOAD_PROGRESS_INTERVAL <= download->chunk_window.checksum_offset -
+                                                  download->chunk_window.progress_offset )
+    {
+        _xi_sft_save_download_progress( download );
+    }
 
     return XI_CONTROL_MESSAGE__SFT_FILE_STATUS_CODE_SUCCESS;
 }
 
 xi_control_message__sft_file_status_code_t
-xi_sft_on_message_file_chunk_checksum_final( xi_sft_context_t* context )
+xi_sft_on_message_file_chunk_checksum_final( xi_sft_file_download_t* download )
 {
-    if ( NULL == context || NULL == context->update_current_file ||
-         NULL == context->checksum_context )
+    if ( NULL == download || NULL == download->file_desc ||
+         NULL == download->checksum_context )
     {
         return XI_CONTROL_MESSAGE__SFT_FILE_STATUS_CODE_ERROR__FILE_CHECKSUM_MISMATCH;
     }
@@ -65,14 +168,13 @@ xi_sft_on_message_file_chunk_checksum_final( xi_sft_context_t* context )
     uint8_t* locally_calculated_fingerprint     = NULL;
     uint16_t locally_calculated_fingerprint_len = 0;
 
-    xi_bsp_fwu_checksum_final( &context->checksum_context,
+    xi_bsp_fwu_checksum_final( &download->checksum_context,
                                &locally_calculated_fingerprint,
                                &locally_calculated_fingerprint_len );
 
     /* integrity check based on checksum values */
-    if ( context->update_current_file->fingerprint_len !=
-             locally_calculated_fingerprint_len ||
-         0 != memcmp( context->update_current_file->fingerprint,
+    if ( download->file_desc->fingerprint_len != locally_calculated_fingerprint_len ||
+         0 != memcmp( download->file_desc->fingerprint,
                       locally_calculated_fingerprint,
                       locally_calculated_fingerprint_len ) )
     {
@@ -11,10 +11,10 @@
 #include <xi_control_message.h>
 
 xi_control_message__sft_file_status_code_t
-xi_sft_on_message_file_chunk_process_file_chunk( xi_sft_context_t* context,
+xi_sft_on_message_file_chunk_process_file_chunk( xi_sft_file_download_t* download,
                                                  xi_control_message_t* sft_message_in );
 
 xi_control_message__sft_file_status_code_t
-xi_sft_on_message_file_chunk_checksum_final( xi_sft_context_t* context );
+xi_sft_on_message_file_chunk_checksum_final( xi_sft_file_download_t* download );
 
 #endif /* __XI_SFT_LOGIC_FILE_CHUNK_HANDLERS_H__ */
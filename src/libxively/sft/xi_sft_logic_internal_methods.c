@@ -11,8 +11,12 @@
 #include <xi_bsp_fwu.h>
 #include <xi_sft_logic_application_callback.h>
 #include <xi_debug.h>
+#include <xi_list.h>
+#include <xi_bsp_io_fs.h>
+#include <xi_fs_bsp_to_xi_mapping.h>
 
 #include <stdio.h>
+#include <string.h>
 
 void _xi_sft_send_file_status( const xi_sft_context_t* context,
                                const xi_control_message_file_desc_ext_t* file_desc_ext,
@@ -34,54 +38,497 @@ void _xi_sft_send_file_status( const xi_sft_context_t* context,
 }
 
 void _xi_sft_send_file_get_chunk( xi_sft_context_t* context,
+                                  const xi_control_message_file_desc_ext_t* file_desc_ext,
                                   uint32_t offset,
                                   uint32_t length )
 {
     if ( NULL != context && NULL != context->fn_send_message &&
-         NULL != context->update_current_file )
+         ( NULL != file_desc_ext || NULL != context->update_current_file ) )
     {
         xi_control_message_t* message_file_get_chunk =
             xi_control_message_create_file_get_chunk(
-                context->update_current_file->name,
-                context->update_current_file->revision, offset,
-                XI_MIN( XI_SFT_FILE_CHUNK_SIZE, length ) );
+                file_desc_ext ? file_desc_ext->name : context->update_current_file->name,
+                file_desc_ext ? file_desc_ext->revision
+                              : context->update_current_file->revision,
+                offset, length );
 
         ( *context->fn_send_message )( context->send_message_user_data,
                                        message_file_get_chunk );
     }
 }
 
-static void _xi_sft_download_current_file( xi_sft_context_t* context )
+xi_sft_file_download_t* _xi_sft_find_file_download( xi_sft_context_t* context,
+                                                    const char* name )
+{
+    if ( NULL == context || NULL == name )
+    {
+        return NULL;
+    }
+
+    uint16_t id_download = 0;
+
+    for ( ; id_download < XI_SFT_PARALLEL_DOWNLOADS_MAX; ++id_download )
+    {
+        xi_sft_file_download_t* download = &context->downloads[id_download];
+
+        if ( NULL != download->file_desc && NULL != download->file_desc->name &&
+             0 == strcmp( download->file_desc->name, name ) )
+        {
+            return download;
+        }
+    }
+
+    return NULL;
+}
+
+static xi_sft_file_download_t* _xi_sft_find_free_file_download( xi_sft_context_t* context )
+{
+    uint16_t id_download = 0;
+
+    for ( ; id_download < XI_SFT_PARALLEL_DOWNLOADS_MAX; ++id_download )
+    {
+        if ( NULL == context->downloads[id_download].file_desc )
+        {
+            return &context->downloads[id_download];
+        }
+    }
+
+    return NULL;
+}
+
+static uint16_t _xi_sft_count_file_downloads( const xi_sft_context_t* context )
+{
+    uint16_t count       = 0;
+    uint16_t id_download = 0;
+
+    for ( ; id_download < XI_SFT_PARALLEL_DOWNLOADS_MAX; ++id_download )
+    {
+        if ( NULL != context->downloads[id_download].file_desc )
+        {
+            ++count;
+        }
+    }
+
+    return count;
+}
+
+/* bytes requested but not arrived yet plus bytes arrived but waiting for the checksum,
+ * over all of the downloads */
+static uint32_t _xi_sft_download_memory_in_use( const xi_sft_context_t* context )
+{
+    uint32_t memory_in_use = 0;
+    uint16_t id_download   = 0;
+
+    for ( ; id_download < XI_SFT_PARALLEL_DOWNLOADS_MAX; ++id_download )
+    {
+        const xi_sft_chunk_window_t* window = &context->downloads[id_download].chunk_window;
+        const xi_sft_pending_chunk_t* pending_chunk = window->pending_chunks;
+        uint16_t id_request                         = 0;
+
+        for ( ; id_request < XI_SFT_FILE_CHUNK_WINDOW_MAX; ++id_request )
+        {
+            memory_in_use += window->requests[id_request].length;
+        }
+
+        for ( ; NULL != pending_chunk; pending_chunk = pending_chunk->__next )
+        {
+            memory_in_use += pending_chunk->length;
+        }
+    }
+
+    return memory_in_use;
+}
+
+static uint8_t _xi_sft_request_file_chunk( xi_sft_context_t* context,
+                                           xi_sft_file_download_t* download,
+                                           uint32_t offset,
+                                           uint32_t length )
+{
+    xi_sft_chunk_window_t* window = &download->chunk_window;
+    uint16_t id_request           = 0;
+
+    for ( ; id_request < XI_SFT_FILE_CHUNK_WINDOW_MAX; ++id_request )
+    {
+        if ( 0 == window->requests[id_request].length )
+        {
+            window->requests[id_request] = ( xi_sft_chunk_request_t ){offset, length};
+            ++window->requests_in_flight;
+
+            _xi_sft_send_file_get_chunk( context, download->file_desc, offset, length );
+
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/* sends the next FILE_GET_CHUNK of the download if its window and the memory budget
+ * let it, returns 1 if a request was sent */
+static uint8_t _xi_sft_request_next_file_chunk( xi_sft_context_t* context,
+                                                xi_sft_file_download_t* download )
+{
+    xi_sft_chunk_window_t* window = &download->chunk_window;
+    const uint32_t file_size      = download->file_desc->size_in_bytes;
+
+    /* slow start: a single request is outstanding until the first chunk arrives, a
+     * service answering with something else than FILE_CHUNK won't get flooded */
+    const uint16_t window_size =
+        ( 0 == window->checksum_offset && NULL == window->pending_chunks )
+            ? 1
+            : context->chunk_window_size;
+
+    if ( window_size <= window->requests_in_flight || file_size <= window->request_offset )
+    {
+        return 0;
+    }
+
+    const uint32_t length = XI_MIN( context->chunk_size, file_size - window->request_offset );
+    const uint32_t memory_in_use = _xi_sft_download_memory_in_use( context );
+
+    /* the budget may be smaller than a chunk, a single request is always allowed */
+    if ( 0 != memory_in_use && context->download_memory_budget < memory_in_use + length )
+    {
+        return 0;
+    }
+
+    if ( 0 == _xi_sft_request_file_chunk( context, download, window->request_offset,
+                                          length ) )
+    {
+        return 0;
+    }
+
+    window->request_offset += length;
+
+    return 1;
+}
+
+void _xi_sft_fill_chunk_windows( xi_sft_context_t* context )
+{
+    if ( NULL == context )
+    {
+        return;
+    }
+
+    uint8_t request_sent = 1;
+
+    /* one request per download in a round so the downloads share the memory budget */
+    while ( 0 != request_sent )
+    {
+        request_sent         = 0;
+        uint16_t id_download = 0;
+
+        for ( ; id_download < XI_SFT_PARALLEL_DOWNLOADS_MAX; ++id_download )
+        {
+            xi_sft_file_download_t* download = &context->downloads[id_download];
+
+            if ( NULL != download->file_desc && 0 != download->flag_mqtt_download )
+            {
+                request_sent |= _xi_sft_request_next_file_chunk( context, download );
+            }
+        }
+    }
+}
+
+void _xi_sft_on_file_chunk_arrived( xi_sft_context_t* context,
+                                    xi_sft_file_download_t* download,
+                                    uint32_t offset,
+                                    uint32_t length )
+{
+    if ( NULL == context || NULL == download )
+    {
+        return;
+    }
+
+    xi_sft_chunk_window_t* window = &download->chunk_window;
+    uint16_t id_request           = 0;
+
+    for ( ; id_request < XI_SFT_FILE_CHUNK_WINDOW_MAX; ++id_request )
+    {
+        if ( 0 != window->requests[id_request].length &&
+             offset == window->requests[id_request].offset )
+        {
+            break;
+        }
+    }
+
+    /* duplicate or an answer to a request of an abandoned download */
+    if ( XI_SFT_FILE_CHUNK_WINDOW_MAX == id_request )
+    {
+        return;
+    }
+
+    const xi_sft_chunk_request_t request = window->requests[id_request];
+
+    window->requests[id_request].length = 0;
+    --window->requests_in_flight;
+
+    if ( 0 < length && length < request.length )
+    {
+        /* the service serves shorter chunks than requested: continue with its chunk
+         * size and ask again for the missing tail of this request */
+        context->chunk_size = XI_MIN( context->chunk_size, length );
+
+        _xi_sft_request_file_chunk( context, download, offset + length,
+                                    request.length - length );
+    }
+}
+
+void _xi_sft_reset_chunk_window( xi_sft_file_download_t* download )
 {
-    if ( NULL == context || NULL == context->update_current_file )
+    if ( NULL == download )
     {
         return;
     }
 
-    if ( 1 == xi_bsp_fwu_is_this_firmware( context->update_current_file->name ) )
+    if ( XI_BSP_IO_FS_INVALID_RESOURCE_HANDLE != download->file_handle )
     {
-        context->update_firmware = context->update_current_file;
+        xi_bsp_io_fs_close( download->file_handle );
+        download->file_handle = XI_BSP_IO_FS_INVALID_RESOURCE_HANDLE;
+    }
+
+    if ( NULL != download->checksum_context )
+    {
+        uint8_t* checksum_dropped     = NULL;
+        uint16_t checksum_dropped_len = 0;
+
+        xi_bsp_fwu_checksum_final( &download->checksum_context, &checksum_dropped,
+                                   &checksum_dropped_len );
+    }
+
+    xi_sft_pending_chunk_t* pending_chunk = NULL;
+
+    while ( NULL != download->chunk_window.pending_chunks )
+    {
+        XI_LIST_POP( xi_sft_pending_chunk_t, download->chunk_window.pending_chunks,
+                     pending_chunk );
+
+        XI_SAFE_FREE( pending_chunk->chunk );
+        XI_SAFE_FREE( pending_chunk );
+    }
+
+    memset( &download->chunk_window, 0, sizeof( xi_sft_chunk_window_t ) );
+}
+
+void _xi_sft_release_file_download( xi_sft_file_download_t* download )
+{
+    _xi_sft_reset_chunk_window( download );
+
+    if ( NULL != download )
+    {
+        download->file_desc          = NULL;
+        download->flag_mqtt_download = 0;
+    }
+}
+
+void _xi_sft_abandon_package_download( xi_sft_context_t* context )
+{
+    if ( NULL == context )
+    {
+        return;
+    }
+
+    uint16_t id_download = 0;
+
+    for ( ; id_download < XI_SFT_PARALLEL_DOWNLOADS_MAX; ++id_download )
+    {
+        _xi_sft_release_file_download( &context->downloads[id_download] );
+    }
+}
+
+/* The fs BSP has no flush, closing the file is the only way to get the written chunks
+ * out of the write buffer of the implementation before the progress points past them.
+ * The file is reopened for update, which doesn't truncate it. */
+static xi_state_t _xi_sft_flush_download_file( xi_sft_file_download_t* download )
+{
+    xi_state_t state = xi_fs_bsp_io_fs_2_xi_state(
+        xi_bsp_io_fs_close( download->file_handle ) );
+
+    download->file_handle = XI_BSP_IO_FS_INVALID_RESOURCE_HANDLE;
+    XI_CHECK_STATE( state );
+
+    state = xi_fs_bsp_io_fs_2_xi_state(
+        xi_bsp_io_fs_open( download->file_desc->name, download->file_desc->size_in_bytes,
+                           XI_BSP_IO_FS_OPEN_READ | XI_BSP_IO_FS_OPEN_WRITE,
+                           &download->file_handle ) );
+
+err_handling:
+    return state;
+}
+
+void _xi_sft_save_download_progress( xi_sft_file_download_t* download )
+{
+    if ( NULL == download || NULL == download->file_desc ||
+         XI_BSP_IO_FS_INVALID_RESOURCE_HANDLE == download->file_handle )
+    {
+        return;
+    }
+
+    xi_sft_chunk_window_t* window = &download->chunk_window;
+
+    /* nothing new since the last save or the file is complete, the latter is handled
+     * by the checksum validation */
+    if ( window->progress_offset == window->checksum_offset ||
+         download->file_desc->size_in_bytes <= window->checksum_offset )
+    {
+        return;
+    }
+
+    /* the saved progress must never point past the data that reached the file */
+    if ( XI_STATE_OK != _xi_sft_flush_download_file( download ) )
+    {
+        return;
+    }
+
+    if ( XI_STATE_OK ==
+         xi_sft_revision_set_download_progress( download->file_desc->name,
+                                                download->file_desc->revision,
+                                                download->file_desc->size_in_bytes,
+                                                window->checksum_offset ) )
+    {
+        window->progress_offset = window->checksum_offset;
+    }
+}
+
+void _xi_sft_save_download_progresses( xi_sft_context_t* context )
+{
+    if ( NULL == context )
+    {
+        return;
+    }
+
+    uint16_t id_download = 0;
+
+    for ( ; id_download < XI_SFT_PARALLEL_DOWNLOADS_MAX; ++id_download )
+    {
+        _xi_sft_save_download_progress( &context->downloads[id_download] );
+    }
+}
+
+/* Reopens the partially downloaded file and feeds its saved part into a new checksum
+ * context, the BSP checksum API offers no way to store the checksum state itself. */
+static void _xi_sft_resume_download( xi_sft_file_download_t* download )
+{
+    const xi_control_message_file_desc_ext_t* file_desc = download->file_desc;
+    xi_sft_chunk_window_t* window                       = &download->chunk_window;
+
+    char* revision         = NULL;
+    uint32_t size_in_bytes = 0;
+    uint32_t offset        = 0;
+    uint32_t read_offset   = 0;
+
+    xi_state_t state = xi_sft_revision_get_download_progress(
+        file_desc->name, &revision, &size_in_bytes, &offset );
+
+    if ( XI_STATE_OK != state )
+    {
+        /* no download to continue */
+        return;
+    }
+
+    XI_CHECK_CND( 0 != strcmp( revision, file_desc->revision ) ||
+                      size_in_bytes != file_desc->size_in_bytes || 0 == offset ||
+                      size_in_bytes <= offset,
+                  XI_ELEMENT_NOT_FOUND, state );
+
+    /* read and write without truncating the file */
+    state = xi_fs_bsp_io_fs_2_xi_state(
+        xi_bsp_io_fs_open( file_desc->name, file_desc->size_in_bytes,
+                           XI_BSP_IO_FS_OPEN_READ | XI_BSP_IO_FS_OPEN_WRITE,
+                           &download->file_handle ) );
+    XI_CHECK_STATE( state );
+
+    xi_bsp_fwu_checksum_init( &download->checksum_context );
+
+    while ( read_offset < offset )
+    {
+        const uint8_t* buffer = NULL;
+        size_t buffer_size    = 0;
+
+        state = xi_fs_bsp_io_fs_2_xi_state( xi_bsp_io_fs_read(
+            download->file_handle, read_offset, &buffer, &buffer_size ) );
+        XI_CHECK_STATE( state );
+        XI_CHECK_CND( 0 == buffer_size, XI_FS_READ_ERROR, state );
+
+        buffer_size = XI_MIN( buffer_size, offset - read_offset );
+
+        xi_bsp_fwu_checksum_update( download->checksum_context, buffer, buffer_size );
+
+        read_offset += buffer_size;
+    }
+
+    window->request_offset  = offset;
+    window->checksum_offset = offset;
+    window->progress_offset = offset;
+
+    xi_debug_format( "continuing download of [%s] from offset %lu", file_desc->name,
+                     ( unsigned long )offset );
+
+    XI_SAFE_FREE( revision );
+
+    return;
+
+err_handling:
+
+    /* stale or unusable progress, the download starts over */
+    _xi_sft_reset_chunk_window( download );
+    xi_sft_revision_remove_download_progress( file_desc->name );
+
+    XI_SAFE_FREE( revision );
+}
+
+void _xi_sft_start_mqtt_download( xi_sft_context_t* context,
+                                  xi_sft_file_download_t* download )
+{
+    if ( NULL == context || NULL == download || NULL == download->file_desc )
+    {
+        return;
+    }
+
+    _xi_sft_reset_chunk_window( download );
+
+    download->flag_mqtt_download = 1;
+
+    if ( 0 == download->file_desc->size_in_bytes )
+    {
+        /* an empty file still needs its single, empty FILE_CHUNK */
+        _xi_sft_send_file_get_chunk( context, download->file_desc, 0, 0 );
+    }
+    else
+    {
+        _xi_sft_resume_download( download );
+        _xi_sft_fill_chunk_windows( context );
+    }
+}
+
+/* starts the download of the file assigned to the slot, returns 0 if the file can't be
+ * downloaded at all */
+static uint8_t
+_xi_sft_download_file( xi_sft_context_t* context, xi_sft_file_download_t* download )
+{
+    const xi_control_message_file_desc_ext_t* file_desc = download->file_desc;
+
+    if ( 1 == xi_bsp_fwu_is_this_firmware( file_desc->name ) )
+    {
+        context->update_firmware = file_desc;
     }
 
     uint8_t download_started_by_callback = 0;
 
     /* decide how to download the file, if external function and URL are available,
        then try to download with these */
-    if ( NULL != context->update_current_file->download_link &&
-         NULL != context->sft_url_handler_callback )
+    if ( NULL != file_desc->download_link && NULL != context->sft_url_handler_callback )
     {
         /* trying to use an application provided callback to download the file */
         download_started_by_callback = ( *context->sft_url_handler_callback )(
-            context->update_current_file->download_link,
-            context->update_current_file->name, context->update_current_file->fingerprint,
-            context->update_current_file->fingerprint_len,
-            context->update_current_file->flag_mqtt_download_also_supported,
+            file_desc->download_link, file_desc->name, file_desc->fingerprint,
+            file_desc->fingerprint_len, file_desc->flag_mqtt_download_also_supported,
             xi_sft_on_file_downloaded_application_callback, context );
 
         if ( 0 == download_started_by_callback )
         {
             _xi_sft_send_file_status(
-                context, NULL, XI_CONTROL_MESSAGE__SFT_FILE_STATUS_PHASE_DOWNLOADING,
+                context, file_desc, XI_CONTROL_MESSAGE__SFT_FILE_STATUS_PHASE_DOWNLOADING,
                 XI_CONTROL_MESSAGE__SFT_FILE_STATUS_CODE_ERROR__URLDL_REJECTED );
         }
     }
@@ -91,42 +538,46 @@ static void _xi_sft_download_current_file( xi_sft_context_t* context )
     {
         /* external URL download started successfully: report the DOWNLOADING phase
            to SFT service, since non-MQTT downloads aren't detected by SFT service */
-        _xi_sft_send_file_status( context, NULL,
+        _xi_sft_send_file_status( context, file_desc,
                                   XI_CONTROL_MESSAGE__SFT_FILE_STATUS_PHASE_DOWNLOADING,
                                   XI_CONTROL_MESSAGE__SFT_FILE_STATUS_CODE_SUCCESS );
     }
-    else if ( NULL == context->update_current_file->download_link ||
-              0 != context->update_current_file->flag_mqtt_download_also_supported )
+    else if ( NULL == file_desc->download_link ||
+              0 != file_desc->flag_mqtt_download_also_supported )
     {
         /* external URL download failed to start: fallback on the internal MQTT file
          * download */
-        _xi_sft_send_file_get_chunk( context, 0,
-                                     context->update_current_file->size_in_bytes );
+        _xi_sft_start_mqtt_download( context, download );
     }
+    else
+    {
+        return 0;
+    }
+
+    return 1;
 }
 
-void _xi_sft_current_file_revision_handling( xi_sft_context_t* context )
+void _xi_sft_file_revision_handling( xi_sft_context_t* context,
+                                     const xi_control_message_file_desc_ext_t* file_desc )
 {
-    if ( NULL == context || NULL == context->update_current_file )
+    if ( NULL == context || NULL == file_desc )
     {
         return;
     }
 
-    if ( context->update_firmware != context->update_current_file )
+    if ( context->update_firmware != file_desc )
     {
         /* handling non-firmware files */
-        _xi_sft_send_file_status( context, NULL,
+        _xi_sft_send_file_status( context, file_desc,
                                   XI_CONTROL_MESSAGE__SFT_FILE_STATUS_PHASE_FINISHED,
                                   XI_CONTROL_MESSAGE__SFT_FILE_STATUS_CODE_SUCCESS );
 
-        xi_sft_revision_set( context->update_current_file->name,
-                             context->update_current_file->revision );
+        xi_sft_revision_set( file_desc->name, file_desc->revision );
     }
     else
     {
         /* handling firmware file(s) */
-        xi_sft_revision_set_firmware_update( context->update_current_file->name,
-                                             context->update_current_file->revision );
+        xi_sft_revision_set_firmware_update( file_desc->name, file_desc->revision );
     }
 }
 
@@ -137,14 +588,34 @@ void _xi_sft_continue_package_download( xi_sft_context_t* context )
         return;
     }
 
-    const xi_state_t state = _xi_sft_select_next_resource_to_download( context );
-    XI_CHECK_STATE( state );
+    xi_state_t state = XI_STATE_OK;
 
-    if ( NULL != context->update_current_file )
+    /* start new downloads while there is a free slot and the memory budget has room */
+    while ( _xi_sft_count_file_downloads( context ) < context->parallel_downloads &&
+            _xi_sft_download_memory_in_use( context ) < context->download_memory_budget )
     {
-        _xi_sft_download_current_file( context );
+        xi_sft_file_download_t* download = _xi_sft_find_free_file_download( context );
+
+        state = _xi_sft_select_next_resource_to_download( context );
+        XI_CHECK_STATE( state );
+
+        if ( NULL == context->update_current_file )
+        {
+            break;
+        }
+
+        download->file_desc = context->update_current_file;
+
+        if ( 0 == _xi_sft_download_file( context, download ) )
+        {
+            /* package download stops here */
+            _xi_sft_abandon_package_download( context );
+            return;
+        }
     }
-    else
+
+    if ( NULL == context->update_current_file &&
+         0 == _xi_sft_count_file_downloads( context ) )
     {
         /* finished with package download */
         if ( NULL != context->update_firmware )
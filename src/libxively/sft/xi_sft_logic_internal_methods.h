@@ -16,10 +16,45 @@ void _xi_sft_send_file_status( const xi_sft_context_t* context,
                                xi_control_message__sft_file_status_code_t code );
 
 void _xi_sft_send_file_get_chunk( xi_sft_context_t* context,
+                                  const xi_control_message_file_desc_ext_t* file_desc_ext,
                                   uint32_t offset,
                                   uint32_t length );
 
-void _xi_sft_current_file_revision_handling( xi_sft_context_t* context );
+/* returns the download of the named file or NULL if the file isn't under download */
+xi_sft_file_download_t* _xi_sft_find_file_download( xi_sft_context_t* context,
+                                                    const char* name );
+
+/* starts the FILE_GET_CHUNK flow of the file, continues a download saved by
+ * _xi_sft_save_download_progress if there is one for the same revision */
+void _xi_sft_start_mqtt_download( xi_sft_context_t* context,
+                                  xi_sft_file_download_t* download );
+
+/* keeps the windows of outstanding FILE_GET_CHUNK requests full within the memory
+ * budget */
+void _xi_sft_fill_chunk_windows( xi_sft_context_t* context );
+
+/* retires the request answered by a FILE_CHUNK, re-requests the tail of a short one */
+void _xi_sft_on_file_chunk_arrived( xi_sft_context_t* context,
+                                    xi_sft_file_download_t* download,
+                                    uint32_t offset,
+                                    uint32_t length );
+
+/* saves how far the file is downloaded so that a later context can continue */
+void _xi_sft_save_download_progress( xi_sft_file_download_t* download );
+
+void _xi_sft_save_download_progresses( xi_sft_context_t* context );
+
+/* abandons the MQTT download state: closes the file, drops checksum and pending chunks */
+void _xi_sft_reset_chunk_window( xi_sft_file_download_t* download );
+
+/* resets the download and frees its slot */
+void _xi_sft_release_file_download( xi_sft_file_download_t* download );
+
+/* releases every download, no further file of the package is started */
+void _xi_sft_abandon_package_download( xi_sft_context_t* context );
+
+void _xi_sft_file_revision_handling( xi_sft_context_t* context,
+                                     const xi_control_message_file_desc_ext_t* file_desc );
 
 void _xi_sft_continue_package_download( xi_sft_context_t* context );
 
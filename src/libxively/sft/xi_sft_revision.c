@@ -11,12 +11,17 @@
 #include <xi_helpers.h>
 #include <xi_macros.h>
 
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <xi_fs_bsp_to_xi_mapping.h>
 
 #define XI_SFT_REVISION_RESOURCENAME( resource_name )                                    \
     xi_str_cat( resource_name, ".xirev" )
 
+#define XI_SFT_REVISION_DOWNLOAD_PROGRESS_RESOURCENAME( resource_name )                  \
+    xi_str_cat( resource_name, ".xiprog" )
+
 static xi_state_t
 _xi_sft_revision_write_string_to_file( const char* const resource_name,
                                        const char* const string_to_write )
@@ -112,6 +117,99 @@ xi_state_t xi_sft_revision_get( const char* const resource_name, char** revision
     return state;
 }
 
+xi_state_t xi_sft_revision_set_download_progress( const char* const resource_name,
+                                                  const char* const revision,
+                                                  uint32_t size_in_bytes,
+                                                  uint32_t offset )
+{
+    if ( NULL == resource_name || NULL == revision )
+    {
+        return XI_INVALID_PARAMETER;
+    }
+
+    xi_state_t state                      = XI_STATE_OK;
+    char* resource_name_download_progress = NULL;
+
+    XI_ALLOC_BUFFER( char, download_progress_data,
+                     strlen( revision ) + 2 * 10 /* two 32 bit decimals */ +
+                         3 /* two newlines + trailing zero */,
+                     state );
+
+    sprintf( download_progress_data, "%s\n%lu\n%lu", revision,
+             ( unsigned long )size_in_bytes, ( unsigned long )offset );
+
+    resource_name_download_progress =
+        XI_SFT_REVISION_DOWNLOAD_PROGRESS_RESOURCENAME( resource_name );
+
+    state = _xi_sft_revision_write_string_to_file( resource_name_download_progress,
+                                                   download_progress_data );
+
+err_handling:
+
+    XI_SAFE_FREE( resource_name_download_progress );
+    XI_SAFE_FREE( download_progress_data );
+
+    return state;
+}
+
+xi_state_t xi_sft_revision_get_download_progress( const char* const resource_name,
+                                                  char** revision_out,
+                                                  uint32_t* size_in_bytes_out,
+                                                  uint32_t* offset_out )
+{
+    if ( NULL == resource_name || NULL == revision_out || NULL != *revision_out ||
+         NULL == size_in_bytes_out || NULL == offset_out )
+    {
+        return XI_INVALID_PARAMETER;
+    }
+
+    char* resource_name_download_progress =
+        XI_SFT_REVISION_DOWNLOAD_PROGRESS_RESOURCENAME( resource_name );
+
+    xi_state_t state = _xi_sft_revision_read_string_from_file(
+        resource_name_download_progress, revision_out );
+
+    XI_CHECK_STATE( state );
+
+    /* layout: revision, size and offset separated by newlines */
+    char* size_in_bytes = strchr( *revision_out, '\n' );
+    XI_CHECK_CND( NULL == size_in_bytes, XI_ELEMENT_NOT_FOUND, state );
+
+    char* offset = strchr( size_in_bytes + 1, '\n' );
+    XI_CHECK_CND( NULL == offset, XI_ELEMENT_NOT_FOUND, state );
+
+    /* replace newlines with string terminator zeros */
+    *size_in_bytes++ = 0;
+    *offset++        = 0;
+
+    *size_in_bytes_out = ( uint32_t )strtoul( size_in_bytes, NULL, 10 );
+    *offset_out        = ( uint32_t )strtoul( offset, NULL, 10 );
+
+    XI_SAFE_FREE( resource_name_download_progress );
+
+    return state;
+
+err_handling:
+
+    XI_SAFE_FREE( *revision_out );
+    XI_SAFE_FREE( resource_name_download_progress );
+
+    return state;
+}
+
+xi_state_t xi_sft_revision_remove_download_progress( const char* const resource_name )
+{
+    char* resource_name_download_progress =
+        XI_SFT_REVISION_DOWNLOAD_PROGRESS_RESOURCENAME( resource_name );
+
+    const xi_state_t state = xi_fs_bsp_io_fs_2_xi_state(
+        xi_bsp_io_fs_remove( resource_name_download_progress ) );
+
+    XI_SAFE_FREE( resource_name_download_progress );
+
+    return state;
+}
+
 #define XI_SFT_REVISION_FIRMWAREUPDATEREVISION_MAILBOX_TO_NEXT_RUN                       \
     "firmware_update_revision.mailbox"
 
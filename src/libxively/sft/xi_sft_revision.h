@@ -8,12 +8,27 @@
 #define __XI_SFT_REVISION_H__
 
 #include <xively_error.h>
+#include <stdint.h>
 
 xi_state_t
 xi_sft_revision_set( const char* const resource_name, const char* const revision );
 
 xi_state_t xi_sft_revision_get( const char* const resource_name, char** revision_out );
 
+/* Download progress of a resource: the revision under download, its size and the
+ * offset up to which the resource is written and checksummed. Used to continue an
+ * interrupted download instead of starting it over. */
+xi_state_t xi_sft_revision_set_download_progress( const char* const resource_name,
+                                                  const char* const revision,
+                                                  uint32_t size_in_bytes,
+                                                  uint32_t offset );
+
+xi_state_t xi_sft_revision_get_download_progress( const char* const resource_name,
+                                                  char** revision_out,
+                                                  uint32_t* size_in_bytes_out,
+                                                  uint32_t* offset_out );
+
+xi_state_t xi_sft_revision_remove_download_progress( const char* const resource_name );
 
 xi_state_t
 xi_sft_revision_set_firmware_update( const char* const resource_name_xi_firmware,
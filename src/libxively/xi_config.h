@@ -31,18 +31,112 @@
 #define XI_CBOR_MESSAGE_MAX_BUFFER_SIZE XI_MQTT_MAX_PAYLOAD_SIZE
 #endif
 
+/* default number of layer to layer transitions executed back to back by a single
+ * xi_evtd_single_step without going through the event queue, 0 disables it */
+#ifndef XI_EVTD_DIRECT_CALL_DEPTH
+#define XI_EVTD_DIRECT_CALL_DEPTH 8
+#endif
+
+/* default number of handles xi_evtd_step runs from the event queue before it returns
+ * to the event loop, the rest waits for the next step, 0 means no limit */
+#ifndef XI_EVTD_STEP_BUDGET
+#define XI_EVTD_STEP_BUDGET 64
+#endif
+
+/* default time in milliseconds after which xi_evtd_step stops running the handles of
+ * the event queue, 0 means no limit */
+#ifndef XI_EVTD_STEP_TIME_SLICE_MS
+#define XI_EVTD_STEP_TIME_SLICE_MS 0
+#endif
+
+/* 1 makes the calls to the layers of the default types go through a switch generated
+ * at compile time instead of the function pointers of the layers */
+#ifndef XI_LAYER_CHAIN_STATIC
+#define XI_LAYER_CHAIN_STATIC 0
+#endif
+
+/* 1 measures the duration of every layer call with the monotonic clock of the BSP and
+ * fills the latency histograms of xi_stats_t.layers, 0 only counts the calls */
+#ifndef XI_STATS_LAYER_TIMING
+#define XI_STATS_LAYER_TIMING 0
+#endif
+
 #ifndef XI_SFT_FILE_CHUNK_SIZE
 #define XI_SFT_FILE_CHUNK_SIZE 1024
 #endif
 
+#ifndef XI_SFT_FILE_CHUNK_WINDOW
+#define XI_SFT_FILE_CHUNK_WINDOW 4
+#endif
+
+#ifndef XI_SFT_FILE_CHUNK_WINDOW_MAX
+#define XI_SFT_FILE_CHUNK_WINDOW_MAX 16
+#endif
+
+/* number of files of an SFT package downloaded at the same time */
+#ifndef XI_SFT_PARALLEL_DOWNLOADS
+#define XI_SFT_PARALLEL_DOWNLOADS 1
+#endif
+
+#ifndef XI_SFT_PARALLEL_DOWNLOADS_MAX
+#define XI_SFT_PARALLEL_DOWNLOADS_MAX 4
+#endif
+
+/* bytes requested and buffered at the same time by all of the SFT downloads */
+#ifndef XI_SFT_DOWNLOAD_MEMORY_BUDGET
+#define XI_SFT_DOWNLOAD_MEMORY_BUDGET                                                    \
+    ( XI_SFT_FILE_CHUNK_WINDOW_MAX * XI_SFT_FILE_CHUNK_SIZE )
+#endif
+
+/* number of downloaded bytes after which the SFT download progress is saved */
+#ifndef XI_SFT_DOWNLOAD_PROGRESS_INTERVAL
+#define XI_SFT_DOWNLOAD_PROGRESS_INTERVAL ( 16 * XI_SFT_FILE_CHUNK_SIZE )
+#endif
+
+/* seconds the event loop waits on the sockets if no time event is scheduled, -1 makes
+ * it wait for a socket event only. The periodic wakeup is what picks up the events
+ * scheduled by other threads, so -1 suits single threaded applications only. */
 #ifndef XI_DEFAULT_IDLE_TIMEOUT
 #define XI_DEFAULT_IDLE_TIMEOUT 1
 #endif
 
+/* the longest wait of the event loop in seconds, -1 for no limit */
 #ifndef XI_MAX_IDLE_TIMEOUT
 #define XI_MAX_IDLE_TIMEOUT 5
 #endif
 
+/* the event loop wakes up for a time event at the next multiple of this many seconds,
+ * so that the events scheduled close to each other are processed in one wakeup, 0
+ * wakes up at the exact time of each event */
+#ifndef XI_TIMER_SLACK
+#define XI_TIMER_SLACK 0
+#endif
+
+/* the signed index type of the vectors, it bounds the number of the time events and of
+ * the sockets the event dispatcher can hold, about 60 connected contexts with int8_t */
+#ifndef XI_VECTOR_INDEX_TYPE
+#define XI_VECTOR_INDEX_TYPE int8_t
+#endif
+
+#ifndef XI_PUBLISH_QUEUE_MAX_SPOOL_SIZE
+#define XI_PUBLISH_QUEUE_MAX_SPOOL_SIZE ( 1024 * 64 )
+#endif
+
+#ifndef XI_PUBLISH_QUEUE_DRAIN_INTERVAL
+#define XI_PUBLISH_QUEUE_DRAIN_INTERVAL 1
+#endif
+
+/* the session log is compacted once it is bigger than this and most of it is dead */
+#ifndef XI_SESSION_LOG_COMPACTION_THRESHOLD
+#define XI_SESSION_LOG_COMPACTION_THRESHOLD ( 1024 * 4 )
+#endif
+
+/* PINGREQs are sent up to keepalive timeout / XI_MQTT_KEEPALIVE_JITTER_DIVISOR earlier,
+ * chosen randomly per connection, 0 disables the jitter */
+#ifndef XI_MQTT_KEEPALIVE_JITTER_DIVISOR
+#define XI_MQTT_KEEPALIVE_JITTER_DIVISOR 4
+#endif
+
 #ifndef XI_MQTT_PORT
 #define XI_MQTT_PORT 8883
 /* note: usually port 1883 is used for insecure MQTT connections */
@@ -12,6 +12,7 @@
 #include "xi_types.h"
 #include "xi_backoff_status.h"
 #include "xi_timed_task.h"
+#include "xi_handle.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -23,11 +24,11 @@ extern "C" {
 typedef struct
 {
     uint32_t network_timeout;
-    uint8_t globals_ref_count;
+    uint32_t globals_ref_count;
     xi_evtd_instance_t* evtd_instance;
     xi_context_t* default_context;
     xi_context_handle_t default_context_handle;
-    xi_vector_t* context_handles_vector;
+    xi_handle_table_t* context_handles_vector;
     xi_timed_task_container_t* timed_tasks_container;
     struct xi_threadpool_s* main_threadpool;
     char* str_account_id;
@@ -5,79 +5,195 @@
  */
 
 #include "xi_handle.h"
+#include "xi_allocator.h"
+#include "xi_debug.h"
+#include "xi_macros.h"
 #include "xively_types.h"
 
+#define XI_HANDLE_INDEX_MASK XI_HANDLE_MAX_OBJECTS
+#define XI_HANDLE_GENERATION_MAX 0x7FFF /* keeps the handles positive */
+#define XI_HANDLE_TABLE_INITIAL_CAPACITY 4
+
 /* -----------------------------------------------------------------------
  *  INTERNAL FUNCTIONS
  * ----------------------------------------------------------------------- */
 
-static inline int8_t xi_compare_context_pointers( const union xi_vector_selector_u* e0,
-                                                  const union xi_vector_selector_u* e1 )
+static xi_handle_t xi_handle_make( uint16_t generation, uint32_t index )
 {
-    return e0->ptr_value == e1->ptr_value ? 0 : 1;
+    return ( xi_handle_t )( ( ( uint32_t )generation << XI_HANDLE_INDEX_BITS ) | index );
+}
+
+/**
+ * @brief xi_handle_slot returns the slot of a handle only if the handle is current
+ */
+static xi_handle_slot_t* xi_handle_slot( xi_handle_table_t* table, xi_handle_t handle )
+{
+    const uint32_t index = ( uint32_t )handle & XI_HANDLE_INDEX_MASK;
+
+    if ( 0 >= handle || table->slots_count <= index )
+    {
+        return NULL;
+    }
+
+    xi_handle_slot_t* slot = &table->slots[index];
+
+    if ( NULL == slot->object ||
+         slot->generation != ( ( uint32_t )handle >> XI_HANDLE_INDEX_BITS ) )
+    {
+        return NULL;
+    }
+
+    return slot;
+}
+
+static xi_state_t xi_handle_table_grow( xi_handle_table_t* table )
+{
+    const uint32_t new_capacity =
+        XI_MIN( XI_MAX( table->slots_capacity * 2, XI_HANDLE_TABLE_INITIAL_CAPACITY ),
+                table->max_objects );
+
+    const size_t slots_size = sizeof( xi_handle_slot_t ) * new_capacity;
+
+    /* the first slots are allocated, not every allocator reallocs a NULL pointer */
+    xi_handle_slot_t* slots = ( NULL == table->slots )
+                                  ? xi_alloc( slots_size )
+                                  : xi_realloc( table->slots, slots_size );
+
+    if ( NULL == slots )
+    {
+        return XI_OUT_OF_MEMORY;
+    }
+
+    table->slots          = slots;
+    table->slots_capacity = new_capacity;
+
+    return XI_STATE_OK;
 }
 
 /* -----------------------------------------------------------------------
  *  MAIN LIBRARY FUNCTIONS
  * ----------------------------------------------------------------------- */
 
-void* xi_object_for_handle( xi_vector_t* vector, xi_handle_t handle )
+xi_handle_table_t* xi_handle_table_create( uint32_t max_objects )
 {
-    assert( vector != NULL );
-    return xi_vector_get( vector, handle );
+    xi_state_t state = XI_STATE_OK;
+
+    assert( 0 < max_objects && XI_HANDLE_MAX_OBJECTS >= max_objects );
+
+    XI_ALLOC( xi_handle_table_t, table, state );
+
+    table->max_objects = max_objects;
+    table->first_free  = XI_HANDLE_MAX_OBJECTS;
+
+    return table;
+
+err_handling:
+    return NULL;
 }
 
-xi_state_t
-xi_find_handle_for_object( xi_vector_t* vector, const void* object, xi_handle_t* handle )
+void xi_handle_table_destroy( xi_handle_table_t** table )
 {
-    assert( vector != NULL );
-    xi_vector_index_type_t handler_index = xi_vector_find(
-        vector, XI_VEC_CONST_VALUE_PARAM( XI_VEC_VALUE_PTR( ( void* )object ) ),
-        xi_compare_context_pointers );
-    if ( handler_index < 0 )
+    if ( NULL == table || NULL == *table )
     {
-        *handle = XI_INVALID_CONTEXT_HANDLE;
-        return XI_ELEMENT_NOT_FOUND;
+        return;
     }
-    *handle = handler_index;
-    return XI_STATE_OK;
+
+    XI_SAFE_FREE( ( *table )->slots );
+    XI_SAFE_FREE( *table );
 }
 
-xi_state_t xi_delete_handle_for_object( xi_vector_t* vector, const void* object )
+void* xi_object_for_handle( xi_handle_table_t* table, xi_handle_t handle )
 {
-    assert( vector != NULL );
-    xi_vector_index_type_t handler_index = xi_vector_find(
-        vector, XI_VEC_CONST_VALUE_PARAM( XI_VEC_VALUE_PTR( ( void* )object ) ),
-        xi_compare_context_pointers );
+    assert( table != NULL );
+
+    const xi_handle_slot_t* slot = xi_handle_slot( table, handle );
 
-    if ( handler_index < 0 )
+    return ( NULL != slot ) ? slot->object : NULL;
+}
+
+xi_state_t xi_find_handle_for_object( xi_handle_table_t* table,
+                                      const void* object,
+                                      xi_handle_t* handle )
+{
+    assert( table != NULL );
+
+    uint32_t index = 0;
+
+    for ( ; NULL != object && index < table->slots_count; ++index )
+    {
+        if ( object == table->slots[index].object )
+        {
+            *handle = xi_handle_make( table->slots[index].generation, index );
+            return XI_STATE_OK;
+        }
+    }
+
+    *handle = XI_INVALID_CONTEXT_HANDLE;
+    return XI_ELEMENT_NOT_FOUND;
+}
+
+xi_state_t xi_delete_handle( xi_handle_table_t* table, xi_handle_t handle )
+{
+    assert( table != NULL );
+
+    xi_handle_slot_t* slot = xi_handle_slot( table, handle );
+
+    if ( NULL == slot )
     {
         return XI_ELEMENT_NOT_FOUND;
     }
-    vector->array[handler_index].selector_t.ptr_value = NULL;
+
+    slot->object     = NULL;
+    slot->generation = ( XI_HANDLE_GENERATION_MAX == slot->generation )
+                           ? 1
+                           : ( uint16_t )( slot->generation + 1 );
+    slot->next_free   = table->first_free;
+    table->first_free = ( uint16_t )( slot - table->slots );
+
+    table->objects_count -= 1;
+
     return XI_STATE_OK;
 }
 
-xi_state_t xi_register_handle_for_object( xi_vector_t* vector,
-                                          const int32_t max_object_cnt,
-                                          const void* object )
+xi_state_t xi_register_handle_for_object( xi_handle_table_t* table,
+                                          const void* object,
+                                          xi_handle_t* handle )
 {
-    assert( vector != NULL );
-    xi_vector_index_type_t handler_index =
-        xi_vector_find( vector, XI_VEC_CONST_VALUE_PARAM( XI_VEC_VALUE_PTR( NULL ) ),
-                        xi_compare_context_pointers );
-    if ( handler_index < 0 )
+    assert( table != NULL );
+    assert( object != NULL );
+
+    xi_state_t state       = XI_STATE_OK;
+    xi_handle_slot_t* slot = NULL;
+
+    if ( table->objects_count >= table->max_objects )
+    {
+        return XI_NO_MORE_RESOURCE_AVAILABLE;
+    }
+
+    if ( XI_HANDLE_MAX_OBJECTS != table->first_free )
+    {
+        slot              = &table->slots[table->first_free];
+        table->first_free = slot->next_free;
+    }
+    else
     {
-        if ( vector->elem_no >= max_object_cnt )
+        if ( table->slots_count == table->slots_capacity )
         {
-            return XI_NO_MORE_RESOURCE_AVAILABLE;
+            XI_CHECK_STATE( state = xi_handle_table_grow( table ) );
         }
-        xi_vector_push( vector,
-                        XI_VEC_CONST_VALUE_PARAM( XI_VEC_VALUE_PTR( ( void* )object ) ) );
+
+        slot             = &table->slots[table->slots_count++];
+        slot->generation = 1;
     }
-    else
+
+    slot->object = ( void* )object;
+    table->objects_count += 1;
+
+    if ( NULL != handle )
     {
-        vector->array[handler_index].selector_t.ptr_value = ( void* )object;
+        *handle = xi_handle_make( slot->generation, ( uint32_t )( slot - table->slots ) );
     }
-    return XI_STATE_OK;
+
+err_handling:
+    return state;
 }
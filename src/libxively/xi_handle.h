@@ -7,25 +7,63 @@
 #ifndef __XI_HANDLE_H__
 #define __XI_HANDLE_H__
 
-#include "xi_handle.h"
-#include "xi_vector.h"
+#include <stdint.h>
+
+#include "xively_error.h"
 
 /*-----------------------------------------------------------------------
  *  TYPEDEFS
  * ----------------------------------------------------------------------- */
 
+/* a handle is the index of its slot in the low bits and the generation of the slot in
+ * the high ones, a slot changes its generation each time it is freed so that the
+ * handles of the deleted objects are not mistaken for the ones reusing the slot */
 typedef int32_t xi_handle_t;
 
+#define XI_HANDLE_INDEX_BITS 16
+#define XI_HANDLE_MAX_OBJECTS ( ( 1 << XI_HANDLE_INDEX_BITS ) - 1 )
+
+typedef struct xi_handle_slot_s
+{
+    void* object;
+    uint16_t generation;
+    uint16_t next_free; /* index of the next free slot, valid if the slot is free */
+} xi_handle_slot_t;
+
+typedef struct xi_handle_table_s
+{
+    xi_handle_slot_t* slots;
+    uint32_t slots_capacity;
+    uint32_t slots_count; /* slots handed out at least once, the others are unused */
+    uint32_t objects_count;
+    uint32_t max_objects;
+    uint16_t first_free; /* XI_HANDLE_MAX_OBJECTS if no freed slot is waiting */
+} xi_handle_table_t;
+
 /*-----------------------------------------------------------------------
  *  PUBLIC FUNCTIONS
  * ----------------------------------------------------------------------- */
 
-void* xi_object_for_handle( xi_vector_t* vector, xi_handle_t handle );
-xi_state_t
-xi_find_handle_for_object( xi_vector_t* vector, const void* object, xi_handle_t* handle );
-xi_state_t xi_delete_handle_for_object( xi_vector_t* vector, const void* object );
-xi_state_t xi_register_handle_for_object( xi_vector_t* vector,
-                                          const int32_t max_object_cnt,
-                                          const void* object );
+/**
+ * @brief xi_handle_table_create creates an empty table, the slots are allocated as the
+ * objects are registered
+ *
+ * @param max_objects at most XI_HANDLE_MAX_OBJECTS
+ */
+xi_handle_table_t* xi_handle_table_create( uint32_t max_objects );
+void xi_handle_table_destroy( xi_handle_table_t** table );
+
+/* all of these are O(1) */
+void* xi_object_for_handle( xi_handle_table_t* table, xi_handle_t handle );
+xi_state_t xi_delete_handle( xi_handle_table_t* table, xi_handle_t handle );
+xi_state_t xi_register_handle_for_object( xi_handle_table_t* table,
+                                          const void* object,
+                                          xi_handle_t* handle );
+
+/* scans the whole table, the owners of the objects keep their handles instead on the
+ * hot paths */
+xi_state_t xi_find_handle_for_object( xi_handle_table_t* table,
+                                      const void* object,
+                                      xi_handle_t* handle );
 
 #endif /* __XI_HANDLE_H__ */
@@ -28,6 +28,10 @@ typedef struct xi_layer_s
     void* user_data;
     struct xi_context_data_s* context_data;
     xi_layer_state_t layer_state;
+#if XI_LAYER_CHAIN_STATIC
+    /* default type the layer_funcs belong to, called without the function pointers */
+    xi_layer_type_id_t static_type_id;
+#endif
 #if XI_DEBUG_EXTRA_INFO
     xi_layer_debug_info_t debug_info;
 #endif
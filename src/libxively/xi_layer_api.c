@@ -7,66 +7,174 @@
 #include "xi_config.h"
 #include "xi_layer_api.h"
 #include "xi_globals.h"
-#include "xi_event_thread_dispatcher.h"
+#include "xi_stats.h"
+#include "xi_bsp_time.h"
+
+#if XI_LAYER_CHAIN_STATIC
+#include "xi_layer_stack_funcs.h"
+#endif
 
 /**
  * @brief get_next_layer_state function that checks what should be the next
  * layer state according to some very simple rules related to which function on which
  * layer is being called
  *
- * @param func next function
+ * @param func_id next function
  * @param from_context layer's context from which we are moving
- * @param context target context of function invocation
  * @param state state in which the transition is happening
  * @return next layer state
  */
-static xi_layer_state_t get_next_layer_state( xi_layer_func_t* func,
+static xi_layer_state_t get_next_layer_state( xi_layer_func_id_t func_id,
                                               xi_layer_connectivity_t* from_context,
-                                              xi_layer_connectivity_t* context,
                                               xi_state_t state )
 {
-    if ( func == XI_THIS_LAYER( context )->layer_funcs->close )
+    switch ( func_id )
     {
-        if ( XI_THIS_LAYER_STATE( from_context ) == XI_LAYER_STATE_CONNECTED )
-        {
-            return XI_LAYER_STATE_CLOSING;
-        }
-        else
-        {
+        case XI_LAYER_FUNC_CLOSE:
+            if ( XI_THIS_LAYER_STATE( from_context ) == XI_LAYER_STATE_CONNECTED )
+            {
+                return XI_LAYER_STATE_CLOSING;
+            }
+            return XI_THIS_LAYER_STATE( from_context );
+        case XI_LAYER_FUNC_CLOSE_EXTERNALLY:
+            return XI_LAYER_STATE_CLOSED;
+        case XI_LAYER_FUNC_CONNECT:
+            return state == XI_STATE_OK ? XI_LAYER_STATE_CONNECTED
+                                        : XI_LAYER_STATE_CLOSED;
+        case XI_LAYER_FUNC_INIT:
+            return XI_LAYER_STATE_CONNECTING;
+        case XI_LAYER_FUNC_PULL:
+        case XI_LAYER_FUNC_PUSH:
+        case XI_LAYER_FUNC_POST_CONNECT:
             return XI_THIS_LAYER_STATE( from_context );
-        }
-    }
-    else if ( func == XI_THIS_LAYER( context )->layer_funcs->close_externally )
-    {
-        return XI_LAYER_STATE_CLOSED;
-    }
-    else if ( func == XI_THIS_LAYER( context )->layer_funcs->connect )
-    {
-        return state == XI_STATE_OK ? XI_LAYER_STATE_CONNECTED : XI_LAYER_STATE_CLOSED;
-    }
-    else if ( func == XI_THIS_LAYER( context )->layer_funcs->init )
-    {
-        return XI_LAYER_STATE_CONNECTING;
-    }
-    else if ( func == XI_THIS_LAYER( context )->layer_funcs->pull )
-    {
-        return XI_THIS_LAYER_STATE( from_context );
-    }
-    else if ( func == XI_THIS_LAYER( context )->layer_funcs->push )
-    {
-        return XI_THIS_LAYER_STATE( from_context );
     }
-    else if ( func == XI_THIS_LAYER( context )->layer_funcs->post_connect )
+
+    return XI_LAYER_STATE_NONE;
+}
+
+/**
+ * @brief xi_layer_call_clock returns the start of a layer call, the clock is read only
+ * if the library is built with XI_STATS_LAYER_TIMING
+ */
+static inline xi_time_t xi_layer_call_clock()
+{
+#if XI_STATS_LAYER_TIMING
+    return xi_bsp_time_getmonotonictime_microseconds();
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @brief xi_layer_call_account accounts a finished layer call to the given layer, with
+ * its duration if the library is built with XI_STATS_LAYER_TIMING
+ */
+static inline void
+xi_layer_call_account( xi_layer_type_id_t layer_type_id, xi_time_t start_us )
+{
+#if XI_STATS_LAYER_TIMING
+    xi_stats_record_layer_call( layer_type_id,
+                                xi_bsp_time_getmonotonictime_microseconds() - start_us );
+#else
+    XI_UNUSED( start_us );
+    xi_stats_count_layer_call( layer_type_id );
+#endif
+}
+
+/**
+ * @brief xi_layer_timed_call runs the layer function and accounts it to the layer it
+ * belongs to
+ *
+ * @param func the layer function, passed as the fourth argument of the handle
+ */
+static xi_state_t
+xi_layer_timed_call( void* context, void* data, xi_state_t state, void* func )
+{
+    /* read before the call, the layer may be gone after it */
+    const xi_layer_type_id_t layer_type_id =
+        XI_THIS_LAYER( ( xi_layer_connectivity_t* )context )->layer_type_id;
+    const xi_time_t start_us = xi_layer_call_clock();
+
+    const xi_state_t ret_state = ( ( xi_layer_func_t* )func )( context, data, state );
+
+    xi_layer_call_account( layer_type_id, start_us );
+
+    return ret_state;
+}
+
+#if XI_LAYER_CHAIN_STATIC
+
+/**
+ * @brief xi_layer_static_call is the xi_layer_timed_call of the layers of a default
+ * type, the function is found by a switch generated at compile time
+ *
+ * @param func_id the xi_layer_func_id_t, passed as the fourth argument of the handle
+ */
+static xi_state_t
+xi_layer_static_call( void* context, void* data, xi_state_t state, void* func_id )
+{
+    const xi_layer_t* layer = XI_THIS_LAYER( ( xi_layer_connectivity_t* )context );
+    const xi_layer_type_id_t layer_type_id = layer->layer_type_id;
+    const xi_time_t start_us               = xi_layer_call_clock();
+
+    const xi_state_t ret_state = xi_layer_stack_call(
+        layer->static_type_id, ( xi_layer_func_id_t )( intptr_t )func_id, context, data,
+        state );
+
+    xi_layer_call_account( layer_type_id, start_us );
+
+    return ret_state;
+}
+
+#endif
+
+/**
+ * @brief xi_layer_schedule_call puts the layer call to the event dispatcher and
+ * updates the state of the calling layer
+ */
+static xi_state_t xi_layer_schedule_call( xi_layer_func_t* func,
+                                          xi_layer_func_id_t func_id,
+                                          xi_layer_connectivity_t* from_context,
+                                          xi_layer_connectivity_t* context,
+                                          void* data,
+                                          xi_state_t state )
+{
+    xi_state_t local_state = XI_STATE_OK;
+
+    if ( func != NULL )
     {
-        return XI_THIS_LAYER_STATE( from_context );
+        xi_event_closure_t closure =
+            xi_make_closure( &xi_layer_timed_call, context, data, state, ( void* )func );
+
+#if XI_LAYER_CHAIN_STATIC
+        if ( XI_LAYER_STACK_NO_STATIC_TYPE !=
+             XI_THIS_LAYER( context )->static_type_id )
+        {
+            closure = xi_make_closure( &xi_layer_static_call, context, data, state,
+                                       ( void* )( intptr_t )func_id );
+        }
+#endif
+
+        /* layer handles always target the main thread so there is no need to go
+         * through the thread dispatcher, nor to carry the whole handle */
+        local_state = xi_evtd_execute_closure_direct(
+            XI_CONTEXT_DATA( context )->evtd_instance, closure );
+        XI_CHECK_STATE( local_state );
+
+        xi_layer_state_t next_state =
+            get_next_layer_state( func_id, from_context, state );
+
+        XI_THIS_LAYER_STATE_UPDATE( from_context, next_state );
     }
 
-    return XI_LAYER_STATE_NONE;
+err_handling:
+    return local_state;
 }
 
 #if XI_DEBUG_EXTRA_INFO
 
 xi_state_t xi_layer_continue_with_impl( xi_layer_func_t* func,
+                                        xi_layer_func_id_t func_id,
                                         xi_layer_connectivity_t* from_context,
                                         xi_layer_connectivity_t* context,
                                         void* data,
@@ -74,56 +182,25 @@ xi_state_t xi_layer_continue_with_impl( xi_layer_func_t* func,
                                         const char* file_name,
                                         const int line_no )
 {
-    xi_state_t local_state = XI_STATE_OK;
-
     if ( NULL != context )
     {
         context->self->debug_info.debug_file_last_call = file_name;
         context->self->debug_info.debug_line_last_call = line_no;
     }
 
-    if ( func != NULL )
-    {
-        xi_event_handle_queue_t* e_ptr =
-            xi_evttd_execute( XI_CONTEXT_DATA( context )->evtd_instance,
-                              xi_make_handle( func, context, data, state ) );
-        XI_CHECK_MEMORY( e_ptr, local_state );
-
-        xi_layer_state_t next_state =
-            get_next_layer_state( func, from_context, context, state );
-
-        XI_THIS_LAYER_STATE_UPDATE( from_context, next_state );
-    }
-
-err_handling:
-    return local_state;
+    return xi_layer_schedule_call( func, func_id, from_context, context, data, state );
 }
 
 #else /* XI_DEBUG_EXTRA_INFO */
 
 xi_state_t xi_layer_continue_with_impl( xi_layer_func_t* func,
+                                        xi_layer_func_id_t func_id,
                                         xi_layer_connectivity_t* from_context,
                                         xi_layer_connectivity_t* context,
                                         void* data,
                                         xi_state_t state )
 {
-    xi_state_t local_state = XI_STATE_OK;
-
-    if ( func != NULL )
-    {
-        xi_event_handle_queue_t* e_ptr =
-            xi_evttd_execute( XI_CONTEXT_DATA( context )->evtd_instance,
-                              xi_make_handle( func, context, data, state ) );
-        XI_CHECK_MEMORY( e_ptr, local_state );
-
-        xi_layer_state_t next_state =
-            get_next_layer_state( func, from_context, context, state );
-
-        XI_THIS_LAYER_STATE_UPDATE( from_context, next_state );
-    }
-
-err_handling:
-    return local_state;
+    return xi_layer_schedule_call( func, func_id, from_context, context, data, state );
 }
 
 #endif
@@ -54,6 +54,7 @@ extern "C" {
 
 #if XI_DEBUG_EXTRA_INFO
 extern xi_state_t xi_layer_continue_with_impl( xi_layer_func_t* f,
+                                               xi_layer_func_id_t func_id,
                                                xi_layer_connectivity_t* from_context,
                                                xi_layer_connectivity_t* context,
                                                void* data,
@@ -61,29 +62,30 @@ extern xi_state_t xi_layer_continue_with_impl( xi_layer_func_t* f,
                                                const char* file_name,
                                                const int line_no );
 
-#define XI_LAYER_CONTINUE_WITH( layer, target, context, data, state )                    \
+#define XI_LAYER_CONTINUE_WITH( layer, target, func_id, context, data, state )           \
     xi_layer_continue_with_impl(                                                         \
         ( ( NULL == context->layer_connection.layer )                                    \
               ? ( NULL )                                                                 \
               : ( context->layer_connection.layer->layer_funcs->target ) ),              \
-        &context->layer_connection,                                                      \
+        func_id, &context->layer_connection,                                             \
         ( ( NULL == context->layer_connection.layer )                                    \
               ? ( NULL )                                                                 \
               : ( &context->layer_connection.layer->layer_connection ) ),                \
         data, state, __FILE__, __LINE__ )
 #else /* XI_DEBUG_EXTRA_INFO */
 extern xi_state_t xi_layer_continue_with_impl( xi_layer_func_t* f,
+                                               xi_layer_func_id_t func_id,
                                                xi_layer_connectivity_t* from_context,
                                                xi_layer_connectivity_t* context,
                                                void* data,
                                                xi_state_t state );
 
-#define XI_LAYER_CONTINUE_WITH( layer, target, context, data, state )                    \
+#define XI_LAYER_CONTINUE_WITH( layer, target, func_id, context, data, state )           \
     xi_layer_continue_with_impl(                                                         \
         ( ( NULL == context->layer_connection.layer )                                    \
               ? ( NULL )                                                                 \
               : ( context->layer_connection.layer->layer_funcs->target ) ),              \
-        &context->layer_connection,                                                      \
+        func_id, &context->layer_connection,                                             \
         ( ( NULL == context->layer_connection.layer )                                    \
               ? ( NULL )                                                                 \
               : ( &context->layer_connection.layer->layer_connection ) ),                \
@@ -93,76 +95,94 @@ extern xi_state_t xi_layer_continue_with_impl( xi_layer_func_t* f,
 
 /* ON_DEMAND */
 #define XI_PROCESS_PUSH_ON_THIS_LAYER( context, data, state )                            \
-    XI_LAYER_CONTINUE_WITH( self, push, XI_THIS_LAYER( context ), data, state )
+    XI_LAYER_CONTINUE_WITH( self, push, XI_LAYER_FUNC_PUSH, XI_THIS_LAYER( context ),    \
+                            data, state )
 
 #define XI_PROCESS_PUSH_ON_NEXT_LAYER( context, data, state )                            \
-    XI_LAYER_CONTINUE_WITH( next, push, XI_THIS_LAYER( context ), data, state )
+    XI_LAYER_CONTINUE_WITH( next, push, XI_LAYER_FUNC_PUSH, XI_THIS_LAYER( context ),    \
+                            data, state )
 
 #define XI_PROCESS_PUSH_ON_PREV_LAYER( context, data, state )                            \
-    XI_LAYER_CONTINUE_WITH( prev, push, XI_THIS_LAYER( context ), data, state )
+    XI_LAYER_CONTINUE_WITH( prev, push, XI_LAYER_FUNC_PUSH, XI_THIS_LAYER( context ),    \
+                            data, state )
 
 /* ON_PUSHING */
 #define XI_PROCESS_PULL_ON_THIS_LAYER( context, data, state )                            \
-    XI_LAYER_CONTINUE_WITH( self, pull, XI_THIS_LAYER( context ), data, state )
+    XI_LAYER_CONTINUE_WITH( self, pull, XI_LAYER_FUNC_PULL, XI_THIS_LAYER( context ),    \
+                            data, state )
 
 #define XI_PROCESS_PULL_ON_NEXT_LAYER( context, data, state )                            \
-    XI_LAYER_CONTINUE_WITH( next, pull, XI_THIS_LAYER( context ), data, state )
+    XI_LAYER_CONTINUE_WITH( next, pull, XI_LAYER_FUNC_PULL, XI_THIS_LAYER( context ),    \
+                            data, state )
 
 #define XI_PROCESS_PULL_ON_PREV_LAYER( context, data, state )                            \
-    XI_LAYER_CONTINUE_WITH( prev, pull, XI_THIS_LAYER( context ), data, state )
+    XI_LAYER_CONTINUE_WITH( prev, pull, XI_LAYER_FUNC_PULL, XI_THIS_LAYER( context ),    \
+                            data, state )
 
 /* CLOSING */
 #define XI_PROCESS_CLOSE_ON_THIS_LAYER( context, data, state )                           \
-    XI_LAYER_CONTINUE_WITH( self, close, XI_THIS_LAYER( context ), data, state )
+    XI_LAYER_CONTINUE_WITH( self, close, XI_LAYER_FUNC_CLOSE, XI_THIS_LAYER( context ),  \
+                            data, state )
 
 #define XI_PROCESS_CLOSE_ON_NEXT_LAYER( context, data, state )                           \
-    XI_LAYER_CONTINUE_WITH( next, close, XI_THIS_LAYER( context ), data, state )
+    XI_LAYER_CONTINUE_WITH( next, close, XI_LAYER_FUNC_CLOSE, XI_THIS_LAYER( context ),  \
+                            data, state )
 
 #define XI_PROCESS_CLOSE_ON_PREV_LAYER( context, data, state )                           \
-    XI_LAYER_CONTINUE_WITH( prev, close, XI_THIS_LAYER( context ), data, state )
+    XI_LAYER_CONTINUE_WITH( prev, close, XI_LAYER_FUNC_CLOSE, XI_THIS_LAYER( context ),  \
+                            data, state )
 
 /* CLOSING_EXTERNALLY */
 #define XI_PROCESS_CLOSE_EXTERNALLY_ON_THIS_LAYER( context, data, state )                \
-    XI_LAYER_CONTINUE_WITH( self, close_externally, XI_THIS_LAYER( context ), data,      \
-                            state )
+    XI_LAYER_CONTINUE_WITH( self, close_externally, XI_LAYER_FUNC_CLOSE_EXTERNALLY,      \
+                            XI_THIS_LAYER( context ), data, state )
 
 #define XI_PROCESS_CLOSE_EXTERNALLY_ON_NEXT_LAYER( context, data, state )                \
-    XI_LAYER_CONTINUE_WITH( next, close_externally, XI_THIS_LAYER( context ), data,      \
-                            state )
+    XI_LAYER_CONTINUE_WITH( next, close_externally, XI_LAYER_FUNC_CLOSE_EXTERNALLY,      \
+                            XI_THIS_LAYER( context ), data, state )
 
 #define XI_PROCESS_CLOSE_EXTERNALLY_ON_PREV_LAYER( context, data, state )                \
-    XI_LAYER_CONTINUE_WITH( prev, close_externally, XI_THIS_LAYER( context ), data,      \
-                            state )
+    XI_LAYER_CONTINUE_WITH( prev, close_externally, XI_LAYER_FUNC_CLOSE_EXTERNALLY,      \
+                            XI_THIS_LAYER( context ), data, state )
 
 /* INIT */
 #define XI_PROCESS_INIT_ON_THIS_LAYER( context, data, state )                            \
-    XI_LAYER_CONTINUE_WITH( self, init, XI_THIS_LAYER( context ), data, state )
+    XI_LAYER_CONTINUE_WITH( self, init, XI_LAYER_FUNC_INIT, XI_THIS_LAYER( context ),    \
+                            data, state )
 
 #define XI_PROCESS_INIT_ON_NEXT_LAYER( context, data, state )                            \
-    XI_LAYER_CONTINUE_WITH( next, init, XI_THIS_LAYER( context ), data, state )
+    XI_LAYER_CONTINUE_WITH( next, init, XI_LAYER_FUNC_INIT, XI_THIS_LAYER( context ),    \
+                            data, state )
 
 #define XI_PROCESS_INIT_ON_PREV_LAYER( context, data, state )                            \
-    XI_LAYER_CONTINUE_WITH( prev, init, XI_THIS_LAYER( context ), data, state )
+    XI_LAYER_CONTINUE_WITH( prev, init, XI_LAYER_FUNC_INIT, XI_THIS_LAYER( context ),    \
+                            data, state )
 
 /* CONNECT */
 #define XI_PROCESS_CONNECT_ON_THIS_LAYER( context, data, state )                         \
-    XI_LAYER_CONTINUE_WITH( self, connect, XI_THIS_LAYER( context ), data, state );
+    XI_LAYER_CONTINUE_WITH( self, connect, XI_LAYER_FUNC_CONNECT,                        \
+                            XI_THIS_LAYER( context ), data, state );
 
 #define XI_PROCESS_CONNECT_ON_NEXT_LAYER( context, data, state )                         \
-    XI_LAYER_CONTINUE_WITH( next, connect, XI_THIS_LAYER( context ), data, state )
+    XI_LAYER_CONTINUE_WITH( next, connect, XI_LAYER_FUNC_CONNECT,                        \
+                            XI_THIS_LAYER( context ), data, state )
 
 #define XI_PROCESS_CONNECT_ON_PREV_LAYER( context, data, state )                         \
-    XI_LAYER_CONTINUE_WITH( prev, connect, XI_THIS_LAYER( context ), data, state )
+    XI_LAYER_CONTINUE_WITH( prev, connect, XI_LAYER_FUNC_CONNECT,                        \
+                            XI_THIS_LAYER( context ), data, state )
 
 /* POST-CONNECT */
 #define XI_PROCESS_POST_CONNECT_ON_THIS_LAYER( context, data, state )                    \
-    XI_LAYER_CONTINUE_WITH( self, post_connect, XI_THIS_LAYER( context ), data, state );
+    XI_LAYER_CONTINUE_WITH( self, post_connect, XI_LAYER_FUNC_POST_CONNECT,              \
+                            XI_THIS_LAYER( context ), data, state );
 
 #define XI_PROCESS_POST_CONNECT_ON_NEXT_LAYER( context, data, state )                    \
-    XI_LAYER_CONTINUE_WITH( next, post_connect, XI_THIS_LAYER( context ), data, state )
+    XI_LAYER_CONTINUE_WITH( next, post_connect, XI_LAYER_FUNC_POST_CONNECT,              \
+                            XI_THIS_LAYER( context ), data, state )
 
 #define XI_PROCESS_POST_CONNECT_ON_PREV_LAYER( context, data, state )                    \
-    XI_LAYER_CONTINUE_WITH( prev, post_connect, XI_THIS_LAYER( context ), data, state )
+    XI_LAYER_CONTINUE_WITH( prev, post_connect, XI_LAYER_FUNC_POST_CONNECT,              \
+                            XI_THIS_LAYER( context ), data, state )
 
 #ifdef __cplusplus
 }
@@ -9,6 +9,10 @@
 #include "xi_allocator.h"
 #include "xi_macros.h"
 
+#if XI_LAYER_CHAIN_STATIC
+#include "xi_layer_stack_funcs.h"
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -25,6 +29,9 @@ xi_layer_t* default_layer_heap_alloc( xi_layer_type_t* type )
     ret->layer_funcs           = &type->layer_interface;
     ret->layer_type_id         = type->layer_type_id;
     ret->layer_connection.self = ret;
+#if XI_LAYER_CHAIN_STATIC
+    ret->static_type_id = xi_layer_stack_static_type_id( ret->layer_funcs );
+#endif
 
     return ret;
 
@@ -23,6 +23,17 @@ extern "C" {
 
 typedef xi_state_t( xi_layer_func_t )( void* context, void* data, xi_state_t state );
 
+/* identifies the function of the layer interface a layer call is made to */
+typedef enum xi_layer_func_id_e {
+    XI_LAYER_FUNC_PUSH = 0,
+    XI_LAYER_FUNC_PULL,
+    XI_LAYER_FUNC_CLOSE,
+    XI_LAYER_FUNC_CLOSE_EXTERNALLY,
+    XI_LAYER_FUNC_INIT,
+    XI_LAYER_FUNC_CONNECT,
+    XI_LAYER_FUNC_POST_CONNECT
+} xi_layer_func_id_t;
+
 /* The raw interface of the purly raw layer that combines both: simplicity and
  * functionality of the 'on demand processing' idea.
  *
@@ -11,6 +11,7 @@
 #include "xi_layer_factory_interface.h"
 #include "xi_layer_macros.h"
 #include "xi_layers_ids.h"
+#include "xi_layer_stack_funcs.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -32,63 +33,13 @@ extern "C" {
 
 XI_DECLARE_LAYER_CHAIN_SCHEME( XI_LAYER_CHAIN_DEFAULT, XI_DEFAULT_LAYER_CHAIN );
 
-#include "xi_io_net_layer.h"
-#ifndef XI_NO_TLS_LAYER
-#include "xi_tls_layer.h"
-#include "xi_tls_layer_state.h"
-#endif
-
-/*-----------------------------------------------------------------------*/
-#include "xi_control_topic_layer.h"
-#include "xi_mqtt_codec_layer.h"
-#include "xi_mqtt_codec_layer_data.h"
-#include "xi_mqtt_logic_layer.h"
-#include "xi_mqtt_logic_layer_data.h"
+#define XI_LAYER_STACK_TYPES_ADD( type_id, push, pull, close, close_externally, init,    \
+                                  connect, post_connect )                                \
+    XI_LAYER_TYPES_ADD( type_id, &push, &pull, &close, &close_externally, &init,         \
+                        &connect, &post_connect ),
 
 XI_DECLARE_LAYER_TYPES_BEGIN( xi_layer_types_g )
-XI_LAYER_TYPES_ADD( XI_LAYER_TYPE_IO,
-                    &xi_io_net_layer_push,
-                    &xi_io_net_layer_pull,
-                    &xi_io_net_layer_close,
-                    &xi_io_net_layer_close_externally,
-                    &xi_io_net_layer_init,
-                    &xi_io_net_layer_connect,
-                    &xi_layer_default_post_connect )
-#ifndef XI_NO_TLS_LAYER
-, XI_LAYER_TYPES_ADD( XI_LAYER_TYPE_TLS,
-                      &xi_tls_layer_push,
-                      &xi_tls_layer_pull,
-                      &xi_tls_layer_close,
-                      &xi_tls_layer_close_externally,
-                      &xi_tls_layer_init,
-                      &xi_tls_layer_connect,
-                      &xi_layer_default_post_connect )
-#endif
-      ,
-    XI_LAYER_TYPES_ADD( XI_LAYER_TYPE_MQTT_CODEC,
-                        &xi_mqtt_codec_layer_push,
-                        &xi_mqtt_codec_layer_pull,
-                        &xi_mqtt_codec_layer_close,
-                        &xi_mqtt_codec_layer_close_externally,
-                        &xi_mqtt_codec_layer_init,
-                        &xi_mqtt_codec_layer_connect,
-                        &xi_layer_default_post_connect ),
-    XI_LAYER_TYPES_ADD( XI_LAYER_TYPE_MQTT_LOGIC,
-                        &xi_mqtt_logic_layer_push,
-                        &xi_mqtt_logic_layer_pull,
-                        &xi_mqtt_logic_layer_close,
-                        &xi_mqtt_logic_layer_close_externally,
-                        &xi_mqtt_logic_layer_init,
-                        &xi_mqtt_logic_layer_connect,
-                        &xi_mqtt_logic_layer_post_connect ),
-    XI_LAYER_TYPES_ADD( XI_LAYER_TYPE_CONTROL_TOPIC,
-                        &xi_control_topic_layer_push,
-                        &xi_control_topic_layer_pull,
-                        &xi_control_topic_layer_close,
-                        &xi_control_topic_layer_close_externally,
-                        &xi_control_topic_layer_init,
-                        &xi_control_topic_layer_connect,
-                        &xi_layer_default_post_connect ) XI_DECLARE_LAYER_TYPES_END()
+XI_LAYER_STACK_TYPES( XI_LAYER_STACK_TYPES_ADD ) XI_DECLARE_LAYER_TYPES_END()
 
 #ifdef __cplusplus
 }
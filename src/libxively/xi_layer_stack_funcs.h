@@ -0,0 +1,142 @@
+/* Copyright (c) 2003-2018, Xively All rights reserved.
+ *
+ * This is part of the Xively C Client library,
+ * it is licensed under the BSD 3-Clause license.
+ */
+
+#ifndef __XI_LAYER_STACK_FUNCS_H__
+#define __XI_LAYER_STACK_FUNCS_H__
+
+#include "xi_config.h"
+#include "xi_layer_default_functions.h"
+#include "xi_layer_type.h"
+#include "xi_layers_ids.h"
+
+#include "xi_io_net_layer.h"
+#ifndef XI_NO_TLS_LAYER
+#include "xi_tls_layer.h"
+#include "xi_tls_layer_state.h"
+#endif
+
+#include "xi_control_topic_layer.h"
+#include "xi_mqtt_codec_layer.h"
+#include "xi_mqtt_codec_layer_data.h"
+#include "xi_mqtt_logic_layer.h"
+#include "xi_mqtt_logic_layer_data.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * The layer types of the default layer chain, each one given to LAYER_TYPE as
+ * ( type_id, push, pull, close, close_externally, init, connect, post_connect ).
+ * Both the xi_layer_types_g table and the static dispatch of the layer calls, see
+ * XI_LAYER_CHAIN_STATIC, are generated from it.
+ */
+#ifndef XI_NO_TLS_LAYER
+#define XI_LAYER_STACK_TLS_TYPE( LAYER_TYPE )                                            \
+    LAYER_TYPE( XI_LAYER_TYPE_TLS, xi_tls_layer_push, xi_tls_layer_pull,                 \
+                xi_tls_layer_close, xi_tls_layer_close_externally, xi_tls_layer_init,    \
+                xi_tls_layer_connect, xi_layer_default_post_connect )
+#else
+#define XI_LAYER_STACK_TLS_TYPE( LAYER_TYPE )
+#endif
+
+#define XI_LAYER_STACK_TYPES( LAYER_TYPE )                                               \
+    LAYER_TYPE( XI_LAYER_TYPE_IO, xi_io_net_layer_push, xi_io_net_layer_pull,            \
+                xi_io_net_layer_close, xi_io_net_layer_close_externally,                 \
+                xi_io_net_layer_init, xi_io_net_layer_connect,                           \
+                xi_layer_default_post_connect )                                          \
+    XI_LAYER_STACK_TLS_TYPE( LAYER_TYPE )                                                \
+    LAYER_TYPE( XI_LAYER_TYPE_MQTT_CODEC, xi_mqtt_codec_layer_push,                      \
+                xi_mqtt_codec_layer_pull, xi_mqtt_codec_layer_close,                     \
+                xi_mqtt_codec_layer_close_externally, xi_mqtt_codec_layer_init,          \
+                xi_mqtt_codec_layer_connect, xi_layer_default_post_connect )             \
+    LAYER_TYPE( XI_LAYER_TYPE_MQTT_LOGIC, xi_mqtt_logic_layer_push,                      \
+                xi_mqtt_logic_layer_pull, xi_mqtt_logic_layer_close,                     \
+                xi_mqtt_logic_layer_close_externally, xi_mqtt_logic_layer_init,          \
+                xi_mqtt_logic_layer_connect, xi_mqtt_logic_layer_post_connect )          \
+    LAYER_TYPE( XI_LAYER_TYPE_CONTROL_TOPIC, xi_control_topic_layer_push,                \
+                xi_control_topic_layer_pull, xi_control_topic_layer_close,               \
+                xi_control_topic_layer_close_externally, xi_control_topic_layer_init,    \
+                xi_control_topic_layer_connect, xi_layer_default_post_connect )
+
+#if XI_LAYER_CHAIN_STATIC
+
+/* static_type_id of the layers whose functions aren't the ones of a default type */
+#define XI_LAYER_STACK_NO_STATIC_TYPE ( ( xi_layer_type_id_t )0xff )
+
+#define XI_LAYER_STACK_MATCH_TYPE( type_id, push_fn, pull_fn, close_fn,                  \
+                                   close_externally_fn, init_fn, connect_fn,             \
+                                   post_connect_fn )                                     \
+    if ( &push_fn == funcs->push && &pull_fn == funcs->pull &&                           \
+         &close_fn == funcs->close && &close_externally_fn == funcs->close_externally && \
+         &init_fn == funcs->init && &connect_fn == funcs->connect &&                     \
+         &post_connect_fn == funcs->post_connect )                                       \
+    {                                                                                    \
+        return type_id;                                                                  \
+    }
+
+/**
+ * @brief xi_layer_stack_static_type_id finds the default layer type the functions
+ * belong to, whatever the table and the type id they have been given with
+ *
+ * @return the type id or XI_LAYER_STACK_NO_STATIC_TYPE
+ */
+static inline xi_layer_type_id_t
+xi_layer_stack_static_type_id( const xi_layer_interface_t* funcs )
+{
+    XI_LAYER_STACK_TYPES( XI_LAYER_STACK_MATCH_TYPE )
+
+    return XI_LAYER_STACK_NO_STATIC_TYPE;
+}
+
+#define XI_LAYER_STACK_CALL_CASE( type_id, push_fn, pull_fn, close_fn,                   \
+                                  close_externally_fn, init_fn, connect_fn,              \
+                                  post_connect_fn )                                      \
+    case type_id:                                                                        \
+        switch ( func_id )                                                               \
+        {                                                                                \
+            case XI_LAYER_FUNC_PUSH:                                                     \
+                return push_fn( context, data, state );                                  \
+            case XI_LAYER_FUNC_PULL:                                                     \
+                return pull_fn( context, data, state );                                  \
+            case XI_LAYER_FUNC_CLOSE:                                                    \
+                return close_fn( context, data, state );                                 \
+            case XI_LAYER_FUNC_CLOSE_EXTERNALLY:                                         \
+                return close_externally_fn( context, data, state );                      \
+            case XI_LAYER_FUNC_INIT:                                                     \
+                return init_fn( context, data, state );                                  \
+            case XI_LAYER_FUNC_CONNECT:                                                  \
+                return connect_fn( context, data, state );                               \
+            case XI_LAYER_FUNC_POST_CONNECT:                                             \
+                return post_connect_fn( context, data, state );                          \
+        }                                                                                \
+        break;
+
+/**
+ * @brief xi_layer_stack_call calls the function of a default layer type directly,
+ * without going through the function pointers of the layer
+ */
+static inline xi_state_t xi_layer_stack_call( xi_layer_type_id_t static_type_id,
+                                              xi_layer_func_id_t func_id,
+                                              void* context,
+                                              void* data,
+                                              xi_state_t state )
+{
+    switch ( static_type_id )
+    {
+        XI_LAYER_STACK_TYPES( XI_LAYER_STACK_CALL_CASE )
+    }
+
+    return XI_INTERNAL_ERROR;
+}
+
+#endif /* XI_LAYER_CHAIN_STATIC */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __XI_LAYER_STACK_FUNCS_H__ */
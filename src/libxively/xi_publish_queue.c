@@ -0,0 +1,743 @@
+/* Copyright (c) 2003-2018, Xively All rights reserved.
+ *
+ * This is part of the Xively C Client library,
+ * it is licensed under the BSD 3-Clause license.
+ */
+
+#include <string.h>
+
+#include "xi_publish_queue.h"
+#include "xi_allocator.h"
+#include "xi_config.h"
+#include "xi_debug.h"
+#include "xi_helpers.h"
+#include "xi_internals.h"
+#include "xi_list.h"
+#include "xi_macros.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* the callback is already a prepared handle to xi_user_callback_wrapper, only the
+ * state has to be filled in */
+static void xi_publish_queue_notify( xi_publish_queue_t* queue,
+                                     xi_event_handle_t* callback,
+                                     xi_state_t state )
+{
+    if ( 0 == xi_handle_disposed( callback ) )
+    {
+        xi_event_handle_t handle = *callback;
+        handle.handlers.h3.a3    = state;
+
+        xi_evttd_execute( queue->evtd_instance, handle );
+        xi_dispose_handle( callback );
+    }
+}
+
+void xi_publish_queue_free_entry( xi_publish_queue_entry_t** entry )
+{
+    if ( NULL == entry || NULL == *entry )
+    {
+        return;
+    }
+
+    XI_SAFE_FREE( ( *entry )->topic );
+    xi_free_desc( &( *entry )->data );
+    XI_SAFE_FREE( *entry );
+}
+
+static xi_state_t xi_publish_queue_spool_read_exact( xi_publish_queue_t* queue,
+                                                     size_t offset,
+                                                     uint8_t* dst,
+                                                     size_t len )
+{
+    xi_state_t state = XI_STATE_OK;
+
+    while ( 0 < len )
+    {
+        const uint8_t* buffer = NULL;
+        size_t buffer_size    = 0;
+
+        state = xi_internals.fs_functions.read_resource( NULL, queue->spool_handle, offset,
+                                                         &buffer, &buffer_size );
+        XI_CHECK_STATE( state );
+        XI_CHECK_CND_DBGMESSAGE( 0 == buffer_size, XI_FS_READ_ERROR, state,
+                                 "unexpected end of the spool" );
+
+        const size_t chunk = XI_MIN( buffer_size, len );
+        memcpy( dst, buffer, chunk );
+
+        dst += chunk;
+        offset += chunk;
+        len -= chunk;
+    }
+
+err_handling:
+    return state;
+}
+
+static xi_state_t xi_publish_queue_spool_write_at( xi_publish_queue_t* queue,
+                                                   const uint8_t* src,
+                                                   size_t len,
+                                                   size_t offset )
+{
+    size_t bytes_written = 0;
+
+    /* zero length writes are rejected by some of the filesystem implementations */
+    if ( 0 == len )
+    {
+        return XI_STATE_OK;
+    }
+
+    xi_state_t state = xi_internals.fs_functions.write_resource(
+        NULL, queue->spool_handle, src, len, offset, &bytes_written );
+
+    if ( XI_STATE_OK == state && bytes_written != len )
+    {
+        state = XI_FS_WRITE_ERROR;
+    }
+
+    return state;
+}
+
+static void xi_publish_queue_spool_encode_header( uint8_t* header,
+                                                  uint16_t topic_len,
+                                                  xi_mqtt_qos_t qos,
+                                                  xi_mqtt_retain_t retain,
+                                                  uint32_t payload_len )
+{
+    header[0] = ( uint8_t )( topic_len >> 8 );
+    header[1] = ( uint8_t )( topic_len );
+    header[2] = ( uint8_t )qos;
+    header[3] = ( uint8_t )retain;
+    header[4] = ( uint8_t )( payload_len >> 24 );
+    header[5] = ( uint8_t )( payload_len >> 16 );
+    header[6] = ( uint8_t )( payload_len >> 8 );
+    header[7] = ( uint8_t )( payload_len );
+}
+
+static size_t xi_publish_queue_spool_record_size( const uint8_t* header )
+{
+    const size_t topic_len   = ( ( size_t )header[0] << 8 ) | header[1];
+    const size_t payload_len = ( ( size_t )header[4] << 24 ) |
+                               ( ( size_t )header[5] << 16 ) |
+                               ( ( size_t )header[6] << 8 ) | header[7];
+
+    return XI_PUBLISH_QUEUE_SPOOL_HEADER_SIZE + topic_len + payload_len;
+}
+
+/* the offset is saved after every record read, the resource is rewritten as a whole
+ * and closed right away so that it is never held in a write buffer */
+static void xi_publish_queue_spool_save_read_offset( xi_publish_queue_t* queue )
+{
+    xi_fs_resource_handle_t handle = xi_fs_init_resource_handle();
+    const uint32_t offset          = ( uint32_t )queue->spool_read_offset;
+    const uint8_t encoded[XI_PUBLISH_QUEUE_SPOOL_OFFSET_SIZE] = {
+        ( uint8_t )( offset >> 24 ), ( uint8_t )( offset >> 16 ),
+        ( uint8_t )( offset >> 8 ), ( uint8_t )( offset )};
+    size_t bytes_written = 0;
+
+    xi_state_t state = xi_internals.fs_functions.open_resource(
+        NULL, XI_FS_CONFIG_DATA, queue->spool_offset_name, XI_FS_OPEN_WRITE, &handle );
+    XI_CHECK_STATE( state );
+
+    state = xi_internals.fs_functions.write_resource( NULL, handle, encoded,
+                                                      sizeof( encoded ), 0,
+                                                      &bytes_written );
+
+    xi_internals.fs_functions.close_resource( NULL, handle );
+    XI_CHECK_STATE( state );
+
+    return;
+
+err_handling:
+    /* a restart will send the records read since the last save once again */
+    xi_debug_format( "saving the spool read offset failed with state: %d", state );
+}
+
+/* @return the saved read offset or 0 if there is none */
+static size_t xi_publish_queue_spool_load_read_offset( xi_publish_queue_t* queue )
+{
+    xi_fs_resource_handle_t handle = xi_fs_init_resource_handle();
+    const uint8_t* buffer          = NULL;
+    size_t buffer_size             = 0;
+    size_t offset                  = 0;
+
+    if ( XI_STATE_OK != xi_internals.fs_functions.open_resource(
+                            NULL, XI_FS_CONFIG_DATA, queue->spool_offset_name,
+                            XI_FS_OPEN_READ, &handle ) )
+    {
+        return 0;
+    }
+
+    if ( XI_STATE_OK == xi_internals.fs_functions.read_resource( NULL, handle, 0, &buffer,
+                                                                 &buffer_size ) &&
+         XI_PUBLISH_QUEUE_SPOOL_OFFSET_SIZE <= buffer_size )
+    {
+        offset = ( ( size_t )buffer[0] << 24 ) | ( ( size_t )buffer[1] << 16 ) |
+                 ( ( size_t )buffer[2] << 8 ) | buffer[3];
+    }
+
+    xi_internals.fs_functions.close_resource( NULL, handle );
+
+    return offset;
+}
+
+/* closes the spool and removes the resource, any unread data is lost */
+static void xi_publish_queue_spool_reset( xi_publish_queue_t* queue )
+{
+    if ( XI_FS_INVALID_RESOURCE_HANDLE != queue->spool_handle )
+    {
+        xi_internals.fs_functions.close_resource( NULL, queue->spool_handle );
+        queue->spool_handle = xi_fs_init_resource_handle();
+    }
+
+    /* the spool goes first, a stale offset is never used for a new spool */
+    if ( XI_PUBLISH_QUEUE_SPOOL_IDLE != queue->spool_mode )
+    {
+        xi_internals.fs_functions.remove_resource( NULL, XI_FS_CONFIG_DATA,
+                                                   queue->spool_name );
+        xi_internals.fs_functions.remove_resource( NULL, XI_FS_CONFIG_DATA,
+                                                   queue->spool_offset_name );
+    }
+
+    queue->spool_mode             = XI_PUBLISH_QUEUE_SPOOL_IDLE;
+    queue->spool_read_offset      = 0;
+    queue->spool_write_offset     = 0;
+    queue->stats.spooled_messages = 0;
+    queue->stats.spooled_bytes    = 0;
+}
+
+static xi_state_t xi_publish_queue_spool_open_for_reading( xi_publish_queue_t* queue )
+{
+    xi_state_t state = XI_STATE_OK;
+
+    if ( XI_FS_INVALID_RESOURCE_HANDLE != queue->spool_handle )
+    {
+        state = xi_internals.fs_functions.close_resource( NULL, queue->spool_handle );
+        queue->spool_handle = xi_fs_init_resource_handle();
+        XI_CHECK_STATE( state );
+    }
+
+    state = xi_internals.fs_functions.open_resource( NULL, XI_FS_CONFIG_DATA,
+                                                     queue->spool_name, XI_FS_OPEN_READ,
+                                                     &queue->spool_handle );
+    XI_CHECK_STATE( state );
+
+    queue->spool_mode = XI_PUBLISH_QUEUE_SPOOL_READING;
+
+err_handling:
+    return state;
+}
+
+/* picks up the spool left by a previous instance, counts the records and validates
+ * their boundaries, a truncated tail is ignored. Reading resumes at the saved offset
+ * if it is one of the boundaries, from the beginning otherwise. */
+static xi_state_t xi_publish_queue_spool_recover( xi_publish_queue_t* queue )
+{
+    xi_fs_stat_t resource_stat = {.resource_size = 0};
+
+    xi_state_t state = xi_internals.fs_functions.stat_resource(
+        NULL, XI_FS_CONFIG_DATA, queue->spool_name, &resource_stat );
+
+    if ( XI_STATE_OK != state || 0 == resource_stat.resource_size )
+    {
+        return XI_STATE_OK;
+    }
+
+    state = xi_publish_queue_spool_open_for_reading( queue );
+    XI_CHECK_STATE( state );
+
+    size_t offset             = 0;
+    size_t read_offset        = xi_publish_queue_spool_load_read_offset( queue );
+    size_t records_before     = 0;
+    uint8_t read_offset_found = ( 0 == read_offset );
+
+    while ( offset + XI_PUBLISH_QUEUE_SPOOL_HEADER_SIZE <= resource_stat.resource_size )
+    {
+        uint8_t header[XI_PUBLISH_QUEUE_SPOOL_HEADER_SIZE] = {0};
+
+        state = xi_publish_queue_spool_read_exact( queue, offset, header,
+                                                   sizeof( header ) );
+        XI_CHECK_STATE( state );
+
+        const size_t record_size = xi_publish_queue_spool_record_size( header );
+
+        if ( offset + record_size > resource_stat.resource_size )
+        {
+            break;
+        }
+
+        offset += record_size;
+        queue->stats.spooled_messages += 1;
+
+        if ( offset == read_offset )
+        {
+            read_offset_found = 1;
+            records_before    = queue->stats.spooled_messages;
+        }
+    }
+
+    if ( 0 == read_offset_found )
+    {
+        read_offset    = 0;
+        records_before = 0;
+    }
+
+    queue->spool_read_offset  = read_offset;
+    queue->spool_write_offset = offset;
+    queue->stats.spooled_messages -= records_before;
+    queue->stats.spooled_bytes = offset - read_offset;
+
+    xi_debug_format( "recovered %zu spooled messages", queue->stats.spooled_messages );
+
+    if ( queue->spool_read_offset >= queue->spool_write_offset )
+    {
+        xi_publish_queue_spool_reset( queue );
+    }
+
+    return XI_STATE_OK;
+
+err_handling:
+    xi_publish_queue_spool_reset( queue );
+    return state;
+}
+
+static xi_state_t xi_publish_queue_spool_push( xi_publish_queue_t* queue,
+                                               const char* topic,
+                                               const xi_data_desc_t* data,
+                                               const xi_mqtt_qos_t qos,
+                                               const xi_mqtt_retain_t retain )
+{
+    /* the spool can't be appended while it is being read, it is a single sequential
+     * file and the posix implementation truncates on open for writing */
+    if ( NULL == queue->spool_name ||
+         XI_PUBLISH_QUEUE_SPOOL_READING == queue->spool_mode )
+    {
+        return XI_NO_MORE_RESOURCE_AVAILABLE;
+    }
+
+    xi_state_t state       = XI_STATE_OK;
+    const size_t topic_len = strlen( topic );
+    const size_t record_size =
+        XI_PUBLISH_QUEUE_SPOOL_HEADER_SIZE + topic_len + data->length;
+
+    uint8_t header[XI_PUBLISH_QUEUE_SPOOL_HEADER_SIZE] = {0};
+
+    if ( XI_MAX16_t < topic_len ||
+         XI_PUBLISH_QUEUE_MAX_SPOOL_SIZE < queue->spool_write_offset + record_size )
+    {
+        return XI_NO_MORE_RESOURCE_AVAILABLE;
+    }
+
+    if ( XI_PUBLISH_QUEUE_SPOOL_IDLE == queue->spool_mode )
+    {
+        /* left by a spool that was removed before its offset */
+        xi_internals.fs_functions.remove_resource( NULL, XI_FS_CONFIG_DATA,
+                                                   queue->spool_offset_name );
+
+        state = xi_internals.fs_functions.open_resource(
+            NULL, XI_FS_CONFIG_DATA, queue->spool_name, XI_FS_OPEN_WRITE,
+            &queue->spool_handle );
+        XI_CHECK_STATE( state );
+
+        queue->spool_mode = XI_PUBLISH_QUEUE_SPOOL_WRITING;
+    }
+
+    xi_publish_queue_spool_encode_header( header, ( uint16_t )topic_len, qos, retain,
+                                          data->length );
+
+    XI_CHECK_STATE( state = xi_publish_queue_spool_write_at(
+                        queue, header, sizeof( header ), queue->spool_write_offset ) );
+
+    XI_CHECK_STATE( state = xi_publish_queue_spool_write_at(
+                        queue, ( const uint8_t* )topic, topic_len,
+                        queue->spool_write_offset + sizeof( header ) ) );
+
+    XI_CHECK_STATE( state = xi_publish_queue_spool_write_at(
+                        queue, data->data_ptr, data->length,
+                        queue->spool_write_offset + sizeof( header ) + topic_len ) );
+
+    queue->spool_write_offset += record_size;
+    queue->stats.spooled_messages += 1;
+    queue->stats.spooled_bytes += record_size;
+
+    return XI_STATE_OK;
+
+err_handling:
+    /* a partially written record is never accounted, the next write overwrites it */
+    xi_debug_format( "spool write failed with state: %d", state );
+    return state;
+}
+
+static xi_publish_queue_entry_t* xi_publish_queue_spool_pop( xi_publish_queue_t* queue )
+{
+    xi_state_t state                = XI_STATE_OK;
+    xi_publish_queue_entry_t* entry = NULL;
+    uint8_t header[XI_PUBLISH_QUEUE_SPOOL_HEADER_SIZE] = {0};
+
+    if ( queue->spool_read_offset >= queue->spool_write_offset )
+    {
+        xi_publish_queue_spool_reset( queue );
+        return NULL;
+    }
+
+    if ( XI_PUBLISH_QUEUE_SPOOL_WRITING == queue->spool_mode )
+    {
+        XI_CHECK_STATE( state = xi_publish_queue_spool_open_for_reading( queue ) );
+    }
+
+    XI_CHECK_STATE( state = xi_publish_queue_spool_read_exact(
+                        queue, queue->spool_read_offset, header, sizeof( header ) ) );
+
+    const size_t record_size  = xi_publish_queue_spool_record_size( header );
+    const size_t topic_len    = ( ( size_t )header[0] << 8 ) | header[1];
+    const size_t payload_len  = record_size - XI_PUBLISH_QUEUE_SPOOL_HEADER_SIZE - topic_len;
+    const size_t topic_offset = queue->spool_read_offset + sizeof( header );
+
+    XI_CHECK_CND_DBGMESSAGE(
+        queue->spool_read_offset + record_size > queue->spool_write_offset,
+        XI_FS_READ_ERROR, state, "corrupted spool record" );
+
+    XI_ALLOC_AT( xi_publish_queue_entry_t, entry, state );
+    XI_ALLOC_BUFFER_AT( char, entry->topic, topic_len + 1, state );
+
+    entry->data = xi_make_empty_desc_alloc( XI_MAX( payload_len, 1 ) );
+    XI_CHECK_MEMORY( entry->data, state );
+
+    XI_CHECK_STATE( state = xi_publish_queue_spool_read_exact(
+                        queue, topic_offset, ( uint8_t* )entry->topic, topic_len ) );
+    XI_CHECK_STATE( state = xi_publish_queue_spool_read_exact(
+                        queue, topic_offset + topic_len, entry->data->data_ptr,
+                        payload_len ) );
+
+    entry->data->length = payload_len;
+    entry->qos          = ( xi_mqtt_qos_t )header[2];
+    entry->retain       = ( xi_mqtt_retain_t )header[3];
+    entry->priority     = XI_PUBLISH_PRIORITY_NORMAL;
+    entry->callback     = xi_make_empty_handle();
+
+    queue->spool_read_offset += record_size;
+    queue->stats.spooled_messages -= 1;
+    queue->stats.spooled_bytes -= record_size;
+
+    if ( queue->spool_read_offset >= queue->spool_write_offset )
+    {
+        xi_publish_queue_spool_reset( queue );
+    }
+    else
+    {
+        xi_publish_queue_spool_save_read_offset( queue );
+    }
+
+    return entry;
+
+err_handling:
+    xi_publish_queue_free_entry( &entry );
+
+    /* there is no way to resynchronise on a broken spool, all of its content is lost */
+    xi_debug_format( "dropping %zu spooled messages, state: %d",
+                     queue->stats.spooled_messages, state );
+
+    queue->stats.dropped_messages += queue->stats.spooled_messages;
+    xi_publish_queue_spool_reset( queue );
+
+    return NULL;
+}
+
+#define XI_PUBLISH_QUEUE_LOWER_PRIORITY( entry, value ) ( ( entry )->priority < value )
+
+/* drops the oldest entry of the lowest class unless that class is above the priority,
+ * returns 0 if nothing could be dropped */
+static uint8_t xi_publish_queue_drop_lowest( xi_publish_queue_t* queue,
+                                             const xi_publish_priority_t priority )
+{
+    xi_publish_queue_entry_t* entry = queue->entries;
+    xi_publish_queue_entry_t* curr  = queue->entries;
+
+    /* the entries are ordered, the lowest class is the last run of the list */
+    for ( ; NULL != curr; curr = curr->__next )
+    {
+        if ( curr->priority != entry->priority )
+        {
+            entry = curr;
+        }
+    }
+
+    if ( NULL == entry || entry->priority > priority )
+    {
+        return 0;
+    }
+
+    XI_LIST_DROP( xi_publish_queue_entry_t, queue->entries, entry );
+
+    queue->stats.queued_messages -= 1;
+    queue->stats.queued_bytes -= entry->data->length;
+    queue->stats.dropped_messages += 1;
+
+    xi_publish_queue_notify( queue, &entry->callback, XI_BACKOFF_TERMINAL );
+    xi_publish_queue_free_entry( &entry );
+
+    return 1;
+}
+
+static uint8_t xi_publish_queue_ram_has_room( const xi_publish_queue_t* queue, size_t len )
+{
+    return queue->stats.queued_messages < queue->max_messages &&
+           ( 0 == queue->max_bytes || queue->stats.queued_bytes + len <= queue->max_bytes );
+}
+
+xi_publish_queue_t* xi_publish_queue_create( xi_evtd_instance_t* evtd_instance,
+                                             xi_event_handle_t drain_handle,
+                                             size_t max_messages,
+                                             size_t max_bytes,
+                                             uint16_t drain_rate,
+                                             const char* spool_name )
+{
+    assert( NULL != evtd_instance );
+    assert( 0 < max_messages );
+
+    xi_state_t state = XI_STATE_OK;
+
+    XI_ALLOC( xi_publish_queue_t, queue, state );
+
+    queue->evtd_instance = evtd_instance;
+    queue->drain_handle  = drain_handle;
+    queue->max_messages  = max_messages;
+    queue->max_bytes     = max_bytes;
+    queue->drain_rate    = drain_rate;
+    queue->spool_handle  = xi_fs_init_resource_handle();
+
+    if ( NULL != spool_name )
+    {
+        queue->spool_name = xi_str_dup( spool_name );
+        XI_CHECK_MEMORY( queue->spool_name, state );
+
+        const size_t name_len = strlen( spool_name );
+
+        XI_ALLOC_BUFFER_AT( char, queue->spool_offset_name,
+                            name_len + sizeof( XI_PUBLISH_QUEUE_SPOOL_OFFSET_SUFFIX ),
+                            state );
+        memcpy( queue->spool_offset_name, spool_name, name_len );
+        memcpy( queue->spool_offset_name + name_len, XI_PUBLISH_QUEUE_SPOOL_OFFSET_SUFFIX,
+                sizeof( XI_PUBLISH_QUEUE_SPOOL_OFFSET_SUFFIX ) );
+
+        xi_publish_queue_spool_recover( queue );
+    }
+
+    return queue;
+
+err_handling:
+    if ( NULL != queue )
+    {
+        XI_SAFE_FREE( queue->spool_name );
+    }
+    XI_SAFE_FREE( queue );
+    return NULL;
+}
+
+void xi_publish_queue_destroy( xi_publish_queue_t** queue )
+{
+    if ( NULL == queue || NULL == *queue )
+    {
+        return;
+    }
+
+    xi_publish_queue_t* q = *queue;
+
+    if ( NULL != q->drain_event.ptr_to_position )
+    {
+        xi_evtd_cancel( q->evtd_instance, &q->drain_event );
+    }
+
+    while ( NULL != q->entries )
+    {
+        xi_publish_queue_entry_t* entry = NULL;
+        XI_LIST_POP( xi_publish_queue_entry_t, q->entries, entry );
+        xi_publish_queue_free_entry( &entry );
+    }
+
+    /* keep the unsent part of the spool for the next run */
+    if ( XI_FS_INVALID_RESOURCE_HANDLE != q->spool_handle )
+    {
+        xi_internals.fs_functions.close_resource( NULL, q->spool_handle );
+    }
+
+    XI_SAFE_FREE( q->spool_name );
+    XI_SAFE_FREE( q->spool_offset_name );
+    XI_SAFE_FREE( *queue );
+}
+
+xi_state_t xi_publish_queue_push( xi_publish_queue_t* queue,
+                                  const char* topic,
+                                  xi_data_desc_t* data,
+                                  const xi_mqtt_qos_t qos,
+                                  const xi_mqtt_retain_t retain,
+                                  const xi_publish_priority_t priority,
+                                  xi_event_handle_t callback )
+{
+    assert( NULL != queue );
+
+    if ( NULL == topic || NULL == data )
+    {
+        xi_free_desc( &data );
+        return XI_INVALID_PARAMETER;
+    }
+
+    xi_state_t state                = XI_STATE_OK;
+    xi_publish_queue_entry_t* entry = NULL;
+
+    /* once anything went to the spool the following messages have to follow it,
+     * otherwise they would overtake the older, spooled ones, unless they are of a class
+     * that is meant to overtake them */
+    if ( ( XI_PUBLISH_QUEUE_SPOOL_WRITING == queue->spool_mode &&
+           XI_PUBLISH_PRIORITY_NORMAL >= priority ) ||
+         0 == xi_publish_queue_ram_has_room( queue, data->length ) )
+    {
+        if ( XI_STATE_OK ==
+             xi_publish_queue_spool_push( queue, topic, data, qos, retain ) )
+        {
+            xi_free_desc( &data );
+            xi_publish_queue_notify( queue, &callback, XI_STATE_OK );
+            return XI_STATE_OK;
+        }
+
+        /* a full spool that is being written can't be overtaken by RAM either, or the
+         * message alone exceeds the byte limit, there is no point in evicting */
+        if ( ( XI_PUBLISH_QUEUE_SPOOL_WRITING == queue->spool_mode &&
+               XI_PUBLISH_PRIORITY_NORMAL >= priority ) ||
+             ( 0 != queue->max_bytes && data->length > queue->max_bytes ) )
+        {
+            queue->stats.dropped_messages += 1;
+            xi_free_desc( &data );
+            xi_publish_queue_notify( queue, &callback, XI_BACKOFF_TERMINAL );
+            return XI_STATE_OK;
+        }
+
+        while ( 0 == xi_publish_queue_ram_has_room( queue, data->length ) )
+        {
+            if ( 0 == xi_publish_queue_drop_lowest( queue, priority ) )
+            {
+                /* only the higher classes are left */
+                queue->stats.dropped_messages += 1;
+                xi_free_desc( &data );
+                xi_publish_queue_notify( queue, &callback, XI_BACKOFF_TERMINAL );
+                return XI_STATE_OK;
+            }
+        }
+    }
+
+    XI_ALLOC_AT( xi_publish_queue_entry_t, entry, state );
+
+    entry->topic = xi_str_dup( topic );
+    XI_CHECK_MEMORY( entry->topic, state );
+
+    entry->data     = data;
+    entry->callback = callback;
+    entry->qos      = qos;
+    entry->retain   = retain;
+    entry->priority = priority;
+
+    XI_LIST_INSERT_BEFORE( xi_publish_queue_entry_t, queue->entries,
+                           XI_PUBLISH_QUEUE_LOWER_PRIORITY, priority, entry );
+
+    queue->stats.queued_messages += 1;
+    queue->stats.queued_bytes += data->length;
+
+    return XI_STATE_OK;
+
+err_handling:
+    if ( NULL != entry )
+    {
+        XI_SAFE_FREE( entry->topic );
+        XI_SAFE_FREE( entry );
+    }
+
+    xi_free_desc( &data );
+    return state;
+}
+
+xi_publish_queue_entry_t* xi_publish_queue_pop( xi_publish_queue_t* queue )
+{
+    assert( NULL != queue );
+
+    xi_publish_queue_entry_t* entry = NULL;
+
+    /* while reading, the spool holds messages older than anything in RAM of its class,
+     * the higher classes go first anyway */
+    if ( XI_PUBLISH_QUEUE_SPOOL_READING == queue->spool_mode &&
+         ( NULL == queue->entries ||
+           XI_PUBLISH_PRIORITY_NORMAL >= queue->entries->priority ) )
+    {
+        entry = xi_publish_queue_spool_pop( queue );
+
+        if ( NULL != entry )
+        {
+            return entry;
+        }
+    }
+
+    if ( NULL != queue->entries )
+    {
+        XI_LIST_POP( xi_publish_queue_entry_t, queue->entries, entry );
+
+        queue->stats.queued_messages -= 1;
+        queue->stats.queued_bytes -= entry->data->length;
+
+        return entry;
+    }
+
+    if ( XI_PUBLISH_QUEUE_SPOOL_WRITING == queue->spool_mode )
+    {
+        return xi_publish_queue_spool_pop( queue );
+    }
+
+    return NULL;
+}
+
+uint8_t xi_publish_queue_is_empty( const xi_publish_queue_t* queue )
+{
+    assert( NULL != queue );
+
+    return NULL == queue->entries && XI_PUBLISH_QUEUE_SPOOL_IDLE == queue->spool_mode;
+}
+
+xi_state_t xi_publish_queue_schedule_drain( xi_publish_queue_t* queue )
+{
+    assert( NULL != queue );
+
+    if ( 0 != queue->drain_scheduled || 0 != xi_publish_queue_is_empty( queue ) )
+    {
+        return XI_STATE_OK;
+    }
+
+    if ( NULL == xi_evtd_execute( queue->evtd_instance, queue->drain_handle ) )
+    {
+        return XI_OUT_OF_MEMORY;
+    }
+
+    queue->drain_scheduled = 1;
+
+    return XI_STATE_OK;
+}
+
+xi_state_t xi_publish_queue_schedule_next_drain( xi_publish_queue_t* queue )
+{
+    assert( NULL != queue );
+
+    xi_state_t state = xi_evtd_execute_in( queue->evtd_instance, queue->drain_handle,
+                                           XI_PUBLISH_QUEUE_DRAIN_INTERVAL,
+                                           &queue->drain_event );
+
+    if ( XI_STATE_OK == state )
+    {
+        queue->drain_scheduled = 1;
+    }
+
+    return state;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,156 @@
+/* Copyright (c) 2003-2018, Xively All rights reserved.
+ *
+ * This is part of the Xively C Client library,
+ * it is licensed under the BSD 3-Clause license.
+ */
+
+#ifndef __XI_PUBLISH_QUEUE_H__
+#define __XI_PUBLISH_QUEUE_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <xively_types.h>
+
+#include "xi_data_desc.h"
+#include "xi_event_dispatcher_api.h"
+#include "xi_event_thread_dispatcher.h"
+#include "xi_fs_api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* size of the record header stored in the spool in front of topic and payload:
+ * topic length (2 bytes), qos (1 byte), retain (1 byte), payload length (4 bytes) */
+#define XI_PUBLISH_QUEUE_SPOOL_HEADER_SIZE 8
+
+/* the read offset of the spool is kept in a resource of the spool name with this suffix,
+ * 4 bytes big endian, so that a restart doesn't send the consumed records again */
+#define XI_PUBLISH_QUEUE_SPOOL_OFFSET_SUFFIX ".offset"
+#define XI_PUBLISH_QUEUE_SPOOL_OFFSET_SIZE 4
+
+typedef struct xi_publish_queue_entry_s
+{
+    struct xi_publish_queue_entry_s* __next;
+    char* topic;
+    xi_data_desc_t* data;
+    xi_event_handle_t callback;
+    xi_mqtt_qos_t qos;
+    xi_mqtt_retain_t retain;
+    xi_publish_priority_t priority;
+} xi_publish_queue_entry_t;
+
+typedef enum xi_publish_queue_spool_mode_e {
+    XI_PUBLISH_QUEUE_SPOOL_IDLE = 0,
+    XI_PUBLISH_QUEUE_SPOOL_WRITING,
+    XI_PUBLISH_QUEUE_SPOOL_READING
+} xi_publish_queue_spool_mode_t;
+
+/**
+ * @struct xi_publish_queue_t
+ *
+ * Bounded FIFO of publications requested while the context was offline. Entries are kept
+ * in RAM up to max_messages/max_bytes, the overflow goes to the spool resource if one is
+ * configured. The spool is written sequentially while offline and read sequentially while
+ * draining, since at the time the reading starts the RAM part is empty the FIFO order is
+ * preserved across both storages.
+ *
+ * The RAM entries are ordered by the priority class, FIFO within a class. The spool is
+ * class agnostic, its records come back as XI_PUBLISH_PRIORITY_NORMAL, so the messages
+ * above that class stay in RAM whenever there is room for them and are drained ahead of
+ * the spool.
+ */
+typedef struct xi_publish_queue_s
+{
+    xi_publish_queue_entry_t* entries;
+    xi_evtd_instance_t* evtd_instance;
+    xi_event_handle_t drain_handle;
+    xi_time_event_handle_t drain_event;
+    char* spool_name;
+    char* spool_offset_name;
+    xi_fs_resource_handle_t spool_handle;
+    xi_publish_queue_spool_mode_t spool_mode;
+    size_t spool_read_offset;
+    size_t spool_write_offset;
+    size_t max_messages;
+    size_t max_bytes;
+    uint16_t drain_rate;
+    uint8_t drain_scheduled;
+    xi_publish_queue_stats_t stats;
+} xi_publish_queue_t;
+
+/**
+ * @brief xi_publish_queue_create allocates and initialises a queue
+ *
+ * If the spool resource already exists and is not empty its content is treated as
+ * queued messages and will be drained before anything else, starting from the read
+ * offset saved by the previous instance.
+ *
+ * @param drain_handle handle executed whenever the queue wants to be drained
+ * @return new queue or NULL if out of memory
+ */
+extern xi_publish_queue_t* xi_publish_queue_create( xi_evtd_instance_t* evtd_instance,
+                                                    xi_event_handle_t drain_handle,
+                                                    size_t max_messages,
+                                                    size_t max_bytes,
+                                                    uint16_t drain_rate,
+                                                    const char* spool_name );
+
+/**
+ * @brief xi_publish_queue_destroy releases the queue and all of the RAM entries
+ *
+ * Pending drain is cancelled. The spool resource is left intact if it still holds
+ * messages so that they can be sent by the next instance of the queue.
+ */
+extern void xi_publish_queue_destroy( xi_publish_queue_t** queue );
+
+/**
+ * @brief xi_publish_queue_push queues a message behind the ones of its priority class
+ * and the higher ones, takes the ownership of data
+ *
+ * If there is no room for the message the oldest RAM entry of the lowest class is
+ * dropped, its callback is invoked with XI_BACKOFF_TERMINAL and the dropped_messages
+ * counter is increased. A message is never queued at the cost of a higher class one, it
+ * is dropped itself instead. Once the spool is being written a message up to the normal
+ * class that the spool can't take is dropped as well, it would overtake the spooled ones
+ * otherwise.
+ */
+extern xi_state_t xi_publish_queue_push( xi_publish_queue_t* queue,
+                                         const char* topic,
+                                         xi_data_desc_t* data,
+                                         const xi_mqtt_qos_t qos,
+                                         const xi_mqtt_retain_t retain,
+                                         const xi_publish_priority_t priority,
+                                         xi_event_handle_t callback );
+
+/**
+ * @brief xi_publish_queue_pop removes the oldest message of the highest class from the
+ * queue
+ *
+ * @return entry that has to be released with xi_publish_queue_free_entry or NULL if
+ * the queue is empty
+ */
+extern xi_publish_queue_entry_t* xi_publish_queue_pop( xi_publish_queue_t* queue );
+
+extern void xi_publish_queue_free_entry( xi_publish_queue_entry_t** entry );
+
+extern uint8_t xi_publish_queue_is_empty( const xi_publish_queue_t* queue );
+
+/**
+ * @brief xi_publish_queue_schedule_drain executes the drain handle unless a drain is
+ * already pending or there is nothing to drain
+ */
+extern xi_state_t xi_publish_queue_schedule_drain( xi_publish_queue_t* queue );
+
+/**
+ * @brief xi_publish_queue_schedule_next_drain re-arms the drain handle after
+ * XI_PUBLISH_QUEUE_DRAIN_INTERVAL seconds, used to keep the drain rate
+ */
+extern xi_state_t xi_publish_queue_schedule_next_drain( xi_publish_queue_t* queue );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __XI_PUBLISH_QUEUE_H__ */
@@ -0,0 +1,658 @@
+/* Copyright (c) 2003-2018, Xively All rights reserved.
+ *
+ * This is part of the Xively C Client library,
+ * it is licensed under the BSD 3-Clause license.
+ */
+
+#include <string.h>
+
+#include "xi_session_log.h"
+#include "xi_allocator.h"
+#include "xi_config.h"
+#include "xi_debug.h"
+#include "xi_helpers.h"
+#include "xi_internals.h"
+#include "xi_list.h"
+#include "xi_macros.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define XI_SESSION_LOG_CMP_MSG_ID( entry, id ) ( entry->msg_id == id )
+
+static xi_state_t xi_session_log_read_exact( xi_session_log_t* log,
+                                             size_t offset,
+                                             uint8_t* dst,
+                                             size_t len )
+{
+    xi_state_t state = XI_STATE_OK;
+
+    while ( 0 < len )
+    {
+        const uint8_t* buffer = NULL;
+        size_t buffer_size    = 0;
+
+        state = xi_internals.fs_functions.read_resource( NULL, log->log_handle, offset,
+                                                         &buffer, &buffer_size );
+        XI_CHECK_STATE( state );
+        XI_CHECK_CND_DBGMESSAGE( 0 == buffer_size, XI_FS_READ_ERROR, state,
+                                 "unexpected end of the session log" );
+
+        const size_t chunk = XI_MIN( buffer_size, len );
+        memcpy( dst, buffer, chunk );
+
+        dst += chunk;
+        offset += chunk;
+        len -= chunk;
+    }
+
+err_handling:
+    return state;
+}
+
+static xi_state_t xi_session_log_write_at( xi_fs_resource_handle_t handle,
+                                           const uint8_t* src,
+                                           size_t len,
+                                           size_t offset )
+{
+    size_t bytes_written = 0;
+
+    /* zero length writes are rejected by some of the filesystem implementations */
+    if ( 0 == len )
+    {
+        return XI_STATE_OK;
+    }
+
+    xi_state_t state = xi_internals.fs_functions.write_resource( NULL, handle, src, len,
+                                                                 offset, &bytes_written );
+
+    if ( XI_STATE_OK == state && bytes_written != len )
+    {
+        state = XI_FS_WRITE_ERROR;
+    }
+
+    return state;
+}
+
+static void xi_session_log_close( xi_session_log_t* log )
+{
+    if ( XI_FS_INVALID_RESOURCE_HANDLE != log->log_handle )
+    {
+        xi_internals.fs_functions.close_resource( NULL, log->log_handle );
+        log->log_handle = xi_fs_init_resource_handle();
+    }
+}
+
+/* the handle is kept open for reading and writing, opening for update requires an
+ * existing resource so a new one is created (or truncated) by a plain write first */
+static xi_state_t xi_session_log_open( xi_session_log_t* log, uint8_t truncate )
+{
+    xi_state_t state = XI_STATE_OK;
+
+    xi_session_log_close( log );
+
+    if ( 0 != truncate )
+    {
+        state = xi_internals.fs_functions.open_resource(
+            NULL, XI_FS_CONFIG_DATA, log->log_names[log->slot], XI_FS_OPEN_WRITE,
+            &log->log_handle );
+        XI_CHECK_STATE( state );
+
+        xi_session_log_close( log );
+    }
+
+    state = xi_internals.fs_functions.open_resource(
+        NULL, XI_FS_CONFIG_DATA, log->log_names[log->slot],
+        ( xi_fs_open_flags_t )( XI_FS_OPEN_READ | XI_FS_OPEN_WRITE ), &log->log_handle );
+
+err_handling:
+    return state;
+}
+
+static uint32_t xi_session_log_next_generation( uint32_t generation )
+{
+    return ( 0 == generation + 1 ) ? 1 : generation + 1;
+}
+
+static xi_state_t xi_session_log_write_generation( xi_fs_resource_handle_t handle,
+                                                   uint32_t generation )
+{
+    const uint8_t header[XI_SESSION_LOG_FILE_HEADER_SIZE] = {
+        ( uint8_t )( generation >> 24 ), ( uint8_t )( generation >> 16 ),
+        ( uint8_t )( generation >> 8 ), ( uint8_t )( generation )};
+
+    return xi_session_log_write_at( handle, header, sizeof( header ), 0 );
+}
+
+/* @return the generation of the log in the resource, 0 if there is no complete one */
+static uint32_t xi_session_log_read_generation( xi_session_log_t* log, uint8_t slot )
+{
+    xi_fs_resource_handle_t handle = xi_fs_init_resource_handle();
+    const uint8_t* buffer          = NULL;
+    size_t buffer_size             = 0;
+    uint32_t generation            = 0;
+
+    if ( XI_STATE_OK != xi_internals.fs_functions.open_resource(
+                            NULL, XI_FS_CONFIG_DATA, log->log_names[slot],
+                            XI_FS_OPEN_READ, &handle ) )
+    {
+        return 0;
+    }
+
+    if ( XI_STATE_OK == xi_internals.fs_functions.read_resource( NULL, handle, 0, &buffer,
+                                                                 &buffer_size ) &&
+         XI_SESSION_LOG_FILE_HEADER_SIZE <= buffer_size )
+    {
+        generation = ( ( uint32_t )buffer[0] << 24 ) | ( ( uint32_t )buffer[1] << 16 ) |
+                     ( ( uint32_t )buffer[2] << 8 ) | buffer[3];
+    }
+
+    xi_internals.fs_functions.close_resource( NULL, handle );
+
+    return generation;
+}
+
+static void xi_session_log_encode_record_header( uint8_t* header,
+                                                 xi_session_log_record_type_t type,
+                                                 uint16_t msg_id,
+                                                 uint32_t body_len )
+{
+    header[0] = ( uint8_t )type;
+    header[1] = ( uint8_t )( msg_id >> 8 );
+    header[2] = ( uint8_t )( msg_id );
+    header[3] = ( uint8_t )( body_len >> 24 );
+    header[4] = ( uint8_t )( body_len >> 16 );
+    header[5] = ( uint8_t )( body_len >> 8 );
+    header[6] = ( uint8_t )( body_len );
+}
+
+static void xi_session_log_free_entries( xi_session_log_t* log )
+{
+    while ( NULL != log->entries )
+    {
+        xi_session_log_entry_t* entry = NULL;
+        XI_LIST_POP( xi_session_log_entry_t, log->entries, entry );
+        XI_SAFE_FREE( entry );
+    }
+
+    log->live_bytes = 0;
+}
+
+void xi_session_log_reset( xi_session_log_t* log )
+{
+    assert( NULL != log );
+
+    xi_session_log_close( log );
+    xi_session_log_free_entries( log );
+
+    if ( 0 != log->write_offset )
+    {
+        xi_internals.fs_functions.remove_resource( NULL, XI_FS_CONFIG_DATA,
+                                                   log->log_names[log->slot] );
+    }
+
+    log->write_offset   = 0;
+    log->replay_pending = 0;
+}
+
+/* writes the unacknowledged publications only to the other resource under the next
+ * generation, there is no rename in the filesystem api. The generation is written last
+ * and the handle closed, which takes the data out of the write buffer, before the
+ * current log is removed. On failure the current log stays in use as it is. */
+static xi_state_t xi_session_log_compact( xi_session_log_t* log )
+{
+    xi_state_t state               = XI_STATE_OK;
+    uint8_t* buffer                = NULL;
+    size_t offset                  = 0;
+    xi_session_log_entry_t* entry  = log->entries;
+    xi_fs_resource_handle_t handle = xi_fs_init_resource_handle();
+    const uint8_t slot             = ( uint8_t )( log->slot ^ 1 );
+    const uint32_t generation      = xi_session_log_next_generation( log->generation );
+
+    if ( NULL == log->entries )
+    {
+        xi_session_log_reset( log );
+        return XI_STATE_OK;
+    }
+
+    XI_ALLOC_BUFFER_AT( uint8_t, buffer, log->live_bytes, state );
+
+    for ( ; NULL != entry; entry = entry->__next )
+    {
+        XI_CHECK_STATE( state = xi_session_log_read_exact( log, entry->offset,
+                                                           buffer + offset,
+                                                           entry->size ) );
+        offset += entry->size;
+    }
+
+    XI_CHECK_STATE( state = xi_internals.fs_functions.open_resource(
+                        NULL, XI_FS_CONFIG_DATA, log->log_names[slot], XI_FS_OPEN_WRITE,
+                        &handle ) );
+    XI_CHECK_STATE( state = xi_session_log_write_at( handle, buffer, log->live_bytes,
+                                                     XI_SESSION_LOG_FILE_HEADER_SIZE ) );
+    XI_CHECK_STATE( state = xi_session_log_write_generation( handle, generation ) );
+
+    state  = xi_internals.fs_functions.close_resource( NULL, handle );
+    handle = xi_fs_init_resource_handle();
+    XI_CHECK_STATE( state );
+
+    XI_SAFE_FREE( buffer );
+
+    /* the new log is complete, the previous one can go */
+    xi_session_log_close( log );
+    xi_internals.fs_functions.remove_resource( NULL, XI_FS_CONFIG_DATA,
+                                               log->log_names[log->slot] );
+
+    log->slot       = slot;
+    log->generation = generation;
+
+    offset = XI_SESSION_LOG_FILE_HEADER_SIZE;
+
+    for ( entry = log->entries; NULL != entry; entry = entry->__next )
+    {
+        entry->offset = offset;
+        offset += entry->size;
+    }
+
+    log->write_offset = offset;
+
+    return xi_session_log_open( log, 0 );
+
+err_handling:
+    xi_debug_format( "session log compaction failed with state: %d", state );
+
+    if ( XI_FS_INVALID_RESOURCE_HANDLE != handle )
+    {
+        xi_internals.fs_functions.close_resource( NULL, handle );
+    }
+
+    xi_internals.fs_functions.remove_resource( NULL, XI_FS_CONFIG_DATA,
+                                               log->log_names[slot] );
+    XI_SAFE_FREE( buffer );
+
+    return state;
+}
+
+/* picks up the newest complete log left by a previous instance and removes the other
+ * resource, a PUBACK removes the matching publish from the entries, a truncated tail or
+ * an unknown record ends the log */
+static xi_state_t xi_session_log_recover( xi_session_log_t* log )
+{
+    xi_fs_stat_t resource_stat = {.resource_size = 0};
+    const uint32_t generations[2] = {xi_session_log_read_generation( log, 0 ),
+                                     xi_session_log_read_generation( log, 1 )};
+
+    /* serial number arithmetic, the generation may wrap around */
+    log->slot = ( 0 != generations[1] &&
+                  ( 0 == generations[0] ||
+                    0 < ( int32_t )( generations[1] - generations[0] ) ) )
+                    ? 1
+                    : 0;
+    log->generation = generations[log->slot];
+
+    /* an older log or one whose writing hasn't been completed */
+    xi_internals.fs_functions.remove_resource( NULL, XI_FS_CONFIG_DATA,
+                                               log->log_names[log->slot ^ 1] );
+
+    if ( 0 == log->generation )
+    {
+        xi_internals.fs_functions.remove_resource( NULL, XI_FS_CONFIG_DATA,
+                                                   log->log_names[log->slot] );
+        return XI_STATE_OK;
+    }
+
+    xi_state_t state = xi_internals.fs_functions.stat_resource(
+        NULL, XI_FS_CONFIG_DATA, log->log_names[log->slot], &resource_stat );
+
+    if ( XI_STATE_OK != state ||
+         XI_SESSION_LOG_FILE_HEADER_SIZE >= resource_stat.resource_size )
+    {
+        log->write_offset = resource_stat.resource_size;
+        xi_session_log_reset( log );
+        return XI_STATE_OK;
+    }
+
+    /* from now on the resource is removed on reset */
+    log->write_offset = resource_stat.resource_size;
+
+    XI_CHECK_STATE( state = xi_session_log_open( log, 0 ) );
+
+    size_t offset = XI_SESSION_LOG_FILE_HEADER_SIZE;
+
+    while ( offset + XI_SESSION_LOG_RECORD_HEADER_SIZE <= resource_stat.resource_size )
+    {
+        uint8_t header[XI_SESSION_LOG_RECORD_HEADER_SIZE] = {0};
+        xi_session_log_entry_t* entry                     = NULL;
+
+        XI_CHECK_STATE( state = xi_session_log_read_exact( log, offset, header,
+                                                           sizeof( header ) ) );
+
+        const uint16_t msg_id    = ( uint16_t )( ( header[1] << 8 ) | header[2] );
+        const size_t record_size = XI_SESSION_LOG_RECORD_HEADER_SIZE +
+                                   ( ( ( size_t )header[3] << 24 ) |
+                                     ( ( size_t )header[4] << 16 ) |
+                                     ( ( size_t )header[5] << 8 ) | header[6] );
+
+        if ( offset + record_size > resource_stat.resource_size )
+        {
+            break;
+        }
+
+        if ( XI_SESSION_LOG_RECORD_PUBLISH == header[0] )
+        {
+            XI_ALLOC_AT( xi_session_log_entry_t, entry, state );
+
+            entry->offset = offset;
+            entry->size   = record_size;
+            entry->msg_id = msg_id;
+
+            XI_LIST_PUSH_BACK( xi_session_log_entry_t, log->entries, entry );
+
+            log->live_bytes += record_size;
+            log->last_msg_id = msg_id;
+        }
+        else if ( XI_SESSION_LOG_RECORD_PUBACK == header[0] )
+        {
+            XI_LIST_FIND( xi_session_log_entry_t, log->entries, XI_SESSION_LOG_CMP_MSG_ID,
+                          msg_id, entry );
+
+            if ( NULL != entry )
+            {
+                XI_LIST_DROP( xi_session_log_entry_t, log->entries, entry );
+                log->live_bytes -= entry->size;
+                XI_SAFE_FREE( entry );
+            }
+        }
+        else
+        {
+            break;
+        }
+
+        offset += record_size;
+    }
+
+    xi_debug_format( "recovered session log of %zu bytes, %zu of them unacknowledged",
+                     offset, log->live_bytes );
+
+    log->replay_pending = ( NULL != log->entries ) ? 1 : 0;
+
+    /* the tail has to go as well, if that fails the appends continue after the last
+     * complete record */
+    if ( XI_SESSION_LOG_FILE_HEADER_SIZE + log->live_bytes !=
+         resource_stat.resource_size )
+    {
+        log->write_offset = offset;
+        return xi_session_log_compact( log );
+    }
+
+    return XI_STATE_OK;
+
+err_handling:
+    xi_session_log_reset( log );
+    return state;
+}
+
+xi_session_log_t* xi_session_log_create( const char* log_name )
+{
+    assert( NULL != log_name );
+
+    xi_state_t state = XI_STATE_OK;
+
+    XI_ALLOC( xi_session_log_t, log, state );
+
+    log->log_handle = xi_fs_init_resource_handle();
+
+    const size_t name_len = strlen( log_name );
+
+    log->log_names[0] = xi_str_dup( log_name );
+    XI_CHECK_MEMORY( log->log_names[0], state );
+
+    XI_ALLOC_BUFFER_AT( char, log->log_names[1],
+                        name_len + sizeof( XI_SESSION_LOG_ALT_SUFFIX ), state );
+    memcpy( log->log_names[1], log_name, name_len );
+    memcpy( log->log_names[1] + name_len, XI_SESSION_LOG_ALT_SUFFIX,
+            sizeof( XI_SESSION_LOG_ALT_SUFFIX ) );
+
+    xi_session_log_recover( log );
+
+    return log;
+
+err_handling:
+    if ( NULL != log )
+    {
+        XI_SAFE_FREE( log->log_names[0] );
+    }
+    XI_SAFE_FREE( log );
+    return NULL;
+}
+
+void xi_session_log_destroy( xi_session_log_t** log )
+{
+    if ( NULL == log || NULL == *log )
+    {
+        return;
+    }
+
+    /* keep the resource for the next run */
+    xi_session_log_close( *log );
+    xi_session_log_free_entries( *log );
+
+    XI_SAFE_FREE( ( *log )->log_names[0] );
+    XI_SAFE_FREE( ( *log )->log_names[1] );
+    XI_SAFE_FREE( *log );
+}
+
+static xi_state_t xi_session_log_append_record( xi_session_log_t* log,
+                                                xi_session_log_record_type_t type,
+                                                uint16_t msg_id,
+                                                const uint8_t* publish_header,
+                                                const char* topic,
+                                                const xi_data_desc_t* data )
+{
+    xi_state_t state       = XI_STATE_OK;
+    const size_t topic_len = ( NULL != topic ) ? strlen( topic ) : 0;
+    const size_t body_len =
+        ( NULL != publish_header )
+            ? XI_SESSION_LOG_PUBLISH_HEADER_SIZE + topic_len + data->length
+            : 0;
+    size_t offset = log->write_offset;
+
+    uint8_t header[XI_SESSION_LOG_RECORD_HEADER_SIZE] = {0};
+
+    if ( XI_FS_INVALID_RESOURCE_HANDLE == log->log_handle )
+    {
+        XI_CHECK_STATE( state = xi_session_log_open( log, 0 == log->write_offset ) );
+    }
+
+    /* a new log */
+    if ( 0 == offset )
+    {
+        const uint32_t generation = xi_session_log_next_generation( log->generation );
+
+        XI_CHECK_STATE(
+            state = xi_session_log_write_generation( log->log_handle, generation ) );
+
+        log->generation = generation;
+        offset          = XI_SESSION_LOG_FILE_HEADER_SIZE;
+    }
+
+    xi_session_log_encode_record_header( header, type, msg_id, ( uint32_t )body_len );
+
+    XI_CHECK_STATE( state = xi_session_log_write_at( log->log_handle, header,
+                                                     sizeof( header ), offset ) );
+    offset += sizeof( header );
+
+    if ( NULL != publish_header )
+    {
+        XI_CHECK_STATE( state = xi_session_log_write_at(
+                            log->log_handle, publish_header,
+                            XI_SESSION_LOG_PUBLISH_HEADER_SIZE, offset ) );
+        offset += XI_SESSION_LOG_PUBLISH_HEADER_SIZE;
+
+        XI_CHECK_STATE( state = xi_session_log_write_at( log->log_handle,
+                                                         ( const uint8_t* )topic,
+                                                         topic_len, offset ) );
+        offset += topic_len;
+
+        XI_CHECK_STATE( state = xi_session_log_write_at( log->log_handle,
+                                                         data->data_ptr,
+                                                         data->length, offset ) );
+        offset += data->length;
+    }
+
+    log->write_offset = offset;
+
+    return XI_STATE_OK;
+
+err_handling:
+    /* a partially written record is never accounted, the next write overwrites it */
+    xi_debug_format( "session log write failed with state: %d", state );
+    return state;
+}
+
+xi_state_t xi_session_log_append_publish( xi_session_log_t* log,
+                                          uint16_t msg_id,
+                                          const char* topic,
+                                          const xi_data_desc_t* data,
+                                          const xi_mqtt_qos_t qos,
+                                          const xi_mqtt_retain_t retain )
+{
+    assert( NULL != log );
+
+    if ( NULL == topic || NULL == data )
+    {
+        return XI_INVALID_PARAMETER;
+    }
+
+    xi_state_t state              = XI_STATE_OK;
+    const size_t topic_len        = strlen( topic );
+    xi_session_log_entry_t* entry = NULL;
+
+    uint8_t publish_header[XI_SESSION_LOG_PUBLISH_HEADER_SIZE] = {
+        ( uint8_t )qos, ( uint8_t )retain, ( uint8_t )( topic_len >> 8 ),
+        ( uint8_t )( topic_len )};
+
+    if ( XI_MAX16_t < topic_len )
+    {
+        return XI_NO_MORE_RESOURCE_AVAILABLE;
+    }
+
+    XI_ALLOC_AT( xi_session_log_entry_t, entry, state );
+
+    XI_CHECK_STATE( state = xi_session_log_append_record(
+                        log, XI_SESSION_LOG_RECORD_PUBLISH, msg_id, publish_header,
+                        topic, data ) );
+
+    /* the record is the last thing written, a new log starts with its header */
+    entry->size = XI_SESSION_LOG_RECORD_HEADER_SIZE + XI_SESSION_LOG_PUBLISH_HEADER_SIZE +
+                  topic_len + data->length;
+    entry->offset = log->write_offset - entry->size;
+    entry->msg_id = msg_id;
+
+    XI_LIST_PUSH_BACK( xi_session_log_entry_t, log->entries, entry );
+
+    log->live_bytes += entry->size;
+    log->last_msg_id = msg_id;
+
+    return XI_STATE_OK;
+
+err_handling:
+    XI_SAFE_FREE( entry );
+    return state;
+}
+
+xi_state_t xi_session_log_append_puback( xi_session_log_t* log, uint16_t msg_id )
+{
+    assert( NULL != log );
+
+    xi_session_log_entry_t* entry = NULL;
+
+    XI_LIST_FIND( xi_session_log_entry_t, log->entries, XI_SESSION_LOG_CMP_MSG_ID, msg_id,
+                  entry );
+
+    if ( NULL == entry )
+    {
+        return XI_STATE_OK;
+    }
+
+    XI_LIST_DROP( xi_session_log_entry_t, log->entries, entry );
+    log->live_bytes -= entry->size;
+    XI_SAFE_FREE( entry );
+
+    /* nothing left to replay, there is no point in keeping the resource */
+    if ( NULL == log->entries )
+    {
+        xi_session_log_reset( log );
+        return XI_STATE_OK;
+    }
+
+    xi_state_t state = xi_session_log_append_record( log, XI_SESSION_LOG_RECORD_PUBACK,
+                                                     msg_id, NULL, NULL, NULL );
+
+    if ( XI_STATE_OK == state &&
+         XI_SESSION_LOG_COMPACTION_THRESHOLD < log->write_offset &&
+         log->live_bytes <
+             log->write_offset - XI_SESSION_LOG_FILE_HEADER_SIZE - log->live_bytes )
+    {
+        state = xi_session_log_compact( log );
+    }
+
+    return state;
+}
+
+xi_state_t xi_session_log_read_publish( xi_session_log_t* log,
+                                        const xi_session_log_entry_t* entry,
+                                        char** topic,
+                                        xi_data_desc_t** data,
+                                        xi_mqtt_retain_t* retain )
+{
+    assert( NULL != log );
+    assert( NULL != entry );
+
+    xi_state_t state = XI_STATE_OK;
+    uint8_t publish_header[XI_SESSION_LOG_PUBLISH_HEADER_SIZE] = {0};
+
+    const size_t body_offset = entry->offset + XI_SESSION_LOG_RECORD_HEADER_SIZE;
+
+    if ( NULL == topic || NULL == data || NULL == retain )
+    {
+        return XI_INVALID_PARAMETER;
+    }
+
+    *topic = NULL;
+    *data  = NULL;
+
+    XI_CHECK_STATE( state = xi_session_log_read_exact( log, body_offset, publish_header,
+                                                       sizeof( publish_header ) ) );
+
+    const size_t topic_len = ( ( size_t )publish_header[2] << 8 ) | publish_header[3];
+    const size_t payload_len = entry->size - XI_SESSION_LOG_RECORD_HEADER_SIZE -
+                               XI_SESSION_LOG_PUBLISH_HEADER_SIZE - topic_len;
+
+    XI_ALLOC_BUFFER_AT( char, *topic, topic_len + 1, state );
+
+    *data = xi_make_empty_desc_alloc( XI_MAX( payload_len, 1 ) );
+    XI_CHECK_MEMORY( *data, state );
+
+    XI_CHECK_STATE( state = xi_session_log_read_exact(
+                        log, body_offset + sizeof( publish_header ),
+                        ( uint8_t* )*topic, topic_len ) );
+    XI_CHECK_STATE( state = xi_session_log_read_exact(
+                        log, body_offset + sizeof( publish_header ) + topic_len,
+                        ( *data )->data_ptr, payload_len ) );
+
+    ( *data )->length = payload_len;
+    *retain           = ( xi_mqtt_retain_t )publish_header[1];
+
+    return XI_STATE_OK;
+
+err_handling:
+    XI_SAFE_FREE( *topic );
+    xi_free_desc( data );
+    return state;
+}
+
+#ifdef __cplusplus
+}
+#endif
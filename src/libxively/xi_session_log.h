@@ -0,0 +1,133 @@
+/* Copyright (c) 2003-2018, Xively All rights reserved.
+ *
+ * This is part of the Xively C Client library,
+ * it is licensed under the BSD 3-Clause license.
+ */
+
+#ifndef __XI_SESSION_LOG_H__
+#define __XI_SESSION_LOG_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <xively_types.h>
+
+#include "xi_data_desc.h"
+#include "xi_fs_api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* size of the header in front of the records: generation (4 bytes), 0 marks a log
+ * whose writing hasn't been completed */
+#define XI_SESSION_LOG_FILE_HEADER_SIZE 4
+
+/* the log alternates between the resource of its name and the one with this suffix */
+#define XI_SESSION_LOG_ALT_SUFFIX ".alt"
+
+/* size of the record header: type (1 byte), message id (2 bytes), body length (4 bytes)
+ */
+#define XI_SESSION_LOG_RECORD_HEADER_SIZE 7
+
+/* size of the publish body header stored in front of topic and payload:
+ * qos (1 byte), retain (1 byte), topic length (2 bytes) */
+#define XI_SESSION_LOG_PUBLISH_HEADER_SIZE 4
+
+typedef enum xi_session_log_record_type_e {
+    XI_SESSION_LOG_RECORD_PUBLISH = 1,
+    XI_SESSION_LOG_RECORD_PUBACK
+} xi_session_log_record_type_t;
+
+/* a publish record that has not been acknowledged yet */
+typedef struct xi_session_log_entry_s
+{
+    struct xi_session_log_entry_s* __next;
+    size_t offset;
+    size_t size;
+    uint16_t msg_id;
+} xi_session_log_entry_t;
+
+/**
+ * @struct xi_session_log_t
+ *
+ * Append-only log of the QoS1 publications that have been written to the broker but
+ * not acknowledged yet. Every PUBLISH is followed by a PUBACK record once the broker
+ * acknowledges it, only the publications without one are kept in the entries list.
+ * The log is compacted whenever it is left without unacknowledged publications or
+ * when it grows over XI_SESSION_LOG_COMPACTION_THRESHOLD and most of it is dead.
+ *
+ * The compacted log is written to the other one of two resources, the log name and the
+ * name with XI_SESSION_LOG_ALT_SUFFIX, under the next generation number, the header
+ * goes last. The previous resource is removed only once the new one is complete, so a
+ * crash in between leaves at least one complete log and the newest one is picked.
+ *
+ * A log left by a previous run of the application is recovered on creation and its
+ * publications are replayed once, on the first XI_SESSION_CONTINUE connection.
+ */
+typedef struct xi_session_log_s
+{
+    xi_session_log_entry_t* entries;
+    char* log_names[2];
+    xi_fs_resource_handle_t log_handle;
+    uint32_t generation;
+    uint8_t slot; /* index of the log_names in use */
+    size_t write_offset;
+    size_t live_bytes;
+    uint16_t last_msg_id;
+    uint8_t replay_pending;
+} xi_session_log_t;
+
+/**
+ * @brief xi_session_log_create allocates the log and recovers the resource left by a
+ * previous instance, a truncated tail is ignored
+ *
+ * @return new log or NULL if out of memory
+ */
+extern xi_session_log_t* xi_session_log_create( const char* log_name );
+
+/**
+ * @brief xi_session_log_destroy releases the log, the resource is left intact so that
+ * the unacknowledged publications can be replayed by the next instance
+ */
+extern void xi_session_log_destroy( xi_session_log_t** log );
+
+/**
+ * @brief xi_session_log_append_publish records a publication written to the broker
+ */
+extern xi_state_t xi_session_log_append_publish( xi_session_log_t* log,
+                                                 uint16_t msg_id,
+                                                 const char* topic,
+                                                 const xi_data_desc_t* data,
+                                                 const xi_mqtt_qos_t qos,
+                                                 const xi_mqtt_retain_t retain );
+
+/**
+ * @brief xi_session_log_append_puback records the end of the publication with msg_id
+ *
+ * Unknown ids are ignored. The log may be compacted on the way.
+ */
+extern xi_state_t xi_session_log_append_puback( xi_session_log_t* log, uint16_t msg_id );
+
+/**
+ * @brief xi_session_log_read_publish reads back the publication of a log entry
+ *
+ * @param [out] topic allocated copy of the topic, has to be released by the caller
+ * @param [out] data allocated copy of the payload, has to be released by the caller
+ */
+extern xi_state_t xi_session_log_read_publish( xi_session_log_t* log,
+                                               const xi_session_log_entry_t* entry,
+                                               char** topic,
+                                               xi_data_desc_t** data,
+                                               xi_mqtt_retain_t* retain );
+
+/**
+ * @brief xi_session_log_reset forgets all of the publications and removes the resources
+ */
+extern void xi_session_log_reset( xi_session_log_t* log );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __XI_SESSION_LOG_H__ */
@@ -0,0 +1,224 @@
+/* Copyright (c) 2003-2018, Xively All rights reserved.
+ *
+ * This is part of the Xively C Client library,
+ * it is licensed under the BSD 3-Clause license.
+ */
+
+#include <string.h>
+
+#include "xi_stats.h"
+#include "xi_bsp_time.h"
+#include "xi_macros.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+xi_stats_t xi_stats;
+
+/* The ring buffer of trace events, written only by the event loop thread and read by
+ * any. Each entry works as a seqlock, its sequence is invalidated before the payload is
+ * written and set after, the reader drops an entry whose sequence changed meanwhile.
+ * Volatile alone doesn't order the stores as seen by another core, the atomic builtins
+ * do, without them the trace can be read only by the event loop thread. */
+#ifdef __ATOMIC_ACQUIRE
+#define XI_STATS_STORE( dst, value, order ) __atomic_store_n( &( dst ), value, order )
+#define XI_STATS_LOAD( src, order ) __atomic_load_n( &( src ), order )
+#define XI_STATS_FENCE( order ) __atomic_thread_fence( order )
+#define XI_STATS_RELAXED __ATOMIC_RELAXED
+#define XI_STATS_ACQUIRE __ATOMIC_ACQUIRE
+#define XI_STATS_RELEASE __ATOMIC_RELEASE
+#else
+#define XI_STATS_STORE( dst, value, order ) ( dst ) = ( value )
+#define XI_STATS_LOAD( src, order ) ( src )
+#define XI_STATS_FENCE( order )
+#endif
+
+static xi_stats_trace_event_t* xi_stats_trace_buffer = NULL;
+static size_t xi_stats_trace_buffer_size             = 0;
+static uint32_t xi_stats_trace_written               = 0;
+
+static void
+xi_stats_trace( xi_stats_trace_event_type_t type, uint16_t id, uint32_t value )
+{
+    if ( NULL == xi_stats_trace_buffer )
+    {
+        return;
+    }
+
+    const uint32_t sequence = xi_stats_trace_written;
+    const uint32_t timestamp_ms =
+        ( uint32_t )xi_bsp_time_getcurrenttime_milliseconds();
+    xi_stats_trace_event_t* event =
+        &xi_stats_trace_buffer[sequence % xi_stats_trace_buffer_size];
+
+    /* invalidate first so that a reader copying the entry meanwhile drops it, the fence
+     * keeps the payload stores behind the invalidation */
+    XI_STATS_STORE( event->sequence, sequence - 1, XI_STATS_RELAXED );
+    XI_STATS_FENCE( XI_STATS_RELEASE );
+
+    XI_STATS_STORE( event->timestamp_ms, timestamp_ms, XI_STATS_RELAXED );
+    XI_STATS_STORE( event->type, ( uint16_t )type, XI_STATS_RELAXED );
+    XI_STATS_STORE( event->id, id, XI_STATS_RELAXED );
+    XI_STATS_STORE( event->value, value, XI_STATS_RELAXED );
+
+    XI_STATS_STORE( event->sequence, sequence, XI_STATS_RELEASE );
+    XI_STATS_STORE( xi_stats_trace_written, sequence + 1, XI_STATS_RELEASE );
+}
+
+/* the bucket is the number of significant bits of the duration */
+static uint8_t xi_stats_latency_bucket( xi_time_t duration )
+{
+    uint8_t bucket = 0;
+
+    for ( ; 0 != ( duration >> bucket ) && bucket < XI_STATS_LATENCY_BUCKETS_COUNT - 1;
+          ++bucket )
+        ;
+
+    return bucket;
+}
+
+void xi_stats_record_layer_call( int layer_type_id, xi_time_t duration_us )
+{
+    if ( 0 > layer_type_id || XI_STATS_LAYERS_COUNT <= layer_type_id )
+    {
+        return;
+    }
+
+    if ( 0 > duration_us )
+    {
+        duration_us = 0;
+    }
+
+    xi_stats.layers[layer_type_id].calls += 1;
+    xi_stats.layers[layer_type_id]
+        .latency_histogram[xi_stats_latency_bucket( duration_us )] += 1;
+
+    xi_stats_trace( XI_STATS_TRACE_LAYER_CALL, ( uint16_t )layer_type_id,
+                    ( uint32_t )duration_us );
+}
+
+void xi_stats_count_layer_call( int layer_type_id )
+{
+    if ( 0 > layer_type_id || XI_STATS_LAYERS_COUNT <= layer_type_id )
+    {
+        return;
+    }
+
+    xi_stats.layers[layer_type_id].calls += 1;
+
+    xi_stats_trace( XI_STATS_TRACE_LAYER_CALL, ( uint16_t )layer_type_id, 0 );
+}
+
+void xi_stats_record_select( xi_time_t wait_ms, xi_time_t ready_ms, uint8_t socket_ready )
+{
+    xi_stats.select_calls += 1;
+    xi_stats.select_ready_calls += socket_ready;
+    xi_stats.select_wait_ms += ( 0 < wait_ms ) ? ( uint64_t )wait_ms : 0;
+    xi_stats.select_ready_ms += ( 0 < ready_ms ) ? ( uint64_t )ready_ms : 0;
+
+    xi_stats_trace( XI_STATS_TRACE_SELECT, socket_ready,
+                    ( 0 < wait_ms ) ? ( uint32_t )wait_ms : 0 );
+}
+
+void xi_stats_record_evtd_step( uint32_t timer_heap_size,
+                                uint32_t handles_run,
+                                uint8_t calls_left )
+{
+    xi_stats.evtd_steps += 1;
+    xi_stats.evtd_steps_over_budget += calls_left;
+    xi_stats.timer_heap_size     = timer_heap_size;
+    xi_stats.timer_heap_size_max =
+        XI_MAX( xi_stats.timer_heap_size_max, timer_heap_size );
+    xi_stats.evtd_queue_depth_max = XI_MAX( xi_stats.evtd_queue_depth_max, handles_run );
+
+    xi_stats_trace( XI_STATS_TRACE_EVTD_STEP, 0, handles_run );
+}
+
+void xi_stats_record_publish( xi_publish_priority_t priority, xi_time_t latency_ms )
+{
+    if ( XI_PUBLISH_PRIORITY_COUNT <= ( unsigned )priority )
+    {
+        return;
+    }
+
+    if ( 0 > latency_ms )
+    {
+        latency_ms = 0;
+    }
+
+    xi_publish_priority_stats_t* stats = &xi_stats.publish[priority];
+
+    stats->messages += 1;
+    stats->latency_total_ms += ( uint64_t )latency_ms;
+    stats->latency_max_ms = XI_MAX( stats->latency_max_ms, ( uint32_t )latency_ms );
+    stats->latency_histogram[xi_stats_latency_bucket( latency_ms )] += 1;
+}
+
+void xi_stats_set_trace_buffer( xi_stats_trace_event_t* buffer, size_t size )
+{
+    xi_stats_trace_buffer      = ( 0 < size ) ? buffer : NULL;
+    xi_stats_trace_buffer_size = ( NULL != buffer ) ? size : 0;
+    XI_STATS_STORE( xi_stats_trace_written, 0, XI_STATS_RELEASE );
+}
+
+size_t xi_stats_read_trace( xi_stats_trace_event_t* events,
+                            size_t max_events,
+                            uint32_t* sequence )
+{
+    xi_stats_trace_event_t* const buffer = xi_stats_trace_buffer;
+    const size_t buffer_size             = xi_stats_trace_buffer_size;
+    const uint32_t written = XI_STATS_LOAD( xi_stats_trace_written, XI_STATS_ACQUIRE );
+    size_t events_count    = 0;
+
+    if ( NULL == buffer )
+    {
+        return 0;
+    }
+
+    uint32_t next = *sequence;
+
+    /* the older ones have already been overwritten, a sequence ahead of the writer
+     * comes from before the buffer was set */
+    if ( buffer_size < written - next )
+    {
+        next = ( buffer_size < written ) ? written - ( uint32_t )buffer_size : 0;
+    }
+
+    for ( ; next != written && events_count < max_events; ++next )
+    {
+        xi_stats_trace_event_t* event = &buffer[next % buffer_size];
+        xi_stats_trace_event_t* copy  = &events[events_count];
+
+        copy->sequence     = XI_STATS_LOAD( event->sequence, XI_STATS_ACQUIRE );
+        copy->timestamp_ms = XI_STATS_LOAD( event->timestamp_ms, XI_STATS_RELAXED );
+        copy->type         = XI_STATS_LOAD( event->type, XI_STATS_RELAXED );
+        copy->id           = XI_STATS_LOAD( event->id, XI_STATS_RELAXED );
+        copy->value        = XI_STATS_LOAD( event->value, XI_STATS_RELAXED );
+
+        /* keeps the second read of the sequence behind the payload loads */
+        XI_STATS_FENCE( XI_STATS_ACQUIRE );
+
+        /* the writer has lapped the reader during the copy */
+        if ( next != copy->sequence ||
+             next != XI_STATS_LOAD( event->sequence, XI_STATS_RELAXED ) )
+        {
+            continue;
+        }
+
+        ++events_count;
+    }
+
+    *sequence = next;
+
+    return events_count;
+}
+
+void xi_stats_reset( void )
+{
+    memset( &xi_stats, 0, sizeof( xi_stats ) );
+}
+
+#ifdef __cplusplus
+}
+#endif
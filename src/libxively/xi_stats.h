@@ -0,0 +1,99 @@
+/* Copyright (c) 2003-2018, Xively All rights reserved.
+ *
+ * This is part of the Xively C Client library,
+ * it is licensed under the BSD 3-Clause license.
+ */
+
+#ifndef __XI_STATS_H__
+#define __XI_STATS_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <xively_types.h>
+#include <xively_time.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* process wide counters, see xi_get_stats, plain increments are enough since the
+ * counters are allowed to be approximate */
+extern xi_stats_t xi_stats;
+
+#define XI_STATS_INC( counter ) ( ++xi_stats.counter )
+#define XI_STATS_ADD( counter, value ) ( xi_stats.counter += ( value ) )
+
+/**
+ * @brief xi_stats_record_layer_call accounts a call of a layer function and its
+ * duration
+ *
+ * @param layer_type_id type id of the layer that was called
+ * @param duration_us time spent in the call in microseconds
+ */
+extern void xi_stats_record_layer_call( int layer_type_id, xi_time_t duration_us );
+
+/**
+ * @brief xi_stats_count_layer_call accounts a call of a layer function which was not
+ * timed, the latency histogram of the layer is left untouched
+ *
+ * @param layer_type_id type id of the layer that was called
+ */
+extern void xi_stats_count_layer_call( int layer_type_id );
+
+/**
+ * @brief xi_stats_record_select accounts one iteration of the event loop
+ *
+ * @param wait_ms time blocked in the select
+ * @param ready_ms time spent on processing the events that followed the select
+ * @param socket_ready 1 if the select returned because of a socket
+ */
+extern void
+xi_stats_record_select( xi_time_t wait_ms, xi_time_t ready_ms, uint8_t socket_ready );
+
+/**
+ * @brief xi_stats_record_evtd_step accounts one step of an event dispatcher
+ *
+ * @param timer_heap_size number of the time events pending when the step started
+ * @param handles_run number of handles run from the queue by the step
+ * @param calls_left 1 if the step ran out of its budget with handles still queued
+ */
+extern void xi_stats_record_evtd_step( uint32_t timer_heap_size,
+                                       uint32_t handles_run,
+                                       uint8_t calls_left );
+
+/**
+ * @brief xi_stats_record_publish accounts a publication written to the socket
+ *
+ * @param priority class of the publication
+ * @param latency_ms time the publication spent in the outbound queues
+ */
+extern void xi_stats_record_publish( xi_publish_priority_t priority,
+                                     xi_time_t latency_ms );
+
+/**
+ * @brief xi_stats_set_trace_buffer starts writing the trace events into the ring
+ * buffer, NULL stops it. The sequence of the events starts from 0.
+ */
+extern void xi_stats_set_trace_buffer( xi_stats_trace_event_t* buffer, size_t size );
+
+/**
+ * @brief xi_stats_read_trace copies the trace events from *sequence on
+ *
+ * There is a single writer, the thread running the event loop, and no lock. Events
+ * overwritten before they could be copied are skipped.
+ *
+ * @param [in,out] sequence the first event to copy, on return the next one to copy
+ * @return number of the events copied
+ */
+extern size_t xi_stats_read_trace( xi_stats_trace_event_t* events,
+                                   size_t max_events,
+                                   uint32_t* sequence );
+
+extern void xi_stats_reset( void );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __XI_STATS_H__ */
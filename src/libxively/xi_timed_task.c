@@ -7,7 +7,9 @@
 #include "xi_timed_task.h"
 #include "xi_handle.h"
 
+#ifndef XI_MAX_TIMED_EVENT
 #define XI_MAX_TIMED_EVENT 64
+#endif
 
 typedef enum { XI_TTS_SCHEDULED, XI_TTS_RUNNING, XI_TTS_DELETABLE } xi_timed_task_state_e;
 
@@ -15,6 +17,7 @@ typedef struct xi_timed_task_data_s
 {
     xi_user_task_callback_t* callback;
     xi_context_handle_t context_handle;
+    xi_timed_task_handle_t task_handle;
     void* data;
     xi_time_event_handle_t delayed_event;
     xi_evtd_instance_t* dispatcher;
@@ -30,12 +33,14 @@ xi_timed_task_container_t* xi_make_timed_task_container()
 
     XI_ALLOC( xi_timed_task_container_t, container, state );
 
-    container->timed_tasks_vector = xi_vector_create();
+    container->timed_tasks_vector = xi_handle_table_create( XI_MAX_TIMED_EVENT );
+    XI_CHECK_MEMORY( container->timed_tasks_vector, state );
     XI_CHECK_STATE( state = xi_init_critical_section( &container->cs ) );
 
     return container;
 
 err_handling:
+    xi_handle_table_destroy( &container->timed_tasks_vector );
     XI_SAFE_FREE( container );
     return NULL;
 }
@@ -43,7 +48,7 @@ err_handling:
 void xi_destroy_timed_task_container( xi_timed_task_container_t* container )
 {
     assert( NULL != container );
-    xi_vector_destroy( container->timed_tasks_vector );
+    xi_handle_table_destroy( &container->timed_tasks_vector );
     xi_destroy_critical_section( &container->cs );
     XI_SAFE_FREE( container );
 }
@@ -61,8 +66,7 @@ xi_timed_task_handle_t xi_add_timed_task( xi_timed_task_container_t* container,
     assert( XI_INVALID_CONTEXT_HANDLE < context_handle );
     assert( NULL != callback );
 
-    xi_state_t state                   = XI_STATE_OK;
-    xi_timed_task_handle_t task_handle = XI_INVALID_CONTEXT_HANDLE;
+    xi_state_t state = XI_STATE_OK;
 
     XI_ALLOC( xi_timed_task_data_t, task, state );
 
@@ -74,13 +78,12 @@ xi_timed_task_handle_t xi_add_timed_task( xi_timed_task_container_t* container,
     task->state          = XI_TTS_SCHEDULED;
 
     xi_lock_critical_section( container->cs );
-    XI_CHECK_STATE( state = xi_register_handle_for_object( container->timed_tasks_vector,
-                                                           XI_MAX_TIMED_EVENT, task ) );
-
-    XI_CHECK_STATE( state = xi_find_handle_for_object( container->timed_tasks_vector,
-                                                       task, &task_handle ) );
+    state = xi_register_handle_for_object( container->timed_tasks_vector, task,
+                                           &task->task_handle );
     xi_unlock_critical_section( container->cs );
 
+    XI_CHECK_STATE( state );
+
     state = xi_evtd_execute_in( dispatcher,
                                 xi_make_handle( &xi_timed_task_callback_wrapper,
                                                 ( void* )task, ( void* )container ),
@@ -88,9 +91,16 @@ xi_timed_task_handle_t xi_add_timed_task( xi_timed_task_container_t* container,
 
     XI_CHECK_STATE( state );
 
-    return task_handle;
+    return task->task_handle;
 
 err_handling:
+    if ( NULL != task && 0 < task->task_handle )
+    {
+        xi_lock_critical_section( container->cs );
+        xi_delete_handle( container->timed_tasks_vector, task->task_handle );
+        xi_unlock_critical_section( container->cs );
+    }
+
     XI_SAFE_FREE( task );
     return -state;
 }
@@ -114,7 +124,7 @@ void xi_remove_timed_task( xi_timed_task_container_t* container,
             state = xi_evtd_cancel( task->dispatcher, &task->delayed_event );
             assert( XI_STATE_OK == state );
 
-            state = xi_delete_handle_for_object( container->timed_tasks_vector, task );
+            state = xi_delete_handle( container->timed_tasks_vector, task->task_handle );
             XI_UNUSED( state );
 
             /* POST-CONDITION */
@@ -138,51 +148,44 @@ xi_state_t xi_timed_task_callback_wrapper( void* void_task, void* void_scheduler
     xi_timed_task_container_t* container = ( xi_timed_task_container_t* )void_scheduler;
     assert( NULL != container );
 
-    xi_state_t state                   = XI_STATE_OK;
-    xi_timed_task_handle_t task_handle = -1;
+    xi_state_t state = XI_STATE_OK;
 
+    /* the task is still registered, xi_remove_timed_task cancels the event of a
+     * scheduled task before it releases it */
     xi_lock_critical_section( container->cs );
-    state =
-        xi_find_handle_for_object( container->timed_tasks_vector, task, &task_handle );
-    if ( XI_STATE_OK == state )
-    {
-        task->state = XI_TTS_RUNNING;
-    }
+    task->state = XI_TTS_RUNNING;
     xi_unlock_critical_section( container->cs );
 
-    if ( XI_STATE_OK == state )
-    {
-        assert( NULL != task->callback );
-        assert( task->context_handle > XI_INVALID_CONTEXT_HANDLE );
-
-        ( task->callback )( task->context_handle, task_handle, task->data );
+    assert( NULL != task->callback );
+    assert( task->context_handle > XI_INVALID_CONTEXT_HANDLE );
 
-        xi_lock_critical_section( container->cs );
+    ( task->callback )( task->context_handle, task->task_handle, task->data );
 
-        if ( 0 == task->seconds_repeat || XI_TTS_DELETABLE == task->state )
-        {
-            xi_state_t del_state =
-                xi_delete_handle_for_object( container->timed_tasks_vector, task );
+    xi_lock_critical_section( container->cs );
 
-            XI_UNUSED( del_state );
+    if ( 0 == task->seconds_repeat || XI_TTS_DELETABLE == task->state )
+    {
+        xi_state_t del_state =
+            xi_delete_handle( container->timed_tasks_vector, task->task_handle );
 
-            /* POST-CONDITION */
-            assert( XI_STATE_OK == del_state );
+        XI_UNUSED( del_state );
 
-            XI_SAFE_FREE( task );
-        }
-        else
-        {
-            state = xi_evtd_execute_in(
-                task->dispatcher, xi_make_handle( &xi_timed_task_callback_wrapper,
-                                                  ( void* )task, ( void* )container ),
-                task->seconds_repeat, &task->delayed_event );
-            assert( XI_STATE_OK == state );
-            task->state = XI_TTS_SCHEDULED;
-        }
+        /* POST-CONDITION */
+        assert( XI_STATE_OK == del_state );
 
-        xi_unlock_critical_section( container->cs );
+        XI_SAFE_FREE( task );
     }
+    else
+    {
+        state = xi_evtd_execute_in(
+            task->dispatcher, xi_make_handle( &xi_timed_task_callback_wrapper,
+                                              ( void* )task, ( void* )container ),
+            task->seconds_repeat, &task->delayed_event );
+        assert( XI_STATE_OK == state );
+        task->state = XI_TTS_SCHEDULED;
+    }
+
+    xi_unlock_critical_section( container->cs );
 
     return state;
 }
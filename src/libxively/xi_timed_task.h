@@ -8,14 +8,14 @@
 #define __XI_TIMED_TASK_H__
 
 #include "xi_types.h"
-#include "xi_vector.h"
+#include "xi_handle.h"
 #include "xi_macros.h"
 #include "xi_critical_section.h"
 
 typedef struct xi_timed_task_container_s
 {
     struct xi_critical_section_s* cs;
-    xi_vector_t* timed_tasks_vector;
+    xi_handle_table_t* timed_tasks_vector;
 } xi_timed_task_container_t;
 
 xi_timed_task_container_t* xi_make_timed_task_container();
@@ -11,6 +11,8 @@
 #include "xi_connection_data.h"
 #include "xi_vector.h"
 #include "xi_event_dispatcher_api.h"
+#include "xi_publish_queue.h"
+#include "xi_session_log.h"
 #include <xively_types.h>
 
 #ifdef __cplusplus
@@ -52,6 +54,7 @@ typedef struct xi_context_data_s
                             solution to the problem of not binding xively interface with
                             layers directly */
     uint16_t copy_of_last_msg_id; /* value of the msg_id for continious session */
+    xi_keepalive_stats_t keepalive_stats;
 #endif
     /* this is the common part */
     xi_time_event_handle_t connect_handler;
@@ -65,6 +68,16 @@ typedef struct xi_context_data_s
     char** updateable_files;
     uint16_t updateable_files_count;
     xi_sft_url_handler_callback_t* sft_url_handler_callback;
+    uint16_t sft_chunk_window_size;
+    uint32_t sft_chunk_size;
+    uint16_t sft_parallel_downloads;
+    uint32_t sft_download_memory_budget;
+
+    /* store-and-forward queue for publications made while offline, NULL if disabled */
+    xi_publish_queue_t* publish_queue;
+
+    /* unacknowledged QoS1 publications kept across restarts, NULL if disabled */
+    xi_session_log_t* session_log;
 } xi_context_data_t;
 
 typedef struct xi_context_s
@@ -72,6 +85,7 @@ typedef struct xi_context_s
     xi_protocol_t protocol;
     xi_layer_chain_t layer_chain;
     xi_context_data_t context_data;
+    xi_context_handle_t context_handle; /* in xi_globals.context_handles_vector */
 } xi_context_t;
 
 #ifdef __cplusplus
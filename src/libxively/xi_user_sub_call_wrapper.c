@@ -35,9 +35,7 @@ xi_state_t xi_user_sub_call_wrapper( void* context,
     /* only if the library context is not null */
     if ( NULL != context )
     {
-        state = xi_find_handle_for_object( xi_globals.context_handles_vector, context,
-                                           &context_handle );
-        XI_CHECK_STATE( state );
+        context_handle = ( ( xi_context_t* )context )->context_handle;
     }
 
     switch ( in_state )
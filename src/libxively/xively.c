@@ -20,6 +20,7 @@
 #include "xi_handle.h"
 #include "xi_helpers.h"
 #include "xi_internals.h"
+#include "xi_io_net_capture.h"
 #include "xi_layer_api.h"
 #include "xi_layer_chain.h"
 #include "xi_layer_default_allocators.h"
@@ -27,6 +28,7 @@
 #include "xi_layer_interface.h"
 #include "xi_layer_macros.h"
 #include "xi_macros.h"
+#include "xi_stats.h"
 #include "xi_timed_task.h"
 #include "xi_version.h"
 #include "xi_list.h"
@@ -206,7 +208,7 @@ xi_state_t xi_create_context_with_custom_layers_and_evtd(
         /* note: this is NULL if thread module is disabled */
         xi_globals.main_threadpool = xi_threadpool_create_instance( 1 );
 
-        xi_globals.context_handles_vector = xi_vector_create();
+        xi_globals.context_handles_vector = xi_handle_table_create( XI_MAX_NUM_CONTEXTS );
         xi_globals.timed_tasks_container  = xi_make_timed_task_container();
     }
 
@@ -227,9 +229,9 @@ xi_state_t xi_create_context_with_custom_layers_and_evtd(
     ( *context )->layer_chain = xi_layer_chain_create(
         layer_chain, layer_chain_size, &( *context )->context_data, layer_config );
 
-    XI_CHECK_STATE( state =
-                        xi_register_handle_for_object( xi_globals.context_handles_vector,
-                                                       XI_MAX_NUM_CONTEXTS, *context ) );
+    XI_CHECK_STATE( state = xi_register_handle_for_object(
+                        xi_globals.context_handles_vector, *context,
+                        &( *context )->context_handle ) );
 
     return XI_STATE_OK;
 
@@ -257,15 +259,10 @@ xi_context_handle_t xi_create_context()
                         &context, xi_layer_types_g, XI_LAYER_CHAIN_DEFAULT,
                         XI_LAYER_CHAIN_DEFAULTSIZE_SUFFIX ) );
 
-    xi_context_handle_t context_handle;
-    XI_CHECK_STATE( state = xi_find_handle_for_object( xi_globals.context_handles_vector,
-                                                       context, &context_handle ) );
+    return context->context_handle;
 
-    goto end;
 err_handling:
     return -state;
-end:
-    return context_handle;
 }
 
 xi_state_t xi_set_device_unique_id( const char* unique_id )
@@ -340,6 +337,9 @@ static void xi_free_context_data( xi_context_t* context )
         XI_SAFE_FREE( context_data->updateable_files );
     }
 
+    xi_publish_queue_destroy( &context_data->publish_queue );
+    xi_session_log_destroy( &context_data->session_log );
+
     xi_free_connection_data( &context_data->connection_data );
 
     /* remember, event dispatcher ownership is not taken, this is why we don't delete
@@ -358,7 +358,8 @@ xi_state_t xi_delete_context_with_custom_layers( xi_context_t** context,
 
     xi_state_t state = XI_STATE_OK;
 
-    state = xi_delete_handle_for_object( xi_globals.context_handles_vector, *context );
+    state = xi_delete_handle( xi_globals.context_handles_vector,
+                              ( *context )->context_handle );
 
     if ( XI_STATE_OK != state )
     {
@@ -382,8 +383,7 @@ xi_state_t xi_delete_context_with_custom_layers( xi_context_t** context,
         xi_globals.evtd_instance = NULL;
         xi_threadpool_destroy_instance( &xi_globals.main_threadpool );
 
-        xi_vector_destroy( xi_globals.context_handles_vector );
-        xi_globals.context_handles_vector = NULL;
+        xi_handle_table_destroy( &xi_globals.context_handles_vector );
 
         xi_destroy_timed_task_container( xi_globals.timed_tasks_container );
         xi_globals.timed_tasks_container = NULL;
@@ -420,15 +420,10 @@ xi_state_t xi_user_callback_wrapper( void* context,
     assert( NULL != client_callback );
     assert( NULL != context );
 
-    xi_state_t state = XI_STATE_OK;
-    xi_context_handle_t context_handle;
-    XI_CHECK_STATE( state = xi_find_handle_for_object( xi_globals.context_handles_vector,
-                                                       context, &context_handle ) );
-
-    ( ( xi_user_callback_t* )( client_callback ) )( context_handle, data, in_state );
+    ( ( xi_user_callback_t* )( client_callback ) )(
+        ( ( xi_context_t* )context )->context_handle, data, in_state );
 
-err_handling:
-    return state;
+    return XI_STATE_OK;
 }
 
 extern uint8_t xi_is_context_connected( xi_context_handle_t xih )
@@ -473,6 +468,40 @@ xi_state_t xi_events_process_tick()
     return XI_EVENT_PROCESS_STOPPED;
 }
 
+xi_state_t xi_events_get_fds( xi_fd_interest_t* fds,
+                              size_t max_fds,
+                              size_t* fds_count,
+                              xi_time_t* timeout_ms )
+{
+    if ( xi_evtd_dispatcher_continue( xi_globals.evtd_instance ) == 1 )
+    {
+        return xi_event_loop_get_fd_interests( xi_globals.evtd_instance, fds, max_fds,
+                                               fds_count, timeout_ms );
+    }
+
+    return XI_EVENT_PROCESS_STOPPED;
+}
+
+xi_state_t xi_notify_fd_ready( intptr_t fd, uint8_t events )
+{
+    if ( xi_evtd_dispatcher_continue( xi_globals.evtd_instance ) == 1 )
+    {
+        return xi_event_loop_notify_fd( xi_globals.evtd_instance, fd, events );
+    }
+
+    return XI_EVENT_PROCESS_STOPPED;
+}
+
+xi_state_t xi_notify_timeout()
+{
+    if ( xi_evtd_dispatcher_continue( xi_globals.evtd_instance ) == 1 )
+    {
+        return xi_event_loop_notify_timeout( xi_globals.evtd_instance );
+    }
+
+    return XI_EVENT_PROCESS_STOPPED;
+}
+
 
 xi_state_t xi_set_updateable_files( xi_context_handle_t xih,
                                     const char** filenames,
@@ -507,6 +536,51 @@ err_handling:
     return state;
 }
 
+xi_state_t xi_set_sft_download_window( xi_context_handle_t xih,
+                                       uint16_t window,
+                                       uint32_t chunk_size )
+{
+    if ( XI_SFT_FILE_CHUNK_WINDOW_MAX < window ||
+         XI_MQTT_MAX_PAYLOAD_SIZE < chunk_size )
+    {
+        return XI_INVALID_PARAMETER;
+    }
+
+    xi_state_t state = XI_STATE_OK;
+    xi_context_t* xi = xi_object_for_handle( xi_globals.context_handles_vector, xih );
+
+    XI_CHECK_CND_DBGMESSAGE( NULL == xi, XI_NULL_CONTEXT, state,
+                             "ERROR: NULL context provided" );
+
+    xi->context_data.sft_chunk_window_size = window;
+    xi->context_data.sft_chunk_size        = chunk_size;
+
+err_handling:
+    return state;
+}
+
+xi_state_t xi_set_sft_parallel_downloads( xi_context_handle_t xih,
+                                          uint16_t max_files,
+                                          uint32_t memory_budget )
+{
+    if ( XI_SFT_PARALLEL_DOWNLOADS_MAX < max_files )
+    {
+        return XI_INVALID_PARAMETER;
+    }
+
+    xi_state_t state = XI_STATE_OK;
+    xi_context_t* xi = xi_object_for_handle( xi_globals.context_handles_vector, xih );
+
+    XI_CHECK_CND_DBGMESSAGE( NULL == xi, XI_NULL_CONTEXT, state,
+                             "ERROR: NULL context provided" );
+
+    xi->context_data.sft_parallel_downloads     = max_files;
+    xi->context_data.sft_download_memory_budget = memory_budget;
+
+err_handling:
+    return state;
+}
+
 
 xi_state_t xi_connect_with_lastwill_to_impl( xi_context_handle_t xih,
                                              const char* host,
@@ -722,16 +796,108 @@ xi_state_t xi_connect_with_lastwill_to( xi_context_handle_t xih,
         session_type, will_topic, will_message, will_qos, will_retain, client_callback );
 }
 
+static uint8_t xi_is_context_online( const xi_context_t* xi )
+{
+    return XI_BACKOFF_CLASS_NONE == xi_globals.backoff_status.backoff_class &&
+           NULL != xi->context_data.connection_data &&
+           XI_CONNECTION_STATE_OPENED ==
+               xi->context_data.connection_data->connection_state &&
+           XI_SHUTDOWN_UNINITIALISED == xi->context_data.shutdown_state;
+}
+
+static xi_state_t xi_publish_data_on_layer_chain( xi_context_t* xi,
+                                                  const char* topic,
+                                                  xi_data_desc_t* data,
+                                                  const xi_mqtt_qos_t qos,
+                                                  const xi_mqtt_retain_t retain,
+                                                  const xi_publish_priority_t priority,
+                                                  xi_event_handle_t event_handle )
+{
+    xi_mqtt_logic_task_t* task = NULL;
+    xi_state_t state           = XI_STATE_OK;
+    xi_layer_t* input_layer    = xi->layer_chain.top;
+
+    task = xi_mqtt_logic_make_publish_task( topic, data, qos, retain, priority,
+                                            event_handle );
+
+    XI_CHECK_MEMORY( task, state );
+
+    return XI_PROCESS_PUSH_ON_THIS_LAYER( &input_layer->layer_connection, task,
+                                          XI_STATE_OK );
+
+err_handling:
+    if ( task )
+    {
+        xi_mqtt_logic_free_task( &task );
+    }
+
+    return state;
+}
+
+/* publishes up to drain_rate messages from the offline queue, re-arms itself if there
+ * is more to send. The context is referred by its handle so that a pending drain of a
+ * deleted context is harmless. */
+static xi_state_t xi_publish_queue_drain( void* context_handle )
+{
+    xi_context_t* xi = ( xi_context_t* )xi_object_for_handle(
+        xi_globals.context_handles_vector, ( xi_handle_t )( intptr_t )context_handle );
+
+    if ( NULL == xi || NULL == xi->context_data.publish_queue )
+    {
+        return XI_STATE_OK;
+    }
+
+    xi_publish_queue_t* queue       = xi->context_data.publish_queue;
+    xi_publish_queue_entry_t* entry = NULL;
+    size_t budget                   = queue->drain_rate;
+
+    queue->drain_scheduled             = 0;
+    queue->drain_event.ptr_to_position = NULL;
+
+    /* the drain will be restarted by the next successful connect */
+    if ( 0 == xi_is_context_online( xi ) )
+    {
+        return XI_STATE_OK;
+    }
+
+    while ( ( 0 == queue->drain_rate || 0 < budget-- ) &&
+            NULL != ( entry = xi_publish_queue_pop( queue ) ) )
+    {
+        const xi_state_t state =
+            xi_publish_data_on_layer_chain( xi, entry->topic, entry->data, entry->qos,
+                                            entry->retain, entry->priority,
+                                            entry->callback );
+
+        /* the ownership of the data has been passed to the task */
+        entry->data = NULL;
+        xi_publish_queue_free_entry( &entry );
+
+        if ( XI_STATE_OK == state )
+        {
+            queue->stats.drained_messages += 1;
+        }
+    }
+
+    if ( 0 == xi_publish_queue_is_empty( queue ) )
+    {
+        return xi_publish_queue_schedule_next_drain( queue );
+    }
+
+    return XI_STATE_OK;
+}
+
 xi_state_t xi_publish_data_impl( xi_context_handle_t xih,
                                  const char* topic,
                                  xi_data_desc_t* data,
                                  const xi_mqtt_qos_t qos,
                                  const xi_mqtt_retain_t retain,
+                                 const xi_publish_priority_t priority,
                                  xi_user_callback_t* callback,
                                  void* user_data )
 {
     /* PRE-CONDITIONS */
     assert( XI_INVALID_CONTEXT_HANDLE < xih );
+    assert( XI_PUBLISH_PRIORITY_COUNT > priority );
     xi_context_t* xi =
         ( xi_context_t* )xi_object_for_handle( xi_globals.context_handles_vector, xih );
     assert( NULL != xi );
@@ -749,38 +915,31 @@ xi_state_t xi_publish_data_impl( xi_context_handle_t xih,
     assert( XI_EVENT_HANDLE_ARGC4 == event_handle.handle_type ||
             XI_EVENT_HANDLE_UNSET == event_handle.handle_type );
 
-    if ( XI_BACKOFF_CLASS_NONE != xi_globals.backoff_status.backoff_class )
-    {
-        xi_free_desc( &data );
-        return XI_BACKOFF_TERMINAL;
-    }
-
-    xi_mqtt_qos_t effective_qos = qos;
-
-    xi_mqtt_logic_task_t* task = NULL;
-    xi_state_t state           = XI_STATE_OK;
-    xi_layer_t* input_layer    = xi->layer_chain.top;
-
-    xi_mqtt_logic_layer_data_t* layer_data =
-        ( xi_mqtt_logic_layer_data_t* )input_layer->user_data;
+    xi_publish_queue_t* queue = xi->context_data.publish_queue;
 
-    XI_UNUSED( layer_data );
-
-    task = xi_mqtt_logic_make_publish_task( topic, data, effective_qos, retain,
-                                            event_handle );
+    /* while there is anything queued new messages have to wait for their turn */
+    if ( NULL != queue &&
+         ( 0 == xi_is_context_online( xi ) || 0 == xi_publish_queue_is_empty( queue ) ) )
+    {
+        xi_state_t state = xi_publish_queue_push( queue, topic, data, qos, retain,
+                                                  priority, event_handle );
 
-    XI_CHECK_MEMORY( task, state );
+        if ( XI_STATE_OK == state && 0 != xi_is_context_online( xi ) )
+        {
+            state = xi_publish_queue_schedule_drain( queue );
+        }
 
-    return XI_PROCESS_PUSH_ON_THIS_LAYER( &input_layer->layer_connection, task,
-                                          XI_STATE_OK );
+        return state;
+    }
 
-err_handling:
-    if ( task )
+    if ( XI_BACKOFF_CLASS_NONE != xi_globals.backoff_status.backoff_class )
     {
-        xi_mqtt_logic_free_task( &task );
+        xi_free_desc( &data );
+        return XI_BACKOFF_TERMINAL;
     }
 
-    return state;
+    return xi_publish_data_on_layer_chain( xi, topic, data, qos, retain, priority,
+                                           event_handle );
 }
 
 xi_state_t xi_publish( xi_context_handle_t xih,
@@ -801,8 +960,8 @@ xi_state_t xi_publish( xi_context_handle_t xih,
 
     XI_CHECK_MEMORY( data_desc, state );
 
-    return xi_publish_data_impl( xih, topic, data_desc, qos, retain, callback,
-                                 user_data );
+    return xi_publish_data_impl( xih, topic, data_desc, qos, retain,
+                                 XI_PUBLISH_PRIORITY_NORMAL, callback, user_data );
 
 err_handling:
     return state;
@@ -824,7 +983,7 @@ xi_state_t xi_publish_timeseries( xi_context_handle_t xih,
     XI_CHECK_MEMORY( data_desc, state );
 
     return xi_publish_data_impl( xih, topic, data_desc, qos, XI_MQTT_RETAIN_FALSE,
-                                 callback, user_data );
+                                 XI_PUBLISH_PRIORITY_NORMAL, callback, user_data );
 
 err_handling:
     return state;
@@ -980,7 +1139,7 @@ xi_state_t xi_publish_formatted_timeseries( xi_context_handle_t xih,
     XI_CHECK_MEMORY( data_desc, state );
 
     state = xi_publish_data_impl( xih, topic, data_desc, qos, XI_MQTT_RETAIN_FALSE,
-                                  callback, user_data );
+                                  XI_PUBLISH_PRIORITY_NORMAL, callback, user_data );
 
 err_handling:
 
@@ -1011,25 +1170,330 @@ xi_state_t xi_publish_data( xi_context_handle_t xih,
 
     XI_CHECK_MEMORY( data_desc, state );
 
-    return xi_publish_data_impl( xih, topic, data_desc, qos, retain, callback,
+    return xi_publish_data_impl( xih, topic, data_desc, qos, retain,
+                                 XI_PUBLISH_PRIORITY_NORMAL, callback, user_data );
+
+err_handling:
+    return state;
+}
+
+xi_state_t xi_publish_data_with_priority( xi_context_handle_t xih,
+                                          const char* topic,
+                                          const uint8_t* data,
+                                          size_t data_len,
+                                          const xi_mqtt_qos_t qos,
+                                          const xi_mqtt_retain_t retain,
+                                          const xi_publish_priority_t priority,
+                                          xi_user_callback_t* callback,
+                                          void* user_data )
+{
+    /* PRE-CONDITIONS */
+    assert( NULL != topic );
+    assert( NULL != data );
+    assert( 0 != data_len );
+
+    xi_state_t state = XI_STATE_OK;
+
+    XI_CHECK_CND_DBGMESSAGE( XI_PUBLISH_PRIORITY_COUNT <= priority,
+                             XI_INVALID_PARAMETER, state, "unknown priority class" );
+
+    xi_data_desc_t* data_desc = xi_make_desc_from_buffer_copy( data, data_len );
+
+    XI_CHECK_MEMORY( data_desc, state );
+
+    return xi_publish_data_impl( xih, topic, data_desc, qos, retain, priority, callback,
                                  user_data );
 
 err_handling:
     return state;
 }
 
+xi_state_t xi_set_offline_publish_queue( xi_context_handle_t xih,
+                                         size_t max_messages,
+                                         size_t max_bytes,
+                                         uint16_t drain_rate,
+                                         const char* spool_file_name )
+{
+    xi_context_t* xi =
+        ( xi_context_t* )xi_object_for_handle( xi_globals.context_handles_vector, xih );
+
+    if ( NULL == xi || 0 == max_messages )
+    {
+        return XI_INVALID_PARAMETER;
+    }
+
+    if ( NULL != xi->context_data.publish_queue )
+    {
+        return XI_ALREADY_INITIALIZED;
+    }
+
+    xi->context_data.publish_queue = xi_publish_queue_create(
+        xi->context_data.evtd_instance,
+        xi_make_handle( &xi_publish_queue_drain, ( void* )( intptr_t )xih ), max_messages,
+        max_bytes, drain_rate, spool_file_name );
+
+    if ( NULL == xi->context_data.publish_queue )
+    {
+        return XI_OUT_OF_MEMORY;
+    }
+
+    /* a recovered spool can be sent right away if the context is already connected */
+    if ( 0 != xi_is_context_online( xi ) )
+    {
+        return xi_publish_queue_schedule_drain( xi->context_data.publish_queue );
+    }
+
+    return XI_STATE_OK;
+}
+
+xi_state_t xi_set_persistent_session( xi_context_handle_t xih, const char* log_file_name )
+{
+    xi_context_t* xi =
+        ( xi_context_t* )xi_object_for_handle( xi_globals.context_handles_vector, xih );
+
+    if ( NULL == xi || NULL == log_file_name )
+    {
+        return XI_INVALID_PARAMETER;
+    }
+
+    if ( NULL != xi->context_data.session_log )
+    {
+        return XI_ALREADY_INITIALIZED;
+    }
+
+    xi->context_data.session_log = xi_session_log_create( log_file_name );
+
+    if ( NULL == xi->context_data.session_log )
+    {
+        return XI_OUT_OF_MEMORY;
+    }
+
+    return XI_STATE_OK;
+}
+
+xi_state_t xi_get_offline_publish_queue_stats( xi_context_handle_t xih,
+                                               xi_publish_queue_stats_t* stats )
+{
+    xi_context_t* xi =
+        ( xi_context_t* )xi_object_for_handle( xi_globals.context_handles_vector, xih );
+
+    if ( NULL == xi || NULL == stats )
+    {
+        return XI_INVALID_PARAMETER;
+    }
+
+    if ( NULL == xi->context_data.publish_queue )
+    {
+        return XI_NOT_INITIALIZED;
+    }
+
+    *stats = xi->context_data.publish_queue->stats;
+
+    return XI_STATE_OK;
+}
+
+xi_state_t xi_get_keepalive_stats( xi_context_handle_t xih, xi_keepalive_stats_t* stats )
+{
+    xi_context_t* xi =
+        ( xi_context_t* )xi_object_for_handle( xi_globals.context_handles_vector, xih );
+
+    if ( NULL == xi || NULL == stats )
+    {
+        return XI_INVALID_PARAMETER;
+    }
+
+    *stats = xi->context_data.keepalive_stats;
+
+    return XI_STATE_OK;
+}
+
+xi_state_t xi_get_stats( xi_context_handle_t xih, xi_stats_t* stats )
+{
+    xi_context_t* xi =
+        ( xi_context_t* )xi_object_for_handle( xi_globals.context_handles_vector, xih );
+
+    if ( NULL == xi || NULL == stats )
+    {
+        return XI_INVALID_PARAMETER;
+    }
+
+    *stats           = xi_stats;
+    stats->keepalive = xi->context_data.keepalive_stats;
+
+    return XI_STATE_OK;
+}
+
+void xi_reset_stats( void )
+{
+    xi_stats_reset();
+}
+
+void xi_set_stats_trace_buffer( xi_stats_trace_event_t* events, size_t events_count )
+{
+    xi_stats_set_trace_buffer( events, events_count );
+}
+
+xi_state_t xi_get_stats_trace( xi_stats_trace_event_t* events,
+                               size_t max_events,
+                               uint32_t* sequence,
+                               size_t* events_count )
+{
+    if ( NULL == events || NULL == sequence || NULL == events_count )
+    {
+        return XI_INVALID_PARAMETER;
+    }
+
+    *events_count = xi_stats_read_trace( events, max_events, sequence );
+
+    return XI_STATE_OK;
+}
+
+xi_state_t xi_start_net_capture( const char* resource_name )
+{
+    return xi_io_net_capture_start( resource_name );
+}
+
+void xi_stop_net_capture( void )
+{
+    xi_io_net_capture_stop();
+}
+
 xi_state_t xi_subscribe( xi_context_handle_t xih,
                          const char* topic,
                          const xi_mqtt_qos_t qos,
                          xi_user_subscription_callback_t* callback,
                          void* user_data )
 {
-    if ( ( XI_INVALID_CONTEXT_HANDLE == xih ) || ( NULL == topic ) ||
-         ( NULL == callback ) )
+    const xi_subscription_t subscription = {topic, qos, callback, user_data};
+
+    return xi_subscribe_many( xih, &subscription, 1 );
+}
+
+xi_state_t xi_subscribe_many( xi_context_handle_t xih,
+                              const xi_subscription_t* subscriptions,
+                              size_t count )
+{
+    size_t i = 0;
+
+    if ( ( XI_INVALID_CONTEXT_HANDLE == xih ) || ( NULL == subscriptions ) ||
+         ( 0 == count ) )
     {
         return XI_INVALID_PARAMETER;
     }
 
+    for ( i = 0; i < count; ++i )
+    {
+        if ( ( NULL == subscriptions[i].topic ) || ( NULL == subscriptions[i].callback ) )
+        {
+            return XI_INVALID_PARAMETER;
+        }
+    }
+
+    xi_state_t state                    = XI_STATE_OK;
+    xi_mqtt_logic_task_t* task          = NULL;
+    xi_mqtt_task_specific_data_t* entry = NULL;
+    char* internal_topic                = NULL;
+    xi_layer_t* input_layer             = NULL;
+    xi_event_handle_t event_handle      = xi_make_empty_event_handle();
+
+    xi_context_t* xi =
+        ( xi_context_t* )xi_object_for_handle( xi_globals.context_handles_vector, xih );
+
+    XI_CHECK_MEMORY( xi, state );
+
+    if ( XI_BACKOFF_CLASS_NONE != xi_globals.backoff_status.backoff_class )
+    {
+        return XI_BACKOFF_TERMINAL;
+    }
+
+    input_layer = xi->layer_chain.top;
+
+    /* all of the topic filters go into a single task and so a single SUBSCRIBE */
+    for ( i = 0; i < count; ++i )
+    {
+        event_handle = xi_make_threaded_handle(
+            XI_THREADID_THREAD_0, &xi_user_sub_call_wrapper, xi, NULL, XI_STATE_OK,
+            ( void* )subscriptions[i].callback, ( void* )subscriptions[i].user_data,
+            ( void* )NULL );
+
+        event_handle.handlers.h6.a1 = xi;
+
+        /* copy the topic memory */
+        /* Olgierd: I'm not sure whether it should be copied or not ? Ususally people
+         * will do the const char* const topic_name = "topic_name"; in such cases
+         * copying doesn't make any sense, in other cases like our test driver we will
+         * use dynamically allocted memory for topic. */
+        internal_topic = xi_str_dup( subscriptions[i].topic );
+
+        XI_CHECK_MEMORY( internal_topic, state );
+
+        if ( NULL == task )
+        {
+            task = xi_mqtt_logic_make_subscribe_task(
+                internal_topic, subscriptions[i].qos, event_handle );
+            XI_CHECK_MEMORY( task, state );
+        }
+        else
+        {
+            XI_CHECK_STATE( state = xi_mqtt_logic_subscribe_task_add_topic(
+                                task, internal_topic, subscriptions[i].qos,
+                                event_handle ) );
+        }
+
+        /* the topic is owned by the task now */
+        internal_topic = NULL;
+    }
+
+    /* pass the partial ownership of the task data to the handlers ( in case of
+     * subscription failure it will release the memory ) */
+    for ( entry = task->data.data_u; NULL != entry; entry = entry->subscribe.next )
+    {
+        entry->subscribe.handler.handlers.h6.a6 = entry;
+    }
+
+    return XI_PROCESS_PUSH_ON_THIS_LAYER( &input_layer->layer_connection, task,
+                                          XI_STATE_OK );
+
+err_handling:
+    if ( task )
+    {
+        xi_mqtt_logic_free_task( &task );
+    }
+
+    XI_SAFE_FREE( internal_topic );
+
+    return state;
+}
+
+xi_state_t xi_unsubscribe( xi_context_handle_t xih,
+                           const char* topic,
+                           xi_user_callback_t* callback,
+                           void* user_data )
+{
+    return xi_unsubscribe_many( xih, &topic, 1, callback, user_data );
+}
+
+xi_state_t xi_unsubscribe_many( xi_context_handle_t xih,
+                                const char* const* topics,
+                                size_t count,
+                                xi_user_callback_t* callback,
+                                void* user_data )
+{
+    size_t i = 0;
+
+    if ( ( XI_INVALID_CONTEXT_HANDLE == xih ) || ( NULL == topics ) || ( 0 == count ) )
+    {
+        return XI_INVALID_PARAMETER;
+    }
+
+    for ( i = 0; i < count; ++i )
+    {
+        if ( NULL == topics[i] )
+        {
+            return XI_INVALID_PARAMETER;
+        }
+    }
+
     xi_state_t state               = XI_STATE_OK;
     xi_mqtt_logic_task_t* task     = NULL;
     char* internal_topic           = NULL;
@@ -1041,34 +1505,42 @@ xi_state_t xi_subscribe( xi_context_handle_t xih,
 
     XI_CHECK_MEMORY( xi, state );
 
-    event_handle = xi_make_threaded_handle(
-        XI_THREADID_THREAD_0, &xi_user_sub_call_wrapper, xi, NULL, XI_STATE_OK,
-        ( void* )callback, ( void* )user_data, ( void* )NULL );
-
     if ( XI_BACKOFF_CLASS_NONE != xi_globals.backoff_status.backoff_class )
     {
         return XI_BACKOFF_TERMINAL;
     }
 
-    /* copy the topic memory */
-    /* Olgierd: I'm not sure whether it should be copied or not ? Ususally people will do
-     * the const char* const topic_name = "topic_name"; in such cases copying doesn't make
-     * any sense, in other cases like our test driver we will use dynamically allocted
-     * memory for topic. */
-    internal_topic = xi_str_dup( topic );
+    if ( NULL == callback )
+    {
+        callback  = &xi_default_client_callback;
+        user_data = NULL;
+    }
 
-    XI_CHECK_MEMORY( internal_topic, state );
+    event_handle =
+        xi_make_threaded_handle( XI_THREADID_THREAD_0, &xi_user_callback_wrapper, xi,
+                                 user_data, XI_STATE_OK, ( void* )callback );
 
     input_layer = xi->layer_chain.top;
 
-    event_handle.handlers.h6.a1 = xi;
+    for ( i = 0; i < count; ++i )
+    {
+        internal_topic = xi_str_dup( topics[i] );
 
-    task = xi_mqtt_logic_make_subscribe_task( internal_topic, qos, event_handle );
-    XI_CHECK_MEMORY( task, state );
+        XI_CHECK_MEMORY( internal_topic, state );
 
-    /* pass the partial ownership of the task data to the handler ( in case of
-     * subscription failure it will release the memory ) */
-    task->data.data_u->subscribe.handler.handlers.h6.a6 = task->data.data_u;
+        if ( NULL == task )
+        {
+            task = xi_mqtt_logic_make_unsubscribe_task( internal_topic, event_handle );
+            XI_CHECK_MEMORY( task, state );
+        }
+        else
+        {
+            XI_CHECK_STATE( state = xi_mqtt_logic_unsubscribe_task_add_topic(
+                                task, internal_topic ) );
+        }
+
+        internal_topic = NULL;
+    }
 
     return XI_PROCESS_PUSH_ON_THIS_LAYER( &input_layer->layer_connection, task,
                                           XI_STATE_OK );
@@ -0,0 +1,262 @@
+/* Copyright (c) 2003-2018, Xively All rights reserved.
+ *
+ * This is part of the Xively C Client library,
+ * it is licensed under the BSD 3-Clause license.
+ */
+
+/*
+ * Compares the streaming control topic CBOR codec with the cn-cbor based one on the
+ * messages of an SFT download: FILE_GET_CHUNK and FILE_STATUS are encoded, FILE_CHUNK
+ * messages carrying XI_SFT_FILE_CHUNK_SIZE bytes are decoded.
+ *
+ * usage: xi_bench_cbor_codec_ct [messages]
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "xi_allocator.h"
+#include "xi_cbor_codec_ct.h"
+#include "xi_cbor_codec_ct_cn_cbor.h"
+#include "xi_config.h"
+#include "xi_control_message.h"
+
+#define XI_BENCH_CBOR_DEFAULT_MESSAGES 200000
+
+typedef void( xi_bench_cbor_encode_t )( const xi_control_message_t* control_message,
+                                        uint8_t** out_encoded_allocated_inside,
+                                        uint32_t* out_len );
+
+typedef xi_control_message_t*( xi_bench_cbor_decode_t )( const uint8_t* data,
+                                                         const uint32_t len );
+
+#ifdef XI_BENCH_COUNT_ALLOCATIONS
+/* linked with -Wl,--wrap=xi_bsp_mem_alloc */
+extern void* __real_xi_bsp_mem_alloc( size_t byte_count );
+
+static size_t xi_bench_cbor_allocations = 0;
+
+void* __wrap_xi_bsp_mem_alloc( size_t byte_count )
+{
+    ++xi_bench_cbor_allocations;
+    return __real_xi_bsp_mem_alloc( byte_count );
+}
+#endif
+
+static double xi_bench_cbor_now()
+{
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return ( double )ts.tv_sec + ( double )ts.tv_nsec / 1e9;
+}
+
+static size_t xi_bench_cbor_allocation_count()
+{
+#ifdef XI_BENCH_COUNT_ALLOCATIONS
+    return xi_bench_cbor_allocations;
+#else
+    return 0;
+#endif
+}
+
+static void xi_bench_cbor_report( const char* operation,
+                                  const char* codec,
+                                  size_t messages,
+                                  double seconds,
+                                  size_t allocations )
+{
+#ifdef XI_BENCH_COUNT_ALLOCATIONS
+    printf( "%-22s %-10s %12.1f %12.2f\n", operation, codec,
+            seconds * 1e9 / ( double )messages, ( double )allocations / messages );
+#else
+    ( void )allocations;
+    printf( "%-22s %-10s %12.1f %12s\n", operation, codec,
+            seconds * 1e9 / ( double )messages, "n/a" );
+#endif
+}
+
+static int xi_bench_cbor_encode( const char* operation,
+                                 const char* codec,
+                                 xi_bench_cbor_encode_t* encode,
+                                 const xi_control_message_t* control_message,
+                                 size_t messages )
+{
+    size_t i = 0;
+
+    const size_t allocations_before = xi_bench_cbor_allocation_count();
+    const double start              = xi_bench_cbor_now();
+
+    for ( ; i < messages; ++i )
+    {
+        uint8_t* encoded     = NULL;
+        uint32_t encoded_len = 0;
+
+        encode( control_message, &encoded, &encoded_len );
+
+        if ( NULL == encoded )
+        {
+            fprintf( stderr, "%s: %s encoding failed\n", operation, codec );
+            return 0;
+        }
+
+        xi_free( encoded );
+    }
+
+    xi_bench_cbor_report( operation, codec, messages, xi_bench_cbor_now() - start,
+                          xi_bench_cbor_allocation_count() - allocations_before );
+
+    return 1;
+}
+
+static int xi_bench_cbor_decode( const char* operation,
+                                 const char* codec,
+                                 xi_bench_cbor_decode_t* decode,
+                                 const uint8_t* encoded,
+                                 uint32_t encoded_len,
+                                 size_t messages )
+{
+    size_t i = 0;
+
+    const size_t allocations_before = xi_bench_cbor_allocation_count();
+    const double start              = xi_bench_cbor_now();
+
+    for ( ; i < messages; ++i )
+    {
+        xi_control_message_t* control_message = decode( encoded, encoded_len );
+
+        if ( NULL == control_message ||
+             XI_SFT_FILE_CHUNK_SIZE != control_message->file_chunk.length )
+        {
+            fprintf( stderr, "%s: %s decoding failed\n", operation, codec );
+            xi_control_message_free( &control_message );
+            return 0;
+        }
+
+        xi_control_message_free( &control_message );
+    }
+
+    xi_bench_cbor_report( operation, codec, messages, xi_bench_cbor_now() - start,
+                          xi_bench_cbor_allocation_count() - allocations_before );
+
+    return 1;
+}
+
+static uint8_t* xi_bench_cbor_put_head( uint8_t* out, uint8_t major, uint32_t value )
+{
+    if ( value < 24 )
+    {
+        *out++ = ( uint8_t )( major << 5 | value );
+    }
+    else
+    {
+        *out++ = ( uint8_t )( major << 5 | 26 );
+        *out++ = ( uint8_t )( value >> 24 );
+        *out++ = ( uint8_t )( value >> 16 );
+        *out++ = ( uint8_t )( value >> 8 );
+        *out++ = ( uint8_t )value;
+    }
+
+    return out;
+}
+
+static uint8_t* xi_bench_cbor_put_text( uint8_t* out, const char* text )
+{
+    out = xi_bench_cbor_put_head( out, 3, ( uint32_t )strlen( text ) );
+    memcpy( out, text, strlen( text ) );
+
+    return out + strlen( text );
+}
+
+/* FILE_CHUNK the way the broker sends it */
+static uint32_t xi_bench_cbor_make_file_chunk( uint8_t* out, uint32_t offset )
+{
+    uint8_t* const begin = out;
+    uint32_t i           = 0;
+
+    out = xi_bench_cbor_put_head( out, 5, 6 );
+    out = xi_bench_cbor_put_text( out, "msgtype" );
+    out = xi_bench_cbor_put_head( out, 0, XI_CONTROL_MESSAGE_SC__SFT_FILE_CHUNK );
+    out = xi_bench_cbor_put_text( out, "msgver" );
+    out = xi_bench_cbor_put_head( out, 0, 1 );
+    out = xi_bench_cbor_put_text( out, "N" );
+    out = xi_bench_cbor_put_text( out, "firmware.bin" );
+    out = xi_bench_cbor_put_text( out, "R" );
+    out = xi_bench_cbor_put_text( out, "1.0.42" );
+    out = xi_bench_cbor_put_text( out, "O" );
+    out = xi_bench_cbor_put_head( out, 0, offset );
+    out = xi_bench_cbor_put_text( out, "C" );
+    out = xi_bench_cbor_put_head( out, 2, XI_SFT_FILE_CHUNK_SIZE );
+
+    for ( ; i < XI_SFT_FILE_CHUNK_SIZE; ++i )
+    {
+        *out++ = ( uint8_t )i;
+    }
+
+    return ( uint32_t )( out - begin );
+}
+
+int main( int argc, char* argv[] )
+{
+    const size_t messages =
+        argc > 1 ? ( size_t )atoi( argv[1] ) : XI_BENCH_CBOR_DEFAULT_MESSAGES;
+
+    const xi_control_message_t file_get_chunk = {
+        .file_get_chunk = {.common   = {.msgtype = XI_CONTROL_MESSAGE_CS__SFT_FILE_GET_CHUNK,
+                                      .msgver  = 1},
+                           .name     = "firmware.bin",
+                           .revision = "1.0.42",
+                           .offset   = 1048576,
+                           .length   = XI_SFT_FILE_CHUNK_SIZE}};
+
+    const xi_control_message_t file_status = {
+        .file_status = {.common   = {.msgtype = XI_CONTROL_MESSAGE_CS__SFT_FILE_STATUS,
+                                   .msgver  = 1},
+                        .name     = "firmware.bin",
+                        .revision = "1.0.42",
+                        .phase    = XI_CONTROL_MESSAGE__SFT_FILE_STATUS_PHASE_DOWNLOADED,
+                        .code     = XI_CONTROL_MESSAGE__SFT_FILE_STATUS_CODE_SUCCESS}};
+
+    /* head, keys and values take less than a hundred bytes on top of the chunk */
+    uint8_t* file_chunk = malloc( XI_SFT_FILE_CHUNK_SIZE + 128 );
+    int ret             = 1;
+
+    if ( 0 == messages || NULL == file_chunk )
+    {
+        fprintf( stderr, "usage: %s [messages]\n", argv[0] );
+        free( file_chunk );
+        return 1;
+    }
+
+    const uint32_t file_chunk_len = xi_bench_cbor_make_file_chunk( file_chunk, 1048576 );
+
+    printf( "%zu messages, FILE_CHUNK payload: %d bytes\n", messages,
+            XI_SFT_FILE_CHUNK_SIZE );
+    printf( "%-22s %-10s %12s %12s\n", "operation", "codec", "ns/msg", "allocs/msg" );
+
+    if ( xi_bench_cbor_encode( "encode FILE_GET_CHUNK", "cn-cbor",
+                               &xi_cbor_codec_ct_cn_cbor_encode, &file_get_chunk,
+                               messages ) &&
+         xi_bench_cbor_encode( "encode FILE_GET_CHUNK", "streaming",
+                               &xi_cbor_codec_ct_encode, &file_get_chunk, messages ) &&
+         xi_bench_cbor_encode( "encode FILE_STATUS", "cn-cbor",
+                               &xi_cbor_codec_ct_cn_cbor_encode, &file_status,
+                               messages ) &&
+         xi_bench_cbor_encode( "encode FILE_STATUS", "streaming", &xi_cbor_codec_ct_encode,
+                               &file_status, messages ) &&
+         xi_bench_cbor_decode( "decode FILE_CHUNK", "cn-cbor",
+                               &xi_cbor_codec_ct_cn_cbor_decode, file_chunk,
+                               file_chunk_len, messages ) &&
+         xi_bench_cbor_decode( "decode FILE_CHUNK", "streaming", &xi_cbor_codec_ct_decode,
+                               file_chunk, file_chunk_len, messages ) )
+    {
+        ret = 0;
+    }
+
+    free( file_chunk );
+
+    return ret;
+}
@@ -0,0 +1,185 @@
+/* Copyright (c) 2003-2018, Xively All rights reserved.
+ *
+ * This is part of the Xively C Client library,
+ * it is licensed under the BSD 3-Clause license.
+ */
+
+/*
+ * Measures the throughput of the firmware update checksum BSP the library was
+ * built with. The image is fed the same way SFT does it: one FILE_CHUNK of
+ * XI_SFT_FILE_CHUNK_SIZE bytes per xi_bsp_fwu_checksum_update call. With the
+ * crypto-algorithms backend every SHA-256 implementation available on this CPU
+ * is measured and their digests are cross-checked.
+ *
+ * usage: xi_bench_checksum [image size in MiB] [rounds]
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <xi_bsp_fwu.h>
+#include <xi_config.h>
+
+#ifdef XI_BENCH_CHECKSUM_CRYPTOALGS
+#include <sha256.h>
+#endif
+
+#ifndef XI_BENCH_CHECKSUM_BACKEND
+#define XI_BENCH_CHECKSUM_BACKEND "unknown"
+#endif
+
+#define XI_BENCH_CHECKSUM_DIGEST_SIZE 32
+#define XI_BENCH_CHECKSUM_DEFAULT_IMAGE_MB 16
+#define XI_BENCH_CHECKSUM_DEFAULT_ROUNDS 5
+
+static double xi_bench_checksum_now()
+{
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return ( double )ts.tv_sec + ( double )ts.tv_nsec / 1e9;
+}
+
+/* returns the best time out of the given number of rounds */
+static double xi_bench_checksum_run( const uint8_t* image,
+                                     size_t image_size,
+                                     size_t chunk_size,
+                                     int rounds,
+                                     uint8_t* digest_out )
+{
+    double best = -1;
+    int round   = 0;
+
+    for ( ; round < rounds; ++round )
+    {
+        void* checksum_context = NULL;
+        uint8_t* checksum      = NULL;
+        uint16_t checksum_len  = 0;
+        size_t offset          = 0;
+
+        const double start = xi_bench_checksum_now();
+
+        xi_bsp_fwu_checksum_init( &checksum_context );
+
+        for ( ; offset < image_size; offset += chunk_size )
+        {
+            const size_t left = image_size - offset;
+            xi_bsp_fwu_checksum_update( checksum_context, image + offset,
+                                        left < chunk_size ? left : chunk_size );
+        }
+
+        xi_bsp_fwu_checksum_final( &checksum_context, &checksum, &checksum_len );
+
+        const double elapsed = xi_bench_checksum_now() - start;
+
+        if ( best < 0 || elapsed < best )
+        {
+            best = elapsed;
+        }
+
+        memcpy( digest_out, checksum,
+                checksum_len < XI_BENCH_CHECKSUM_DIGEST_SIZE
+                    ? checksum_len
+                    : XI_BENCH_CHECKSUM_DIGEST_SIZE );
+    }
+
+    return best;
+}
+
+static void xi_bench_checksum_report( const char* implementation,
+                                      size_t image_size,
+                                      size_t chunk_size,
+                                      double seconds )
+{
+    printf( "%-18s %-10s %10zu %10.2f %10.1f\n", XI_BENCH_CHECKSUM_BACKEND,
+            implementation, chunk_size, seconds * 1000.0,
+            ( double )image_size / ( 1024.0 * 1024.0 ) / seconds );
+}
+
+int main( int argc, char* argv[] )
+{
+    const size_t image_mb =
+        argc > 1 ? ( size_t )atoi( argv[1] ) : XI_BENCH_CHECKSUM_DEFAULT_IMAGE_MB;
+    const int rounds = argc > 2 ? atoi( argv[2] ) : XI_BENCH_CHECKSUM_DEFAULT_ROUNDS;
+    const size_t image_size = image_mb * 1024 * 1024;
+    const size_t chunk_sizes[] = {XI_SFT_FILE_CHUNK_SIZE, image_size};
+    uint8_t digest[XI_BENCH_CHECKSUM_DIGEST_SIZE];
+    uint32_t seed  = 0x12345678;
+    size_t i       = 0;
+    int ret        = 0;
+    uint8_t* image = NULL;
+
+    if ( 0 == image_mb || 0 >= rounds )
+    {
+        fprintf( stderr, "usage: %s [image size in MiB] [rounds]\n", argv[0] );
+        return 1;
+    }
+
+    image = malloc( image_size );
+
+    if ( NULL == image )
+    {
+        fprintf( stderr, "could not allocate %zu MiB image\n", image_mb );
+        return 1;
+    }
+
+    /* content does not matter for the speed, but keep it reproducible */
+    for ( i = 0; i < image_size; ++i )
+    {
+        seed     = seed * 1103515245 + 12345;
+        image[i] = ( uint8_t )( seed >> 16 );
+    }
+
+    printf( "image: %zu MiB, best of %d rounds\n", image_mb, rounds );
+    printf( "%-18s %-10s %10s %10s %10s\n", "backend", "impl", "chunk", "ms", "MiB/s" );
+
+    for ( i = 0; i < sizeof( chunk_sizes ) / sizeof( chunk_sizes[0] ); ++i )
+    {
+#ifdef XI_BENCH_CHECKSUM_CRYPTOALGS
+        const SHA256_IMPL implementations[] = {SHA256_IMPL_PORTABLE, SHA256_IMPL_SHANI,
+                                               SHA256_IMPL_ARMV8};
+        uint8_t reference_digest[XI_BENCH_CHECKSUM_DIGEST_SIZE];
+        size_t impl_id = 0;
+
+        for ( ; impl_id < sizeof( implementations ) / sizeof( implementations[0] );
+              ++impl_id )
+        {
+            if ( 0 == sha256_select_impl( implementations[impl_id] ) )
+            {
+                continue;
+            }
+
+            const double seconds = xi_bench_checksum_run( image, image_size,
+                                                          chunk_sizes[i], rounds, digest );
+
+            xi_bench_checksum_report( sha256_impl_name(), image_size, chunk_sizes[i],
+                                      seconds );
+
+            if ( 0 == impl_id )
+            {
+                memcpy( reference_digest, digest, sizeof( digest ) );
+            }
+            else if ( 0 != memcmp( reference_digest, digest, sizeof( digest ) ) )
+            {
+                fprintf( stderr, "%s digest differs from the portable one\n",
+                         sha256_impl_name() );
+                ret = 1;
+            }
+        }
+
+        sha256_select_impl( SHA256_IMPL_AUTO );
+#else
+        const double seconds =
+            xi_bench_checksum_run( image, image_size, chunk_sizes[i], rounds, digest );
+
+        xi_bench_checksum_report( "default", image_size, chunk_sizes[i], seconds );
+#endif
+    }
+
+    free( image );
+
+    return ret;
+}
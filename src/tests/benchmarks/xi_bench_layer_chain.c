@@ -0,0 +1,422 @@
+/* Copyright (c) 2003-2018, Xively All rights reserved.
+ *
+ * This is part of the Xively C Client library,
+ * it is licensed under the BSD 3-Clause license.
+ */
+
+/*
+ * Measures the cost of moving QoS0 publications through the layer chain. The
+ * real MQTT codec, MQTT logic and control topic layers are stacked on top of a
+ * loopback layer which answers CONNECT and SUBSCRIBE itself, so no socket is
+ * involved and only the dispatching overhead and the layers' own work are
+ * measured. Every message is published and stepped through separately, once with
+ * all of the transitions going through the event queue and once with the
+ * dispatcher's direct call slot enabled.
+ *
+ * The instructions per message are counted with the hardware counters where the
+ * kernel gives access to them. Built with XI_LAYER_CHAIN_STATIC=1 the calls to the
+ * MQTT and control topic layers go through the static dispatch.
+ *
+ * usage: xi_bench_layer_chain [messages]
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef XI_BENCH_COUNT_INSTRUCTIONS
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <xively.h>
+
+#include "xi_config.h"
+#include "xi_control_topic_layer.h"
+#include "xi_data_desc.h"
+#include "xi_globals.h"
+#include "xi_handle.h"
+#include "xi_layer_default_functions.h"
+#include "xi_layer_macros.h"
+#include "xi_mqtt_codec_layer.h"
+#include "xi_mqtt_logic_layer.h"
+
+#define XI_BENCH_LAYER_CHAIN_DEFAULT_MESSAGES 100000
+#define XI_BENCH_LAYER_CHAIN_MAX_STEPS 64
+
+/* hidden API functions, the same ones the integration tests rely on */
+extern xi_state_t xi_create_context_with_custom_layers( xi_context_t** context,
+                                                        xi_layer_type_t layer_config[],
+                                                        xi_layer_type_id_t layer_chain[],
+                                                        size_t layer_chain_size );
+
+extern xi_state_t xi_delete_context_with_custom_layers( xi_context_t** context,
+                                                        xi_layer_type_t layer_config[],
+                                                        size_t layer_chain_size );
+
+static size_t xi_bench_layer_chain_publishes       = 0;
+static uint8_t xi_bench_layer_chain_expect_payload = 0;
+static uint8_t xi_bench_layer_chain_connected      = 0;
+
+#ifdef XI_BENCH_COUNT_ALLOCATIONS
+/* linked with -Wl,--wrap=xi_bsp_mem_alloc */
+extern void* __real_xi_bsp_mem_alloc( size_t byte_count );
+
+static size_t xi_bench_layer_chain_allocations = 0;
+
+void* __wrap_xi_bsp_mem_alloc( size_t byte_count )
+{
+    ++xi_bench_layer_chain_allocations;
+    return __real_xi_bsp_mem_alloc( byte_count );
+}
+#endif
+
+#ifdef XI_BENCH_COUNT_INSTRUCTIONS
+/* counter of the user space instructions of this thread, -1 if there's none */
+static int xi_bench_layer_chain_instructions_fd = -1;
+
+static void xi_bench_layer_chain_open_instructions_counter()
+{
+    struct perf_event_attr attr;
+
+    memset( &attr, 0, sizeof( attr ) );
+    attr.type           = PERF_TYPE_HARDWARE;
+    attr.size           = sizeof( attr );
+    attr.config         = PERF_COUNT_HW_INSTRUCTIONS;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv     = 1;
+
+    xi_bench_layer_chain_instructions_fd =
+        ( int )syscall( __NR_perf_event_open, &attr, 0, -1, -1, 0 );
+}
+
+/* returns 0 if the instructions can't be counted */
+static int xi_bench_layer_chain_instructions( uint64_t* instructions )
+{
+    return 0 <= xi_bench_layer_chain_instructions_fd &&
+           sizeof( *instructions ) == read( xi_bench_layer_chain_instructions_fd,
+                                            instructions, sizeof( *instructions ) );
+}
+#else
+static void xi_bench_layer_chain_open_instructions_counter()
+{
+}
+
+static int xi_bench_layer_chain_instructions( uint64_t* instructions )
+{
+    XI_UNUSED( instructions );
+    return 0;
+}
+#endif
+
+static double xi_bench_layer_chain_now()
+{
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return ( double )ts.tv_sec + ( double )ts.tv_nsec / 1e9;
+}
+
+/* replies the broker would send for the given message, NULL if there is none */
+static xi_data_desc_t* xi_bench_layer_chain_reply( const xi_data_desc_t* sent )
+{
+    const uint8_t type = sent->data_ptr[0] >> 4;
+
+    if ( XI_MQTT_TYPE_CONNECT == type )
+    {
+        return xi_make_desc_from_buffer_copy( ( const uint8_t* )"\x20\x02\x00\x00", 4 );
+    }
+    else if ( XI_MQTT_TYPE_SUBSCRIBE == type )
+    {
+        /* skip the remaining length to get to the message id */
+        size_t offset = 1;
+        while ( offset < sent->length && ( sent->data_ptr[offset] & 0x80 ) )
+        {
+            ++offset;
+        }
+
+        uint8_t suback[] = {0x90, 0x03, 0x00, 0x00, 0x00};
+        suback[2]        = sent->data_ptr[offset + 1];
+        suback[3]        = sent->data_ptr[offset + 2];
+
+        return xi_make_desc_from_buffer_copy( suback, sizeof( suback ) );
+    }
+    else if ( XI_MQTT_TYPE_PINGREQ == type )
+    {
+        return xi_make_desc_from_buffer_copy( ( const uint8_t* )"\xd0\x00", 2 );
+    }
+
+    return NULL;
+}
+
+static xi_state_t
+xi_bench_loopback_layer_push( void* context, void* data, xi_state_t in_out_state )
+{
+    XI_UNUSED( in_out_state );
+
+    xi_data_desc_t* data_desc = ( xi_data_desc_t* )data;
+    xi_data_desc_t* reply     = NULL;
+
+    /* the codec sends the payload of a PUBLISH right after its header */
+    if ( xi_bench_layer_chain_expect_payload )
+    {
+        xi_bench_layer_chain_expect_payload = 0;
+        ++xi_bench_layer_chain_publishes;
+    }
+    else if ( XI_MQTT_TYPE_PUBLISH == data_desc->data_ptr[0] >> 4 )
+    {
+        xi_bench_layer_chain_expect_payload = 1;
+    }
+    else
+    {
+        reply = xi_bench_layer_chain_reply( data_desc );
+    }
+
+    xi_free_desc( &data_desc );
+
+    if ( NULL != reply )
+    {
+        XI_PROCESS_PULL_ON_THIS_LAYER( context, reply, XI_STATE_OK );
+    }
+
+    return XI_PROCESS_PUSH_ON_NEXT_LAYER( context, NULL, XI_STATE_WRITTEN );
+}
+
+static xi_state_t
+xi_bench_loopback_layer_pull( void* context, void* data, xi_state_t in_out_state )
+{
+    return XI_PROCESS_PULL_ON_NEXT_LAYER( context, data, in_out_state );
+}
+
+static xi_state_t
+xi_bench_loopback_layer_close( void* context, void* data, xi_state_t in_out_state )
+{
+    return XI_PROCESS_CLOSE_EXTERNALLY_ON_THIS_LAYER( context, data, in_out_state );
+}
+
+static xi_state_t xi_bench_loopback_layer_close_externally( void* context,
+                                                            void* data,
+                                                            xi_state_t in_out_state )
+{
+    return XI_PROCESS_CLOSE_EXTERNALLY_ON_NEXT_LAYER( context, data, in_out_state );
+}
+
+static xi_state_t
+xi_bench_loopback_layer_init( void* context, void* data, xi_state_t in_out_state )
+{
+    return XI_PROCESS_CONNECT_ON_THIS_LAYER( context, data, in_out_state );
+}
+
+static xi_state_t
+xi_bench_loopback_layer_connect( void* context, void* data, xi_state_t in_out_state )
+{
+    return XI_PROCESS_CONNECT_ON_NEXT_LAYER( context, data, in_out_state );
+}
+
+enum xi_bench_layer_chain_stack_order_e
+{
+    XI_LAYER_TYPE_BENCH_LOOPBACK = 0,
+    XI_LAYER_TYPE_BENCH_MQTT_CODEC,
+    XI_LAYER_TYPE_BENCH_MQTT_LOGIC,
+    XI_LAYER_TYPE_BENCH_CONTROL_TOPIC
+};
+
+#define XI_BENCH_LAYER_CHAIN                                                             \
+    XI_LAYER_TYPE_BENCH_LOOPBACK                                                         \
+    , XI_LAYER_TYPE_BENCH_MQTT_CODEC, XI_LAYER_TYPE_BENCH_MQTT_LOGIC,                    \
+        XI_LAYER_TYPE_BENCH_CONTROL_TOPIC
+
+XI_DECLARE_LAYER_TYPES_BEGIN( xi_bench_layer_chain_types )
+XI_LAYER_TYPES_ADD( XI_LAYER_TYPE_BENCH_LOOPBACK,
+                    xi_bench_loopback_layer_push,
+                    xi_bench_loopback_layer_pull,
+                    xi_bench_loopback_layer_close,
+                    xi_bench_loopback_layer_close_externally,
+                    xi_bench_loopback_layer_init,
+                    xi_bench_loopback_layer_connect,
+                    xi_layer_default_post_connect )
+, XI_LAYER_TYPES_ADD( XI_LAYER_TYPE_BENCH_MQTT_CODEC,
+                      xi_mqtt_codec_layer_push,
+                      xi_mqtt_codec_layer_pull,
+                      xi_mqtt_codec_layer_close,
+                      xi_mqtt_codec_layer_close_externally,
+                      xi_mqtt_codec_layer_init,
+                      xi_mqtt_codec_layer_connect,
+                      xi_layer_default_post_connect ),
+    XI_LAYER_TYPES_ADD( XI_LAYER_TYPE_BENCH_MQTT_LOGIC,
+                        xi_mqtt_logic_layer_push,
+                        xi_mqtt_logic_layer_pull,
+                        xi_mqtt_logic_layer_close,
+                        xi_mqtt_logic_layer_close_externally,
+                        xi_mqtt_logic_layer_init,
+                        xi_mqtt_logic_layer_connect,
+                        xi_mqtt_logic_layer_post_connect ),
+    XI_LAYER_TYPES_ADD( XI_LAYER_TYPE_BENCH_CONTROL_TOPIC,
+                        xi_control_topic_layer_push,
+                        xi_control_topic_layer_pull,
+                        xi_control_topic_layer_close,
+                        xi_control_topic_layer_close_externally,
+                        xi_control_topic_layer_init,
+                        xi_control_topic_layer_connect,
+                        xi_layer_default_post_connect ) XI_DECLARE_LAYER_TYPES_END()
+
+    XI_DECLARE_LAYER_CHAIN_SCHEME( XI_LAYER_CHAIN_BENCH, XI_BENCH_LAYER_CHAIN );
+
+static void xi_bench_layer_chain_on_connected( xi_context_handle_t in_context_handle,
+                                               void* data,
+                                               xi_state_t state )
+{
+    XI_UNUSED( in_context_handle );
+
+    const xi_connection_data_t* conn_data = ( xi_connection_data_t* )data;
+
+    xi_bench_layer_chain_connected =
+        ( XI_STATE_OK == state && XI_CONNECTION_STATE_OPENED == conn_data->connection_state );
+}
+
+/* steps the dispatcher until the condition holds, returns 0 if it never did */
+static int
+xi_bench_layer_chain_step_until( const size_t* counter, size_t expected_value )
+{
+    int steps = 0;
+
+    for ( ; steps < XI_BENCH_LAYER_CHAIN_MAX_STEPS && *counter < expected_value; ++steps )
+    {
+        xi_evtd_step( xi_globals.evtd_instance, time( NULL ) );
+    }
+
+    return *counter >= expected_value;
+}
+
+static int xi_bench_layer_chain_run( xi_context_handle_t context_handle,
+                                     const char* mode,
+                                     uint16_t direct_call_depth,
+                                     size_t messages )
+{
+    size_t i = 0;
+
+    xi_globals.evtd_instance->direct_call_depth = direct_call_depth;
+
+#ifdef XI_BENCH_COUNT_ALLOCATIONS
+    const size_t allocations_before = xi_bench_layer_chain_allocations;
+#endif
+    const size_t publishes_before = xi_bench_layer_chain_publishes;
+    uint64_t instructions_before  = 0;
+    uint64_t instructions_after   = 0;
+    const int instructions_counted =
+        xi_bench_layer_chain_instructions( &instructions_before );
+    const double start = xi_bench_layer_chain_now();
+
+    for ( ; i < messages; ++i )
+    {
+        xi_publish( context_handle, "bench/topic", "layer chain benchmark payload",
+                    XI_MQTT_QOS_AT_MOST_ONCE, XI_MQTT_RETAIN_FALSE, NULL, NULL );
+
+        if ( 0 == xi_bench_layer_chain_step_until( &xi_bench_layer_chain_publishes,
+                                                   publishes_before + i + 1 ) )
+        {
+            fprintf( stderr, "%s: publication %zu did not reach the loopback layer\n",
+                     mode, i );
+            return 0;
+        }
+    }
+
+    const double elapsed = xi_bench_layer_chain_now() - start;
+    char instructions_per_message[16] = "n/a";
+
+    if ( instructions_counted &&
+         xi_bench_layer_chain_instructions( &instructions_after ) )
+    {
+        snprintf( instructions_per_message, sizeof( instructions_per_message ), "%.0f",
+                  ( double )( instructions_after - instructions_before ) /
+                      ( double )messages );
+    }
+
+#ifdef XI_BENCH_COUNT_ALLOCATIONS
+    const double allocations_per_message =
+        ( double )( xi_bench_layer_chain_allocations - allocations_before ) /
+        ( double )messages;
+
+    printf( "%-10s %6u %10zu %12.1f %12s %12.2f\n", mode, direct_call_depth, messages,
+            elapsed * 1e9 / ( double )messages, instructions_per_message,
+            allocations_per_message );
+#else
+    printf( "%-10s %6u %10zu %12.1f %12s %12s\n", mode, direct_call_depth, messages,
+            elapsed * 1e9 / ( double )messages, instructions_per_message, "n/a" );
+#endif
+
+    return 1;
+}
+
+int main( int argc, char* argv[] )
+{
+    const size_t messages =
+        argc > 1 ? ( size_t )atoi( argv[1] ) : XI_BENCH_LAYER_CHAIN_DEFAULT_MESSAGES;
+    xi_context_t* context             = NULL;
+    xi_context_handle_t context_handle = XI_INVALID_CONTEXT_HANDLE;
+    int ret                            = 1;
+
+    if ( 0 == messages )
+    {
+        fprintf( stderr, "usage: %s [messages]\n", argv[0] );
+        return 1;
+    }
+
+    if ( XI_STATE_OK != xi_initialize( "xi_bench_account_id", "xi_bench_device_id" ) ||
+         XI_STATE_OK != xi_create_context_with_custom_layers(
+                            &context, xi_bench_layer_chain_types, XI_LAYER_CHAIN_BENCH,
+                            XI_LAYER_CHAIN_SCHEME_LENGTH( XI_LAYER_CHAIN_BENCH ) ) ||
+         XI_STATE_OK != xi_find_handle_for_object( xi_globals.context_handles_vector,
+                                                   context, &context_handle ) )
+    {
+        fprintf( stderr, "could not create the context\n" );
+        return 1;
+    }
+
+    xi_connect( context_handle, "bench_user", "bench_password", 10, 3600,
+                XI_SESSION_CLEAN, &xi_bench_layer_chain_on_connected );
+
+    {
+        int steps = 0;
+        for ( ; steps < XI_BENCH_LAYER_CHAIN_MAX_STEPS && !xi_bench_layer_chain_connected;
+              ++steps )
+        {
+            xi_evtd_step( xi_globals.evtd_instance, time( NULL ) );
+        }
+    }
+
+    if ( !xi_bench_layer_chain_connected )
+    {
+        fprintf( stderr, "loopback connection has not been established\n" );
+        goto end;
+    }
+
+    xi_bench_layer_chain_open_instructions_counter();
+
+    printf( "layer calls: %s\n",
+            XI_LAYER_CHAIN_STATIC ? "static dispatch" : "function pointers" );
+    printf( "%-10s %6s %10s %12s %12s %12s\n", "mode", "depth", "messages", "ns/msg",
+            "instr/msg", "allocs/msg" );
+
+    if ( xi_bench_layer_chain_run( context_handle, "queued", 0, messages ) &&
+         xi_bench_layer_chain_run( context_handle, "direct", XI_EVTD_DIRECT_CALL_DEPTH,
+                                   messages ) )
+    {
+        ret = 0;
+    }
+
+end:
+    xi_shutdown_connection( context_handle );
+    xi_evtd_step( xi_globals.evtd_instance, time( NULL ) );
+
+    xi_delete_context_with_custom_layers(
+        &context, xi_bench_layer_chain_types,
+        XI_LAYER_CHAIN_SCHEME_LENGTH( XI_LAYER_CHAIN_BENCH ) );
+
+    xi_shutdown();
+
+    return ret;
+}
@@ -0,0 +1,846 @@
+/* Copyright (c) 2003-2018, Xively All rights reserved.
+ *
+ * This is part of the Xively C Client library,
+ * it is licensed under the BSD 3-Clause license.
+ */
+
+/*
+ * End to end benchmark of the client running over a real TCP connection. A minimal
+ * MQTT broker runs on a thread of the same process and listens on an ephemeral
+ * loopback port. It acknowledges CONNECT, SUBSCRIBE and PINGREQ, echoes every
+ * publication made on the echo topic back to the client and, when asked to on the
+ * fan-in topic, sends a burst of publications. The client side is the unmodified
+ * default layer chain driven by xi_events_process_tick.
+ *
+ * Reported are the time of the connect handshake, the echo throughput together
+ * with the p50/p99 round trip latency for QoS0 and QoS1 at several payload sizes,
+ * the throughput of receiving a burst on a subscribed topic and the allocations
+ * made per message, taken from xi_get_stats.
+ *
+ * usage: xi_bench_loopback [messages]
+ */
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <xively.h>
+
+#include "xi_globals.h"
+#include "xi_macros.h"
+#include "xi_mqtt_message.h"
+
+#define XI_BENCH_LOOPBACK_DEFAULT_MESSAGES 10000
+#define XI_BENCH_LOOPBACK_CONNECTS 20
+#define XI_BENCH_LOOPBACK_WINDOW 16
+#define XI_BENCH_LOOPBACK_FANIN_PAYLOAD_SIZE 64
+#define XI_BENCH_LOOPBACK_TIMEOUT_SEC 30
+
+#define XI_BENCH_LOOPBACK_ECHO_TOPIC "bench/echo"
+#define XI_BENCH_LOOPBACK_FANIN_TOPIC "bench/fanin"
+#define XI_BENCH_LOOPBACK_FANIN_START_TOPIC "bench/fanin/start"
+
+static const size_t xi_bench_loopback_payload_sizes[] = {16, 256, 4096};
+
+/* the state of a single measurement, shared with the callbacks */
+typedef struct xi_bench_loopback_run_s
+{
+    xi_context_handle_t context_handle;
+    xi_mqtt_qos_t qos;
+    size_t payload_size;
+    size_t messages;
+    size_t sent;
+    size_t received;
+    double* sent_at;
+    double* latencies;
+    uint8_t* payload;
+} xi_bench_loopback_run_t;
+
+static xi_connection_state_t xi_bench_loopback_connection_state =
+    XI_CONNECTION_STATE_UNINITIALIZED;
+static size_t xi_bench_loopback_subacks = 0;
+static xi_bench_loopback_run_t xi_bench_loopback_run_state;
+
+static double xi_bench_loopback_now()
+{
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return ( double )ts.tv_sec + ( double )ts.tv_nsec / 1e9;
+}
+
+/*
+ * The broker. It serves one connection at a time with blocking sockets, everything
+ * it does not understand is dropped.
+ */
+
+static int xi_bench_broker_write( int fd, const uint8_t* data, size_t length )
+{
+    while ( 0 < length )
+    {
+        const ssize_t written = send( fd, data, length, MSG_NOSIGNAL );
+
+        if ( 0 >= written )
+        {
+            return 0;
+        }
+
+        data += written;
+        length -= ( size_t )written;
+    }
+
+    return 1;
+}
+
+static int xi_bench_broker_read( int fd, uint8_t* data, size_t length )
+{
+    while ( 0 < length )
+    {
+        const ssize_t read = recv( fd, data, length, 0 );
+
+        if ( 0 >= read )
+        {
+            return 0;
+        }
+
+        data += read;
+        length -= ( size_t )read;
+    }
+
+    return 1;
+}
+
+static size_t xi_bench_broker_encode_remaining_length( uint8_t* out, size_t length )
+{
+    size_t bytes = 0;
+
+    do
+    {
+        out[bytes] = length % 128;
+        length /= 128;
+        out[bytes] |= ( 0 < length ) ? 0x80 : 0;
+        ++bytes;
+    } while ( 0 < length );
+
+    return bytes;
+}
+
+static int xi_bench_broker_send_publish( int fd,
+                                         const uint8_t* topic,
+                                         size_t topic_length,
+                                         const uint8_t* payload,
+                                         size_t payload_length,
+                                         uint8_t qos,
+                                         uint16_t msg_id )
+{
+    uint8_t header[7];
+    const size_t remaining_length =
+        2 + topic_length + ( 0 < qos ? 2 : 0 ) + payload_length;
+    size_t header_length = 0;
+    size_t offset        = 0;
+
+    header[0]     = ( XI_MQTT_TYPE_PUBLISH << 4 ) | ( qos << 1 );
+    header_length = 1 + xi_bench_broker_encode_remaining_length( header + 1,
+                                                                 remaining_length );
+
+    uint8_t* message = malloc( header_length + remaining_length );
+
+    if ( NULL == message )
+    {
+        return 0;
+    }
+
+    memcpy( message, header, header_length );
+    offset            = header_length;
+    message[offset++] = ( uint8_t )( topic_length >> 8 );
+    message[offset++] = ( uint8_t )topic_length;
+    memcpy( message + offset, topic, topic_length );
+    offset += topic_length;
+
+    if ( 0 < qos )
+    {
+        message[offset++] = ( uint8_t )( msg_id >> 8 );
+        message[offset++] = ( uint8_t )msg_id;
+    }
+
+    memcpy( message + offset, payload, payload_length );
+    offset += payload_length;
+
+    const int ret = xi_bench_broker_write( fd, message, offset );
+
+    free( message );
+
+    return ret;
+}
+
+static int xi_bench_broker_topic_is( const uint8_t* topic,
+                                     size_t topic_length,
+                                     const char* expected )
+{
+    return topic_length == strlen( expected ) &&
+           0 == memcmp( topic, expected, topic_length );
+}
+
+static int xi_bench_broker_on_publish( int fd,
+                                       uint8_t flags,
+                                       const uint8_t* body,
+                                       size_t length,
+                                       uint16_t* next_msg_id )
+{
+    const uint8_t qos = ( flags >> 1 ) & 0x03;
+
+    if ( length < 2 )
+    {
+        return 0;
+    }
+
+    const size_t topic_length = ( ( size_t )body[0] << 8 ) | body[1];
+    const size_t header_size  = 2 + topic_length + ( 0 < qos ? 2 : 0 );
+
+    if ( length < header_size )
+    {
+        return 0;
+    }
+
+    const uint8_t* topic        = body + 2;
+    const uint8_t* payload      = body + header_size;
+    const size_t payload_length  = length - header_size;
+
+    if ( 0 < qos )
+    {
+        const uint8_t puback[] = {XI_MQTT_TYPE_PUBACK << 4, 2, body[2 + topic_length],
+                                  body[3 + topic_length]};
+
+        if ( !xi_bench_broker_write( fd, puback, sizeof( puback ) ) )
+        {
+            return 0;
+        }
+    }
+
+    if ( xi_bench_broker_topic_is( topic, topic_length, XI_BENCH_LOOPBACK_ECHO_TOPIC ) )
+    {
+        *next_msg_id = ( 0 == *next_msg_id + 1 ) ? 1 : *next_msg_id + 1;
+
+        return xi_bench_broker_send_publish( fd, topic, topic_length, payload,
+                                             payload_length, qos, *next_msg_id );
+    }
+
+    if ( xi_bench_broker_topic_is( topic, topic_length,
+                                   XI_BENCH_LOOPBACK_FANIN_START_TOPIC ) )
+    {
+        uint8_t fanin_payload[XI_BENCH_LOOPBACK_FANIN_PAYLOAD_SIZE] = {0};
+        char count_string[16]                                       = {0};
+        size_t i                                                    = 0;
+
+        memcpy( count_string, payload,
+                XI_MIN( payload_length, sizeof( count_string ) - 1 ) );
+
+        const size_t count = ( size_t )strtoul( count_string, NULL, 10 );
+
+        for ( i = 0; i < count; ++i )
+        {
+            if ( !xi_bench_broker_send_publish(
+                     fd, ( const uint8_t* )XI_BENCH_LOOPBACK_FANIN_TOPIC,
+                     strlen( XI_BENCH_LOOPBACK_FANIN_TOPIC ), fanin_payload,
+                     sizeof( fanin_payload ), 0, 0 ) )
+            {
+                return 0;
+            }
+        }
+    }
+
+    return 1;
+}
+
+static int xi_bench_broker_on_subscribe( int fd, const uint8_t* body, size_t length )
+{
+    uint8_t suback[64] = {XI_MQTT_TYPE_SUBACK << 4, 2};
+    size_t offset      = 2;
+
+    if ( length < 2 )
+    {
+        return 0;
+    }
+
+    suback[2] = body[0];
+    suback[3] = body[1];
+
+    /* every requested QoS is granted */
+    while ( offset + 2 < length && ( size_t )suback[1] + 2 < sizeof( suback ) )
+    {
+        const size_t topic_length = ( ( size_t )body[offset] << 8 ) | body[offset + 1];
+
+        offset += 2 + topic_length;
+
+        if ( length <= offset )
+        {
+            return 0;
+        }
+
+        suback[2 + suback[1]] = body[offset] & 0x03;
+        suback[1] += 1;
+        offset += 1;
+    }
+
+    return xi_bench_broker_write( fd, suback, 2 + suback[1] );
+}
+
+static void xi_bench_broker_serve( int fd )
+{
+    uint8_t* body        = NULL;
+    size_t body_capacity = 0;
+    uint16_t next_msg_id = 0;
+
+    for ( ;; )
+    {
+        uint8_t fixed_header = 0;
+        uint8_t length_byte  = 0;
+        size_t length        = 0;
+        size_t multiplier    = 1;
+        int ok               = 1;
+
+        if ( !xi_bench_broker_read( fd, &fixed_header, 1 ) )
+        {
+            break;
+        }
+
+        do
+        {
+            if ( !xi_bench_broker_read( fd, &length_byte, 1 ) )
+            {
+                goto end;
+            }
+
+            length += ( length_byte & 0x7F ) * multiplier;
+            multiplier *= 128;
+        } while ( length_byte & 0x80 );
+
+        if ( body_capacity < length )
+        {
+            uint8_t* new_body = realloc( body, length );
+
+            if ( NULL == new_body )
+            {
+                break;
+            }
+
+            body          = new_body;
+            body_capacity = length;
+        }
+
+        if ( !xi_bench_broker_read( fd, body, length ) )
+        {
+            break;
+        }
+
+        switch ( fixed_header >> 4 )
+        {
+            case XI_MQTT_TYPE_CONNECT:
+            {
+                const uint8_t connack[] = {XI_MQTT_TYPE_CONNACK << 4, 2, 0, 0};
+                ok = xi_bench_broker_write( fd, connack, sizeof( connack ) );
+            }
+            break;
+            case XI_MQTT_TYPE_PUBLISH:
+                ok = xi_bench_broker_on_publish( fd, fixed_header & 0x0F, body, length,
+                                                 &next_msg_id );
+                break;
+            case XI_MQTT_TYPE_SUBSCRIBE:
+                ok = xi_bench_broker_on_subscribe( fd, body, length );
+                break;
+            case XI_MQTT_TYPE_UNSUBSCRIBE:
+            {
+                const uint8_t unsuback[] = {XI_MQTT_TYPE_UNSUBACK << 4, 2, body[0],
+                                            body[1]};
+                ok = 2 <= length &&
+                     xi_bench_broker_write( fd, unsuback, sizeof( unsuback ) );
+            }
+            break;
+            case XI_MQTT_TYPE_PINGREQ:
+            {
+                const uint8_t pingresp[] = {XI_MQTT_TYPE_PINGRESP << 4, 0};
+                ok = xi_bench_broker_write( fd, pingresp, sizeof( pingresp ) );
+            }
+            break;
+            case XI_MQTT_TYPE_DISCONNECT:
+                ok = 0;
+                break;
+            default:
+                break;
+        }
+
+        if ( !ok )
+        {
+            break;
+        }
+    }
+
+end:
+    free( body );
+}
+
+static void* xi_bench_broker_thread( void* arg )
+{
+    const int listen_fd = ( int )( intptr_t )arg;
+
+    for ( ;; )
+    {
+        const int fd = accept( listen_fd, NULL, NULL );
+
+        if ( 0 > fd )
+        {
+            if ( EINTR == errno )
+            {
+                continue;
+            }
+
+            /* the listening socket has been shut down */
+            break;
+        }
+
+        const int nodelay = 1;
+        setsockopt( fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof( nodelay ) );
+
+        xi_bench_broker_serve( fd );
+
+        close( fd );
+    }
+
+    return NULL;
+}
+
+static int xi_bench_broker_start( pthread_t* thread, int* listen_fd, uint16_t* port )
+{
+    struct sockaddr_in address;
+    socklen_t address_length = sizeof( address );
+
+    memset( &address, 0, sizeof( address ) );
+    address.sin_family      = AF_INET;
+    address.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+    address.sin_port        = 0;
+
+    *listen_fd = socket( AF_INET, SOCK_STREAM, 0 );
+
+    if ( 0 > *listen_fd ||
+         0 != bind( *listen_fd, ( struct sockaddr* )&address, sizeof( address ) ) ||
+         0 != listen( *listen_fd, 1 ) ||
+         0 != getsockname( *listen_fd, ( struct sockaddr* )&address, &address_length ) ||
+         0 != pthread_create( thread, NULL, xi_bench_broker_thread,
+                              ( void* )( intptr_t )*listen_fd ) )
+    {
+        if ( 0 <= *listen_fd )
+        {
+            close( *listen_fd );
+        }
+
+        return 0;
+    }
+
+    *port = ntohs( address.sin_port );
+
+    return 1;
+}
+
+static void xi_bench_broker_stop( pthread_t thread, int listen_fd )
+{
+    shutdown( listen_fd, SHUT_RDWR );
+    pthread_join( thread, NULL );
+    close( listen_fd );
+}
+
+/*
+ * The client.
+ */
+
+static void xi_bench_loopback_on_connection( xi_context_handle_t in_context_handle,
+                                             void* data,
+                                             xi_state_t state )
+{
+    XI_UNUSED( in_context_handle );
+    XI_UNUSED( state );
+
+    const xi_connection_data_t* conn_data = ( xi_connection_data_t* )data;
+
+    xi_bench_loopback_connection_state = conn_data->connection_state;
+}
+
+/* runs the event loop until the counter reaches the expected value */
+static int xi_bench_loopback_process_until( const size_t* counter, size_t expected_value )
+{
+    const double deadline = xi_bench_loopback_now() + XI_BENCH_LOOPBACK_TIMEOUT_SEC;
+
+    while ( *counter < expected_value && xi_bench_loopback_now() < deadline )
+    {
+        /* run what has been scheduled from outside of the callbacks before the select
+         * blocks */
+        xi_evtd_step( xi_globals.evtd_instance, time( NULL ) );
+
+        if ( XI_STATE_OK != xi_events_process_tick() )
+        {
+            return 0;
+        }
+    }
+
+    return *counter >= expected_value;
+}
+
+static int xi_bench_loopback_process_until_state( xi_connection_state_t state )
+{
+    const double deadline = xi_bench_loopback_now() + XI_BENCH_LOOPBACK_TIMEOUT_SEC;
+
+    while ( state != xi_bench_loopback_connection_state &&
+            xi_bench_loopback_now() < deadline )
+    {
+        xi_evtd_step( xi_globals.evtd_instance, time( NULL ) );
+
+        if ( XI_STATE_OK != xi_events_process_tick() ||
+             XI_CONNECTION_STATE_OPEN_FAILED == xi_bench_loopback_connection_state )
+        {
+            return 0;
+        }
+    }
+
+    return state == xi_bench_loopback_connection_state;
+}
+
+static int xi_bench_loopback_compare_doubles( const void* a, const void* b )
+{
+    const double lhs = *( const double* )a;
+    const double rhs = *( const double* )b;
+
+    return ( lhs > rhs ) - ( lhs < rhs );
+}
+
+static double xi_bench_loopback_percentile( double* sorted, size_t count, double p )
+{
+    size_t index = ( size_t )( p * ( double )count );
+
+    return sorted[index < count ? index : count - 1];
+}
+
+static void xi_bench_loopback_publish_next( xi_bench_loopback_run_t* run )
+{
+    const uint32_t sequence = ( uint32_t )run->sent;
+
+    memcpy( run->payload, &sequence, sizeof( sequence ) );
+    run->sent_at[sequence] = xi_bench_loopback_now();
+    ++run->sent;
+
+    xi_publish_data( run->context_handle, XI_BENCH_LOOPBACK_ECHO_TOPIC, run->payload,
+                     run->payload_size, run->qos, XI_MQTT_RETAIN_FALSE, NULL, NULL );
+}
+
+static void xi_bench_loopback_on_echo( xi_context_handle_t in_context_handle,
+                                       xi_sub_call_type_t call_type,
+                                       const xi_sub_call_params_t* const params,
+                                       xi_state_t state,
+                                       void* user_data )
+{
+    XI_UNUSED( in_context_handle );
+    XI_UNUSED( state );
+    XI_UNUSED( user_data );
+
+    xi_bench_loopback_run_t* run = &xi_bench_loopback_run_state;
+    uint32_t sequence            = 0;
+
+    if ( XI_SUB_CALL_SUBACK == call_type )
+    {
+        ++xi_bench_loopback_subacks;
+        return;
+    }
+
+    if ( XI_SUB_CALL_MESSAGE != call_type ||
+         sizeof( sequence ) > params->message.temporary_payload_data_length )
+    {
+        return;
+    }
+
+    memcpy( &sequence, params->message.temporary_payload_data, sizeof( sequence ) );
+
+    if ( sequence >= run->sent )
+    {
+        return;
+    }
+
+    run->latencies[run->received++] = xi_bench_loopback_now() - run->sent_at[sequence];
+
+    if ( run->sent < run->messages )
+    {
+        xi_bench_loopback_publish_next( run );
+    }
+}
+
+static void xi_bench_loopback_on_fanin( xi_context_handle_t in_context_handle,
+                                        xi_sub_call_type_t call_type,
+                                        const xi_sub_call_params_t* const params,
+                                        xi_state_t state,
+                                        void* user_data )
+{
+    XI_UNUSED( in_context_handle );
+    XI_UNUSED( params );
+    XI_UNUSED( state );
+    XI_UNUSED( user_data );
+
+    if ( XI_SUB_CALL_SUBACK == call_type )
+    {
+        ++xi_bench_loopback_subacks;
+    }
+    else if ( XI_SUB_CALL_MESSAGE == call_type )
+    {
+        ++xi_bench_loopback_run_state.received;
+    }
+}
+
+static uint32_t xi_bench_loopback_allocations( xi_context_handle_t context_handle )
+{
+    xi_stats_t stats;
+    memset( &stats, 0, sizeof( stats ) );
+
+    xi_get_stats( context_handle, &stats );
+
+    return stats.allocations;
+}
+
+static int xi_bench_loopback_connect( xi_context_handle_t context_handle, uint16_t port )
+{
+    xi_bench_loopback_connection_state = XI_CONNECTION_STATE_OPENING;
+
+    xi_connect_to( context_handle, "127.0.0.1", port, "bench_user", "bench_password", 10,
+                   3600, XI_SESSION_CLEAN, &xi_bench_loopback_on_connection );
+
+    return xi_bench_loopback_process_until_state( XI_CONNECTION_STATE_OPENED );
+}
+
+static int xi_bench_loopback_measure_connect( xi_context_handle_t context_handle,
+                                              uint16_t port )
+{
+    double connect_times[XI_BENCH_LOOPBACK_CONNECTS];
+    size_t i = 0;
+
+    for ( i = 0; i < XI_BENCH_LOOPBACK_CONNECTS; ++i )
+    {
+        const double start = xi_bench_loopback_now();
+
+        if ( !xi_bench_loopback_connect( context_handle, port ) )
+        {
+            fprintf( stderr, "connect %zu has failed\n", i );
+            return 0;
+        }
+
+        connect_times[i] = xi_bench_loopback_now() - start;
+
+        xi_shutdown_connection( context_handle );
+
+        if ( !xi_bench_loopback_process_until_state( XI_CONNECTION_STATE_CLOSED ) )
+        {
+            fprintf( stderr, "disconnect %zu has failed\n", i );
+            return 0;
+        }
+    }
+
+    qsort( connect_times, XI_BENCH_LOOPBACK_CONNECTS, sizeof( double ),
+           xi_bench_loopback_compare_doubles );
+
+    printf( "%-8s %4s %8s %10u %12s %10.1f %10.1f %12s\n", "connect", "-", "-",
+            XI_BENCH_LOOPBACK_CONNECTS, "-",
+            xi_bench_loopback_percentile( connect_times, XI_BENCH_LOOPBACK_CONNECTS,
+                                          0.5 ) *
+                1e6,
+            xi_bench_loopback_percentile( connect_times, XI_BENCH_LOOPBACK_CONNECTS,
+                                          0.99 ) *
+                1e6,
+            "-" );
+
+    return 1;
+}
+
+static int xi_bench_loopback_measure_echo( xi_context_handle_t context_handle,
+                                           xi_mqtt_qos_t qos,
+                                           size_t payload_size,
+                                           size_t messages )
+{
+    xi_bench_loopback_run_t* run = &xi_bench_loopback_run_state;
+    size_t i                     = 0;
+    int ret                      = 0;
+
+    memset( run, 0, sizeof( *run ) );
+    run->context_handle = context_handle;
+    run->qos            = qos;
+    run->payload_size   = payload_size;
+    run->messages       = messages;
+    run->sent_at        = calloc( messages, sizeof( double ) );
+    run->latencies      = calloc( messages, sizeof( double ) );
+    run->payload        = calloc( payload_size, 1 );
+
+    if ( NULL == run->sent_at || NULL == run->latencies || NULL == run->payload )
+    {
+        goto end;
+    }
+
+    const uint32_t allocations_before = xi_bench_loopback_allocations( context_handle );
+    const double start                = xi_bench_loopback_now();
+
+    for ( i = 0; i < XI_BENCH_LOOPBACK_WINDOW && i < messages; ++i )
+    {
+        xi_bench_loopback_publish_next( run );
+    }
+
+    if ( !xi_bench_loopback_process_until( &run->received, messages ) )
+    {
+        fprintf( stderr, "echo: %zu of %zu messages have returned\n", run->received,
+                 messages );
+        goto end;
+    }
+
+    const double elapsed = xi_bench_loopback_now() - start;
+    const uint32_t allocations =
+        xi_bench_loopback_allocations( context_handle ) - allocations_before;
+
+    qsort( run->latencies, messages, sizeof( double ),
+           xi_bench_loopback_compare_doubles );
+
+    printf( "%-8s %4d %8zu %10zu %12.0f %10.1f %10.1f %12.2f\n", "echo", qos,
+            payload_size, messages, ( double )messages / elapsed,
+            xi_bench_loopback_percentile( run->latencies, messages, 0.5 ) * 1e6,
+            xi_bench_loopback_percentile( run->latencies, messages, 0.99 ) * 1e6,
+            ( double )allocations / ( double )messages );
+
+    ret = 1;
+
+end:
+    free( run->sent_at );
+    free( run->latencies );
+    free( run->payload );
+    memset( run, 0, sizeof( *run ) );
+
+    return ret;
+}
+
+static int
+xi_bench_loopback_measure_fanin( xi_context_handle_t context_handle, size_t messages )
+{
+    xi_bench_loopback_run_t* run = &xi_bench_loopback_run_state;
+    char count_string[16]        = {0};
+
+    memset( run, 0, sizeof( *run ) );
+    snprintf( count_string, sizeof( count_string ), "%zu", messages );
+
+    const uint32_t allocations_before = xi_bench_loopback_allocations( context_handle );
+    const double start                = xi_bench_loopback_now();
+
+    xi_publish( context_handle, XI_BENCH_LOOPBACK_FANIN_START_TOPIC, count_string,
+                XI_MQTT_QOS_AT_MOST_ONCE, XI_MQTT_RETAIN_FALSE, NULL, NULL );
+
+    if ( !xi_bench_loopback_process_until( &run->received, messages ) )
+    {
+        fprintf( stderr, "fan-in: %zu of %zu messages have arrived\n", run->received,
+                 messages );
+        return 0;
+    }
+
+    const double elapsed = xi_bench_loopback_now() - start;
+    const uint32_t allocations =
+        xi_bench_loopback_allocations( context_handle ) - allocations_before;
+
+    printf( "%-8s %4d %8d %10zu %12.0f %10s %10s %12.2f\n", "fan-in", 0,
+            XI_BENCH_LOOPBACK_FANIN_PAYLOAD_SIZE, messages, ( double )messages / elapsed,
+            "-", "-", ( double )allocations / ( double )messages );
+
+    return 1;
+}
+
+int main( int argc, char* argv[] )
+{
+    const size_t messages =
+        argc > 1 ? ( size_t )atoi( argv[1] ) : XI_BENCH_LOOPBACK_DEFAULT_MESSAGES;
+    xi_context_handle_t context_handle = XI_INVALID_CONTEXT_HANDLE;
+    pthread_t broker_thread;
+    int listen_fd = -1;
+    uint16_t port = 0;
+    size_t i      = 0;
+    int ret       = 1;
+
+    if ( 0 == messages )
+    {
+        fprintf( stderr, "usage: %s [messages]\n", argv[0] );
+        return 1;
+    }
+
+    if ( !xi_bench_broker_start( &broker_thread, &listen_fd, &port ) )
+    {
+        fprintf( stderr, "could not start the loopback broker\n" );
+        return 1;
+    }
+
+    if ( XI_STATE_OK != xi_initialize( "xi_bench_account_id", "xi_bench_device_id" ) ||
+         XI_INVALID_CONTEXT_HANDLE >= ( context_handle = xi_create_context() ) )
+    {
+        fprintf( stderr, "could not create the context\n" );
+        goto end;
+    }
+
+    printf( "%-8s %4s %8s %10s %12s %10s %10s %12s\n", "test", "qos", "payload",
+            "messages", "msgs/s", "p50 us", "p99 us", "allocs/msg" );
+
+    if ( !xi_bench_loopback_measure_connect( context_handle, port ) ||
+         !xi_bench_loopback_connect( context_handle, port ) )
+    {
+        goto end;
+    }
+
+    xi_subscribe( context_handle, XI_BENCH_LOOPBACK_ECHO_TOPIC, XI_MQTT_QOS_AT_LEAST_ONCE,
+                  &xi_bench_loopback_on_echo, NULL );
+    xi_subscribe( context_handle, XI_BENCH_LOOPBACK_FANIN_TOPIC, XI_MQTT_QOS_AT_MOST_ONCE,
+                  &xi_bench_loopback_on_fanin, NULL );
+
+    if ( !xi_bench_loopback_process_until( &xi_bench_loopback_subacks, 2 ) )
+    {
+        fprintf( stderr, "the subscriptions have not been acknowledged\n" );
+        goto end;
+    }
+
+    for ( i = 0; i < XI_ARRAYSIZE( xi_bench_loopback_payload_sizes ); ++i )
+    {
+        if ( !xi_bench_loopback_measure_echo( context_handle, XI_MQTT_QOS_AT_MOST_ONCE,
+                                              xi_bench_loopback_payload_sizes[i],
+                                              messages ) ||
+             !xi_bench_loopback_measure_echo( context_handle, XI_MQTT_QOS_AT_LEAST_ONCE,
+                                              xi_bench_loopback_payload_sizes[i],
+                                              messages ) )
+        {
+            goto end;
+        }
+    }
+
+    if ( xi_bench_loopback_measure_fanin( context_handle, messages ) )
+    {
+        ret = 0;
+    }
+
+end:
+    if ( XI_INVALID_CONTEXT_HANDLE < context_handle )
+    {
+        if ( XI_CONNECTION_STATE_OPENED == xi_bench_loopback_connection_state )
+        {
+            xi_shutdown_connection( context_handle );
+            xi_bench_loopback_process_until_state( XI_CONNECTION_STATE_CLOSED );
+        }
+
+        xi_delete_context( context_handle );
+    }
+
+    xi_shutdown();
+
+    xi_bench_broker_stop( broker_thread, listen_fd );
+
+    return ret;
+}
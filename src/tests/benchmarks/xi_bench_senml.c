@@ -0,0 +1,323 @@
+/* Copyright (c) 2003-2018, Xively All rights reserved.
+ *
+ * This is part of the Xively C Client library,
+ * it is licensed under the BSD 3-Clause license.
+ */
+
+/*
+ * Serializes SenML documents of 1000 entries with float values, times and units. The
+ * library's presized JSON serializer is compared with the way it used to work, growing
+ * the buffer token by token and formatting numbers with snprintf, which is reproduced
+ * here as the baseline, and with the SenML CBOR serializer. The streaming writer rows
+ * append the same entries into a fixed buffer of XI_BENCH_SENML_WRITER_BUFFER_SIZE
+ * bytes, flushing it whenever it is full.
+ *
+ * usage: xi_bench_senml [documents]
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "xi_allocator.h"
+#include "xi_data_desc.h"
+#include "xi_macros.h"
+#include "xively_senml.h"
+
+#define XI_BENCH_SENML_DEFAULT_DOCUMENTS 2000
+#define XI_BENCH_SENML_ENTRIES 1000
+#define XI_BENCH_SENML_WRITER_BUFFER_SIZE 1024
+
+#ifdef XI_BENCH_COUNT_ALLOCATIONS
+/* linked with -Wl,--wrap=xi_bsp_mem_alloc */
+extern void* __real_xi_bsp_mem_alloc( size_t byte_count );
+
+static size_t xi_bench_senml_allocations = 0;
+
+void* __wrap_xi_bsp_mem_alloc( size_t byte_count )
+{
+    ++xi_bench_senml_allocations;
+    return __real_xi_bsp_mem_alloc( byte_count );
+}
+#endif
+
+typedef xi_state_t( xi_bench_senml_serialize_t )( xi_senml_t* senml_structure,
+                                                  uint8_t** out_buffer,
+                                                  uint32_t* out_size );
+
+static double xi_bench_senml_now()
+{
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return ( double )ts.tv_sec + ( double )ts.tv_nsec / 1e9;
+}
+
+static size_t xi_bench_senml_allocation_count()
+{
+#ifdef XI_BENCH_COUNT_ALLOCATIONS
+    return xi_bench_senml_allocations;
+#else
+    return 0;
+#endif
+}
+
+static xi_state_t
+xi_bench_senml_append( xi_data_desc_t* out, const char* key, uint32_t count )
+{
+    xi_state_t state = XI_STATE_OK;
+
+    if ( 0 < count )
+    {
+        XI_CHECK_STATE( state = xi_data_desc_append_data_resize( out, ",", 1 ) );
+    }
+
+    XI_CHECK_STATE( state = xi_data_desc_append_data_resize( out, key, strlen( key ) ) );
+
+err_handling:
+    return state;
+}
+
+static xi_state_t xi_bench_senml_append_string( xi_data_desc_t* out, const char* string )
+{
+    xi_state_t state = XI_STATE_OK;
+
+    XI_CHECK_STATE( state = xi_data_desc_append_data_resize( out, "\"", 1 ) );
+    XI_CHECK_STATE(
+        state = xi_data_desc_append_data_resize( out, string, strlen( string ) ) );
+    XI_CHECK_STATE( state = xi_data_desc_append_data_resize( out, "\"", 1 ) );
+
+err_handling:
+    return state;
+}
+
+static xi_state_t
+xi_bench_senml_append_number( xi_data_desc_t* out, const char* format, double value )
+{
+    char buf[32] = {'\0'};
+
+    const int ret = ( '%' == format[0] && 'd' == format[1] )
+                        ? snprintf( buf, sizeof( buf ), format, ( int32_t )value )
+                        : snprintf( buf, sizeof( buf ), format, value );
+
+    return xi_data_desc_append_data_resize( out, buf, ret );
+}
+
+/* the former serializer, float and boolean values only */
+static xi_state_t xi_bench_senml_serialize_baseline( xi_senml_t* senml_structure,
+                                                     uint8_t** out_buffer,
+                                                     uint32_t* out_size )
+{
+    xi_state_t state        = XI_STATE_OK;
+    xi_senml_entry_t* entry = senml_structure->entries_list;
+    uint32_t entries_count  = 0;
+
+    xi_data_desc_t* out = xi_make_empty_desc_alloc( 32 );
+    XI_CHECK_MEMORY( out, state );
+
+    XI_CHECK_STATE( state = xi_data_desc_append_data_resize( out, "{\"e\":[", 6 ) );
+
+    for ( ; NULL != entry; entry = entry->__next )
+    {
+        uint32_t fields_count = 0;
+
+        XI_CHECK_STATE( state = xi_bench_senml_append( out, "{", entries_count++ ) );
+
+        XI_CHECK_STATE( state = xi_bench_senml_append( out, "\"n\":", fields_count++ ) );
+        XI_CHECK_STATE( state = xi_bench_senml_append_string( out, entry->name ) );
+
+        XI_CHECK_STATE( state = xi_bench_senml_append( out, "\"v\":", fields_count++ ) );
+        XI_CHECK_STATE( state = xi_bench_senml_append_number(
+                            out, "%.5g", entry->value_cnt.value.float_value ) );
+
+        XI_CHECK_STATE( state = xi_bench_senml_append( out, "\"t\":", fields_count++ ) );
+        XI_CHECK_STATE( state = xi_bench_senml_append_number( out, "%d", entry->time ) );
+
+        XI_CHECK_STATE( state = xi_bench_senml_append( out, "\"u\":", fields_count++ ) );
+        XI_CHECK_STATE( state = xi_bench_senml_append_string( out, entry->units ) );
+
+        XI_CHECK_STATE( state = xi_data_desc_append_data_resize( out, "}", 1 ) );
+    }
+
+    XI_CHECK_STATE( state = xi_data_desc_append_data_resize( out, "]", 1 ) );
+    XI_CHECK_STATE( state = xi_bench_senml_append( out, "\"bn\":", 1 ) );
+    XI_CHECK_STATE(
+        state = xi_bench_senml_append_string( out, senml_structure->base_name ) );
+    XI_CHECK_STATE( state = xi_data_desc_append_data_resize( out, "}", 1 ) );
+
+    *out_buffer      = out->data_ptr;
+    *out_size        = out->length;
+    out->memory_type = XI_MEMORY_TYPE_UNMANAGED;
+
+err_handling:
+    xi_free_desc( &out );
+    return state;
+}
+
+static xi_state_t xi_bench_senml_serialize_cbor( xi_senml_t* senml_structure,
+                                                 uint8_t** out_buffer,
+                                                 uint32_t* out_size )
+{
+    return xi_senml_serialize_as( senml_structure, XI_SENML_FORMAT_CBOR, out_buffer,
+                                  out_size );
+}
+
+/* out_size is the total of the flushed documents, there is no buffer to hand over */
+static xi_state_t xi_bench_senml_write( xi_senml_t* senml_structure,
+                                        xi_senml_format_t format,
+                                        uint8_t** out_buffer,
+                                        uint32_t* out_size )
+{
+    static uint8_t buffer[XI_BENCH_SENML_WRITER_BUFFER_SIZE];
+
+    xi_senml_writer_t writer;
+    xi_state_t state              = XI_STATE_OK;
+    const xi_senml_entry_t* entry = senml_structure->entries_list;
+    const uint8_t* document       = NULL;
+    uint32_t document_size        = 0;
+
+    *out_buffer = NULL;
+    *out_size   = 0;
+
+    XI_INIT_SENML_WRITER( state, &writer, format, buffer, sizeof( buffer ),
+                          XI_SENML_BASE_NAME( senml_structure->base_name ) );
+    XI_CHECK_STATE( state );
+
+    while ( NULL != entry )
+    {
+        XI_APPEND_SENML_ENTRY( state, &writer, XI_SENML_ENTRY_NAME( entry->name ),
+                               XI_SENML_ENTRY_FLOAT_VALUE(
+                                   entry->value_cnt.value.float_value ),
+                               XI_SENML_ENTRY_TIME( entry->time ),
+                               XI_SENML_ENTRY_UNITS( entry->units ) );
+
+        if ( XI_BUFFER_OVERFLOW == state )
+        {
+            XI_CHECK_STATE(
+                state = xi_flush_senml_writer( &writer, &document, &document_size ) );
+            *out_size += document_size;
+            continue;
+        }
+
+        XI_CHECK_STATE( state );
+        entry = entry->__next;
+    }
+
+    XI_CHECK_STATE( state = xi_flush_senml_writer( &writer, &document, &document_size ) );
+    *out_size += document_size;
+
+err_handling:
+    return state;
+}
+
+static xi_state_t xi_bench_senml_write_json( xi_senml_t* senml_structure,
+                                             uint8_t** out_buffer,
+                                             uint32_t* out_size )
+{
+    return xi_bench_senml_write( senml_structure, XI_SENML_FORMAT_JSON, out_buffer,
+                                 out_size );
+}
+
+static xi_state_t xi_bench_senml_write_cbor( xi_senml_t* senml_structure,
+                                             uint8_t** out_buffer,
+                                             uint32_t* out_size )
+{
+    return xi_bench_senml_write( senml_structure, XI_SENML_FORMAT_CBOR, out_buffer,
+                                 out_size );
+}
+
+static int xi_bench_senml_run( const char* serializer_name,
+                               xi_bench_senml_serialize_t* serialize,
+                               xi_senml_t* senml_structure,
+                               size_t documents )
+{
+    size_t i       = 0;
+    uint32_t bytes = 0;
+
+    const size_t allocations_before = xi_bench_senml_allocation_count();
+    const double start              = xi_bench_senml_now();
+
+    for ( ; i < documents; ++i )
+    {
+        uint8_t* buffer = NULL;
+
+        if ( XI_STATE_OK != serialize( senml_structure, &buffer, &bytes ) )
+        {
+            fprintf( stderr, "%s: serialization failed\n", serializer_name );
+            return 0;
+        }
+
+        xi_free( buffer );
+    }
+
+    const double seconds     = xi_bench_senml_now() - start;
+    const size_t allocations = xi_bench_senml_allocation_count() - allocations_before;
+
+#ifdef XI_BENCH_COUNT_ALLOCATIONS
+    printf( "%-12s %12.1f %12.1f %12u\n", serializer_name, seconds * 1e6 / documents,
+            ( double )allocations / documents, bytes );
+#else
+    ( void )allocations;
+    printf( "%-12s %12.1f %12s %12u\n", serializer_name, seconds * 1e6 / documents, "n/a",
+            bytes );
+#endif
+
+    return 1;
+}
+
+int main( int argc, char* argv[] )
+{
+    const size_t documents =
+        argc > 1 ? ( size_t )atoi( argv[1] ) : XI_BENCH_SENML_DEFAULT_DOCUMENTS;
+
+    xi_senml_t* senml_structure = NULL;
+    xi_state_t state            = XI_STATE_OK;
+    int32_t i                   = 0;
+    int ret                     = 1;
+
+    if ( 0 == documents )
+    {
+        fprintf( stderr, "usage: %s [documents]\n", argv[0] );
+        return 1;
+    }
+
+    XI_CREATE_SENML_STRUCT( state, senml_structure,
+                            XI_SENML_BASE_NAME( "urn:dev:mac:0024befffe804ff1:" ) );
+
+    for ( ; i < XI_BENCH_SENML_ENTRIES && XI_STATE_OK == state; ++i )
+    {
+        XI_ADD_SENML_ENTRY( state, senml_structure, XI_SENML_ENTRY_NAME( "temperature" ),
+                            XI_SENML_ENTRY_FLOAT_VALUE( 21.5f + ( i % 97 ) * 0.13f ),
+                            XI_SENML_ENTRY_TIME( -i ), XI_SENML_ENTRY_UNITS( "Cel" ) );
+    }
+
+    if ( XI_STATE_OK != state )
+    {
+        fprintf( stderr, "building the SenML structure failed\n" );
+        xi_senml_destroy( &senml_structure );
+        return 1;
+    }
+
+    printf( "%zu documents of %d entries\n", documents, XI_BENCH_SENML_ENTRIES );
+    printf( "%-12s %12s %12s %12s\n", "serializer", "us/doc", "allocs/doc", "bytes/doc" );
+
+    if ( xi_bench_senml_run( "baseline", &xi_bench_senml_serialize_baseline,
+                             senml_structure, documents ) &&
+         xi_bench_senml_run( "presized", &xi_senml_serialize, senml_structure,
+                             documents ) &&
+         xi_bench_senml_run( "cbor", &xi_bench_senml_serialize_cbor, senml_structure,
+                             documents ) &&
+         xi_bench_senml_run( "writer json", &xi_bench_senml_write_json, senml_structure,
+                             documents ) &&
+         xi_bench_senml_run( "writer cbor", &xi_bench_senml_write_cbor, senml_structure,
+                             documents ) )
+    {
+        ret = 0;
+    }
+
+    xi_senml_destroy( &senml_structure );
+
+    return ret;
+}
@@ -20,7 +20,7 @@ extern cn_cbor_context* context_cbor;
 
 #endif
 
-/* reusing the put_name_and_revision function from libxively here in the mock broker */
+/* reusing the put_name_and_revision function of the cn-cbor codec in the mock broker */
 void xi_cbor_put_name_and_revision( cn_cbor* cb_map,
                                     const char* name,
                                     const char* revision,
@@ -0,0 +1,358 @@
+/* Copyright (c) 2003-2018, Xively All rights reserved.
+ *
+ * This is part of the Xively C Client library,
+ * it is licensed under the BSD 3-Clause license.
+ */
+
+#include <string.h>
+
+#include "xi_io_replay_layer.h"
+#include "xi_io_net_capture.h"
+
+#include "xi_bsp_time.h"
+#include "xi_data_desc.h"
+#include "xi_debug.h"
+#include "xi_event_dispatcher_api.h"
+#include "xi_layer_api.h"
+#include "xi_macros.h"
+#include "xi_time_event.h"
+#include "xi_types.h"
+
+static struct
+{
+    /* set by xi_io_replay_layer_set_recording */
+    const uint8_t* recording;
+    size_t recording_size;
+    uint16_t session;
+    xi_io_replay_pace_t pace;
+
+    /* progress of the connection */
+    size_t offset;           /* of the next record to deliver */
+    size_t write_offset;     /* of the next recorded write to compare with */
+    uint32_t writes_awaited; /* recorded writes preceding the offset */
+    xi_time_t started_ms;
+    uint32_t session_started_ms;
+    uint8_t session_started;
+    xi_time_event_handle_t feed_event;
+    xi_io_replay_stats_t stats;
+} xi_io_replay;
+
+static uint8_t xi_io_replay_is_pingreq( const uint8_t* data, size_t length )
+{
+    return 2 == length && 0xc0 == data[0] && 0x00 == data[1];
+}
+
+static uint8_t xi_io_replay_is_pingresp( const uint8_t* data, size_t length )
+{
+    return 2 == length && 0xd0 == data[0] && 0x00 == data[1];
+}
+
+static xi_state_t
+xi_io_replay_next_of_session( size_t* offset, xi_io_net_capture_record_t* record )
+{
+    xi_state_t state = XI_STATE_OK;
+
+    do
+    {
+        state = xi_io_net_capture_next_record(
+            xi_io_replay.recording, xi_io_replay.recording_size, offset, record );
+    } while ( XI_STATE_OK == state && xi_io_replay.session != record->session );
+
+    return state;
+}
+
+/* skips to the recorded write following the offset, the keepalive ones aside */
+static xi_state_t
+xi_io_replay_next_write( size_t* offset, xi_io_net_capture_record_t* record )
+{
+    size_t next      = *offset;
+    xi_state_t state = XI_STATE_OK;
+
+    while ( XI_STATE_OK == ( state = xi_io_replay_next_of_session( &next, record ) ) )
+    {
+        if ( XI_IO_NET_CAPTURE_CLOSE == record->type )
+        {
+            return XI_ELEMENT_NOT_FOUND;
+        }
+
+        *offset = next;
+
+        if ( XI_IO_NET_CAPTURE_OUT == record->type &&
+             !xi_io_replay_is_pingreq( record->data, record->length ) )
+        {
+            return XI_STATE_OK;
+        }
+    }
+
+    return state;
+}
+
+static xi_state_t xi_io_replay_layer_feed( void* context, xi_time_t delay_s )
+{
+    if ( NULL != xi_io_replay.feed_event.ptr_to_position )
+    {
+        return XI_STATE_OK;
+    }
+
+    return xi_evtd_execute_in(
+        XI_CONTEXT_DATA( context )->evtd_instance,
+        xi_make_handle( &xi_io_replay_layer_pull, context, NULL, XI_STATE_OK ), delay_s,
+        &xi_io_replay.feed_event );
+}
+
+xi_state_t xi_io_replay_layer_set_recording( const uint8_t* recording,
+                                             size_t recording_size,
+                                             uint16_t session,
+                                             xi_io_replay_pace_t pace )
+{
+    xi_io_net_capture_record_t record;
+    size_t offset        = 0;
+    xi_state_t state     = XI_STATE_OK;
+    uint8_t session_seen = 0;
+
+    /* the whole recording is checked upfront so that the replay can't end halfway */
+    while ( XI_STATE_OK == ( state = xi_io_net_capture_next_record(
+                                 recording, recording_size, &offset, &record ) ) )
+    {
+        session = ( 0 == session ) ? record.session : session;
+        session_seen |= ( session == record.session );
+    }
+
+    if ( XI_ELEMENT_NOT_FOUND != state )
+    {
+        return state;
+    }
+
+    if ( !session_seen )
+    {
+        return XI_ELEMENT_NOT_FOUND;
+    }
+
+    xi_io_replay.recording      = recording;
+    xi_io_replay.recording_size = recording_size;
+    xi_io_replay.session        = session;
+    xi_io_replay.pace           = pace;
+
+    return XI_STATE_OK;
+}
+
+void xi_io_replay_layer_get_stats( xi_io_replay_stats_t* stats )
+{
+    memcpy( stats, &xi_io_replay.stats, sizeof( *stats ) );
+}
+
+int32_t xi_io_replay_layer_awaited_write( const uint8_t** data, size_t* length )
+{
+    xi_io_net_capture_record_t record;
+    size_t offset = xi_io_replay.write_offset;
+
+    if ( xi_io_replay.stats.finished ||
+         xi_io_replay.stats.writes >= xi_io_replay.writes_awaited ||
+         XI_STATE_OK != xi_io_replay_next_write( &offset, &record ) )
+    {
+        return -1;
+    }
+
+    *data   = record.data;
+    *length = record.length;
+
+    return ( int32_t )xi_io_replay.stats.writes;
+}
+
+xi_state_t xi_io_replay_layer_push( void* context, void* data, xi_state_t in_out_state )
+{
+    XI_UNUSED( in_out_state );
+
+    xi_data_desc_t* buffer = ( xi_data_desc_t* )data;
+    xi_data_desc_t* reply  = NULL;
+    xi_state_t state       = XI_STATE_OK;
+    xi_io_net_capture_record_t record;
+
+    if ( XI_THIS_LAYER_NOT_OPERATIONAL( context ) || NULL == buffer )
+    {
+        xi_free_desc( &buffer );
+        return XI_STATE_OK;
+    }
+
+    if ( xi_io_replay_is_pingreq( buffer->data_ptr, buffer->capacity ) )
+    {
+        reply = xi_make_desc_from_buffer_copy( ( const uint8_t* )"\xd0\x00", 2 );
+        XI_CHECK_MEMORY( reply, state );
+    }
+    else
+    {
+        if ( XI_STATE_OK !=
+                 xi_io_replay_next_write( &xi_io_replay.write_offset, &record ) ||
+             0 == record.length || 0 == buffer->capacity ||
+             record.data[0] != buffer->data_ptr[0] )
+        {
+            ++xi_io_replay.stats.writes_diverged;
+        }
+
+        ++xi_io_replay.stats.writes;
+        xi_io_replay.stats.bytes_written += buffer->capacity;
+
+        state = xi_io_replay_layer_feed( context, 0 );
+        XI_CHECK_STATE( state );
+    }
+
+    xi_free_desc( &buffer );
+
+    if ( NULL != reply )
+    {
+        XI_PROCESS_PULL_ON_THIS_LAYER( context, reply, XI_STATE_OK );
+    }
+
+    return XI_PROCESS_PUSH_ON_NEXT_LAYER( context, NULL, XI_STATE_WRITTEN );
+
+err_handling:
+    xi_free_desc( &buffer );
+
+    return XI_PROCESS_CLOSE_EXTERNALLY_ON_THIS_LAYER( context, NULL, state );
+}
+
+xi_state_t xi_io_replay_layer_pull( void* context, void* data, xi_state_t in_out_state )
+{
+    xi_data_desc_t* buffer = ( xi_data_desc_t* )data;
+    xi_state_t state       = XI_STATE_OK;
+    size_t next            = 0;
+    xi_io_net_capture_record_t record;
+
+    if ( XI_THIS_LAYER_NOT_OPERATIONAL( context ) )
+    {
+        xi_free_desc( &buffer );
+        return XI_STATE_OK;
+    }
+
+    /* a reply made up by the layer itself */
+    if ( NULL != buffer )
+    {
+        return XI_PROCESS_PULL_ON_NEXT_LAYER( context, buffer, in_out_state );
+    }
+
+    for ( ;; )
+    {
+        next = xi_io_replay.offset;
+
+        if ( XI_STATE_OK != xi_io_replay_next_of_session( &next, &record ) ||
+             XI_IO_NET_CAPTURE_CLOSE == record.type )
+        {
+            xi_io_replay.stats.finished = 1;
+            return XI_STATE_OK;
+        }
+
+        if ( !xi_io_replay.session_started )
+        {
+            xi_io_replay.session_started    = 1;
+            xi_io_replay.session_started_ms = record.timestamp_ms;
+        }
+
+        if ( XI_IO_NET_CAPTURE_IN != record.type )
+        {
+            if ( XI_IO_NET_CAPTURE_OUT == record.type &&
+                 !xi_io_replay_is_pingreq( record.data, record.length ) )
+            {
+                ++xi_io_replay.writes_awaited;
+            }
+
+            xi_io_replay.offset = next;
+            continue;
+        }
+
+        if ( xi_io_replay_is_pingresp( record.data, record.length ) )
+        {
+            ++xi_io_replay.stats.records_skipped;
+            xi_io_replay.offset = next;
+            continue;
+        }
+
+        /* the next write of the client resumes the feed */
+        if ( xi_io_replay.stats.writes < xi_io_replay.writes_awaited )
+        {
+            return XI_STATE_OK;
+        }
+
+        if ( XI_IO_REPLAY_RECORDED_PACE == xi_io_replay.pace )
+        {
+            const xi_time_t due_ms =
+                xi_io_replay.started_ms +
+                ( xi_time_t )( record.timestamp_ms - xi_io_replay.session_started_ms );
+            const xi_time_t now_ms = xi_bsp_time_getcurrenttime_milliseconds();
+
+            if ( now_ms < due_ms )
+            {
+                return xi_io_replay_layer_feed( context, ( due_ms - now_ms ) / 1000 );
+            }
+        }
+
+        break;
+    }
+
+    buffer = xi_make_desc_from_buffer_copy( record.data, record.length );
+    XI_CHECK_MEMORY( buffer, state );
+
+    xi_io_replay.offset = next;
+    xi_io_replay.stats.records_delivered += 1;
+    xi_io_replay.stats.bytes_delivered += record.length;
+
+    /* one record per iteration of the event loop like a socket read */
+    state = xi_io_replay_layer_feed( context, 0 );
+    XI_CHECK_STATE( state );
+
+    return XI_PROCESS_PULL_ON_NEXT_LAYER( context, buffer, XI_STATE_OK );
+
+err_handling:
+    xi_free_desc( &buffer );
+
+    return XI_PROCESS_CLOSE_EXTERNALLY_ON_THIS_LAYER( context, NULL, state );
+}
+
+xi_state_t xi_io_replay_layer_close( void* context, void* data, xi_state_t in_out_state )
+{
+    return XI_PROCESS_CLOSE_EXTERNALLY_ON_THIS_LAYER( context, data, in_out_state );
+}
+
+xi_state_t
+xi_io_replay_layer_close_externally( void* context, void* data, xi_state_t in_out_state )
+{
+    if ( NULL != xi_io_replay.feed_event.ptr_to_position )
+    {
+        xi_evtd_cancel( XI_CONTEXT_DATA( context )->evtd_instance,
+                        &xi_io_replay.feed_event );
+    }
+
+    return XI_PROCESS_CLOSE_EXTERNALLY_ON_NEXT_LAYER( context, data, in_out_state );
+}
+
+xi_state_t xi_io_replay_layer_init( void* context, void* data, xi_state_t in_out_state )
+{
+    if ( NULL == xi_io_replay.recording )
+    {
+        xi_debug_logger( "no recording to replay" );
+        in_out_state = XI_FAILED_INITIALIZATION;
+    }
+
+    xi_io_replay.offset             = 0;
+    xi_io_replay.write_offset       = 0;
+    xi_io_replay.writes_awaited     = 0;
+    xi_io_replay.started_ms         = 0;
+    xi_io_replay.session_started_ms = 0;
+    xi_io_replay.session_started    = 0;
+    memset( &xi_io_replay.stats, 0, sizeof( xi_io_replay.stats ) );
+
+    return XI_PROCESS_CONNECT_ON_THIS_LAYER( context, data, in_out_state );
+}
+
+xi_state_t
+xi_io_replay_layer_connect( void* context, void* data, xi_state_t in_out_state )
+{
+    XI_UNUSED( data );
+
+    if ( XI_STATE_OK == in_out_state )
+    {
+        xi_io_replay.started_ms = xi_bsp_time_getcurrenttime_milliseconds();
+        in_out_state            = xi_io_replay_layer_feed( context, 0 );
+    }
+
+    return XI_PROCESS_CONNECT_ON_NEXT_LAYER( context, NULL, in_out_state );
+}
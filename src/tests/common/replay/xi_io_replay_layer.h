@@ -0,0 +1,98 @@
+/* Copyright (c) 2003-2018, Xively All rights reserved.
+ *
+ * This is part of the Xively C Client library,
+ * it is licensed under the BSD 3-Clause license.
+ */
+
+#ifndef __XI_IO_REPLAY_LAYER_H__
+#define __XI_IO_REPLAY_LAYER_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "xi_layer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * An io layer which plays a session of a net capture, see xi_io_net_capture.h, back
+ * into the layer chain instead of using a socket.
+ *
+ * The inbound records are pulled into the next layer in order, each one not before
+ * the client has written as many times as it did before the record was read during
+ * the capture. The writes themselves are dropped, only their first bytes are
+ * compared with the recorded ones to count the divergences. Keepalive is not
+ * replayed: the recorded PINGREQs are not waited for, the recorded PINGRESPs are
+ * skipped and the PINGREQs of the client are answered by the layer itself.
+ *
+ * The client actions, like subscribing or publishing, are not part of the replay,
+ * whoever drives it has to repeat them, xi_io_replay_layer_awaited_write tells which
+ * recorded write the replay is stalled on.
+ *
+ * There is one replay at a time, the recording is set before connecting.
+ */
+
+typedef enum xi_io_replay_pace_e {
+    /* the records are delivered as soon as the client is ready for them */
+    XI_IO_REPLAY_FULL_SPEED = 0,
+    /* no record is delivered before its offset from the start of the session has
+     * elapsed, the gaps shorter than a second are waited out by polling */
+    XI_IO_REPLAY_RECORDED_PACE
+} xi_io_replay_pace_t;
+
+typedef struct xi_io_replay_stats_s
+{
+    uint32_t records_delivered;
+    uint32_t records_skipped; /* the keepalive ones */
+    uint32_t writes;
+    uint32_t writes_diverged; /* starting differently than the recorded ones */
+    uint64_t bytes_delivered;
+    uint64_t bytes_written;
+    uint8_t finished; /* the end of the session has been reached */
+} xi_io_replay_stats_t;
+
+/**
+ * @brief xi_io_replay_layer_set_recording sets the capture to replay, it is not
+ * copied and has to stay valid until the connection is closed
+ *
+ * @param session number of the session to replay, 0 for the first one recorded
+ * @return XI_STATE_OK, XI_INVALID_PARAMETER if the recording is malformed or
+ * XI_ELEMENT_NOT_FOUND if it has no such session
+ */
+xi_state_t xi_io_replay_layer_set_recording( const uint8_t* recording,
+                                             size_t recording_size,
+                                             uint16_t session,
+                                             xi_io_replay_pace_t pace );
+
+void xi_io_replay_layer_get_stats( xi_io_replay_stats_t* stats );
+
+/**
+ * @brief xi_io_replay_layer_awaited_write tells the recorded write the next inbound
+ * record waits for
+ *
+ * @param [out] data, length the recorded bytes
+ * @return index of the write, counted from 0, or -1 if the replay is not stalled
+ */
+int32_t xi_io_replay_layer_awaited_write( const uint8_t** data, size_t* length );
+
+xi_state_t xi_io_replay_layer_push( void* context, void* data, xi_state_t in_out_state );
+
+xi_state_t xi_io_replay_layer_pull( void* context, void* data, xi_state_t in_out_state );
+
+xi_state_t xi_io_replay_layer_close( void* context, void* data, xi_state_t in_out_state );
+
+xi_state_t
+xi_io_replay_layer_close_externally( void* context, void* data, xi_state_t in_out_state );
+
+xi_state_t xi_io_replay_layer_init( void* context, void* data, xi_state_t in_out_state );
+
+xi_state_t
+xi_io_replay_layer_connect( void* context, void* data, xi_state_t in_out_state );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __XI_IO_REPLAY_LAYER_H__ */
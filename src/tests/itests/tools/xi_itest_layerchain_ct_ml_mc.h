@@ -62,7 +62,7 @@ XI_LAYER_TYPES_ADD( XI_LAYER_TYPE_MOCK_IO,
                         xi_mqtt_logic_layer_close_externally,
                         xi_mqtt_logic_layer_init,
                         xi_mqtt_logic_layer_connect,
-                        xi_layer_default_post_connect ),
+                        xi_mqtt_logic_layer_post_connect ),
     XI_LAYER_TYPES_ADD( XI_LAYER_TYPE_CONTROL_TOPIC_SUT,
                         xi_control_topic_layer_push,
                         xi_control_topic_layer_pull,
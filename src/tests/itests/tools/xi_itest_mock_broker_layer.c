@@ -11,6 +11,7 @@
 #include "xi_itest_mock_broker_sft_logic.h"
 #include "xi_itest_mock_broker_layerchain.h"
 #include "xi_layer_macros.h"
+#include "xi_list.h"
 #include "xi_mqtt_logic_layer_data_helpers.h"
 #include "xi_tuples.h"
 #include "xi_types.h"
@@ -106,12 +107,19 @@ xi_state_t xi_mock_broker_layer_push( void* context, void* data, xi_state_t in_o
             xi_mock_broker_data_t* layer_data =
                 ( xi_mock_broker_data_t* )layer->user_data;
 
-            if ( NULL != layer_data )
+            xi_mqtt_written_data_t* written_data = ( xi_mqtt_written_data_t* )data;
+
+            /* messages are written in the order of pushing, so the written PUBLISH
+             * is the oldest one with content */
+            if ( NULL != layer_data && NULL != layer_data->outgoing_publish_contents &&
+                 ( NULL == written_data || XI_MQTT_TYPE_PUBLISH == written_data->a2 ) )
             {
-                xi_free_desc( &layer_data->outgoing_publish_content );
+                xi_data_desc_t* publish_content = NULL;
+                XI_LIST_POP( xi_data_desc_t, layer_data->outgoing_publish_contents,
+                             publish_content );
+                xi_free_desc( &publish_content );
             }
 
-            xi_mqtt_written_data_t* written_data = ( xi_mqtt_written_data_t* )data;
             XI_SAFE_FREE_TUPLE( written_data );
         }
 
@@ -138,6 +146,7 @@ xi_state_t xi_mock_broker_layer_pull( void* context, void* data, xi_state_t in_o
     xi_layer_t* layer                 = ( xi_layer_t* )XI_THIS_LAYER( context );
     xi_mock_broker_data_t* layer_data = ( xi_mock_broker_data_t* )layer->user_data;
     xi_mqtt_message_t* recvd_msg      = ( xi_mqtt_message_t* )data;
+    xi_mqtt_topicpair_t* topic        = NULL;
 
     /* mock broker behavior: decoded MQTT messages arrive here,
      * note the PULL to PUSH conversion */
@@ -189,6 +198,15 @@ xi_state_t xi_mock_broker_layer_pull( void* context, void* data, xi_state_t in_o
                         recvd_msg->subscribe.topics->xi_mqtt_topic_pair_payload_u.qos,
                         XI_MQTT_DUP_FALSE ) );
 
+                // every further topic filter is granted with the requested qos too
+                for ( topic = recvd_msg->subscribe.topics->next; NULL != topic;
+                      topic = topic->next )
+                {
+                    XI_CHECK_STATE( in_out_state = append_subscribe_topic(
+                                        msg_suback, "unused topic name",
+                                        topic->xi_mqtt_topic_pair_payload_u.qos ) );
+                }
+
                 msg_suback->common.common_u.common_bits.type = XI_MQTT_TYPE_SUBACK;
 
                 xi_mqtt_message_free( &recvd_msg );
@@ -196,6 +214,19 @@ xi_state_t xi_mock_broker_layer_pull( void* context, void* data, xi_state_t in_o
             }
             break;
 
+            case XI_MQTT_TYPE_UNSUBSCRIBE:
+            {
+                XI_ALLOC( xi_mqtt_message_t, msg_unsuback, in_out_state );
+
+                msg_unsuback->common.common_u.common_bits.type = XI_MQTT_TYPE_UNSUBACK;
+                msg_unsuback->unsuback.message_id = recvd_msg->unsubscribe.message_id;
+
+                xi_mqtt_message_free( &recvd_msg );
+                return XI_PROCESS_PUSH_ON_PREV_LAYER( context, msg_unsuback,
+                                                      in_out_state );
+            }
+            break;
+
             case XI_MQTT_TYPE_PUBLISH:
             {
                 const char* publish_topic_name =
@@ -243,7 +274,9 @@ xi_state_t xi_mock_broker_layer_pull( void* context, void* data, xi_state_t in_o
                             recvd_msg->common.common_u.common_bits.dup,
                             recvd_msg->publish.message_id );
 
-                        layer_data->outgoing_publish_content = reply_sft_cbor_encoded;
+                        XI_LIST_PUSH_BACK( xi_data_desc_t,
+                                           layer_data->outgoing_publish_contents,
+                                           reply_sft_cbor_encoded );
 
                         xi_mqtt_message_free( &recvd_msg );
 
@@ -251,6 +284,32 @@ xi_state_t xi_mock_broker_layer_pull( void* context, void* data, xi_state_t in_o
                             context, mqtt_publish_sft_reply, in_out_state );
                     }
                 }
+
+                /* loopback */
+                if ( NULL != layer_data && NULL != layer_data->loopback_topic_name &&
+                     0 == strcmp( publish_topic_name, layer_data->loopback_topic_name ) )
+                {
+                    xi_data_desc_t* loopback_content = xi_make_desc_from_buffer_copy(
+                        recvd_msg->publish.content->data_ptr,
+                        recvd_msg->publish.content->length );
+                    XI_CHECK_MEMORY( loopback_content, in_out_state );
+
+                    XI_ALLOC( xi_mqtt_message_t, mqtt_publish_loopback, in_out_state );
+
+                    in_out_state = fill_with_publish_data(
+                        mqtt_publish_loopback, layer_data->loopback_topic_name,
+                        loopback_content, XI_MQTT_QOS_AT_MOST_ONCE, XI_MQTT_RETAIN_FALSE,
+                        XI_MQTT_DUP_FALSE, 0 );
+
+                    XI_LIST_PUSH_BACK( xi_data_desc_t,
+                                       layer_data->outgoing_publish_contents,
+                                       loopback_content );
+
+                    xi_mqtt_message_free( &recvd_msg );
+
+                    return XI_PROCESS_PUSH_ON_PREV_LAYER( context, mqtt_publish_loopback,
+                                                          in_out_state );
+                }
             }
             break;
 
@@ -284,6 +343,18 @@ xi_mock_broker_layer_close( void* context, void* data, xi_state_t in_out_state )
     xi_layer_t* layer                 = ( xi_layer_t* )XI_THIS_LAYER( context );
     xi_mock_broker_data_t* layer_data = ( xi_mock_broker_data_t* )layer->user_data;
 
+    if ( NULL != layer_data )
+    {
+        xi_data_desc_t* publish_content = NULL;
+
+        while ( NULL != layer_data->outgoing_publish_contents )
+        {
+            XI_LIST_POP( xi_data_desc_t, layer_data->outgoing_publish_contents,
+                         publish_content );
+            xi_free_desc( &publish_content );
+        }
+    }
+
     XI_SAFE_FREE( layer_data );
 
     return XI_PROCESS_CLOSE_ON_PREV_LAYER( context, data, in_out_state );
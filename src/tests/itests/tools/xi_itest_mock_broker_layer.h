@@ -24,7 +24,11 @@ typedef struct xi_mock_broker_data_s
     const char* control_topic_name_broker_in;
     const char* control_topic_name_broker_out;
 
-    xi_data_desc_t* outgoing_publish_content;
+    /* PUBLISHes on this topic are sent back to the client with QoS0, NULL turns it off */
+    const char* loopback_topic_name;
+
+    /* payloads of PUBLISH replies not written yet, in the order of pushing */
+    xi_data_desc_t* outgoing_publish_contents;
 } xi_mock_broker_data_t;
 
 /**
@@ -6,6 +6,10 @@
 
 #include "xi_itest_helpers.h"
 
+#if XI_LAYER_CHAIN_STATIC
+#include "xi_layer_stack_funcs.h"
+#endif
+
 int cmocka_run_test_groups( const struct CMGroupTest* const tgroups )
 {
     int ret = 0;
@@ -83,6 +87,11 @@ void xi_itest_inject_wraps( xi_context_t* xi_context,
         xi_itest_inject_wrap( layer, close_externally, close_externally );
         xi_itest_inject_wrap( layer, init, init );
         xi_itest_inject_wrap( layer, connect, connect );
+
+#if XI_LAYER_CHAIN_STATIC
+        /* the wrapped layer mustn't be called through the static dispatch anymore */
+        layer->static_type_id = xi_layer_stack_static_type_id( layer->layer_funcs );
+#endif
     }
     else
     {
@@ -12,6 +12,10 @@
 #include "xi_memory_checks.h"
 #include "xi_mqtt_logic_layer_data_helpers.h"
 
+#ifdef XI_SENML_ENABLED
+#include "xively_senml.h"
+#endif
+
 #include <time.h>
 
 xi_context_t* xi_context__itest_mqttlogic_layer                      = NULL;
@@ -136,9 +140,37 @@ xi_state_t xi_itest_mqttlogic_call_subscribe( xi_context_handle_t xih,
                          &xi_itest_mqttlogic_subscribe_callback, NULL );
 }
 
+#ifdef XI_SENML_ENABLED
+xi_state_t xi_itest_mqttlogic_call_publish_senml( xi_context_handle_t xih,
+                                                  const char* topic_name,
+                                                  const char* payload )
+{
+    xi_senml_t* senml_structure = NULL;
+    xi_state_t state            = XI_STATE_OK;
+
+    XI_CREATE_SENML_STRUCT( state, senml_structure, XI_SENML_BASE_NAME( "urn:itest:" ) );
+    XI_ADD_SENML_ENTRY( state, senml_structure, XI_SENML_ENTRY_NAME( "payload_length" ),
+                        XI_SENML_ENTRY_FLOAT_VALUE( ( float )strlen( payload ) ) );
+
+    if ( XI_STATE_OK == state )
+    {
+        state = xi_publish_senml( xih, topic_name, senml_structure, XI_SENML_FORMAT_CBOR,
+                                  XI_MQTT_QOS_AT_LEAST_ONCE, XI_MQTT_RETAIN_FALSE, NULL,
+                                  NULL );
+    }
+
+    xi_senml_destroy( &senml_structure );
+
+    return state;
+}
+#endif
+
 static const xi_itest_mqttlogic_persistant_session_test_sample_t
     XI_ITEST_MQTTLOGIC_PERSISTANT_SESSION_TEST_DATA[] = {
         {XI_MQTT_TYPE_PUBLISH, &xi_itest_mqttlogic_call_publish},
+#ifdef XI_SENML_ENABLED
+        {XI_MQTT_TYPE_PUBLISH, &xi_itest_mqttlogic_call_publish_senml},
+#endif
         {XI_MQTT_TYPE_SUBSCRIBE, &xi_itest_mqttlogic_call_subscribe}};
 
 int xi_itest_mqttlogic_layer_setup( void** state )
@@ -923,3 +955,87 @@ void xi_itest_mqtt_logic_layer__persistant_session__success_unacked_messages_are
 err_handling:
     xi_itest_mqttlogic_shutdown_and_disconnect( context_handle );
 }
+
+void xi_itest_mqtt_logic_layer__keepalive__traffic_flowing__pingreq_is_skipped(
+    void** state )
+{
+    XI_UNUSED( state );
+
+    xi_state_t local_state             = XI_STATE_OK;
+    xi_context_handle_t context_handle = XI_INVALID_CONTEXT_HANDLE;
+    xi_keepalive_stats_t stats         = {0, 0};
+
+    /* long enough for the jitter to not reach the steps below */
+    const uint16_t keepalive_timeout = 40;
+
+    xi_layer_t* top_layer = xi_context__itest_mqttlogic_layer->layer_chain.top;
+
+    /* the CONNECT has to be written for the CONNACK to start the keepalive */
+    will_return( xi_mock_layer_mqttlogic_prev_push, XI_STATE_OK );
+
+    xi_itest_mqttlogic_prepare_init_and_connect_layer( top_layer, XI_SESSION_CLEAN, 0 );
+
+    xi_context__itest_mqttlogic_layer->context_data.connection_data->keepalive_timeout =
+        keepalive_timeout;
+
+    xi_itest_mqttlogic_layer_act();
+
+    const xi_time_t connected_time = xi_globals.evtd_instance->current_step;
+
+    XI_CHECK_STATE( local_state = xi_find_handle_for_object(
+                        xi_globals.context_handles_vector,
+                        xi_context__itest_mqttlogic_layer, &context_handle ) );
+
+    /* a message sent in the middle of the keepalive period */
+    assert_int_equal( xi_publish( context_handle, "test_topic", "test_payload",
+                                  XI_MQTT_QOS_AT_MOST_ONCE, XI_MQTT_RETAIN_FALSE, NULL,
+                                  NULL ),
+                      XI_STATE_OK );
+
+    expect_value( xi_mock_layer_mqttlogic_next_push, in_out_state, XI_STATE_OK );
+    expect_value( xi_mock_layer_mqttlogic_prev_push, in_out_state, XI_STATE_OK );
+    expect_check( xi_mock_layer_mqttlogic_prev_push, data, check_msg,
+                  xi_itest_mqttlogic_make_msg_test_matrix(
+                      ( xi_itest_mqttlogic_test_msg_what_to_check_t ){0, 0, 0, 1},
+                      ( xi_itest_mqttlogic_test_msg_common_bits_check_values_t ){
+                          0, 0, 0, XI_MQTT_TYPE_PUBLISH} ) );
+    will_return( xi_mock_layer_mqttlogic_prev_push, XI_STATE_OK );
+
+    xi_evtd_step( xi_globals.evtd_instance, connected_time + 20 );
+
+    /* the keepalive expires but the connection has not been idle, no PINGREQ */
+    xi_evtd_step( xi_globals.evtd_instance, connected_time + keepalive_timeout + 2 );
+
+    assert_int_equal( xi_get_keepalive_stats( context_handle, &stats ), XI_STATE_OK );
+    assert_int_equal( stats.pings_sent, 0 );
+    assert_int_equal( stats.pings_avoided, 1 );
+
+    /* nothing sent since, the next expiry pings */
+    expect_value( xi_mock_layer_mqttlogic_prev_push, in_out_state, XI_STATE_OK );
+    expect_check( xi_mock_layer_mqttlogic_prev_push, data, check_msg,
+                  xi_itest_mqttlogic_make_msg_test_matrix(
+                      ( xi_itest_mqttlogic_test_msg_what_to_check_t ){0, 0, 0, 1},
+                      ( xi_itest_mqttlogic_test_msg_common_bits_check_values_t ){
+                          0, 0, 0, XI_MQTT_TYPE_PINGREQ} ) );
+    will_return( xi_mock_layer_mqttlogic_prev_push, XI_STATE_OK );
+
+    xi_evtd_step( xi_globals.evtd_instance,
+                  connected_time + 20 + keepalive_timeout + 2 );
+
+    assert_int_equal( xi_get_keepalive_stats( context_handle, &stats ), XI_STATE_OK );
+    assert_int_equal( stats.pings_sent, 1 );
+    assert_int_equal( stats.pings_avoided, 1 );
+
+    /* the broker answers, the shutdown does not have to wait for it */
+    XI_ALLOC( xi_mqtt_message_t, pingresp, local_state );
+    pingresp->common.common_u.common_bits.type = XI_MQTT_TYPE_PINGRESP;
+
+    XI_PROCESS_PULL_ON_PREV_LAYER( &top_layer->layer_connection, pingresp, XI_STATE_OK );
+    xi_evtd_step( xi_globals.evtd_instance, xi_globals.evtd_instance->current_step );
+
+    xi_itest_mqttlogic_shutdown_and_disconnect( context_handle );
+
+    return;
+err_handling:
+    xi_itest_mqttlogic_shutdown_and_disconnect( context_handle );
+}
@@ -34,6 +34,8 @@ xi_itest_mqtt_logic_layer__persistant_session__failure_unsent_message_are_not_re
 extern void
 xi_itest_mqtt_logic_layer__persistant_session__success_unacked_messages_are_resend_after_reconnect(
     void** state );
+extern void xi_itest_mqtt_logic_layer__keepalive__traffic_flowing__pingreq_is_skipped(
+    void** state );
 
 #ifdef XI_MOCK_TEST_PREPROCESSOR_RUN
 struct CMUnitTest xi_itests_mqttlogic_layer[] = {
@@ -64,6 +66,10 @@ struct CMUnitTest xi_itests_mqttlogic_layer[] = {
     cmocka_unit_test_setup_teardown(
         xi_itest_mqtt_logic_layer__persistant_session__success_unacked_messages_are_resend_after_reconnect,
         xi_itest_mqttlogic_layer_setup,
+        xi_itest_mqttlogic_layer_teardown ),
+    cmocka_unit_test_setup_teardown(
+        xi_itest_mqtt_logic_layer__keepalive__traffic_flowing__pingreq_is_skipped,
+        xi_itest_mqttlogic_layer_setup,
         xi_itest_mqttlogic_layer_teardown )};
 #endif
 
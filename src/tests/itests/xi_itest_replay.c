@@ -0,0 +1,308 @@
+/* Copyright (c) 2003-2018, Xively All rights reserved.
+ *
+ * This is part of the Xively C Client library,
+ * it is licensed under the BSD 3-Clause license.
+ */
+
+#include "xi_itest_replay.h"
+
+#include <string.h>
+#include <time.h>
+
+#include "xi_bsp_time.h"
+#include "xi_globals.h"
+#include "xi_handle.h"
+#include "xi_io_net_capture.h"
+#include "xi_io_replay_layer.h"
+#include "xi_layer_default_functions.h"
+#include "xi_layer_macros.h"
+#include "xi_memory_checks.h"
+
+#include "xi_mqtt_codec_layer.h"
+#include "xi_mqtt_logic_layer.h"
+
+/*
+ * The replay io layer under the real MQTT layers, fed with a session put together
+ * record by record. The control topic layer is left out, its subscription and the
+ * Secure File Transfer traffic would make the session depend on the configuration.
+ * The session is:
+ *  - the client connects and subscribes,
+ *  - the broker acknowledges both, then publishes three messages, the first two
+ *    read at once, with a PINGRESP in between and the last one a bit later,
+ *  - the client disconnects.
+ */
+
+enum xi_itest_replay_stack_order_e
+{
+    XI_LAYER_TYPE_ITEST_REPLAY = 0,
+    XI_LAYER_TYPE_ITEST_REPLAY_MQTT_CODEC,
+    XI_LAYER_TYPE_ITEST_REPLAY_MQTT_LOGIC
+};
+
+#define XI_ITEST_REPLAY_LAYER_CHAIN                                                      \
+    XI_LAYER_TYPE_ITEST_REPLAY                                                           \
+    , XI_LAYER_TYPE_ITEST_REPLAY_MQTT_CODEC, XI_LAYER_TYPE_ITEST_REPLAY_MQTT_LOGIC
+
+XI_DECLARE_LAYER_TYPES_BEGIN( xi_itest_replay_layer_chain )
+XI_LAYER_TYPES_ADD( XI_LAYER_TYPE_ITEST_REPLAY,
+                    xi_io_replay_layer_push,
+                    xi_io_replay_layer_pull,
+                    xi_io_replay_layer_close,
+                    xi_io_replay_layer_close_externally,
+                    xi_io_replay_layer_init,
+                    xi_io_replay_layer_connect,
+                    xi_layer_default_post_connect )
+, XI_LAYER_TYPES_ADD( XI_LAYER_TYPE_ITEST_REPLAY_MQTT_CODEC,
+                      xi_mqtt_codec_layer_push,
+                      xi_mqtt_codec_layer_pull,
+                      xi_mqtt_codec_layer_close,
+                      xi_mqtt_codec_layer_close_externally,
+                      xi_mqtt_codec_layer_init,
+                      xi_mqtt_codec_layer_connect,
+                      xi_layer_default_post_connect ),
+    XI_LAYER_TYPES_ADD( XI_LAYER_TYPE_ITEST_REPLAY_MQTT_LOGIC,
+                        xi_mqtt_logic_layer_push,
+                        xi_mqtt_logic_layer_pull,
+                        xi_mqtt_logic_layer_close,
+                        xi_mqtt_logic_layer_close_externally,
+                        xi_mqtt_logic_layer_init,
+                        xi_mqtt_logic_layer_connect,
+                        xi_mqtt_logic_layer_post_connect ) XI_DECLARE_LAYER_TYPES_END()
+
+    XI_DECLARE_LAYER_CHAIN_SCHEME( XI_LAYER_CHAIN_ITEST_REPLAY,
+                                   XI_ITEST_REPLAY_LAYER_CHAIN );
+
+#define XI_ITEST_REPLAY_TOPIC "replay/topic"
+#define XI_ITEST_REPLAY_LAST_PUBLISH_MS 300
+#define XI_ITEST_REPLAY_MAX_STEPS 32
+#define XI_ITEST_REPLAY_MAX_PACED_MS 3000
+
+/* PUBLISH QoS0 on XI_ITEST_REPLAY_TOPIC with a two bytes long payload */
+#define XI_ITEST_REPLAY_PUBLISH( payload )                                              \
+    "\x30\x10\x00\x0c" XI_ITEST_REPLAY_TOPIC payload
+
+static xi_context_t* xi_itest_replay_context              = NULL;
+static xi_context_handle_t xi_itest_replay_context_handle = XI_INVALID_CONTEXT_HANDLE;
+static uint8_t xi_itest_replay_recording[256]             = {0};
+static size_t xi_itest_replay_recording_size              = 0;
+static size_t xi_itest_replay_messages                    = 0;
+
+static void xi_itest_replay_append( xi_io_net_capture_record_type_t type,
+                                    uint32_t timestamp_ms,
+                                    const char* data,
+                                    size_t length )
+{
+    uint8_t* record = xi_itest_replay_recording + xi_itest_replay_recording_size;
+
+    assert_true( xi_itest_replay_recording_size + XI_IO_NET_CAPTURE_RECORD_HEADER_SIZE +
+                     length <=
+                 sizeof( xi_itest_replay_recording ) );
+
+    record[0]  = ( uint8_t )type;
+    record[1]  = 0;
+    record[2]  = 1; /* the session */
+    record[3]  = ( uint8_t )( timestamp_ms >> 24 );
+    record[4]  = ( uint8_t )( timestamp_ms >> 16 );
+    record[5]  = ( uint8_t )( timestamp_ms >> 8 );
+    record[6]  = ( uint8_t )timestamp_ms;
+    record[7]  = 0;
+    record[8]  = 0;
+    record[9]  = 0;
+    record[10] = ( uint8_t )length;
+
+    memcpy( record + XI_IO_NET_CAPTURE_RECORD_HEADER_SIZE, data, length );
+
+    xi_itest_replay_recording_size += XI_IO_NET_CAPTURE_RECORD_HEADER_SIZE + length;
+}
+
+/* the connection callback is called by the control topic layer which is left out */
+static void xi_itest_replay_on_connected( xi_context_handle_t in_context_handle,
+                                          void* data,
+                                          xi_state_t state )
+{
+    XI_UNUSED( in_context_handle );
+    XI_UNUSED( data );
+    XI_UNUSED( state );
+}
+
+static void xi_itest_replay_on_message( xi_context_handle_t in_context_handle,
+                                        xi_sub_call_type_t call_type,
+                                        const xi_sub_call_params_t* const params,
+                                        xi_state_t state,
+                                        void* user_data )
+{
+    XI_UNUSED( in_context_handle );
+    XI_UNUSED( params );
+    XI_UNUSED( state );
+    XI_UNUSED( user_data );
+
+    if ( XI_SUB_CALL_MESSAGE == call_type )
+    {
+        ++xi_itest_replay_messages;
+    }
+}
+
+/* connects and subscribes once the replay waits for the SUBSCRIBE */
+static void xi_itest_replay_connect_and_subscribe()
+{
+    const uint8_t* awaited_write = NULL;
+    size_t awaited_write_length  = 0;
+    const xi_time_t started_ms   = xi_bsp_time_getcurrenttime_milliseconds();
+    xi_io_replay_stats_t stats;
+
+    xi_connect( xi_itest_replay_context_handle, "itest_replay_user",
+                "itest_replay_password", 10, 0, XI_SESSION_CLEAN,
+                &xi_itest_replay_on_connected );
+
+    /* bounded by the time rather than the steps since the paced replay polls */
+    while ( ( !xi_is_context_connected( xi_itest_replay_context_handle ) ||
+              -1 == xi_io_replay_layer_awaited_write( &awaited_write,
+                                                      &awaited_write_length ) ) &&
+            xi_bsp_time_getcurrenttime_milliseconds() - started_ms <
+                XI_ITEST_REPLAY_MAX_PACED_MS )
+    {
+        xi_evtd_step( xi_globals.evtd_instance, time( NULL ) );
+    }
+
+    assert_true( xi_is_context_connected( xi_itest_replay_context_handle ) );
+
+    /* stalled on the SUBSCRIBE, the second write of the session */
+    xi_io_replay_layer_get_stats( &stats );
+    assert_int_equal( 1, xi_io_replay_layer_awaited_write( &awaited_write,
+                                                           &awaited_write_length ) );
+    assert_int_equal( 0x82, awaited_write[0] );
+    assert_int_equal( 1, stats.records_delivered );
+
+    assert_int_equal( XI_STATE_OK,
+                      xi_subscribe( xi_itest_replay_context_handle, XI_ITEST_REPLAY_TOPIC,
+                                    XI_MQTT_QOS_AT_MOST_ONCE, &xi_itest_replay_on_message,
+                                    NULL ) );
+}
+
+int xi_itest_replay_setup( void** state )
+{
+    XI_UNUSED( state );
+
+    xi_memory_limiter_tearup();
+
+    xi_itest_replay_recording_size = 0;
+    xi_itest_replay_messages       = 0;
+
+    memcpy( xi_itest_replay_recording, XI_IO_NET_CAPTURE_MAGIC,
+            XI_IO_NET_CAPTURE_MAGIC_SIZE );
+    xi_itest_replay_recording[XI_IO_NET_CAPTURE_MAGIC_SIZE] = XI_IO_NET_CAPTURE_VERSION;
+    xi_itest_replay_recording_size = XI_IO_NET_CAPTURE_FILE_HEADER_SIZE;
+
+    xi_itest_replay_append( XI_IO_NET_CAPTURE_CONNECT, 0, "localhost:1883", 14 );
+    xi_itest_replay_append( XI_IO_NET_CAPTURE_OUT, 0, "\x10\x00", 2 );
+    xi_itest_replay_append( XI_IO_NET_CAPTURE_IN, 10, "\x20\x02\x00\x00", 4 );
+    xi_itest_replay_append( XI_IO_NET_CAPTURE_OUT, 20, "\x82\x00", 2 );
+    xi_itest_replay_append( XI_IO_NET_CAPTURE_IN, 30, "\x90\x03\x00\x01\x00", 5 );
+    xi_itest_replay_append( XI_IO_NET_CAPTURE_IN, 40,
+                            XI_ITEST_REPLAY_PUBLISH( "m1" )
+                                XI_ITEST_REPLAY_PUBLISH( "m2" ),
+                            36 );
+    xi_itest_replay_append( XI_IO_NET_CAPTURE_OUT, 50, "\xc0\x00", 2 );
+    xi_itest_replay_append( XI_IO_NET_CAPTURE_IN, 60, "\xd0\x00", 2 );
+    xi_itest_replay_append( XI_IO_NET_CAPTURE_IN, XI_ITEST_REPLAY_LAST_PUBLISH_MS,
+                            XI_ITEST_REPLAY_PUBLISH( "m3" ), 18 );
+    xi_itest_replay_append( XI_IO_NET_CAPTURE_OUT, 400, "\xe0\x00", 2 );
+    xi_itest_replay_append( XI_IO_NET_CAPTURE_CLOSE, 400, "", 0 );
+
+    assert_int_equal( XI_STATE_OK, xi_initialize( "xi_itest_replay_account_id",
+                                                  "xi_itest_replay_device_id" ) );
+
+    XI_CHECK_STATE( xi_create_context_with_custom_layers(
+        &xi_itest_replay_context, xi_itest_replay_layer_chain,
+        XI_LAYER_CHAIN_ITEST_REPLAY,
+        XI_LAYER_CHAIN_SCHEME_LENGTH( XI_LAYER_CHAIN_ITEST_REPLAY ) ) );
+
+    XI_CHECK_STATE( xi_find_handle_for_object( xi_globals.context_handles_vector,
+                                               xi_itest_replay_context,
+                                               &xi_itest_replay_context_handle ) );
+
+    return 0;
+
+err_handling:
+    fail();
+
+    return 1;
+}
+
+int xi_itest_replay_teardown( void** state )
+{
+    XI_UNUSED( state );
+
+    int steps = 0;
+
+    xi_shutdown_connection( xi_itest_replay_context_handle );
+
+    for ( ; steps < XI_ITEST_REPLAY_MAX_STEPS &&
+            xi_evtd_dispatcher_continue( xi_globals.evtd_instance );
+          ++steps )
+    {
+        xi_evtd_step( xi_globals.evtd_instance, time( NULL ) );
+    }
+
+    xi_delete_context_with_custom_layers(
+        &xi_itest_replay_context, xi_itest_replay_layer_chain,
+        XI_LAYER_CHAIN_SCHEME_LENGTH( XI_LAYER_CHAIN_ITEST_REPLAY ) );
+
+    xi_shutdown();
+
+    return !xi_memory_limiter_teardown();
+}
+
+void xi_itest_replay__full_speed__inbound_records_delivered_after_awaited_writes(
+    void** state )
+{
+    XI_UNUSED( state );
+
+    xi_io_replay_stats_t stats;
+    int steps = 0;
+
+    assert_int_equal( XI_STATE_OK,
+                      xi_io_replay_layer_set_recording(
+                          xi_itest_replay_recording, xi_itest_replay_recording_size, 0,
+                          XI_IO_REPLAY_FULL_SPEED ) );
+
+    xi_itest_replay_connect_and_subscribe();
+
+    do
+    {
+        xi_evtd_step( xi_globals.evtd_instance, time( NULL ) );
+        xi_io_replay_layer_get_stats( &stats );
+    } while ( ++steps < XI_ITEST_REPLAY_MAX_STEPS && !stats.finished );
+
+    assert_true( stats.finished );
+    assert_int_equal( 3, xi_itest_replay_messages );
+    assert_int_equal( 4, stats.records_delivered );
+    assert_int_equal( 1, stats.records_skipped );
+    assert_int_equal( 2, stats.writes );
+    assert_int_equal( 0, stats.writes_diverged );
+}
+
+void xi_itest_replay__recorded_pace__record_not_delivered_before_its_offset(
+    void** state )
+{
+    XI_UNUSED( state );
+
+    const xi_time_t started_ms = xi_bsp_time_getcurrenttime_milliseconds();
+    xi_time_t elapsed_ms       = 0;
+
+    assert_int_equal( XI_STATE_OK,
+                      xi_io_replay_layer_set_recording(
+                          xi_itest_replay_recording, xi_itest_replay_recording_size, 1,
+                          XI_IO_REPLAY_RECORDED_PACE ) );
+
+    xi_itest_replay_connect_and_subscribe();
+
+    do
+    {
+        xi_evtd_step( xi_globals.evtd_instance, time( NULL ) );
+        elapsed_ms = xi_bsp_time_getcurrenttime_milliseconds() - started_ms;
+    } while ( 3 > xi_itest_replay_messages && elapsed_ms < XI_ITEST_REPLAY_MAX_PACED_MS );
+
+    assert_int_equal( 3, xi_itest_replay_messages );
+    assert_true( XI_ITEST_REPLAY_LAST_PUBLISH_MS <= elapsed_ms );
+}
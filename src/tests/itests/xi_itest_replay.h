@@ -0,0 +1,33 @@
+/* Copyright (c) 2003-2018, Xively All rights reserved.
+ *
+ * This is part of the Xively C Client library,
+ * it is licensed under the BSD 3-Clause license.
+ */
+
+#ifndef __XI_ITEST_REPLAY_H__
+#define __XI_ITEST_REPLAY_H__
+
+#include "xi_itest_helpers.h"
+
+extern int xi_itest_replay_setup( void** state );
+extern int xi_itest_replay_teardown( void** state );
+
+extern void
+xi_itest_replay__full_speed__inbound_records_delivered_after_awaited_writes(
+    void** state );
+extern void
+xi_itest_replay__recorded_pace__record_not_delivered_before_its_offset( void** state );
+
+#ifdef XI_MOCK_TEST_PREPROCESSOR_RUN
+struct CMUnitTest xi_itests_replay[] = {
+    cmocka_unit_test_setup_teardown(
+        xi_itest_replay__full_speed__inbound_records_delivered_after_awaited_writes,
+        xi_itest_replay_setup,
+        xi_itest_replay_teardown ),
+    cmocka_unit_test_setup_teardown(
+        xi_itest_replay__recorded_pace__record_not_delivered_before_its_offset,
+        xi_itest_replay_setup,
+        xi_itest_replay_teardown )};
+#endif
+
+#endif /* __XI_ITEST_REPLAY_H__ */
@@ -673,6 +673,57 @@ void xi_itest_sft__checksum_mismatch__update_process_exits( void** fixture_void
     xi_itest_sft__act( fixture_void, 1, ( const char* [] ){"file1", "file2"}, 2, NULL );
 }
 
+/* Every hop between the client and the mock broker is delayed by one event loop
+ * iteration which is one simulated second. Downloading the 48 chunks of the three
+ * files one round-trip after the other takes more than 100 iterations, the window of
+ * outstanding FILE_GET_CHUNK requests has to bring it under the budget. */
+#define XI_ITEST_SFT__THROUGHPUT_LOOP_BUDGET 40
+
+void xi_itest_sft__chunk_window__three_files_downloaded_within_loop_budget(
+    void** fixture_void )
+{
+    xi_itest_sft__test_fixture_t* fixture = ( xi_itest_sft__test_fixture_t* )*fixture_void;
+
+    fixture->loop_id__manual_disconnect = XI_ITEST_SFT__THROUGHPUT_LOOP_BUDGET;
+
+    assert_int_equal( XI_STATE_OK,
+                      xi_set_sft_download_window( xi_context_handle,
+                                                  XI_SFT_FILE_CHUNK_WINDOW_MAX, 0 ) );
+
+    expect_value( xi_mock_broker_sft_logic_on_message, control_message->common.msgtype,
+                  XI_CONTROL_MESSAGE_CS__SFT_FILE_INFO );
+
+    const char* filenames[] = {"file1", "file2", "file3"};
+
+    uint16_t id_file = 0;
+    for ( ; id_file < 3; ++id_file )
+    {
+        const uint32_t size_multiplier = id_file + 1;
+
+        expect_value_count( xi_mock_broker_sft_logic_on_message,
+                            control_message->common.msgtype,
+                            XI_CONTROL_MESSAGE_CS__SFT_FILE_GET_CHUNK,
+                            XI_ITEST_SFT__NUMBER_OF_FILE_CHUNKS( size_multiplier ) );
+
+        expect_string_count( xi_mock_broker_sft_logic_on_file_get_chunk,
+                             control_message->file_get_chunk.name, filenames[id_file],
+                             XI_ITEST_SFT__NUMBER_OF_FILE_CHUNKS( size_multiplier ) );
+
+        expect_value_count( xi_mock_broker_sft_logic_on_message,
+                            control_message->common.msgtype,
+                            XI_CONTROL_MESSAGE_CS__SFT_FILE_STATUS, 2 );
+        expect_file_status_phase_and_code(
+            XI_CONTROL_MESSAGE__SFT_FILE_STATUS_PHASE_DOWNLOADED,
+            XI_CONTROL_MESSAGE__SFT_FILE_STATUS_CODE_SUCCESS );
+        expect_file_status_phase_and_code(
+            XI_CONTROL_MESSAGE__SFT_FILE_STATUS_PHASE_FINISHED,
+            XI_CONTROL_MESSAGE__SFT_FILE_STATUS_CODE_SUCCESS );
+    }
+
+    /* ACT */
+    xi_itest_sft__act( fixture_void, 1, filenames, 3, NULL );
+}
+
 /**************************************************
  * custom external URL download tests *************
  **************************************************/
@@ -25,6 +25,8 @@ xi_itest_sft__firmware_bin_received__firmware_test_commit_triggered( void** stat
 extern void
 xi_itest_sft__revision_non_volatile_storage__proper_value_stored( void** state );
 extern void xi_itest_sft__checksum_mismatch__update_process_exits( void** state );
+extern void
+xi_itest_sft__chunk_window__three_files_downloaded_within_loop_budget( void** state );
 
 extern void xi_itest_sft__custom_URL_download__single_file( void** fixture_void );
 extern void
@@ -76,6 +78,10 @@ struct CMUnitTest xi_itests_sft[] = {
         xi_itest_sft__checksum_mismatch__update_process_exits,
         xi_itest_sft_setup,
         xi_itest_sft_teardown ),
+    cmocka_unit_test_setup_teardown(
+        xi_itest_sft__chunk_window__three_files_downloaded_within_loop_budget,
+        xi_itest_sft_setup,
+        xi_itest_sft_teardown ),
     cmocka_unit_test_setup_teardown( xi_itest_sft__custom_URL_download__single_file,
                                      xi_itest_sft_setup,
                                      xi_itest_sft_teardown ),
@@ -0,0 +1,276 @@
+/* Copyright (c) 2003-2018, Xively All rights reserved.
+ *
+ * This is part of the Xively C Client library,
+ * it is licensed under the BSD 3-Clause license.
+ */
+
+#include <xi_itest_startup.h>
+#include "xi_itest_helpers.h"
+#include "xi_backoff_status_api.h"
+
+#include "xi_debug.h"
+#include "xi_globals.h"
+#include "xi_handle.h"
+
+#include "xi_memory_checks.h"
+#include "xi_itest_layerchain_ct_ml_mc.h"
+#include "xi_itest_mock_broker_layerchain.h"
+
+#include <stdio.h>
+
+/*
+ * Measures the startup: the number of event loop iterations from xi_connect to the
+ * first message delivered on a subscription. The subscriptions are requested while the
+ * client is still connecting, once all of them are granted a message is published which
+ * the mock broker sends back. Each hop between the client and the mock broker takes
+ * one iteration.
+ *
+ * The tasks are sent together after the CONNACK so the number of iterations does not
+ * grow with the number of subscribed topics.
+ */
+
+/* Depends on the xi_itest_tls_error.c */
+extern xi_context_t* xi_context;
+extern xi_context_handle_t xi_context_handle;
+extern xi_context_t* xi_context_mockbroker;
+/* end of dependency */
+
+#define XI_ITEST_STARTUP__MAX_LOOP_COUNT 64
+#define XI_ITEST_STARTUP__LOOP_BUDGET 8
+#define XI_ITEST_STARTUP__TOPIC_NAME_SIZE 32
+#define XI_ITEST_STARTUP__LOOPBACK_TOPIC_NAME "xi_itest_startup/topic/0"
+
+/*********************************************************************************
+ * test fixture ******************************************************************
+ ********************************************************************************/
+typedef struct xi_itest_startup__test_fixture_s
+{
+    const char* control_topic_name_client_in;
+    const char* control_topic_name_client_out;
+
+    uint16_t topics_count;
+    uint16_t subacks_count;
+    uint16_t loop_counter;
+
+    /* loop iteration of the first message delivered, 0 if none arrived */
+    uint16_t loop_id__first_message;
+
+} xi_itest_startup__test_fixture_t;
+
+static xi_itest_startup__test_fixture_t* _xi_itest_startup__generate_fixture()
+{
+    xi_state_t state = XI_STATE_OK;
+
+    XI_ALLOC( xi_itest_startup__test_fixture_t, fixture, state );
+
+    fixture->control_topic_name_client_in =
+        ( "xi/ctrl/v1/xi_itest_startup_device_id/cln" );
+    fixture->control_topic_name_client_out =
+        ( "xi/ctrl/v1/xi_itest_startup_device_id/svc" );
+
+    return fixture;
+
+err_handling:
+    fail();
+
+    return NULL;
+}
+
+/*********************************************************************************
+ * setup / teardown **************************************************************
+ ********************************************************************************/
+int xi_itest_startup_setup( void** fixture_void )
+{
+    /* clear the external dependencies */
+    xi_context            = NULL;
+    xi_context_handle     = XI_INVALID_CONTEXT_HANDLE;
+    xi_context_mockbroker = NULL;
+
+    xi_memory_limiter_tearup();
+
+    *fixture_void = _xi_itest_startup__generate_fixture();
+
+    xi_globals.backoff_status.backoff_lut_i = 0;
+    xi_cancel_backoff_event();
+
+    xi_initialize( "xi_itest_startup_account_id", "xi_itest_startup_device_id" );
+
+    XI_CHECK_STATE( xi_create_context_with_custom_layers(
+        &xi_context, itest_ct_ml_mc_layer_chain, XI_LAYER_CHAIN_CT_ML_MC,
+        XI_LAYER_CHAIN_SCHEME_LENGTH( XI_LAYER_CHAIN_CT_ML_MC ) ) );
+
+    xi_find_handle_for_object( xi_globals.context_handles_vector, xi_context,
+                               &xi_context_handle );
+
+    XI_CHECK_STATE( xi_create_context_with_custom_layers(
+        &xi_context_mockbroker, itest_mock_broker_codec_layer_chain,
+        XI_LAYER_CHAIN_MOCK_BROKER_CODEC,
+        XI_LAYER_CHAIN_SCHEME_LENGTH( XI_LAYER_CHAIN_MOCK_BROKER_CODEC ) ) );
+
+    return 0;
+
+err_handling:
+    fail();
+
+    return 1;
+}
+
+int xi_itest_startup_teardown( void** fixture_void )
+{
+    xi_delete_context_with_custom_layers(
+        &xi_context, itest_ct_ml_mc_layer_chain,
+        XI_LAYER_CHAIN_SCHEME_LENGTH( XI_LAYER_CHAIN_CT_ML_MC ) );
+
+    xi_delete_context_with_custom_layers(
+        &xi_context_mockbroker, itest_mock_broker_codec_layer_chain,
+        XI_LAYER_CHAIN_SCHEME_LENGTH( XI_LAYER_CHAIN_MOCK_BROKER_CODEC ) );
+
+    xi_shutdown();
+
+    xi_itest_startup__test_fixture_t* fixture =
+        ( xi_itest_startup__test_fixture_t* )*fixture_void;
+
+    XI_SAFE_FREE( fixture );
+
+    return !xi_memory_limiter_teardown();
+}
+
+static void
+_xi_itest_startup__on_connection_state_changed( xi_context_handle_t in_context_handle,
+                                                void* data,
+                                                xi_state_t state )
+{
+    XI_UNUSED( in_context_handle );
+    XI_UNUSED( data );
+    XI_UNUSED( state );
+}
+
+static void _xi_itest_startup__on_message( xi_context_handle_t in_context_handle,
+                                           xi_sub_call_type_t call_type,
+                                           const xi_sub_call_params_t* const params,
+                                           xi_state_t state,
+                                           void* user_data )
+{
+    XI_UNUSED( params );
+    XI_UNUSED( state );
+
+    xi_itest_startup__test_fixture_t* fixture =
+        ( xi_itest_startup__test_fixture_t* )user_data;
+
+    switch ( call_type )
+    {
+        case XI_SUB_CALL_SUBACK:
+            if ( ++fixture->subacks_count == fixture->topics_count )
+            {
+                xi_publish( in_context_handle, XI_ITEST_STARTUP__LOOPBACK_TOPIC_NAME,
+                            "first message", XI_MQTT_QOS_AT_MOST_ONCE,
+                            XI_MQTT_RETAIN_FALSE, NULL, NULL );
+            }
+            break;
+        case XI_SUB_CALL_MESSAGE:
+            if ( 0 == fixture->loop_id__first_message )
+            {
+                fixture->loop_id__first_message = fixture->loop_counter;
+            }
+            break;
+        default:;
+    }
+}
+
+/*********************************************************************************
+ * act ***************************************************************************
+ ********************************************************************************/
+static void xi_itest_startup__act( void** fixture_void, uint16_t topics_count )
+{
+    {
+        will_return_always( xi_mock_broker_layer__check_expected__LAYER_LEVEL,
+                            CONTROL_SKIP_CHECK_EXPECTED );
+
+        will_return_always( xi_mock_broker_layer__check_expected__MQTT_LEVEL,
+                            CONTROL_SKIP_CHECK_EXPECTED );
+
+        will_return_always( xi_mock_layer_tls_prev__check_expected__LAYER_LEVEL,
+                            CONTROL_SKIP_CHECK_EXPECTED );
+    }
+
+    xi_state_t state = XI_STATE_OK;
+    uint16_t id_topic = 0;
+    char topic_name[XI_ITEST_STARTUP__TOPIC_NAME_SIZE];
+
+    xi_itest_startup__test_fixture_t* const fixture =
+        ( xi_itest_startup__test_fixture_t* )*fixture_void;
+
+    XI_ALLOC( xi_mock_broker_data_t, broker_data, state );
+    broker_data->control_topic_name_broker_in  = fixture->control_topic_name_client_out;
+    broker_data->control_topic_name_broker_out = fixture->control_topic_name_client_in;
+    broker_data->loopback_topic_name           = XI_ITEST_STARTUP__LOOPBACK_TOPIC_NAME;
+
+    fixture->topics_count = topics_count;
+
+    XI_PROCESS_INIT_ON_THIS_LAYER(
+        &xi_context_mockbroker->layer_chain.top->layer_connection, broker_data,
+        XI_STATE_OK );
+
+    xi_evtd_step( xi_globals.evtd_instance, xi_bsp_time_getcurrenttime_seconds() );
+
+    xi_connect( xi_context_handle, "itest_username", "itest_password",
+                XI_ITEST_STARTUP__MAX_LOOP_COUNT, XI_ITEST_STARTUP__MAX_LOOP_COUNT,
+                XI_SESSION_CLEAN, &_xi_itest_startup__on_connection_state_changed );
+
+    while ( xi_evtd_dispatcher_continue( xi_globals.evtd_instance ) == 1 &&
+            fixture->loop_counter < XI_ITEST_STARTUP__MAX_LOOP_COUNT )
+    {
+        xi_evtd_step( xi_globals.evtd_instance,
+                      xi_bsp_time_getcurrenttime_seconds() + fixture->loop_counter );
+        ++fixture->loop_counter;
+
+        /* the layers are initialised but the CONNACK has not arrived yet */
+        if ( 1 == fixture->loop_counter )
+        {
+            for ( ; id_topic < topics_count; ++id_topic )
+            {
+                sprintf( topic_name, "xi_itest_startup/topic/%d", id_topic );
+
+                state = xi_subscribe( xi_context_handle, topic_name,
+                                      XI_MQTT_QOS_AT_LEAST_ONCE,
+                                      &_xi_itest_startup__on_message, fixture );
+                assert_int_equal( XI_STATE_OK, state );
+            }
+        }
+
+        if ( 0 != fixture->loop_id__first_message &&
+             fixture->loop_counter == fixture->loop_id__first_message + 1 )
+        {
+            xi_shutdown_connection( xi_context_handle );
+        }
+    }
+
+    printf( "[  STARTUP ] %2d topics: first message after %d loop iterations\n",
+            topics_count, fixture->loop_id__first_message );
+
+    assert_int_not_equal( 0, fixture->loop_id__first_message );
+    assert_in_range( fixture->loop_id__first_message, 1, XI_ITEST_STARTUP__LOOP_BUDGET );
+
+err_handling:;
+}
+
+/*********************************************************************************
+ * test cases ********************************************************************
+ ********************************************************************************/
+void xi_itest_startup__subscribe_1_topic__first_message_within_loop_budget(
+    void** fixture_void )
+{
+    xi_itest_startup__act( fixture_void, 1 );
+}
+
+void xi_itest_startup__subscribe_8_topics__first_message_within_loop_budget(
+    void** fixture_void )
+{
+    xi_itest_startup__act( fixture_void, 8 );
+}
+
+void xi_itest_startup__subscribe_16_topics__first_message_within_loop_budget(
+    void** fixture_void )
+{
+    xi_itest_startup__act( fixture_void, 16 );
+}
@@ -0,0 +1,36 @@
+/* Copyright (c) 2003-2018, Xively All rights reserved.
+ *
+ * This is part of the Xively C Client library,
+ * it is licensed under the BSD 3-Clause license.
+ */
+
+#ifndef __XI_ITEST_STARTUP_H__
+#define __XI_ITEST_STARTUP_H__
+
+extern int xi_itest_startup_setup( void** state );
+extern int xi_itest_startup_teardown( void** state );
+
+extern void
+xi_itest_startup__subscribe_1_topic__first_message_within_loop_budget( void** state );
+extern void
+xi_itest_startup__subscribe_8_topics__first_message_within_loop_budget( void** state );
+extern void
+xi_itest_startup__subscribe_16_topics__first_message_within_loop_budget( void** state );
+
+#ifdef XI_MOCK_TEST_PREPROCESSOR_RUN
+struct CMUnitTest xi_itests_startup[] = {
+    cmocka_unit_test_setup_teardown(
+        xi_itest_startup__subscribe_1_topic__first_message_within_loop_budget,
+        xi_itest_startup_setup,
+        xi_itest_startup_teardown ),
+    cmocka_unit_test_setup_teardown(
+        xi_itest_startup__subscribe_8_topics__first_message_within_loop_budget,
+        xi_itest_startup_setup,
+        xi_itest_startup_teardown ),
+    cmocka_unit_test_setup_teardown(
+        xi_itest_startup__subscribe_16_topics__first_message_within_loop_budget,
+        xi_itest_startup_setup,
+        xi_itest_startup_teardown )};
+#endif
+
+#endif /* __XI_ITEST_STARTUP_H__ */
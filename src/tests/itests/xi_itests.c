@@ -12,8 +12,10 @@
 #include "xi_itest_tls_layer.h"
 #endif
 #include "xi_itest_mqttlogic_layer.h"
+#include "xi_itest_replay.h"
 #ifdef XI_CONTROL_TOPIC_ENABLED
 #include "xi_itest_sft.h"
+#include "xi_itest_startup.h"
 #endif
 #undef XI_MOCK_TEST_PREPROCESSOR_RUN
 
@@ -27,9 +29,11 @@ struct CMGroupTest groups[] = {cmocka_test_group( xi_itests_clean_session ),
 #endif
                                cmocka_test_group( xi_itests_mqttlogic_layer ),
                                cmocka_test_group( xi_itests_connect_error ),
+                               cmocka_test_group( xi_itests_replay ),
 #ifdef XI_CONTROL_TOPIC_ENABLED
 #ifdef XI_SECURE_FILE_TRANSFER_ENABLED
                                cmocka_test_group( xi_itests_sft ),
+                               cmocka_test_group( xi_itests_startup ),
 #endif
 #endif
                                cmocka_test_group_end};
@@ -0,0 +1,934 @@
+/* Copyright (c) 2003-2018, Xively All rights reserved.
+ *
+ * This is part of the Xively C Client library,
+ * it is licensed under the BSD 3-Clause license.
+ */
+
+#include "xi_fleet_broker.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "xi_macros.h"
+#include "xi_mqtt_message.h"
+
+#ifdef XI_SECURE_FILE_TRANSFER_ENABLED
+#include "xi_bsp_fwu.h"
+#include "xi_cbor_codec_ct_server.h"
+#include "xi_control_message.h"
+#include "xi_control_message_sft_generators.h"
+#include "xi_helpers.h"
+#endif
+
+#define XI_FLEET_BROKER_READ_CHUNK 4096
+#define XI_FLEET_BROKER_CONTROL_TOPIC_PREFIX "xi/ctrl/"
+
+/* a connection of a device, index is -1 until its CONNECT has been seen */
+typedef struct xi_fleet_broker_connection_s
+{
+    int fd;
+    int64_t device_index;
+    uint16_t next_msg_id;
+    uint8_t* in;
+    size_t in_length;
+    size_t in_capacity;
+    uint8_t* out;
+    size_t out_length;
+    size_t out_capacity;
+} xi_fleet_broker_connection_t;
+
+struct xi_fleet_broker_s
+{
+    pthread_t thread;
+    int listen_fd;
+    int wake_pipe[2];
+    uint32_t devices_count;
+    xi_fleet_broker_device_stats_t* device_stats;
+    xi_fleet_broker_connection_t* connections;
+    size_t connections_count;
+    size_t connections_capacity;
+    uint32_t sft_file_size;
+    char sft_revision[32];
+    uint8_t* sft_fingerprint;
+    uint16_t sft_fingerprint_len;
+};
+
+double xi_fleet_now()
+{
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return ( double )ts.tv_sec + ( double )ts.tv_nsec / 1e9;
+}
+
+static int xi_fleet_broker_reserve( uint8_t** buffer, size_t* capacity, size_t required )
+{
+    if ( required <= *capacity )
+    {
+        return 1;
+    }
+
+    size_t new_capacity = XI_MAX( *capacity * 2, required );
+    uint8_t* new_buffer = realloc( *buffer, new_capacity );
+
+    if ( NULL == new_buffer )
+    {
+        return 0;
+    }
+
+    *buffer   = new_buffer;
+    *capacity = new_capacity;
+
+    return 1;
+}
+
+static int xi_fleet_broker_queue( xi_fleet_broker_connection_t* connection,
+                                  const uint8_t* data,
+                                  size_t length )
+{
+    if ( !xi_fleet_broker_reserve( &connection->out, &connection->out_capacity,
+                                   connection->out_length + length ) )
+    {
+        return 0;
+    }
+
+    memcpy( connection->out + connection->out_length, data, length );
+    connection->out_length += length;
+
+    return 1;
+}
+
+static int xi_fleet_broker_queue_publish( xi_fleet_broker_connection_t* connection,
+                                          const uint8_t* topic,
+                                          size_t topic_length,
+                                          const uint8_t* payload,
+                                          size_t payload_length,
+                                          uint8_t qos )
+{
+    uint8_t header[7];
+    size_t header_length        = 1;
+    size_t remaining_length     = 2 + topic_length + ( 0 < qos ? 2 : 0 ) + payload_length;
+    const size_t message_length = remaining_length;
+
+    header[0] = ( XI_MQTT_TYPE_PUBLISH << 4 ) | ( qos << 1 );
+
+    do
+    {
+        header[header_length] = remaining_length % 128;
+        remaining_length /= 128;
+        header[header_length++] |= ( 0 < remaining_length ) ? 0x80 : 0;
+    } while ( 0 < remaining_length );
+
+    header[header_length++] = ( uint8_t )( topic_length >> 8 );
+    header[header_length++] = ( uint8_t )topic_length;
+
+    if ( !xi_fleet_broker_reserve( &connection->out, &connection->out_capacity,
+                                   connection->out_length + header_length +
+                                       message_length ) ||
+         !xi_fleet_broker_queue( connection, header, header_length ) ||
+         !xi_fleet_broker_queue( connection, topic, topic_length ) )
+    {
+        return 0;
+    }
+
+    if ( 0 < qos )
+    {
+        connection->next_msg_id += 1;
+        connection->next_msg_id += ( 0 == connection->next_msg_id ) ? 1 : 0;
+
+        const uint8_t msg_id[] = {( uint8_t )( connection->next_msg_id >> 8 ),
+                                  ( uint8_t )connection->next_msg_id};
+
+        xi_fleet_broker_queue( connection, msg_id, sizeof( msg_id ) );
+    }
+
+    return xi_fleet_broker_queue( connection, payload, payload_length );
+}
+
+static xi_fleet_broker_device_stats_t*
+xi_fleet_broker_stats_of( xi_fleet_broker_t* broker,
+                          const xi_fleet_broker_connection_t* connection )
+{
+    if ( 0 > connection->device_index ||
+         broker->devices_count <= ( uint64_t )connection->device_index )
+    {
+        return NULL;
+    }
+
+    return &broker->device_stats[connection->device_index];
+}
+
+#ifdef XI_SECURE_FILE_TRANSFER_ENABLED
+
+static xi_control_message_t*
+xi_fleet_broker_make_file_update_available( xi_fleet_broker_t* broker,
+                                            const xi_control_message_t* file_info )
+{
+    xi_state_t state = XI_STATE_OK;
+    uint16_t id_file = 0;
+    uint16_t offered = 0;
+
+    XI_ALLOC( xi_control_message_t, reply, state );
+
+    reply->common.msgtype = XI_CONTROL_MESSAGE_SC__SFT_FILE_UPDATE_AVAILABLE;
+    reply->common.msgver  = 1;
+
+    if ( 0 < file_info->file_info.list_len )
+    {
+        XI_ALLOC_BUFFER_AT( xi_control_message_file_desc_ext_t,
+                            reply->file_update_available.list,
+                            sizeof( xi_control_message_file_desc_ext_t ) *
+                                file_info->file_info.list_len,
+                            state );
+    }
+
+    for ( ; id_file < file_info->file_info.list_len; ++id_file )
+    {
+        const xi_control_message_file_desc_t* file = &file_info->file_info.list[id_file];
+
+        /* the device is up to date with this one */
+        if ( NULL != file->revision &&
+             0 == strcmp( file->revision, broker->sft_revision ) )
+        {
+            continue;
+        }
+
+        xi_control_message_file_desc_ext_t* offer =
+            &reply->file_update_available.list[offered++];
+
+        reply->file_update_available.list_len = offered;
+
+        offer->name     = xi_str_dup( file->name );
+        offer->revision = xi_str_dup( broker->sft_revision );
+        XI_CHECK_MEMORY( offer->name, state );
+        XI_CHECK_MEMORY( offer->revision, state );
+
+        offer->size_in_bytes                     = broker->sft_file_size;
+        offer->fingerprint_len                   = broker->sft_fingerprint_len;
+        offer->flag_mqtt_download_also_supported = 1;
+
+        XI_ALLOC_BUFFER_AT( uint8_t, offer->fingerprint, broker->sft_fingerprint_len,
+                            state );
+        memcpy( offer->fingerprint, broker->sft_fingerprint,
+                broker->sft_fingerprint_len );
+    }
+
+    return reply;
+
+err_handling:
+    xi_control_message_free( &reply );
+
+    return NULL;
+}
+
+/* answers a request made on the control topic, the reply goes to the channel the
+ * device is subscribed to */
+static int xi_fleet_broker_on_control_message( xi_fleet_broker_t* broker,
+                                               xi_fleet_broker_connection_t* connection,
+                                               const uint8_t* topic,
+                                               size_t topic_length,
+                                               const uint8_t* payload,
+                                               size_t payload_length )
+{
+    xi_fleet_broker_device_stats_t* stats =
+        xi_fleet_broker_stats_of( broker, connection );
+    xi_control_message_t* reply = NULL;
+    uint8_t* encoded            = NULL;
+    uint32_t encoded_length     = 0;
+    char reply_topic[256]       = {0};
+    int ret                     = 1;
+
+    if ( 0 == broker->sft_file_size || topic_length < 4 ||
+         sizeof( reply_topic ) <= topic_length ||
+         0 != memcmp( topic + topic_length - 4, "/svc", 4 ) )
+    {
+        return 1;
+    }
+
+    memcpy( reply_topic, topic, topic_length - 3 );
+    strcat( reply_topic, "cln" );
+
+    xi_control_message_t* request =
+        xi_cbor_codec_ct_server_decode( payload, ( uint32_t )payload_length );
+
+    if ( NULL == request )
+    {
+        return 1;
+    }
+
+    switch ( request->common.msgtype )
+    {
+        case XI_CONTROL_MESSAGE_CS__SFT_FILE_INFO:
+            reply = xi_fleet_broker_make_file_update_available( broker, request );
+
+            if ( NULL != stats && NULL != reply &&
+                 0 < reply->file_update_available.list_len && 0 == stats->sft_started_at )
+            {
+                stats->sft_started_at = xi_fleet_now();
+            }
+            break;
+        case XI_CONTROL_MESSAGE_CS__SFT_FILE_GET_CHUNK:
+            if ( request->file_get_chunk.offset + request->file_get_chunk.length >
+                 broker->sft_file_size )
+            {
+                request->file_get_chunk.length =
+                    ( broker->sft_file_size > request->file_get_chunk.offset )
+                        ? broker->sft_file_size - request->file_get_chunk.offset
+                        : 0;
+            }
+
+            reply = xi_control_message_sft_generate_reply_FILE_CHUNK( request );
+
+            if ( NULL != stats && NULL != reply )
+            {
+                stats->sft_chunks_sent += 1;
+                stats->sft_bytes_sent += reply->file_chunk.length;
+            }
+            break;
+        case XI_CONTROL_MESSAGE_CS__SFT_FILE_STATUS:
+            if ( NULL != stats && ( XI_CONTROL_MESSAGE__SFT_FILE_STATUS_PHASE_FINISHED ==
+                                        request->file_status.phase ||
+                                    0 > request->file_status.code ) )
+            {
+                stats->sft_finished_at = xi_fleet_now();
+                stats->sft_status_code = request->file_status.code;
+            }
+            break;
+        default:
+            break;
+    }
+
+    if ( NULL != reply )
+    {
+        xi_cbor_codec_ct_server_encode( reply, &encoded, &encoded_length );
+
+        ret = xi_fleet_broker_queue_publish(
+            connection, ( const uint8_t* )reply_topic, strlen( reply_topic ), encoded,
+            encoded_length, XI_MQTT_QOS_AT_MOST_ONCE );
+    }
+
+    XI_SAFE_FREE( encoded );
+    xi_control_message_free( &reply );
+    xi_control_message_free( &request );
+
+    return ret;
+}
+
+static int xi_fleet_broker_sft_init( xi_fleet_broker_t* broker )
+{
+    void* checksum_context = NULL;
+    uint8_t* checksum      = NULL;
+    uint8_t* file_content  = NULL;
+    xi_state_t state       = XI_STATE_OK;
+
+    if ( 0 == broker->sft_file_size )
+    {
+        return 1;
+    }
+
+    /* a new revision on every start so that no device skips the download */
+    snprintf( broker->sft_revision, sizeof( broker->sft_revision ), "fleet-%ld",
+              ( long )time( NULL ) );
+
+    file_content = xi_control_message_sft_get_reproducible_randomlike_bytes(
+        0, broker->sft_file_size );
+    XI_CHECK_MEMORY( file_content, state );
+
+    xi_bsp_fwu_checksum_init( &checksum_context );
+    xi_bsp_fwu_checksum_update( checksum_context, file_content, broker->sft_file_size );
+    xi_bsp_fwu_checksum_final( &checksum_context, &checksum,
+                               &broker->sft_fingerprint_len );
+
+    XI_ALLOC_BUFFER_AT( uint8_t, broker->sft_fingerprint, broker->sft_fingerprint_len,
+                        state );
+    memcpy( broker->sft_fingerprint, checksum, broker->sft_fingerprint_len );
+
+err_handling:
+    XI_SAFE_FREE( file_content );
+
+    return XI_STATE_OK == state;
+}
+
+#endif /* XI_SECURE_FILE_TRANSFER_ENABLED */
+
+/* moves the offset past a length prefixed field of a CONNECT payload */
+static const uint8_t* xi_fleet_broker_next_field( const uint8_t* body,
+                                                  size_t length,
+                                                  size_t* offset,
+                                                  size_t* field_length )
+{
+    if ( length < *offset + 2 )
+    {
+        return NULL;
+    }
+
+    *field_length = ( ( size_t )body[*offset] << 8 ) | body[*offset + 1];
+
+    if ( length < *offset + 2 + *field_length )
+    {
+        return NULL;
+    }
+
+    *offset += 2 + *field_length;
+
+    return body + *offset - *field_length;
+}
+
+static int xi_fleet_broker_on_connect( xi_fleet_broker_t* broker,
+                                       xi_fleet_broker_connection_t* connection,
+                                       const uint8_t* body,
+                                       size_t length )
+{
+    const uint8_t connack[] = {XI_MQTT_TYPE_CONNACK << 4, 2, 0, 0};
+    const size_t prefix_length = strlen( XI_FLEET_BROKER_USERNAME_PREFIX );
+    const uint8_t* username    = NULL;
+    size_t username_length     = 0;
+    size_t offset              = 0;
+    uint8_t flags              = 0;
+
+    /* the protocol name is followed by the level, the flags and the keepalive */
+    if ( NULL == xi_fleet_broker_next_field( body, length, &offset, &username_length ) ||
+         length < offset + 4 )
+    {
+        return 0;
+    }
+
+    flags = body[offset + 1];
+    offset += 4;
+
+    /* the client id and the will come before the username */
+    if ( NULL == xi_fleet_broker_next_field( body, length, &offset, &username_length ) ||
+         ( ( flags & 0x04 ) &&
+           ( NULL == xi_fleet_broker_next_field( body, length, &offset,
+                                                 &username_length ) ||
+             NULL == xi_fleet_broker_next_field( body, length, &offset,
+                                                 &username_length ) ) ) )
+    {
+        return 0;
+    }
+
+    if ( flags & 0x80 )
+    {
+        username = xi_fleet_broker_next_field( body, length, &offset, &username_length );
+    }
+
+    if ( NULL != username && prefix_length < username_length &&
+         0 == memcmp( username, XI_FLEET_BROKER_USERNAME_PREFIX, prefix_length ) )
+    {
+        size_t i                 = prefix_length;
+        connection->device_index = 0;
+
+        for ( ; i < username_length && '0' <= username[i] && '9' >= username[i]; ++i )
+        {
+            connection->device_index =
+                connection->device_index * 10 + ( username[i] - '0' );
+        }
+    }
+
+    xi_fleet_broker_device_stats_t* stats =
+        xi_fleet_broker_stats_of( broker, connection );
+
+    if ( NULL != stats )
+    {
+        stats->connects += 1;
+    }
+
+    return xi_fleet_broker_queue( connection, connack, sizeof( connack ) );
+}
+
+static int xi_fleet_broker_on_publish( xi_fleet_broker_t* broker,
+                                       xi_fleet_broker_connection_t* connection,
+                                       uint8_t flags,
+                                       const uint8_t* body,
+                                       size_t length )
+{
+    const uint8_t qos = ( flags >> 1 ) & 0x03;
+
+    if ( length < 2 )
+    {
+        return 0;
+    }
+
+    const size_t topic_length = ( ( size_t )body[0] << 8 ) | body[1];
+    const size_t header_size  = 2 + topic_length + ( 0 < qos ? 2 : 0 );
+
+    if ( length < header_size )
+    {
+        return 0;
+    }
+
+    const uint8_t* topic        = body + 2;
+    const uint8_t* payload      = body + header_size;
+    const size_t payload_length = length - header_size;
+
+    if ( 0 < qos )
+    {
+        const uint8_t puback[] = {XI_MQTT_TYPE_PUBACK << 4, 2, body[2 + topic_length],
+                                  body[3 + topic_length]};
+
+        if ( !xi_fleet_broker_queue( connection, puback, sizeof( puback ) ) )
+        {
+            return 0;
+        }
+    }
+
+    if ( topic_length == strlen( XI_FLEET_BROKER_ECHO_TOPIC ) &&
+         0 == memcmp( topic, XI_FLEET_BROKER_ECHO_TOPIC, topic_length ) )
+    {
+        return xi_fleet_broker_queue_publish( connection, topic, topic_length, payload,
+                                              payload_length, qos );
+    }
+
+#ifdef XI_SECURE_FILE_TRANSFER_ENABLED
+    if ( topic_length > strlen( XI_FLEET_BROKER_CONTROL_TOPIC_PREFIX ) &&
+         0 == memcmp( topic, XI_FLEET_BROKER_CONTROL_TOPIC_PREFIX,
+                      strlen( XI_FLEET_BROKER_CONTROL_TOPIC_PREFIX ) ) )
+    {
+        return xi_fleet_broker_on_control_message( broker, connection, topic,
+                                                   topic_length, payload,
+                                                   payload_length );
+    }
+#else
+    XI_UNUSED( broker );
+#endif
+
+    return 1;
+}
+
+static int xi_fleet_broker_on_subscribe( xi_fleet_broker_connection_t* connection,
+                                         const uint8_t* body,
+                                         size_t length )
+{
+    uint8_t suback[64] = {XI_MQTT_TYPE_SUBACK << 4, 2};
+    size_t offset      = 2;
+
+    if ( length < 2 )
+    {
+        return 0;
+    }
+
+    suback[2] = body[0];
+    suback[3] = body[1];
+
+    /* every requested QoS is granted */
+    while ( offset + 2 < length && ( size_t )suback[1] + 2 < sizeof( suback ) )
+    {
+        offset += 2 + ( ( ( size_t )body[offset] << 8 ) | body[offset + 1] );
+
+        if ( length <= offset )
+        {
+            return 0;
+        }
+
+        suback[2 + suback[1]] = body[offset] & 0x03;
+        suback[1] += 1;
+        offset += 1;
+    }
+
+    return xi_fleet_broker_queue( connection, suback, 2 + suback[1] );
+}
+
+/* handles one complete message, returns 0 if the connection is to be closed */
+static int xi_fleet_broker_on_message( xi_fleet_broker_t* broker,
+                                       xi_fleet_broker_connection_t* connection,
+                                       uint8_t fixed_header,
+                                       const uint8_t* body,
+                                       size_t length )
+{
+    switch ( fixed_header >> 4 )
+    {
+        case XI_MQTT_TYPE_CONNECT:
+            return xi_fleet_broker_on_connect( broker, connection, body, length );
+        case XI_MQTT_TYPE_PUBLISH:
+            return xi_fleet_broker_on_publish( broker, connection, fixed_header & 0x0F,
+                                               body, length );
+        case XI_MQTT_TYPE_SUBSCRIBE:
+            return xi_fleet_broker_on_subscribe( connection, body, length );
+        case XI_MQTT_TYPE_UNSUBSCRIBE:
+        {
+            const uint8_t unsuback[] = {XI_MQTT_TYPE_UNSUBACK << 4, 2,
+                                        2 <= length ? body[0] : 0,
+                                        2 <= length ? body[1] : 0};
+            return xi_fleet_broker_queue( connection, unsuback, sizeof( unsuback ) );
+        }
+        case XI_MQTT_TYPE_PINGREQ:
+        {
+            const uint8_t pingresp[] = {XI_MQTT_TYPE_PINGRESP << 4, 0};
+            return xi_fleet_broker_queue( connection, pingresp, sizeof( pingresp ) );
+        }
+        case XI_MQTT_TYPE_DISCONNECT:
+            return 0;
+        default:
+            return 1;
+    }
+}
+
+/* consumes the complete messages buffered so far */
+static int xi_fleet_broker_process_input( xi_fleet_broker_t* broker,
+                                          xi_fleet_broker_connection_t* connection )
+{
+    size_t consumed = 0;
+    int ret         = 1;
+
+    while ( ret )
+    {
+        size_t offset     = consumed + 1;
+        size_t length     = 0;
+        size_t multiplier = 1;
+        uint8_t complete  = 0;
+
+        /* the remaining length takes at most four bytes */
+        while ( !complete && offset < connection->in_length && offset - consumed <= 4 )
+        {
+            const uint8_t length_byte = connection->in[offset++];
+
+            length += ( length_byte & 0x7F ) * multiplier;
+            multiplier *= 128;
+            complete = ( 0 == ( length_byte & 0x80 ) );
+        }
+
+        if ( !complete || connection->in_length - offset < length )
+        {
+            break;
+        }
+
+        ret = xi_fleet_broker_on_message( broker, connection, connection->in[consumed],
+                                          connection->in + offset, length );
+
+        consumed = offset + length;
+    }
+
+    memmove( connection->in, connection->in + consumed,
+             connection->in_length - consumed );
+    connection->in_length -= consumed;
+
+    return ret;
+}
+
+static int xi_fleet_broker_flush( xi_fleet_broker_connection_t* connection )
+{
+    size_t written = 0;
+
+    while ( written < connection->out_length )
+    {
+        const ssize_t sent = send( connection->fd, connection->out + written,
+                                   connection->out_length - written, MSG_NOSIGNAL );
+
+        if ( 0 > sent )
+        {
+            if ( EAGAIN == errno || EWOULDBLOCK == errno )
+            {
+                break;
+            }
+
+            return 0;
+        }
+
+        written += ( size_t )sent;
+    }
+
+    memmove( connection->out, connection->out + written,
+             connection->out_length - written );
+    connection->out_length -= written;
+
+    return 1;
+}
+
+static int xi_fleet_broker_read( xi_fleet_broker_t* broker,
+                                 xi_fleet_broker_connection_t* connection )
+{
+    for ( ;; )
+    {
+        if ( !xi_fleet_broker_reserve( &connection->in, &connection->in_capacity,
+                                       connection->in_length +
+                                           XI_FLEET_BROKER_READ_CHUNK ) )
+        {
+            return 0;
+        }
+
+        const ssize_t received =
+            recv( connection->fd, connection->in + connection->in_length,
+                  connection->in_capacity - connection->in_length, 0 );
+
+        if ( 0 == received )
+        {
+            return 0;
+        }
+        else if ( 0 > received )
+        {
+            return EAGAIN == errno || EWOULDBLOCK == errno;
+        }
+
+        connection->in_length += ( size_t )received;
+
+        if ( !xi_fleet_broker_process_input( broker, connection ) )
+        {
+            return 0;
+        }
+    }
+}
+
+static void xi_fleet_broker_close( xi_fleet_broker_t* broker, size_t id_connection )
+{
+    xi_fleet_broker_connection_t* connection = &broker->connections[id_connection];
+
+    close( connection->fd );
+    free( connection->in );
+    free( connection->out );
+
+    *connection = broker->connections[--broker->connections_count];
+}
+
+static void xi_fleet_broker_accept( xi_fleet_broker_t* broker )
+{
+    for ( ;; )
+    {
+        const int fd = accept( broker->listen_fd, NULL, NULL );
+
+        if ( 0 > fd )
+        {
+            return;
+        }
+
+        if ( broker->connections_count == broker->connections_capacity )
+        {
+            const size_t new_capacity = XI_MAX( 64, broker->connections_capacity * 2 );
+            xi_fleet_broker_connection_t* new_connections = realloc(
+                broker->connections, new_capacity * sizeof( *broker->connections ) );
+
+            if ( NULL == new_connections )
+            {
+                close( fd );
+                return;
+            }
+
+            broker->connections          = new_connections;
+            broker->connections_capacity = new_capacity;
+        }
+
+        const int nodelay = 1;
+        setsockopt( fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof( nodelay ) );
+        fcntl( fd, F_SETFL, fcntl( fd, F_GETFL ) | O_NONBLOCK );
+
+        xi_fleet_broker_connection_t* connection =
+            &broker->connections[broker->connections_count++];
+
+        memset( connection, 0, sizeof( *connection ) );
+        connection->fd           = fd;
+        connection->device_index = -1;
+    }
+}
+
+static void* xi_fleet_broker_thread( void* arg )
+{
+    xi_fleet_broker_t* broker = ( xi_fleet_broker_t* )arg;
+    struct pollfd* fds        = NULL;
+    size_t fds_capacity       = 0;
+
+    for ( ;; )
+    {
+        const size_t fds_count = 2 + broker->connections_count;
+        size_t i               = 0;
+
+        if ( fds_capacity < fds_count )
+        {
+            struct pollfd* new_fds = realloc( fds, fds_count * 2 * sizeof( *fds ) );
+
+            if ( NULL == new_fds )
+            {
+                break;
+            }
+
+            fds          = new_fds;
+            fds_capacity = fds_count * 2;
+        }
+
+        fds[0] = ( struct pollfd ){.fd = broker->wake_pipe[0], .events = POLLIN};
+        fds[1] = ( struct pollfd ){.fd = broker->listen_fd, .events = POLLIN};
+
+        for ( i = 0; i < broker->connections_count; ++i )
+        {
+            const short events =
+                POLLIN | ( 0 < broker->connections[i].out_length ? POLLOUT : 0 );
+
+            fds[2 + i] = ( struct pollfd ){.fd     = broker->connections[i].fd,
+                                           .events = events};
+        }
+
+        if ( 0 > poll( fds, fds_count, -1 ) && EINTR != errno )
+        {
+            break;
+        }
+
+        if ( fds[0].revents )
+        {
+            break;
+        }
+
+        /* backwards since a closed connection is replaced with the last one */
+        for ( i = fds_count - 2; 0 < i; --i )
+        {
+            xi_fleet_broker_connection_t* connection = &broker->connections[i - 1];
+            const short revents                      = fds[i + 1].revents;
+
+            if ( 0 == revents )
+            {
+                continue;
+            }
+
+            if ( ( revents & ( POLLERR | POLLNVAL ) ) ||
+                 ( ( revents & ( POLLIN | POLLHUP ) ) &&
+                   !xi_fleet_broker_read( broker, connection ) ) ||
+                 !xi_fleet_broker_flush( connection ) )
+            {
+                xi_fleet_broker_close( broker, i - 1 );
+            }
+        }
+
+        if ( fds[1].revents & POLLIN )
+        {
+            xi_fleet_broker_accept( broker );
+        }
+    }
+
+    free( fds );
+
+    while ( 0 < broker->connections_count )
+    {
+        xi_fleet_broker_close( broker, broker->connections_count - 1 );
+    }
+
+    return NULL;
+}
+
+xi_fleet_broker_t* xi_fleet_broker_start( uint32_t devices_count,
+                                          uint32_t sft_file_size,
+                                          uint16_t* port )
+{
+    struct sockaddr_in address;
+    socklen_t address_length  = sizeof( address );
+    xi_fleet_broker_t* broker = calloc( 1, sizeof( xi_fleet_broker_t ) );
+
+    if ( NULL == broker )
+    {
+        return NULL;
+    }
+
+    broker->listen_fd     = -1;
+    broker->wake_pipe[0]  = -1;
+    broker->wake_pipe[1]  = -1;
+    broker->devices_count = devices_count;
+    broker->sft_file_size = sft_file_size;
+    broker->device_stats  = calloc( devices_count, sizeof( *broker->device_stats ) );
+
+    memset( &address, 0, sizeof( address ) );
+    address.sin_family      = AF_INET;
+    address.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+
+#ifdef XI_SECURE_FILE_TRANSFER_ENABLED
+    if ( !xi_fleet_broker_sft_init( broker ) )
+    {
+        goto err_handling;
+    }
+#else
+    broker->sft_file_size = 0;
+#endif
+
+    if ( NULL == broker->device_stats || 0 != pipe( broker->wake_pipe ) ||
+         0 > ( broker->listen_fd = socket( AF_INET, SOCK_STREAM, 0 ) ) ||
+         0 != bind( broker->listen_fd, ( struct sockaddr* )&address,
+                    sizeof( address ) ) ||
+         0 != listen( broker->listen_fd, SOMAXCONN ) ||
+         0 != getsockname( broker->listen_fd, ( struct sockaddr* )&address,
+                           &address_length ) )
+    {
+        goto err_handling;
+    }
+
+    fcntl( broker->listen_fd, F_SETFL, fcntl( broker->listen_fd, F_GETFL ) | O_NONBLOCK );
+
+    if ( 0 != pthread_create( &broker->thread, NULL, xi_fleet_broker_thread, broker ) )
+    {
+        goto err_handling;
+    }
+
+    *port = ntohs( address.sin_port );
+
+    return broker;
+
+err_handling:
+    xi_fleet_broker_destroy( &broker );
+
+    return NULL;
+}
+
+void xi_fleet_broker_stop( xi_fleet_broker_t* broker )
+{
+    const uint8_t wake = 0;
+
+    if ( NULL == broker || 0 > broker->wake_pipe[1] )
+    {
+        return;
+    }
+
+    if ( 1 == write( broker->wake_pipe[1], &wake, 1 ) )
+    {
+        pthread_join( broker->thread, NULL );
+    }
+
+    close( broker->wake_pipe[1] );
+    broker->wake_pipe[1] = -1;
+}
+
+const xi_fleet_broker_device_stats_t*
+xi_fleet_broker_device_stats( const xi_fleet_broker_t* broker, uint32_t device_index )
+{
+    return ( device_index < broker->devices_count ) ? &broker->device_stats[device_index]
+                                                    : NULL;
+}
+
+void xi_fleet_broker_destroy( xi_fleet_broker_t** broker )
+{
+    if ( NULL == broker || NULL == *broker )
+    {
+        return;
+    }
+
+    xi_fleet_broker_t* const b = *broker;
+
+    if ( 0 <= b->listen_fd )
+    {
+        close( b->listen_fd );
+    }
+
+    if ( 0 <= b->wake_pipe[0] )
+    {
+        close( b->wake_pipe[0] );
+    }
+
+    if ( 0 <= b->wake_pipe[1] )
+    {
+        close( b->wake_pipe[1] );
+    }
+
+#ifdef XI_SECURE_FILE_TRANSFER_ENABLED
+    XI_SAFE_FREE( b->sft_fingerprint );
+#endif
+
+    free( b->connections );
+    free( b->device_stats );
+    free( b );
+
+    *broker = NULL;
+}
@@ -0,0 +1,74 @@
+/* Copyright (c) 2003-2018, Xively All rights reserved.
+ *
+ * This is part of the Xively C Client library,
+ * it is licensed under the BSD 3-Clause license.
+ */
+
+#ifndef __XI_FLEET_BROKER_H__
+#define __XI_FLEET_BROKER_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * A broker stand-in for the fleet simulator. It runs on its own thread, serves any
+ * number of loopback connections from a single poll loop and implements just enough
+ * of MQTT for the simulated devices:
+ *  - CONNECT, SUBSCRIBE, UNSUBSCRIBE and PINGREQ are acknowledged,
+ *  - publications on XI_FLEET_BROKER_ECHO_TOPIC are sent back to their sender,
+ *  - when SFT is compiled in, the control topic requests are answered with an update
+ *    of every file the device reports, served chunk by chunk over MQTT.
+ *
+ * The devices are told apart by their MQTT username, which has to be
+ * XI_FLEET_BROKER_USERNAME_PREFIX followed by the device index.
+ */
+
+#define XI_FLEET_BROKER_ECHO_TOPIC "fleet/echo"
+#define XI_FLEET_BROKER_USERNAME_PREFIX "fleet-"
+
+typedef struct xi_fleet_broker_s xi_fleet_broker_t;
+
+typedef struct xi_fleet_broker_device_stats_s
+{
+    uint32_t connects;
+    uint32_t sft_chunks_sent;
+    uint64_t sft_bytes_sent;
+    double sft_started_at;  /* the first update offered, 0 if there was none */
+    double sft_finished_at; /* the final status received, 0 if there was none */
+    int8_t sft_status_code; /* as reported in the final status */
+} xi_fleet_broker_device_stats_t;
+
+/**
+ * @brief xi_fleet_broker_start starts listening on an ephemeral loopback port
+ *
+ * @param devices_count number of the devices the statistics are kept for
+ * @param sft_file_size size of the files offered to the devices, 0 disables SFT
+ * @param [out] port the port the broker listens on
+ * @return NULL on failure
+ */
+xi_fleet_broker_t* xi_fleet_broker_start( uint32_t devices_count,
+                                          uint32_t sft_file_size,
+                                          uint16_t* port );
+
+/**
+ * @brief xi_fleet_broker_stop closes every connection and joins the broker thread,
+ * the statistics stay readable until xi_fleet_broker_destroy
+ */
+void xi_fleet_broker_stop( xi_fleet_broker_t* broker );
+
+const xi_fleet_broker_device_stats_t*
+xi_fleet_broker_device_stats( const xi_fleet_broker_t* broker, uint32_t device_index );
+
+void xi_fleet_broker_destroy( xi_fleet_broker_t** broker );
+
+/* CLOCK_MONOTONIC in seconds, the time base of all of the timestamps */
+double xi_fleet_now();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __XI_FLEET_BROKER_H__ */
@@ -0,0 +1,980 @@
+/* Copyright (c) 2003-2018, Xively All rights reserved.
+ *
+ * This is part of the Xively C Client library,
+ * it is licensed under the BSD 3-Clause license.
+ */
+
+/*
+ * Fleet simulator, a load generator which runs many Xively contexts in one process
+ * against the broker stand-in of xi_fleet_broker.c. It is meant for finding the
+ * scaling limits of the library, so the contexts are driven through the external
+ * event loop API (xi_events_get_fds, poll, xi_notify_fd_ready) which has no limit on
+ * the number of sockets.
+ *
+ * Every device connects with its own username, subscribes to the echo topic and
+ * publishes to it at the configured rate with payloads drawn from the configured
+ * size mix. The broker sends each publication back, so every message measures the
+ * round trip through the whole layer chain. Optionally all of the devices are
+ * disconnected and reconnected periodically and every device downloads a file over
+ * SFT.
+ *
+ * The number of the contexts is capped by XI_MAX_NUM_CONTEXTS, `make fleet_simulator`
+ * builds the library with XI_FLEET_SIMULATOR_MAX_CONTEXTS instead of the default.
+ */
+
+#include <errno.h>
+#include <malloc.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <xively.h>
+
+#include "xi_err.h"
+#include "xi_fleet_broker.h"
+#include "xi_macros.h"
+
+#define XI_FLEET_TICK_MS 10
+#define XI_FLEET_RAMP_UP_TIMEOUT_SEC 120
+#define XI_FLEET_DRAIN_SEC 2
+#define XI_FLEET_SHUTDOWN_TIMEOUT_SEC 30
+#define XI_FLEET_CONNECTION_TIMEOUT_SEC 30
+#define XI_FLEET_MAX_PAYLOAD_SIZES 8
+#define XI_FLEET_PAYLOAD_HEADER_SIZE ( sizeof( double ) + sizeof( uint32_t ) )
+
+typedef struct xi_fleet_options_s
+{
+    uint32_t devices_count;
+    double duration_sec;
+    double publish_rate;
+    xi_mqtt_qos_t qos;
+    uint16_t keepalive_sec;
+    double storm_period_sec;
+    uint32_t sft_file_size;
+    uint8_t per_device_report;
+    size_t payload_sizes[XI_FLEET_MAX_PAYLOAD_SIZES];
+    uint32_t payload_weights[XI_FLEET_MAX_PAYLOAD_SIZES];
+    size_t payload_sizes_count;
+} xi_fleet_options_t;
+
+typedef struct xi_fleet_device_s
+{
+    uint32_t index;
+    xi_context_handle_t context_handle;
+    xi_connection_state_t connection_state;
+    uint8_t subscribed;
+    uint8_t reconnect_pending;
+    uint8_t connect_refused; /* by the library, the device is left out of the run */
+    double connect_started_at;
+    double publish_credit;
+    uint32_t published;
+    uint32_t received;
+    uint32_t reconnects;
+    uint32_t failed_connects;
+    double latency_sum;
+    double latency_max;
+    char username[32];
+    char sft_filename[32];
+} xi_fleet_device_t;
+
+/* a growing array of samples, in seconds */
+typedef struct xi_fleet_samples_s
+{
+    double* values;
+    size_t count;
+    size_t capacity;
+} xi_fleet_samples_t;
+
+static xi_fleet_options_t xi_fleet_options = {
+    .devices_count       = 100,
+    .duration_sec        = 10,
+    .publish_rate        = 1,
+    .qos                 = XI_MQTT_QOS_AT_MOST_ONCE,
+    .keepalive_sec       = 60,
+    .payload_sizes       = {16, 256, 4096},
+    .payload_weights     = {70, 25, 5},
+    .payload_sizes_count = 3};
+
+static xi_fleet_device_t* xi_fleet_devices   = NULL;
+static xi_fleet_device_t** xi_fleet_by_handle = NULL;
+static uint16_t xi_fleet_port                 = 0;
+static uint8_t xi_fleet_publishing            = 0;
+static uint8_t xi_fleet_shutting_down         = 0;
+static uint8_t* xi_fleet_payload              = NULL;
+static unsigned int xi_fleet_seed             = 1;
+
+static xi_fleet_samples_t xi_fleet_connect_samples;
+static xi_fleet_samples_t xi_fleet_reconnect_samples;
+static xi_fleet_samples_t xi_fleet_latency_samples;
+
+#ifdef XI_FLEET_SIMULATOR_COUNT_MEMORY
+/* linked with -Wl,--wrap for the three memory BSP functions, only the blocks of the
+ * main thread are counted so that the broker thread does not show up */
+extern void* __real_xi_bsp_mem_alloc( size_t byte_count );
+extern void* __real_xi_bsp_mem_realloc( void* ptr, size_t byte_count );
+extern void __real_xi_bsp_mem_free( void* ptr );
+
+static pthread_t xi_fleet_main_thread;
+static int64_t xi_fleet_live_bytes = 0;
+static int64_t xi_fleet_peak_bytes = 0;
+
+static void xi_fleet_account( int64_t delta )
+{
+    xi_fleet_live_bytes += delta;
+    xi_fleet_peak_bytes = XI_MAX( xi_fleet_peak_bytes, xi_fleet_live_bytes );
+}
+
+void* __wrap_xi_bsp_mem_alloc( size_t byte_count )
+{
+    void* ptr = __real_xi_bsp_mem_alloc( byte_count );
+
+    if ( NULL != ptr && pthread_equal( pthread_self(), xi_fleet_main_thread ) )
+    {
+        xi_fleet_account( ( int64_t )malloc_usable_size( ptr ) );
+    }
+
+    return ptr;
+}
+
+void* __wrap_xi_bsp_mem_realloc( void* ptr, size_t byte_count )
+{
+    const int64_t old_size = ( NULL != ptr ) ? ( int64_t )malloc_usable_size( ptr ) : 0;
+    void* new_ptr          = __real_xi_bsp_mem_realloc( ptr, byte_count );
+
+    if ( NULL != new_ptr && pthread_equal( pthread_self(), xi_fleet_main_thread ) )
+    {
+        xi_fleet_account( ( int64_t )malloc_usable_size( new_ptr ) - old_size );
+    }
+
+    return new_ptr;
+}
+
+void __wrap_xi_bsp_mem_free( void* ptr )
+{
+    if ( NULL != ptr && pthread_equal( pthread_self(), xi_fleet_main_thread ) )
+    {
+        xi_fleet_account( -( int64_t )malloc_usable_size( ptr ) );
+    }
+
+    __real_xi_bsp_mem_free( ptr );
+}
+#endif
+
+static double xi_fleet_cpu_time()
+{
+    struct timespec ts;
+    clock_gettime( CLOCK_THREAD_CPUTIME_ID, &ts );
+
+    return ( double )ts.tv_sec + ( double )ts.tv_nsec / 1e9;
+}
+
+static void xi_fleet_samples_add( xi_fleet_samples_t* samples, double value )
+{
+    if ( samples->count == samples->capacity )
+    {
+        const size_t new_capacity = XI_MAX( 1024, samples->capacity * 2 );
+        double* new_values = realloc( samples->values, new_capacity * sizeof( double ) );
+
+        if ( NULL == new_values )
+        {
+            return;
+        }
+
+        samples->values   = new_values;
+        samples->capacity = new_capacity;
+    }
+
+    samples->values[samples->count++] = value;
+}
+
+static int xi_fleet_compare_doubles( const void* a, const void* b )
+{
+    const double lhs = *( const double* )a;
+    const double rhs = *( const double* )b;
+
+    return ( lhs > rhs ) - ( lhs < rhs );
+}
+
+/* sorts the samples, p is within [0, 1] */
+static double xi_fleet_samples_percentile( xi_fleet_samples_t* samples, double p )
+{
+    if ( 0 == samples->count )
+    {
+        return 0;
+    }
+
+    qsort( samples->values, samples->count, sizeof( double ), xi_fleet_compare_doubles );
+
+    const size_t index = ( size_t )( p * ( double )samples->count );
+
+    return samples->values[XI_MIN( index, samples->count - 1 )];
+}
+
+static int xi_fleet_compare_devices_by_handle( const void* a, const void* b )
+{
+    const xi_context_handle_t lhs = ( *( xi_fleet_device_t* const* )a )->context_handle;
+    const xi_context_handle_t rhs = ( *( xi_fleet_device_t* const* )b )->context_handle;
+
+    return ( lhs > rhs ) - ( lhs < rhs );
+}
+
+/* the connection callbacks carry no user data, the device is looked up by handle */
+static xi_fleet_device_t* xi_fleet_device_for_handle( xi_context_handle_t handle )
+{
+    xi_fleet_device_t key     = {.context_handle = handle};
+    const xi_fleet_device_t* key_ptr = &key;
+
+    xi_fleet_device_t** found = bsearch( &key_ptr, xi_fleet_by_handle,
+                                         xi_fleet_options.devices_count,
+                                         sizeof( xi_fleet_device_t* ),
+                                         xi_fleet_compare_devices_by_handle );
+
+    return ( NULL != found ) ? *found : NULL;
+}
+
+static void xi_fleet_on_echo( xi_context_handle_t in_context_handle,
+                              xi_sub_call_type_t call_type,
+                              const xi_sub_call_params_t* const params,
+                              xi_state_t state,
+                              void* user_data )
+{
+    XI_UNUSED( in_context_handle );
+
+    xi_fleet_device_t* device = ( xi_fleet_device_t* )user_data;
+    double sent_at            = 0;
+
+    if ( XI_SUB_CALL_SUBACK == call_type )
+    {
+        device->subscribed = ( XI_MQTT_SUBSCRIPTION_SUCCESSFULL == state );
+        return;
+    }
+
+    if ( XI_SUB_CALL_MESSAGE != call_type ||
+         XI_FLEET_PAYLOAD_HEADER_SIZE > params->message.temporary_payload_data_length )
+    {
+        return;
+    }
+
+    memcpy( &sent_at, params->message.temporary_payload_data, sizeof( sent_at ) );
+
+    const double latency = xi_fleet_now() - sent_at;
+
+    device->received += 1;
+    device->latency_sum += latency;
+    device->latency_max = XI_MAX( device->latency_max, latency );
+
+    xi_fleet_samples_add( &xi_fleet_latency_samples, latency );
+}
+
+static void xi_fleet_connect( xi_fleet_device_t* device );
+
+static void xi_fleet_on_connection( xi_context_handle_t in_context_handle,
+                                    void* data,
+                                    xi_state_t state )
+{
+    XI_UNUSED( state );
+
+    xi_fleet_device_t* device = xi_fleet_device_for_handle( in_context_handle );
+    const xi_connection_data_t* conn_data = ( xi_connection_data_t* )data;
+
+    if ( NULL == device )
+    {
+        return;
+    }
+
+    device->connection_state = conn_data->connection_state;
+
+    switch ( conn_data->connection_state )
+    {
+        case XI_CONNECTION_STATE_OPENED:
+            xi_fleet_samples_add( 0 < device->reconnects ? &xi_fleet_reconnect_samples
+                                                         : &xi_fleet_connect_samples,
+                                  xi_fleet_now() - device->connect_started_at );
+
+            xi_subscribe( device->context_handle, XI_FLEET_BROKER_ECHO_TOPIC,
+                          XI_MQTT_QOS_AT_LEAST_ONCE, &xi_fleet_on_echo, device );
+            break;
+        case XI_CONNECTION_STATE_OPEN_FAILED:
+            device->failed_connects += 1;
+
+            if ( !xi_fleet_shutting_down )
+            {
+                xi_fleet_connect( device );
+            }
+            break;
+        case XI_CONNECTION_STATE_CLOSED:
+            device->subscribed = 0;
+
+            if ( device->reconnect_pending && !xi_fleet_shutting_down )
+            {
+                device->reconnect_pending = 0;
+                device->reconnects += 1;
+                xi_fleet_connect( device );
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+static void xi_fleet_connect( xi_fleet_device_t* device )
+{
+    device->connection_state   = XI_CONNECTION_STATE_OPENING;
+    device->connect_started_at = xi_fleet_now();
+
+    const xi_state_t state = xi_connect_to(
+        device->context_handle, "127.0.0.1", xi_fleet_port, device->username,
+        "fleet-password", XI_FLEET_CONNECTION_TIMEOUT_SEC, xi_fleet_options.keepalive_sec,
+        XI_SESSION_CLEAN, &xi_fleet_on_connection );
+
+    /* e.g. the event dispatcher ran out of the vector indices, see
+     * XI_VECTOR_INDEX_TYPE */
+    if ( XI_STATE_OK != state )
+    {
+        fprintf( stderr, "could not connect device %u: %s (%d)\n", device->index,
+                 xi_get_state_string( state ), ( int )state );
+
+        device->connection_state = XI_CONNECTION_STATE_OPEN_FAILED;
+        device->connect_refused  = 1;
+        device->failed_connects += 1;
+    }
+}
+
+static size_t xi_fleet_pick_payload_size()
+{
+    uint32_t total_weight = 0;
+    size_t i              = 0;
+
+    for ( i = 0; i < xi_fleet_options.payload_sizes_count; ++i )
+    {
+        total_weight += xi_fleet_options.payload_weights[i];
+    }
+
+    uint32_t pick = ( uint32_t )rand_r( &xi_fleet_seed ) % XI_MAX( total_weight, 1 );
+
+    for ( i = 0; i < xi_fleet_options.payload_sizes_count - 1; ++i )
+    {
+        if ( pick < xi_fleet_options.payload_weights[i] )
+        {
+            break;
+        }
+
+        pick -= xi_fleet_options.payload_weights[i];
+    }
+
+    return xi_fleet_options.payload_sizes[i];
+}
+
+static void xi_fleet_publish( xi_fleet_device_t* device )
+{
+    const double now          = xi_fleet_now();
+    const size_t payload_size = xi_fleet_pick_payload_size();
+
+    memcpy( xi_fleet_payload, &now, sizeof( now ) );
+    memcpy( xi_fleet_payload + sizeof( now ), &device->index, sizeof( device->index ) );
+
+    /* the payload is copied by the library */
+    if ( XI_STATE_OK == xi_publish_data( device->context_handle,
+                                         XI_FLEET_BROKER_ECHO_TOPIC, xi_fleet_payload,
+                                         payload_size, xi_fleet_options.qos,
+                                         XI_MQTT_RETAIN_FALSE, NULL, NULL ) )
+    {
+        device->published += 1;
+    }
+}
+
+/* hands out the publications that became due since the last tick */
+static void xi_fleet_publish_due( double elapsed_sec )
+{
+    uint32_t i = 0;
+
+    for ( i = 0; i < xi_fleet_options.devices_count; ++i )
+    {
+        xi_fleet_device_t* device = &xi_fleet_devices[i];
+
+        if ( !device->subscribed )
+        {
+            continue;
+        }
+
+        device->publish_credit += xi_fleet_options.publish_rate * elapsed_sec;
+
+        for ( ; 1 <= device->publish_credit; device->publish_credit -= 1 )
+        {
+            xi_fleet_publish( device );
+        }
+    }
+}
+
+static void xi_fleet_storm()
+{
+    uint32_t i = 0;
+
+    for ( i = 0; i < xi_fleet_options.devices_count; ++i )
+    {
+        xi_fleet_device_t* device = &xi_fleet_devices[i];
+
+        if ( XI_CONNECTION_STATE_OPENED == device->connection_state )
+        {
+            device->reconnect_pending = 1;
+            xi_shutdown_connection( device->context_handle );
+        }
+    }
+}
+
+typedef int( xi_fleet_condition_t )();
+
+static int xi_fleet_all_subscribed()
+{
+    uint32_t i = 0;
+
+    for ( i = 0; i < xi_fleet_options.devices_count; ++i )
+    {
+        if ( !xi_fleet_devices[i].subscribed && !xi_fleet_devices[i].connect_refused )
+        {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+static int xi_fleet_all_closed()
+{
+    uint32_t i = 0;
+
+    for ( i = 0; i < xi_fleet_options.devices_count; ++i )
+    {
+        if ( XI_CONNECTION_STATE_CLOSED != xi_fleet_devices[i].connection_state &&
+             XI_CONNECTION_STATE_OPEN_FAILED != xi_fleet_devices[i].connection_state &&
+             XI_CONNECTION_STATE_UNINITIALIZED != xi_fleet_devices[i].connection_state )
+        {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/* runs the event loop until the deadline or until the condition holds */
+static int xi_fleet_run( double deadline, xi_fleet_condition_t* condition )
+{
+    static xi_fd_interest_t* interests = NULL;
+    static struct pollfd* fds          = NULL;
+    static size_t capacity             = 0;
+
+    double last_tick  = xi_fleet_now();
+    double next_storm = ( 0 < xi_fleet_options.storm_period_sec )
+                            ? last_tick + xi_fleet_options.storm_period_sec
+                            : 0;
+
+    while ( xi_fleet_now() < deadline && ( NULL == condition || !condition() ) )
+    {
+        size_t fds_count     = 0;
+        size_t i             = 0;
+        xi_time_t timeout_ms = 0;
+
+        xi_state_t state =
+            xi_events_get_fds( interests, capacity, &fds_count, &timeout_ms );
+
+        if ( XI_BUFFER_OVERFLOW == state )
+        {
+            const size_t new_capacity = fds_count + 64;
+            xi_fd_interest_t* new_interests =
+                realloc( interests, new_capacity * sizeof( *interests ) );
+            struct pollfd* new_fds = realloc( fds, new_capacity * sizeof( *fds ) );
+
+            interests = ( NULL != new_interests ) ? new_interests : interests;
+            fds       = ( NULL != new_fds ) ? new_fds : fds;
+
+            if ( NULL == new_interests || NULL == new_fds )
+            {
+                return 0;
+            }
+
+            capacity = new_capacity;
+            continue;
+        }
+        else if ( XI_STATE_OK != state )
+        {
+            return 0;
+        }
+
+        for ( i = 0; i < fds_count; ++i )
+        {
+            fds[i].fd      = ( int )interests[i].fd;
+            fds[i].events  = ( ( interests[i].events & XI_FD_EVENT_READ ) ? POLLIN : 0 ) |
+                            ( ( interests[i].events & XI_FD_EVENT_WRITE ) ? POLLOUT : 0 );
+            fds[i].revents = 0;
+        }
+
+        if ( 0 > timeout_ms || XI_FLEET_TICK_MS < timeout_ms )
+        {
+            timeout_ms = XI_FLEET_TICK_MS;
+        }
+
+        if ( 0 > poll( fds, fds_count, ( int )timeout_ms ) && EINTR != errno )
+        {
+            return 0;
+        }
+
+        for ( i = 0; i < fds_count; ++i )
+        {
+            if ( 0 == fds[i].revents )
+            {
+                continue;
+            }
+
+            const short revents = fds[i].revents;
+            const uint8_t events =
+                ( ( revents & POLLIN ) ? XI_FD_EVENT_READ : 0 ) |
+                ( ( revents & POLLOUT ) ? XI_FD_EVENT_WRITE : 0 ) |
+                ( ( revents & ( POLLERR | POLLHUP | POLLNVAL ) ) ? XI_FD_EVENT_ERROR
+                                                                 : 0 );
+
+            /* a socket closed by an earlier notification is not found, that is fine */
+            xi_notify_fd_ready( fds[i].fd, events );
+        }
+
+        const double now = xi_fleet_now();
+
+        if ( xi_fleet_publishing )
+        {
+            xi_fleet_publish_due( now - last_tick );
+
+            if ( 0 < next_storm && next_storm <= now )
+            {
+                xi_fleet_storm();
+                next_storm = now + xi_fleet_options.storm_period_sec;
+            }
+        }
+
+        last_tick = now;
+
+        /* runs the timed events and whatever the publications have queued */
+        if ( XI_STATE_OK != xi_notify_timeout() )
+        {
+            return 0;
+        }
+    }
+
+    return NULL == condition || condition();
+}
+
+static int xi_fleet_parse_payload_mix( const char* mix )
+{
+    size_t count = 0;
+
+    while ( NULL != mix && '\0' != *mix && count < XI_FLEET_MAX_PAYLOAD_SIZES )
+    {
+        char* end                                = NULL;
+        xi_fleet_options.payload_sizes[count]   = strtoul( mix, &end, 10 );
+        xi_fleet_options.payload_weights[count] = 1;
+
+        if ( ':' == *end )
+        {
+            xi_fleet_options.payload_weights[count] = strtoul( end + 1, &end, 10 );
+        }
+
+        if ( ( ',' != *end && '\0' != *end ) ||
+             XI_FLEET_PAYLOAD_HEADER_SIZE > xi_fleet_options.payload_sizes[count] )
+        {
+            return 0;
+        }
+
+        mix = ( ',' == *end ) ? end + 1 : end;
+        ++count;
+    }
+
+    xi_fleet_options.payload_sizes_count = count;
+
+    return 0 < count;
+}
+
+static void xi_fleet_usage( const char* name )
+{
+    fprintf( stderr,
+             "usage: %s [-n devices] [-t seconds] [-r rate] [-q qos] [-m mix]\n"
+             "          [-k keepalive] [-s storm_period] [-f sft_file_size] [-v]\n"
+             "\n"
+             "  -n number of the simulated devices, default 100\n"
+             "  -t length of the load phase in seconds, default 10\n"
+             "  -r publications per second of each device, default 1\n"
+             "  -q QoS of the publications, 0 or 1, default 0\n"
+             "  -m payload sizes and their weights, default 16:70,256:25,4096:5,\n"
+             "     every payload is at least %u bytes\n"
+             "  -k MQTT keepalive in seconds, default 60\n"
+             "  -s reconnect all of the devices every given seconds, default never\n"
+             "  -f size of the file every device downloads over SFT, default none\n"
+             "  -v print a CSV line per device as well\n",
+             name, ( unsigned )XI_FLEET_PAYLOAD_HEADER_SIZE );
+}
+
+static int xi_fleet_parse_options( int argc, char* argv[] )
+{
+    int option = 0;
+
+    while ( -1 != ( option = getopt( argc, argv, "n:t:r:q:m:k:s:f:vh" ) ) )
+    {
+        switch ( option )
+        {
+            case 'n':
+                xi_fleet_options.devices_count = ( uint32_t )strtoul( optarg, NULL, 10 );
+                break;
+            case 't':
+                xi_fleet_options.duration_sec = strtod( optarg, NULL );
+                break;
+            case 'r':
+                xi_fleet_options.publish_rate = strtod( optarg, NULL );
+                break;
+            case 'q':
+                xi_fleet_options.qos = ( '1' == optarg[0] ) ? XI_MQTT_QOS_AT_LEAST_ONCE
+                                                            : XI_MQTT_QOS_AT_MOST_ONCE;
+                break;
+            case 'm':
+                if ( !xi_fleet_parse_payload_mix( optarg ) )
+                {
+                    return 0;
+                }
+                break;
+            case 'k':
+                xi_fleet_options.keepalive_sec = ( uint16_t )strtoul( optarg, NULL, 10 );
+                break;
+            case 's':
+                xi_fleet_options.storm_period_sec = strtod( optarg, NULL );
+                break;
+            case 'f':
+                xi_fleet_options.sft_file_size = ( uint32_t )strtoul( optarg, NULL, 10 );
+                break;
+            case 'v':
+                xi_fleet_options.per_device_report = 1;
+                break;
+            default:
+                return 0;
+        }
+    }
+
+    return 0 < xi_fleet_options.devices_count && 0 <= xi_fleet_options.duration_sec;
+}
+
+/* two sockets per device, the broker's end is in this process too */
+static void xi_fleet_raise_file_limit()
+{
+    struct rlimit limit;
+    const rlim_t required = ( rlim_t )xi_fleet_options.devices_count * 3 + 64;
+
+    if ( 0 == getrlimit( RLIMIT_NOFILE, &limit ) && limit.rlim_cur < required )
+    {
+        limit.rlim_cur = XI_MIN( required, limit.rlim_max );
+        setrlimit( RLIMIT_NOFILE, &limit );
+
+        if ( limit.rlim_cur < required )
+        {
+            fprintf( stderr,
+                     "warning: the open file limit %lu is too low for %u devices\n",
+                     ( unsigned long )limit.rlim_cur, xi_fleet_options.devices_count );
+        }
+    }
+}
+
+static int xi_fleet_create_devices()
+{
+    size_t max_payload_size = 0;
+    uint32_t i              = 0;
+
+    xi_fleet_devices =
+        calloc( xi_fleet_options.devices_count, sizeof( xi_fleet_device_t ) );
+    xi_fleet_by_handle =
+        calloc( xi_fleet_options.devices_count, sizeof( xi_fleet_device_t* ) );
+
+    for ( i = 0; i < xi_fleet_options.payload_sizes_count; ++i )
+    {
+        max_payload_size = XI_MAX( max_payload_size, xi_fleet_options.payload_sizes[i] );
+    }
+
+    xi_fleet_payload = calloc( max_payload_size, 1 );
+
+    if ( NULL == xi_fleet_devices || NULL == xi_fleet_by_handle ||
+         NULL == xi_fleet_payload )
+    {
+        return 0;
+    }
+
+    for ( i = 0; i < xi_fleet_options.devices_count; ++i )
+    {
+        xi_fleet_device_t* device = &xi_fleet_devices[i];
+
+        device->index          = i;
+        device->context_handle = xi_create_context();
+        xi_fleet_by_handle[i]  = device;
+
+        if ( XI_INVALID_CONTEXT_HANDLE >= device->context_handle )
+        {
+            fprintf( stderr,
+                     "could not create context %u: %s (%d), the library allows "
+                     "XI_MAX_NUM_CONTEXTS of them\n",
+                     i, xi_get_state_string( ( xi_state_t )-device->context_handle ),
+                     ( int )-device->context_handle );
+            xi_fleet_options.devices_count = i;
+            return 0;
+        }
+
+        snprintf( device->username, sizeof( device->username ), "%s%u",
+                  XI_FLEET_BROKER_USERNAME_PREFIX, i );
+
+        if ( 0 < xi_fleet_options.sft_file_size )
+        {
+            const char* filenames[] = {device->sft_filename};
+
+            snprintf( device->sft_filename, sizeof( device->sft_filename ),
+                      "xi_fleet_%u.bin", i );
+            xi_set_updateable_files( device->context_handle, filenames, 1, NULL );
+        }
+    }
+
+    qsort( xi_fleet_by_handle, xi_fleet_options.devices_count,
+           sizeof( xi_fleet_device_t* ), xi_fleet_compare_devices_by_handle );
+
+    return 1;
+}
+
+static void xi_fleet_delete_devices()
+{
+    uint32_t i = 0;
+
+    for ( i = 0; NULL != xi_fleet_devices && i < xi_fleet_options.devices_count; ++i )
+    {
+        xi_fleet_device_t* device = &xi_fleet_devices[i];
+        char revision_filename[40];
+
+        xi_delete_context( device->context_handle );
+
+        if ( '\0' != device->sft_filename[0] )
+        {
+            snprintf( revision_filename, sizeof( revision_filename ), "%s.xirev",
+                      device->sft_filename );
+            remove( device->sft_filename );
+            remove( revision_filename );
+        }
+    }
+
+    free( xi_fleet_devices );
+    free( xi_fleet_by_handle );
+    free( xi_fleet_payload );
+
+    xi_fleet_devices   = NULL;
+    xi_fleet_by_handle = NULL;
+    xi_fleet_payload   = NULL;
+}
+
+static void xi_fleet_report( const xi_fleet_broker_t* broker,
+                             double load_sec,
+                             double load_cpu_sec,
+                             int64_t bytes_per_device )
+{
+    xi_fleet_samples_t sft_samples = {NULL, 0, 0};
+    uint64_t published             = 0;
+    uint64_t received              = 0;
+    uint32_t reconnects            = 0;
+    uint32_t failed_connects       = 0;
+    uint32_t connected             = 0;
+    uint32_t sft_ok                = 0;
+    uint32_t sft_failed            = 0;
+    uint64_t sft_bytes             = 0;
+    uint32_t i                     = 0;
+
+    if ( xi_fleet_options.per_device_report )
+    {
+        printf( "device,connects,published,received,latency_avg_ms,latency_max_ms,"
+                "reconnects,failed_connects,sft_sec,sft_code\n" );
+    }
+
+    for ( i = 0; i < xi_fleet_options.devices_count; ++i )
+    {
+        const xi_fleet_device_t* device = &xi_fleet_devices[i];
+        const xi_fleet_broker_device_stats_t* broker_stats =
+            xi_fleet_broker_device_stats( broker, i );
+        const double sft_sec = ( 0 < broker_stats->sft_finished_at )
+                                   ? broker_stats->sft_finished_at -
+                                         broker_stats->sft_started_at
+                                   : 0;
+
+        published += device->published;
+        received += device->received;
+        reconnects += device->reconnects;
+        failed_connects += device->failed_connects;
+        connected += ( 0 < broker_stats->connects );
+        sft_bytes += broker_stats->sft_bytes_sent;
+
+        if ( 0 < broker_stats->sft_finished_at )
+        {
+            sft_ok += ( 0 <= broker_stats->sft_status_code );
+            sft_failed += ( 0 > broker_stats->sft_status_code );
+            xi_fleet_samples_add( &sft_samples, sft_sec );
+        }
+
+        if ( xi_fleet_options.per_device_report )
+        {
+            printf( "%u,%u,%u,%u,%.3f,%.3f,%u,%u,%.3f,%d\n", i, broker_stats->connects,
+                    device->published, device->received,
+                    0 < device->received ? device->latency_sum * 1e3 / device->received
+                                         : 0,
+                    device->latency_max * 1e3, device->reconnects,
+                    device->failed_connects, sft_sec, broker_stats->sft_status_code );
+        }
+    }
+
+    printf( "%-28s %u (%u connected)\n", "devices", xi_fleet_options.devices_count,
+            connected );
+    printf( "%-28s %.2f / %.2f\n", "connect p50/p99 ms",
+            xi_fleet_samples_percentile( &xi_fleet_connect_samples, 0.5 ) * 1e3,
+            xi_fleet_samples_percentile( &xi_fleet_connect_samples, 0.99 ) * 1e3 );
+    printf( "%-28s %u\n", "failed connects", failed_connects );
+#ifdef XI_FLEET_SIMULATOR_COUNT_MEMORY
+    printf( "%-28s %lld (peak of the run %lld total)\n", "heap bytes per device",
+            ( long long )bytes_per_device, ( long long )xi_fleet_peak_bytes );
+#else
+    XI_UNUSED( bytes_per_device );
+    printf( "%-28s n/a\n", "heap bytes per device" );
+#endif
+    printf( "%-28s %llu (%.1f msgs/s)\n", "published", ( unsigned long long )published,
+            0 < load_sec ? ( double )published / load_sec : 0 );
+    printf( "%-28s %llu (%.1f msgs/s)\n", "received", ( unsigned long long )received,
+            0 < load_sec ? ( double )received / load_sec : 0 );
+    printf( "%-28s %.2f / %.2f\n", "round trip p50/p99 ms",
+            xi_fleet_samples_percentile( &xi_fleet_latency_samples, 0.5 ) * 1e3,
+            xi_fleet_samples_percentile( &xi_fleet_latency_samples, 0.99 ) * 1e3 );
+    printf( "%-28s %.2f\n", "cpu per message us",
+            0 < published + received
+                ? load_cpu_sec * 1e6 / ( double )( published + received )
+                : 0 );
+    printf( "%-28s %u (p50 %.2f ms, p99 %.2f ms)\n", "reconnects", reconnects,
+            xi_fleet_samples_percentile( &xi_fleet_reconnect_samples, 0.5 ) * 1e3,
+            xi_fleet_samples_percentile( &xi_fleet_reconnect_samples, 0.99 ) * 1e3 );
+
+    if ( 0 < xi_fleet_options.sft_file_size )
+    {
+        printf( "%-28s %u ok, %u failed (p50 %.2f s, p99 %.2f s, %llu bytes sent)\n",
+                "sft downloads", sft_ok, sft_failed,
+                xi_fleet_samples_percentile( &sft_samples, 0.5 ),
+                xi_fleet_samples_percentile( &sft_samples, 0.99 ),
+                ( unsigned long long )sft_bytes );
+    }
+
+    free( sft_samples.values );
+}
+
+int main( int argc, char* argv[] )
+{
+    xi_fleet_broker_t* broker = NULL;
+    int64_t bytes_per_device  = 0;
+    double load_sec           = 0;
+    double load_cpu_sec       = 0;
+    uint32_t i                = 0;
+    int ret                   = 1;
+
+#ifdef XI_FLEET_SIMULATOR_COUNT_MEMORY
+    xi_fleet_main_thread = pthread_self();
+#endif
+
+    if ( !xi_fleet_parse_options( argc, argv ) )
+    {
+        xi_fleet_usage( argv[0] );
+        return 1;
+    }
+
+    xi_fleet_raise_file_limit();
+
+    if ( XI_STATE_OK != xi_initialize( "xi_fleet_account_id", "xi_fleet_device_id" ) )
+    {
+        fprintf( stderr, "could not initialize the library\n" );
+        return 1;
+    }
+
+    broker = xi_fleet_broker_start( xi_fleet_options.devices_count,
+                                    xi_fleet_options.sft_file_size, &xi_fleet_port );
+
+    if ( NULL == broker )
+    {
+        fprintf( stderr, "could not start the broker stand-in\n" );
+        goto end;
+    }
+
+#ifdef XI_FLEET_SIMULATOR_COUNT_MEMORY
+    const int64_t live_bytes_before = xi_fleet_live_bytes;
+#endif
+
+    if ( !xi_fleet_create_devices() )
+    {
+        goto end;
+    }
+
+    /* ramp up, every device connects at once */
+    for ( i = 0; i < xi_fleet_options.devices_count; ++i )
+    {
+        xi_fleet_connect( &xi_fleet_devices[i] );
+    }
+
+    const double ramp_up_start = xi_fleet_now();
+
+    if ( !xi_fleet_run( ramp_up_start + XI_FLEET_RAMP_UP_TIMEOUT_SEC,
+                        &xi_fleet_all_subscribed ) )
+    {
+        fprintf( stderr, "not all of the devices have connected and subscribed\n" );
+    }
+
+    printf( "%-28s %.2f\n", "ramp-up s", xi_fleet_now() - ramp_up_start );
+
+#ifdef XI_FLEET_SIMULATOR_COUNT_MEMORY
+    bytes_per_device =
+        ( xi_fleet_live_bytes - live_bytes_before ) / xi_fleet_options.devices_count;
+#endif
+
+    /* the load phase, the latencies of the ramp up are left out */
+    xi_fleet_latency_samples.count = 0;
+    xi_fleet_publishing            = 1;
+
+    const double load_start     = xi_fleet_now();
+    const double load_cpu_start = xi_fleet_cpu_time();
+
+    xi_fleet_run( load_start + xi_fleet_options.duration_sec, NULL );
+
+    load_sec     = xi_fleet_now() - load_start;
+    load_cpu_sec = xi_fleet_cpu_time() - load_cpu_start;
+
+    /* let the echoes of the last publications come back */
+    xi_fleet_publishing = 0;
+    xi_fleet_run( xi_fleet_now() + XI_FLEET_DRAIN_SEC, NULL );
+
+    xi_fleet_shutting_down = 1;
+
+    for ( i = 0; i < xi_fleet_options.devices_count; ++i )
+    {
+        xi_shutdown_connection( xi_fleet_devices[i].context_handle );
+    }
+
+    xi_fleet_run( xi_fleet_now() + XI_FLEET_SHUTDOWN_TIMEOUT_SEC, &xi_fleet_all_closed );
+
+    xi_fleet_broker_stop( broker );
+    xi_fleet_report( broker, load_sec, load_cpu_sec, bytes_per_device );
+
+    ret = 0;
+
+end:
+    xi_fleet_delete_devices();
+    xi_shutdown();
+    xi_fleet_broker_stop( broker );
+    xi_fleet_broker_destroy( &broker );
+
+    free( xi_fleet_connect_samples.values );
+    free( xi_fleet_reconnect_samples.values );
+    free( xi_fleet_latency_samples.values );
+
+    return ret;
+}
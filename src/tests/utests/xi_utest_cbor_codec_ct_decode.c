@@ -14,7 +14,9 @@
 #include <stdint.h>
 #include <string.h>
 
+#include <xi_allocator.h>
 #include <xi_cbor_codec_ct.h>
+#include <xi_cbor_codec_ct_cn_cbor.h>
 #include <xi_control_message.h>
 #include <xi_macros.h>
 
@@ -488,6 +490,174 @@ XI_TT_TESTCASE_WITH_SETUP(
         xi_control_message_free( &file_chunk_out );
     } )
 
+XI_TT_TESTCASE_WITH_SETUP(
+    xi_utest_cbor_codec_ct_decode__file_chunk__chunk_points_into_the_received_buffer,
+    xi_utest_setup_basic,
+    xi_utest_teardown_basic,
+    NULL,
+    {
+        // ARRANGE
+        const xi_control_message_t file_chunk_in = {
+            .file_chunk = {
+                .common = {.msgtype = XI_CONTROL_MESSAGE_SC__SFT_FILE_CHUNK, .msgver = 1},
+                .name     = "filename for filechunk message",
+                .revision = "revision for filechunk message",
+                .offset   = 1024,
+                .length   = 15,
+                .status   = 0,
+                .chunk    = ( uint8_t* )"my chunk hello"}};
+
+        uint8_t* encoded     = NULL;
+        uint32_t encoded_len = 0;
+
+        xi_cbor_codec_ct_server_encode( &file_chunk_in, &encoded, &encoded_len );
+
+        // ACT
+        xi_control_message_t* file_chunk_out =
+            xi_cbor_codec_ct_decode( encoded, encoded_len );
+
+        // ASSERT
+        xi_utest_cbor_ASSERT_control_messages_match( &file_chunk_in, file_chunk_out );
+
+        tt_want_int_op( 1, ==, file_chunk_out->file_chunk.flag_chunk_borrowed );
+        tt_want_ptr_op( encoded, <=, file_chunk_out->file_chunk.chunk );
+        tt_want_ptr_op( file_chunk_out->file_chunk.chunk +
+                            file_chunk_out->file_chunk.length,
+                        <=, encoded + encoded_len );
+
+        xi_control_message_free( &file_chunk_out );
+        XI_SAFE_FREE( encoded );
+    } )
+
+XI_TT_TESTCASE_WITH_SETUP(
+    xi_utest_cbor_codec_ct_decode__file_chunk__any_key_order_unknown_keys_skipped,
+    xi_utest_setup_basic,
+    xi_utest_teardown_basic,
+    NULL,
+    {
+        // ARRANGE
+        /* indefinite length map, msgtype and msgver last, an unknown key holding an
+         * array with a nested map and a byte string in between */
+        const uint8_t encoded[] = {
+            0xbf, 0x61, 0x43, 0x43, 0x01, 0x02, 0x03, 0x67, 'u',  'n',  'k',  'n', 'o',
+            'w',  'n',  0x83, 0x01, 0xa1, 0x61, 'a',  0x20, 0x41, 0xff, 0x61, 0x4f, 0x19,
+            0x01, 0x00, 0x61, 0x4e, 0x61, 'f',  0x66, 'm',  's',  'g',  'v',  'e', 'r',
+            0x01, 0x67, 'm',  's',  'g',  't',  'y',  'p',  'e',  0x03, 0xff};
+
+        const xi_control_message_t file_chunk_expected = {
+            .file_chunk = {
+                .common = {.msgtype = XI_CONTROL_MESSAGE_SC__SFT_FILE_CHUNK, .msgver = 1},
+                .name     = "f",
+                .revision = NULL,
+                .offset   = 256,
+                .length   = 3,
+                .status   = 0,
+                .chunk    = ( uint8_t[] ){1, 2, 3}}};
+
+        // ACT
+        xi_control_message_t* file_chunk_out =
+            xi_cbor_codec_ct_decode( encoded, sizeof( encoded ) );
+
+        // ASSERT
+        xi_utest_cbor_ASSERT_control_messages_match( &file_chunk_expected,
+                                                     file_chunk_out );
+
+        xi_control_message_free( &file_chunk_out );
+    } )
+
+XI_TT_TESTCASE_WITH_SETUP(
+    xi_utest_cbor_codec_ct_decode__truncated_or_trailing_data__returns_null,
+    xi_utest_setup_basic,
+    xi_utest_teardown_basic,
+    NULL,
+    {
+        // ARRANGE
+        xi_control_message_file_desc_ext_t single_file_list[1] = {
+            {.name            = "first_SFT_test.cfg",
+             .revision        = "1",
+             .size_in_bytes   = 109489,
+             .fingerprint     = ( uint8_t* )"first_SFT_test_artificial_checksum.cfg",
+             .fingerprint_len = 39,
+             .download_link   = "hello I am the download link"}};
+
+        const xi_control_message_t file_update_available_in = {
+            .file_update_available = {
+                .common = {.msgtype = XI_CONTROL_MESSAGE_SC__SFT_FILE_UPDATE_AVAILABLE,
+                           .msgver  = 1},
+                .list_len = 1,
+                .list     = single_file_list}};
+
+        uint8_t* encoded     = NULL;
+        uint32_t encoded_len = 0;
+        uint32_t prefix_len  = 0;
+
+        xi_cbor_codec_ct_server_encode( &file_update_available_in, &encoded,
+                                        &encoded_len );
+
+        // ACT & ASSERT
+        for ( ; prefix_len < encoded_len; ++prefix_len )
+        {
+            tt_want_ptr_op( NULL, ==, xi_cbor_codec_ct_decode( encoded, prefix_len ) );
+        }
+
+        uint8_t* encoded_with_trailing_byte = xi_alloc( encoded_len + 1 );
+        memcpy( encoded_with_trailing_byte, encoded, encoded_len );
+        encoded_with_trailing_byte[encoded_len] = 0;
+
+        tt_want_ptr_op( NULL, ==, xi_cbor_codec_ct_decode( encoded_with_trailing_byte,
+                                                           encoded_len + 1 ) );
+
+        XI_SAFE_FREE( encoded_with_trailing_byte );
+        XI_SAFE_FREE( encoded );
+    } )
+
+XI_TT_TESTCASE_WITH_SETUP(
+    xi_utest_cbor_codec_ct_decode__file_update_available__same_result_as_cn_cbor_codec,
+    xi_utest_setup_basic,
+    xi_utest_teardown_basic,
+    NULL,
+    {
+        // ARRANGE
+        xi_control_message_file_desc_ext_t two_file_list[2] = {
+            {.name                              = "filename 1",
+             .revision                          = "revision 11",
+             .file_operation                    = 1,
+             .size_in_bytes                     = 0x01020304,
+             .fingerprint                       = ( uint8_t[] ){0x55, 0x56, 0x0, 0x56},
+             .fingerprint_len                   = 4,
+             .download_link                     = "https://example.com/1",
+             .flag_mqtt_download_also_supported = 1},
+            {.name = NULL, .revision = "revision 22", .size_in_bytes = 23}};
+
+        const xi_control_message_t file_update_available_in = {
+            .file_update_available = {
+                .common = {.msgtype = XI_CONTROL_MESSAGE_SC__SFT_FILE_UPDATE_AVAILABLE,
+                           .msgver  = 2},
+                .list_len = 2,
+                .list     = two_file_list}};
+
+        uint8_t* encoded     = NULL;
+        uint32_t encoded_len = 0;
+
+        xi_cbor_codec_ct_server_encode( &file_update_available_in, &encoded,
+                                        &encoded_len );
+
+        // ACT
+        xi_control_message_t* streaming_out =
+            xi_cbor_codec_ct_decode( encoded, encoded_len );
+        xi_control_message_t* cn_cbor_out =
+            xi_cbor_codec_ct_cn_cbor_decode( encoded, encoded_len );
+
+        // ASSERT
+        xi_utest_cbor_ASSERT_control_messages_match( cn_cbor_out, streaming_out );
+        xi_utest_cbor_ASSERT_control_messages_match( &file_update_available_in,
+                                                     streaming_out );
+
+        xi_control_message_free( &streaming_out );
+        xi_control_message_free( &cn_cbor_out );
+        XI_SAFE_FREE( encoded );
+    } )
+
 XI_TT_TESTGROUP_END
 
 #ifndef XI_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
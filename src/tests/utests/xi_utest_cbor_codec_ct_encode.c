@@ -15,6 +15,7 @@
 #include <string.h>
 
 #include <xi_cbor_codec_ct.h>
+#include <xi_cbor_codec_ct_cn_cbor.h>
 #include <xi_control_message_sft.h>
 #include <xi_macros.h>
 
@@ -325,6 +326,69 @@ XI_TT_TESTCASE_WITH_SETUP(
         XI_SAFE_FREE( encoded );
     } )
 
+/*****************************************************
+ * STREAMING vs cn-cbor ******************************
+ *****************************************************/
+
+XI_TT_TESTCASE_WITH_SETUP(
+    xi_utest_cbor_codec_ct_encode__all_client_messages__same_output_as_cn_cbor_codec,
+    xi_utest_setup_basic,
+    xi_utest_teardown_basic,
+    NULL,
+    {
+        xi_control_message_file_desc_t file_list[3] = {
+            {.name = "filename 1", .revision = NULL},
+            {.name = NULL, .revision = "revision 2"},
+            {.name     = "a file name longer than twenty three bytes",
+             .revision = "a revision even longer than the file name, over 255 bytes "
+                         "....................................................."
+                         "....................................................."
+                         "....................................................."
+                         "....................................................."}};
+
+        const xi_control_message_t messages[] = {
+            {.file_info = {.common    = {.msgtype = XI_CONTROL_MESSAGE_CS__SFT_FILE_INFO,
+                                      .msgver  = 1},
+                           .list_len = 3,
+                           .list     = file_list,
+                           .flag_accept_download_link = 1}},
+            {.file_get_chunk = {.common   = {.msgtype =
+                                               XI_CONTROL_MESSAGE_CS__SFT_FILE_GET_CHUNK,
+                                           .msgver = 0xffffffff},
+                                .name     = "name",
+                                .revision = NULL,
+                                .offset   = 0x12345678,
+                                .length   = 65536}},
+            {.file_status =
+                 {.common   = {.msgtype = XI_CONTROL_MESSAGE_CS__SFT_FILE_STATUS,
+                             .msgver  = 24},
+                  .name     = NULL,
+                  .revision = "revision",
+                  .phase    = XI_CONTROL_MESSAGE__SFT_FILE_STATUS_PHASE_FINISHED,
+                  .code = XI_CONTROL_MESSAGE__SFT_FILE_STATUS_CODE_ERROR__FILE_CLOSE}},
+            {.file_chunk = {.common = {.msgtype = XI_CONTROL_MESSAGE_SC__SFT_FILE_CHUNK,
+                                       .msgver  = 1}}}};
+
+        size_t id_message = 0;
+        for ( ; id_message < XI_ARRAYSIZE( messages ); ++id_message )
+        {
+            uint8_t* encoded             = NULL;
+            uint32_t encoded_len         = 0;
+            uint8_t* encoded_cn_cbor     = NULL;
+            uint32_t encoded_cn_cbor_len = 0;
+
+            xi_cbor_codec_ct_encode( &messages[id_message], &encoded, &encoded_len );
+            xi_cbor_codec_ct_cn_cbor_encode( &messages[id_message], &encoded_cn_cbor,
+                                             &encoded_cn_cbor_len );
+
+            tt_want_int_op( encoded_cn_cbor_len, ==, encoded_len );
+            tt_want_int_op( 0, ==, memcmp( encoded_cn_cbor, encoded, encoded_len ) );
+
+            XI_SAFE_FREE( encoded );
+            XI_SAFE_FREE( encoded_cn_cbor );
+        }
+    } )
+
 XI_TT_TESTGROUP_END
 
 #ifndef XI_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
@@ -66,6 +66,42 @@ xi_state_t proc_loop( xi_event_handle_arg1_t a )
     return 0;
 }
 
+/* records the order of execution of the handles scheduled by the direct call tests */
+static uint32_t direct_call_order[32];
+static uint32_t direct_call_order_count = 0;
+
+xi_state_t record_direct_call( xi_event_handle_arg1_t a )
+{
+    direct_call_order[direct_call_order_count++] = ( uint32_t )( intptr_t )a;
+    return 0;
+}
+
+/* the shape of the closures */
+xi_state_t record_closure_call( void* a1, void* a2, xi_state_t a3, void* a4 )
+{
+    XI_UNUSED( a2 );
+    XI_UNUSED( a3 );
+    XI_UNUSED( a4 );
+
+    return record_direct_call( a1 );
+}
+
+/* schedules itself directly until the counter drops to zero */
+xi_state_t chain_direct_call( xi_event_handle_arg1_t a )
+{
+    uint32_t* counter = ( uint32_t* )a;
+
+    direct_call_order[direct_call_order_count++] = *counter;
+
+    if ( *counter > 0 )
+    {
+        *counter -= 1;
+        xi_evtd_execute_direct( evtd_g_i, xi_make_handle( &chain_direct_call, counter ) );
+    }
+
+    return 0;
+}
+
 void test_time_overflow_function( void )
 {
     evtd_g_i = xi_evtd_create_instance();
@@ -353,6 +389,121 @@ end:
     xi_evtd_destroy_instance( evtd_g_i );
 } )
 
+XI_TT_TESTCASE( utest__execute_direct__mixed_with_execute__queue_order_kept, {
+    evtd_g_i                    = xi_evtd_create_instance();
+    evtd_g_i->direct_call_depth = 4;
+    direct_call_order_count     = 0;
+
+    /* first one takes the direct slot, the rest has to wait behind it */
+    tt_int_op( XI_STATE_OK, ==,
+               xi_evtd_execute_direct(
+                   evtd_g_i, xi_make_handle( &record_direct_call, ( void* )1 ) ) );
+    tt_ptr_op( NULL, !=,
+               xi_evtd_execute( evtd_g_i,
+                                xi_make_handle( &record_direct_call, ( void* )2 ) ) );
+    tt_int_op( XI_STATE_OK, ==,
+               xi_evtd_execute_direct(
+                   evtd_g_i, xi_make_handle( &record_direct_call, ( void* )3 ) ) );
+
+    xi_evtd_step( evtd_g_i, 0 );
+
+    tt_int_op( 3, ==, direct_call_order_count );
+    tt_int_op( 1, ==, direct_call_order[0] );
+    tt_int_op( 2, ==, direct_call_order[1] );
+    tt_int_op( 3, ==, direct_call_order[2] );
+
+end:
+    xi_evtd_destroy_instance( evtd_g_i );
+} )
+
+XI_TT_TESTCASE( utest__execute_closure__mixed_with_handles__queue_order_kept, {
+    evtd_g_i                    = xi_evtd_create_instance();
+    evtd_g_i->direct_call_depth = 4;
+    direct_call_order_count     = 0;
+
+    tt_int_op( XI_STATE_OK, ==,
+               xi_evtd_execute_closure_direct(
+                   evtd_g_i, xi_make_closure( &record_closure_call, ( void* )1, NULL,
+                                              XI_STATE_OK, NULL ) ) );
+    tt_ptr_op( NULL, !=,
+               xi_evtd_execute( evtd_g_i,
+                                xi_make_handle( &record_direct_call, ( void* )2 ) ) );
+    tt_ptr_op( NULL, !=,
+               xi_evtd_execute_closure(
+                   evtd_g_i, xi_make_closure( &record_closure_call, ( void* )3, NULL,
+                                              XI_STATE_OK, NULL ) ) );
+    /* a handle of the closure shape is converted to one */
+    tt_int_op( XI_STATE_OK, ==,
+               xi_evtd_execute_direct( evtd_g_i,
+                                       xi_make_handle( &record_closure_call, ( void* )4,
+                                                       NULL, XI_STATE_OK, NULL ) ) );
+
+    xi_evtd_step( evtd_g_i, 0 );
+
+    tt_int_op( 4, ==, direct_call_order_count );
+    tt_int_op( 1, ==, direct_call_order[0] );
+    tt_int_op( 2, ==, direct_call_order[1] );
+    tt_int_op( 3, ==, direct_call_order[2] );
+    tt_int_op( 4, ==, direct_call_order[3] );
+
+end:
+    xi_evtd_destroy_instance( evtd_g_i );
+} )
+
+XI_TT_TESTCASE( utest__execute_direct__chain_longer_than_depth__split_between_steps, {
+    evtd_g_i                    = xi_evtd_create_instance();
+    evtd_g_i->direct_call_depth = 4;
+    direct_call_order_count     = 0;
+
+    uint32_t counter = 6;
+
+    xi_evtd_execute( evtd_g_i, xi_make_handle( &chain_direct_call, &counter ) );
+
+    /* the queued handle plus direct_call_depth direct ones */
+    tt_int_op( 1, ==, xi_evtd_single_step( evtd_g_i, 0 ) );
+    tt_int_op( 5, ==, direct_call_order_count );
+
+    /* the leftover is executed first by the next step */
+    tt_int_op( 1, ==, xi_evtd_single_step( evtd_g_i, 0 ) );
+    tt_int_op( 7, ==, direct_call_order_count );
+    tt_int_op( 0, ==, counter );
+
+    tt_int_op( 0, ==, xi_evtd_single_step( evtd_g_i, 0 ) );
+
+end:
+    xi_evtd_destroy_instance( evtd_g_i );
+} )
+
+XI_TT_TESTCASE( utest__step__more_handles_than_budget__rest_left_for_next_step, {
+    evtd_g_i                    = xi_evtd_create_instance();
+    evtd_g_i->direct_call_depth = 0;
+    evtd_g_i->step_budget       = 3;
+    direct_call_order_count     = 0;
+
+    intptr_t i = 1;
+    for ( ; i <= 5; ++i )
+    {
+        tt_ptr_op( NULL, !=,
+                   xi_evtd_execute( evtd_g_i,
+                                    xi_make_handle( &record_direct_call, ( void* )i ) ) );
+    }
+
+    xi_evtd_step( evtd_g_i, 0 );
+
+    tt_int_op( 3, ==, direct_call_order_count );
+    tt_int_op( 1, ==, xi_evtd_has_pending_calls( evtd_g_i ) );
+
+    xi_evtd_step( evtd_g_i, 0 );
+
+    tt_int_op( 5, ==, direct_call_order_count );
+    tt_int_op( 4, ==, direct_call_order[3] );
+    tt_int_op( 5, ==, direct_call_order[4] );
+    tt_int_op( 0, ==, xi_evtd_has_pending_calls( evtd_g_i ) );
+
+end:
+    xi_evtd_destroy_instance( evtd_g_i );
+} )
+
 /* skipped because this feature is not yet implemented */
 SKIP_XI_TT_TESTCASE(
     utest__xi_evtd__events_to_call_added__overlap_timer__proper_events_executed,
@@ -0,0 +1,188 @@
+/* Copyright (c) 2003-2018, Xively All rights reserved.
+ *
+ * This is part of the Xively C Client library,
+ * it is licensed under the BSD 3-Clause license.
+ */
+
+#include "tinytest.h"
+#include "tinytest_macros.h"
+#include "xi_tt_testcase_management.h"
+#include "xi_utest_basic_testcase_frame.h"
+
+#include "xi_event_loop.h"
+#include "xi_bsp_time.h"
+
+#include <stdio.h>
+
+#ifndef XI_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
+
+xi_state_t xi_utest_event_loop_add( xi_event_handle_arg1_t a, xi_event_handle_arg2_t b )
+{
+    *( ( uint32_t* )a ) += ( uint32_t )( intptr_t )b;
+    return XI_STATE_OK;
+}
+
+#define XI_UTEST_EVENT_LOOP_ADD_HANDLE( counter, value )                                 \
+    xi_make_handle( &xi_utest_event_loop_add, counter, ( void* )( intptr_t )value )
+
+#endif
+
+XI_TT_TESTGROUP_BEGIN( utest_event_loop )
+
+XI_TT_TESTCASE_WITH_SETUP(
+    utest__xi_event_loop_get_fd_interests__sockets_registered__events_translated,
+    xi_utest_setup_basic,
+    xi_utest_teardown_basic,
+    NULL,
+    {
+        uint32_t counter                  = 0;
+        xi_fd_interest_t fds[3]           = {{0, 0}};
+        size_t fds_count                  = 0;
+        xi_time_t timeout_ms              = 0;
+        xi_evtd_instance_t* evtd_instance = xi_evtd_create_instance();
+
+        tt_ptr_op( evtd_instance, !=, NULL );
+
+        xi_evtd_register_socket_fd( evtd_instance, 15,
+                                    XI_UTEST_EVENT_LOOP_ADD_HANDLE( &counter, 1 ) );
+        xi_evtd_register_socket_fd( evtd_instance, 14,
+                                    XI_UTEST_EVENT_LOOP_ADD_HANDLE( &counter, 1 ) );
+        xi_evtd_register_socket_fd( evtd_instance, 12,
+                                    XI_UTEST_EVENT_LOOP_ADD_HANDLE( &counter, 1 ) );
+        xi_evtd_continue_when_evt_on_socket(
+            evtd_instance, XI_EVENT_WANT_WRITE,
+            XI_UTEST_EVENT_LOOP_ADD_HANDLE( &counter, 1 ), 14 );
+        xi_evtd_continue_when_evt_on_socket(
+            evtd_instance, XI_EVENT_WANT_CONNECT,
+            XI_UTEST_EVENT_LOOP_ADD_HANDLE( &counter, 1 ), 12 );
+
+        tt_int_op( xi_event_loop_get_fd_interests( evtd_instance, fds, 2, &fds_count,
+                                                   &timeout_ms ),
+                   ==, XI_BUFFER_OVERFLOW );
+        tt_int_op( fds_count, ==, 3 );
+
+        tt_int_op( xi_event_loop_get_fd_interests( evtd_instance, fds, 3, &fds_count,
+                                                   &timeout_ms ),
+                   ==, XI_STATE_OK );
+        tt_int_op( fds_count, ==, 3 );
+        tt_int_op( fds[0].fd, ==, 15 );
+        tt_int_op( fds[0].events, ==, XI_FD_EVENT_READ );
+        tt_int_op( fds[1].fd, ==, 14 );
+        tt_int_op( fds[1].events, ==, XI_FD_EVENT_WRITE );
+        tt_int_op( fds[2].fd, ==, 12 );
+        tt_int_op( fds[2].events, ==, XI_FD_EVENT_WRITE );
+
+        /* nothing scheduled, the host loop may wait on the sockets only */
+        tt_int_op( timeout_ms, ==, -1 );
+        tt_int_op( counter, ==, 0 );
+
+    end:
+        if ( NULL != evtd_instance )
+        {
+            xi_evtd_unregister_socket_fd( evtd_instance, 12 );
+            xi_evtd_unregister_socket_fd( evtd_instance, 15 );
+            xi_evtd_unregister_socket_fd( evtd_instance, 14 );
+        }
+        xi_evtd_destroy_instance( evtd_instance );
+    } )
+
+XI_TT_TESTCASE_WITH_SETUP(
+    utest__xi_event_loop_get_fd_interests__time_event_scheduled__timeout_until_it,
+    xi_utest_setup_basic,
+    xi_utest_teardown_basic,
+    NULL,
+    {
+        uint32_t counter                  = 0;
+        size_t fds_count                  = 1;
+        xi_time_t timeout_ms              = 0;
+        xi_evtd_instance_t* evtd_instance = xi_evtd_create_instance();
+
+        tt_ptr_op( evtd_instance, !=, NULL );
+
+        xi_evtd_step( evtd_instance, xi_bsp_time_getcurrenttime_seconds() );
+        xi_evtd_execute_in( evtd_instance, XI_UTEST_EVENT_LOOP_ADD_HANDLE( &counter, 1 ),
+                            5, NULL );
+
+        tt_int_op( xi_event_loop_get_fd_interests( evtd_instance, NULL, 0, &fds_count,
+                                                   &timeout_ms ),
+                   ==, XI_STATE_OK );
+        tt_int_op( fds_count, ==, 0 );
+        tt_int_op( timeout_ms, >=, 4000 );
+        tt_int_op( timeout_ms, <=, 5000 );
+
+        /* an early notification must not run the event ahead of its time */
+        tt_int_op( xi_event_loop_notify_timeout( evtd_instance ), ==, XI_STATE_OK );
+        tt_int_op( counter, ==, 0 );
+
+        /* overdue events are reported as a timeout of 0 and run on the notification */
+        evtd_instance->current_step -= 10;
+        xi_evtd_execute_in( evtd_instance, XI_UTEST_EVENT_LOOP_ADD_HANDLE( &counter, 2 ),
+                            0, NULL );
+
+        tt_int_op( xi_event_loop_get_fd_interests( evtd_instance, NULL, 0, &fds_count,
+                                                   &timeout_ms ),
+                   ==, XI_STATE_OK );
+        tt_int_op( timeout_ms, ==, 0 );
+        tt_int_op( xi_event_loop_notify_timeout( evtd_instance ), ==, XI_STATE_OK );
+        tt_int_op( counter, ==, 2 );
+
+    end:
+        xi_evtd_destroy_instance( evtd_instance );
+    } )
+
+XI_TT_TESTCASE_WITH_SETUP(
+    utest__xi_event_loop_notify_fd__readiness_reported__only_awaited_events_handled,
+    xi_utest_setup_basic,
+    xi_utest_teardown_basic,
+    NULL,
+    {
+        uint32_t counter                  = 0;
+        xi_evtd_instance_t* evtd_instance = xi_evtd_create_instance();
+
+        tt_ptr_op( evtd_instance, !=, NULL );
+
+        xi_evtd_register_socket_fd( evtd_instance, 14,
+                                    XI_UTEST_EVENT_LOOP_ADD_HANDLE( &counter, 1 ) );
+        xi_evtd_continue_when_evt_on_socket(
+            evtd_instance, XI_EVENT_WANT_WRITE,
+            XI_UTEST_EVENT_LOOP_ADD_HANDLE( &counter, 3 ), 14 );
+
+        /* the socket waits for the write */
+        tt_int_op( xi_event_loop_notify_fd( evtd_instance, 14, XI_FD_EVENT_READ ), ==,
+                   XI_STATE_OK );
+        tt_int_op( counter, ==, 0 );
+
+        tt_int_op( xi_event_loop_notify_fd( evtd_instance, 14,
+                                            XI_FD_EVENT_READ | XI_FD_EVENT_WRITE ),
+                   ==, XI_STATE_OK );
+        tt_int_op( counter, ==, 3 );
+
+        /* back to the read handle */
+        tt_int_op( xi_event_loop_notify_fd( evtd_instance, 14, XI_FD_EVENT_READ ), ==,
+                   XI_STATE_OK );
+        tt_int_op( counter, ==, 4 );
+
+        tt_int_op( xi_event_loop_notify_fd( evtd_instance, 14, XI_FD_EVENT_ERROR ), ==,
+                   XI_STATE_OK );
+        tt_int_op( counter, ==, 5 );
+
+        /* a socket closed meanwhile does not stop the dispatcher */
+        tt_int_op( xi_event_loop_notify_fd( evtd_instance, 16, XI_FD_EVENT_READ ), ==,
+                   XI_FD_HANDLER_NOT_FOUND );
+        tt_int_op( xi_evtd_dispatcher_continue( evtd_instance ), ==, 1 );
+
+    end:
+        if ( NULL != evtd_instance )
+        {
+            xi_evtd_unregister_socket_fd( evtd_instance, 14 );
+        }
+        xi_evtd_destroy_instance( evtd_instance );
+    } )
+
+XI_TT_TESTGROUP_END
+
+#ifndef XI_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
+#define XI_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
+#include __FILE__
+#undef XI_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
+#endif
@@ -63,6 +63,52 @@ XI_TT_TESTCASE_WITH_SETUP(
     end:;
     } )
 
+XI_TT_TESTCASE_WITH_SETUP(
+    xi_utest_fwu_checksum_million_a_in_uneven_chunks__fips_digest,
+    xi_utest_setup_basic,
+    xi_utest_teardown_basic,
+    NULL,
+    {
+        /* FIPS 180-2 long message test, fed in chunks that do not line up with the
+         * 64 bytes SHA-256 blocks to cover both the buffered and the direct paths */
+        uint8_t data[1000];
+        memset( data, 'a', sizeof( data ) );
+
+        void* sha         = NULL;
+        uint32_t fed      = 0;
+        uint32_t chunk_id = 0;
+
+        xi_bsp_fwu_checksum_init( &sha );
+
+        while ( fed < 1000000 )
+        {
+            uint32_t len = ( chunk_id++ % 2 ) ? 997 : 7;
+
+            if ( 1000000 - fed < len )
+            {
+                len = 1000000 - fed;
+            }
+
+            xi_bsp_fwu_checksum_update( sha, data, len );
+            fed += len;
+        }
+
+        uint8_t* checksum     = NULL;
+        uint16_t checksum_len = 0;
+
+        xi_bsp_fwu_checksum_final( &sha, &checksum, &checksum_len );
+
+        tt_int_op( 32, ==, checksum_len );
+
+        uint8_t desired_hash[32] = {0xcd, 0xc7, 0x6e, 0x5c, 0x99, 0x14, 0xfb, 0x92,
+                                    0x81, 0xa1, 0xc7, 0xe2, 0x84, 0xd7, 0x3e, 0x67,
+                                    0xf1, 0x80, 0x9a, 0x48, 0xa4, 0x97, 0x20, 0x0e,
+                                    0x04, 0x6d, 0x39, 0xcc, 0xc7, 0x11, 0x2c, 0xd0};
+
+        tt_want_int_op( 0, ==, memcmp( checksum, desired_hash, 32 ) );
+    end:;
+    } )
+
 XI_TT_TESTGROUP_END
 
 #ifndef XI_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
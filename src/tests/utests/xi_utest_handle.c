@@ -10,7 +10,6 @@
 #include "xi_memory_checks.h"
 
 #include "xi_handle.h"
-#include "xi_vector.h"
 #include "xi_types.h"
 #include "xively.h"
 
@@ -20,18 +19,17 @@
 XI_TT_TESTGROUP_BEGIN( utest_handle )
 
 XI_TT_TESTCASE( utest__xi_object_for_handle__object_found, {
-    xi_vector_t* vector = xi_vector_create();
+    xi_handle_table_t* table = xi_handle_table_create( 5 );
 
     void* object = ( void* )( intptr_t )333;
-    xi_register_handle_for_object( vector, 5, object );
     xi_handle_t handle;
-    xi_find_handle_for_object( vector, object, &handle );
+    xi_register_handle_for_object( table, object, &handle );
 
-    void* object2 = xi_object_for_handle( vector, handle );
+    void* object2 = xi_object_for_handle( table, handle );
 
     tt_want_ptr_op( object, ==, object2 );
 
-    xi_vector_destroy( vector );
+    xi_handle_table_destroy( &table );
 
     tt_int_op( xi_is_whole_memory_deallocated(), >, 0 );
 end:;
@@ -39,135 +37,203 @@ end:;
 } )
 
 XI_TT_TESTCASE( utest__xi_object_for_handle__object_not_found, {
-    xi_vector_t* vector = xi_vector_create();
+    xi_handle_table_t* table = xi_handle_table_create( 5 );
 
     void* object = ( void* )( intptr_t )333;
-    xi_register_handle_for_object( vector, 5, object );
     xi_handle_t handle;
-    xi_find_handle_for_object( vector, object, &handle );
+    xi_register_handle_for_object( table, object, &handle );
     handle += 1;
 
-    xi_context_t* object2 = xi_object_for_handle( vector, handle );
+    xi_context_t* object2 = xi_object_for_handle( table, handle );
 
     tt_want_ptr_op( object, !=, object2 );
     tt_want_ptr_op( object2, ==, NULL );
+    tt_want_ptr_op( xi_object_for_handle( table, XI_INVALID_CONTEXT_HANDLE ), ==, NULL );
+    tt_want_ptr_op( xi_object_for_handle( table, 0 ), ==, NULL );
 
-    xi_vector_destroy( vector );
+    xi_handle_table_destroy( &table );
+
+    tt_int_op( xi_is_whole_memory_deallocated(), >, 0 );
+end:;
+} )
+
+XI_TT_TESTCASE( utest__xi_object_for_handle__stale_handle_of_reused_slot__not_found, {
+    xi_handle_table_t* table = xi_handle_table_create( 5 );
+
+    void* object        = ( void* )( intptr_t )333;
+    void* object2       = ( void* )( intptr_t )444;
+    xi_handle_t handle  = XI_INVALID_CONTEXT_HANDLE;
+    xi_handle_t handle2 = XI_INVALID_CONTEXT_HANDLE;
+
+    xi_register_handle_for_object( table, object, &handle );
+    tt_want_int_op( xi_delete_handle( table, handle ), ==, XI_STATE_OK );
+
+    /* the slot is reused by the next object */
+    xi_register_handle_for_object( table, object2, &handle2 );
+
+    tt_want_int_op( handle, !=, handle2 );
+    tt_want_ptr_op( xi_object_for_handle( table, handle ), ==, NULL );
+    tt_want_ptr_op( xi_object_for_handle( table, handle2 ), ==, object2 );
+    tt_want_int_op( xi_delete_handle( table, handle ), ==, XI_ELEMENT_NOT_FOUND );
+    tt_want_ptr_op( xi_object_for_handle( table, handle2 ), ==, object2 );
+
+    xi_handle_table_destroy( &table );
 
     tt_int_op( xi_is_whole_memory_deallocated(), >, 0 );
 end:;
 } )
 
 XI_TT_TESTCASE( utest__xi_find_handle_for_object__handle_found, {
-    xi_vector_t* vector = xi_vector_create();
+    xi_handle_table_t* table = xi_handle_table_create( 5 );
 
-    void* object = ( void* )( intptr_t )333;
-    xi_register_handle_for_object( vector, 5, object );
-    xi_handle_t handle = XI_INVALID_CONTEXT_HANDLE;
-    xi_state_t state   = xi_find_handle_for_object( vector, object, &handle );
+    void* object           = ( void* )( intptr_t )333;
+    xi_handle_t registered = XI_INVALID_CONTEXT_HANDLE;
+    xi_handle_t handle     = XI_INVALID_CONTEXT_HANDLE;
+    xi_register_handle_for_object( table, object, &registered );
+    xi_state_t state = xi_find_handle_for_object( table, object, &handle );
 
     tt_want_int_op( state, ==, XI_STATE_OK );
     tt_want_int_op( handle, >, XI_INVALID_CONTEXT_HANDLE );
+    tt_want_int_op( handle, ==, registered );
 
-    xi_vector_destroy( vector );
+    xi_handle_table_destroy( &table );
 
     tt_int_op( xi_is_whole_memory_deallocated(), >, 0 );
 end:;
 } )
 
 XI_TT_TESTCASE( utest__xi_find_handle_for_object__handle_not_found, {
-    xi_vector_t* vector = xi_vector_create();
+    xi_handle_table_t* table = xi_handle_table_create( 5 );
 
     void* object = ( void* )( intptr_t )333;
-    xi_register_handle_for_object( vector, 5, object );
+    xi_register_handle_for_object( table, object, NULL );
     xi_context_handle_t handle = XI_INVALID_CONTEXT_HANDLE;
     object           = ( intptr_t* )object + 1; // cast required to keep IAR happy
-    xi_state_t state = xi_find_handle_for_object( vector, object, &handle );
+    xi_state_t state = xi_find_handle_for_object( table, object, &handle );
 
     tt_want_int_op( state, ==, XI_ELEMENT_NOT_FOUND );
     tt_want_int_op( handle, ==, XI_INVALID_CONTEXT_HANDLE );
 
-    xi_vector_destroy( vector );
+    xi_handle_table_destroy( &table );
 
     tt_int_op( xi_is_whole_memory_deallocated(), >, 0 );
 end:;
 } )
 
-XI_TT_TESTCASE( utest__xi_delete_handle_for_object__delete_success_handle_not_found, {
-    xi_vector_t* vector = xi_vector_create();
+XI_TT_TESTCASE( utest__xi_delete_handle__delete_success_handle_not_found, {
+    xi_handle_table_t* table = xi_handle_table_create( 5 );
 
     void* object = ( void* )( intptr_t )333;
-    xi_register_handle_for_object( vector, 5, object );
+    xi_register_handle_for_object( table, object, NULL );
     xi_state_t state           = XI_STATE_OK;
     xi_context_handle_t handle = XI_INVALID_CONTEXT_HANDLE;
 
-    state = xi_find_handle_for_object( vector, object, &handle );
+    state = xi_find_handle_for_object( table, object, &handle );
     tt_want_int_op( state, ==, XI_STATE_OK );
     tt_want_int_op( handle, >, XI_INVALID_CONTEXT_HANDLE );
 
-    xi_state_t delete_state = xi_delete_handle_for_object( vector, object );
+    xi_state_t delete_state = xi_delete_handle( table, handle );
     tt_want_int_op( delete_state, ==, XI_STATE_OK );
 
-    state = xi_find_handle_for_object( vector, object, &handle );
+    state = xi_find_handle_for_object( table, object, &handle );
     tt_want_int_op( state, ==, XI_ELEMENT_NOT_FOUND );
     tt_want_int_op( handle, ==, XI_INVALID_CONTEXT_HANDLE );
 
-    xi_vector_destroy( vector );
+    xi_handle_table_destroy( &table );
 
     tt_int_op( xi_is_whole_memory_deallocated(), >, 0 );
 end:;
 } )
 
-XI_TT_TESTCASE( utest__xi_delete_handle_for_object__unsuccessful_delete, {
-    xi_vector_t* vector = xi_vector_create();
+XI_TT_TESTCASE( utest__xi_delete_handle__unsuccessful_delete, {
+    xi_handle_table_t* table = xi_handle_table_create( 5 );
 
-    void* unregistered_object = ( void* )( intptr_t )444;
-    xi_state_t delete_state = xi_delete_handle_for_object( vector, unregistered_object );
+    xi_state_t delete_state = xi_delete_handle( table, 444 );
 
     tt_want_int_op( delete_state, ==, XI_ELEMENT_NOT_FOUND );
 
-    xi_vector_destroy( vector );
+    xi_handle_table_destroy( &table );
 
     tt_int_op( xi_is_whole_memory_deallocated(), >, 0 );
 end:;
 } )
 
 XI_TT_TESTCASE( utest__xi_register_handle_for_object__successful_registration, {
-    xi_vector_t* vector = xi_vector_create();
+    xi_handle_table_t* table = xi_handle_table_create( 10 );
 
     int32_t max_num_contexts = 10;
     int i;
     for ( i = 0; i < max_num_contexts; ++i )
     {
-        void* object = ( void* )( intptr_t )222;
-        xi_state_t state =
-            xi_register_handle_for_object( vector, max_num_contexts, object );
+        void* object     = ( void* )( intptr_t )222;
+        xi_state_t state = xi_register_handle_for_object( table, object, NULL );
 
         tt_want_int_op( state, ==, XI_STATE_OK );
     }
 
-    xi_vector_destroy( vector );
+    xi_handle_table_destroy( &table );
 
     tt_int_op( xi_is_whole_memory_deallocated(), >, 0 );
 end:;
 } )
 
 XI_TT_TESTCASE( utest__xi_register_handle_for_object__unsuccessful_registration, {
-    xi_vector_t* vector = xi_vector_create();
+    xi_handle_table_t* table = xi_handle_table_create( 10 );
 
     int32_t max_num_contexts = 10;
     int i;
     for ( i = 0; i < max_num_contexts; ++i )
     {
         void* object = ( void* )( intptr_t )222;
-        xi_register_handle_for_object( vector, max_num_contexts, object );
+        xi_register_handle_for_object( table, object, NULL );
     }
 
     void* object     = ( void* )( intptr_t )333;
-    xi_state_t state = xi_register_handle_for_object( vector, max_num_contexts, object );
+    xi_state_t state = xi_register_handle_for_object( table, object, NULL );
     tt_want_int_op( state, ==, XI_NO_MORE_RESOURCE_AVAILABLE );
 
-    xi_vector_destroy( vector );
+    xi_handle_table_destroy( &table );
+
+    tt_int_op( xi_is_whole_memory_deallocated(), >, 0 );
+end:;
+} )
+
+XI_TT_TESTCASE( utest__xi_register_handle_for_object__thousands_of_objects__all_found, {
+    const int32_t objects_count = 4000;
+    xi_handle_table_t* table    = xi_handle_table_create( objects_count );
+    xi_handle_t handles[4000];
+    int32_t i = 0;
+
+    for ( ; i < objects_count; ++i )
+    {
+        tt_int_op( xi_register_handle_for_object( table, ( void* )( intptr_t )( i + 1 ),
+                                                  &handles[i] ),
+                   ==, XI_STATE_OK );
+    }
+
+    /* free every other slot and take them again */
+    for ( i = 0; i < objects_count; i += 2 )
+    {
+        tt_int_op( xi_delete_handle( table, handles[i] ), ==, XI_STATE_OK );
+    }
+
+    for ( i = 0; i < objects_count; i += 2 )
+    {
+        tt_ptr_op( xi_object_for_handle( table, handles[i] ), ==, NULL );
+        tt_int_op( xi_register_handle_for_object( table, ( void* )( intptr_t )( i + 1 ),
+                                                  &handles[i] ),
+                   ==, XI_STATE_OK );
+    }
+
+    for ( i = 0; i < objects_count; ++i )
+    {
+        tt_ptr_op( xi_object_for_handle( table, handles[i] ), ==,
+                   ( void* )( intptr_t )( i + 1 ) );
+    }
+
+    tt_int_op( table->slots_count, ==, objects_count );
+
+    xi_handle_table_destroy( &table );
 
     tt_int_op( xi_is_whole_memory_deallocated(), >, 0 );
 end:;
@@ -0,0 +1,181 @@
+/* Copyright (c) 2003-2018, Xively All rights reserved.
+ *
+ * This is part of the Xively C Client library,
+ * it is licensed under the BSD 3-Clause license.
+ */
+
+#include "tinytest.h"
+#include "tinytest_macros.h"
+#include "xi_tt_testcase_management.h"
+#include "xi_utest_basic_testcase_frame.h"
+
+#include "xi_io_net_capture.h"
+#include "xi_allocator.h"
+#include "xi_bsp_io_fs.h"
+#include "xi_macros.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#ifndef XI_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
+
+static const char* xi_utest_io_net_capture_name = "net_capture.utest_file";
+
+/* reads the whole capture file, the buffer is to be freed by the caller */
+static uint8_t* xi_utest_io_net_capture_read( size_t* size )
+{
+    xi_bsp_io_fs_resource_handle_t handle = XI_BSP_IO_FS_INVALID_RESOURCE_HANDLE;
+    xi_bsp_io_fs_stat_t stat              = {0};
+    uint8_t* recording                    = NULL;
+    const uint8_t* chunk                  = NULL;
+    size_t chunk_size                     = 0;
+
+    *size = 0;
+
+    if ( XI_BSP_IO_FS_STATE_OK !=
+             xi_bsp_io_fs_stat( xi_utest_io_net_capture_name, &stat ) ||
+         XI_BSP_IO_FS_STATE_OK != xi_bsp_io_fs_open( xi_utest_io_net_capture_name, 0,
+                                                      XI_BSP_IO_FS_OPEN_READ, &handle ) )
+    {
+        return NULL;
+    }
+
+    recording = ( uint8_t* )xi_alloc( stat.resource_size );
+
+    while ( NULL != recording && *size < stat.resource_size &&
+            XI_BSP_IO_FS_STATE_OK ==
+                xi_bsp_io_fs_read( handle, *size, &chunk, &chunk_size ) &&
+            0 < chunk_size )
+    {
+        chunk_size = XI_MIN( chunk_size, stat.resource_size - *size );
+        memcpy( recording + *size, chunk, chunk_size );
+        *size += chunk_size;
+    }
+
+    xi_bsp_io_fs_close( handle );
+
+    return recording;
+}
+
+#endif
+
+XI_TT_TESTGROUP_BEGIN( utest_io_net_capture )
+
+XI_TT_TESTCASE_WITH_SETUP(
+    utest__xi_io_net_capture_record__session_recorded__read_back_in_order,
+    xi_utest_setup_basic,
+    xi_utest_teardown_basic,
+    NULL,
+    {
+        xi_io_net_capture_record_t record;
+        size_t offset      = 0;
+        size_t size        = 0;
+        uint8_t* recording = NULL;
+
+        tt_int_op( xi_io_net_capture_start( xi_utest_io_net_capture_name ), ==,
+                   XI_STATE_OK );
+
+        const uint16_t session = xi_io_net_capture_begin_session( "localhost", 1883 );
+        tt_int_op( session, !=, 0 );
+
+        xi_io_net_capture_record( session, XI_IO_NET_CAPTURE_OUT,
+                                  ( const uint8_t* )"\x10\x02", 2 );
+        xi_io_net_capture_record( session, XI_IO_NET_CAPTURE_IN,
+                                  ( const uint8_t* )"\x20\x02\x00\x00", 4 );
+        xi_io_net_capture_record( session, XI_IO_NET_CAPTURE_CLOSE, NULL, 0 );
+
+        xi_io_net_capture_stop();
+
+        /* neither a stopped capture nor the session 0 records anything */
+        xi_io_net_capture_record( session, XI_IO_NET_CAPTURE_IN,
+                                  ( const uint8_t* )"\xd0\x00", 2 );
+        xi_io_net_capture_record( 0, XI_IO_NET_CAPTURE_IN, ( const uint8_t* )"\xd0\x00",
+                                  2 );
+
+        recording = xi_utest_io_net_capture_read( &size );
+        tt_ptr_op( recording, !=, NULL );
+
+        tt_int_op( xi_io_net_capture_next_record( recording, size, &offset, &record ),
+                   ==, XI_STATE_OK );
+        tt_int_op( record.type, ==, XI_IO_NET_CAPTURE_CONNECT );
+        tt_int_op( record.session, ==, session );
+        tt_int_op( record.length, ==, strlen( "localhost:1883" ) );
+        tt_int_op( memcmp( record.data, "localhost:1883", record.length ), ==, 0 );
+
+        tt_int_op( xi_io_net_capture_next_record( recording, size, &offset, &record ),
+                   ==, XI_STATE_OK );
+        tt_int_op( record.type, ==, XI_IO_NET_CAPTURE_OUT );
+        tt_int_op( record.length, ==, 2 );
+        tt_int_op( memcmp( record.data, "\x10\x02", 2 ), ==, 0 );
+
+        const uint32_t out_timestamp_ms = record.timestamp_ms;
+
+        tt_int_op( xi_io_net_capture_next_record( recording, size, &offset, &record ),
+                   ==, XI_STATE_OK );
+        tt_int_op( record.type, ==, XI_IO_NET_CAPTURE_IN );
+        tt_int_op( record.length, ==, 4 );
+        tt_int_op( memcmp( record.data, "\x20\x02\x00\x00", 4 ), ==, 0 );
+        tt_int_op( record.timestamp_ms, >=, out_timestamp_ms );
+
+        tt_int_op( xi_io_net_capture_next_record( recording, size, &offset, &record ),
+                   ==, XI_STATE_OK );
+        tt_int_op( record.type, ==, XI_IO_NET_CAPTURE_CLOSE );
+        tt_int_op( record.length, ==, 0 );
+
+        tt_int_op( xi_io_net_capture_next_record( recording, size, &offset, &record ),
+                   ==, XI_ELEMENT_NOT_FOUND );
+
+    end:
+        xi_io_net_capture_stop();
+        XI_SAFE_FREE( recording );
+        xi_bsp_io_fs_remove( xi_utest_io_net_capture_name );
+    } )
+
+XI_TT_TESTCASE_WITH_SETUP(
+    utest__xi_io_net_capture_begin_session__no_capture_running__returns_session_0,
+    xi_utest_setup_basic,
+    xi_utest_teardown_basic,
+    NULL,
+    {
+        tt_int_op( xi_io_net_capture_begin_session( "localhost", 1883 ), ==, 0 );
+
+    end:;
+    } )
+
+XI_TT_TESTCASE_WITH_SETUP(
+    utest__xi_io_net_capture_next_record__malformed_recording__invalid_parameter,
+    xi_utest_setup_basic,
+    xi_utest_teardown_basic,
+    NULL,
+    {
+        xi_io_net_capture_record_t record;
+        size_t offset = 0;
+
+        /* a record announcing 5 bytes of data with only 2 following */
+        const uint8_t truncated[] = {'X',  'I',  'N',  'E',  'T',  'C',  'A',  'P',
+                                     1,    3,    0x00, 0x01, 0x00, 0x00, 0x00, 0x00,
+                                     0x00, 0x00, 0x00, 0x05, 0x10, 0x02};
+
+        tt_int_op( xi_io_net_capture_next_record( truncated, sizeof( truncated ),
+                                                  &offset, &record ),
+                   ==, XI_INVALID_PARAMETER );
+
+        offset = 0;
+        tt_int_op( xi_io_net_capture_next_record( truncated, 8, &offset, &record ), ==,
+                   XI_INVALID_PARAMETER );
+
+        /* the header alone is an empty recording */
+        offset = 0;
+        tt_int_op( xi_io_net_capture_next_record( truncated, 9, &offset, &record ), ==,
+                   XI_ELEMENT_NOT_FOUND );
+
+    end:;
+    } )
+
+XI_TT_TESTGROUP_END
+
+#ifndef XI_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
+#define XI_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
+#include __FILE__
+#undef XI_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
+#endif
@@ -114,6 +114,8 @@ xi_utest_list_number_more_than_10_predicate( void* arg, xi_utest_list_t* elem, i
     return ( elem->value >= 10 );
 }
 
+#define XI_UTEST_LIST_GREATER( elem, val ) ( ( elem )->value > ( val ) )
+
 #endif
 
 XI_TT_TESTGROUP_BEGIN( utest_list )
@@ -239,6 +241,47 @@ XI_TT_TESTCASE_WITH_SETUP(
         xi_utest_destroy_list( more_10_list );
     } )
 
+XI_TT_TESTCASE_WITH_SETUP(
+    utest__xi_list_insert_before__ordered_list__order_kept,
+    xi_utest_setup_basic,
+    xi_utest_teardown_basic,
+    NULL,
+    {
+        xi_utest_list_t* test_list = xi_utest_make_test_list( 4 );
+        xi_utest_list_t* curr      = NULL;
+        xi_state_t state           = XI_STATE_OK;
+        int i                      = 0;
+
+        /* 0 1 2 3 becomes -1 0 1 1 2 3 4, the new 1 goes behind the old one */
+        const int values[]   = {1, 4, -1};
+        const int expected[] = {-1, 0, 1, 1, 2, 3, 4};
+
+        tt_ptr_op( test_list, !=, NULL );
+
+        xi_utest_list_t* const old_one = test_list->__next;
+
+        for ( i = 0; i < 3; ++i )
+        {
+            XI_ALLOC( xi_utest_list_t, elem, state );
+            elem->value = values[i];
+
+            XI_LIST_INSERT_BEFORE( xi_utest_list_t, test_list, XI_UTEST_LIST_GREATER,
+                                   values[i], elem );
+        }
+
+        for ( curr = test_list, i = 0; NULL != curr; curr = curr->__next, ++i )
+        {
+            tt_int_op( curr->value, ==, expected[i] );
+        }
+
+        tt_int_op( i, ==, 7 );
+        tt_ptr_op( test_list->__next->__next, ==, old_one );
+
+    err_handling:
+    end:
+        xi_utest_destroy_list( test_list );
+    } )
+
 XI_TT_TESTGROUP_END
 
 #ifndef XI_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
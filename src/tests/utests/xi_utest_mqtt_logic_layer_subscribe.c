@@ -43,7 +43,7 @@ static xi_state_t successful_subscribe_handler( xi_context_handle_t in_context_h
 
     tt_want_int_op( call_type, ==, XI_SUB_CALL_SUBACK );
     tt_want_int_op( state, ==, XI_MQTT_SUBSCRIPTION_SUCCESSFULL );
-    global_value_to_test = 1;
+    global_value_to_test += 1;
 
     return XI_STATE_OK;
 }
@@ -61,7 +61,7 @@ static xi_state_t failed_subscribe_handler( xi_context_handle_t in_context_handl
 
     tt_want_int_op( call_type, ==, XI_SUB_CALL_SUBACK );
     tt_want_int_op( state, ==, XI_MQTT_SUBSCRIPTION_FAILED );
-    global_value_to_test = 1;
+    global_value_to_test += 1;
 
     return XI_STATE_OK;
 }
@@ -134,7 +134,7 @@ XI_TT_TESTCASE_WITH_SETUP(
         // set the task data
         XI_ALLOC_AT( xi_mqtt_logic_task_t, task, local_state );
 
-        task->cs = 111; // this is very hakish since it depends on the code
+        task->cs = 122; // this is very hakish since it depends on the code
         // so most probably this test will fail everytime we change anything in
         // tested function which is not too good at least you know what to check
         // if the test fails
@@ -233,7 +233,7 @@ XI_TT_TESTCASE_WITH_SETUP(
         // set the task data
         XI_ALLOC_AT( xi_mqtt_logic_task_t, task, local_state );
 
-        task->cs = 111; // this is very hakish since it depends on the code
+        task->cs = 122; // this is very hakish since it depends on the code
         // so most probably this test will fail everytime we change anything in
         // tested function which is not too good at least you know what to check
         // if the test fails
@@ -299,6 +299,114 @@ XI_TT_TESTCASE_WITH_SETUP(
         xi_delete_context( xi_context_handle );
         tt_int_op( xi_is_whole_memory_deallocated(), >, 0 );
     } )
+
+XI_TT_TESTCASE_WITH_SETUP(
+    utest__do_mqtt_subscribe__two_topics_in_one_suback__each_handler_gets_its_result,
+    xi_utest_setup_basic,
+    xi_utest_teardown_basic,
+    NULL,
+    {
+        xi_state_t local_state = XI_STATE_OK;
+
+        xi_context_handle_t xi_context_handle = xi_create_context();
+        if ( XI_INVALID_CONTEXT_HANDLE >= xi_context_handle )
+        {
+            tt_fail_msg( "Failed to create context!" );
+            return;
+        }
+
+        xi_mqtt_logic_task_t* task = 0;
+        xi_mqtt_message_t* msg     = 0;
+
+        xi_context_t* xi_context =
+            xi_object_for_handle( xi_globals.context_handles_vector, xi_context_handle );
+        tt_assert( NULL != xi_context );
+
+        XI_ALLOC_AT( xi_mqtt_logic_task_t, task, local_state );
+
+        task->cs = 122; // the same dependency on the code as in the tests above
+
+        xi_evtd_execute_in(
+            xi_globals.evtd_instance,
+            xi_make_handle( &do_mqtt_subscribe, 0, &task, XI_STATE_TIMEOUT, 0 ), 10,
+            &task->timeout );
+
+        task->data.mqtt_settings.scenario = XI_MQTT_SUBSCRIBE;
+        task->data.mqtt_settings.qos      = XI_MQTT_QOS_AT_LEAST_ONCE;
+
+        // the batch: the first topic is granted, the second one refused
+        XI_ALLOC_AT( xi_mqtt_task_specific_data_t, task->data.data_u, local_state );
+        XI_ALLOC_AT( xi_mqtt_task_specific_data_t, task->data.data_u->subscribe.next,
+                     local_state );
+        xi_mqtt_task_specific_data_t* granted = task->data.data_u;
+        xi_mqtt_task_specific_data_t* refused = task->data.data_u->subscribe.next;
+
+        granted->subscribe.handler = xi_make_threaded_handle(
+            XI_THREADID_THREAD_0, &xi_user_sub_call_wrapper, xi_context, NULL,
+            XI_STATE_OK, ( void* )&successful_subscribe_handler, ( void* )NULL,
+            ( void* )granted );
+
+        refused->subscribe.handler = xi_make_threaded_handle(
+            XI_THREADID_THREAD_0, &xi_user_sub_call_wrapper, xi_context, NULL,
+            XI_STATE_OK, ( void* )&failed_subscribe_handler, ( void* )NULL,
+            ( void* )refused );
+
+        XI_ALLOC_AT( xi_mqtt_message_t, msg, local_state );
+
+        msg->common.common_u.common_bits.type = XI_MQTT_TYPE_SUBACK;
+        XI_ALLOC_AT( xi_mqtt_topicpair_t, msg->suback.topics, local_state );
+        msg->suback.topics->xi_mqtt_topic_pair_payload_u.status = XI_MQTT_QOS_0_GRANTED;
+        XI_ALLOC_AT( xi_mqtt_topicpair_t, msg->suback.topics->next, local_state );
+        msg->suback.topics->next->xi_mqtt_topic_pair_payload_u.status =
+            XI_MQTT_SUBACK_FAILED;
+
+        xi_mqtt_logic_layer_data_t logic_layer_data;
+        memset( &logic_layer_data, 0, sizeof( xi_mqtt_logic_layer_data_t ) );
+
+        logic_layer_data.q12_tasks_queue = task;
+
+        logic_layer_data.handlers_for_topics = xi_vector_create();
+
+        xi_layer_t* layer = xi_context->layer_chain.bottom;
+        layer->user_data  = &logic_layer_data;
+
+        tt_want_int_op(
+            do_mqtt_subscribe( &layer->layer_connection, task, XI_STATE_OK, msg ), ==,
+            XI_STATE_OK );
+
+        // only the granted topic filter is registered and it is detached from the batch
+        tt_want_int_op( logic_layer_data.handlers_for_topics->elem_no, ==, 1 );
+        tt_want_ptr_op(
+            logic_layer_data.handlers_for_topics->array[0].selector_t.ptr_value, ==,
+            granted );
+        tt_want_ptr_op( granted->subscribe.next, ==, NULL );
+
+        // both handlers are called, the refused one releases its data
+        xi_evtd_step( xi_globals.evtd_instance, 20 );
+
+        tt_want_int_op( global_value_to_test, ==, 2 );
+        global_value_to_test = 0;
+
+        XI_SAFE_FREE( granted );
+        xi_vector_del( logic_layer_data.handlers_for_topics, 0 );
+
+        logic_layer_data.handlers_for_topics =
+            xi_vector_destroy( logic_layer_data.handlers_for_topics );
+
+        xi_delete_context( xi_context_handle );
+
+        return;
+
+    err_handling:
+        tt_abort_msg( "test should not fail" );
+    end:
+        if ( task != 0 )
+            xi_mqtt_logic_free_task( &task );
+        xi_mqtt_message_free( &msg );
+        xi_delete_context( xi_context_handle );
+        tt_int_op( xi_is_whole_memory_deallocated(), >, 0 );
+    } )
+
 XI_TT_TESTGROUP_END
 
 #ifndef XI_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
@@ -24,6 +24,25 @@
 
 #ifndef XI_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
 
+/* runs the parser over a whole message, the message is allocated for the caller */
+static xi_state_t
+utest_mqtt_parse( uint8_t* bytes, size_t bytes_length, xi_mqtt_message_t** out )
+{
+    xi_state_t local_state = XI_STATE_OK;
+    xi_mqtt_parser_t parser;
+    xi_data_desc_t data_desc = {bytes, NULL, bytes_length, bytes_length, 0,
+                                XI_MEMORY_TYPE_UNMANAGED};
+
+    xi_mqtt_parser_init( &parser );
+
+    XI_ALLOC_AT( xi_mqtt_message_t, *out, local_state );
+
+    local_state = xi_mqtt_parser_execute( &parser, *out, &data_desc );
+
+err_handling:
+    return local_state;
+}
+
 #endif
 
 XI_TT_TESTGROUP_BEGIN( utest_mqtt_parser )
@@ -88,6 +107,133 @@ XI_TT_TESTCASE( utest__parse_suback_response__invalid_data__parser_error, {
     tt_want_int_op( xi_is_whole_memory_deallocated(), >, 0 );
 } )
 
+XI_TT_TESTCASE( utest__parser_execute__suback_with_three_codes__status_per_topic, {
+    uint8_t bytes[] = {0x90, 0x05, 0x00, 0x0A, 0x00, 0x01, 0x80};
+
+    xi_mqtt_message_t* msg = NULL;
+
+    tt_want_int_op( utest_mqtt_parse( bytes, sizeof( bytes ), &msg ), ==, XI_STATE_OK );
+    tt_want_int_op( xi_mqtt_get_message_id( msg ), ==, 10 );
+
+    xi_mqtt_topicpair_t* topic = msg->suback.topics;
+
+    tt_want_int_op( topic->xi_mqtt_topic_pair_payload_u.status, ==,
+                    XI_MQTT_QOS_0_GRANTED );
+    topic = topic->next;
+    tt_want_int_op( topic->xi_mqtt_topic_pair_payload_u.status, ==,
+                    XI_MQTT_QOS_1_GRANTED );
+    topic = topic->next;
+    tt_want_int_op( topic->xi_mqtt_topic_pair_payload_u.status, ==,
+                    XI_MQTT_SUBACK_FAILED );
+    tt_want_ptr_op( topic->next, ==, NULL );
+
+    xi_mqtt_message_free( &msg );
+
+    tt_want_int_op( xi_is_whole_memory_deallocated(), >, 0 );
+} )
+
+XI_TT_TESTCASE( utest__parser_execute__subscribe_with_two_topics__topics_in_order, {
+    uint8_t bytes[] = {0x82, 0x0C, 0x00, 0x01, 0x00, 0x03, 'a',
+                       '/',  'b',  0x01, 0x00, 0x01, 'c',  0x00};
+
+    xi_mqtt_message_t* msg = NULL;
+
+    tt_want_int_op( utest_mqtt_parse( bytes, sizeof( bytes ), &msg ), ==, XI_STATE_OK );
+    tt_want_int_op( xi_mqtt_get_message_id( msg ), ==, 1 );
+
+    xi_mqtt_topicpair_t* topic = msg->subscribe.topics;
+
+    tt_want_int_op( memcmp( topic->name->data_ptr, "a/b", 3 ), ==, 0 );
+    tt_want_int_op( topic->xi_mqtt_topic_pair_payload_u.qos, ==,
+                    XI_MQTT_QOS_AT_LEAST_ONCE );
+    topic = topic->next;
+    tt_want_int_op( memcmp( topic->name->data_ptr, "c", 1 ), ==, 0 );
+    tt_want_int_op( topic->xi_mqtt_topic_pair_payload_u.qos, ==,
+                    XI_MQTT_QOS_AT_MOST_ONCE );
+    tt_want_ptr_op( topic->next, ==, NULL );
+
+    xi_mqtt_message_free( &msg );
+
+    tt_want_int_op( xi_is_whole_memory_deallocated(), >, 0 );
+} )
+
+XI_TT_TESTCASE( utest__parser_execute__unsubscribe_and_unsuback__message_ids_parsed, {
+    uint8_t unsubscribe_bytes[] = {0xA2, 0x0A, 0x00, 0x02, 0x00, 0x03, 'a',
+                                   '/',  'b',  0x00, 0x01, 'c'};
+    uint8_t unsuback_bytes[] = {0xB0, 0x02, 0x00, 0x02};
+
+    xi_mqtt_message_t* msg = NULL;
+
+    tt_want_int_op(
+        utest_mqtt_parse( unsubscribe_bytes, sizeof( unsubscribe_bytes ), &msg ), ==,
+        XI_STATE_OK );
+    tt_want_int_op( xi_mqtt_get_message_id( msg ), ==, 2 );
+    tt_want_int_op( memcmp( msg->unsubscribe.topics->name->data_ptr, "a/b", 3 ), ==, 0 );
+    tt_want_int_op( memcmp( msg->unsubscribe.topics->next->name->data_ptr, "c", 1 ), ==,
+                    0 );
+
+    xi_mqtt_message_free( &msg );
+
+    tt_want_int_op( utest_mqtt_parse( unsuback_bytes, sizeof( unsuback_bytes ), &msg ),
+                    ==, XI_STATE_OK );
+    tt_want_int_op( msg->common.common_u.common_bits.type, ==, XI_MQTT_TYPE_UNSUBACK );
+    tt_want_int_op( xi_mqtt_get_message_id( msg ), ==, 2 );
+
+    xi_mqtt_message_free( &msg );
+
+    tt_want_int_op( xi_is_whole_memory_deallocated(), >, 0 );
+} )
+
+XI_TT_TESTCASE( utest__parser_execute__two_parsers_interleaved__both_payloads_complete, {
+    /* PUBLISH "t" with the payload "payload" split in the middle of the payload */
+    uint8_t bytes[] = {0x30, 0x0A, 0x00, 0x01, 't', 'p', 'a', 'y', 'l', 'o', 'a', 'd'};
+    const size_t split = 7;
+
+    xi_state_t local_state = XI_STATE_OK;
+    xi_mqtt_parser_t parsers[2];
+    xi_mqtt_message_t* msgs[2] = {NULL, NULL};
+    xi_data_desc_t heads[2];
+    xi_data_desc_t tails[2];
+    int i = 0;
+
+    for ( i = 0; i < 2; ++i )
+    {
+        xi_data_desc_t head = {bytes, NULL, split, split, 0, XI_MEMORY_TYPE_UNMANAGED};
+        xi_data_desc_t tail = {bytes + split, NULL, sizeof( bytes ) - split,
+                               sizeof( bytes ) - split, 0, XI_MEMORY_TYPE_UNMANAGED};
+
+        heads[i] = head;
+        tails[i] = tail;
+
+        xi_mqtt_parser_init( &parsers[i] );
+        XI_ALLOC_AT( xi_mqtt_message_t, msgs[i], local_state );
+    }
+
+    /* the first parser completes while the second one still waits for its tail */
+    tt_want_int_op( xi_mqtt_parser_execute( &parsers[0], msgs[0], &heads[0] ), ==,
+                    XI_STATE_WANT_READ );
+    tt_want_int_op( xi_mqtt_parser_execute( &parsers[1], msgs[1], &heads[1] ), ==,
+                    XI_STATE_WANT_READ );
+    tt_want_int_op( xi_mqtt_parser_execute( &parsers[0], msgs[0], &tails[0] ), ==,
+                    XI_STATE_OK );
+    tt_want_int_op( xi_mqtt_parser_execute( &parsers[1], msgs[1], &tails[1] ), ==,
+                    XI_STATE_OK );
+
+    for ( i = 0; i < 2; ++i )
+    {
+        tt_want_int_op( tails[i].curr_pos, ==, tails[i].length );
+        tt_want_int_op( msgs[i]->publish.content->length, ==, 7 );
+        tt_want_int_op( memcmp( msgs[i]->publish.content->data_ptr, "payload", 7 ), ==,
+                        0 );
+    }
+
+err_handling:
+    xi_mqtt_message_free( &msgs[0] );
+    xi_mqtt_message_free( &msgs[1] );
+
+    tt_want_int_op( xi_is_whole_memory_deallocated(), >, 0 );
+} )
+
 XI_TT_TESTGROUP_END
 
 #ifndef XI_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
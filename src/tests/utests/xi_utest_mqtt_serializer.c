@@ -13,6 +13,7 @@
 #include "xi_helpers.h"
 #include "xi_globals.h"
 #include "xi_mqtt_serialiser.h"
+#include "xi_mqtt_logic_layer_data_helpers.h"
 
 #include "xi_memory_checks.h"
 
@@ -122,6 +123,35 @@ end:
 err_handling:;
 }
 
+/* serializes the message and compares it with the reference bytes */
+static void utest_mqtt_serialize_and_compare( xi_mqtt_message_t* msg,
+                                              const uint8_t* reference,
+                                              size_t reference_length )
+{
+    xi_state_t local_state = XI_STATE_OK;
+    xi_data_desc_t* buffer = NULL;
+
+    size_t message_len, remaining_len, payload_size = 0;
+    local_state =
+        xi_mqtt_serialiser_size( &message_len, &remaining_len, &payload_size, NULL, msg );
+
+    tt_int_op( local_state, ==, XI_STATE_OK );
+    tt_int_op( message_len, ==, reference_length );
+    tt_int_op( remaining_len, ==, reference_length - 2 );
+
+    buffer = xi_make_empty_desc_alloc( message_len );
+    XI_CHECK_MEMORY( buffer, local_state );
+
+    tt_int_op( xi_mqtt_serialiser_write( NULL, msg, buffer, message_len, remaining_len ),
+               ==, XI_MQTT_SERIALISER_RC_SUCCESS );
+    tt_int_op( buffer->length, ==, reference_length );
+    tt_int_op( memcmp( buffer->data_ptr, reference, reference_length ), ==, 0 );
+
+end:
+err_handling:
+    xi_free_desc( &buffer );
+}
+
 #endif
 
 XI_TT_TESTGROUP_BEGIN( utest_mqtt_serializer )
@@ -130,6 +160,50 @@ XI_TT_TESTCASE( utest__serialize_publish__valid_data_border_case__size_is_correc
     utest__serialize_publish__valid_data_border_case__size_is_correct_impl();
 } )
 
+XI_TT_TESTCASE( utest__serialize_subscribe__two_topics__one_message_with_both, {
+    const uint8_t reference[] = {0x82, 0x0C, 0x00, 0x01, 0x00, 0x03, 'a',
+                                 '/',  'b',  0x01, 0x00, 0x01, 'c',  0x00};
+
+    xi_mqtt_message_t* msg = NULL;
+    xi_state_t local_state = XI_STATE_OK;
+
+    XI_ALLOC_AT( xi_mqtt_message_t, msg, local_state );
+
+    tt_want_int_op( fill_with_subscribe_data( msg, "a/b", 1, XI_MQTT_QOS_AT_LEAST_ONCE,
+                                              XI_MQTT_DUP_FALSE ),
+                    ==, XI_STATE_OK );
+    tt_want_int_op( append_subscribe_topic( msg, "c", XI_MQTT_QOS_AT_MOST_ONCE ), ==,
+                    XI_STATE_OK );
+
+    utest_mqtt_serialize_and_compare( msg, reference, sizeof( reference ) );
+
+err_handling:
+    xi_mqtt_message_free( &msg );
+
+    tt_want_int_op( xi_is_whole_memory_deallocated(), >, 0 );
+} )
+
+XI_TT_TESTCASE( utest__serialize_unsubscribe__two_topics__one_message_with_both, {
+    const uint8_t reference[] = {0xA2, 0x0A, 0x00, 0x02, 0x00, 0x03,
+                                 'a',  '/',  'b',  0x00, 0x01, 'c'};
+
+    xi_mqtt_message_t* msg = NULL;
+    xi_state_t local_state = XI_STATE_OK;
+
+    XI_ALLOC_AT( xi_mqtt_message_t, msg, local_state );
+
+    tt_want_int_op( fill_with_unsubscribe_data( msg, "a/b", 2, XI_MQTT_DUP_FALSE ), ==,
+                    XI_STATE_OK );
+    tt_want_int_op( append_unsubscribe_topic( msg, "c" ), ==, XI_STATE_OK );
+
+    utest_mqtt_serialize_and_compare( msg, reference, sizeof( reference ) );
+
+err_handling:
+    xi_mqtt_message_free( &msg );
+
+    tt_want_int_op( xi_is_whole_memory_deallocated(), >, 0 );
+} )
+
 XI_TT_TESTGROUP_END
 
 #ifndef XI_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
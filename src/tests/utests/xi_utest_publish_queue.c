@@ -0,0 +1,474 @@
+/* Copyright (c) 2003-2018, Xively All rights reserved.
+ *
+ * This is part of the Xively C Client library,
+ * it is licensed under the BSD 3-Clause license.
+ */
+
+#include "tinytest.h"
+#include "tinytest_macros.h"
+#include "xi_tt_testcase_management.h"
+#include "xi_utest_basic_testcase_frame.h"
+
+#include "xi_publish_queue.h"
+#include "xi_event_dispatcher_api.h"
+#include "xi_internals.h"
+#include "xi_macros.h"
+
+#include <string.h>
+
+#ifndef XI_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
+
+static const char* xi_utest_publish_queue_spool_name = "publish_queue.utest_file";
+
+typedef struct xi_utest_publish_queue_result_s
+{
+    int calls;
+    xi_state_t state;
+} xi_utest_publish_queue_result_t;
+
+static xi_state_t
+xi_utest_publish_queue_on_done( void* result, void* unused, xi_state_t state )
+{
+    XI_UNUSED( unused );
+
+    ( ( xi_utest_publish_queue_result_t* )result )->calls += 1;
+    ( ( xi_utest_publish_queue_result_t* )result )->state = state;
+
+    return XI_STATE_OK;
+}
+
+static xi_event_handle_t
+xi_utest_publish_queue_make_callback( xi_utest_publish_queue_result_t* result )
+{
+    return xi_make_handle( &xi_utest_publish_queue_on_done, result, NULL, XI_STATE_OK );
+}
+
+static xi_state_t
+xi_utest_publish_queue_push_with_priority( xi_publish_queue_t* queue,
+                                           const char* topic,
+                                           const char* msg,
+                                           const xi_publish_priority_t priority,
+                                           xi_event_handle_t callback )
+{
+    return xi_publish_queue_push( queue, topic, xi_make_desc_from_string_copy( msg ),
+                                  XI_MQTT_QOS_AT_LEAST_ONCE, XI_MQTT_RETAIN_FALSE,
+                                  priority, callback );
+}
+
+static xi_state_t xi_utest_publish_queue_push_string( xi_publish_queue_t* queue,
+                                                      const char* topic,
+                                                      const char* msg,
+                                                      xi_event_handle_t callback )
+{
+    return xi_utest_publish_queue_push_with_priority(
+        queue, topic, msg, XI_PUBLISH_PRIORITY_NORMAL, callback );
+}
+
+/* pops one entry and compares it with the expected topic and payload */
+static int xi_utest_publish_queue_pop_matches( xi_publish_queue_t* queue,
+                                               const char* topic,
+                                               const char* msg )
+{
+    xi_publish_queue_entry_t* entry = xi_publish_queue_pop( queue );
+
+    const int matches = NULL != entry && 0 == strcmp( entry->topic, topic ) &&
+                        entry->data->length == strlen( msg ) &&
+                        0 == memcmp( entry->data->data_ptr, msg, strlen( msg ) ) &&
+                        XI_MQTT_QOS_AT_LEAST_ONCE == entry->qos;
+
+    xi_publish_queue_free_entry( &entry );
+
+    return matches;
+}
+
+#endif
+
+XI_TT_TESTGROUP_BEGIN( utest_publish_queue )
+
+XI_TT_TESTCASE_WITH_SETUP(
+    utest__xi_publish_queue_push_pop__three_messages__fifo_order_and_stats,
+    xi_utest_setup_basic,
+    xi_utest_teardown_basic,
+    NULL,
+    {
+        xi_evtd_instance_t* evtd  = xi_evtd_create_instance();
+        xi_publish_queue_t* queue = xi_publish_queue_create(
+            evtd, xi_make_empty_handle(), 10, 0, 0, NULL );
+
+        tt_ptr_op( queue, !=, NULL );
+        tt_int_op( xi_publish_queue_is_empty( queue ), ==, 1 );
+
+        tt_int_op( xi_utest_publish_queue_push_string( queue, "t1", "a",
+                                                       xi_make_empty_handle() ),
+                   ==, XI_STATE_OK );
+        tt_int_op( xi_utest_publish_queue_push_string( queue, "t2", "bb",
+                                                       xi_make_empty_handle() ),
+                   ==, XI_STATE_OK );
+        tt_int_op( xi_utest_publish_queue_push_string( queue, "t3", "ccc",
+                                                       xi_make_empty_handle() ),
+                   ==, XI_STATE_OK );
+
+        tt_int_op( queue->stats.queued_messages, ==, 3 );
+        tt_int_op( queue->stats.queued_bytes, ==, 6 );
+        tt_int_op( queue->stats.dropped_messages, ==, 0 );
+
+        tt_int_op( xi_utest_publish_queue_pop_matches( queue, "t1", "a" ), ==, 1 );
+        tt_int_op( xi_utest_publish_queue_pop_matches( queue, "t2", "bb" ), ==, 1 );
+        tt_int_op( xi_utest_publish_queue_pop_matches( queue, "t3", "ccc" ), ==, 1 );
+
+        tt_ptr_op( xi_publish_queue_pop( queue ), ==, NULL );
+        tt_int_op( queue->stats.queued_messages, ==, 0 );
+        tt_int_op( queue->stats.queued_bytes, ==, 0 );
+
+    end:
+        xi_publish_queue_destroy( &queue );
+        xi_evtd_destroy_instance( evtd );
+    } )
+
+XI_TT_TESTCASE_WITH_SETUP(
+    utest__xi_publish_queue_push__queue_full__oldest_dropped_and_notified,
+    xi_utest_setup_basic,
+    xi_utest_teardown_basic,
+    NULL,
+    {
+        xi_utest_publish_queue_result_t result = {0, XI_STATE_OK};
+
+        xi_evtd_instance_t* evtd  = xi_evtd_create_instance();
+        xi_publish_queue_t* queue = xi_publish_queue_create(
+            evtd, xi_make_empty_handle(), 2, 0, 0, NULL );
+
+        tt_ptr_op( queue, !=, NULL );
+
+        xi_utest_publish_queue_push_string(
+            queue, "t1", "a", xi_utest_publish_queue_make_callback( &result ) );
+        xi_utest_publish_queue_push_string( queue, "t2", "b", xi_make_empty_handle() );
+        xi_utest_publish_queue_push_string( queue, "t3", "c", xi_make_empty_handle() );
+
+        tt_int_op( queue->stats.queued_messages, ==, 2 );
+        tt_int_op( queue->stats.dropped_messages, ==, 1 );
+
+        xi_evtd_step( evtd, 0 );
+
+        tt_int_op( result.calls, ==, 1 );
+        tt_int_op( result.state, ==, XI_BACKOFF_TERMINAL );
+
+        tt_int_op( xi_utest_publish_queue_pop_matches( queue, "t2", "b" ), ==, 1 );
+        tt_int_op( xi_utest_publish_queue_pop_matches( queue, "t3", "c" ), ==, 1 );
+
+    end:
+        xi_publish_queue_destroy( &queue );
+        xi_evtd_destroy_instance( evtd );
+    } )
+
+XI_TT_TESTCASE_WITH_SETUP(
+    utest__xi_publish_queue_push__message_over_byte_limit__message_dropped,
+    xi_utest_setup_basic,
+    xi_utest_teardown_basic,
+    NULL,
+    {
+        xi_evtd_instance_t* evtd  = xi_evtd_create_instance();
+        xi_publish_queue_t* queue = xi_publish_queue_create(
+            evtd, xi_make_empty_handle(), 10, 4, 0, NULL );
+
+        tt_ptr_op( queue, !=, NULL );
+
+        xi_utest_publish_queue_push_string( queue, "t1", "abc", xi_make_empty_handle() );
+        xi_utest_publish_queue_push_string( queue, "t2", "too long",
+                                            xi_make_empty_handle() );
+
+        /* nothing can make room for the second message so only that one is lost */
+        tt_int_op( queue->stats.dropped_messages, ==, 1 );
+        tt_int_op( queue->stats.queued_messages, ==, 1 );
+
+        /* this one fits after the oldest is evicted */
+        xi_utest_publish_queue_push_string( queue, "t3", "ab", xi_make_empty_handle() );
+        xi_utest_publish_queue_push_string( queue, "t4", "cd", xi_make_empty_handle() );
+
+        tt_int_op( queue->stats.dropped_messages, ==, 2 );
+        tt_int_op( queue->stats.queued_messages, ==, 2 );
+        tt_int_op( queue->stats.queued_bytes, ==, 4 );
+
+        tt_int_op( xi_utest_publish_queue_pop_matches( queue, "t3", "ab" ), ==, 1 );
+        tt_int_op( xi_utest_publish_queue_pop_matches( queue, "t4", "cd" ), ==, 1 );
+
+    end:
+        xi_publish_queue_destroy( &queue );
+        xi_evtd_destroy_instance( evtd );
+    } )
+
+XI_TT_TESTCASE_WITH_SETUP(
+    utest__xi_publish_queue_push_pop__mixed_priorities__class_order_and_lowest_dropped,
+    xi_utest_setup_basic,
+    xi_utest_teardown_basic,
+    NULL,
+    {
+        xi_utest_publish_queue_result_t result = {0, XI_STATE_OK};
+
+        xi_evtd_instance_t* evtd  = xi_evtd_create_instance();
+        xi_publish_queue_t* queue = xi_publish_queue_create(
+            evtd, xi_make_empty_handle(), 3, 0, 0, NULL );
+
+        tt_ptr_op( queue, !=, NULL );
+
+        xi_utest_publish_queue_push_with_priority( queue, "b1", "a",
+                                                   XI_PUBLISH_PRIORITY_BULK,
+                                                   xi_make_empty_handle() );
+        xi_utest_publish_queue_push_with_priority(
+            queue, "b2", "b", XI_PUBLISH_PRIORITY_BULK,
+            xi_utest_publish_queue_make_callback( &result ) );
+        xi_utest_publish_queue_push_with_priority( queue, "a1", "c",
+                                                   XI_PUBLISH_PRIORITY_ALARM,
+                                                   xi_make_empty_handle() );
+
+        /* the oldest bulk message makes room for the normal one */
+        xi_utest_publish_queue_push_with_priority( queue, "n1", "d",
+                                                   XI_PUBLISH_PRIORITY_NORMAL,
+                                                   xi_make_empty_handle() );
+
+        tt_int_op( queue->stats.queued_messages, ==, 3 );
+        tt_int_op( queue->stats.dropped_messages, ==, 1 );
+
+        /* the remaining bulk one goes for the next alarm, a bulk one has no room */
+        xi_utest_publish_queue_push_with_priority( queue, "a2", "e",
+                                                   XI_PUBLISH_PRIORITY_ALARM,
+                                                   xi_make_empty_handle() );
+        xi_utest_publish_queue_push_with_priority( queue, "b3", "f",
+                                                   XI_PUBLISH_PRIORITY_BULK,
+                                                   xi_make_empty_handle() );
+
+        tt_int_op( queue->stats.queued_messages, ==, 3 );
+        tt_int_op( queue->stats.dropped_messages, ==, 3 );
+
+        xi_evtd_step( evtd, 0 );
+
+        tt_int_op( result.calls, ==, 1 );
+        tt_int_op( result.state, ==, XI_BACKOFF_TERMINAL );
+
+        tt_int_op( xi_utest_publish_queue_pop_matches( queue, "a1", "c" ), ==, 1 );
+        tt_int_op( xi_utest_publish_queue_pop_matches( queue, "a2", "e" ), ==, 1 );
+        tt_int_op( xi_utest_publish_queue_pop_matches( queue, "n1", "d" ), ==, 1 );
+
+        tt_ptr_op( xi_publish_queue_pop( queue ), ==, NULL );
+
+    end:
+        xi_publish_queue_destroy( &queue );
+        xi_evtd_destroy_instance( evtd );
+    } )
+
+#ifdef XI_FS_POSIX
+XI_TT_TESTCASE_WITH_SETUP(
+    utest__xi_publish_queue_push_pop__ram_full__overflow_spooled_in_order,
+    xi_utest_setup_basic,
+    xi_utest_teardown_basic,
+    NULL,
+    {
+        xi_utest_publish_queue_result_t result = {0, XI_BACKOFF_TERMINAL};
+        xi_fs_stat_t resource_stat             = {.resource_size = 0};
+
+        xi_evtd_instance_t* evtd  = xi_evtd_create_instance();
+        xi_publish_queue_t* queue = xi_publish_queue_create(
+            evtd, xi_make_empty_handle(), 2, 0, 0, xi_utest_publish_queue_spool_name );
+
+        tt_ptr_op( queue, !=, NULL );
+
+        xi_utest_publish_queue_push_string( queue, "t1", "m1", xi_make_empty_handle() );
+        xi_utest_publish_queue_push_string( queue, "t2", "m2", xi_make_empty_handle() );
+        xi_utest_publish_queue_push_string(
+            queue, "t3", "m3", xi_utest_publish_queue_make_callback( &result ) );
+        xi_utest_publish_queue_push_string( queue, "t4", "m4", xi_make_empty_handle() );
+
+        tt_int_op( queue->stats.queued_messages, ==, 2 );
+        tt_int_op( queue->stats.spooled_messages, ==, 2 );
+        tt_int_op( queue->stats.spooled_bytes, ==,
+                   2 * ( XI_PUBLISH_QUEUE_SPOOL_HEADER_SIZE + 4 ) );
+        tt_int_op( queue->stats.dropped_messages, ==, 0 );
+
+        /* spooled message is reported as delivered to the spool */
+        xi_evtd_step( evtd, 0 );
+        tt_int_op( result.calls, ==, 1 );
+        tt_int_op( result.state, ==, XI_STATE_OK );
+
+        tt_int_op( xi_utest_publish_queue_pop_matches( queue, "t1", "m1" ), ==, 1 );
+        tt_int_op( xi_utest_publish_queue_pop_matches( queue, "t2", "m2" ), ==, 1 );
+
+        /* while the spool is read new messages are newer than the spooled ones */
+        xi_utest_publish_queue_push_string( queue, "t5", "m5", xi_make_empty_handle() );
+
+        tt_int_op( xi_utest_publish_queue_pop_matches( queue, "t3", "m3" ), ==, 1 );
+        tt_int_op( xi_utest_publish_queue_pop_matches( queue, "t4", "m4" ), ==, 1 );
+        tt_int_op( xi_utest_publish_queue_pop_matches( queue, "t5", "m5" ), ==, 1 );
+
+        tt_int_op( xi_publish_queue_is_empty( queue ), ==, 1 );
+        tt_int_op( queue->stats.spooled_messages, ==, 0 );
+
+        /* a fully drained spool is removed */
+        tt_int_op( xi_internals.fs_functions.stat_resource(
+                       NULL, XI_FS_CONFIG_DATA, xi_utest_publish_queue_spool_name,
+                       &resource_stat ),
+                   !=, XI_STATE_OK );
+
+    end:
+        xi_publish_queue_destroy( &queue );
+        xi_evtd_destroy_instance( evtd );
+    } )
+
+XI_TT_TESTCASE_WITH_SETUP(
+    utest__xi_publish_queue_push__spool_in_use_and_full__new_message_dropped,
+    xi_utest_setup_basic,
+    xi_utest_teardown_basic,
+    NULL,
+    {
+        xi_utest_publish_queue_result_t result = {0, XI_STATE_OK};
+
+        xi_evtd_instance_t* evtd  = xi_evtd_create_instance();
+        xi_publish_queue_t* queue = xi_publish_queue_create(
+            evtd, xi_make_empty_handle(), 1, 0, 0, xi_utest_publish_queue_spool_name );
+        xi_data_desc_t* too_big =
+            xi_make_empty_desc_alloc( XI_PUBLISH_QUEUE_MAX_SPOOL_SIZE );
+
+        tt_ptr_op( queue, !=, NULL );
+        tt_ptr_op( too_big, !=, NULL );
+
+        too_big->length = XI_PUBLISH_QUEUE_MAX_SPOOL_SIZE;
+
+        xi_utest_publish_queue_push_string( queue, "t1", "m1", xi_make_empty_handle() );
+        xi_utest_publish_queue_push_string( queue, "t2", "m2", xi_make_empty_handle() );
+
+        /* no room in the spool, RAM would send it ahead of the spooled t2 */
+        tt_int_op( xi_publish_queue_push( queue, "t3", too_big, XI_MQTT_QOS_AT_LEAST_ONCE,
+                                          XI_MQTT_RETAIN_FALSE,
+                                          XI_PUBLISH_PRIORITY_NORMAL,
+                                          xi_utest_publish_queue_make_callback(
+                                              &result ) ),
+                   ==, XI_STATE_OK );
+        too_big = NULL;
+
+        xi_utest_publish_queue_push_string( queue, "t4", "m4", xi_make_empty_handle() );
+
+        tt_int_op( queue->stats.dropped_messages, ==, 1 );
+        tt_int_op( queue->stats.queued_messages, ==, 1 );
+        tt_int_op( queue->stats.spooled_messages, ==, 2 );
+
+        xi_evtd_step( evtd, 0 );
+        tt_int_op( result.calls, ==, 1 );
+        tt_int_op( result.state, ==, XI_BACKOFF_TERMINAL );
+
+        tt_int_op( xi_utest_publish_queue_pop_matches( queue, "t1", "m1" ), ==, 1 );
+        tt_int_op( xi_utest_publish_queue_pop_matches( queue, "t2", "m2" ), ==, 1 );
+        tt_int_op( xi_utest_publish_queue_pop_matches( queue, "t4", "m4" ), ==, 1 );
+        tt_ptr_op( xi_publish_queue_pop( queue ), ==, NULL );
+
+    end:
+        xi_free_desc( &too_big );
+        xi_publish_queue_destroy( &queue );
+        xi_evtd_destroy_instance( evtd );
+        xi_internals.fs_functions.remove_resource( NULL, XI_FS_CONFIG_DATA,
+                                                   xi_utest_publish_queue_spool_name );
+    } )
+
+XI_TT_TESTCASE_WITH_SETUP(
+    utest__xi_publish_queue_create__spool_left_by_previous_queue__spool_recovered,
+    xi_utest_setup_basic,
+    xi_utest_teardown_basic,
+    NULL,
+    {
+        xi_evtd_instance_t* evtd  = xi_evtd_create_instance();
+        xi_publish_queue_t* queue = xi_publish_queue_create(
+            evtd, xi_make_empty_handle(), 1, 0, 0, xi_utest_publish_queue_spool_name );
+
+        tt_ptr_op( queue, !=, NULL );
+
+        xi_utest_publish_queue_push_string( queue, "t1", "m1", xi_make_empty_handle() );
+        xi_utest_publish_queue_push_string( queue, "t2", "m2", xi_make_empty_handle() );
+        xi_utest_publish_queue_push_string( queue, "t3", "m3", xi_make_empty_handle() );
+
+        tt_int_op( queue->stats.spooled_messages, ==, 2 );
+
+        /* RAM content is lost, the spool stays */
+        xi_publish_queue_destroy( &queue );
+
+        queue = xi_publish_queue_create( evtd, xi_make_empty_handle(), 1, 0, 0,
+                                         xi_utest_publish_queue_spool_name );
+
+        tt_ptr_op( queue, !=, NULL );
+        tt_int_op( queue->stats.spooled_messages, ==, 2 );
+        tt_int_op( xi_publish_queue_is_empty( queue ), ==, 0 );
+
+        tt_int_op( xi_utest_publish_queue_pop_matches( queue, "t2", "m2" ), ==, 1 );
+        tt_int_op( xi_utest_publish_queue_pop_matches( queue, "t3", "m3" ), ==, 1 );
+        tt_ptr_op( xi_publish_queue_pop( queue ), ==, NULL );
+
+    end:
+        xi_publish_queue_destroy( &queue );
+        xi_evtd_destroy_instance( evtd );
+        xi_internals.fs_functions.remove_resource( NULL, XI_FS_CONFIG_DATA,
+                                                   xi_utest_publish_queue_spool_name );
+    } )
+
+XI_TT_TESTCASE_WITH_SETUP(
+    utest__xi_publish_queue_create__spool_partially_drained__only_the_rest_recovered,
+    xi_utest_setup_basic,
+    xi_utest_teardown_basic,
+    NULL,
+    {
+        xi_fs_stat_t resource_stat = {.resource_size = 0};
+
+        xi_evtd_instance_t* evtd  = xi_evtd_create_instance();
+        xi_publish_queue_t* queue = xi_publish_queue_create(
+            evtd, xi_make_empty_handle(), 1, 0, 0, xi_utest_publish_queue_spool_name );
+
+        tt_ptr_op( queue, !=, NULL );
+
+        xi_utest_publish_queue_push_string( queue, "t1", "m1", xi_make_empty_handle() );
+        xi_utest_publish_queue_push_string( queue, "t2", "m2", xi_make_empty_handle() );
+        xi_utest_publish_queue_push_string( queue, "t3", "m3", xi_make_empty_handle() );
+        xi_utest_publish_queue_push_string( queue, "t4", "m4", xi_make_empty_handle() );
+        xi_utest_publish_queue_push_string( queue, "t5", "m5", xi_make_empty_handle() );
+
+        tt_int_op( queue->stats.spooled_messages, ==, 4 );
+
+        /* half of the spool is handed over before the restart */
+        tt_int_op( xi_utest_publish_queue_pop_matches( queue, "t1", "m1" ), ==, 1 );
+        tt_int_op( xi_utest_publish_queue_pop_matches( queue, "t2", "m2" ), ==, 1 );
+        tt_int_op( xi_utest_publish_queue_pop_matches( queue, "t3", "m3" ), ==, 1 );
+
+        xi_publish_queue_destroy( &queue );
+
+        queue = xi_publish_queue_create( evtd, xi_make_empty_handle(), 1, 0, 0,
+                                         xi_utest_publish_queue_spool_name );
+
+        tt_ptr_op( queue, !=, NULL );
+        tt_int_op( queue->stats.spooled_messages, ==, 2 );
+        tt_int_op( queue->stats.spooled_bytes, ==,
+                   2 * ( XI_PUBLISH_QUEUE_SPOOL_HEADER_SIZE + 4 ) );
+
+        tt_int_op( xi_utest_publish_queue_pop_matches( queue, "t4", "m4" ), ==, 1 );
+        tt_int_op( xi_utest_publish_queue_pop_matches( queue, "t5", "m5" ), ==, 1 );
+        tt_ptr_op( xi_publish_queue_pop( queue ), ==, NULL );
+
+        /* the offset goes away together with the drained spool */
+        tt_int_op( xi_internals.fs_functions.stat_resource(
+                       NULL, XI_FS_CONFIG_DATA, queue->spool_offset_name,
+                       &resource_stat ),
+                   !=, XI_STATE_OK );
+
+    end:
+        if ( NULL != queue )
+        {
+            xi_internals.fs_functions.remove_resource( NULL, XI_FS_CONFIG_DATA,
+                                                       queue->spool_offset_name );
+        }
+        xi_publish_queue_destroy( &queue );
+        xi_evtd_destroy_instance( evtd );
+        xi_internals.fs_functions.remove_resource( NULL, XI_FS_CONFIG_DATA,
+                                                   xi_utest_publish_queue_spool_name );
+    } )
+#endif
+
+XI_TT_TESTGROUP_END
+
+#ifndef XI_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
+#define XI_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
+#include __FILE__
+#undef XI_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
+#endif
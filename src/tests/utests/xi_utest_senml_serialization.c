@@ -9,6 +9,7 @@
 #include "xi_tt_testcase_management.h"
 
 #include "xively_senml.h"
+#include "xi_senml_cbor_serializer.h"
 #include "xi_senml_json_serializer.h"
 #include "xi_helpers.h"
 #include "xi_macros.h"
@@ -691,6 +692,537 @@ XI_TT_TESTCASE( utest__xi_senml_json_serialize__valid_data__create_buffer_with_j
                     return;
                 } )
 
+XI_TT_TESTCASE(
+    utest__xi_senml_json_serialize_float__various_values__shortest_representation_read_back_as_the_same_float,
+    {
+        const struct
+        {
+            float value;
+            const char* expected;
+        } cases[] = {{0.0f, "0"},
+                     {-0.0f, "-0"},
+                     {0.1f, "0.1"},
+                     {1.0f / 3.0f, "0.33333334"},
+                     {22.02f, "22.02"},
+                     {100.0f, "100"},
+                     {123456.7f, "123456.7"},
+                     {16777216.0f, "16777216"},
+                     {1e10f, "1e+10"},
+                     {-2.5e-5f, "-2.5e-05"},
+                     {0.0001f, "0.0001"},
+                     {3.4028235e38f, "3.4028235e+38"},
+                     {1e-40f, "1e-40"}};
+
+        size_t i = 0;
+
+        for ( ; i < XI_ARRAYSIZE( cases ); ++i )
+        {
+            xi_data_desc_t* desc = xi_make_empty_desc_alloc( 32 );
+
+            tt_want_int_op( xi_senml_json_serialize_float( desc, cases[i].value ), ==,
+                            XI_STATE_OK );
+            tt_want_int_op( desc->length, ==, strlen( cases[i].expected ) );
+            tt_want_int_op( memcmp( desc->data_ptr, cases[i].expected, desc->length ),
+                            ==, 0 );
+
+            /* read back */
+            char read_back[32] = {'\0'};
+            memcpy( read_back, desc->data_ptr, XI_MIN( desc->length, 31 ) );
+            tt_want( cases[i].value == strtof( read_back, NULL ) );
+
+            xi_free_desc( &desc );
+        }
+    } )
+
+XI_TT_TESTCASE(
+    utest__xi_senml_json_serialize_float__infinity_and_nan__serialization_error, {
+        xi_data_desc_t* desc = xi_make_empty_desc_alloc( 32 );
+
+        const float zero = 0.0f;
+
+        tt_want_int_op( xi_senml_json_serialize_float( desc, 1.0f / zero ), ==,
+                        XI_SERIALIZATION_ERROR );
+        tt_want_int_op( xi_senml_json_serialize_float( desc, -1.0f / zero ), ==,
+                        XI_SERIALIZATION_ERROR );
+        tt_want_int_op( xi_senml_json_serialize_float( desc, zero / zero ), ==,
+                        XI_SERIALIZATION_ERROR );
+        tt_want_int_op( desc->length, ==, 0 );
+
+        xi_free_desc( &desc );
+    } )
+
+XI_TT_TESTCASE(
+    utest__xi_senml_json_serialize_int__int32_limits__serialized_int_in_the_buffer, {
+        xi_data_desc_t* desc = xi_make_empty_desc_alloc( 32 );
+
+        tt_want_int_op( xi_senml_json_serialize_int( desc, INT32_MIN ), ==, XI_STATE_OK );
+        tt_want_int_op( xi_senml_json_serialize_key( desc, "", 1 ), ==, XI_STATE_OK );
+        tt_want_int_op( xi_senml_json_serialize_int( desc, INT32_MAX ), ==, XI_STATE_OK );
+        tt_want_int_op( xi_senml_json_serialize_key( desc, "", 1 ), ==, XI_STATE_OK );
+        tt_want_int_op( xi_senml_json_serialize_int( desc, 0 ), ==, XI_STATE_OK );
+
+        tt_want_int_op(
+            memcmp( desc->data_ptr, "-2147483648,2147483647,0", desc->length ), ==, 0 );
+
+        xi_free_desc( &desc );
+    } )
+
+XI_TT_TESTCASE(
+    utest__xi_senml_json_serialize__256_entries__single_buffer_of_exact_size_same_as_appended_entries,
+    {
+        xi_senml_t* structure    = 0;
+        xi_state_t state         = XI_STATE_OK;
+        int32_t i                = 0;
+        xi_data_desc_t* document = NULL;
+        xi_data_desc_t* appended = NULL;
+        xi_senml_entry_t* entry  = NULL;
+        uint32_t entries_count   = 0;
+
+        XI_UNUSED( state );
+
+        /* both documents have to fit the application memory of the memory limiter
+         * together with the buffer growth of the appended one */
+        XI_CREATE_SENML_STRUCT( state, structure, XI_SENML_BASE_NAME( "urn:dev:256" ),
+                                XI_SENML_BASE_UNITS( "Cel" ), XI_SENML_BASE_TIME( 1 ) );
+
+        for ( ; i < 256; ++i )
+        {
+            if ( 0 == i % 2 )
+            {
+                XI_ADD_SENML_ENTRY( state, structure, XI_SENML_ENTRY_NAME( "temp" ),
+                                    XI_SENML_ENTRY_FLOAT_VALUE( i * 0.37f - 100.0f ),
+                                    XI_SENML_ENTRY_TIME( -i ) );
+            }
+            else
+            {
+                XI_ADD_SENML_ENTRY( state, structure, XI_SENML_ENTRY_NAME( "door" ),
+                                    XI_SENML_ENTRY_BOOLEAN_VALUE( i % 3 ),
+                                    XI_SENML_ENTRY_UPDATE_TIME( i * 60 ) );
+            }
+        }
+
+        tt_int_op( xi_senml_json_serialize( &document, structure ), ==, XI_STATE_OK );
+        tt_int_op( document->capacity, ==, document->length );
+
+        /* the very same document appended entry by entry */
+        appended = xi_make_empty_desc_alloc( 32 );
+        tt_ptr_op( appended, !=, NULL );
+
+        tt_int_op( xi_senml_json_serialize_init( appended ), ==, XI_STATE_OK );
+
+        for ( entry = structure->entries_list; NULL != entry; entry = entry->__next )
+        {
+            tt_int_op( xi_senml_json_serialize_entry( appended, entry, entries_count++ ),
+                       ==, XI_STATE_OK );
+        }
+
+        tt_int_op( xi_senml_json_serialize_close_entries( appended ), ==, XI_STATE_OK );
+        tt_int_op( xi_senml_json_serialize_base_name( appended, "urn:dev:256", 1 ), ==,
+                   XI_STATE_OK );
+        tt_int_op( xi_senml_json_serialize_base_time( appended, 1, 2 ), ==, XI_STATE_OK );
+        tt_int_op( xi_senml_json_serialize_base_units( appended, "Cel", 3 ), ==,
+                   XI_STATE_OK );
+        tt_int_op( xi_senml_json_serialize_close( appended ), ==, XI_STATE_OK );
+
+        tt_int_op( entries_count, ==, 256 );
+        tt_int_op( document->length, ==, appended->length );
+        tt_int_op( memcmp( document->data_ptr, appended->data_ptr, document->length ), ==,
+                   0 );
+
+    end:
+        xi_free_desc( &appended );
+        xi_free_desc( &document );
+        xi_senml_destroy( &structure );
+    } )
+
+XI_TT_TESTCASE( utest__xi_senml_cbor_serialize__valid_data__rfc8428_records_in_the_buffer, {
+    xi_senml_t* structure = 0;
+    xi_state_t state      = XI_STATE_OK;
+
+    XI_UNUSED( state );
+
+    XI_CREATE_SENML_STRUCT( state, structure, XI_SENML_BASE_NAME( "dev:" ),
+                            XI_SENML_BASE_UNITS( "V" ), XI_SENML_BASE_TIME( 23 ) );
+
+    XI_ADD_SENML_ENTRY( state, structure, XI_SENML_ENTRY_NAME( "t" ),
+                        XI_SENML_ENTRY_FLOAT_VALUE( 22.5f ) );
+    XI_ADD_SENML_ENTRY( state, structure, XI_SENML_ENTRY_TIME( -120 ),
+                        XI_SENML_ENTRY_BOOLEAN_VALUE( 0 ) );
+    XI_ADD_SENML_ENTRY( state, structure, XI_SENML_ENTRY_TIME( 300 ),
+                        XI_SENML_ENTRY_STRING_VALUE( "ok" ) );
+    XI_ADD_SENML_ENTRY( state, structure, XI_SENML_ENTRY_FLOAT_VALUE( 0.1f ),
+                        XI_SENML_ENTRY_UPDATE_TIME( 60 ) );
+    XI_ADD_SENML_ENTRY( state, structure, XI_SENML_ENTRY_UNITS( "Cel" ),
+                        XI_SENML_ENTRY_FLOAT_VALUE( 21.0f ) );
+
+    const uint8_t expected[] = {
+        0x85,                                     /* array of 5 records */
+        0xa5, 0x21, 0x64, 'd', 'e', 'v', ':',     /* bn */
+        0x22, 0x17, 0x23, 0x61, 'V',              /* bt, bu */
+        0x00, 0x61, 't', 0x02, 0xf9, 0x4d, 0xa0,  /* n, v as half float */
+        0xa2, 0x04, 0xf4, 0x06, 0x38, 0x77,       /* vb, t */
+        0xa2, 0x03, 0x62, 'o', 'k', 0x06, 0x19, 0x01, 0x2c, /* vs, t */
+        0xa2, 0x02, 0xfa, 0x3d, 0xcc, 0xcc, 0xcd, 0x07, 0x18, 0x3c, /* v, ut */
+        0xa2, 0x01, 0x63, 'C', 'e', 'l', 0x02, 0x15 /* u, v as integer */
+    };
+
+    uint8_t* buff = NULL;
+    uint32_t size = 0;
+
+    tt_want_int_op(
+        xi_senml_serialize_as( structure, XI_SENML_FORMAT_CBOR, &buff, &size ), ==,
+        XI_STATE_OK );
+    tt_want_int_op( size, ==, sizeof( expected ) );
+    tt_want_int_op( memcmp( expected, buff, XI_MIN( sizeof( expected ), size ) ), ==,
+                    0 );
+
+    xi_senml_destroy( &structure );
+    xi_senml_free_buffer( &buff );
+} )
+
+XI_TT_TESTCASE(
+    utest__xi_senml_cbor_serialize__float_values__shortest_exact_encoding, {
+        const struct
+        {
+            float value;
+            uint8_t encoded_len;
+            uint8_t encoded[5];
+        } cases[] = {{0.0f, 1, {0x00}},
+                     {-0.0f, 1, {0x00}},
+                     {-1.0f, 1, {0x20}},
+                     {65504.0f, 3, {0x19, 0xff, 0xe0}},
+                     {-2147483648.0f, 5, {0x3a, 0x7f, 0xff, 0xff, 0xff}},
+                     {2147483648.0f, 5, {0xfa, 0x4f, 0x00, 0x00, 0x00}},
+                     {0.5f, 3, {0xf9, 0x38, 0x00}},
+                     {-1.5f, 3, {0xf9, 0xbe, 0x00}},
+                     {5.9604645e-08f, 3, {0xf9, 0x00, 0x01}},
+                     {6.1035156e-05f, 3, {0xf9, 0x04, 0x00}},
+                     {2.9802322e-08f, 5, {0xfa, 0x33, 0x00, 0x00, 0x00}},
+                     {1.0009766f, 3, {0xf9, 0x3c, 0x01}},
+                     {1.0004883f, 5, {0xfa, 0x3f, 0x80, 0x10, 0x00}},
+                     {3.4028235e38f, 5, {0xfa, 0x7f, 0x7f, 0xff, 0xff}}};
+
+        size_t i = 0;
+
+        for ( ; i < XI_ARRAYSIZE( cases ); ++i )
+        {
+            xi_senml_t* structure    = 0;
+            xi_state_t state         = XI_STATE_OK;
+            xi_data_desc_t* document = NULL;
+
+            XI_UNUSED( state );
+
+            XI_CREATE_SENML_EMPTY_STRUCT( state, structure );
+            XI_ADD_SENML_ENTRY( state, structure,
+                                XI_SENML_ENTRY_FLOAT_VALUE( cases[i].value ) );
+
+            tt_want_int_op( xi_senml_cbor_serialize( &document, structure ), ==,
+                            XI_STATE_OK );
+
+            /* array of one record with the value only */
+            tt_want_int_op( document->length, ==, 3 + cases[i].encoded_len );
+            tt_want_int_op( memcmp( document->data_ptr, "\x81\xa1\x02", 3 ), ==, 0 );
+            tt_want_int_op( memcmp( document->data_ptr + 3, cases[i].encoded,
+                                    cases[i].encoded_len ),
+                            ==, 0 );
+
+            xi_free_desc( &document );
+            xi_senml_destroy( &structure );
+        }
+    } )
+
+XI_TT_TESTCASE(
+    utest__xi_senml_cbor_serialize__infinity_and_nan__serialization_error, {
+        const float zero     = 0.0f;
+        const float values[] = {1.0f / zero, -1.0f / zero, zero / zero};
+
+        size_t i = 0;
+
+        for ( ; i < XI_ARRAYSIZE( values ); ++i )
+        {
+            xi_senml_t* structure    = 0;
+            xi_state_t state         = XI_STATE_OK;
+            xi_data_desc_t* document = NULL;
+
+            XI_UNUSED( state );
+
+            XI_CREATE_SENML_EMPTY_STRUCT( state, structure );
+            XI_ADD_SENML_ENTRY( state, structure, XI_SENML_ENTRY_NAME( "n" ),
+                                XI_SENML_ENTRY_FLOAT_VALUE( values[i] ) );
+
+            tt_want_int_op( xi_senml_cbor_serialize( &document, structure ), ==,
+                            XI_SERIALIZATION_ERROR );
+            tt_want_ptr_op( document, ==, NULL );
+
+            xi_senml_destroy( &structure );
+        }
+    } )
+
+XI_TT_TESTCASE(
+    utest__xi_senml_cbor_serialize__no_entries__base_record_or_empty_array, {
+        xi_senml_t* structure    = 0;
+        xi_state_t state         = XI_STATE_OK;
+        xi_data_desc_t* document = NULL;
+
+        XI_UNUSED( state );
+
+        XI_CREATE_SENML_EMPTY_STRUCT( state, structure );
+
+        tt_want_int_op( xi_senml_cbor_serialize( &document, structure ), ==,
+                        XI_STATE_OK );
+        tt_want_int_op( document->length, ==, 1 );
+        tt_want_int_op( document->data_ptr[0], ==, 0x80 );
+
+        xi_free_desc( &document );
+        xi_senml_destroy( &structure );
+
+        XI_CREATE_SENML_STRUCT( state, structure, XI_SENML_BASE_TIME( 1000 ) );
+
+        tt_want_int_op( xi_senml_cbor_serialize( &document, structure ), ==,
+                        XI_STATE_OK );
+        tt_want_int_op( document->length, ==, 6 );
+        tt_want_int_op( memcmp( document->data_ptr, "\x81\xa1\x22\x19\x03\xe8", 6 ), ==,
+                        0 );
+
+        xi_free_desc( &document );
+        xi_senml_destroy( &structure );
+    } )
+
+XI_TT_TESTCASE( utest__xi_senml_serialize_as__unknown_format__invalid_parameter, {
+    xi_senml_t* structure = 0;
+    xi_state_t state      = XI_STATE_OK;
+    uint8_t* buff         = NULL;
+    uint32_t size         = 0;
+
+    XI_UNUSED( state );
+
+    XI_CREATE_SENML_EMPTY_STRUCT( state, structure );
+
+    tt_want_int_op( xi_senml_serialize_as( structure, ( xi_senml_format_t )7, &buff,
+                                           &size ),
+                    ==, XI_INVALID_PARAMETER );
+    tt_want_ptr_op( buff, ==, NULL );
+    tt_want_int_op( size, ==, 0 );
+
+    xi_senml_destroy( &structure );
+} )
+
+XI_TT_TESTCASE(
+    utest__xi_senml_cbor_serialize__256_entries__exact_size_less_than_two_thirds_of_json, {
+        xi_senml_t* structure = 0;
+        xi_state_t state      = XI_STATE_OK;
+        int32_t i             = 0;
+        xi_data_desc_t* json  = NULL;
+        xi_data_desc_t* cbor  = NULL;
+
+        XI_UNUSED( state );
+
+        /* sized for the application memory of the memory limiter */
+        XI_CREATE_SENML_STRUCT( state, structure,
+                                XI_SENML_BASE_NAME( "urn:dev:mac:0024befffe804ff1:" ) );
+
+        for ( ; i < 256; ++i )
+        {
+            XI_ADD_SENML_ENTRY( state, structure, XI_SENML_ENTRY_NAME( "temperature" ),
+                                XI_SENML_ENTRY_FLOAT_VALUE( 21.5f + ( i % 97 ) * 0.13f ),
+                                XI_SENML_ENTRY_TIME( -i ),
+                                XI_SENML_ENTRY_UNITS( "Cel" ) );
+        }
+
+        tt_int_op( xi_senml_json_serialize( &json, structure ), ==, XI_STATE_OK );
+        tt_int_op( xi_senml_cbor_serialize( &cbor, structure ), ==, XI_STATE_OK );
+
+        tt_int_op( cbor->capacity, ==, cbor->length );
+        tt_int_op( cbor->length * 3, <, json->length * 2 );
+
+    end:
+        xi_free_desc( &json );
+        xi_free_desc( &cbor );
+        xi_senml_destroy( &structure );
+    } )
+
+XI_TT_TESTCASE(
+    utest__xi_append_senml_entry__entries_fit__same_document_as_serialized_structure, {
+        xi_senml_t* structure = 0;
+        xi_state_t state      = XI_STATE_OK;
+        uint8_t buffer[512];
+        xi_senml_writer_t json_writer;
+        xi_senml_writer_t cbor_writer;
+        int32_t i = 0;
+
+        XI_UNUSED( state );
+
+        XI_CREATE_SENML_STRUCT( state, structure, XI_SENML_BASE_NAME( "dev:" ),
+                                XI_SENML_BASE_TIME( 1000 ) );
+
+        XI_INIT_SENML_WRITER( state, &json_writer, XI_SENML_FORMAT_JSON, buffer,
+                              sizeof( buffer ), XI_SENML_BASE_NAME( "dev:" ),
+                              XI_SENML_BASE_TIME( 1000 ) );
+        tt_want_int_op( state, ==, XI_STATE_OK );
+
+        for ( ; i < 5; ++i )
+        {
+            XI_ADD_SENML_ENTRY( state, structure, XI_SENML_ENTRY_NAME( "temp" ),
+                                XI_SENML_ENTRY_FLOAT_VALUE( 20.5f + i ),
+                                XI_SENML_ENTRY_TIME( -i ), XI_SENML_ENTRY_UNITS( "Cel" ) );
+
+            XI_APPEND_SENML_ENTRY( state, &json_writer, XI_SENML_ENTRY_NAME( "temp" ),
+                                   XI_SENML_ENTRY_FLOAT_VALUE( 20.5f + i ),
+                                   XI_SENML_ENTRY_TIME( -i ),
+                                   XI_SENML_ENTRY_UNITS( "Cel" ) );
+            tt_want_int_op( state, ==, XI_STATE_OK );
+        }
+
+        const uint8_t* document = NULL;
+        uint32_t document_size  = 0;
+        xi_data_desc_t* json    = NULL;
+        xi_data_desc_t* cbor    = NULL;
+
+        tt_want_int_op( xi_senml_json_serialize( &json, structure ), ==, XI_STATE_OK );
+        tt_want_int_op( xi_flush_senml_writer( &json_writer, &document, &document_size ),
+                        ==, XI_STATE_OK );
+        tt_want_ptr_op( document, ==, buffer );
+        tt_want_int_op( document_size, ==, json->length );
+        tt_want_int_op(
+            memcmp( document, json->data_ptr, XI_MIN( document_size, json->length ) ), ==,
+            0 );
+
+        /* the CBOR document is the same array but of indefinite length */
+        XI_INIT_SENML_WRITER( state, &cbor_writer, XI_SENML_FORMAT_CBOR, buffer,
+                              sizeof( buffer ), XI_SENML_BASE_NAME( "dev:" ),
+                              XI_SENML_BASE_TIME( 1000 ) );
+
+        for ( i = 0; i < 5; ++i )
+        {
+            XI_APPEND_SENML_ENTRY( state, &cbor_writer, XI_SENML_ENTRY_NAME( "temp" ),
+                                   XI_SENML_ENTRY_FLOAT_VALUE( 20.5f + i ),
+                                   XI_SENML_ENTRY_TIME( -i ),
+                                   XI_SENML_ENTRY_UNITS( "Cel" ) );
+            tt_want_int_op( state, ==, XI_STATE_OK );
+        }
+
+        tt_want_int_op( xi_senml_cbor_serialize( &cbor, structure ), ==, XI_STATE_OK );
+        tt_want_int_op( xi_flush_senml_writer( &cbor_writer, &document, &document_size ),
+                        ==, XI_STATE_OK );
+        tt_want_int_op( document_size, ==, cbor->length + 1 );
+        tt_want_int_op( document[0], ==, 0x9f );
+        tt_want_int_op( memcmp( document + 1, cbor->data_ptr + 1, cbor->length - 1 ), ==,
+                        0 );
+        tt_want_int_op( document[document_size - 1], ==, 0xff );
+
+        xi_free_desc( &json );
+        xi_free_desc( &cbor );
+        xi_senml_destroy( &structure );
+    } )
+
+XI_TT_TESTCASE(
+    utest__xi_append_senml_entry__buffer_full__overflow_then_flushed_documents_within_capacity,
+    {
+        const xi_senml_format_t formats[] = {XI_SENML_FORMAT_JSON, XI_SENML_FORMAT_CBOR};
+        const uint32_t capacity           = 100;
+
+        size_t f = 0;
+
+        for ( ; f < XI_ARRAYSIZE( formats ); ++f )
+        {
+            /* the tail of the buffer must stay untouched */
+            uint8_t buffer[128];
+            xi_senml_writer_t writer;
+            xi_state_t state        = XI_STATE_OK;
+            const uint8_t* document = NULL;
+            uint32_t document_size  = 0;
+            uint32_t documents      = 0;
+            uint32_t entries        = 0;
+            int32_t i               = 0;
+
+            memset( buffer, 0xaa, sizeof( buffer ) );
+
+            XI_INIT_SENML_WRITER( state, &writer, formats[f], buffer, capacity,
+                                  XI_SENML_BASE_NAME( "urn:dev:mac:0024befffe804ff1:" ) );
+            tt_want_int_op( state, ==, XI_STATE_OK );
+
+            for ( ; i < 20; ++i )
+            {
+                XI_APPEND_SENML_ENTRY( state, &writer, XI_SENML_ENTRY_NAME( "temp" ),
+                                       XI_SENML_ENTRY_FLOAT_VALUE( 0.1f * i ),
+                                       XI_SENML_ENTRY_TIME( i ) );
+
+                if ( XI_BUFFER_OVERFLOW == state )
+                {
+                    tt_want_int_op( 0, <, writer.entries_count );
+                    entries += writer.entries_count;
+
+                    tt_want_int_op( xi_flush_senml_writer( &writer, &document,
+                                                           &document_size ),
+                                    ==, XI_STATE_OK );
+                    tt_want_int_op( document_size, <=, capacity );
+                    ++documents;
+
+                    XI_APPEND_SENML_ENTRY( state, &writer, XI_SENML_ENTRY_NAME( "temp" ),
+                                           XI_SENML_ENTRY_FLOAT_VALUE( 0.1f * i ),
+                                           XI_SENML_ENTRY_TIME( i ) );
+                }
+
+                tt_want_int_op( state, ==, XI_STATE_OK );
+            }
+
+            entries += writer.entries_count;
+
+            tt_want_int_op(
+                xi_flush_senml_writer( &writer, &document, &document_size ), ==,
+                XI_STATE_OK );
+            tt_want_int_op( document_size, <=, capacity );
+
+            tt_want_int_op( 1, <, documents );
+            tt_want_int_op( entries, ==, 20 );
+            tt_want_int_op( buffer[capacity], ==, 0xaa );
+            tt_want_int_op( buffer[sizeof( buffer ) - 1], ==, 0xaa );
+        }
+    } )
+
+XI_TT_TESTCASE( utest__xi_init_senml_writer__tiny_buffer__buffer_overflow, {
+    uint8_t buffer[16];
+    xi_senml_writer_t writer;
+    xi_state_t state = XI_STATE_OK;
+
+    XI_INIT_SENML_WRITER( state, &writer, XI_SENML_FORMAT_JSON, buffer, sizeof( buffer ),
+                          XI_SENML_BASE_NAME( "urn:dev:mac:0024befffe804ff1:" ) );
+    tt_want_int_op( state, ==, XI_BUFFER_OVERFLOW );
+
+    XI_INIT_SENML_EMPTY_WRITER( state, &writer, ( xi_senml_format_t )7, buffer,
+                                sizeof( buffer ) );
+    tt_want_int_op( state, ==, XI_INVALID_PARAMETER );
+} )
+
+XI_TT_TESTCASE( utest__xi_flush_senml_writer__no_entries__empty_documents, {
+    uint8_t buffer[32];
+    xi_senml_writer_t writer;
+    xi_state_t state        = XI_STATE_OK;
+    const uint8_t* document = NULL;
+    uint32_t document_size  = 0;
+
+    XI_UNUSED( state );
+
+    XI_INIT_SENML_EMPTY_WRITER( state, &writer, XI_SENML_FORMAT_JSON, buffer,
+                                sizeof( buffer ) );
+    tt_want_int_op( xi_flush_senml_writer( &writer, &document, &document_size ), ==,
+                    XI_STATE_OK );
+    tt_want_int_op( document_size, ==, 8 );
+    tt_want_int_op( memcmp( document, "{\"e\":[]}", 8 ), ==, 0 );
+
+    XI_INIT_SENML_WRITER( state, &writer, XI_SENML_FORMAT_CBOR, buffer, sizeof( buffer ),
+                          XI_SENML_BASE_TIME( 1000 ) );
+    tt_want_int_op( xi_flush_senml_writer( &writer, &document, &document_size ), ==,
+                    XI_STATE_OK );
+    tt_want_int_op( document_size, ==, 7 );
+    tt_want_int_op( memcmp( document, "\x9f\xa1\x22\x19\x03\xe8\xff", 7 ), ==, 0 );
+
+    /* an entry without value is rejected and leaves the writer intact */
+    XI_APPEND_SENML_ENTRY( state, &writer, XI_SENML_ENTRY_NAME( "n" ) );
+    tt_want_int_op( state, ==, XI_INVALID_PARAMETER );
+    tt_want_int_op( writer.length, ==, 0 );
+} )
+
 XI_TT_TESTGROUP_END
 
 #pragma GCC diagnostic pop
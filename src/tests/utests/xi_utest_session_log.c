@@ -0,0 +1,292 @@
+/* Copyright (c) 2003-2018, Xively All rights reserved.
+ *
+ * This is part of the Xively C Client library,
+ * it is licensed under the BSD 3-Clause license.
+ */
+
+#include "tinytest.h"
+#include "tinytest_macros.h"
+#include "xi_tt_testcase_management.h"
+#include "xi_utest_basic_testcase_frame.h"
+
+#include "xi_session_log.h"
+#include "xi_config.h"
+#include "xi_internals.h"
+#include "xi_macros.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#ifndef XI_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
+
+static const char* xi_utest_session_log_name     = "session_log.utest_file";
+static const char* xi_utest_session_log_alt_name = "session_log.utest_file.alt";
+
+static xi_state_t xi_utest_session_log_append_string( xi_session_log_t* log,
+                                                      uint16_t msg_id,
+                                                      const char* topic,
+                                                      const char* msg )
+{
+    xi_data_desc_t* data = xi_make_desc_from_string_copy( msg );
+
+    xi_state_t state = xi_session_log_append_publish(
+        log, msg_id, topic, data, XI_MQTT_QOS_AT_LEAST_ONCE, XI_MQTT_RETAIN_FALSE );
+
+    xi_free_desc( &data );
+
+    return state;
+}
+
+/* reads the publication of the entry and compares it with the expected one */
+static int xi_utest_session_log_entry_matches( xi_session_log_t* log,
+                                               const xi_session_log_entry_t* entry,
+                                               uint16_t msg_id,
+                                               const char* topic,
+                                               const char* msg )
+{
+    char* entry_topic       = NULL;
+    xi_data_desc_t* data    = NULL;
+    xi_mqtt_retain_t retain = XI_MQTT_RETAIN_TRUE;
+
+    const int matches =
+        NULL != entry && msg_id == entry->msg_id &&
+        XI_STATE_OK ==
+            xi_session_log_read_publish( log, entry, &entry_topic, &data, &retain ) &&
+        0 == strcmp( entry_topic, topic ) && data->length == strlen( msg ) &&
+        0 == memcmp( data->data_ptr, msg, strlen( msg ) ) &&
+        XI_MQTT_RETAIN_FALSE == retain;
+
+    XI_SAFE_FREE( entry_topic );
+    xi_free_desc( &data );
+
+    return matches;
+}
+
+static void xi_utest_session_log_remove_resource()
+{
+    xi_internals.fs_functions.remove_resource( NULL, XI_FS_CONFIG_DATA,
+                                               xi_utest_session_log_name );
+    xi_internals.fs_functions.remove_resource( NULL, XI_FS_CONFIG_DATA,
+                                               xi_utest_session_log_alt_name );
+}
+
+#endif
+
+XI_TT_TESTGROUP_BEGIN( utest_session_log )
+
+XI_TT_TESTCASE_WITH_SETUP(
+    utest__xi_session_log_create__log_left_by_previous_instance__unacked_publishes_recovered,
+    xi_utest_setup_basic,
+    xi_utest_teardown_basic,
+    NULL,
+    {
+        xi_session_log_t* log = xi_session_log_create( xi_utest_session_log_name );
+
+        tt_ptr_op( log, !=, NULL );
+        tt_int_op( log->replay_pending, ==, 0 );
+
+        tt_int_op( xi_utest_session_log_append_string( log, 1, "t1", "m1" ), ==,
+                   XI_STATE_OK );
+        tt_int_op( xi_utest_session_log_append_string( log, 2, "t2", "m2" ), ==,
+                   XI_STATE_OK );
+        tt_int_op( xi_utest_session_log_append_string( log, 3, "t3", "m3" ), ==,
+                   XI_STATE_OK );
+        tt_int_op( xi_session_log_append_puback( log, 2 ), ==, XI_STATE_OK );
+
+        xi_session_log_destroy( &log );
+
+        log = xi_session_log_create( xi_utest_session_log_name );
+
+        tt_ptr_op( log, !=, NULL );
+        tt_int_op( log->replay_pending, ==, 1 );
+        tt_int_op( log->last_msg_id, ==, 3 );
+
+        /* the dead record is compacted away on recovery */
+        tt_int_op( log->write_offset, ==,
+                   XI_SESSION_LOG_FILE_HEADER_SIZE + log->live_bytes );
+
+        tt_int_op( xi_utest_session_log_entry_matches( log, log->entries, 1, "t1", "m1" ),
+                   ==, 1 );
+        tt_int_op( xi_utest_session_log_entry_matches( log, log->entries->__next, 3,
+                                                       "t3", "m3" ),
+                   ==, 1 );
+        tt_ptr_op( log->entries->__next->__next, ==, NULL );
+
+    end:
+        xi_session_log_destroy( &log );
+        xi_utest_session_log_remove_resource();
+    } )
+
+XI_TT_TESTCASE_WITH_SETUP(
+    utest__xi_session_log_append_puback__last_publish_acknowledged__resource_removed,
+    xi_utest_setup_basic,
+    xi_utest_teardown_basic,
+    NULL,
+    {
+        xi_fs_stat_t resource_stat = {.resource_size = 0};
+        xi_session_log_t* log      = xi_session_log_create( xi_utest_session_log_name );
+
+        tt_ptr_op( log, !=, NULL );
+
+        xi_utest_session_log_append_string( log, 1, "t1", "m1" );
+        xi_utest_session_log_append_string( log, 2, "t2", "m2" );
+
+        tt_int_op( xi_session_log_append_puback( log, 1 ), ==, XI_STATE_OK );
+        tt_int_op( xi_internals.fs_functions.stat_resource(
+                       NULL, XI_FS_CONFIG_DATA, xi_utest_session_log_name,
+                       &resource_stat ),
+                   ==, XI_STATE_OK );
+
+        /* unknown ids are ignored */
+        tt_int_op( xi_session_log_append_puback( log, 7 ), ==, XI_STATE_OK );
+        tt_ptr_op( log->entries, !=, NULL );
+
+        tt_int_op( xi_session_log_append_puback( log, 2 ), ==, XI_STATE_OK );
+        tt_ptr_op( log->entries, ==, NULL );
+        tt_int_op( log->write_offset, ==, 0 );
+        tt_int_op( xi_internals.fs_functions.stat_resource(
+                       NULL, XI_FS_CONFIG_DATA, xi_utest_session_log_name,
+                       &resource_stat ),
+                   !=, XI_STATE_OK );
+
+    end:
+        xi_session_log_destroy( &log );
+        xi_utest_session_log_remove_resource();
+    } )
+
+XI_TT_TESTCASE_WITH_SETUP(
+    utest__xi_session_log_append_puback__log_over_threshold__compacted_to_live_records,
+    xi_utest_setup_basic,
+    xi_utest_teardown_basic,
+    NULL,
+    {
+        uint16_t msg_id       = 2;
+        xi_session_log_t* log = xi_session_log_create( xi_utest_session_log_name );
+
+        tt_ptr_op( log, !=, NULL );
+
+        /* the first publication stays unacknowledged for the whole time */
+        xi_utest_session_log_append_string( log, 1, "t1", "m1" );
+
+        for ( ; msg_id < 1000; ++msg_id )
+        {
+            tt_int_op( xi_utest_session_log_append_string( log, msg_id, "t", "m" ), ==,
+                       XI_STATE_OK );
+            tt_int_op( xi_session_log_append_puback( log, msg_id ), ==, XI_STATE_OK );
+            tt_int_op( log->write_offset, <=, XI_SESSION_LOG_COMPACTION_THRESHOLD + 64 );
+        }
+
+        tt_int_op( xi_utest_session_log_entry_matches( log, log->entries, 1, "t1", "m1" ),
+                   ==, 1 );
+        tt_ptr_op( log->entries->__next, ==, NULL );
+
+        xi_session_log_destroy( &log );
+
+        log = xi_session_log_create( xi_utest_session_log_name );
+
+        tt_ptr_op( log, !=, NULL );
+        tt_int_op( xi_utest_session_log_entry_matches( log, log->entries, 1, "t1", "m1" ),
+                   ==, 1 );
+        tt_ptr_op( log->entries->__next, ==, NULL );
+
+    end:
+        xi_session_log_destroy( &log );
+        xi_utest_session_log_remove_resource();
+    } )
+
+XI_TT_TESTCASE_WITH_SETUP(
+    utest__xi_session_log_create__truncated_tail__tail_ignored,
+    xi_utest_setup_basic,
+    xi_utest_teardown_basic,
+    NULL,
+    {
+        xi_session_log_t* log = xi_session_log_create( xi_utest_session_log_name );
+
+        tt_ptr_op( log, !=, NULL );
+
+        xi_utest_session_log_append_string( log, 1, "t1", "m1" );
+
+        /* a record header promising more than is stored, as if the write was cut */
+        const uint8_t cut_record[] = {XI_SESSION_LOG_RECORD_PUBLISH, 0, 2, 0, 0, 0, 64};
+        size_t bytes_written       = 0;
+
+        tt_int_op( xi_internals.fs_functions.write_resource(
+                       NULL, log->log_handle, cut_record, sizeof( cut_record ),
+                       log->write_offset, &bytes_written ),
+                   ==, XI_STATE_OK );
+
+        xi_session_log_destroy( &log );
+
+        log = xi_session_log_create( xi_utest_session_log_name );
+
+        tt_ptr_op( log, !=, NULL );
+        tt_int_op( log->last_msg_id, ==, 1 );
+        tt_int_op( xi_utest_session_log_entry_matches( log, log->entries, 1, "t1", "m1" ),
+                   ==, 1 );
+        tt_ptr_op( log->entries->__next, ==, NULL );
+        tt_int_op( log->write_offset, ==,
+                   XI_SESSION_LOG_FILE_HEADER_SIZE + log->live_bytes );
+
+    end:
+        xi_session_log_destroy( &log );
+        xi_utest_session_log_remove_resource();
+    } )
+
+XI_TT_TESTCASE_WITH_SETUP(
+    utest__xi_session_log_create__compaction_cut_before_its_header__previous_log_kept,
+    xi_utest_setup_basic,
+    xi_utest_teardown_basic,
+    NULL,
+    {
+        xi_fs_stat_t resource_stat     = {.resource_size = 0};
+        xi_fs_resource_handle_t handle = xi_fs_init_resource_handle();
+        size_t bytes_written           = 0;
+        xi_session_log_t* log = xi_session_log_create( xi_utest_session_log_name );
+
+        tt_ptr_op( log, !=, NULL );
+
+        xi_utest_session_log_append_string( log, 1, "t1", "m1" );
+        xi_utest_session_log_append_string( log, 2, "t2", "m2" );
+
+        xi_session_log_destroy( &log );
+
+        /* the compacted log got its records but not the generation */
+        const uint8_t cut_log[] = {
+            0, 0, 0, 0, XI_SESSION_LOG_RECORD_PUBLISH, 0, 3, 0, 0, 0, 0};
+
+        tt_int_op( xi_internals.fs_functions.open_resource(
+                       NULL, XI_FS_CONFIG_DATA, xi_utest_session_log_alt_name,
+                       XI_FS_OPEN_WRITE, &handle ),
+                   ==, XI_STATE_OK );
+        tt_int_op( xi_internals.fs_functions.write_resource(
+                       NULL, handle, cut_log, sizeof( cut_log ), 0, &bytes_written ),
+                   ==, XI_STATE_OK );
+        xi_internals.fs_functions.close_resource( NULL, handle );
+
+        log = xi_session_log_create( xi_utest_session_log_name );
+
+        tt_ptr_op( log, !=, NULL );
+        tt_int_op( log->slot, ==, 0 );
+        tt_int_op( xi_utest_session_log_entry_matches( log, log->entries, 1, "t1", "m1" ),
+                   ==, 1 );
+        tt_int_op( xi_utest_session_log_entry_matches( log, log->entries->__next, 2,
+                                                       "t2", "m2" ),
+                   ==, 1 );
+        tt_ptr_op( log->entries->__next->__next, ==, NULL );
+        tt_int_op( xi_internals.fs_functions.stat_resource(
+                       NULL, XI_FS_CONFIG_DATA, xi_utest_session_log_alt_name,
+                       &resource_stat ),
+                   !=, XI_STATE_OK );
+
+    end:
+        xi_session_log_destroy( &log );
+        xi_utest_session_log_remove_resource();
+    } )
+
+XI_TT_TESTGROUP_END
+
+#ifndef XI_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
+#define XI_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
+#include __FILE__
+#undef XI_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
+#endif
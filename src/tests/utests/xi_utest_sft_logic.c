@@ -13,11 +13,13 @@
 #include <string.h>
 
 #include <xi_sft_logic.h>
+#include <xi_sft_revision.h>
 #include <xi_macros.h>
 #include <xi_helpers.h>
 #include <xi_control_message_sft.h>
 #include <xi_control_message_sft_generators.h>
 #include <xi_bsp_io_fs.h>
+#include <xi_bsp_fwu.h>
 
 #ifndef XI_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
 
@@ -52,6 +54,141 @@ err_handling:
     return message_FUA;
 }
 
+#define XI_UTEST_SFT_LOGIC__MAX_SENT_MESSAGES 32
+
+static xi_control_message_t*
+    xi_utest_sft_logic__sent_messages[XI_UTEST_SFT_LOGIC__MAX_SENT_MESSAGES] = {0};
+static uint16_t xi_utest_sft_logic__sent_messages_count = 0;
+
+static xi_state_t xi_utest_sft_logic__send_message( void* user_data,
+                                                    xi_control_message_t* message )
+{
+    XI_UNUSED( user_data );
+
+    if ( XI_UTEST_SFT_LOGIC__MAX_SENT_MESSAGES <= xi_utest_sft_logic__sent_messages_count )
+    {
+        xi_control_message_free( &message );
+        return XI_OUT_OF_MEMORY;
+    }
+
+    xi_utest_sft_logic__sent_messages[xi_utest_sft_logic__sent_messages_count++] =
+        message;
+
+    return XI_STATE_OK;
+}
+
+static void xi_utest_sft_logic__free_sent_messages()
+{
+    for ( ; 0 < xi_utest_sft_logic__sent_messages_count;
+          --xi_utest_sft_logic__sent_messages_count )
+    {
+        xi_control_message_free(
+            &xi_utest_sft_logic__sent_messages[xi_utest_sft_logic__sent_messages_count -
+                                               1] );
+    }
+}
+
+static uint16_t xi_utest_sft_logic__count_sent_messages(
+    xi_control_message_type_t msgtype,
+    xi_control_message__sft_file_status_code_t file_status_code )
+{
+    uint16_t count = 0;
+    uint16_t i     = 0;
+
+    for ( ; i < xi_utest_sft_logic__sent_messages_count; ++i )
+    {
+        const xi_control_message_t* message = xi_utest_sft_logic__sent_messages[i];
+
+        if ( msgtype == message->common.msgtype &&
+             ( XI_CONTROL_MESSAGE_CS__SFT_FILE_STATUS != msgtype ||
+               file_status_code == message->file_status.code ) )
+        {
+            ++count;
+        }
+    }
+
+    return count;
+}
+
+/* FUA of files with the size and the checksum of the bytes the FILE_CHUNK generator
+ * serves */
+xi_control_message_t*
+xi_utest_sft_logic__generate_FUA_for_generated_files( const char** filenames,
+                                                      uint16_t files_count,
+                                                      uint32_t size_in_bytes )
+{
+    xi_control_message_t* message_FUA = NULL;
+
+    xi_state_t state = XI_STATE_OK;
+
+    uint8_t* file_content  = NULL;
+    void* checksum_context = NULL;
+    uint8_t* checksum      = NULL;
+    uint16_t checksum_len  = 0;
+    uint16_t id_file       = 0;
+
+    XI_ALLOC_BUFFER( xi_control_message_file_desc_ext_t, file_list,
+                     sizeof( xi_control_message_file_desc_ext_t ) * files_count, state );
+
+    file_content =
+        xi_control_message_sft_get_reproducible_randomlike_bytes( 0, size_in_bytes );
+    XI_CHECK_MEMORY( file_content, state );
+
+    xi_bsp_fwu_checksum_init( &checksum_context );
+    xi_bsp_fwu_checksum_update( checksum_context, file_content, size_in_bytes );
+    xi_bsp_fwu_checksum_final( &checksum_context, &checksum, &checksum_len );
+
+    for ( ; id_file < files_count; ++id_file )
+    {
+        file_list[id_file].name            = xi_str_dup( filenames[id_file] );
+        file_list[id_file].revision        = xi_str_dup( "revision" );
+        file_list[id_file].size_in_bytes   = size_in_bytes;
+        file_list[id_file].fingerprint_len = checksum_len;
+
+        XI_ALLOC_BUFFER_AT( uint8_t, file_list[id_file].fingerprint, checksum_len,
+                            state );
+        memcpy( file_list[id_file].fingerprint, checksum, checksum_len );
+    }
+
+    XI_ALLOC_AT( xi_control_message_t, message_FUA, state );
+
+    message_FUA->file_update_available.common.msgtype =
+        XI_CONTROL_MESSAGE_SC__SFT_FILE_UPDATE_AVAILABLE;
+    message_FUA->file_update_available.common.msgver = 1;
+    message_FUA->file_update_available.list_len      = files_count;
+    message_FUA->file_update_available.list          = file_list;
+
+err_handling:
+
+    XI_SAFE_FREE( file_content );
+
+    return message_FUA;
+}
+
+xi_control_message_t*
+xi_utest_sft_logic__generate_FUA_for_generated_file( const char* filename,
+                                                     uint32_t size_in_bytes )
+{
+    return xi_utest_sft_logic__generate_FUA_for_generated_files( &filename, 1,
+                                                                 size_in_bytes );
+}
+
+/* answers the FILE_GET_CHUNK with the given index of the sent messages, the served
+ * chunk is at most max_chunk_length long */
+static void xi_utest_sft_logic__reply_FILE_CHUNK( xi_sft_context_t* sft_context,
+                                                  uint16_t sent_message_index,
+                                                  uint32_t max_chunk_length )
+{
+    xi_control_message_t* message_FILE_GET_CHUNK =
+        xi_utest_sft_logic__sent_messages[sent_message_index];
+
+    message_FILE_GET_CHUNK->file_get_chunk.length =
+        XI_MIN( message_FILE_GET_CHUNK->file_get_chunk.length, max_chunk_length );
+
+    xi_sft_on_message( sft_context, xi_control_message_sft_generate_reply_FILE_CHUNK(
+                                        message_FILE_GET_CHUNK ) );
+}
+
 #endif
 
 XI_TT_TESTGROUP_BEGIN( utest_sft_logic )
@@ -102,6 +239,21 @@ XI_TT_TESTCASE_WITH_SETUP( xi_utest__minimal_config__call_on_connected__no_crash
                                xi_sft_free_context( &sft_context );
                            } )
 
+XI_TT_TESTCASE_WITH_SETUP( xi_utest__minimal_config__call_send_file_info__no_crash,
+                           xi_utest_setup_basic,
+                           xi_utest_teardown_basic,
+                           NULL,
+                           {
+                               xi_sft_context_t* sft_context = NULL;
+
+                               xi_sft_make_context( &sft_context, NULL, 0, NULL, NULL,
+                                                    NULL );
+
+                               xi_sft_send_file_info( sft_context );
+
+                               xi_sft_free_context( &sft_context );
+                           } )
+
 XI_TT_TESTCASE_WITH_SETUP( xi_utest__minimal_config__call_on_connection_failed__no_crash,
                            xi_utest_setup_basic,
                            xi_utest_teardown_basic,
@@ -225,13 +377,338 @@ XI_TT_TESTCASE_WITH_SETUP(
 
         xi_sft_on_message( sft_context, message_FILE_CHUNK );
 
-        tt_ptr_op( NULL, !=, sft_context->checksum_context );
+        tt_ptr_op( NULL, !=, sft_context->downloads[0].checksum_context );
 
         xi_bsp_io_fs_remove( __FUNCTION__ );
     end:
 
         xi_control_message_free( &message_FILE_GET_CHUNK );
         xi_sft_free_context( &sft_context );
+        xi_sft_revision_remove_download_progress( __FUNCTION__ );
+    } )
+
+XI_TT_TESTCASE_WITH_SETUP(
+    xi_utest__chunk_window__FILE_CHUNKs_arrive_in_reverse_order__download_succeeds,
+    xi_utest_setup_basic,
+    xi_utest_teardown_basic,
+    NULL,
+    {
+        xi_sft_context_t* sft_context = NULL;
+
+        xi_sft_make_context( &sft_context, NULL, 0, &xi_utest_sft_logic__send_message,
+                             NULL, NULL );
+        xi_sft_set_download_window( sft_context, 4, 32 );
+
+        xi_sft_on_message( sft_context, xi_utest_sft_logic__generate_FUA_for_generated_file(
+                                            __FUNCTION__, 111 ) );
+
+        /* slow start: a single request until the first chunk arrives */
+        tt_int_op( 1, ==, xi_utest_sft_logic__sent_messages_count );
+
+        xi_utest_sft_logic__reply_FILE_CHUNK( sft_context, 0, 32 );
+
+        /* the window opens, the rest of the file is requested at once */
+        tt_int_op( 4, ==, xi_utest_sft_logic__sent_messages_count );
+        tt_int_op( 3, ==, sft_context->downloads[0].chunk_window.requests_in_flight );
+
+        /* serve the chunks backwards, written at their offsets, checksummed in order */
+        xi_utest_sft_logic__reply_FILE_CHUNK( sft_context, 3, 32 );
+        xi_utest_sft_logic__reply_FILE_CHUNK( sft_context, 2, 32 );
+
+        tt_ptr_op( NULL, !=, sft_context->downloads[0].chunk_window.pending_chunks );
+        tt_int_op( 32, ==, sft_context->downloads[0].chunk_window.checksum_offset );
+
+        xi_utest_sft_logic__reply_FILE_CHUNK( sft_context, 1, 32 );
+
+        tt_int_op( 4, ==, xi_utest_sft_logic__count_sent_messages(
+                              XI_CONTROL_MESSAGE_CS__SFT_FILE_GET_CHUNK, 0 ) );
+        tt_int_op( 2, ==, xi_utest_sft_logic__count_sent_messages(
+                              XI_CONTROL_MESSAGE_CS__SFT_FILE_STATUS,
+                              XI_CONTROL_MESSAGE__SFT_FILE_STATUS_CODE_SUCCESS ) );
+        tt_int_op( 0, ==, sft_context->downloads[0].chunk_window.requests_in_flight );
+
+    end:
+
+        xi_bsp_io_fs_remove( __FUNCTION__ );
+        xi_bsp_io_fs_remove( "xi_utest__chunk_window__FILE_CHUNKs_arrive_in_reverse_order_"
+                             "_download_succeeds.xirev" );
+        xi_utest_sft_logic__free_sent_messages();
+        xi_sft_free_context( &sft_context );
+    } )
+
+XI_TT_TESTCASE_WITH_SETUP(
+    xi_utest__chunk_window__service_serves_shorter_chunks__chunk_size_adopted,
+    xi_utest_setup_basic,
+    xi_utest_teardown_basic,
+    NULL,
+    {
+        xi_sft_context_t* sft_context = NULL;
+
+        xi_sft_make_context( &sft_context, NULL, 0, &xi_utest_sft_logic__send_message,
+                             NULL, NULL );
+        xi_sft_set_download_window( sft_context, 2, 64 );
+
+        xi_sft_on_message( sft_context, xi_utest_sft_logic__generate_FUA_for_generated_file(
+                                            __FUNCTION__, 111 ) );
+
+        /* the service caps chunks at 20 bytes whatever the request is */
+        uint32_t bytes_served = 0;
+        uint16_t id_message   = 0;
+        for ( ; id_message < xi_utest_sft_logic__sent_messages_count; ++id_message )
+        {
+            if ( XI_CONTROL_MESSAGE_CS__SFT_FILE_GET_CHUNK ==
+                 xi_utest_sft_logic__sent_messages[id_message]->common.msgtype )
+            {
+                xi_utest_sft_logic__reply_FILE_CHUNK( sft_context, id_message, 20 );
+
+                bytes_served +=
+                    xi_utest_sft_logic__sent_messages[id_message]->file_get_chunk.length;
+
+                tt_int_op( 20, ==, sft_context->chunk_size );
+            }
+        }
+
+        /* the tails of the short chunks were requested, no byte was requested twice */
+        tt_int_op( 111, ==, bytes_served );
+
+        tt_int_op( 2, ==, xi_utest_sft_logic__count_sent_messages(
+                              XI_CONTROL_MESSAGE_CS__SFT_FILE_STATUS,
+                              XI_CONTROL_MESSAGE__SFT_FILE_STATUS_CODE_SUCCESS ) );
+    end:
+
+        xi_bsp_io_fs_remove( __FUNCTION__ );
+        xi_bsp_io_fs_remove( "xi_utest__chunk_window__service_serves_shorter_chunks__"
+                             "chunk_size_adopted.xirev" );
+        xi_utest_sft_logic__free_sent_messages();
+        xi_sft_free_context( &sft_context );
+    } )
+
+XI_TT_TESTCASE_WITH_SETUP(
+    xi_utest__download_progress__context_freed_midway__download_continues_from_saved_offset,
+    xi_utest_setup_basic,
+    xi_utest_teardown_basic,
+    NULL,
+    {
+        xi_sft_context_t* sft_context = NULL;
+        char* revision                = NULL;
+        uint32_t size_in_bytes        = 0;
+        uint32_t offset               = 0;
+
+        xi_sft_make_context( &sft_context, NULL, 0, &xi_utest_sft_logic__send_message,
+                             NULL, NULL );
+        xi_sft_set_download_window( sft_context, 1, 32 );
+
+        xi_sft_on_message( sft_context, xi_utest_sft_logic__generate_FUA_for_generated_file(
+                                            __FUNCTION__, 111 ) );
+
+        xi_utest_sft_logic__reply_FILE_CHUNK( sft_context, 0, 32 );
+        xi_utest_sft_logic__reply_FILE_CHUNK( sft_context, 1, 32 );
+
+        /* connection lost */
+        xi_sft_free_context( &sft_context );
+        xi_utest_sft_logic__free_sent_messages();
+
+        tt_int_op( XI_STATE_OK, ==, xi_sft_revision_get_download_progress(
+                                        __FUNCTION__, &revision, &size_in_bytes,
+                                        &offset ) );
+        tt_str_op( "revision", ==, revision );
+        tt_int_op( 111, ==, size_in_bytes );
+        tt_int_op( 64, ==, offset );
+
+        /* reconnected, the service announces the same file again */
+        xi_sft_make_context( &sft_context, NULL, 0, &xi_utest_sft_logic__send_message,
+                             NULL, NULL );
+        xi_sft_set_download_window( sft_context, 1, 32 );
+
+        xi_sft_on_message( sft_context, xi_utest_sft_logic__generate_FUA_for_generated_file(
+                                            __FUNCTION__, 111 ) );
+
+        tt_int_op( 1, ==, xi_utest_sft_logic__sent_messages_count );
+        tt_int_op( 64, ==, xi_utest_sft_logic__sent_messages[0]->file_get_chunk.offset );
+
+        uint16_t id_message = 0;
+        for ( ; id_message < xi_utest_sft_logic__sent_messages_count; ++id_message )
+        {
+            if ( XI_CONTROL_MESSAGE_CS__SFT_FILE_GET_CHUNK ==
+                 xi_utest_sft_logic__sent_messages[id_message]->common.msgtype )
+            {
+                xi_utest_sft_logic__reply_FILE_CHUNK( sft_context, id_message, 32 );
+            }
+        }
+
+        /* only the missing part was downloaded and the checksum covers the whole file */
+        tt_int_op( 2, ==, xi_utest_sft_logic__count_sent_messages(
+                              XI_CONTROL_MESSAGE_CS__SFT_FILE_GET_CHUNK, 0 ) );
+        tt_int_op( 2, ==, xi_utest_sft_logic__count_sent_messages(
+                              XI_CONTROL_MESSAGE_CS__SFT_FILE_STATUS,
+                              XI_CONTROL_MESSAGE__SFT_FILE_STATUS_CODE_SUCCESS ) );
+
+        XI_SAFE_FREE( revision );
+        tt_int_op( XI_STATE_OK, !=, xi_sft_revision_get_download_progress(
+                                        __FUNCTION__, &revision, &size_in_bytes,
+                                        &offset ) );
+
+    end:
+
+        XI_SAFE_FREE( revision );
+        xi_bsp_io_fs_remove( __FUNCTION__ );
+        xi_bsp_io_fs_remove( "xi_utest__download_progress__context_freed_midway__download_"
+                             "continues_from_saved_offset.xirev" );
+        xi_sft_revision_remove_download_progress( __FUNCTION__ );
+        xi_utest_sft_logic__free_sent_messages();
+        xi_sft_free_context( &sft_context );
+    } )
+
+XI_TT_TESTCASE_WITH_SETUP(
+    xi_utest__download_progress__saved_for_other_revision__download_starts_over,
+    xi_utest_setup_basic,
+    xi_utest_teardown_basic,
+    NULL,
+    {
+        xi_sft_context_t* sft_context = NULL;
+        char* revision                = NULL;
+        uint32_t size_in_bytes        = 0;
+        uint32_t offset               = 0;
+
+        xi_sft_revision_set_download_progress( __FUNCTION__, "previous revision", 111,
+                                               64 );
+
+        xi_sft_make_context( &sft_context, NULL, 0, &xi_utest_sft_logic__send_message,
+                             NULL, NULL );
+
+        xi_sft_on_message( sft_context, xi_utest_sft_logic__generate_FUA_for_generated_file(
+                                            __FUNCTION__, 111 ) );
+
+        tt_int_op( 1, ==, xi_utest_sft_logic__sent_messages_count );
+        tt_int_op( 0, ==, xi_utest_sft_logic__sent_messages[0]->file_get_chunk.offset );
+
+        /* the stale progress is dropped */
+        tt_int_op( XI_STATE_OK, !=, xi_sft_revision_get_download_progress(
+                                        __FUNCTION__, &revision, &size_in_bytes,
+                                        &offset ) );
+
+    end:
+
+        XI_SAFE_FREE( revision );
+        xi_sft_revision_remove_download_progress( __FUNCTION__ );
+        xi_utest_sft_logic__free_sent_messages();
+        xi_sft_free_context( &sft_context );
+    } )
+
+XI_TT_TESTCASE_WITH_SETUP(
+    xi_utest__parallel_downloads__three_files__two_at_a_time_package_finished_once,
+    xi_utest_setup_basic,
+    xi_utest_teardown_basic,
+    NULL,
+    {
+        xi_sft_context_t* sft_context = NULL;
+        const char* filenames[]       = {"xi_utest_parallel_file1",
+                                   "xi_utest_parallel_file2", "xi_utest_parallel_file3"};
+        uint16_t id_file              = 0;
+
+        xi_sft_make_context( &sft_context, NULL, 0, &xi_utest_sft_logic__send_message,
+                             NULL, NULL );
+        xi_sft_set_download_window( sft_context, 2, 32 );
+        xi_sft_set_parallel_downloads( sft_context, 2, 0 );
+
+        xi_sft_on_message( sft_context, xi_utest_sft_logic__generate_FUA_for_generated_files(
+                                            filenames, 3, 70 ) );
+
+        /* the first two files are started at once, the third waits for a free slot */
+        tt_int_op( 2, ==, xi_utest_sft_logic__sent_messages_count );
+        tt_str_op( filenames[0], ==,
+                   xi_utest_sft_logic__sent_messages[0]->file_get_chunk.name );
+        tt_str_op( filenames[1], ==,
+                   xi_utest_sft_logic__sent_messages[1]->file_get_chunk.name );
+
+        uint16_t id_message = 0;
+        for ( ; id_message < xi_utest_sft_logic__sent_messages_count; ++id_message )
+        {
+            if ( XI_CONTROL_MESSAGE_CS__SFT_FILE_GET_CHUNK ==
+                 xi_utest_sft_logic__sent_messages[id_message]->common.msgtype )
+            {
+                /* the package is reported finished only with the last chunk */
+                tt_ptr_op( NULL, !=, sft_context->update_message_fua );
+
+                xi_utest_sft_logic__reply_FILE_CHUNK( sft_context, id_message, 32 );
+            }
+        }
+
+        tt_ptr_op( NULL, ==, sft_context->update_message_fua );
+
+        tt_int_op( 9, ==, xi_utest_sft_logic__count_sent_messages(
+                              XI_CONTROL_MESSAGE_CS__SFT_FILE_GET_CHUNK, 0 ) );
+        tt_int_op( 6, ==, xi_utest_sft_logic__count_sent_messages(
+                              XI_CONTROL_MESSAGE_CS__SFT_FILE_STATUS,
+                              XI_CONTROL_MESSAGE__SFT_FILE_STATUS_CODE_SUCCESS ) );
+
+    end:
+
+        for ( id_file = 0; id_file < 3; ++id_file )
+        {
+            char* revision_resource_name = xi_str_cat( filenames[id_file], ".xirev" );
+
+            xi_bsp_io_fs_remove( filenames[id_file] );
+            xi_bsp_io_fs_remove( revision_resource_name );
+
+            XI_SAFE_FREE( revision_resource_name );
+        }
+
+        xi_utest_sft_logic__free_sent_messages();
+        xi_sft_free_context( &sft_context );
+    } )
+
+XI_TT_TESTCASE_WITH_SETUP(
+    xi_utest__parallel_downloads__memory_budget__outstanding_bytes_never_exceed_it,
+    xi_utest_setup_basic,
+    xi_utest_teardown_basic,
+    NULL,
+    {
+        xi_sft_context_t* sft_context = NULL;
+        const char* filenames[] = {"xi_utest_budget_file1", "xi_utest_budget_file2"};
+        uint16_t id_file        = 0;
+
+        xi_sft_make_context( &sft_context, NULL, 0, &xi_utest_sft_logic__send_message,
+                             NULL, NULL );
+        xi_sft_set_download_window( sft_context, 4, 16 );
+        xi_sft_set_parallel_downloads( sft_context, 2, 48 );
+
+        xi_sft_on_message( sft_context, xi_utest_sft_logic__generate_FUA_for_generated_files(
+                                            filenames, 2, 100 ) );
+
+        uint16_t id_message = 0;
+        for ( ; id_message < xi_utest_sft_logic__sent_messages_count; ++id_message )
+        {
+            if ( XI_CONTROL_MESSAGE_CS__SFT_FILE_GET_CHUNK ==
+                 xi_utest_sft_logic__sent_messages[id_message]->common.msgtype )
+            {
+                xi_utest_sft_logic__reply_FILE_CHUNK( sft_context, id_message, 16 );
+
+                /* 48 bytes are three outstanding requests of 16 bytes */
+                tt_int_op( 3, >=,
+                           sft_context->downloads[0].chunk_window.requests_in_flight +
+                               sft_context->downloads[1].chunk_window.requests_in_flight );
+            }
+        }
+
+        tt_int_op( 4, ==, xi_utest_sft_logic__count_sent_messages(
+                              XI_CONTROL_MESSAGE_CS__SFT_FILE_STATUS,
+                              XI_CONTROL_MESSAGE__SFT_FILE_STATUS_CODE_SUCCESS ) );
+
+    end:
+
+        for ( id_file = 0; id_file < 2; ++id_file )
+        {
+            char* revision_resource_name = xi_str_cat( filenames[id_file], ".xirev" );
+
+            xi_bsp_io_fs_remove( filenames[id_file] );
+            xi_bsp_io_fs_remove( revision_resource_name );
+
+            XI_SAFE_FREE( revision_resource_name );
+        }
+
+        xi_utest_sft_logic__free_sent_messages();
+        xi_sft_free_context( &sft_context );
     } )
 
 XI_TT_TESTGROUP_END
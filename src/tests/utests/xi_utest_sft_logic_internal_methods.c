@@ -46,7 +46,7 @@ XI_TT_TESTCASE_WITH_SETUP( xi_utest__send_file_get_chunk__null_parameters__no_cr
                            xi_utest_setup_basic,
                            xi_utest_teardown_basic,
                            NULL,
-                           { _xi_sft_send_file_get_chunk( NULL, 0, 0 ); } )
+                           { _xi_sft_send_file_get_chunk( NULL, NULL, 0, 0 ); } )
 
 XI_TT_TESTCASE_WITH_SETUP(
     xi_utest__send_file_get_chunk__context_with_null_fields__no_crash,
@@ -57,7 +57,7 @@ XI_TT_TESTCASE_WITH_SETUP(
         xi_sft_context_t sft_context = {.fn_send_message = ( fn_send_control_message_t )1,
                                         .update_current_file = NULL};
 
-        _xi_sft_send_file_get_chunk( &sft_context, 0, 0 );
+        _xi_sft_send_file_get_chunk( &sft_context, NULL, 0, 0 );
     } )
 
 
@@ -0,0 +1,240 @@
+/* Copyright (c) 2003-2018, Xively All rights reserved.
+ *
+ * This is part of the Xively C Client library,
+ * it is licensed under the BSD 3-Clause license.
+ */
+
+#include "tinytest.h"
+#include "tinytest_macros.h"
+#include "xi_tt_testcase_management.h"
+#include "xi_utest_basic_testcase_frame.h"
+
+#include "xi_stats.h"
+
+#include <stdio.h>
+
+#ifndef XI_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
+
+#define XI_UTEST_STATS_TRACE_SIZE 4
+
+#endif
+
+XI_TT_TESTGROUP_BEGIN( utest_stats )
+
+XI_TT_TESTCASE_WITH_SETUP(
+    utest__xi_stats_record_layer_call__durations__counted_in_log2_buckets,
+    xi_utest_setup_basic,
+    xi_utest_teardown_basic,
+    NULL,
+    {
+        xi_stats_reset();
+
+        xi_stats_record_layer_call( 1, 0 );
+        xi_stats_record_layer_call( 1, 1 );
+        xi_stats_record_layer_call( 1, 5 );
+        xi_stats_record_layer_call( 1, 7 );
+        xi_stats_record_layer_call( 1, 100000 );
+        xi_stats_record_layer_call( 1, -3 );
+
+        tt_int_op( xi_stats.layers[1].calls, ==, 6 );
+        tt_int_op( xi_stats.layers[1].latency_histogram[0], ==, 2 );
+        tt_int_op( xi_stats.layers[1].latency_histogram[1], ==, 1 );
+        tt_int_op( xi_stats.layers[1].latency_histogram[3], ==, 2 );
+        tt_int_op(
+            xi_stats.layers[1].latency_histogram[XI_STATS_LATENCY_BUCKETS_COUNT - 1], ==,
+            1 );
+        tt_int_op( xi_stats.layers[0].calls, ==, 0 );
+
+    end:
+        xi_stats_reset();
+    } )
+
+XI_TT_TESTCASE_WITH_SETUP(
+    utest__xi_stats_count_layer_call__untimed_calls__histogram_untouched,
+    xi_utest_setup_basic,
+    xi_utest_teardown_basic,
+    NULL,
+    {
+        uint8_t bucket = 0;
+
+        xi_stats_reset();
+
+        xi_stats_count_layer_call( 2 );
+        xi_stats_count_layer_call( 2 );
+        xi_stats_count_layer_call( XI_STATS_LAYERS_COUNT );
+
+        tt_int_op( xi_stats.layers[2].calls, ==, 2 );
+
+        for ( ; bucket < XI_STATS_LATENCY_BUCKETS_COUNT; ++bucket )
+        {
+            tt_int_op( xi_stats.layers[2].latency_histogram[bucket], ==, 0 );
+        }
+
+    end:
+        xi_stats_reset();
+    } )
+
+XI_TT_TESTCASE_WITH_SETUP(
+    utest__xi_stats_record_layer_call__type_id_out_of_range__ignored,
+    xi_utest_setup_basic,
+    xi_utest_teardown_basic,
+    NULL,
+    {
+        int layer_type_id = 0;
+
+        xi_stats_reset();
+
+        xi_stats_record_layer_call( -1, 1 );
+        xi_stats_record_layer_call( XI_STATS_LAYERS_COUNT, 1 );
+
+        for ( ; layer_type_id < XI_STATS_LAYERS_COUNT; ++layer_type_id )
+        {
+            tt_int_op( xi_stats.layers[layer_type_id].calls, ==, 0 );
+        }
+
+    end:
+        xi_stats_reset();
+    } )
+
+XI_TT_TESTCASE_WITH_SETUP(
+    utest__xi_stats_record_evtd_step__several_steps__maxima_kept,
+    xi_utest_setup_basic,
+    xi_utest_teardown_basic,
+    NULL,
+    {
+        xi_stats_reset();
+
+        xi_stats_record_evtd_step( 3, 10, 0 );
+        xi_stats_record_evtd_step( 5, 2, 0 );
+        xi_stats_record_evtd_step( 1, 4, 1 );
+        xi_stats_record_select( 20, 2, 1 );
+        xi_stats_record_select( 30, 0, 0 );
+
+        tt_int_op( xi_stats.evtd_steps, ==, 3 );
+        tt_int_op( xi_stats.timer_heap_size, ==, 1 );
+        tt_int_op( xi_stats.timer_heap_size_max, ==, 5 );
+        tt_int_op( xi_stats.evtd_queue_depth_max, ==, 10 );
+        tt_int_op( xi_stats.evtd_steps_over_budget, ==, 1 );
+        tt_int_op( xi_stats.select_calls, ==, 2 );
+        tt_int_op( xi_stats.select_ready_calls, ==, 1 );
+        tt_int_op( xi_stats.select_wait_ms, ==, 50 );
+        tt_int_op( xi_stats.select_ready_ms, ==, 2 );
+
+        xi_stats_reset();
+
+        tt_int_op( xi_stats.evtd_steps, ==, 0 );
+        tt_int_op( xi_stats.timer_heap_size_max, ==, 0 );
+
+    end:
+        xi_stats_reset();
+    } )
+
+XI_TT_TESTCASE_WITH_SETUP(
+    utest__xi_stats_record_publish__latencies__kept_per_priority_class,
+    xi_utest_setup_basic,
+    xi_utest_teardown_basic,
+    NULL,
+    {
+        xi_stats_reset();
+
+        xi_stats_record_publish( XI_PUBLISH_PRIORITY_ALARM, 1 );
+        xi_stats_record_publish( XI_PUBLISH_PRIORITY_ALARM, 6 );
+        xi_stats_record_publish( XI_PUBLISH_PRIORITY_BULK, 300 );
+        xi_stats_record_publish( XI_PUBLISH_PRIORITY_BULK, -2 );
+        xi_stats_record_publish( XI_PUBLISH_PRIORITY_COUNT, 1 );
+
+        tt_int_op( xi_stats.publish[XI_PUBLISH_PRIORITY_ALARM].messages, ==, 2 );
+        tt_int_op( xi_stats.publish[XI_PUBLISH_PRIORITY_ALARM].latency_max_ms, ==, 6 );
+        tt_int_op( xi_stats.publish[XI_PUBLISH_PRIORITY_ALARM].latency_total_ms, ==, 7 );
+        tt_int_op( xi_stats.publish[XI_PUBLISH_PRIORITY_ALARM].latency_histogram[1], ==,
+                   1 );
+        tt_int_op( xi_stats.publish[XI_PUBLISH_PRIORITY_ALARM].latency_histogram[3], ==,
+                   1 );
+        tt_int_op( xi_stats.publish[XI_PUBLISH_PRIORITY_BULK].messages, ==, 2 );
+        tt_int_op( xi_stats.publish[XI_PUBLISH_PRIORITY_BULK].latency_max_ms, ==, 300 );
+        tt_int_op( xi_stats.publish[XI_PUBLISH_PRIORITY_BULK].latency_histogram[0], ==,
+                   1 );
+        tt_int_op( xi_stats.publish[XI_PUBLISH_PRIORITY_NORMAL].messages, ==, 0 );
+
+    end:
+        xi_stats_reset();
+    } )
+
+XI_TT_TESTCASE_WITH_SETUP(
+    utest__xi_stats_read_trace__no_buffer__nothing_read,
+    xi_utest_setup_basic,
+    xi_utest_teardown_basic,
+    NULL,
+    {
+        xi_stats_trace_event_t events[XI_UTEST_STATS_TRACE_SIZE];
+        uint32_t sequence = 0;
+
+        xi_stats_set_trace_buffer( NULL, 0 );
+        xi_stats_record_evtd_step( 0, 1, 0 );
+
+        tt_int_op( xi_stats_read_trace( events, XI_UTEST_STATS_TRACE_SIZE, &sequence ),
+                   ==, 0 );
+        tt_int_op( sequence, ==, 0 );
+
+    end:
+        xi_stats_reset();
+    } )
+
+XI_TT_TESTCASE_WITH_SETUP(
+    utest__xi_stats_read_trace__buffer_overrun__oldest_events_skipped,
+    xi_utest_setup_basic,
+    xi_utest_teardown_basic,
+    NULL,
+    {
+        xi_stats_trace_event_t buffer[XI_UTEST_STATS_TRACE_SIZE];
+        xi_stats_trace_event_t events[XI_UTEST_STATS_TRACE_SIZE];
+        uint32_t sequence = 0;
+        uint32_t step     = 0;
+
+        xi_stats_set_trace_buffer( buffer, XI_UTEST_STATS_TRACE_SIZE );
+
+        xi_stats_record_evtd_step( 0, 100, 0 );
+        xi_stats_record_layer_call( 2, 3 );
+
+        tt_int_op( xi_stats_read_trace( events, XI_UTEST_STATS_TRACE_SIZE, &sequence ),
+                   ==, 2 );
+        tt_int_op( sequence, ==, 2 );
+        tt_int_op( events[0].sequence, ==, 0 );
+        tt_int_op( events[0].type, ==, XI_STATS_TRACE_EVTD_STEP );
+        tt_int_op( events[0].value, ==, 100 );
+        tt_int_op( events[1].type, ==, XI_STATS_TRACE_LAYER_CALL );
+        tt_int_op( events[1].id, ==, 2 );
+        tt_int_op( events[1].value, ==, 3 );
+
+        /* the writer laps the reader, events 2 to 5 are lost */
+        for ( ; step < 6; ++step )
+        {
+            xi_stats_record_evtd_step( 0, step, 0 );
+        }
+
+        tt_int_op( xi_stats_read_trace( events, 2, &sequence ), ==, 2 );
+        tt_int_op( events[0].sequence, ==, 4 );
+        tt_int_op( events[0].value, ==, 2 );
+        tt_int_op( events[1].sequence, ==, 5 );
+
+        tt_int_op( xi_stats_read_trace( events, XI_UTEST_STATS_TRACE_SIZE, &sequence ),
+                   ==, 2 );
+        tt_int_op( events[1].sequence, ==, 7 );
+        tt_int_op( events[1].value, ==, 5 );
+        tt_int_op( sequence, ==, 8 );
+
+        tt_int_op( xi_stats_read_trace( events, XI_UTEST_STATS_TRACE_SIZE, &sequence ),
+                   ==, 0 );
+
+    end:
+        xi_stats_set_trace_buffer( NULL, 0 );
+        xi_stats_reset();
+    } )
+
+XI_TT_TESTGROUP_END
+
+#ifndef XI_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
+#define XI_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
+#include __FILE__
+#undef XI_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
+#endif
@@ -36,6 +36,10 @@
 #define XI_TT_RESOURCE_MANAGER                  ( XI_TT_FS << 1 )
 #define XI_TT_IO_LAYER                          ( XI_TT_RESOURCE_MANAGER << 1 )
 #define XI_TT_TIME_EVENT                        ( XI_TT_IO_LAYER << 1 )
+#define XI_TT_PUBLISH_QUEUE                     ( XI_TT_TIME_EVENT << 1 )
+#define XI_TT_SESSION_LOG                       ( XI_TT_PUBLISH_QUEUE << 1 )
+#define XI_TT_STATS                             ( XI_TT_SESSION_LOG << 1 )
+#define XI_TT_EVENT_LOOP                        ( XI_TT_STATS << 1 )
 
 // clang-format on
 
@@ -61,6 +65,11 @@ XI_TT_TESTCASE_PREDECLARATION( utest_mqtt_parser );
 XI_TT_TESTCASE_PREDECLARATION( utest_mqtt_logic_layer_subscribe );
 XI_TT_TESTCASE_PREDECLARATION( utest_mqtt_codec_layer_data );
 XI_TT_TESTCASE_PREDECLARATION( utest_publish );
+XI_TT_TESTCASE_PREDECLARATION( utest_publish_queue );
+XI_TT_TESTCASE_PREDECLARATION( utest_session_log );
+XI_TT_TESTCASE_PREDECLARATION( utest_stats );
+XI_TT_TESTCASE_PREDECLARATION( utest_event_loop );
+XI_TT_TESTCASE_PREDECLARATION( utest_io_net_capture );
 XI_TT_TESTCASE_PREDECLARATION( utest_fwu_checksum );
 XI_TT_TESTCASE_PREDECLARATION( utest_cbor_codec_ct_encode );
 XI_TT_TESTCASE_PREDECLARATION( utest_cbor_codec_ct_decode );
@@ -178,6 +187,26 @@ struct testgroup_t groups[] = {
     {"utest_publish - ", utest_publish},
 #endif
 
+#if ( XI_TT_TEST_SET & XI_TT_PUBLISH_QUEUE )
+    {"utest_publish_queue - ", utest_publish_queue},
+#endif
+
+#if ( XI_TT_TEST_SET & XI_TT_SESSION_LOG )
+    {"utest_session_log - ", utest_session_log},
+#endif
+
+#if ( XI_TT_TEST_SET & XI_TT_STATS )
+    {"utest_stats - ", utest_stats},
+#endif
+
+#if ( XI_TT_TEST_SET & XI_TT_EVENT_LOOP )
+    {"utest_event_loop - ", utest_event_loop},
+#endif
+
+#if ( XI_TT_TEST_SET & XI_TT_IO_LAYER )
+    {"utest_io_net_capture - ", utest_io_net_capture},
+#endif
+
 #ifdef XI_CONTROL_TOPIC_ENABLED
 #if ( XI_TT_TEST_SET & XI_TT_CONTROL_TOPIC )
     {"utest_control_topic - ", utest_control_topic},